@@ -134,6 +134,34 @@ CommandLineHandler::CommandLineHandler()
             .set_syntax("n")
             .set_exact_value_count(1));
 
+    parser().add_option_handler(
+        &m_pass_range
+            .add_name("--pass-range")
+            .set_description("only render a range of rendering passes (0-based, inclusive)")
+            .set_syntax("first last")
+            .set_exact_value_count(2));
+
+    parser().add_option_handler(
+        &m_slice
+            .add_name("--slice")
+            .set_description("only render one of count horizontal bands of whole tiles (0-based)")
+            .set_syntax("index count")
+            .set_exact_value_count(2));
+
+    parser().add_option_handler(
+        &m_sample_buffer
+            .add_name("--sample-buffer")
+            .set_description("write the raw sample sums of the rendered tiles to a file that can be merged with mergesamplebuffers")
+            .set_syntax("filename")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_frames
+            .add_name("--frames")
+            .set_description("render a range of frames in a single session; # characters in the project and output filenames are replaced by the frame number")
+            .set_syntax("first last")
+            .set_exact_value_count(2));
+
     parser().add_option_handler(
         &m_override_shading
             .add_name("--override-shading")
@@ -72,6 +72,10 @@ class CommandLineHandler
     foundation::ValueOptionHandler<int>             m_window;
     foundation::ValueOptionHandler<int>             m_samples;
     foundation::ValueOptionHandler<int>             m_passes;
+    foundation::ValueOptionHandler<int>             m_pass_range;
+    foundation::ValueOptionHandler<int>             m_slice;
+    foundation::ValueOptionHandler<std::string>     m_sample_buffer;
+    foundation::ValueOptionHandler<int>             m_frames;
     foundation::ValueOptionHandler<std::string>     m_override_shading;
     foundation::ValueOptionHandler<std::string>     m_select_object_instances;
 
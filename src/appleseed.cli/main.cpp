@@ -46,6 +46,10 @@
 #include "renderer/api/utility.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
 #include "foundation/platform/console.h"
 #include "foundation/platform/debugger.h"
 #include "foundation/platform/thread.h"
@@ -70,6 +74,7 @@
 #include "boost/filesystem/path.hpp"
 
 // Standard headers.
+#include <algorithm>
 #include <cstddef>
 #include <cstdlib>
 #include <memory>
@@ -314,6 +319,67 @@ namespace
                 "generic_frame_renderer.passes",
                 g_cl.m_passes.values()[0]);
         }
+
+        if (g_cl.m_pass_range.is_set())
+        {
+            params.insert_path(
+                "generic_frame_renderer.first_pass",
+                g_cl.m_pass_range.values()[0]);
+
+            params.insert_path(
+                "generic_frame_renderer.last_pass",
+                g_cl.m_pass_range.values()[1]);
+        }
+    }
+
+    bool apply_slice_command_line_option(Project& project)
+    {
+        if (!g_cl.m_slice.is_set())
+            return true;
+
+        const int index = g_cl.m_slice.values()[0];
+        const int count = g_cl.m_slice.values()[1];
+
+        const Frame* frame = project.get_frame();
+        const CanvasProperties& props = frame->image().properties();
+
+        if (count < 1 || index < 0 || index >= count || static_cast<size_t>(count) > props.m_tile_count_y)
+        {
+            LOG_ERROR(
+                g_logger,
+                "invalid slice %d of %d: the frame has " FMT_SIZE_T " rows of tiles.",
+                index,
+                count,
+                props.m_tile_count_y);
+            return false;
+        }
+
+        // Restrict rendering to a band of whole tiles: tiles are seeded independently
+        // of each other, so they are rendered exactly as in a render of the full frame.
+        const size_t begin_row = index * props.m_tile_count_y / count;
+        const size_t end_row = (index + 1) * props.m_tile_count_y / count;
+        const AABB2u crop_window =
+            AABB2u::intersect(
+                AABB2u(
+                    Vector2u(0, begin_row * props.m_tile_height),
+                    Vector2u(props.m_canvas_width - 1, min(end_row * props.m_tile_height, props.m_canvas_height) - 1)),
+                frame->get_crop_window());
+
+        if (!crop_window.is_valid())
+        {
+            LOG_ERROR(g_logger, "slice %d of %d is outside of the crop window.", index, count);
+            return false;
+        }
+
+        set_frame_parameter(
+            project,
+            "crop_window",
+            foundation::to_string(crop_window.min.x) + ' ' +
+            foundation::to_string(crop_window.min.y) + ' ' +
+            foundation::to_string(crop_window.max.x) + ' ' +
+            foundation::to_string(crop_window.max.y));
+
+        return true;
     }
 
     void apply_select_object_instances_command_line_option(Assembly& assembly, const RegExFilter& filter)
@@ -414,9 +480,17 @@ namespace
         // Apply --samples option.
         apply_samples_command_line_option(params);
 
-        // Apply --passes option.
+        // Apply --passes and --pass-range options.
         apply_passes_command_line_option(params);
 
+        // Apply --sample-buffer option.
+        if (g_cl.m_sample_buffer.is_set())
+        {
+            params.insert_path(
+                "sample_buffer_file",
+                g_cl.m_sample_buffer.value());
+        }
+
         // Apply --override-shading option.
         if (g_cl.m_override_shading.is_set())
         {
@@ -456,7 +530,9 @@ namespace
 
 #endif
 
-    auto_release_ptr<Project> load_project(const string& project_filepath)
+    auto_release_ptr<Project> load_project(
+        const string&   project_filepath,
+        const int       options = ProjectFileReader::Defaults)
     {
         // Construct the schema file path.
         const bf::path schema_filepath =
@@ -469,7 +545,8 @@ namespace
         return
             reader.read(
                 project_filepath.c_str(),
-                schema_filepath.string().c_str());
+                schema_filepath.string().c_str(),
+                options);
     }
 
     bool configure_project(Project& project, ParamArray& params)
@@ -504,6 +581,10 @@ namespace
         // Apply the command line options.
         apply_command_line_options(project, params);
 
+        // Apply --slice option last since it depends on the final resolution and crop window.
+        if (!apply_slice_command_line_option(project))
+            return false;
+
         return true;
     }
 
@@ -513,53 +594,61 @@ namespace
         return value == "progressive";
     }
 
-    bool render(const string& project_filename)
+    // Return a new tile callback factory, or 0 if none is needed.
+    ITileCallbackFactory* create_tile_callback_factory(
+        const string&       project_filename,
+        const Project&      project,
+        const ParamArray&   params)
     {
-        // Load the project.
-        auto_release_ptr<Project> project = load_project(project_filename);
-        if (project.get() == 0)
-            return false;
-
-        // Retrieve the rendering parameters.
-        ParamArray params;
-        if (!configure_project(project.ref(), params))
-            return false;
-
-        // Create the tile callback factory.
-        auto_ptr<ITileCallbackFactory> tile_callback_factory;
         if (g_cl.m_mplay_display.is_set())
         {
-            tile_callback_factory.reset(
+            return
                 new MPlayTileCallbackFactory(
                     project_filename.c_str(),
                     is_progressive_render(params),
-                    g_logger));
+                    g_logger);
         }
         else if (g_cl.m_hrmanpipe_display.is_set())
         {
-            tile_callback_factory.reset(
+            return
                 new HRmanPipeTileCallbackFactory(
                     g_cl.m_hrmanpipe_display.value(),
                     is_progressive_render(params),
-                    g_logger));
+                    g_logger);
         }
-        else if (g_cl.m_output.is_set() && g_cl.m_continuous_saving.is_set())
+        else if (g_cl.m_output.is_set() && g_cl.m_continuous_saving.is_set() && !g_cl.m_frames.is_set())
         {
-            tile_callback_factory.reset(
+            return
                 new ContinuousSavingTileCallbackFactory(
                     g_cl.m_output.value().c_str(),
-                    g_logger));
+                    g_logger);
         }
-        else if (project->get_display() == 0)
+        else if (project.get_display() == 0)
         {
             // Create a default tile callback if needed.
             if (params.get_optional<string>("frame_renderer", "") != "progressive")
-            {
-                tile_callback_factory.reset(
-                    new ProgressTileCallbackFactory(g_logger));
-            }
+                return new ProgressTileCallbackFactory(g_logger);
         }
 
+        return 0;
+    }
+
+    bool render(const string& project_filename)
+    {
+        // Load the project.
+        auto_release_ptr<Project> project = load_project(project_filename);
+        if (project.get() == 0)
+            return false;
+
+        // Retrieve the rendering parameters.
+        ParamArray params;
+        if (!configure_project(project.ref(), params))
+            return false;
+
+        // Create the tile callback factory.
+        auto_ptr<ITileCallbackFactory> tile_callback_factory(
+            create_tile_callback_factory(project_filename, project.ref(), params));
+
         // Create the master renderer.
         DefaultRendererController renderer_controller;
         MasterRenderer renderer(
@@ -653,6 +742,185 @@ namespace
         return true;
     }
 
+    // Updates the project from the project file of each frame and writes rendered frames to disk.
+    class SequenceCallback
+      : public ISequenceCallback
+    {
+      public:
+        SequenceCallback(
+            const string&   project_pattern,
+            const size_t    first_frame)
+          : m_project_pattern(project_pattern)
+          , m_first_frame(first_frame)
+          , m_stopwatch(0)
+        {
+        }
+
+        virtual bool on_frame_begin(
+            Project&        project,
+            const size_t    frame) override
+        {
+            m_stopwatch.start();
+
+            // The project of the first frame is the one being rendered.
+            if (frame == m_first_frame || m_project_pattern.find('#') == string::npos)
+                return true;
+
+            // Only the animated state of the frame's project is used: don't read meshes.
+            const string project_filename = get_numbered_string(m_project_pattern, frame);
+            auto_release_ptr<Project> frame_project =
+                load_project(project_filename, ProjectFileReader::OmitReadingMeshFiles);
+            if (frame_project.get() == 0)
+                return false;
+
+            size_t updated_count;
+            if (!SceneUpdater::update(
+                    *project.get_scene(),
+                    *frame_project->get_scene(),
+                    updated_count))
+            {
+                LOG_ERROR(
+                    g_logger,
+                    "cannot update the scene from %s.",
+                    project_filename.c_str());
+                return false;
+            }
+
+            LOG_INFO(
+                g_logger,
+                "updated %s %s from %s.",
+                pretty_uint(updated_count).c_str(),
+                plural(updated_count, "entity", "entities").c_str(),
+                project_filename.c_str());
+
+            return true;
+        }
+
+        virtual bool on_frame_end(
+            Project&        project,
+            const size_t    frame) override
+        {
+            const Frame* rendered_frame = project.get_frame();
+
+            if (g_cl.m_output.is_set())
+            {
+                const string output_filename = get_numbered_string(g_cl.m_output.value(), frame);
+                LOG_INFO(g_logger, "writing frame to %s...", output_filename.c_str());
+                rendered_frame->write_main_image(output_filename.c_str());
+                rendered_frame->write_aov_images(output_filename.c_str());
+            }
+            else
+            {
+                const string output_pattern =
+                    rendered_frame->get_parameters().get_optional<string>("output_filename");
+
+                if (!output_pattern.empty())
+                {
+                    const string output_filename = get_numbered_string(output_pattern, frame);
+                    LOG_INFO(g_logger, "writing frame to %s...", output_filename.c_str());
+                    rendered_frame->write_main_image(output_filename.c_str());
+
+                    if (rendered_frame->get_parameters().get_optional<bool>("output_aovs", false))
+                        rendered_frame->write_aov_images(output_filename.c_str());
+                }
+            }
+
+            LOG_INFO(
+                g_logger,
+                "frame " FMT_SIZE_T " completed in %s.",
+                frame,
+                pretty_time(m_stopwatch.measure().get_seconds(), 3).c_str());
+
+            return true;
+        }
+
+      private:
+        const string                        m_project_pattern;
+        const size_t                        m_first_frame;
+        Stopwatch<DefaultWallclockTimer>    m_stopwatch;
+    };
+
+    bool render_sequence(const string& project_pattern)
+    {
+        if (g_cl.m_frames.values()[0] < 0 || g_cl.m_frames.values()[0] > g_cl.m_frames.values()[1])
+        {
+            LOG_ERROR(
+                g_logger,
+                "invalid frame range %d to %d.",
+                g_cl.m_frames.values()[0],
+                g_cl.m_frames.values()[1]);
+            return false;
+        }
+
+        const size_t first_frame = static_cast<size_t>(g_cl.m_frames.values()[0]);
+        const size_t last_frame = static_cast<size_t>(g_cl.m_frames.values()[1]);
+
+        if (g_cl.m_output.is_set() && g_cl.m_output.value().find('#') == string::npos)
+        {
+            LOG_ERROR(g_logger, "the output filename must contain # characters when rendering a sequence.");
+            return false;
+        }
+
+        if (g_cl.m_sample_buffer.is_set())
+        {
+            LOG_ERROR(g_logger, "sample buffers cannot be written when rendering a sequence.");
+            return false;
+        }
+
+        // Load the project of the first frame.
+        auto_release_ptr<Project> project =
+            load_project(get_numbered_string(project_pattern, first_frame));
+        if (project.get() == 0)
+            return false;
+
+        // Retrieve the rendering parameters.
+        ParamArray params;
+        if (!configure_project(project.ref(), params))
+            return false;
+
+        // Frames are written to disk once they are complete.
+        if (g_cl.m_continuous_saving.is_set())
+            LOG_WARNING(g_logger, "continuous saving is not supported when rendering a sequence.");
+
+        auto_ptr<ITileCallbackFactory> tile_callback_factory(
+            create_tile_callback_factory(project_pattern, project.ref(), params));
+
+        // Create the master renderer.
+        DefaultRendererController renderer_controller;
+        MasterRenderer renderer(
+            project.ref(),
+            params,
+            &renderer_controller,
+            tile_callback_factory.get());
+
+        // Render the sequence.
+        SequenceCallback sequence_callback(project_pattern, first_frame);
+        Stopwatch<DefaultWallclockTimer> stopwatch;
+        if (params.get_optional<bool>("background_mode", true))
+        {
+            ProcessPriorityContext background_context(ProcessPriorityLow, &g_logger);
+            stopwatch.start();
+            if (!renderer.render_sequence(sequence_callback, first_frame, last_frame))
+                return false;
+            stopwatch.measure();
+        }
+        else
+        {
+            stopwatch.start();
+            if (!renderer.render_sequence(sequence_callback, first_frame, last_frame))
+                return false;
+            stopwatch.measure();
+        }
+
+        // Print rendering time.
+        LOG_INFO(
+            g_logger,
+            "sequence rendering finished in %s.",
+            pretty_time(stopwatch.get_seconds(), 3).c_str());
+
+        return true;
+    }
+
     bool benchmark_render(const string& project_filename)
     {
         // Configure our logger.
@@ -767,6 +1035,8 @@ int main(int argc, const char* argv[])
 
         if (g_cl.m_benchmark_mode.is_set())
             success = success && benchmark_render(project_filename);
+        else if (g_cl.m_frames.is_set())
+            success = success && render_sequence(project_filename);
         else success = success && render(project_filename);
     }
 
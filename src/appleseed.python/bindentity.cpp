@@ -70,6 +70,7 @@ namespace
     void entity_set_parameters(Entity* e, const bpy::dict& params)
     {
         e->get_parameters() = bpy_dict_to_param_array(params);
+        e->bump_version_id();
     }
 }
 
@@ -74,6 +74,16 @@ namespace
         object->get_triangle(index) = triangle;
     }
 
+    void compute_mesh_smooth_vertex_normals(MeshObject* object)
+    {
+        compute_smooth_vertex_normals(*object);
+    }
+
+    void compute_mesh_smooth_vertex_tangents(MeshObject* object)
+    {
+        compute_smooth_vertex_tangents(*object);
+    }
+
     bpy::list read_mesh_objects(
         const bpy::list&    search_paths,
         const string&       base_object_name,
@@ -205,7 +215,7 @@ void bind_mesh_object()
         .def("write", write_mesh_object).staticmethod("write")
         ;
 
-    bpy::def("compute_smooth_vertex_normals", compute_smooth_vertex_normals);
-    bpy::def("compute_smooth_vertex_tangents", compute_smooth_vertex_tangents);
+    bpy::def("compute_smooth_vertex_normals", compute_mesh_smooth_vertex_normals);
+    bpy::def("compute_smooth_vertex_tangents", compute_mesh_smooth_vertex_tangents);
     bpy::def("create_primitive_mesh", create_mesh_prim);
 }
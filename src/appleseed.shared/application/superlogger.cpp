@@ -56,6 +56,9 @@ SuperLogger::SuperLogger()
 
 SuperLogger::~SuperLogger()
 {
+    // Make sure no queued message is sent to the log target once it's deleted.
+    disable_async_mode();
+
     delete m_log_target;
 }
 
@@ -114,6 +117,36 @@ void SuperLogger::configure_from_settings(const Dictionary& settings)
 
     if (settings.strings().exist("message_verbosity"))
         set_verbosity_level_from_string(settings.get("message_verbosity"));
+
+    if (settings.strings().exist("asynchronous_logging"))
+    {
+        const char* value = settings.get("asynchronous_logging");
+        try
+        {
+            if (from_string<bool>(value))
+                enable_async_mode();
+            else disable_async_mode();
+        }
+        catch (ExceptionStringConversionError)
+        {
+            LOG_ERROR(*this, "invalid value \"%s\" for parameter \"asynchronous_logging\".", value);
+        }
+    }
+
+    if (settings.strings().exist("crash_log_flushing"))
+    {
+        const char* value = settings.get("crash_log_flushing");
+        try
+        {
+            if (from_string<bool>(value))
+                enable_crash_flushing();
+            else disable_crash_flushing();
+        }
+        catch (ExceptionStringConversionError)
+        {
+            LOG_ERROR(*this, "invalid value \"%s\" for parameter \"crash_log_flushing\".", value);
+        }
+    }
 }
 
 }   // namespace shared
@@ -1298,8 +1298,10 @@ void MainWindow::slot_pack_project_as()
     if (!filepath.isEmpty())
     {
         const QString Extension = "appleseedz";
+        const QString BinaryExtension = "appleseedb";
 
-        if (QFileInfo(filepath).suffix() != Extension)
+        const QString suffix = QFileInfo(filepath).suffix();
+        if (suffix != Extension && suffix != BinaryExtension)
             filepath += "." + Extension;
 
         filepath = QDir::toNativeSeparators(filepath);
@@ -1313,13 +1315,13 @@ QString MainWindow::get_filter_string(const int filter)
     QStringList filters;
 
     if (filter & ProjectDialogFilterAllProjects)
-        filters << "Project Files (*.appleseed *.appleseedz)";
+        filters << "Project Files (*.appleseed *.appleseedz *.appleseedb)";
 
     if (filter & ProjectDialogFilterPlainProjects)
         filters << "Plain Project Files (*.appleseed)";
 
     if (filter & ProjectDialogFilterPackedProjects)
-        filters << "Packed Project Files (*.appleseedz)";
+        filters << "Packed Project Files (*.appleseedz *.appleseedb)";
 
     if (filter & ProjectDialogFilterAllFiles)
         filters << "All Files (*.*)";
@@ -210,7 +210,7 @@ class MainWindow
     {
         ProjectDialogFilterAllProjects    = 1 << 0,  // all appleseed extensions
         ProjectDialogFilterPlainProjects  = 1 << 1,  // .appleseed extension
-        ProjectDialogFilterPackedProjects = 1 << 2,  // .appleseedz extension
+        ProjectDialogFilterPackedProjects = 1 << 2,  // .appleseedz and .appleseedb extensions
         ProjectDialogFilterAllFiles       = 1 << 3   // all extensions
     };
 
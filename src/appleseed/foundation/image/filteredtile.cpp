@@ -35,6 +35,12 @@
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/atomic.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
+
+// Standard headers.
+#include <vector>
 
 using namespace std;
 
@@ -54,8 +60,6 @@ namespace foundation
 //   http://alvyray.com/Memos/CG/Microsoft/6_pixel.pdf
 //
 
-#define ATOMIC_UPDATES
-
 FilteredTile::FilteredTile(
     const size_t        width,
     const size_t        height,
@@ -87,10 +91,77 @@ void FilteredTile::clear()
         ptr[i] = 0.0f;
 }
 
+namespace
+{
+    // Maximum footprint size, in pixels along one axis, for which filter
+    // weights are stored on the stack.
+    const size_t MaxStackFootprintSize = 32;
+
+    struct AtomicAccumulator
+    {
+        static void add(
+            float*          ptr,
+            const float     weight,
+            const float*    values,
+            const size_t    value_count)
+        {
+            atomic_add(ptr++, weight);
+
+            for (size_t i = 0; i < value_count; ++i)
+                atomic_add(ptr++, values[i] * weight);
+        }
+    };
+
+    struct NonAtomicAccumulator
+    {
+        static void add(
+            float* APPLESEED_RESTRICT           ptr,
+            const float                         weight,
+            const float* APPLESEED_RESTRICT     values,
+            const size_t                        value_count)
+        {
+            *ptr++ += weight;
+
+            size_t i = 0;
+
+#ifdef APPLESEED_USE_SSE
+            const __m128 mweight = _mm_set1_ps(weight);
+
+            for (; i + 4 <= value_count; i += 4)
+            {
+                const __m128 mvalues = _mm_loadu_ps(values + i);
+                const __m128 mpixel = _mm_loadu_ps(ptr + i);
+                _mm_storeu_ps(ptr + i, _mm_add_ps(mpixel, _mm_mul_ps(mvalues, mweight)));
+            }
+#endif
+
+            for (; i < value_count; ++i)
+                ptr[i] += values[i] * weight;
+        }
+    };
+}
+
 void FilteredTile::add(
     const float         x,
     const float         y,
     const float*        values)
+{
+    do_add<AtomicAccumulator>(x, y, values);
+}
+
+void FilteredTile::add_unsynchronized(
+    const float         x,
+    const float         y,
+    const float*        values)
+{
+    do_add<NonAtomicAccumulator>(x, y, values);
+}
+
+template <typename Accumulator>
+void FilteredTile::do_add(
+    const float         x,
+    const float         y,
+    const float*        values)
 {
     // Convert (x, y) from continuous image space to discrete image space.
     const float dx = x - 0.5f;
@@ -107,32 +178,41 @@ void FilteredTile::add(
     footprint = AABB2i::intersect(footprint, m_crop_window);
 
     // Bail out if the point does not fall inside the crop window.
-    // Only check the x coordinate; the y coordinate is checked in the loop below.
-    if (footprint.min.x > footprint.max.x)
+    if (footprint.min.x > footprint.max.x || footprint.min.y > footprint.max.y)
         return;
 
-    for (int ry = footprint.min.y; ry <= footprint.max.y; ++ry)
+    const size_t footprint_width = static_cast<size_t>(footprint.max.x - footprint.min.x + 1);
+    const size_t footprint_height = static_cast<size_t>(footprint.max.y - footprint.min.y + 1);
+
+    // Filters are separable: evaluate them once per column and once per row of the footprint
+    // and compute the weight of each pixel as the product of its column and row weights.
+    float stack_weights[2 * MaxStackFootprintSize];
+    vector<float> heap_weights;
+    float* weights_x = stack_weights;
+    if (footprint_width > MaxStackFootprintSize || footprint_height > MaxStackFootprintSize)
     {
-        float* APPLESEED_RESTRICT ptr = reinterpret_cast<float*>(pixel(footprint.min.x, ry));
+        heap_weights.resize(footprint_width + footprint_height);
+        weights_x = &heap_weights[0];
+    }
+    float* weights_y = weights_x + footprint_width;
 
-        for (int rx = footprint.min.x; rx <= footprint.max.x; ++rx)
-        {
-            const float weight = m_filter.evaluate(rx - dx, ry - dy);
+    for (size_t i = 0; i < footprint_width; ++i)
+        weights_x[i] = m_filter.evaluate_x(static_cast<float>(footprint.min.x + static_cast<int>(i)) - dx);
 
-#ifdef ATOMIC_UPDATES
-            atomic_add(ptr++, weight);
-#else
-            *ptr++ += weight;
-#endif
+    for (size_t i = 0; i < footprint_height; ++i)
+        weights_y[i] = m_filter.evaluate_y(static_cast<float>(footprint.min.y + static_cast<int>(i)) - dy);
 
-            for (size_t i = 0, e = m_channel_count - 1; i < e; ++i)
-            {
-#ifdef ATOMIC_UPDATES
-                atomic_add(ptr++, values[i] * weight);
-#else
-                *ptr++ += values[i] * weight;
-#endif
-            }
+    const size_t value_count = m_channel_count - 1;
+
+    for (size_t j = 0; j < footprint_height; ++j)
+    {
+        float* ptr = pixel(footprint.min.x, footprint.min.y + j);
+        const float weight_y = weights_y[j];
+
+        for (size_t i = 0; i < footprint_width; ++i)
+        {
+            Accumulator::add(ptr, weights_x[i] * weight_y, values, value_count);
+            ptr += m_channel_count;
         }
     }
 }
@@ -118,6 +118,7 @@ class FilteredTile
     // Set all pixels to black and all weights to zero.
     void clear();
 
+    // Add a sample. Safe to call concurrently from multiple threads.
     // The point (x, y) is expressed in continuous image space
     // (https://github.com/appleseedhq/appleseed/wiki/Terminology).
     void add(
@@ -125,9 +126,23 @@ class FilteredTile
         const float         y,
         const float*        values);
 
+    // Same as add(), but not thread-safe. Faster when the tile is only
+    // accessed by a single thread.
+    void add_unsynchronized(
+        const float         x,
+        const float         y,
+        const float*        values);
+
   protected:
     const AABB2u            m_crop_window;
     const Filter2f&         m_filter;
+
+  private:
+    template <typename Accumulator>
+    void do_add(
+        const float         x,
+        const float         y,
+        const float*        values);
 };
 
 
@@ -0,0 +1,100 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_IMAGE_TILEDTEXTUREFILEFORMAT_H
+#define APPLESEED_FOUNDATION_IMAGE_TILEDTEXTUREFILEFORMAT_H
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
+namespace foundation
+{
+
+//
+// Native tiled, mipmapped texture file format.
+//
+// Layout of a file (all values in little-endian byte order):
+//
+//   TiledTextureFileHeader
+//   TiledTextureLevelHeader     [level count]
+//   TiledTextureChannelStats    [channel count]
+//   TiledTextureTileEntry       [total tile count, level by level, tiles in row-major order]
+//   tile data
+//
+// Level 0 is the full resolution image, each subsequent level halves the
+// dimensions of the previous one (rounding down, but never below 1 pixel).
+// Tiles are stored uncompressed, as contiguous arrays of interleaved pixels.
+// Tiles on the right and bottom borders of a level are truncated so that
+// they don't extend past the edges of the level.
+//
+// Channel statistics are computed on the full resolution level and are
+// expressed as floating-point values, in the color space of the texture.
+//
+
+const char TiledTextureFileMagic[4] = { 'A', 'S', 'T', 'X' };
+const uint32 TiledTextureFileVersion = 2;
+const char TiledTextureFileExtension[] = ".astx";
+
+enum TiledTextureFileFlags
+{
+    TiledTextureFileFlagConstant = 1 << 0  // all pixels of the texture have the same value
+};
+
+struct TiledTextureFileHeader
+{
+    char        m_magic[4];
+    uint32      m_version;
+    uint32      m_channel_count;
+    uint32      m_pixel_format;             // a foundation::PixelFormat value
+    uint32      m_tile_width;
+    uint32      m_tile_height;
+    uint32      m_level_count;
+    uint32      m_flags;                    // a combination of TiledTextureFileFlags values
+};
+
+struct TiledTextureLevelHeader
+{
+    uint32      m_width;
+    uint32      m_height;
+};
+
+struct TiledTextureChannelStats
+{
+    float       m_average;
+    float       m_max;
+};
+
+struct TiledTextureTileEntry
+{
+    uint64      m_offset;                   // offset in bytes from the beginning of the file
+    uint64      m_size;                     // size in bytes of the tile data
+};
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_IMAGE_TILEDTEXTUREFILEFORMAT_H
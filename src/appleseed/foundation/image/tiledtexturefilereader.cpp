@@ -0,0 +1,330 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "tiledtexturefilereader.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/exceptionunsupportedimageformat.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/image/tiledtexturefileformat.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/randomaccessfile.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// TiledTextureFileReader class implementation.
+//
+
+struct TiledTextureFileReader::Impl
+{
+    string                              m_filename;
+    RandomAccessFile                    m_file;
+    uint32                              m_flags;
+    vector<CanvasProperties>            m_levels;
+    vector<TiledTextureChannelStats>    m_channel_stats;
+    vector<size_t>                      m_first_tile_entries;   // index of the first tile entry of each level
+    vector<TiledTextureTileEntry>       m_tile_entries;
+
+    void read_header()
+    {
+        TiledTextureFileHeader header;
+        read(0, &header, sizeof(header));
+
+        if (memcmp(header.m_magic, TiledTextureFileMagic, sizeof(TiledTextureFileMagic)) != 0 ||
+            header.m_version != TiledTextureFileVersion ||
+            header.m_pixel_format > PixelFormatDouble ||
+            header.m_channel_count == 0 ||
+            header.m_tile_width == 0 ||
+            header.m_tile_height == 0 ||
+            header.m_level_count == 0)
+            throw ExceptionUnsupportedImageFormat();
+
+        m_flags = header.m_flags;
+
+        uint64 offset = sizeof(header);
+
+        vector<TiledTextureLevelHeader> level_headers(header.m_level_count);
+        read(
+            offset,
+            &level_headers[0],
+            level_headers.size() * sizeof(TiledTextureLevelHeader));
+        offset += level_headers.size() * sizeof(TiledTextureLevelHeader);
+
+        m_channel_stats.resize(header.m_channel_count);
+        read(
+            offset,
+            &m_channel_stats[0],
+            m_channel_stats.size() * sizeof(TiledTextureChannelStats));
+        offset += m_channel_stats.size() * sizeof(TiledTextureChannelStats);
+
+        size_t tile_entry_count = 0;
+
+        for (size_t i = 0; i < level_headers.size(); ++i)
+        {
+            const TiledTextureLevelHeader& level_header = level_headers[i];
+
+            if (level_header.m_width == 0 || level_header.m_height == 0)
+                throw ExceptionUnsupportedImageFormat();
+
+            const CanvasProperties props(
+                level_header.m_width,
+                level_header.m_height,
+                header.m_tile_width,
+                header.m_tile_height,
+                header.m_channel_count,
+                static_cast<PixelFormat>(header.m_pixel_format));
+
+            m_levels.push_back(props);
+            m_first_tile_entries.push_back(tile_entry_count);
+            tile_entry_count += props.m_tile_count;
+        }
+
+        m_tile_entries.resize(tile_entry_count);
+        read(
+            offset,
+            &m_tile_entries[0],
+            m_tile_entries.size() * sizeof(TiledTextureTileEntry));
+    }
+
+    void read(
+        const uint64        offset,
+        void*               outbuf,
+        const size_t        size) const
+    {
+        if (m_file.read(offset, outbuf, size) != size)
+            throw ExceptionIOError(("failed to read from " + m_filename).c_str());
+    }
+};
+
+TiledTextureFileReader::TiledTextureFileReader()
+  : impl(new Impl())
+{
+    impl->m_flags = 0;
+}
+
+TiledTextureFileReader::~TiledTextureFileReader()
+{
+    if (is_open())
+        close();
+
+    delete impl;
+}
+
+bool TiledTextureFileReader::is_tiled_texture_file(const char* filename)
+{
+    assert(filename);
+
+    RandomAccessFile file;
+    if (!file.open(filename))
+        return false;
+
+    char magic[sizeof(TiledTextureFileMagic)];
+    if (file.read(0, magic, sizeof(magic)) != sizeof(magic))
+        return false;
+
+    return memcmp(magic, TiledTextureFileMagic, sizeof(magic)) == 0;
+}
+
+bool TiledTextureFileReader::read_constant_color(
+    const char*         filename,
+    Color4f&            color,
+    size_t&             channel_count)
+{
+    assert(filename);
+
+    RandomAccessFile file;
+    if (!file.open(filename))
+        return false;
+
+    TiledTextureFileHeader header;
+    if (file.read(0, &header, sizeof(header)) != sizeof(header))
+        return false;
+
+    if (memcmp(header.m_magic, TiledTextureFileMagic, sizeof(TiledTextureFileMagic)) != 0 ||
+        header.m_version != TiledTextureFileVersion ||
+        (header.m_flags & TiledTextureFileFlagConstant) == 0 ||
+        header.m_channel_count == 0 ||
+        header.m_channel_count > 4)
+        return false;
+
+    // Channel statistics follow the level headers.
+    TiledTextureChannelStats stats[4];
+    const size_t stats_size = header.m_channel_count * sizeof(TiledTextureChannelStats);
+    if (file.read(
+            sizeof(header) + header.m_level_count * sizeof(TiledTextureLevelHeader),
+            stats,
+            stats_size) != stats_size)
+        return false;
+
+    color = Color4f(0.0f, 0.0f, 0.0f, 1.0f);
+
+    for (size_t c = 0; c < header.m_channel_count; ++c)
+        color[c] = stats[c].m_average;
+
+    channel_count = header.m_channel_count;
+
+    return true;
+}
+
+void TiledTextureFileReader::open(const char* filename)
+{
+    assert(filename);
+    assert(!is_open());
+
+    impl->m_filename = filename;
+
+    if (!impl->m_file.open(filename))
+        throw ExceptionIOError(("failed to open " + impl->m_filename).c_str());
+
+    try
+    {
+        impl->read_header();
+    }
+    catch (...)
+    {
+        close();
+        throw;
+    }
+}
+
+void TiledTextureFileReader::close()
+{
+    assert(is_open());
+
+    impl->m_file.close();
+    impl->m_flags = 0;
+    impl->m_levels.clear();
+    impl->m_channel_stats.clear();
+    impl->m_first_tile_entries.clear();
+    impl->m_tile_entries.clear();
+}
+
+bool TiledTextureFileReader::is_open() const
+{
+    return impl->m_file.is_open();
+}
+
+void TiledTextureFileReader::read_canvas_properties(
+    CanvasProperties&   props)
+{
+    assert(is_open());
+
+    props = impl->m_levels[0];
+}
+
+void TiledTextureFileReader::read_image_attributes(
+    ImageAttributes&    attrs)
+{
+    assert(is_open());
+}
+
+Tile* TiledTextureFileReader::read_tile(
+    const size_t        tile_x,
+    const size_t        tile_y)
+{
+    return read_tile(0, tile_x, tile_y);
+}
+
+size_t TiledTextureFileReader::get_level_count() const
+{
+    assert(is_open());
+
+    return impl->m_levels.size();
+}
+
+const CanvasProperties& TiledTextureFileReader::get_level_properties(const size_t level) const
+{
+    assert(is_open());
+    assert(level < impl->m_levels.size());
+
+    return impl->m_levels[level];
+}
+
+bool TiledTextureFileReader::is_constant() const
+{
+    assert(is_open());
+
+    return (impl->m_flags & TiledTextureFileFlagConstant) != 0;
+}
+
+const TiledTextureChannelStats& TiledTextureFileReader::get_channel_stats(const size_t channel) const
+{
+    assert(is_open());
+    assert(channel < impl->m_channel_stats.size());
+
+    return impl->m_channel_stats[channel];
+}
+
+Tile* TiledTextureFileReader::read_tile(
+    const size_t        level,
+    const size_t        tile_x,
+    const size_t        tile_y) const
+{
+    assert(is_open());
+    assert(level < impl->m_levels.size());
+
+    const CanvasProperties& props = impl->m_levels[level];
+
+    assert(tile_x < props.m_tile_count_x);
+    assert(tile_y < props.m_tile_count_y);
+
+    const TiledTextureTileEntry& entry =
+        impl->m_tile_entries[
+            impl->m_first_tile_entries[level] + tile_y * props.m_tile_count_x + tile_x];
+
+    auto_ptr<Tile> tile(
+        new Tile(
+            props.get_tile_width(tile_x),
+            props.get_tile_height(tile_y),
+            props.m_channel_count,
+            props.m_pixel_format));
+
+    if (entry.m_size != tile->get_size())
+        throw ExceptionIOError(("corrupted tile in " + impl->m_filename).c_str());
+
+    impl->read(entry.m_offset, tile->get_storage(), tile->get_size());
+
+    return tile.release();
+}
+
+}   // namespace foundation
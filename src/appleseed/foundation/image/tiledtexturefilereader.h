@@ -0,0 +1,128 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_IMAGE_TILEDTEXTUREFILEREADER_H
+#define APPLESEED_FOUNDATION_IMAGE_TILEDTEXTUREFILEREADER_H
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/image/iprogressiveimagefilereader.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class CanvasProperties; }
+namespace foundation    { class ImageAttributes; }
+namespace foundation    { class Tile; }
+namespace foundation    { struct TiledTextureChannelStats; }
+
+namespace foundation
+{
+
+//
+// Reader for native tiled texture files (see tiledtexturefileformat.h).
+//
+// Once the file is open, tiles of any level may be read concurrently from
+// any number of threads: tiles are fetched with positional reads on a single
+// file handle, without any locking.
+//
+
+class APPLESEED_DLLSYMBOL TiledTextureFileReader
+  : public IProgressiveImageFileReader
+{
+  public:
+    // Constructor.
+    TiledTextureFileReader();
+
+    // Destructor.
+    ~TiledTextureFileReader();
+
+    // Return true if a given file is a native tiled texture file.
+    static bool is_tiled_texture_file(const char* filename);
+
+    // Return true if a given file is a native tiled texture file whose pixels all
+    // have the same value. In that case, store this value and the number of channels
+    // of the file in color and channel_count. Only the file header is read.
+    static bool read_constant_color(
+        const char*         filename,
+        Color4f&            color,
+        size_t&             channel_count);
+
+    // Open an image file.
+    virtual void open(
+        const char*         filename) override;
+
+    // Close the image file.
+    virtual void close() override;
+
+    // Return true if an image file is currently open.
+    virtual bool is_open() const override;
+
+    // Read canvas properties of the full resolution level.
+    virtual void read_canvas_properties(
+        CanvasProperties&   props) override;
+
+    // Read image attributes.
+    virtual void read_image_attributes(
+        ImageAttributes&    attrs) override;
+
+    // Read a tile of the full resolution level. Returns a newly allocated tile.
+    virtual Tile* read_tile(
+        const size_t        tile_x,
+        const size_t        tile_y) override;
+
+    // Return the number of levels in the file.
+    size_t get_level_count() const;
+
+    // Return the canvas properties of a given level.
+    const CanvasProperties& get_level_properties(const size_t level) const;
+
+    // Return true if all pixels of the texture have the same value.
+    bool is_constant() const;
+
+    // Return the statistics of a given channel of the full resolution level.
+    const TiledTextureChannelStats& get_channel_stats(const size_t channel) const;
+
+    // Read a tile of a given level. Returns a newly allocated tile. Thread-safe.
+    Tile* read_tile(
+        const size_t        level,
+        const size_t        tile_x,
+        const size_t        tile_y) const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_IMAGE_TILEDTEXTUREFILEREADER_H
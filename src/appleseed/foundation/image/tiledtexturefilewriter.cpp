@@ -0,0 +1,335 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "tiledtexturefilewriter.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/icanvas.h"
+#include "foundation/image/tile.h"
+#include "foundation/image/tiledtexturefileformat.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/bufferedfile.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// TiledTextureFileWriter class implementation.
+//
+
+namespace
+{
+    // A level of the texture, as a contiguous array of interleaved floating-point pixels.
+    struct Level
+    {
+        size_t          m_width;
+        size_t          m_height;
+        vector<float>   m_pixels;
+    };
+
+    void read_image(
+        const ICanvas&  image,
+        Level&          level)
+    {
+        const CanvasProperties& props = image.properties();
+        const size_t channel_count = props.m_channel_count;
+
+        level.m_width = props.m_canvas_width;
+        level.m_height = props.m_canvas_height;
+        level.m_pixels.resize(props.m_pixel_count * channel_count);
+
+        for (size_t tile_y = 0; tile_y < props.m_tile_count_y; ++tile_y)
+        {
+            for (size_t tile_x = 0; tile_x < props.m_tile_count_x; ++tile_x)
+            {
+                const Tile& tile = image.tile(tile_x, tile_y);
+                const size_t origin_x = tile_x * props.m_tile_width;
+                const size_t origin_y = tile_y * props.m_tile_height;
+
+                for (size_t y = 0; y < tile.get_height(); ++y)
+                {
+                    for (size_t x = 0; x < tile.get_width(); ++x)
+                    {
+                        const size_t index = (origin_y + y) * level.m_width + origin_x + x;
+                        tile.get_pixel(x, y, &level.m_pixels[index * channel_count]);
+                    }
+                }
+            }
+        }
+    }
+
+    // Build the next mipmap level using a 2x2 box filter.
+    void downsample(
+        const Level&    src,
+        const size_t    channel_count,
+        Level&          dest)
+    {
+        dest.m_width = max<size_t>(src.m_width / 2, 1);
+        dest.m_height = max<size_t>(src.m_height / 2, 1);
+        dest.m_pixels.resize(dest.m_width * dest.m_height * channel_count);
+
+        for (size_t y = 0; y < dest.m_height; ++y)
+        {
+            const size_t y0 = min(2 * y, src.m_height - 1);
+            const size_t y1 = min(2 * y + 1, src.m_height - 1);
+
+            for (size_t x = 0; x < dest.m_width; ++x)
+            {
+                const size_t x0 = min(2 * x, src.m_width - 1);
+                const size_t x1 = min(2 * x + 1, src.m_width - 1);
+
+                const float* p00 = &src.m_pixels[(y0 * src.m_width + x0) * channel_count];
+                const float* p10 = &src.m_pixels[(y0 * src.m_width + x1) * channel_count];
+                const float* p01 = &src.m_pixels[(y1 * src.m_width + x0) * channel_count];
+                const float* p11 = &src.m_pixels[(y1 * src.m_width + x1) * channel_count];
+                float* d = &dest.m_pixels[(y * dest.m_width + x) * channel_count];
+
+                for (size_t c = 0; c < channel_count; ++c)
+                    d[c] = 0.25f * (p00[c] + p10[c] + p01[c] + p11[c]);
+            }
+        }
+    }
+
+    // Compute per-channel statistics and detect constant images.
+    bool compute_stats(
+        const Level&                        level,
+        const size_t                        channel_count,
+        vector<TiledTextureChannelStats>&   stats)
+    {
+        const size_t pixel_count = level.m_width * level.m_height;
+        const float* first = &level.m_pixels[0];
+
+        vector<double> sums(channel_count, 0.0);
+        stats.resize(channel_count);
+
+        for (size_t c = 0; c < channel_count; ++c)
+            stats[c].m_max = first[c];
+
+        bool is_constant = true;
+
+        for (size_t i = 0; i < pixel_count; ++i)
+        {
+            const float* p = &level.m_pixels[i * channel_count];
+
+            for (size_t c = 0; c < channel_count; ++c)
+            {
+                sums[c] += p[c];
+                stats[c].m_max = max(stats[c].m_max, p[c]);
+                is_constant = is_constant && p[c] == first[c];
+            }
+        }
+
+        for (size_t c = 0; c < channel_count; ++c)
+            stats[c].m_average = static_cast<float>(sums[c] / pixel_count);
+
+        return is_constant;
+    }
+
+    void write_bytes(
+        BufferedFile&   file,
+        const void*     data,
+        const size_t    size,
+        const char*     filename)
+    {
+        if (file.write(data, size) != size)
+            throw ExceptionIOError(("failed to write to " + string(filename)).c_str());
+    }
+}
+
+TiledTextureFileWriter::TiledTextureFileWriter(
+    const size_t            tile_width,
+    const size_t            tile_height,
+    const PixelFormat       pixel_format,
+    const bool              generate_mipmaps)
+  : m_tile_width(tile_width)
+  , m_tile_height(tile_height)
+  , m_pixel_format(pixel_format)
+  , m_generate_mipmaps(generate_mipmaps)
+{
+    assert(m_tile_width > 0);
+    assert(m_tile_height > 0);
+}
+
+void TiledTextureFileWriter::write(
+    const char*             filename,
+    const ICanvas&          image,
+    const ImageAttributes&  image_attributes)
+{
+    assert(filename);
+
+    const size_t channel_count = image.properties().m_channel_count;
+
+    // Read the full resolution image and build the mipmap chain.
+    vector<Level> levels(1);
+    read_image(image, levels[0]);
+
+    if (m_generate_mipmaps)
+    {
+        while (levels.back().m_width > 1 || levels.back().m_height > 1)
+        {
+            Level level;
+            downsample(levels.back(), channel_count, level);
+            levels.push_back(level);
+        }
+    }
+
+    vector<TiledTextureChannelStats> stats;
+    const bool is_constant = compute_stats(levels[0], channel_count, stats);
+
+    // Compute the layout of each level.
+    vector<CanvasProperties> level_props;
+    size_t tile_count = 0;
+
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        level_props.push_back(
+            CanvasProperties(
+                levels[i].m_width,
+                levels[i].m_height,
+                m_tile_width,
+                m_tile_height,
+                channel_count,
+                m_pixel_format));
+
+        tile_count += level_props.back().m_tile_count;
+    }
+
+    // Compute the tile table.
+    vector<TiledTextureTileEntry> tile_entries;
+    tile_entries.reserve(tile_count);
+
+    uint64 offset =
+          sizeof(TiledTextureFileHeader)
+        + levels.size() * sizeof(TiledTextureLevelHeader)
+        + channel_count * sizeof(TiledTextureChannelStats)
+        + tile_count * sizeof(TiledTextureTileEntry);
+
+    for (size_t i = 0; i < level_props.size(); ++i)
+    {
+        const CanvasProperties& props = level_props[i];
+
+        for (size_t tile_y = 0; tile_y < props.m_tile_count_y; ++tile_y)
+        {
+            for (size_t tile_x = 0; tile_x < props.m_tile_count_x; ++tile_x)
+            {
+                TiledTextureTileEntry entry;
+                entry.m_offset = offset;
+                entry.m_size =
+                      props.get_tile_width(tile_x)
+                    * props.get_tile_height(tile_y)
+                    * props.m_pixel_size;
+                tile_entries.push_back(entry);
+                offset += entry.m_size;
+            }
+        }
+    }
+
+    BufferedFile file;
+    if (!file.open(filename, BufferedFile::BinaryType, BufferedFile::WriteMode))
+        throw ExceptionIOError(("failed to open " + string(filename) + " for writing").c_str());
+
+    // Write the header.
+    TiledTextureFileHeader header;
+    memcpy(header.m_magic, TiledTextureFileMagic, sizeof(header.m_magic));
+    header.m_version = TiledTextureFileVersion;
+    header.m_channel_count = static_cast<uint32>(channel_count);
+    header.m_pixel_format = static_cast<uint32>(m_pixel_format);
+    header.m_tile_width = static_cast<uint32>(m_tile_width);
+    header.m_tile_height = static_cast<uint32>(m_tile_height);
+    header.m_level_count = static_cast<uint32>(levels.size());
+    header.m_flags = is_constant ? TiledTextureFileFlagConstant : 0;
+    write_bytes(file, &header, sizeof(header), filename);
+
+    // Write the level headers.
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        TiledTextureLevelHeader level_header;
+        level_header.m_width = static_cast<uint32>(levels[i].m_width);
+        level_header.m_height = static_cast<uint32>(levels[i].m_height);
+        write_bytes(file, &level_header, sizeof(level_header), filename);
+    }
+
+    // Write the channel statistics and the tile table.
+    write_bytes(file, &stats[0], stats.size() * sizeof(TiledTextureChannelStats), filename);
+    write_bytes(file, &tile_entries[0], tile_entries.size() * sizeof(TiledTextureTileEntry), filename);
+
+    // Write the tiles.
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        const Level& level = levels[i];
+        const CanvasProperties& props = level_props[i];
+
+        for (size_t tile_y = 0; tile_y < props.m_tile_count_y; ++tile_y)
+        {
+            for (size_t tile_x = 0; tile_x < props.m_tile_count_x; ++tile_x)
+            {
+                Tile tile(
+                    props.get_tile_width(tile_x),
+                    props.get_tile_height(tile_y),
+                    channel_count,
+                    m_pixel_format);
+
+                const size_t origin_x = tile_x * m_tile_width;
+                const size_t origin_y = tile_y * m_tile_height;
+                const size_t row_size = tile.get_width() * channel_count;
+
+                for (size_t y = 0; y < tile.get_height(); ++y)
+                {
+                    const float* src = &level.m_pixels[((origin_y + y) * level.m_width + origin_x) * channel_count];
+
+                    Pixel::convert_to_format(
+                        src,
+                        src + row_size,
+                        1,
+                        m_pixel_format,
+                        tile.pixel(0, y),
+                        1);
+                }
+
+                write_bytes(file, tile.get_storage(), tile.get_size(), filename);
+            }
+        }
+    }
+
+    if (!file.close())
+        throw ExceptionIOError(("failed to write to " + string(filename)).c_str());
+}
+
+}   // namespace foundation
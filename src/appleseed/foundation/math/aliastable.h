@@ -0,0 +1,283 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_ALIASTABLE_H
+#define APPLESEED_FOUNDATION_MATH_ALIASTABLE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace foundation
+{
+
+//
+// Alias table for constant-time sampling of discrete distributions.
+//
+// Sampling an alias table requires a single table lookup, regardless of the
+// number of items, while sampling a CDF requires a binary search. Note that
+// the alias method does not preserve the stratification of the samples.
+//
+// References:
+//
+//   http://www.keithschwarz.com/darts-dice-coins/
+//   https://en.wikipedia.org/wiki/Alias_method
+//
+
+template <typename Weight>
+class AliasTable
+  : public NonCopyable
+{
+  public:
+    // Constructor.
+    AliasTable();
+
+    // Return true if the table is empty.
+    bool empty() const;
+
+    // Return true if the table has at least one item with a positive weight.
+    bool valid() const;
+
+    // Return the number of items in the table.
+    size_t size() const;
+
+    // Return the sum of the weight of all inserted items.
+    Weight weight() const;
+
+    // Remove all items from the table.
+    void clear();
+
+    // Allocate memory for a given number of items.
+    void reserve(const size_t count);
+
+    // Insert an item with a given non-negative weight.
+    void insert(const Weight weight);
+
+    // Prepare the table for sampling.
+    // This method must be called once and only once before sample() is called.
+    void prepare();
+
+    // Return the normalized probability of the i'th item.
+    // Only valid once the table has been prepared.
+    Weight get_probability(const size_t i) const;
+
+    // Sample the table and return the index of the chosen item. x is in [0,1).
+    size_t sample(const Weight x) const;
+
+    // Sample the table and return the index of the chosen item and its probability.
+    size_t sample(const Weight x, Weight& probability) const;
+
+  private:
+    struct Entry
+    {
+        Weight  m_probability;          // normalized probability of this item
+        Weight  m_threshold;            // probability of keeping this item instead of its alias
+        size_t  m_alias;                // index of the alias of this item
+    };
+
+    std::vector<Entry>  m_entries;
+    Weight              m_weight_sum;
+};
+
+
+//
+// AliasTable class implementation.
+//
+
+template <typename Weight>
+inline AliasTable<Weight>::AliasTable()
+  : m_weight_sum(0.0)
+{
+}
+
+template <typename Weight>
+inline bool AliasTable<Weight>::empty() const
+{
+    return m_entries.empty();
+}
+
+template <typename Weight>
+inline bool AliasTable<Weight>::valid() const
+{
+    return m_weight_sum > Weight(0.0);
+}
+
+template <typename Weight>
+inline size_t AliasTable<Weight>::size() const
+{
+    return m_entries.size();
+}
+
+template <typename Weight>
+inline Weight AliasTable<Weight>::weight() const
+{
+    return m_weight_sum;
+}
+
+template <typename Weight>
+inline void AliasTable<Weight>::clear()
+{
+    m_entries.clear();
+    m_weight_sum = Weight(0.0);
+}
+
+template <typename Weight>
+inline void AliasTable<Weight>::reserve(const size_t count)
+{
+    m_entries.reserve(count);
+}
+
+template <typename Weight>
+inline void AliasTable<Weight>::insert(const Weight weight)
+{
+    assert(weight >= Weight(0.0));
+
+    Entry entry;
+    entry.m_probability = weight;
+    entry.m_threshold = Weight(1.0);
+    entry.m_alias = m_entries.size();
+    m_entries.push_back(entry);
+
+    m_weight_sum += weight;
+}
+
+template <typename Weight>
+void AliasTable<Weight>::prepare()
+{
+    assert(valid());
+
+    const size_t item_count = m_entries.size();
+
+    // Normalize weights so that they add up to 1.0.
+    const Weight rcp_weight_sum = Weight(1.0) / m_weight_sum;
+    for (size_t i = 0; i < item_count; ++i)
+        m_entries[i].m_probability *= rcp_weight_sum;
+
+    // Split items into those that are less likely and those that are more likely than average.
+    // Items with a null weight are also used as the fallback alias of other small items.
+    std::vector<size_t> small, large;
+    small.reserve(item_count);
+    large.reserve(item_count);
+    std::vector<Weight> scaled(item_count);
+    size_t fallback = 0;
+    for (size_t i = 0; i < item_count; ++i)
+    {
+        scaled[i] = m_entries[i].m_probability * static_cast<Weight>(item_count);
+        if (scaled[i] < Weight(1.0))
+            small.push_back(i);
+        else large.push_back(i);
+        if (m_entries[i].m_probability > m_entries[fallback].m_probability)
+            fallback = i;
+    }
+
+    // Pair each less likely item with a more likely one (Vose's method).
+    while (!small.empty() && !large.empty())
+    {
+        const size_t s = small.back();
+        small.pop_back();
+
+        const size_t l = large.back();
+
+        m_entries[s].m_threshold = scaled[s];
+        m_entries[s].m_alias = l;
+
+        scaled[l] = (scaled[l] + scaled[s]) - Weight(1.0);
+
+        if (scaled[l] < Weight(1.0))
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // Remaining items are only there because of numerical errors.
+    for (size_t i = 0, e = large.size(); i < e; ++i)
+    {
+        Entry& entry = m_entries[large[i]];
+        entry.m_threshold = Weight(1.0);
+        entry.m_alias = large[i];
+    }
+
+    for (size_t i = 0, e = small.size(); i < e; ++i)
+    {
+        Entry& entry = m_entries[small[i]];
+        if (entry.m_probability > Weight(0.0))
+        {
+            entry.m_threshold = Weight(1.0);
+            entry.m_alias = small[i];
+        }
+        else
+        {
+            entry.m_threshold = Weight(0.0);
+            entry.m_alias = fallback;
+        }
+    }
+}
+
+template <typename Weight>
+inline Weight AliasTable<Weight>::get_probability(const size_t i) const
+{
+    assert(i < m_entries.size());
+    return m_entries[i].m_probability;
+}
+
+template <typename Weight>
+inline size_t AliasTable<Weight>::sample(const Weight x) const
+{
+    assert(!m_entries.empty());
+    assert(x >= Weight(0.0));
+    assert(x < Weight(1.0));
+
+    const size_t item_count = m_entries.size();
+
+    // Choose a column of the table, and reuse the remainder of x to choose between the item and its alias.
+    const Weight scaled_x = x * static_cast<Weight>(item_count);
+    const size_t i = std::min(truncate<size_t>(scaled_x), item_count - 1);
+    const Weight y = scaled_x - static_cast<Weight>(i);
+
+    const Entry& entry = m_entries[i];
+    return y < entry.m_threshold ? i : entry.m_alias;
+}
+
+template <typename Weight>
+inline size_t AliasTable<Weight>::sample(const Weight x, Weight& probability) const
+{
+    const size_t i = sample(x);
+    probability = m_entries[i].m_probability;
+    return i;
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_ALIASTABLE_H
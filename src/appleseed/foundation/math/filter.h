@@ -50,6 +50,8 @@ namespace foundation
 // The filters are not normalized (they don't integrate to 1 over their domain).
 // The return value of evaluate() is undefined if (x, y) is outside the filter's domain.
 //
+// All filters are separable: evaluate(x, y) is equal to evaluate_x(x) * evaluate_y(y).
+//
 
 template <typename T>
 class Filter2
@@ -66,6 +68,10 @@ class Filter2
 
     virtual T evaluate(const T x, const T y) const = 0;
 
+    // Evaluate the filter along each axis.
+    virtual T evaluate_x(const T x) const = 0;
+    virtual T evaluate_y(const T y) const = 0;
+
   protected:
     const T m_xradius;
     const T m_yradius;
@@ -94,6 +100,8 @@ class BoxFilter2
     BoxFilter2(const T xradius, const T yradius);
 
     virtual T evaluate(const T x, const T y) const override;
+    virtual T evaluate_x(const T x) const override;
+    virtual T evaluate_y(const T y) const override;
 };
 
 
@@ -109,6 +117,8 @@ class TriangleFilter2
     TriangleFilter2(const T xradius, const T yradius);
 
     virtual T evaluate(const T x, const T y) const override;
+    virtual T evaluate_x(const T x) const override;
+    virtual T evaluate_y(const T y) const override;
 };
 
 
@@ -127,6 +137,8 @@ class GaussianFilter2
         const T alpha);
 
     virtual T evaluate(const T x, const T y) const override;
+    virtual T evaluate_x(const T x) const override;
+    virtual T evaluate_y(const T y) const override;
 
   private:
     const T m_alpha;
@@ -146,6 +158,8 @@ class FastGaussianFilter2
         const T alpha);
 
     virtual T evaluate(const T x, const T y) const override;
+    virtual T evaluate_x(const T x) const override;
+    virtual T evaluate_y(const T y) const override;
 
   private:
     const T m_alpha;
@@ -175,10 +189,14 @@ class MitchellFilter2
         const T c);
 
     virtual T evaluate(const T x, const T y) const override;
+    virtual T evaluate_x(const T x) const override;
+    virtual T evaluate_y(const T y) const override;
 
   private:
     T m_a3, m_a2, m_a0;
     T m_b3, m_b2, m_b1, m_b0;
+
+    T mitchell(const T x) const;
 };
 
 
@@ -197,6 +215,8 @@ class LanczosFilter2
         const T tau);
 
     virtual T evaluate(const T x, const T y) const override;
+    virtual T evaluate_x(const T x) const override;
+    virtual T evaluate_y(const T y) const override;
 
   private:
     const T m_rcp_tau;
@@ -222,6 +242,8 @@ class BlackmanHarrisFilter2
     BlackmanHarrisFilter2(const T xradius, const T yradius);
 
     virtual T evaluate(const T x, const T y) const override;
+    virtual T evaluate_x(const T x) const override;
+    virtual T evaluate_y(const T y) const override;
 
   private:
     static T blackman(const T x);
@@ -235,6 +257,8 @@ class FastBlackmanHarrisFilter2
     FastBlackmanHarrisFilter2(const T xradius, const T yradius);
 
     virtual T evaluate(const T x, const T y) const override;
+    virtual T evaluate_x(const T x) const override;
+    virtual T evaluate_y(const T y) const override;
 
   private:
     static T blackman(const T x);
@@ -294,6 +318,18 @@ inline T BoxFilter2<T>::evaluate(const T x, const T y) const
     return T(1.0);
 }
 
+template <typename T>
+inline T BoxFilter2<T>::evaluate_x(const T x) const
+{
+    return T(1.0);
+}
+
+template <typename T>
+inline T BoxFilter2<T>::evaluate_y(const T y) const
+{
+    return T(1.0);
+}
+
 
 //
 // TriangleFilter2 class implementation.
@@ -313,6 +349,18 @@ inline T TriangleFilter2<T>::evaluate(const T x, const T y) const
     return (T(1.0) - std::abs(nx)) * (T(1.0) - std::abs(ny));
 }
 
+template <typename T>
+inline T TriangleFilter2<T>::evaluate_x(const T x) const
+{
+    return T(1.0) - std::abs(x * Filter2<T>::m_rcp_xradius);
+}
+
+template <typename T>
+inline T TriangleFilter2<T>::evaluate_y(const T y) const
+{
+    return T(1.0) - std::abs(y * Filter2<T>::m_rcp_yradius);
+}
+
 
 //
 // GaussianFilter2 class implementation.
@@ -341,6 +389,18 @@ inline T GaussianFilter2<T>::evaluate(const T x, const T y) const
     return fx * fy;
 }
 
+template <typename T>
+inline T GaussianFilter2<T>::evaluate_x(const T x) const
+{
+    return gaussian(x * Filter2<T>::m_rcp_xradius, m_alpha) - m_shift;
+}
+
+template <typename T>
+inline T GaussianFilter2<T>::evaluate_y(const T y) const
+{
+    return gaussian(y * Filter2<T>::m_rcp_yradius, m_alpha) - m_shift;
+}
+
 template <typename T>
 APPLESEED_FORCE_INLINE T GaussianFilter2<T>::gaussian(const T x, const T alpha)
 {
@@ -378,6 +438,18 @@ inline T FastGaussianFilter2<T>::evaluate(const T x, const T y) const
     return fx * fy;
 }
 
+template <typename T>
+inline T FastGaussianFilter2<T>::evaluate_x(const T x) const
+{
+    return gaussian(x * Filter2<T>::m_rcp_xradius, m_alpha) - m_shift;
+}
+
+template <typename T>
+inline T FastGaussianFilter2<T>::evaluate_y(const T y) const
+{
+    return gaussian(y * Filter2<T>::m_rcp_yradius, m_alpha) - m_shift;
+}
+
 template <typename T>
 APPLESEED_FORCE_INLINE T FastGaussianFilter2<T>::gaussian(const T x, const T alpha)
 {
@@ -414,27 +486,35 @@ inline MitchellFilter2<T>::MitchellFilter2(
 template <typename T>
 inline T MitchellFilter2<T>::evaluate(const T x, const T y) const
 {
-    const T nx = x * Filter2<T>::m_rcp_xradius;
-    const T x1 = std::abs(nx + nx);
+    const T fx = mitchell(x * Filter2<T>::m_rcp_xradius);
+    const T fy = mitchell(y * Filter2<T>::m_rcp_yradius);
+
+    return fx * fy;
+}
+
+template <typename T>
+inline T MitchellFilter2<T>::evaluate_x(const T x) const
+{
+    return mitchell(x * Filter2<T>::m_rcp_xradius);
+}
+
+template <typename T>
+inline T MitchellFilter2<T>::evaluate_y(const T y) const
+{
+    return mitchell(y * Filter2<T>::m_rcp_yradius);
+}
+
+template <typename T>
+APPLESEED_FORCE_INLINE T MitchellFilter2<T>::mitchell(const T x) const
+{
+    const T x1 = std::abs(x + x);
     const T x2 = x1 * x1;
     const T x3 = x2 * x1;
 
-    const T fx =
+    return
         x1 < T(1.0)
             ? m_a3 * x3 + m_a2 * x2 + m_a0
             : m_b3 * x3 + m_b2 * x2 + m_b1 * x1 + m_b0;
-
-    const T ny = y * Filter2<T>::m_rcp_yradius;
-    const T y1 = std::abs(ny + ny);
-    const T y2 = y1 * y1;
-    const T y3 = y2 * y1;
-
-    const T fy =
-        y1 < T(1.0)
-            ? m_a3 * y3 + m_a2 * y2 + m_a0
-            : m_b3 * y3 + m_b2 * y2 + m_b1 * y1 + m_b0;
-
-    return fx * fy;
 }
 
 
@@ -460,6 +540,18 @@ inline T LanczosFilter2<T>::evaluate(const T x, const T y) const
     return lanczos(nx, m_rcp_tau) * lanczos(ny, m_rcp_tau);
 }
 
+template <typename T>
+inline T LanczosFilter2<T>::evaluate_x(const T x) const
+{
+    return lanczos(x * Filter2<T>::m_rcp_xradius, m_rcp_tau);
+}
+
+template <typename T>
+inline T LanczosFilter2<T>::evaluate_y(const T y) const
+{
+    return lanczos(y * Filter2<T>::m_rcp_yradius, m_rcp_tau);
+}
+
 template <typename T>
 APPLESEED_FORCE_INLINE T LanczosFilter2<T>::lanczos(const T x, const T rcp_tau)
 {
@@ -492,6 +584,18 @@ inline T BlackmanHarrisFilter2<T>::evaluate(const T x, const T y) const
     return blackman(nx) * blackman(ny);
 }
 
+template <typename T>
+inline T BlackmanHarrisFilter2<T>::evaluate_x(const T x) const
+{
+    return blackman(T(0.5) * (T(1.0) + x * Filter2<T>::m_rcp_xradius));
+}
+
+template <typename T>
+inline T BlackmanHarrisFilter2<T>::evaluate_y(const T y) const
+{
+    return blackman(T(0.5) * (T(1.0) + y * Filter2<T>::m_rcp_yradius));
+}
+
 template <typename T>
 APPLESEED_FORCE_INLINE T BlackmanHarrisFilter2<T>::blackman(const T x)
 {
@@ -521,6 +625,18 @@ inline T FastBlackmanHarrisFilter2<T>::evaluate(const T x, const T y) const
     return blackman(nx) * blackman(ny);
 }
 
+template <typename T>
+inline T FastBlackmanHarrisFilter2<T>::evaluate_x(const T x) const
+{
+    return blackman(T(0.5) * (T(1.0) + x * Filter2<T>::m_rcp_xradius));
+}
+
+template <typename T>
+inline T FastBlackmanHarrisFilter2<T>::evaluate_y(const T y) const
+{
+    return blackman(T(0.5) * (T(1.0) + y * Filter2<T>::m_rcp_yradius));
+}
+
 template <typename T>
 APPLESEED_FORCE_INLINE T FastBlackmanHarrisFilter2<T>::blackman(const T x)
 {
@@ -0,0 +1,276 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_INTERSECTION_RAYTRIANGLEWT_H
+#define APPLESEED_FOUNDATION_MATH_INTERSECTION_RAYTRIANGLEWT_H
+
+// appleseed.foundation headers.
+#include "foundation/math/ray.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/compiler.h"
+
+// Standard headers.
+#include <cstddef>
+
+namespace foundation
+{
+
+//
+// Woop-Benthin-Wald watertight ray-triangle intersection test.
+//
+// Rays never slip between triangles sharing an edge or a vertex, even when the
+// test is carried out in single precision. Edge functions that evaluate to zero
+// are recomputed in double precision, as suggested in the paper.
+//
+// Reference:
+//
+//   http://jcgt.org/published/0002/01/05/
+//
+
+template <typename T>
+struct TriangleWT
+{
+    // Types.
+    typedef T ValueType;
+    typedef Vector<T, 3> VectorType;
+
+    // Ray-dependent data, shared by all the triangles intersected by a given ray.
+    struct RayInfo
+    {
+        VectorType  m_org;
+        size_t      m_kx;
+        size_t      m_ky;
+        size_t      m_kz;
+        ValueType   m_sx;
+        ValueType   m_sy;
+        ValueType   m_sz;
+
+        // Constructors.
+        RayInfo();
+        template <typename U>
+        explicit RayInfo(const Ray<U, 3>& ray);
+    };
+
+    // Vertices.
+    VectorType  m_v0;
+    VectorType  m_v1;
+    VectorType  m_v2;
+
+    // Constructors.
+    TriangleWT();
+    TriangleWT(
+        const VectorType&   v0,
+        const VectorType&   v1,
+        const VectorType&   v2);
+
+    // The ray is only used for its [tmin, tmax) interval.
+    template <typename U>
+    bool intersect(
+        const Ray<U, 3>&    ray,
+        const RayInfo&      ray_info,
+        ValueType&          t,
+        ValueType&          u,
+        ValueType&          v) const;
+
+    template <typename U>
+    bool intersect(
+        const Ray<U, 3>&    ray,
+        const RayInfo&      ray_info) const;
+
+  private:
+    // Compute the scaled barycentric coordinates and the scaled hit distance.
+    // Return false if the ray misses the triangle.
+    bool compute_scaled_hit(
+        const RayInfo&      ray_info,
+        ValueType&          det,
+        ValueType&          t_scaled,
+        ValueType&          u_scaled,
+        ValueType&          v_scaled) const;
+};
+
+
+//
+// TriangleWT::RayInfo class implementation.
+//
+
+template <typename T>
+inline TriangleWT<T>::RayInfo::RayInfo()
+{
+}
+
+template <typename T>
+template <typename U>
+inline TriangleWT<T>::RayInfo::RayInfo(const Ray<U, 3>& ray)
+  : m_org(ray.m_org)
+{
+    // Make the dimension where the ray direction is maximal the z axis.
+    const VectorType dir(ray.m_dir);
+    m_kz = max_abs_index(dir);
+    m_kx = m_kz == 2 ? 0 : m_kz + 1;
+    m_ky = m_kx == 2 ? 0 : m_kx + 1;
+
+    // Swap the x and y dimensions to preserve the winding direction of triangles.
+    if (dir[m_kz] < ValueType(0.0))
+    {
+        const size_t tmp = m_kx;
+        m_kx = m_ky;
+        m_ky = tmp;
+    }
+
+    // Compute the shear constants.
+    m_sz = ValueType(1.0) / dir[m_kz];
+    m_sx = dir[m_kx] * m_sz;
+    m_sy = dir[m_ky] * m_sz;
+}
+
+
+//
+// TriangleWT class implementation.
+//
+
+template <typename T>
+inline TriangleWT<T>::TriangleWT()
+{
+}
+
+template <typename T>
+inline TriangleWT<T>::TriangleWT(
+    const VectorType&       v0,
+    const VectorType&       v1,
+    const VectorType&       v2)
+  : m_v0(v0)
+  , m_v1(v1)
+  , m_v2(v2)
+{
+}
+
+template <typename T>
+APPLESEED_FORCE_INLINE bool TriangleWT<T>::compute_scaled_hit(
+    const RayInfo&          ray_info,
+    ValueType&              det,
+    ValueType&              t_scaled,
+    ValueType&              u_scaled,
+    ValueType&              v_scaled) const
+{
+    const size_t kx = ray_info.m_kx;
+    const size_t ky = ray_info.m_ky;
+    const size_t kz = ray_info.m_kz;
+
+    // Compute the vertices relative to the ray origin.
+    const VectorType a = m_v0 - ray_info.m_org;
+    const VectorType b = m_v1 - ray_info.m_org;
+    const VectorType c = m_v2 - ray_info.m_org;
+
+    // Shear and scale the vertices.
+    const ValueType ax = a[kx] - ray_info.m_sx * a[kz];
+    const ValueType ay = a[ky] - ray_info.m_sy * a[kz];
+    const ValueType bx = b[kx] - ray_info.m_sx * b[kz];
+    const ValueType by = b[ky] - ray_info.m_sy * b[kz];
+    const ValueType cx = c[kx] - ray_info.m_sx * c[kz];
+    const ValueType cy = c[ky] - ray_info.m_sy * c[kz];
+
+    // Compute the scaled barycentric coordinates.
+    ValueType w0 = cx * by - cy * bx;
+    ValueType w1 = ax * cy - ay * cx;
+    ValueType w2 = bx * ay - by * ax;
+
+    // Fall back to double precision on edges.
+    if (w0 == ValueType(0.0) || w1 == ValueType(0.0) || w2 == ValueType(0.0))
+    {
+        w0 = static_cast<ValueType>(static_cast<double>(cx) * by - static_cast<double>(cy) * bx);
+        w1 = static_cast<ValueType>(static_cast<double>(ax) * cy - static_cast<double>(ay) * cx);
+        w2 = static_cast<ValueType>(static_cast<double>(bx) * ay - static_cast<double>(by) * ax);
+    }
+
+    // Check that the intersection point lies inside the triangle.
+    if ((w0 < ValueType(0.0) || w1 < ValueType(0.0) || w2 < ValueType(0.0)) &&
+        (w0 > ValueType(0.0) || w1 > ValueType(0.0) || w2 > ValueType(0.0)))
+        return false;
+
+    // Reject rays parallel to the triangle.
+    det = w0 + w1 + w2;
+    if (det == ValueType(0.0))
+        return false;
+
+    // Compute the scaled hit distance.
+    t_scaled =
+          w0 * (ray_info.m_sz * a[kz])
+        + w1 * (ray_info.m_sz * b[kz])
+        + w2 * (ray_info.m_sz * c[kz]);
+
+    u_scaled = w1;
+    v_scaled = w2;
+
+    return true;
+}
+
+template <typename T>
+template <typename U>
+APPLESEED_FORCE_INLINE bool TriangleWT<T>::intersect(
+    const Ray<U, 3>&        ray,
+    const RayInfo&          ray_info,
+    ValueType&              t,
+    ValueType&              u,
+    ValueType&              v) const
+{
+    ValueType det, t_scaled, u_scaled, v_scaled;
+    if (!compute_scaled_hit(ray_info, det, t_scaled, u_scaled, v_scaled))
+        return false;
+
+    // Calculate t parameter and test bounds.
+    const ValueType rcp_det = ValueType(1.0) / det;
+    t = t_scaled * rcp_det;
+    if (t >= ray.m_tmax || t < ray.m_tmin)
+        return false;
+
+    // Calculate u and v parameters.
+    u = u_scaled * rcp_det;
+    v = v_scaled * rcp_det;
+
+    // Ray intersects triangle.
+    return true;
+}
+
+template <typename T>
+template <typename U>
+APPLESEED_FORCE_INLINE bool TriangleWT<T>::intersect(
+    const Ray<U, 3>&        ray,
+    const RayInfo&          ray_info) const
+{
+    ValueType det, t_scaled, u_scaled, v_scaled;
+    if (!compute_scaled_hit(ray_info, det, t_scaled, u_scaled, v_scaled))
+        return false;
+
+    // Calculate t parameter and test bounds.
+    const ValueType t = t_scaled / det;
+    return t >= ray.m_tmin && t < ray.m_tmax;
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_INTERSECTION_RAYTRIANGLEWT_H
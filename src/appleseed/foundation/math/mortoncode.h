@@ -0,0 +1,79 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_MORTONCODE_H
+#define APPLESEED_FOUNDATION_MATH_MORTONCODE_H
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+
+namespace foundation
+{
+
+//
+// Morton codes (Z-order curve) of points of the 2D integer grid.
+//
+// Points that are close along the Z-order curve are close in space, hence sorting
+// points by Morton code groups nearby points together.
+//
+
+// Return the 32-bit Morton code of a point of the integer grid [0, 65535]^2.
+uint32 morton_code(const uint32 x, const uint32 y);
+
+
+//
+// Implementation.
+//
+
+namespace morton_impl
+{
+    // Insert a zero bit after each of the 16 lowest bits of an integer.
+    inline uint32 spread_bits(uint32 x)
+    {
+        assert(x < 65536);
+
+        x = (x | (x << 8)) & 0x00FF00FFu;
+        x = (x | (x << 4)) & 0x0F0F0F0Fu;
+        x = (x | (x << 2)) & 0x33333333u;
+        x = (x | (x << 1)) & 0x55555555u;
+
+        return x;
+    }
+}
+
+inline uint32 morton_code(const uint32 x, const uint32 y)
+{
+    return (morton_impl::spread_bits(y) << 1) | morton_impl::spread_bits(x);
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_MORTONCODE_H
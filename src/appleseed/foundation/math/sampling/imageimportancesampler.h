@@ -35,14 +35,15 @@
 #include "foundation/image/color.h"
 #include "foundation/image/colorspace.h"
 #include "foundation/image/image.h"
-#include "foundation/math/cdf.h"
+#include "foundation/math/aliastable.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/utility/job/iabortswitch.h"
 
 // Standard headers.
+#include <cassert>
 #include <cstddef>
-#include <utility>
+#include <vector>
 
 namespace foundation
 {
@@ -60,6 +61,9 @@ namespace foundation
 //           Importance&    importance);
 //   };
 //
+// Rows and columns are selected using alias tables, so sampling the image
+// takes constant time regardless of its resolution.
+//
 
 template <typename Payload, typename Importance>
 class ImageImportanceSampler
@@ -73,15 +77,28 @@ class ImageImportanceSampler
         const size_t        width,
         const size_t        height);
 
-    // Destructor.
-    ~ImageImportanceSampler();
+    // Return the dimensions of the image.
+    size_t get_width() const;
+    size_t get_height() const;
 
-    // Resample the image and rebuild the CDFs.
+    // Resample the image and rebuild the alias tables.
     template <typename ImageSampler>
     void rebuild(
         ImageSampler&       sampler,
         IAbortSwitch*       abort_switch = 0);
 
+    // Resample rows [row_begin, row_end) of the image. Disjoint ranges of rows
+    // may be resampled concurrently. prepare() must be called once all rows
+    // have been resampled.
+    template <typename ImageSampler>
+    void rebuild_rows(
+        ImageSampler&       sampler,
+        const size_t        row_begin,
+        const size_t        row_end);
+
+    // Build the row alias table once all rows have been resampled.
+    void prepare();
+
     // Sample the image and return the coordinates of the chosen pixel
     // and its probability density.
     void sample(
@@ -105,15 +122,15 @@ class ImageImportanceSampler
         const size_t        y) const;
 
   private:
-    typedef CDF<size_t, Importance> RowCDF;
-    typedef CDF<Payload, Importance> ColCDF;
+    typedef AliasTable<Importance> Table;
 
     const size_t            m_width;
     const size_t            m_height;
     const Importance        m_rcp_pixel_count;
 
-    ColCDF*                 m_cols_cdf;
-    RowCDF                  m_rows_cdf;
+    std::vector<Payload>    m_payloads;
+    std::vector<Table>      m_cols_tables;
+    Table                   m_rows_table;
 };
 
 
@@ -146,14 +163,21 @@ ImageImportanceSampler<Payload, Importance>::ImageImportanceSampler(
   : m_width(width)
   , m_height(height)
   , m_rcp_pixel_count(Importance(1.0) / (width * height))
+  , m_payloads(width * height)
+  , m_cols_tables(height)
+{
+}
+
+template <typename Payload, typename Importance>
+inline size_t ImageImportanceSampler<Payload, Importance>::get_width() const
 {
-    m_cols_cdf = new ColCDF[m_height];
+    return m_width;
 }
 
 template <typename Payload, typename Importance>
-ImageImportanceSampler<Payload, Importance>::~ImageImportanceSampler()
+inline size_t ImageImportanceSampler<Payload, Importance>::get_height() const
 {
-    delete [] m_cols_cdf;
+    return m_height;
 }
 
 template <typename Payload, typename Importance>
@@ -162,38 +186,60 @@ void ImageImportanceSampler<Payload, Importance>::rebuild(
     ImageSampler&           sampler,
     IAbortSwitch*           abort_switch)
 {
-    m_rows_cdf.clear();
-    m_rows_cdf.reserve(m_height);
+    m_rows_table.clear();
 
     for (size_t y = 0, ye = m_height; y < ye; ++y)
     {
         if (is_aborted(abort_switch))
-        {
-            m_rows_cdf.clear();
-            break;
-        }
+            return;
 
-        m_cols_cdf[y].clear();
-        m_cols_cdf[y].reserve(m_width);
+        rebuild_rows(sampler, y, y + 1);
+    }
+
+    prepare();
+}
+
+template <typename Payload, typename Importance>
+template <typename ImageSampler>
+void ImageImportanceSampler<Payload, Importance>::rebuild_rows(
+    ImageSampler&           sampler,
+    const size_t            row_begin,
+    const size_t            row_end)
+{
+    assert(row_begin <= row_end);
+    assert(row_end <= m_height);
+
+    for (size_t y = row_begin; y < row_end; ++y)
+    {
+        Table& cols_table = m_cols_tables[y];
+        Payload* payloads = &m_payloads[y * m_width];
+
+        cols_table.clear();
+        cols_table.reserve(m_width);
 
         for (size_t x = 0, xe = m_width; x < xe; ++x)
         {
-            Payload payload;
             Importance importance;
-
-            sampler.sample(x, y, payload, importance);
-
-            m_cols_cdf[y].insert(payload, importance);
+            sampler.sample(x, y, payloads[x], importance);
+            cols_table.insert(importance);
         }
 
-        if (m_cols_cdf[y].valid())
-            m_cols_cdf[y].prepare();
-
-        m_rows_cdf.insert(y, m_cols_cdf[y].weight());
+        if (cols_table.valid())
+            cols_table.prepare();
     }
+}
 
-    if (m_rows_cdf.valid())
-        m_rows_cdf.prepare();
+template <typename Payload, typename Importance>
+void ImageImportanceSampler<Payload, Importance>::prepare()
+{
+    m_rows_table.clear();
+    m_rows_table.reserve(m_height);
+
+    for (size_t y = 0, ye = m_height; y < ye; ++y)
+        m_rows_table.insert(m_cols_tables[y].weight());
+
+    if (m_rows_table.valid())
+        m_rows_table.prepare();
 }
 
 template <typename Payload, typename Importance>
@@ -203,19 +249,19 @@ inline void ImageImportanceSampler<Payload, Importance>::sample(
     size_t&                 y,
     Importance&             probability) const
 {
-    if (m_rows_cdf.valid())
+    if (m_rows_table.valid())
     {
         // Select a row.
-        const typename RowCDF::ItemWeightPair& row = m_rows_cdf.sample(s[1]);
-        assert(row.second != Importance(0.0));
-        y = row.first;
+        Importance row_prob;
+        y = m_rows_table.sample(s[1], row_prob);
+        assert(row_prob != Importance(0.0));
 
         // Select a column within this row.
-        const typename ColCDF::ItemWeightPair& col = m_cols_cdf[y].sample(s[0]);
-        assert(col.second != Importance(0.0));
-        x = &col - &m_cols_cdf[y][0];
+        Importance col_prob;
+        x = m_cols_tables[y].sample(s[0], col_prob);
+        assert(col_prob != Importance(0.0));
 
-        probability = row.second * col.second;
+        probability = row_prob * col_prob;
     }
     else
     {
@@ -237,32 +283,8 @@ inline void ImageImportanceSampler<Payload, Importance>::sample(
     Payload&                payload,
     Importance&             probability) const
 {
-    if (m_rows_cdf.valid())
-    {
-        // Select a row.
-        const typename RowCDF::ItemWeightPair& row = m_rows_cdf.sample(s[1]);
-        assert(row.second != Importance(0.0));
-        y = row.first;
-
-        // Select a column within this row.
-        const typename ColCDF::ItemWeightPair& col = m_cols_cdf[y].sample(s[0]);
-        assert(col.second != Importance(0.0));
-        x = &col - &m_cols_cdf[y][0];
-
-        payload = col.first;
-        probability = row.second * col.second;
-    }
-    else
-    {
-        // Uniform random sampling.
-        x = truncate<size_t>(s[0] * m_width);
-        y = truncate<size_t>(s[1] * m_height);
-
-        payload = m_cols_cdf[y][x].first;
-        probability = m_rcp_pixel_count;
-    }
-
-    assert(probability > Importance(0.0));
+    sample(s, x, y, probability);
+    payload = m_payloads[y * m_width + x];
 }
 
 template <typename Payload, typename Importance>
@@ -270,18 +292,17 @@ inline Importance ImageImportanceSampler<Payload, Importance>::get_pdf(
     const size_t            x,
     const size_t            y) const
 {
-    if (m_rows_cdf.valid())
+    assert(x < m_width);
+    assert(y < m_height);
+
+    if (m_rows_table.valid())
     {
-        if (m_cols_cdf[y].valid())
-        {
-            const typename RowCDF::ItemWeightPair& row = m_rows_cdf[y];
-            const typename ColCDF::ItemWeightPair& col = m_cols_cdf[y][x];
-            return row.second * col.second;
-        }
-        else
-        {
-            return Importance(0.0);
-        }
+        const Table& cols_table = m_cols_tables[y];
+
+        return
+            cols_table.valid()
+                ? m_rows_table.get_probability(y) * cols_table.get_probability(x)
+                : Importance(0.0);
     }
     else
     {
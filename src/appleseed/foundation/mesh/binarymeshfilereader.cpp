@@ -39,9 +39,14 @@
 #include "foundation/utility/bufferedfile.h"
 #include "foundation/utility/memory.h"
 
+// lz4 headers.
+#include "lz4.h"
+
 // Standard headers.
+#include <algorithm>
+#include <cassert>
 #include <cstring>
-#include <memory>
+#include <vector>
 
 using namespace std;
 
@@ -76,15 +81,182 @@ namespace
     {
         checked_read(file, &object, sizeof(T));
     }
+
+    enum FormatVersion
+    {
+        Uncompressed = 1,
+        LZOCompressed = 2,
+        LZ4Compressed = 3
+    };
+
+    void check_format_version(const uint16 version)
+    {
+        switch (version)
+        {
+          case Uncompressed:
+          case LZ4Compressed:
+            break;
+
+          case LZOCompressed:
+            throw ExceptionIOError(
+                "binarymesh format version 2 is no longer supported; "
+                "please use the convertmeshfile tool that ships with appleseed 1.1.0 alpha-21 or earlier");
+
+          default:
+            throw ExceptionIOError("unknown binarymesh format version");
+        }
+    }
+
+    // Reads data from a memory block.
+    class MemoryReaderAdapter
+      : public ReaderAdapter
+    {
+      public:
+        MemoryReaderAdapter(const char* data, const size_t size)
+          : m_ptr(data)
+          , m_end(data + size)
+        {
+        }
+
+        virtual size_t read(
+            void*               outbuf,
+            const size_t        size) override
+        {
+            const size_t bytes_read = min(size, static_cast<size_t>(m_end - m_ptr));
+            memcpy(outbuf, m_ptr, bytes_read);
+            m_ptr += bytes_read;
+            return bytes_read;
+        }
+
+        // Skip a given number of bytes and return a pointer to them.
+        const char* skip(const size_t size)
+        {
+            if (size > static_cast<size_t>(m_end - m_ptr))
+                throw ExceptionIOError();
+
+            const char* ptr = m_ptr;
+            m_ptr += size;
+            return ptr;
+        }
+
+      private:
+        const char*             m_ptr;
+        const char*             m_end;
+    };
+
+    // Decompresses LZ4-compressed blocks straight from a memory block,
+    // following the layout of foundation::LZ4CompressedWriterAdapter.
+    class LZ4MemoryReaderAdapter
+      : public ReaderAdapter
+    {
+      public:
+        explicit LZ4MemoryReaderAdapter(MemoryReaderAdapter& source)
+          : m_source(source)
+          , m_buffer_index(0)
+          , m_buffer_end(0)
+        {
+        }
+
+        virtual size_t read(
+            void*               outbuf,
+            const size_t        size) override
+        {
+            size_t remaining = size;
+
+            while (remaining > 0)
+            {
+                if (m_buffer_index == m_buffer_end)
+                {
+                    if (!fill_buffer())
+                        break;
+                }
+
+                const size_t copy = min(remaining, m_buffer_end - m_buffer_index);
+                memcpy(outbuf, &m_buffer[m_buffer_index], copy);
+
+                outbuf = reinterpret_cast<uint8*>(outbuf) + copy;
+                m_buffer_index += copy;
+                remaining -= copy;
+            }
+
+            return size - remaining;
+        }
+
+      private:
+        MemoryReaderAdapter&    m_source;
+        vector<uint8>           m_buffer;
+        size_t                  m_buffer_index;
+        size_t                  m_buffer_end;
+
+        bool fill_buffer()
+        {
+            uint64 buffer_size;
+            if (m_source.read(&buffer_size, sizeof(buffer_size)) == 0)
+                return false;
+
+            uint64 compressed_buffer_size;
+            checked_read(m_source, compressed_buffer_size);
+
+            const char* compressed_buffer =
+                m_source.skip(static_cast<size_t>(compressed_buffer_size));
+
+            ensure_minimum_size(m_buffer, static_cast<size_t>(buffer_size));
+
+            if (buffer_size > 0 &&
+                LZ4_decompress_fast(
+                    compressed_buffer,
+                    reinterpret_cast<char*>(&m_buffer[0]),
+                    static_cast<int>(buffer_size)) != static_cast<int>(compressed_buffer_size))
+                throw ExceptionIOError();
+
+            m_buffer_index = 0;
+            m_buffer_end = static_cast<size_t>(buffer_size);
+
+            return true;
+        }
+    };
 }
 
 BinaryMeshFileReader::BinaryMeshFileReader(const string& filename)
   : m_filename(filename)
+  , m_data(0)
+  , m_size(0)
 {
 }
 
+BinaryMeshFileReader::BinaryMeshFileReader(
+    const string&       filename,
+    const char*         data,
+    const size_t        size)
+  : m_filename(filename)
+  , m_data(data)
+  , m_size(size)
+{
+    assert(data);
+}
+
 void BinaryMeshFileReader::read(IMeshBuilder& builder)
 {
+    if (m_data)
+    {
+        MemoryReaderAdapter memory(m_data, m_size);
+
+        read_and_check_signature(memory);
+
+        uint16 version;
+        checked_read(memory, version);
+        check_format_version(version);
+
+        if (version == LZ4Compressed)
+        {
+            LZ4MemoryReaderAdapter reader(memory);
+            read_meshes(reader, builder);
+        }
+        else read_meshes(memory, builder);
+
+        return;
+    }
+
     BufferedFile file(
         m_filename.c_str(),
         BufferedFile::BinaryType,
@@ -93,45 +265,28 @@ void BinaryMeshFileReader::read(IMeshBuilder& builder)
     if (!file.is_open())
         throw ExceptionIOError();
 
-    read_and_check_signature(file);
+    PassthroughReaderAdapter passthrough(file);
 
-    uint16 version;
-    checked_read(file, version);
+    read_and_check_signature(passthrough);
 
-    auto_ptr<ReaderAdapter> reader;
+    uint16 version;
+    checked_read(passthrough, version);
+    check_format_version(version);
 
-    switch (version)
+    if (version == LZ4Compressed)
     {
-      // Uncompressed.
-      case 1:
-        reader.reset(new PassthroughReaderAdapter(file));
-        break;
-
-      // LZO-compressed.
-      case 2:
-        throw ExceptionIOError(
-            "binarymesh format version 2 is no longer supported; "
-            "please use the convertmeshfile tool that ships with appleseed 1.1.0 alpha-21 or earlier");
-
-      // LZ4-compressed.
-      case 3:
-        reader.reset(new LZ4CompressedReaderAdapter(file));
-        break;
-
-      // Unknown format.
-      default:
-        throw ExceptionIOError("unknown binarymesh format version");
+        LZ4CompressedReaderAdapter reader(file);
+        read_meshes(reader, builder);
     }
-
-    read_meshes(*reader.get(), builder);
+    else read_meshes(passthrough, builder);
 }
 
-void BinaryMeshFileReader::read_and_check_signature(BufferedFile& file)
+void BinaryMeshFileReader::read_and_check_signature(ReaderAdapter& reader)
 {
     static const char ExpectedSig[10] = { 'B', 'I', 'N', 'A', 'R', 'Y', 'M', 'E', 'S', 'H' };
 
     char signature[sizeof(ExpectedSig)];
-    checked_read(file, signature, sizeof(signature));
+    checked_read(reader, signature, sizeof(signature));
 
     if (memcmp(signature, ExpectedSig, sizeof(ExpectedSig)))
         throw ExceptionIOError("invalid binarymesh format signature");
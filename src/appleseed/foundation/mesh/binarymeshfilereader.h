@@ -40,7 +40,6 @@
 #include <vector>
 
 // Forward declarations.
-namespace foundation    { class BufferedFile; }
 namespace foundation    { class IMeshBuilder; }
 namespace foundation    { class ReaderAdapter; }
 
@@ -58,16 +57,26 @@ class BinaryMeshFileReader
     // Constructor.
     explicit BinaryMeshFileReader(const std::string& filename);
 
+    // Constructor for a mesh file already in memory, for instance in a memory-mapped
+    // pack file. The mesh is decoded directly from data, which must remain valid until
+    // read() returns. The file name is only used to report errors.
+    BinaryMeshFileReader(
+        const std::string&  filename,
+        const char*         data,
+        const size_t        size);
+
     // Read a mesh.
     virtual void read(IMeshBuilder& builder) override;
 
   private:
     const std::string       m_filename;
+    const char*             m_data;
+    const size_t            m_size;
     std::vector<size_t>     m_vertices;
     std::vector<size_t>     m_vertex_normals;
     std::vector<size_t>     m_tex_coords;
 
-    static void read_and_check_signature(BufferedFile& file);
+    static void read_and_check_signature(ReaderAdapter& reader);
 
     static std::string read_string(ReaderAdapter& reader);
     void read_meshes(ReaderAdapter& reader, IMeshBuilder& builder);
@@ -33,7 +33,6 @@
 // appleseed.foundation headers.
 #include "foundation/mesh/objmeshfilereader.h"
 #include "foundation/platform/compiler.h"
-#include "foundation/utility/bufferedfile.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
@@ -41,7 +40,7 @@
 #include <cctype>
 #include <cstddef>
 #include <cstdlib>
-#include <string>
+#include <cstring>
 #include <vector>
 
 namespace foundation
@@ -50,6 +49,10 @@ namespace foundation
 //
 // A lexical analyzer for the OBJ file format.
 //
+// The lexer reads a range of characters in memory, typically a newline-aligned
+// portion of a memory-mapped file. Line numbers are relative to the beginning of
+// the range.
+//
 
 class OBJMeshFileLexer
 {
@@ -63,6 +66,9 @@ class OBJMeshFileLexer
     // Constructor.
     explicit OBJMeshFileLexer(const ParsingMode parsing_mode = Precise)
       : m_parsing_mode(parsing_mode)
+      , m_is_open(false)
+      , m_ptr(0)
+      , m_end(0)
       , m_eof(false)
       , m_line_number(0)
       , m_line(4096)
@@ -74,38 +80,32 @@ class OBJMeshFileLexer
             m_is_space[i] = std::isspace(i) != 0;
     }
 
-    // Open an input file.
-    // Return true on success, false on error.
-    bool open(const std::string& filename)
+    // Start reading a range of characters.
+    void open(const char* begin, const char* end)
     {
+        assert(begin <= end);
+
+        m_is_open = true;
+        m_ptr = begin;
+        m_end = end;
         m_eof = false;
         m_line_number = 0;
         m_line_size = 0;
         m_line_index = 0;
 
-        m_file.open(
-            filename.c_str(),
-            BufferedFile::TextType,
-            BufferedFile::ReadMode);
-
-        if (!m_file.is_open())
-            return false;
-
         read_next_line();
-
-        return true;
     }
 
-    // Close the input file.
+    // Stop reading.
     void close()
     {
-        m_file.close();
+        m_is_open = false;
     }
 
     // Return the position of the current line in the file.
     size_t get_line_number() const
     {
-        assert(m_file.is_open());
+        assert(m_is_open);
 
         return m_line_number;
     }
@@ -113,7 +113,7 @@ class OBJMeshFileLexer
     // Return the current character in the line.
     APPLESEED_FORCE_INLINE unsigned char get_char() const
     {
-        assert(m_file.is_open());
+        assert(m_is_open);
 
         return m_line_index == m_line_size ? '\n' : m_line[m_line_index];
     }
@@ -121,7 +121,7 @@ class OBJMeshFileLexer
     // Advance to the next character in the line.
     APPLESEED_FORCE_INLINE void next_char()
     {
-        assert(m_file.is_open());
+        assert(m_is_open);
 
         if (m_line_index < m_line_size)
             ++m_line_index;
@@ -141,7 +141,7 @@ class OBJMeshFileLexer
     // Return true if the end of the line has been reached.
     APPLESEED_FORCE_INLINE bool is_eol() const
     {
-        assert(m_file.is_open());
+        assert(m_is_open);
 
         return m_line_index == m_line_size;
     }
@@ -149,7 +149,7 @@ class OBJMeshFileLexer
     // Return true if the end of the file has been reached.
     APPLESEED_FORCE_INLINE bool is_eof() const
     {
-        assert(m_file.is_open());
+        assert(m_is_open);
 
         return m_eof && is_eol();
     }
@@ -157,7 +157,7 @@ class OBJMeshFileLexer
     // Eat blank characters and comments.
     void eat_blanks()
     {
-        assert(m_file.is_open());
+        assert(m_is_open);
 
         while (true)
         {
@@ -192,7 +192,7 @@ class OBJMeshFileLexer
     // Accept a end-of-line character, or generate a parse error.
     void accept_newline()
     {
-        assert(m_file.is_open());
+        assert(m_is_open);
 
         if (!is_eol())
             parse_error();
@@ -203,7 +203,7 @@ class OBJMeshFileLexer
     // Accept a string of non-blank characters, or generate a parse error.
     void accept_string(const char** begin, size_t* length)
     {
-        assert(m_file.is_open());
+        assert(m_is_open);
 
         if (is_eof())
             parse_error();
@@ -236,7 +236,7 @@ class OBJMeshFileLexer
     // Accept a long integer, or generate a parse error.
     APPLESEED_FORCE_INLINE long accept_long()
     {
-        assert(m_file.is_open());
+        assert(m_is_open);
 
         // Read an integer value at the current position in the line.
         const char* base_ptr = &m_line[0];
@@ -255,7 +255,7 @@ class OBJMeshFileLexer
     // Accept a double-precision floating point number, or generate a parse error.
     APPLESEED_FORCE_INLINE double accept_double()
     {
-        assert(m_file.is_open());
+        assert(m_is_open);
 
         // Read a floating-point value at the current position in the line.
         char* base_ptr = &m_line[0];
@@ -278,24 +278,26 @@ class OBJMeshFileLexer
   private:
     const ParsingMode   m_parsing_mode;     // parsing mode for floating-point values
     bool                m_is_space[256];    // precomputed values of std::isspace(c) for all c
-    BufferedFile        m_file;
-    bool                m_eof;              // has the end of the file been reached?
+    bool                m_is_open;
+    const char*         m_ptr;              // beginning of the next line in the input range
+    const char*         m_end;              // end of the input range
+    bool                m_eof;              // has the end of the input range been reached?
     size_t              m_line_number;      // position of the current line in the file
     std::vector<char>   m_line;             // current line
     size_t              m_line_size;        // size of the current line (not counting the zero terminator)
     size_t              m_line_index;       // position of the cursor in the current line
 
-    // Close the input file and throw an ExceptionParseError exception.
+    // Stop reading and throw an ExceptionParseError exception.
     void parse_error()
     {
-        m_file.close();
+        close();
         throw OBJMeshFileReader::ExceptionParseError(m_line_number);
     }
 
-    // Read the next line from the input file.
+    // Read the next line from the input range.
     void read_next_line()
     {
-        assert(m_file.is_open());
+        assert(m_is_open);
 
         m_line_size = 0;
 
@@ -303,24 +305,27 @@ class OBJMeshFileLexer
         {
             ++m_line_number;
 
-            while (m_line_size < m_line.size() - 1)
+            // Find the end of the line.
+            const char* line_end =
+                m_ptr < m_end
+                    ? static_cast<const char*>(std::memchr(m_ptr, '\n', m_end - m_ptr))
+                    : 0;
+
+            if (line_end == 0)
             {
-                // Read one character from the file.
-                char c;
-                if (m_file.read(&c) < 1)
-                {
-                    // Reached the end of the file.
-                    m_eof = true;
-                    break;
-                }
-
-                // Stop as soon as the end of the line is reached.
-                if (c == '\n')
-                    break;
-
-                // Append the character to the line.
-                m_line[m_line_size++] = c;
+                // Reached the end of the input range.
+                line_end = m_end;
+                m_eof = true;
             }
+
+            // Copy the line, growing the line buffer if necessary.
+            m_line_size = line_end - m_ptr;
+            if (m_line_size >= m_line.size())
+                m_line.resize(m_line_size + 1);
+            if (m_line_size > 0)
+                std::memcpy(&m_line[0], m_ptr, m_line_size);
+
+            m_ptr = m_eof ? m_end : line_end + 1;
         }
 
         // Append a null terminator.
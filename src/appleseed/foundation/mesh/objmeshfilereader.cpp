@@ -35,11 +35,19 @@
 #include "foundation/math/vector.h"
 #include "foundation/mesh/imeshbuilder.h"
 #include "foundation/mesh/objmeshfilelexer.h"
+#include "foundation/platform/memorymappedfile.h"
+#include "foundation/platform/system.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/memory.h"
 
+// Boost headers.
+#include "boost/thread/thread.hpp"
+
 // Standard headers.
+#include <algorithm>
 #include <cstring>
 #include <map>
+#include <new>
 #include <utility>
 #include <vector>
 
@@ -51,17 +59,470 @@ namespace foundation
 //
 // OBJMeshFileReader class implementation.
 //
+// The file is mapped into memory and split into newline-aligned chunks which are
+// parsed in parallel. Parsing a chunk only collects vertices, texture coordinates,
+// normals, faces (with their indices as they appear in the file) and statements
+// that change the current object or material. Chunks are then replayed in order,
+// on the calling thread, to resolve indices and to feed the mesh builder exactly
+// as if the file had been parsed sequentially.
+//
 
 namespace
 {
     const size_t Undefined = ~0;
+
+    // Minimum size in bytes of a chunk when the number of threads is chosen automatically.
+    const size_t MinChunkSize = 8 * 1024 * 1024;
+
+    // A face, as it appears in the file.
+    struct ChunkFace
+    {
+        size_t  m_line_number;                  // line of the face statement, relative to the chunk
+        uint32  m_vertex_count;
+        uint32  m_tex_coord_count;
+        uint32  m_normal_count;
+    };
+
+    // Number of features defined in a chunk before a given face.
+    struct ChunkFeatureCounts
+    {
+        size_t  m_face_index;
+        size_t  m_vertex_count;
+        size_t  m_tex_coord_count;
+        size_t  m_normal_count;
+    };
+
+    // An o, g or usemtl statement, preceding a given face.
+    struct ChunkStatement
+    {
+        enum Type
+        {
+            ObjectOrGroup,
+            UseMaterial
+        };
+
+        Type    m_type;
+        size_t  m_face_index;
+        string  m_name;
+    };
+
+    struct Chunk
+    {
+        const char*                 m_begin;
+        const char*                 m_end;
+
+        // Features defined in the chunk.
+        vector<Vector3d>            m_vertices;
+        vector<Vector2d>            m_tex_coords;
+        vector<Vector3d>            m_normals;
+
+        // Faces defined in the chunk, and their vertex, texture coordinate and normal indices.
+        vector<ChunkFace>           m_faces;
+        vector<long>                m_face_indices;
+
+        // Feature counts, recorded each time they change before a face.
+        vector<ChunkFeatureCounts>  m_feature_counts;
+
+        // Statements changing the current mesh or material.
+        vector<ChunkStatement>      m_statements;
+
+        // Parsing errors. Parsing stops at the first error.
+        bool                        m_parse_error;
+        size_t                      m_parse_error_line_number;
+        bool                        m_out_of_memory;
+
+        Chunk(const char* begin, const char* end)
+          : m_begin(begin)
+          , m_end(end)
+          , m_parse_error(false)
+          , m_parse_error_line_number(0)
+          , m_out_of_memory(false)
+        {
+        }
+    };
+
+    // Split a range of characters into chunks of roughly equal sizes, ending on line boundaries.
+    void split_into_chunks(
+        const char*                 begin,
+        const char*                 end,
+        const size_t                chunk_count,
+        vector<Chunk>&              chunks)
+    {
+        const size_t size = end - begin;
+        const char* chunk_begin = begin;
+
+        for (size_t i = 1; i <= chunk_count; ++i)
+        {
+            const char* chunk_end = end;
+
+            if (i < chunk_count)
+            {
+                const char* split = max(begin + (size * i) / chunk_count, chunk_begin);
+                const char* newline =
+                    split < end
+                        ? static_cast<const char*>(memchr(split, '\n', end - split))
+                        : 0;
+                if (newline)
+                    chunk_end = newline + 1;
+            }
+
+            chunks.push_back(Chunk(chunk_begin, chunk_end));
+            chunk_begin = chunk_end;
+        }
+    }
+
+    // Parse a chunk. Can be run concurrently on distinct chunks.
+    class ChunkParser
+    {
+      public:
+        ChunkParser(
+            const int               options,
+            Chunk&                  chunk)
+          : m_chunk(chunk)
+          , m_lexer(
+                (options & OBJMeshFileReader::FavorSpeedOverPrecision)
+                    ? OBJMeshFileLexer::Fast
+                    : OBJMeshFileLexer::Precise)
+        {
+        }
+
+        void operator()()
+        {
+            try
+            {
+                m_lexer.open(m_chunk.m_begin, m_chunk.m_end);
+                parse_chunk();
+                m_lexer.close();
+            }
+            catch (const OBJMeshFileReader::ExceptionParseError& e)
+            {
+                m_chunk.m_parse_error = true;
+                m_chunk.m_parse_error_line_number = e.m_line;
+            }
+            catch (const bad_alloc&)
+            {
+                m_chunk.m_out_of_memory = true;
+            }
+        }
+
+      private:
+        Chunk&                      m_chunk;
+        OBJMeshFileLexer            m_lexer;
+
+        void parse_chunk()
+        {
+            while (true)
+            {
+                m_lexer.eat_blanks();
+
+                // Handle end of chunk.
+                if (m_lexer.is_eof())
+                    break;
+
+                // Handle empty lines.
+                if (m_lexer.is_eol())
+                {
+                    m_lexer.accept_newline();
+                    continue;
+                }
+
+                const char* keyword;
+                size_t keyword_length;
+
+                m_lexer.accept_string(&keyword, &keyword_length);
+
+                if (keyword_length == 1)
+                {
+                    switch (keyword[0])
+                    {
+                      case 'f':
+                        parse_f_statement();
+                        break;
+
+                      case 'g':
+                      case 'o':
+                        parse_statement(ChunkStatement::ObjectOrGroup);
+                        break;
+
+                      case 'v':
+                        parse_v_statement();
+                        break;
+
+                      default:
+                        // Ignore unknown or unhandled statements.
+                        m_lexer.eat_line();
+                        continue;
+                    }
+                }
+                else if (keyword_length == 2)
+                {
+                    switch (keyword[0] * 256 + keyword[1])
+                    {
+                      case 'v' * 256 + 'n':
+                        parse_vn_statement();
+                        break;
+
+                      case 'v' * 256 + 't':
+                        parse_vt_statement();
+                        break;
+
+                      default:
+                        // Ignore unknown or unhandled statements.
+                        m_lexer.eat_line();
+                        continue;
+                    }
+                }
+                else if (strncmp(keyword, "usemtl", keyword_length) == 0)
+                {
+                    parse_statement(ChunkStatement::UseMaterial);
+                }
+                else
+                {
+                    // Ignore unknown or unhandled statements.
+                    m_lexer.eat_line();
+                    continue;
+                }
+
+                m_lexer.eat_blanks();
+                m_lexer.accept_newline();
+            }
+        }
+
+        void parse_f_statement()
+        {
+            ChunkFace face;
+            face.m_line_number = m_lexer.get_line_number();
+            face.m_vertex_count = 0;
+            face.m_tex_coord_count = 0;
+            face.m_normal_count = 0;
+
+            // Texture coordinate and normal indices are appended after vertex indices.
+            vector<long>& indices = m_chunk.m_face_indices;
+            clear_keep_memory(m_tex_coord_indices);
+            clear_keep_memory(m_normal_indices);
+
+            while (true)
+            {
+                m_lexer.eat_blanks();
+
+                if (m_lexer.is_eol())
+                    break;
+
+                //
+                // Recognized (epsilon)
+                // Accept n
+                //
+
+                indices.push_back(m_lexer.accept_long());
+                ++face.m_vertex_count;
+
+                //
+                // Recognized n
+                // Accept (epsilon), /
+                //
+
+                {
+                    const unsigned char c = m_lexer.get_char();
+                    if (m_lexer.is_space(c))
+                        continue;
+                    else if (c == '/')
+                        m_lexer.next_char();
+                    else parse_error();
+                }
+
+                //
+                // Recognized n/
+                // Accept /, n
+                //
+
+                {
+                    const unsigned char c = m_lexer.get_char();
+                    if (c == '/')
+                    {
+                        m_lexer.next_char();
+                        goto skip;
+                    }
+                    else m_tex_coord_indices.push_back(m_lexer.accept_long());
+                }
+
+                //
+                // Recognized n/n
+                // Accept (epsilon), /
+                //
+
+                {
+                    const unsigned char c = m_lexer.get_char();
+                    if (m_lexer.is_space(c))
+                        continue;
+                    else if (c == '/')
+                        m_lexer.next_char();
+                    else parse_error();
+                }
+
+              skip:
+
+                //
+                // Recognized n//, n/n/
+                // Accept (epsilon), n
+                //
+
+                {
+                    const unsigned char c = m_lexer.get_char();
+                    if (m_lexer.is_space(c))
+                        continue;
+                    else m_normal_indices.push_back(m_lexer.accept_long());
+                }
+            }
+
+            face.m_tex_coord_count = static_cast<uint32>(m_tex_coord_indices.size());
+            face.m_normal_count = static_cast<uint32>(m_normal_indices.size());
+
+            indices.insert(indices.end(), m_tex_coord_indices.begin(), m_tex_coord_indices.end());
+            indices.insert(indices.end(), m_normal_indices.begin(), m_normal_indices.end());
+
+            record_feature_counts();
+
+            m_chunk.m_faces.push_back(face);
+        }
+
+        // Record the number of features defined so far if it changed since the last face.
+        void record_feature_counts()
+        {
+            const size_t vertex_count = m_chunk.m_vertices.size();
+            const size_t tex_coord_count = m_chunk.m_tex_coords.size();
+            const size_t normal_count = m_chunk.m_normals.size();
+
+            if (!m_chunk.m_feature_counts.empty())
+            {
+                const ChunkFeatureCounts& last = m_chunk.m_feature_counts.back();
+
+                if (last.m_vertex_count == vertex_count &&
+                    last.m_tex_coord_count == tex_coord_count &&
+                    last.m_normal_count == normal_count)
+                    return;
+            }
+
+            ChunkFeatureCounts counts;
+            counts.m_face_index = m_chunk.m_faces.size();
+            counts.m_vertex_count = vertex_count;
+            counts.m_tex_coord_count = tex_coord_count;
+            counts.m_normal_count = normal_count;
+
+            m_chunk.m_feature_counts.push_back(counts);
+        }
+
+        // Stop reading and throw an ExceptionParseError exception.
+        void parse_error()
+        {
+            const size_t line_number = m_lexer.get_line_number();
+
+            m_lexer.close();
+
+            throw OBJMeshFileReader::ExceptionParseError(line_number);
+        }
+
+        void parse_statement(const ChunkStatement::Type type)
+        {
+            ChunkStatement statement;
+            statement.m_type = type;
+            statement.m_face_index = m_chunk.m_faces.size();
+
+            m_lexer.eat_blanks();
+
+            while (!m_lexer.is_eol())
+            {
+                const char* token;
+                size_t token_length;
+
+                m_lexer.accept_string(&token, &token_length);
+                m_lexer.eat_blanks();
+
+                if (!statement.m_name.empty())
+                    statement.m_name += ' ';
+
+                statement.m_name.append(token, token_length);
+            }
+
+            m_chunk.m_statements.push_back(statement);
+        }
+
+        void parse_v_statement()
+        {
+            Vector3d v;
+
+            m_lexer.eat_blanks();
+            v.x = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+            v.y = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+            v.z = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+
+            if (!m_lexer.is_eol())
+                m_lexer.accept_double();
+
+            m_chunk.m_vertices.push_back(v);
+        }
+
+        void parse_vt_statement()
+        {
+            Vector2d v;
+
+            m_lexer.eat_blanks();
+            v.x = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+            v.y = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+
+            if (!m_lexer.is_eol())
+                m_lexer.accept_double();
+
+            m_chunk.m_tex_coords.push_back(v);
+        }
+
+        void parse_vn_statement()
+        {
+            Vector3d n;
+
+            m_lexer.eat_blanks();
+            n.x = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+            n.y = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+            n.z = m_lexer.accept_double();
+
+            m_chunk.m_normals.push_back(n);
+        }
+
+        vector<long>                m_tex_coord_indices;
+        vector<long>                m_normal_indices;
+    };
+
+    template <typename T>
+    void append(vector<T>& dest, vector<T>& src)
+    {
+        if (dest.empty())
+            dest.swap(src);
+        else
+        {
+            dest.insert(dest.end(), src.begin(), src.end());
+            clear_release_memory(src);
+        }
+    }
 }
 
 struct OBJMeshFileReader::Impl
 {
     const int               m_options;
     IMeshBuilder&           m_builder;
-    OBJMeshFileLexer        m_lexer;
+    const char*             m_file_begin;
 
     // Current state.
     bool                    m_inside_mesh_def;              // currently inside a mesh definition?
@@ -79,7 +540,7 @@ struct OBJMeshFileReader::Impl
     vector<size_t>          m_tex_coord_index_mapping;
     vector<size_t>          m_normal_index_mapping;
 
-    // Temporary vectors for collecting indices while parsing face statements.
+    // Temporary vectors for collecting indices while replaying face statements.
     vector<size_t>          m_face_vertex_indices;
     vector<size_t>          m_face_tex_coord_indices;
     vector<size_t>          m_face_normal_indices;
@@ -87,104 +548,74 @@ struct OBJMeshFileReader::Impl
     // Constructor.
     Impl(
         const int           options,
-        IMeshBuilder&       builder)
+        IMeshBuilder&       builder,
+        const char*         file_begin)
       : m_options(options)
       , m_builder(builder)
-      , m_lexer(
-            (options & FavorSpeedOverPrecision)
-                ? OBJMeshFileLexer::Fast
-                : OBJMeshFileLexer::Precise)
+      , m_file_begin(file_begin)
       , m_inside_mesh_def(false)
       , m_current_material_slot_index(0)
     {
     }
 
-    // Close the input file and throw an ExceptionParseError exception.
-    void parse_error()
+    // Return the position in the file of a line of a chunk.
+    size_t get_line_number(const Chunk& chunk, const size_t line_number) const
     {
-        const size_t line_number = m_lexer.get_line_number();
-
-        m_lexer.close();
-
-        throw ExceptionParseError(line_number);
+        return
+              static_cast<size_t>(count(m_file_begin, chunk.m_begin, '\n'))
+            + line_number;
     }
 
-    void parse_file()
+    void parse_chunks(vector<Chunk>& chunks)
     {
-        while (true)
+        if (chunks.size() == 1)
+            ChunkParser(m_options, chunks[0])();
+        else
         {
-            m_lexer.eat_blanks();
-
-            // Handle end of file.
-            if (m_lexer.is_eof())
-                break;
+            boost::thread_group threads;
 
-            // Handle empty lines.
-            if (m_lexer.is_eol())
-            {
-                m_lexer.accept_newline();
-                continue;
-            }
+            for (size_t i = 0; i < chunks.size(); ++i)
+                threads.create_thread(ChunkParser(m_options, chunks[i]));
 
-            const char* keyword;
-            size_t keyword_length;
+            threads.join_all();
+        }
+    }
 
-            m_lexer.accept_string(&keyword, &keyword_length);
+    void replay_chunks(vector<Chunk>& chunks)
+    {
+        // Gather features.
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            const Chunk& chunk = chunks[i];
+            m_vertices.reserve(m_vertices.size() + chunk.m_vertices.size());
+            m_tex_coords.reserve(m_tex_coords.size() + chunk.m_tex_coords.size());
+            m_normals.reserve(m_normals.size() + chunk.m_normals.size());
+        }
 
-            if (keyword_length == 1)
-            {
-                switch (keyword[0])
-                {
-                  case 'f':
-                    parse_f_statement();
-                    break;
+        size_t vertex_base = 0;
+        size_t tex_coord_base = 0;
+        size_t normal_base = 0;
 
-                  case 'g':
-                  case 'o':
-                    parse_o_g_statement();
-                    break;
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            Chunk& chunk = chunks[i];
 
-                  case 'v':
-                    parse_v_statement();
-                    break;
+            const size_t vertex_count = chunk.m_vertices.size();
+            const size_t tex_coord_count = chunk.m_tex_coords.size();
+            const size_t normal_count = chunk.m_normals.size();
 
-                  default:
-                    // Ignore unknown or unhandled statements.
-                    m_lexer.eat_line();
-                    continue;
-                }
-            }
-            else if (keyword_length == 2)
-            {
-                switch (keyword[0] * 256 + keyword[1])
-                {
-                  case 'v' * 256 + 'n':
-                    parse_vn_statement();
-                    break;
+            append(m_vertices, chunk.m_vertices);
+            append(m_tex_coords, chunk.m_tex_coords);
+            append(m_normals, chunk.m_normals);
 
-                  case 'v' * 256 + 't':
-                    parse_vt_statement();
-                    break;
+            replay_chunk(chunk, vertex_base, tex_coord_base, normal_base);
 
-                  default:
-                    // Ignore unknown or unhandled statements.
-                    m_lexer.eat_line();
-                    continue;
-                }
-            }
-            else if (strncmp(keyword, "usemtl", keyword_length) == 0)
-            {
-                parse_usemtl_statement();
-            }
-            else
-            {
-                // Ignore unknown or unhandled statements.
-                m_lexer.eat_line();
-                continue;
-            }
+            clear_release_memory(chunk.m_faces);
+            clear_release_memory(chunk.m_face_indices);
 
-            m_lexer.eat_blanks();
-            m_lexer.accept_newline();
+            vertex_base += vertex_count;
+            tex_coord_base += tex_coord_count;
+            normal_base += normal_count;
         }
 
         // End the definition of the last object.
@@ -192,142 +623,126 @@ struct OBJMeshFileReader::Impl
             m_builder.end_mesh();
     }
 
-    void parse_f_statement()
+    void replay_chunk(
+        const Chunk&        chunk,
+        const size_t        vertex_base,
+        const size_t        tex_coord_base,
+        const size_t        normal_base)
     {
-        clear_keep_memory(m_face_vertex_indices);
-        clear_keep_memory(m_face_tex_coord_indices);
-        clear_keep_memory(m_face_normal_indices);
+        const size_t face_count = chunk.m_faces.size();
 
-        while (true)
+        const long* indices = chunk.m_face_indices.empty() ? 0 : &chunk.m_face_indices[0];
+        size_t counts_index = 0;
+        size_t statement_index = 0;
+
+        for (size_t i = 0; i < face_count; ++i)
         {
-            m_lexer.eat_blanks();
+            // Replay the statements preceding this face.
+            while (statement_index < chunk.m_statements.size() &&
+                   chunk.m_statements[statement_index].m_face_index == i)
+                replay_statement(chunk.m_statements[statement_index++]);
+
+            // Retrieve the number of features defined before this face.
+            while (counts_index + 1 < chunk.m_feature_counts.size() &&
+                   chunk.m_feature_counts[counts_index + 1].m_face_index <= i)
+                ++counts_index;
+
+            const ChunkFeatureCounts& counts = chunk.m_feature_counts[counts_index];
+            const ChunkFace& face = chunk.m_faces[i];
 
-            if (m_lexer.is_eol())
-                break;
+            const size_t line_number = face.m_line_number;
+            const size_t vc = face.m_vertex_count;
+            const size_t tc = face.m_tex_coord_count;
+            const size_t nc = face.m_normal_count;
 
-            //
-            // Recognized (epsilon)
-            // Accept n
-            //
+            clear_keep_memory(m_face_vertex_indices);
+            clear_keep_memory(m_face_tex_coord_indices);
+            clear_keep_memory(m_face_normal_indices);
 
+            for (size_t j = 0; j < vc; ++j)
             {
-                const long n = m_lexer.accept_long();
-                const size_t v = fix_index(n, m_vertices.size());
+                const size_t v = fix_index(chunk, line_number, *indices++, vertex_base + counts.m_vertex_count);
                 m_face_vertex_indices.push_back(v);
             }
 
-            //
-            // Recognized n
-            // Accept (epsilon), /
-            //
-
+            for (size_t j = 0; j < tc; ++j)
             {
-                const unsigned char c = m_lexer.get_char();
-                if (m_lexer.is_space(c))
-                    continue;
-                else if (c == '/')
-                    m_lexer.next_char();
-                else parse_error();
+                const size_t vt = fix_index(chunk, line_number, *indices++, tex_coord_base + counts.m_tex_coord_count);
+                m_face_tex_coord_indices.push_back(vt);
             }
 
-            //
-            // Recognized n/
-            // Accept /, n
-            //
-
+            for (size_t j = 0; j < nc; ++j)
             {
-                const unsigned char c = m_lexer.get_char();
-                if (c == '/')
-                {
-                    m_lexer.next_char();
-                    goto skip;
-                }
-                else
-                {
-                    const long n = m_lexer.accept_long();
-                    const size_t vt = fix_index(n, m_tex_coords.size());
-                    m_face_tex_coord_indices.push_back(vt);
-                }
+                const size_t vn = fix_index(chunk, line_number, *indices++, normal_base + counts.m_normal_count);
+                m_face_normal_indices.push_back(vn);
             }
 
-            //
-            // Recognized n/n
-            // Accept (epsilon), /
-            //
+            // Check whether the face is well-formed.
+            const bool well_formed =
+                    vc >= 3
+                && (tc == 0 || tc == vc)
+                && (nc == 0 || nc == vc);
 
+            if (well_formed)
             {
-                const unsigned char c = m_lexer.get_char();
-                if (m_lexer.is_space(c))
-                    continue;
-                else if (c == '/')
-                    m_lexer.next_char();
-                else parse_error();
+                // The face is well-formed, insert it into the mesh.
+                insert_face_into_mesh();
             }
-
-          skip:
-
-            //
-            // Recognized n//, n/n/
-            // Accept (epsilon), n
-            //
-
+            else
             {
-                const unsigned char c = m_lexer.get_char();
-                if (m_lexer.is_space(c))
-                    continue;
-                else
-                {
-                    const long n = m_lexer.accept_long();
-                    const size_t vn = fix_index(n, m_normals.size());
-                    m_face_normal_indices.push_back(vn);
-                }
+                // The face is ill-formed, ignore it or abort parsing.
+                if (m_options & StopOnInvalidFaceDef)
+                    throw ExceptionInvalidFaceDef(get_line_number(chunk, line_number));
             }
         }
 
-        // Check whether the face is well-formed.
-        const size_t vc = m_face_vertex_indices.size();
-        const size_t tc = m_face_tex_coord_indices.size();
-        const size_t nc = m_face_normal_indices.size();
-        const bool well_formed =
-                vc >= 3
-            && (tc == 0 || tc == vc)
-            && (nc == 0 || nc == vc);
+        // Replay the statements following the last face.
+        while (statement_index < chunk.m_statements.size())
+            replay_statement(chunk.m_statements[statement_index++]);
 
-        if (well_formed)
-        {
-            // The face is well-formed, insert it into the mesh.
-            insert_face_into_mesh();
-        }
-        else
+        if (chunk.m_out_of_memory)
+            throw bad_alloc();
+
+        if (chunk.m_parse_error)
+            throw ExceptionParseError(get_line_number(chunk, chunk.m_parse_error_line_number));
+    }
+
+    void replay_statement(const ChunkStatement& statement)
+    {
+        switch (statement.m_type)
         {
-            // The face is ill-formed, ignore it or abort parsing.
-            if (m_options & StopOnInvalidFaceDef)
-                throw ExceptionInvalidFaceDef(m_lexer.get_line_number());
+          case ChunkStatement::ObjectOrGroup:
+            begin_o_g(statement.m_name);
+            break;
+
+          case ChunkStatement::UseMaterial:
+            use_material(statement.m_name);
+            break;
         }
     }
 
     // Convert 1-based indices (including negative indices) to 0-based indices.
-    size_t fix_index(const long index, const size_t count)
+    size_t fix_index(
+        const Chunk&        chunk,
+        const size_t        line_number,
+        const long          index,
+        const size_t        count) const
     {
         if (index > 0)
         {
             const size_t i = static_cast<size_t>(index);
             if (i > count)
-                parse_error();
+                throw ExceptionParseError(get_line_number(chunk, line_number));
             return i - 1;
         }
         else if (index < 0)
         {
             const size_t i = static_cast<size_t>(-index);
             if (i > count)
-                parse_error();
+                throw ExceptionParseError(get_line_number(chunk, line_number));
             return count - i;
         }
-        else
-        {
-            parse_error();
-            return 0;       // keep the compiler happy
-        }
+        else throw ExceptionParseError(get_line_number(chunk, line_number));
     }
 
     void insert_face_into_mesh()
@@ -417,11 +832,8 @@ struct OBJMeshFileReader::Impl
             indices[i] = mapping[indices[i]];
     }
 
-    void parse_o_g_statement()
+    void begin_o_g(const string& upcoming_mesh_name)
     {
-        // Retrieve the name of the upcoming mesh.
-        const string upcoming_mesh_name = parse_compound_identifier();
-
         // Start a new mesh only if the name of the object or group actually changes.
         if (upcoming_mesh_name != m_current_mesh_name)
         {
@@ -440,92 +852,11 @@ struct OBJMeshFileReader::Impl
         }
     }
 
-    string parse_compound_identifier()
-    {
-        string identifier;
-
-        m_lexer.eat_blanks();
-
-        while (!m_lexer.is_eol())
-        {
-            const char* token;
-            size_t token_length;
-
-            m_lexer.accept_string(&token, &token_length);
-            m_lexer.eat_blanks();
-
-            if (!identifier.empty())
-                identifier += ' ';
-
-            identifier.append(token, token_length);
-        }
-
-        return identifier;
-    }
-
-    void parse_v_statement()
-    {
-        Vector3d v;
-
-        m_lexer.eat_blanks();
-        v.x = m_lexer.accept_double();
-
-        m_lexer.eat_blanks();
-        v.y = m_lexer.accept_double();
-
-        m_lexer.eat_blanks();
-        v.z = m_lexer.accept_double();
-
-        m_lexer.eat_blanks();
-
-        if (!m_lexer.is_eol())
-            m_lexer.accept_double();
-
-        m_vertices.push_back(v);
-    }
-
-    void parse_vt_statement()
-    {
-        Vector2d v;
-
-        m_lexer.eat_blanks();
-        v.x = m_lexer.accept_double();
-
-        m_lexer.eat_blanks();
-        v.y = m_lexer.accept_double();
-
-        m_lexer.eat_blanks();
-
-        if (!m_lexer.is_eol())
-            m_lexer.accept_double();
-
-        m_tex_coords.push_back(v);
-    }
-
-    void parse_vn_statement()
-    {
-        Vector3d n;
-
-        m_lexer.eat_blanks();
-        n.x = m_lexer.accept_double();
-
-        m_lexer.eat_blanks();
-        n.y = m_lexer.accept_double();
-
-        m_lexer.eat_blanks();
-        n.z = m_lexer.accept_double();
-
-        m_normals.push_back(n);
-    }
-
-    void parse_usemtl_statement()
+    void use_material(const string& material_slot_name)
     {
         // Begin a mesh definition if we're not already inside one.
         ensure_mesh_def();
 
-        // Retrieve the name of the material slot.
-        const string material_slot_name = parse_compound_identifier();
-
         // Check whether this material slot has already been defined for this mesh.
         const map<string, size_t>::const_iterator& it =
             m_material_slots.find(material_slot_name);
@@ -560,25 +891,40 @@ struct OBJMeshFileReader::Impl
 
 OBJMeshFileReader::OBJMeshFileReader(
     const string&   filename,
-    const int       options)
+    const int       options,
+    const size_t    thread_count)
   : m_filename(filename)
   , m_options(options)
+  , m_thread_count(thread_count)
 {
 }
 
 void OBJMeshFileReader::read(IMeshBuilder& builder)
 {
-    Impl impl(m_options, builder);
-
-    // Open the input file.
-    if (!impl.m_lexer.open(m_filename))
+    // Map the input file into memory.
+    MemoryMappedFile file;
+    if (!file.open(m_filename.c_str()))
         throw ExceptionIOError();
 
-    // Parse the file.
-    impl.parse_file();
-
-    // Close the input file.
-    impl.m_lexer.close();
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+
+    // Split the file into one chunk per thread.
+    const size_t chunk_count =
+        m_thread_count > 0
+            ? m_thread_count
+            : max<size_t>(
+                  min(file.size() / MinChunkSize, System::get_logical_cpu_core_count()),
+                  1);
+    vector<Chunk> chunks;
+    chunks.reserve(chunk_count);
+    split_into_chunks(begin, end, chunk_count, chunks);
+
+    Impl impl(m_options, builder, begin);
+
+    // Parse all chunks, then feed their contents to the mesh builder.
+    impl.parse_chunks(chunks);
+    impl.replay_chunks(chunks);
 }
 
 }   // namespace foundation
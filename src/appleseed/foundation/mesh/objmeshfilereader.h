@@ -48,6 +48,9 @@ namespace foundation
 //
 // Wavefront OBJ mesh file reader.
 //
+// The file is memory-mapped and parsed by several threads. The sequence of calls
+// made to the mesh builder is the same regardless of the number of threads.
+//
 // Reference:
 //
 //   http://people.scs.fsu.edu/~burkardt/txt/obj_format.txt
@@ -86,10 +89,12 @@ class OBJMeshFileReader
         StopOnInvalidFaceDef    = 1 << 1        // stop parsing on invalid face definitions
     };
 
-    // Constructor.
+    // Constructor. A thread count of 0 lets the reader choose the number
+    // of threads based on the size of the file and on the number of cores.
     OBJMeshFileReader(
         const std::string&  filename,
-        const int           options = Default);
+        const int           options = Default,
+        const size_t        thread_count = 0);
 
     // Read a mesh.
     virtual void read(IMeshBuilder& builder) override;
@@ -99,6 +104,7 @@ class OBJMeshFileReader
 
     const std::string       m_filename;
     const int               m_options;
+    const size_t            m_thread_count;
 };
 
 }       // namespace foundation
@@ -31,6 +31,9 @@
 #include "foundation/math/filter.h"
 #include "foundation/utility/benchmark.h"
 
+// Standard headers.
+#include <cstddef>
+
 using namespace foundation;
 
 BENCHMARK_SUITE(Foundation_Image_FilteredTile)
@@ -57,4 +60,47 @@ BENCHMARK_SUITE(Foundation_Image_FilteredTile)
 
         m_tile.add(m_x, m_y, Values);
     }
+
+    BENCHMARK_CASE_F(AddUnsynchronized, Fixture)
+    {
+        const float Values[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+
+        m_tile.add_unsynchronized(m_x, m_y, Values);
+    }
+
+    struct WideFilterFixture
+    {
+        BlackmanHarrisFilter2<float>    m_filter;
+        FilteredTile                    m_tile;
+        const volatile float            m_x;
+        const volatile float            m_y;
+
+        WideFilterFixture()
+          : m_filter(3.0f, 3.0f)
+          , m_tile(1024, 1024, 17, m_filter)
+          , m_x(42.42f)
+          , m_y(66.66f)
+        {
+        }
+    };
+
+    BENCHMARK_CASE_F(Add_WideFilter_ManyChannels, WideFilterFixture)
+    {
+        float values[17];
+
+        for (size_t i = 0; i < 17; ++i)
+            values[i] = static_cast<float>(i);
+
+        m_tile.add(m_x, m_y, values);
+    }
+
+    BENCHMARK_CASE_F(AddUnsynchronized_WideFilter_ManyChannels, WideFilterFixture)
+    {
+        float values[17];
+
+        for (size_t i = 0; i < 17; ++i)
+            values[i] = static_cast<float>(i);
+
+        m_tile.add_unsynchronized(m_x, m_y, values);
+    }
 }
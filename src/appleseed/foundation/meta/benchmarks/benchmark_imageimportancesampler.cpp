@@ -32,6 +32,7 @@
 #include "foundation/math/rng/distribution.h"
 #include "foundation/math/rng/xorshift.h"
 #include "foundation/math/sampling/imageimportancesampler.h"
+#include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/utility/benchmark.h"
 
@@ -48,6 +49,7 @@ BENCHMARK_SUITE(Foundation_Math_Sampling_ImageImportanceSampler)
     {
         typedef ImageImportanceSampler<ImageSampler::Payload, float> ImportanceSamplerType;
 
+        auto_ptr<Image>                 m_image;
         auto_ptr<ImportanceSamplerType> m_importance_sampler;
         Xorshift                        m_rng;
 
@@ -59,17 +61,23 @@ BENCHMARK_SUITE(Foundation_Math_Sampling_ImageImportanceSampler)
           , m_texel_prob_sum(0.0f)
         {
             GenericImageFileReader reader;
-            auto_ptr<Image> image(reader.read("unit tests/inputs/test_imageimportancesampler_doge2.exr"));
+            m_image.reset(reader.read("unit tests/inputs/test_imageimportancesampler_doge2.exr"));
 
-            const size_t width = image->properties().m_canvas_width;
-            const size_t height = image->properties().m_canvas_height;
+            const size_t width = m_image->properties().m_canvas_width;
+            const size_t height = m_image->properties().m_canvas_height;
 
             m_importance_sampler.reset(new ImportanceSamplerType(width, height));
-            ImageSampler sampler(*image.get());
+            ImageSampler sampler(*m_image.get());
             m_importance_sampler->rebuild(sampler);
         }
     };
 
+    BENCHMARK_CASE_F(Rebuild, Fixture)
+    {
+        ImageSampler sampler(*m_image.get());
+        m_importance_sampler->rebuild(sampler);
+    }
+
     BENCHMARK_CASE_F(Sample, Fixture)
     {
         const Vector2f s = rand_vector2<Vector2f>(m_rng);
@@ -81,4 +89,14 @@ BENCHMARK_SUITE(Foundation_Math_Sampling_ImageImportanceSampler)
         m_texel_coords_sum += texel_coords;
         m_texel_prob_sum += texel_prob;
     }
+
+    BENCHMARK_CASE_F(GetPDF, Fixture)
+    {
+        const Vector2f s = rand_vector2<Vector2f>(m_rng);
+
+        const size_t x = truncate<size_t>(s.x * m_importance_sampler->get_width());
+        const size_t y = truncate<size_t>(s.y * m_importance_sampler->get_height());
+
+        m_texel_prob_sum += m_importance_sampler->get_pdf(x, y);
+    }
 }
@@ -0,0 +1,140 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/mesh/meshbuilderbase.h"
+#include "foundation/mesh/objmeshfilereader.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/benchmark.h"
+
+// Standard headers.
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+using namespace foundation;
+using namespace std;
+
+BENCHMARK_SUITE(Foundation_Mesh_OBJMeshFileReader)
+{
+    const char* Filename = "unit benchmarks/outputs/benchmark_objmeshfilereader.obj";
+
+    // The file is exactly one megabyte, so the reported call rate is the throughput in MB/s.
+    const long FileSize = 1024 * 1024;
+
+    // Write a file with a single mesh made of random triangles.
+    void write_file()
+    {
+        FILE* file = fopen(Filename, "w");
+        if (file == 0)
+            return;
+
+        const int32 VertexCount = 4096;
+
+        MersenneTwister rng;
+
+        for (int32 i = 0; i < VertexCount; ++i)
+        {
+            fprintf(
+                file,
+                "v %f %f %f\n",
+                rand_double1(rng, -100.0, 100.0),
+                rand_double1(rng, -100.0, 100.0),
+                rand_double1(rng, -100.0, 100.0));
+        }
+
+        for (int32 i = 0; i < VertexCount; ++i)
+        {
+            fprintf(
+                file,
+                "vn %f %f %f\n",
+                rand_double1(rng, -1.0, 1.0),
+                rand_double1(rng, -1.0, 1.0),
+                rand_double1(rng, -1.0, 1.0));
+        }
+
+        fprintf(file, "o mesh\n");
+
+        // Add faces until the file is nearly full, then pad it with a comment.
+        while (ftell(file) < FileSize - 64)
+        {
+            const int32 a = rand_int1(rng, 1, VertexCount);
+            const int32 b = rand_int1(rng, 1, VertexCount);
+            const int32 c = rand_int1(rng, 1, VertexCount);
+            fprintf(file, "f %d//%d %d//%d %d//%d\n", a, a, b, b, c, c);
+        }
+
+        fprintf(file, "#%s\n", string(FileSize - ftell(file) - 2, ' ').c_str());
+
+        fclose(file);
+    }
+
+    template <int Options, size_t ThreadCount>
+    struct Fixture
+    {
+        MeshBuilderBase m_builder;
+
+        Fixture()
+        {
+            write_file();
+        }
+
+        void read()
+        {
+            OBJMeshFileReader reader(Filename, Options, ThreadCount);
+            reader.read(m_builder);
+        }
+    };
+
+    typedef Fixture<OBJMeshFileReader::Default, 1> PreciseSingleThreadedFixture;
+    typedef Fixture<OBJMeshFileReader::Default, 4> PreciseQuadThreadedFixture;
+    typedef Fixture<OBJMeshFileReader::FavorSpeedOverPrecision, 1> FastSingleThreadedFixture;
+    typedef Fixture<OBJMeshFileReader::FavorSpeedOverPrecision, 4> FastQuadThreadedFixture;
+
+    BENCHMARK_CASE_F(Read_PreciseParsing_SingleThreaded, PreciseSingleThreadedFixture)
+    {
+        read();
+    }
+
+    BENCHMARK_CASE_F(Read_PreciseParsing_QuadThreaded, PreciseQuadThreadedFixture)
+    {
+        read();
+    }
+
+    BENCHMARK_CASE_F(Read_FastParsing_SingleThreaded, FastSingleThreadedFixture)
+    {
+        read();
+    }
+
+    BENCHMARK_CASE_F(Read_FastParsing_QuadThreaded, FastQuadThreadedFixture)
+    {
+        read();
+    }
+}
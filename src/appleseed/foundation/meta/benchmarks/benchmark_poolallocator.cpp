@@ -30,6 +30,8 @@
 // appleseed.foundation headers.
 #include "foundation/platform/types.h"
 #include "foundation/utility/benchmark.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
 #include "foundation/utility/poolallocator.h"
 
 // Standard headers.
@@ -114,4 +116,74 @@ BENCHMARK_SUITE(Foundation_Utility_PoolAllocator)
     {
         first_allocated_last_deallocated_batch();
     }
+
+    template <typename Allocator>
+    struct AllocationJob
+      : public IJob
+    {
+        virtual void execute(const size_t thread_index)
+        {
+            Allocator allocator;
+            uint32* p[N];
+
+            for (size_t j = 0; j < 16; ++j)
+            {
+                for (size_t i = 0; i < N; ++i)
+                    p[i] = allocator.allocate(1);
+
+                for (size_t i = 0; i < N; ++i)
+                    allocator.deallocate(p[i], 1);
+            }
+        }
+    };
+
+    template <typename Allocator, size_t ThreadCount>
+    struct MultithreadedFixture
+    {
+        Logger      m_logger;
+        JobQueue    m_job_queue;
+        JobManager  m_job_manager;
+
+        MultithreadedFixture()
+          : m_job_manager(m_logger, m_job_queue, ThreadCount, JobManager::KeepRunningOnEmptyQueue)
+        {
+            m_job_manager.start();
+        }
+
+        void payload()
+        {
+            const size_t JobCount = 64;
+            AllocationJob<Allocator> jobs[JobCount];
+
+            for (size_t i = 0; i < JobCount; ++i)
+                m_job_queue.schedule(&jobs[i], false);
+
+            m_job_queue.wait_until_completion();
+        }
+    };
+
+    typedef MultithreadedFixture<DefaultAllocator, 1> SingleThreadedDefaultAllocatorFixture;
+    typedef MultithreadedFixture<PoolAllocator, 1> SingleThreadedPoolAllocatorFixture;
+    typedef MultithreadedFixture<DefaultAllocator, 4> QuadThreadedDefaultAllocatorFixture;
+    typedef MultithreadedFixture<PoolAllocator, 4> QuadThreadedPoolAllocatorFixture;
+
+    BENCHMARK_CASE_F(SingleThreadedBatches_DefaultAllocator, SingleThreadedDefaultAllocatorFixture)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(SingleThreadedBatches_PoolAllocator, SingleThreadedPoolAllocatorFixture)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(QuadThreadedBatches_DefaultAllocator, QuadThreadedDefaultAllocatorFixture)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(QuadThreadedBatches_PoolAllocator, QuadThreadedPoolAllocatorFixture)
+    {
+        payload();
+    }
 }
@@ -0,0 +1,143 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/aliastable.h"
+#include "foundation/math/fp.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Math_AliasTable)
+{
+    typedef foundation::AliasTable<double> AliasTable;
+
+    TEST_CASE(Empty_GivenTableInInitialState_ReturnsTrue)
+    {
+        AliasTable table;
+
+        EXPECT_TRUE(table.empty());
+    }
+
+    TEST_CASE(Valid_GivenTableInInitialState_ReturnsFalse)
+    {
+        AliasTable table;
+
+        EXPECT_FALSE(table.valid());
+    }
+
+    TEST_CASE(Valid_GivenTableWithOneItemWithZeroWeight_ReturnsFalse)
+    {
+        AliasTable table;
+        table.insert(0.0);
+
+        EXPECT_FALSE(table.valid());
+    }
+
+    TEST_CASE(Clear_GivenTableWithOneItem_MakesTableEmptyAndInvalid)
+    {
+        AliasTable table;
+        table.insert(0.5);
+        table.clear();
+
+        EXPECT_TRUE(table.empty());
+        EXPECT_FALSE(table.valid());
+    }
+
+    TEST_CASE(Sample_GivenTableWithOneItemWithPositiveWeight_ReturnsItem)
+    {
+        AliasTable table;
+        table.insert(0.5);
+        table.prepare();
+
+        double probability;
+        const size_t result = table.sample(0.5, probability);
+
+        EXPECT_EQ(0, result);
+        EXPECT_FEQ(1.0, probability);
+    }
+
+    TEST_CASE(Sample_GivenZeroWeightItems_NeverReturnsThem)
+    {
+        AliasTable table;
+        table.insert(0.0);
+        table.insert(1.0);
+        table.insert(0.0);
+        table.insert(3.0);
+        table.prepare();
+
+        const size_t SampleCount = 1000;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const double x = static_cast<double>(i) / SampleCount;
+            const size_t result = table.sample(x);
+
+            EXPECT_TRUE(result == 1 || result == 3);
+        }
+    }
+
+    TEST_CASE(Sample_GivenStratifiedSamples_ReturnsItemsProportionallyToTheirWeight)
+    {
+        AliasTable table;
+        table.insert(1.0);
+        table.insert(2.0);
+        table.insert(5.0);
+        table.insert(0.0);
+        table.prepare();
+
+        const size_t SampleCount = 8000;
+        size_t counts[4] = { 0, 0, 0, 0 };
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const double x = (i + 0.5) / SampleCount;
+            ++counts[table.sample(x)];
+        }
+
+        EXPECT_EQ(1000, counts[0]);
+        EXPECT_EQ(2000, counts[1]);
+        EXPECT_EQ(5000, counts[2]);
+        EXPECT_EQ(0, counts[3]);
+    }
+
+    TEST_CASE(GetProbability_ReturnsNormalizedWeight)
+    {
+        AliasTable table;
+        table.insert(0.4);
+        table.insert(1.6);
+        table.prepare();
+
+        EXPECT_FEQ(0.2, table.get_probability(0));
+        EXPECT_FEQ(0.8, table.get_probability(1));
+    }
+}
@@ -0,0 +1,263 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/math/vector.h"
+#include "foundation/mesh/binarymeshfilereader.h"
+#include "foundation/mesh/binarymeshfilewriter.h"
+#include "foundation/mesh/imeshwalker.h"
+#include "foundation/mesh/meshbuilderbase.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Mesh_BinaryMeshFileReader)
+{
+    const char* Filename = "unit tests/outputs/test_binarymeshfilereader.binarymesh";
+
+    struct Mesh
+    {
+        string              m_name;
+        vector<Vector3d>    m_vertices;
+        vector<size_t>      m_faces;
+    };
+
+    struct MeshBuilder
+      : public MeshBuilderBase
+    {
+        vector<Mesh> m_meshes;
+
+        virtual void begin_mesh(const char* name) override
+        {
+            m_meshes.push_back(Mesh());
+            m_meshes.back().m_name = name;
+        }
+
+        virtual size_t push_vertex(const Vector3d& v) override
+        {
+            m_meshes.back().m_vertices.push_back(v);
+            return m_meshes.back().m_vertices.size() - 1;
+        }
+
+        virtual void begin_face(const size_t vertex_count) override
+        {
+            assert(vertex_count == 3);
+        }
+
+        virtual void set_face_vertices(const size_t vertices[]) override
+        {
+            m_meshes.back().m_faces.push_back(vertices[0]);
+            m_meshes.back().m_faces.push_back(vertices[1]);
+            m_meshes.back().m_faces.push_back(vertices[2]);
+        }
+    };
+
+    struct MeshWalker
+      : public IMeshWalker
+    {
+        const Mesh& m_mesh;
+
+        explicit MeshWalker(const Mesh& mesh)
+          : m_mesh(mesh)
+        {
+        }
+
+        virtual const char* get_name() const override
+        {
+            return m_mesh.m_name.c_str();
+        }
+
+        virtual size_t get_vertex_count() const override
+        {
+            return m_mesh.m_vertices.size();
+        }
+
+        virtual Vector3d get_vertex(const size_t i) const override
+        {
+            return m_mesh.m_vertices[i];
+        }
+
+        virtual size_t get_vertex_normal_count() const override
+        {
+            return 0;
+        }
+
+        virtual Vector3d get_vertex_normal(const size_t i) const override
+        {
+            return Vector3d();
+        }
+
+        virtual size_t get_tex_coords_count() const override
+        {
+            return 0;
+        }
+
+        virtual Vector2d get_tex_coords(const size_t i) const override
+        {
+            return Vector2d();
+        }
+
+        virtual size_t get_material_slot_count() const override
+        {
+            return 0;
+        }
+
+        virtual const char* get_material_slot(const size_t i) const override
+        {
+            return 0;
+        }
+
+        virtual size_t get_face_count() const override
+        {
+            return m_mesh.m_faces.size() / 3;
+        }
+
+        virtual size_t get_face_vertex_count(const size_t face_index) const override
+        {
+            return 3;
+        }
+
+        virtual size_t get_face_vertex(const size_t face_index, const size_t vertex_index) const override
+        {
+            assert(vertex_index < 3);
+            return m_mesh.m_faces[face_index * 3 + vertex_index];
+        }
+
+        virtual size_t get_face_vertex_normal(const size_t face_index, const size_t vertex_index) const override
+        {
+            return 0;
+        }
+
+        virtual size_t get_face_tex_coords(const size_t face_index, const size_t vertex_index) const override
+        {
+            return 0;
+        }
+
+        virtual size_t get_face_material(const size_t face_index) const override
+        {
+            return 0;
+        }
+    };
+
+    Mesh create_mesh()
+    {
+        Mesh mesh;
+        mesh.m_name = "quad";
+
+        mesh.m_vertices.push_back(Vector3d(0.0, 0.0, 0.0));
+        mesh.m_vertices.push_back(Vector3d(1.0, 0.0, 0.0));
+        mesh.m_vertices.push_back(Vector3d(1.0, 1.0, 0.0));
+        mesh.m_vertices.push_back(Vector3d(0.0, 1.0, 0.0));
+
+        mesh.m_faces.push_back(0);
+        mesh.m_faces.push_back(1);
+        mesh.m_faces.push_back(2);
+        mesh.m_faces.push_back(2);
+        mesh.m_faces.push_back(3);
+        mesh.m_faces.push_back(0);
+
+        return mesh;
+    }
+
+    void write_test_file(const Mesh& mesh)
+    {
+        BinaryMeshFileWriter writer(Filename);
+        writer.write(MeshWalker(mesh));
+    }
+
+    string read_file(const char* filename)
+    {
+        ifstream file(filename, ios_base::in | ios_base::binary);
+        return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    }
+
+    TEST_CASE(Read_GivenFile_ReturnsWrittenMesh)
+    {
+        const Mesh mesh = create_mesh();
+        write_test_file(mesh);
+
+        MeshBuilder builder;
+        BinaryMeshFileReader reader(Filename);
+        reader.read(builder);
+
+        ASSERT_EQ(1, builder.m_meshes.size());
+        EXPECT_EQ(mesh.m_name, builder.m_meshes[0].m_name);
+        EXPECT_TRUE(mesh.m_vertices == builder.m_meshes[0].m_vertices);
+        EXPECT_TRUE(mesh.m_faces == builder.m_meshes[0].m_faces);
+    }
+
+    TEST_CASE(Read_GivenFileInMemory_ReturnsWrittenMesh)
+    {
+        const Mesh mesh = create_mesh();
+        write_test_file(mesh);
+
+        const string data = read_file(Filename);
+
+        MeshBuilder builder;
+        BinaryMeshFileReader reader(Filename, data.data(), data.size());
+        reader.read(builder);
+
+        ASSERT_EQ(1, builder.m_meshes.size());
+        EXPECT_EQ(mesh.m_name, builder.m_meshes[0].m_name);
+        EXPECT_TRUE(mesh.m_vertices == builder.m_meshes[0].m_vertices);
+        EXPECT_TRUE(mesh.m_faces == builder.m_meshes[0].m_faces);
+    }
+
+    TEST_CASE(Read_GivenTruncatedFileInMemory_ThrowsExceptionIOError)
+    {
+        write_test_file(create_mesh());
+
+        const string data = read_file(Filename);
+
+        MeshBuilder builder;
+        BinaryMeshFileReader reader(Filename, data.data(), data.size() - 1);
+
+        bool thrown = false;
+
+        try
+        {
+            reader.read(builder);
+        }
+        catch (const ExceptionIOError&)
+        {
+            thrown = true;
+        }
+
+        EXPECT_TRUE(thrown);
+    }
+}
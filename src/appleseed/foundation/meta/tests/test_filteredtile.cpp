@@ -33,8 +33,11 @@
 #include "foundation/utility/test.h"
 
 // Standard headers.
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdio>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -102,4 +105,175 @@ TEST_SUITE(Foundation_Image_FilteredTile)
         const BoxFilter2<float> filter(2.0f, 2.0f);
         test("unit tests/outputs/test_filteredtile_boxfilter_radius_2_0.txt", filter);
     }
+
+    // Samples with fractional positions, some of them close to the borders of the tile.
+    const size_t SampleCount = 4;
+    const float SamplePositions[SampleCount][2] =
+    {
+        { 3.3f, 4.6f },
+        { 0.2f, 7.9f },
+        { 7.7f, 1.1f },
+        { 5.5f, 3.5f }
+    };
+
+    // Five values per sample exercise both the four-wide and the scalar accumulation paths.
+    const size_t ChannelCount = 6;
+
+    void make_values(const size_t sample_index, float values[ChannelCount - 1])
+    {
+        for (size_t i = 0; i < ChannelCount - 1; ++i)
+            values[i] = 0.1f * (sample_index + 1) + 0.37f * i;
+    }
+
+    // Accumulate samples as FilteredTile::add() did before it used separable weights,
+    // by evaluating the 2D filter at every pixel of the footprint. Results are expected
+    // to be bit-identical, which holds as long as floating-point contraction is disabled,
+    // as it is in our builds.
+    void add_reference(vector<float>& pixels, const size_t width, const size_t height, const Filter2f& filter)
+    {
+        for (size_t s = 0; s < SampleCount; ++s)
+        {
+            float values[ChannelCount - 1];
+            make_values(s, values);
+
+            const float dx = SamplePositions[s][0] - 0.5f;
+            const float dy = SamplePositions[s][1] - 0.5f;
+
+            const int min_x = max(static_cast<int>(ceil(dx - filter.get_xradius())), 0);
+            const int min_y = max(static_cast<int>(ceil(dy - filter.get_yradius())), 0);
+            const int max_x = min(static_cast<int>(floor(dx + filter.get_xradius())), static_cast<int>(width) - 1);
+            const int max_y = min(static_cast<int>(floor(dy + filter.get_yradius())), static_cast<int>(height) - 1);
+
+            for (int ry = min_y; ry <= max_y; ++ry)
+            {
+                for (int rx = min_x; rx <= max_x; ++rx)
+                {
+                    const float weight = filter.evaluate(rx - dx, ry - dy);
+                    float* ptr = &pixels[(ry * width + rx) * ChannelCount];
+
+                    ptr[0] += weight;
+
+                    for (size_t i = 0; i < ChannelCount - 1; ++i)
+                        ptr[i + 1] += values[i] * weight;
+                }
+            }
+        }
+    }
+
+    void add_samples(FilteredTile& tile, const bool synchronized)
+    {
+        tile.clear();
+
+        for (size_t s = 0; s < SampleCount; ++s)
+        {
+            float values[ChannelCount - 1];
+            make_values(s, values);
+
+            if (synchronized)
+                tile.add(SamplePositions[s][0], SamplePositions[s][1], values);
+            else tile.add_unsynchronized(SamplePositions[s][0], SamplePositions[s][1], values);
+        }
+    }
+
+    bool is_equal(const FilteredTile& tile, const vector<float>& pixels)
+    {
+        for (size_t y = 0; y < tile.get_height(); ++y)
+        {
+            for (size_t x = 0; x < tile.get_width(); ++x)
+            {
+                const float* ptr = tile.pixel(x, y);
+
+                for (size_t i = 0; i < ChannelCount; ++i)
+                {
+                    if (ptr[i] != pixels[(y * tile.get_width() + x) * ChannelCount + i])
+                        return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool is_equal(const FilteredTile& lhs, const FilteredTile& rhs)
+    {
+        for (size_t y = 0; y < lhs.get_height(); ++y)
+        {
+            for (size_t x = 0; x < lhs.get_width(); ++x)
+            {
+                const float* lhs_ptr = lhs.pixel(x, y);
+                const float* rhs_ptr = rhs.pixel(x, y);
+
+                for (size_t i = 0; i < ChannelCount; ++i)
+                {
+                    if (lhs_ptr[i] != rhs_ptr[i])
+                        return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool add_matches_reference(const Filter2f& filter)
+    {
+        const size_t Width = 8;
+        const size_t Height = 9;
+
+        FilteredTile tile(Width, Height, ChannelCount, filter);
+        add_samples(tile, true);
+
+        vector<float> pixels(Width * Height * ChannelCount, 0.0f);
+        add_reference(pixels, Width, Height, filter);
+
+        return is_equal(tile, pixels);
+    }
+
+    bool add_unsynchronized_matches_add(const Filter2f& filter)
+    {
+        const size_t Width = 8;
+        const size_t Height = 9;
+
+        FilteredTile tile(Width, Height, ChannelCount, filter);
+        add_samples(tile, true);
+
+        FilteredTile unsynchronized_tile(Width, Height, ChannelCount, filter);
+        add_samples(unsynchronized_tile, false);
+
+        return is_equal(tile, unsynchronized_tile);
+    }
+
+    TEST_CASE(Add_GivenTriangleFilter_MatchesPerPixelFilterEvaluation)
+    {
+        EXPECT_TRUE(add_matches_reference(TriangleFilter2<float>(1.5f, 2.0f)));
+    }
+
+    TEST_CASE(Add_GivenGaussianFilter_MatchesPerPixelFilterEvaluation)
+    {
+        EXPECT_TRUE(add_matches_reference(GaussianFilter2<float>(1.5f, 2.0f, 4.0f)));
+    }
+
+    TEST_CASE(Add_GivenMitchellFilter_MatchesPerPixelFilterEvaluation)
+    {
+        EXPECT_TRUE(add_matches_reference(MitchellFilter2<float>(1.5f, 2.0f, 1.0f / 3, 1.0f / 3)));
+    }
+
+    TEST_CASE(Add_GivenLanczosFilter_MatchesPerPixelFilterEvaluation)
+    {
+        EXPECT_TRUE(add_matches_reference(LanczosFilter2<float>(1.5f, 2.0f, 3.0f)));
+    }
+
+    TEST_CASE(Add_GivenBlackmanHarrisFilter_MatchesPerPixelFilterEvaluation)
+    {
+        EXPECT_TRUE(add_matches_reference(BlackmanHarrisFilter2<float>(1.5f, 2.0f)));
+    }
+
+    TEST_CASE(AddUnsynchronized_GivenBoxFilter_MatchesAdd)
+    {
+        EXPECT_TRUE(add_unsynchronized_matches_add(BoxFilter2<float>(1.5f, 2.0f)));
+    }
+
+    TEST_CASE(AddUnsynchronized_GivenBlackmanHarrisFilter_MatchesAdd)
+    {
+        EXPECT_TRUE(add_unsynchronized_matches_add(BlackmanHarrisFilter2<float>(1.5f, 2.0f)));
+    }
 }
@@ -30,10 +30,14 @@
 // appleseed.foundation headers.
 #include "foundation/math/intersection/raytrianglemt.h"
 #include "foundation/math/intersection/raytrianglessk.h"
+#include "foundation/math/intersection/raytrianglewt.h"
 #include "foundation/math/ray.h"
 #include "foundation/math/vector.h"
 #include "foundation/utility/test.h"
 
+// Standard headers.
+#include <cstddef>
+
 using namespace foundation;
 
 namespace
@@ -166,3 +170,65 @@ TEST_SUITE(Foundation_Math_Intersection_RayTriangleSSK)
         EXPECT_FEQ(0.5, v);
     }
 }
+
+TEST_SUITE(Foundation_Math_Intersection_RayTriangleWT)
+{
+    typedef RayTriangleFixture<TriangleWT<double>> Fixture;
+
+    TEST_CASE_F(Intersect_GivenRayWithTMinEqualToHitDistance_ReturnsTrue, Fixture)
+    {
+        const Ray3d ray(Vector3d(-0.2, 1.0, 0.2), Vector3d(0.0, -1.0, 0.0), 1.0, 10.0);
+
+        const bool hit = m_triangle.intersect(ray, TriangleWT<double>::RayInfo(ray));
+
+        ASSERT_TRUE(hit);
+    }
+
+    TEST_CASE_F(Intersect_GivenRayWithTMaxEqualToHitDistance_ReturnsFalse, Fixture)
+    {
+        const Ray3d ray(Vector3d(-0.2, 1.0, 0.2), Vector3d(0.0, -1.0, 0.0), 0.0, 1.0);
+
+        const bool hit = m_triangle.intersect(ray, TriangleWT<double>::RayInfo(ray));
+
+        ASSERT_FALSE(hit);
+    }
+
+    TEST_CASE_F(Intersect_GivenRayHittingDiagonalOfQuad_ReturnsHit, Fixture)
+    {
+        const Ray3d ray(Vector3d(0.0, 1.0, 0.0), Vector3d(0.0, -1.0, 0.0));
+
+        double t, u, v;
+        const bool hit = m_triangle.intersect(ray, TriangleWT<double>::RayInfo(ray), t, u, v);
+
+        ASSERT_TRUE(hit);
+        EXPECT_FEQ(1.0, t);
+        EXPECT_FEQ(0.0, u);
+        EXPECT_FEQ(0.5, v);
+    }
+
+    TEST_CASE(Intersect_GivenSinglePrecisionRaysCrossingSharedEdge_HitsOneOfTheTriangles)
+    {
+        const Vector3f v0(0.0f, 0.0f, 0.0f);
+        const Vector3f v1(1.0f, 0.0f, 0.0f);
+        const Vector3f v2(1.0f, 0.0f, 1.0f);
+        const Vector3f v3(0.0f, 0.0f, 1.0f);
+
+        const TriangleWT<float> triangle1(v0, v1, v2);
+        const TriangleWT<float> triangle2(v0, v2, v3);
+
+        bool always_hit = true;
+
+        for (size_t i = 0; i <= 97; ++i)
+        {
+            // This ray crosses the shared edge at (k, 0, k).
+            const float k = static_cast<float>(i) / 97.0f;
+            const Ray3f ray(Vector3f(k - 0.1f, 1.0f, k - 0.3f), Vector3f(0.1f, -1.0f, 0.3f));
+            const TriangleWT<float>::RayInfo ray_info(ray);
+
+            if (!triangle1.intersect(ray, ray_info) && !triangle2.intersect(ray, ray_info))
+                always_hit = false;
+        }
+
+        EXPECT_TRUE(always_hit);
+    }
+}
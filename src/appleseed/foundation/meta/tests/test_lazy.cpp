@@ -116,4 +116,56 @@ TEST_SUITE(Foundation_Utility_Lazy_Access)
 
         EXPECT_EQ(0, access.get());
     }
+
+    TEST_CASE(TryEvict_GivenObjectNotBeingAccessed_DeletesObject)
+    {
+        auto_ptr<ObjectFactory> factory(new SimpleObjectFactory(42));
+        Lazy<Object> object(factory);
+
+        {
+            Access<Object> access(&object);
+        }
+
+        EXPECT_TRUE(object.try_evict());
+        EXPECT_FALSE(object.try_evict());
+    }
+
+    TEST_CASE(TryEvict_GivenObjectBeingAccessed_KeepsObject)
+    {
+        auto_ptr<ObjectFactory> factory(new SimpleObjectFactory(42));
+        Lazy<Object> object(factory);
+
+        Access<Object> access(&object);
+
+        EXPECT_FALSE(object.try_evict());
+        EXPECT_EQ(42, access->m_value);
+    }
+
+    TEST_CASE(Access_GivenEvictedObject_RecreatesObject)
+    {
+        auto_ptr<ObjectFactory> factory(new SimpleObjectFactory(42));
+        Lazy<Object> object(factory);
+
+        {
+            Access<Object> access(&object);
+        }
+
+        object.try_evict();
+
+        Access<Object> access(&object);
+
+        EXPECT_EQ(42, access->m_value);
+    }
+
+    TEST_CASE(TryEvict_GivenSourceObject_KeepsObject)
+    {
+        Object source_object(42);
+        Lazy<Object> object(&source_object);
+
+        {
+            Access<Object> access(&object);
+        }
+
+        EXPECT_FALSE(object.try_evict());
+    }
 }
@@ -0,0 +1,110 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/utility/log.h"
+#include "foundation/utility/string.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Utility_Log_Logger)
+{
+    struct Fixture
+    {
+        Logger              m_logger;
+        StringLogTarget     m_target;
+
+        Fixture()
+        {
+            m_logger.set_all_formats("{message}");
+            m_logger.add_target(&m_target);
+        }
+
+        ~Fixture()
+        {
+            m_logger.disable_async_mode();
+            m_logger.remove_target(&m_target);
+        }
+    };
+
+    TEST_CASE_F(Write_SynchronousMode_WritesMessageImmediately, Fixture)
+    {
+        LOG_INFO(m_logger, "hello %d", 42);
+
+        EXPECT_EQ("hello 42\n", string(m_target.get_string()));
+    }
+
+    TEST_CASE_F(Write_AsynchronousMode_WritesMessagesInOrderAfterFlush, Fixture)
+    {
+        m_logger.enable_async_mode(4);
+
+        for (size_t i = 0; i < 16; ++i)
+            LOG_INFO(m_logger, "%s", to_string(i).c_str());
+
+        m_logger.flush();
+
+        EXPECT_EQ(
+            "0\n1\n2\n3\n4\n5\n6\n7\n8\n9\n10\n11\n12\n13\n14\n15\n",
+            string(m_target.get_string()));
+    }
+
+    TEST_CASE_F(DisableAsyncMode_WritesPendingMessages, Fixture)
+    {
+        m_logger.enable_async_mode();
+
+        LOG_WARNING(m_logger, "pending");
+
+        m_logger.disable_async_mode();
+
+        EXPECT_FALSE(m_logger.is_async_mode_enabled());
+        EXPECT_EQ("pending\n", string(m_target.get_string()));
+    }
+
+    TEST_CASE_F(Write_AsynchronousModeWithRateLimit_DropsExcessInfoMessagesButNotWarnings, Fixture)
+    {
+        m_logger.enable_async_mode(64, Logger::OverflowBlock, 2);
+
+        for (size_t i = 0; i < 8; ++i)
+            LOG_INFO(m_logger, "info");
+
+        LOG_WARNING(m_logger, "warning");
+
+        m_logger.disable_async_mode();
+
+        const string output = m_target.get_string();
+
+        EXPECT_NEQ(string::npos, output.find("warning\n"));
+        EXPECT_NEQ(string::npos, output.find("dropped"));
+    }
+}
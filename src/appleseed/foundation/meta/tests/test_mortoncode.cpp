@@ -0,0 +1,61 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/mortoncode.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+
+TEST_SUITE(Foundation_Math_MortonCode)
+{
+    TEST_CASE(MortonCode_GivenOrigin_ReturnsZero)
+    {
+        EXPECT_EQ(0, morton_code(0, 0));
+    }
+
+    TEST_CASE(MortonCode_GivenUnitCoordinates_InterleavesBits)
+    {
+        EXPECT_EQ(1, morton_code(1, 0));
+        EXPECT_EQ(2, morton_code(0, 1));
+        EXPECT_EQ(3, morton_code(1, 1));
+        EXPECT_EQ(4, morton_code(2, 0));
+    }
+
+    TEST_CASE(MortonCode_GivenMaximumCoordinates_ReturnsAllBitsSet)
+    {
+        EXPECT_EQ(0xFFFFFFFF, morton_code(65535, 65535));
+    }
+
+    TEST_CASE(MortonCode_GivenPointsOfSameQuadrant_ReturnsConsecutiveCodes)
+    {
+        EXPECT_EQ(morton_code(2, 2) + 1, morton_code(3, 2));
+        EXPECT_EQ(morton_code(2, 2) + 2, morton_code(2, 3));
+        EXPECT_EQ(morton_code(2, 2) + 3, morton_code(3, 3));
+    }
+}
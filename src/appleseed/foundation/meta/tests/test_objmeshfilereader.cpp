@@ -32,6 +32,8 @@
 #include "foundation/mesh/meshbuilderbase.h"
 #include "foundation/mesh/objmeshfilereader.h"
 #include "foundation/platform/compiler.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/string.h"
 #include "foundation/utility/test.h"
 
 // Standard headers.
@@ -121,4 +123,131 @@ TEST_SUITE(Foundation_Mesh_OBJMeshFileReader)
         EXPECT_EQ(4, mesh.m_tex_coords.size());
         EXPECT_EQ(1, mesh.m_faces.size());
     }
+
+    TEST_CASE(ReadMultipleObjectsMeshFile)
+    {
+        OBJMeshFileReader reader("unit tests/inputs/test_objmeshfilereader_multipleobjects.obj");
+        MeshBuilder builder;
+        reader.read(builder);
+
+        ASSERT_EQ(2, builder.m_meshes.size());
+
+        const Mesh& first_mesh = builder.m_meshes[0];
+        EXPECT_EQ("first object", first_mesh.m_name);
+        EXPECT_EQ(4, first_mesh.m_vertices.size());
+        EXPECT_EQ(1, first_mesh.m_vertex_normals.size());
+        EXPECT_EQ(4, first_mesh.m_tex_coords.size());
+        EXPECT_EQ(3, first_mesh.m_faces.size());
+
+        const Mesh& second_mesh = builder.m_meshes[1];
+        EXPECT_EQ("second object", second_mesh.m_name);
+        EXPECT_EQ(7, second_mesh.m_vertices.size());
+        EXPECT_EQ(1, second_mesh.m_vertex_normals.size());
+        EXPECT_EQ(0, second_mesh.m_tex_coords.size());
+        EXPECT_EQ(4, second_mesh.m_faces.size());
+    }
+
+    // Record every call made to the mesh builder.
+    struct RecordingMeshBuilder
+      : public IMeshBuilder
+    {
+        vector<string>      m_calls;
+        size_t              m_vertex_count;
+        size_t              m_vertex_normal_count;
+        size_t              m_tex_coords_count;
+        size_t              m_material_slot_count;
+        size_t              m_face_vertex_count;
+
+        RecordingMeshBuilder()
+          : m_vertex_count(0)
+          , m_vertex_normal_count(0)
+          , m_tex_coords_count(0)
+          , m_material_slot_count(0)
+          , m_face_vertex_count(0)
+        {
+        }
+
+        virtual void begin_mesh(const char* name) override
+        {
+            m_calls.push_back(string("begin_mesh ") + name);
+        }
+
+        virtual size_t push_vertex(const Vector3d& v) override
+        {
+            m_calls.push_back("push_vertex " + to_string(v));
+            return m_vertex_count++;
+        }
+
+        virtual size_t push_vertex_normal(const Vector3d& v) override
+        {
+            m_calls.push_back("push_vertex_normal " + to_string(v));
+            return m_vertex_normal_count++;
+        }
+
+        virtual size_t push_tex_coords(const Vector2d& v) override
+        {
+            m_calls.push_back("push_tex_coords " + to_string(v));
+            return m_tex_coords_count++;
+        }
+
+        virtual size_t push_material_slot(const char* name) override
+        {
+            m_calls.push_back(string("push_material_slot ") + name);
+            return m_material_slot_count++;
+        }
+
+        virtual void begin_face(const size_t vertex_count) override
+        {
+            m_calls.push_back("begin_face " + to_string(vertex_count));
+            m_face_vertex_count = vertex_count;
+        }
+
+        virtual void set_face_vertices(const size_t vertices[]) override
+        {
+            m_calls.push_back("set_face_vertices " + to_string(vertices, m_face_vertex_count));
+        }
+
+        virtual void set_face_vertex_normals(const size_t vertex_normals[]) override
+        {
+            m_calls.push_back("set_face_vertex_normals " + to_string(vertex_normals, m_face_vertex_count));
+        }
+
+        virtual void set_face_vertex_tex_coords(const size_t tex_coords[]) override
+        {
+            m_calls.push_back("set_face_vertex_tex_coords " + to_string(tex_coords, m_face_vertex_count));
+        }
+
+        virtual void set_face_material(const size_t material) override
+        {
+            m_calls.push_back("set_face_material " + to_string(material));
+        }
+
+        virtual void end_face() override
+        {
+            m_calls.push_back("end_face");
+        }
+
+        virtual void end_mesh() override
+        {
+            m_calls.push_back("end_mesh");
+        }
+    };
+
+    TEST_CASE(Read_GivenSeveralThreads_MakesSameCallsAsSingleThread)
+    {
+        const string filename = "unit tests/inputs/test_objmeshfilereader_multipleobjects.obj";
+
+        OBJMeshFileReader reference_reader(filename, OBJMeshFileReader::Default, 1);
+        RecordingMeshBuilder reference_builder;
+        reference_reader.read(reference_builder);
+
+        for (size_t thread_count = 2; thread_count <= 8; ++thread_count)
+        {
+            OBJMeshFileReader reader(filename, OBJMeshFileReader::Default, thread_count);
+            RecordingMeshBuilder builder;
+            reader.read(builder);
+
+            EXPECT_EQ(reference_builder.m_calls, builder.m_calls);
+        }
+    }
 }
@@ -0,0 +1,300 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+#include "foundation/utility/packfile.h"
+#include "foundation/utility/test.h"
+#include "foundation/utility/zip.h"
+
+// Boost headers.
+#include "boost/filesystem.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+namespace bf = boost::filesystem;
+
+TEST_SUITE(Foundation_Utility_PackFile)
+{
+    const string InitialDirectory = "unit tests/inputs/test_zip";
+
+    string read_file(const bf::path& filepath)
+    {
+        ifstream file(filepath.string().c_str(), ios_base::in | ios_base::binary);
+        return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    }
+
+    TEST_CASE(PackUnpackRoundtrip)
+    {
+        const string TargetPack = "unit tests/outputs/test_packfile.pack";
+        const string TargetDirectory = "unit tests/outputs/test_packfile";
+
+        try
+        {
+            ASSERT_TRUE(bf::exists(InitialDirectory));
+            ASSERT_FALSE(bf::exists(TargetPack));
+            ASSERT_FALSE(bf::exists(TargetDirectory));
+
+            pack(TargetPack, InitialDirectory);
+            unpack(TargetPack, TargetDirectory);
+
+            const set<string> expected_files = recursive_ls(InitialDirectory);
+            const set<string> actual_files = recursive_ls(TargetDirectory);
+
+            ASSERT_EQ(expected_files.size(), actual_files.size());
+
+            for (set<string>::iterator it = actual_files.begin(); it != actual_files.end(); ++it)
+            {
+                ASSERT_EQ(1, expected_files.count(*it));
+                EXPECT_EQ(
+                    read_file(bf::path(InitialDirectory) / *it),
+                    read_file(bf::path(TargetDirectory) / *it));
+            }
+
+            bf::remove(TargetPack);
+            bf::remove_all(TargetDirectory);
+        }
+        catch (const exception& e)
+        {
+            bf::remove(TargetPack);
+            bf::remove_all(TargetDirectory);
+            throw e;
+        }
+    }
+
+    TEST_CASE(Unpack_GivenSkippedExtension_DoesNotExtractMatchingFiles)
+    {
+        const string TargetPack = "unit tests/outputs/test_packfile_skip.pack";
+        const string TargetDirectory = "unit tests/outputs/test_packfile_skip";
+
+        try
+        {
+            pack(TargetPack, InitialDirectory);
+            unpack(TargetPack, TargetDirectory, vector<string>(1, ".TXT"));
+
+            const set<string> actual_files = recursive_ls(TargetDirectory);
+
+            for (set<string>::iterator it = actual_files.begin(); it != actual_files.end(); ++it)
+                EXPECT_NEQ(".txt", bf::path(*it).extension().string());
+
+            bf::remove(TargetPack);
+            bf::remove_all(TargetDirectory);
+        }
+        catch (const exception& e)
+        {
+            bf::remove(TargetPack);
+            bf::remove_all(TargetDirectory);
+            throw e;
+        }
+    }
+
+    TEST_CASE(PackFileReader_GivenPackedFile_ReturnsItsContents)
+    {
+        const string TargetPack = "unit tests/outputs/test_packfile_reader.pack";
+
+        try
+        {
+            pack(TargetPack, InitialDirectory);
+
+            const set<string> expected_files = recursive_ls(InitialDirectory);
+
+            const PackFileReader reader(TargetPack);
+            ASSERT_EQ(expected_files.size(), reader.get_entry_count());
+
+            for (set<string>::iterator it = expected_files.begin(); it != expected_files.end(); ++it)
+            {
+                const size_t index = reader.find_entry(*it);
+                ASSERT_NEQ(~size_t(0), index);
+
+                EXPECT_EQ(0, reinterpret_cast<size_t>(reader.get_entry_data(index)) % PackFileAlignment);
+                EXPECT_EQ(
+                    read_file(bf::path(InitialDirectory) / *it),
+                    string(reader.get_entry_data(index), reader.get_entry_size(index)));
+            }
+
+            EXPECT_EQ(~size_t(0), reader.find_entry("missing.txt"));
+        }
+        catch (const exception& e)
+        {
+            bf::remove(TargetPack);
+            throw e;
+        }
+
+        bf::remove(TargetPack);
+    }
+
+    TEST_CASE(PackFileReader_FindUnpackedEntry)
+    {
+        const string TargetPack = "unit tests/outputs/test_packfile_unpacked_entry.pack";
+
+        try
+        {
+            pack(TargetPack, InitialDirectory);
+
+            const set<string> files = recursive_ls(InitialDirectory);
+            ASSERT_FALSE(files.empty());
+
+            const PackFileReader reader(TargetPack);
+            const string& path = *files.begin();
+
+            EXPECT_EQ(
+                reader.find_entry(path),
+                reader.find_unpacked_entry("outputs/unpacked", "outputs/./unpacked/" + path));
+
+            EXPECT_EQ(
+                ~size_t(0),
+                reader.find_unpacked_entry("outputs/unpacked", "outputs/other/" + path));
+        }
+        catch (const exception& e)
+        {
+            bf::remove(TargetPack);
+            throw e;
+        }
+
+        bf::remove(TargetPack);
+    }
+
+    // Write a pack file containing a single empty file with a given path.
+    void write_pack_file_with_path(const string& pack_filename, const string& path)
+    {
+        ofstream file(pack_filename.c_str(), ios_base::out | ios_base::binary);
+
+        const char magic[8] = { 'A', 'S', 'P', 'A', 'C', 'K', '\r', '\n' };
+        const uint16 version = 1;
+        const uint16 reserved = 0;
+        const uint32 entry_count = 1;
+        const uint64 string_table_size = path.size();
+        file.write(magic, sizeof(magic));
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        file.write(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+        file.write(reinterpret_cast<const char*>(&entry_count), sizeof(entry_count));
+        file.write(reinterpret_cast<const char*>(&string_table_size), sizeof(string_table_size));
+
+        const uint64 offset = 0;
+        const uint64 size = 0;
+        const uint32 path_offset = 0;
+        const uint32 path_size = static_cast<uint32>(path.size());
+        file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        file.write(reinterpret_cast<const char*>(&path_offset), sizeof(path_offset));
+        file.write(reinterpret_cast<const char*>(&path_size), sizeof(path_size));
+
+        file.write(path.data(), path.size());
+    }
+
+    bool is_rejected(const string& path)
+    {
+        const string TargetPack = "unit tests/outputs/test_packfile_invalid_path.pack";
+
+        write_pack_file_with_path(TargetPack, path);
+
+        bool rejected = false;
+
+        try
+        {
+            const PackFileReader reader(TargetPack);
+        }
+        catch (const PackFileException&)
+        {
+            rejected = true;
+        }
+
+        bf::remove(TargetPack);
+
+        return rejected;
+    }
+
+    TEST_CASE(PackFileReader_GivenRelativePath_AcceptsPackFile)
+    {
+        EXPECT_FALSE(is_rejected("dir/file..txt"));
+    }
+
+    TEST_CASE(PackFileReader_GivenAbsolutePath_RejectsPackFile)
+    {
+        EXPECT_TRUE(is_rejected("/etc/passwd"));
+        EXPECT_TRUE(is_rejected("C:/Windows/win.ini"));
+    }
+
+    TEST_CASE(PackFileReader_GivenPathWithParentDirectory_RejectsPackFile)
+    {
+        EXPECT_TRUE(is_rejected(".."));
+        EXPECT_TRUE(is_rejected("../file.txt"));
+        EXPECT_TRUE(is_rejected("dir/../../file.txt"));
+        EXPECT_TRUE(is_rejected("dir\\..\\..\\file.txt"));
+    }
+
+    TEST_CASE(IsPackFile_GivenZipFile_ReturnsFalse)
+    {
+        EXPECT_FALSE(is_pack_file("unit tests/inputs/test_zip_validzipfile.zip"));
+    }
+
+    TEST_CASE(GetFilenamesWithExtensionFromPack)
+    {
+        const string TargetPack = "unit tests/outputs/test_packfile_filenames.pack";
+
+        try
+        {
+            pack(TargetPack, InitialDirectory);
+
+            EXPECT_TRUE(is_pack_file(TargetPack.c_str()));
+
+            const vector<string> expected_files =
+                get_filenames_with_extension_from_pack(TargetPack, ".txt");
+
+            const set<string> all_files = recursive_ls(InitialDirectory);
+
+            size_t txt_file_count = 0;
+            for (set<string>::iterator it = all_files.begin(); it != all_files.end(); ++it)
+            {
+                if (bf::path(*it).extension() == ".txt")
+                {
+                    EXPECT_TRUE(find(expected_files.begin(), expected_files.end(), *it) != expected_files.end());
+                    ++txt_file_count;
+                }
+            }
+
+            EXPECT_EQ(txt_file_count, expected_files.size());
+        }
+        catch (const exception& e)
+        {
+            bf::remove(TargetPack);
+            throw e;
+        }
+
+        bf::remove(TargetPack);
+    }
+}
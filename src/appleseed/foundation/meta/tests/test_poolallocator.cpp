@@ -31,9 +31,14 @@
 #include "foundation/utility/poolallocator.h"
 #include "foundation/utility/test.h"
 
+// Boost headers.
+#include "boost/thread/thread.hpp"
+
 // Standard headers.
 #include <cstddef>
 #include <memory>
+#include <set>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -97,6 +102,82 @@ TEST_SUITE(Foundation_Utility_PoolAllocator)
         allocator.deallocate(p, N);
     }
 
+    TEST_CASE(AllocateDeallocateManyItems_ReturnsDistinctBlocks)
+    {
+        PoolAllocator<size_t, 3> allocator;
+
+        const size_t N = 1000;
+
+        vector<size_t*> items;
+        set<size_t*> unique_items;
+
+        for (size_t i = 0; i < N; ++i)
+        {
+            size_t* p = allocator.allocate(1);
+            *p = i;
+            items.push_back(p);
+            unique_items.insert(p);
+        }
+
+        EXPECT_EQ(N, unique_items.size());
+
+        for (size_t i = 0; i < N; ++i)
+        {
+            EXPECT_EQ(i, *items[i]);
+            allocator.deallocate(items[i], 1);
+        }
+    }
+
+    struct Item
+    {
+        // A size that no other test uses, so that this item type gets its own pool.
+        char m_bytes[56];
+    };
+
+    typedef PoolAllocator<Item, 5> ItemAllocator;
+
+    void allocate_items(set<Item*>& items, const size_t count)
+    {
+        ItemAllocator allocator;
+
+        for (size_t i = 0; i < count; ++i)
+            items.insert(allocator.allocate(1));
+    }
+
+    void deallocate_items(const set<Item*>& items)
+    {
+        ItemAllocator allocator;
+
+        for (set<Item*>::const_iterator i = items.begin(); i != items.end(); ++i)
+            allocator.deallocate(*i, 1);
+    }
+
+    TEST_CASE(Allocate_GivenBlocksFreedByTerminatedThread_ReusesThoseBlocks)
+    {
+        set<Item*> freed_items;
+
+        boost::thread first_thread(
+            [&freed_items]()
+            {
+                allocate_items(freed_items, 5);
+                deallocate_items(freed_items);
+            });
+        first_thread.join();
+
+        set<Item*> items;
+
+        boost::thread second_thread(
+            [&items]()
+            {
+                allocate_items(items, 5);
+                deallocate_items(items);
+            });
+        second_thread.join();
+
+        ASSERT_EQ(5, freed_items.size());
+        EXPECT_TRUE(items == freed_items);
+    }
+
     TEST_CASE(RebindVoidAllocatorToIntAllocator)
     {
         PoolAllocator<void, 2>::rebind<int>::other allocator;
@@ -0,0 +1,255 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/image/tiledtexturefileformat.h"
+#include "foundation/image/tiledtexturefilereader.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Image_TiledTextureFileReader)
+{
+    const char* Filename = "unit tests/outputs/test_tiledtexturefilereader.astx";
+
+    // Write a single channel, 8-bit, 3x3 texture with 2x2 tiles and a single level.
+    // The value of each pixel is 10 * y + x.
+    void write_test_file()
+    {
+        FILE* file = fopen(Filename, "wb");
+
+        TiledTextureFileHeader header;
+        memcpy(header.m_magic, TiledTextureFileMagic, sizeof(header.m_magic));
+        header.m_version = TiledTextureFileVersion;
+        header.m_channel_count = 1;
+        header.m_pixel_format = PixelFormatUInt8;
+        header.m_tile_width = 2;
+        header.m_tile_height = 2;
+        header.m_level_count = 1;
+        header.m_flags = 0;
+        fwrite(&header, sizeof(header), 1, file);
+
+        TiledTextureLevelHeader level;
+        level.m_width = 3;
+        level.m_height = 3;
+        fwrite(&level, sizeof(level), 1, file);
+
+        TiledTextureChannelStats stats;
+        stats.m_average = 11.0f / 255.0f;
+        stats.m_max = 22.0f / 255.0f;
+        fwrite(&stats, sizeof(stats), 1, file);
+
+        const uint8 tile00[] = { 0, 1, 10, 11 };
+        const uint8 tile10[] = { 2, 12 };
+        const uint8 tile01[] = { 20, 21 };
+        const uint8 tile11[] = { 22 };
+
+        uint64 offset = sizeof(header) + sizeof(level) + sizeof(stats) + 4 * sizeof(TiledTextureTileEntry);
+        const uint64 sizes[] = { sizeof(tile00), sizeof(tile10), sizeof(tile01), sizeof(tile11) };
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            TiledTextureTileEntry entry;
+            entry.m_offset = offset;
+            entry.m_size = sizes[i];
+            fwrite(&entry, sizeof(entry), 1, file);
+            offset += sizes[i];
+        }
+
+        fwrite(tile00, sizeof(tile00), 1, file);
+        fwrite(tile10, sizeof(tile10), 1, file);
+        fwrite(tile01, sizeof(tile01), 1, file);
+        fwrite(tile11, sizeof(tile11), 1, file);
+
+        fclose(file);
+    }
+
+    // Write a constant, three channels, 32-bit floating-point, 1x1 texture.
+    void write_constant_test_file()
+    {
+        FILE* file = fopen(Filename, "wb");
+
+        TiledTextureFileHeader header;
+        memcpy(header.m_magic, TiledTextureFileMagic, sizeof(header.m_magic));
+        header.m_version = TiledTextureFileVersion;
+        header.m_channel_count = 3;
+        header.m_pixel_format = PixelFormatFloat;
+        header.m_tile_width = 1;
+        header.m_tile_height = 1;
+        header.m_level_count = 1;
+        header.m_flags = TiledTextureFileFlagConstant;
+        fwrite(&header, sizeof(header), 1, file);
+
+        TiledTextureLevelHeader level;
+        level.m_width = 1;
+        level.m_height = 1;
+        fwrite(&level, sizeof(level), 1, file);
+
+        const float pixel[] = { 0.25f, 0.5f, 0.75f };
+
+        for (size_t c = 0; c < 3; ++c)
+        {
+            TiledTextureChannelStats stats;
+            stats.m_average = pixel[c];
+            stats.m_max = pixel[c];
+            fwrite(&stats, sizeof(stats), 1, file);
+        }
+
+        TiledTextureTileEntry entry;
+        entry.m_offset = sizeof(header) + sizeof(level) + 3 * sizeof(TiledTextureChannelStats) + sizeof(entry);
+        entry.m_size = sizeof(pixel);
+        fwrite(&entry, sizeof(entry), 1, file);
+
+        fwrite(pixel, sizeof(pixel), 1, file);
+
+        fclose(file);
+    }
+
+    TEST_CASE(IsTiledTextureFile_GivenTiledTextureFile_ReturnsTrue)
+    {
+        write_test_file();
+
+        EXPECT_TRUE(TiledTextureFileReader::is_tiled_texture_file(Filename));
+    }
+
+    TEST_CASE(IsTiledTextureFile_GivenOtherImageFile_ReturnsFalse)
+    {
+        EXPECT_FALSE(TiledTextureFileReader::is_tiled_texture_file("unit tests/inputs/test_genericprogressiveimagefilereader_image.pnm"));
+    }
+
+    TEST_CASE(ReadConstantColor_GivenConstantTexture_ReturnsColor)
+    {
+        write_constant_test_file();
+
+        Color4f color;
+        size_t channel_count;
+        const bool is_constant = TiledTextureFileReader::read_constant_color(Filename, color, channel_count);
+
+        ASSERT_TRUE(is_constant);
+        EXPECT_EQ(3, channel_count);
+        EXPECT_EQ(Color4f(0.25f, 0.5f, 0.75f, 1.0f), color);
+    }
+
+    TEST_CASE(ReadConstantColor_GivenVaryingTexture_ReturnsFalse)
+    {
+        write_test_file();
+
+        Color4f color;
+        size_t channel_count;
+
+        EXPECT_FALSE(TiledTextureFileReader::read_constant_color(Filename, color, channel_count));
+    }
+
+    TEST_CASE(ReadConstantColor_GivenOtherImageFile_ReturnsFalse)
+    {
+        Color4f color;
+        size_t channel_count;
+
+        EXPECT_FALSE(
+            TiledTextureFileReader::read_constant_color(
+                "unit tests/inputs/test_genericprogressiveimagefilereader_image.pnm",
+                color,
+                channel_count));
+    }
+
+    TEST_CASE(ReadCanvasProperties_ReturnsPropertiesOfFullResolutionLevel)
+    {
+        write_test_file();
+
+        TiledTextureFileReader reader;
+        reader.open(Filename);
+
+        CanvasProperties props;
+        reader.read_canvas_properties(props);
+
+        EXPECT_EQ(1, reader.get_level_count());
+        EXPECT_EQ(3, props.m_canvas_width);
+        EXPECT_EQ(3, props.m_canvas_height);
+        EXPECT_EQ(2, props.m_tile_width);
+        EXPECT_EQ(2, props.m_tile_height);
+        EXPECT_EQ(1, props.m_channel_count);
+        EXPECT_EQ(PixelFormatUInt8, props.m_pixel_format);
+    }
+
+    TEST_CASE(GetChannelStats_ReturnsStoredStatistics)
+    {
+        write_test_file();
+
+        TiledTextureFileReader reader;
+        reader.open(Filename);
+
+        EXPECT_FALSE(reader.is_constant());
+        EXPECT_EQ(11.0f / 255.0f, reader.get_channel_stats(0).m_average);
+        EXPECT_EQ(22.0f / 255.0f, reader.get_channel_stats(0).m_max);
+    }
+
+    TEST_CASE(ReadTile_GivenBorderTile_ReturnsTruncatedTile)
+    {
+        write_test_file();
+
+        TiledTextureFileReader reader;
+        reader.open(Filename);
+
+        auto_ptr<Tile> tile(reader.read_tile(1, 0));
+
+        ASSERT_EQ(1, tile->get_width());
+        ASSERT_EQ(2, tile->get_height());
+        EXPECT_EQ(2, tile->get_storage()[0]);
+        EXPECT_EQ(12, tile->get_storage()[1]);
+    }
+
+    TEST_CASE(ReadTile_GivenInteriorTile_ReturnsFullTile)
+    {
+        write_test_file();
+
+        TiledTextureFileReader reader;
+        reader.open(Filename);
+
+        auto_ptr<Tile> tile(reader.read_tile(0, 0, 0));
+
+        ASSERT_EQ(2, tile->get_width());
+        ASSERT_EQ(2, tile->get_height());
+        EXPECT_EQ(0, tile->get_storage()[0]);
+        EXPECT_EQ(1, tile->get_storage()[1]);
+        EXPECT_EQ(10, tile->get_storage()[2]);
+        EXPECT_EQ(11, tile->get_storage()[3]);
+    }
+}
@@ -0,0 +1,112 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/image.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/image/tiledtexturefileformat.h"
+#include "foundation/image/tiledtexturefilereader.h"
+#include "foundation/image/tiledtexturefilewriter.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Image_TiledTextureFileWriter)
+{
+    const char* Filename = "unit tests/outputs/test_tiledtexturefilewriter.astx";
+
+    TEST_CASE(Write_GeneratesMipmapChain)
+    {
+        Image image(5, 3, 2, 2, 4, PixelFormatFloat);
+        image.clear(Color4f(0.5f));
+
+        TiledTextureFileWriter writer(4, 4, PixelFormatHalf);
+        writer.write(Filename, image);
+
+        TiledTextureFileReader reader;
+        reader.open(Filename);
+
+        ASSERT_EQ(3, reader.get_level_count());
+        EXPECT_EQ(5, reader.get_level_properties(0).m_canvas_width);
+        EXPECT_EQ(3, reader.get_level_properties(0).m_canvas_height);
+        EXPECT_EQ(2, reader.get_level_properties(1).m_canvas_width);
+        EXPECT_EQ(1, reader.get_level_properties(1).m_canvas_height);
+        EXPECT_EQ(1, reader.get_level_properties(2).m_canvas_width);
+        EXPECT_EQ(1, reader.get_level_properties(2).m_canvas_height);
+        EXPECT_EQ(PixelFormatHalf, reader.get_level_properties(0).m_pixel_format);
+    }
+
+    TEST_CASE(Write_GivenConstantImage_FlagsFileAsConstant)
+    {
+        Image image(4, 4, 4, 4, 3, PixelFormatFloat);
+        image.clear(Color3f(0.25f, 0.5f, 1.0f));
+
+        TiledTextureFileWriter writer(2, 2, PixelFormatFloat);
+        writer.write(Filename, image);
+
+        TiledTextureFileReader reader;
+        reader.open(Filename);
+
+        EXPECT_TRUE(reader.is_constant());
+        EXPECT_EQ(0.25f, reader.get_channel_stats(0).m_average);
+        EXPECT_EQ(0.5f, reader.get_channel_stats(1).m_average);
+        EXPECT_EQ(1.0f, reader.get_channel_stats(2).m_max);
+    }
+
+    TEST_CASE(Write_GivenVaryingImage_ComputesStatisticsAndFiltersLevels)
+    {
+        Image image(2, 2, 2, 2, 1, PixelFormatFloat);
+        image.tile(0, 0).set_component(0, 0, 0, 0.0f);
+        image.tile(0, 0).set_component(1, 0, 0, 1.0f);
+        image.tile(0, 0).set_component(0, 1, 0, 2.0f);
+        image.tile(0, 0).set_component(1, 1, 0, 5.0f);
+
+        TiledTextureFileWriter writer(2, 2, PixelFormatFloat);
+        writer.write(Filename, image);
+
+        TiledTextureFileReader reader;
+        reader.open(Filename);
+
+        EXPECT_FALSE(reader.is_constant());
+        EXPECT_EQ(2.0f, reader.get_channel_stats(0).m_average);
+        EXPECT_EQ(5.0f, reader.get_channel_stats(0).m_max);
+
+        auto_ptr<Tile> tile(reader.read_tile(1, 0, 0));
+
+        ASSERT_EQ(1, tile->get_pixel_count());
+        EXPECT_EQ(2.0f, tile->get_component<float>(0, 0));
+    }
+}
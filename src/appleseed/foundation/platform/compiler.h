@@ -148,6 +148,25 @@ namespace foundation
 #define APPLESEED_RESTRICT __restrict
 
 
+//
+// A qualifier to give a variable thread storage duration.
+// Only suitable for plain old data types with static initialization.
+//
+
+// Visual C++.
+#if defined _MSC_VER
+    #define APPLESEED_THREAD_LOCAL __declspec(thread)
+
+// gcc and clang.
+#elif defined __GNUC__
+    #define APPLESEED_THREAD_LOCAL __thread
+
+// Other compilers: fall back to the C++11 keyword.
+#else
+    #define APPLESEED_THREAD_LOCAL thread_local
+#endif
+
+
 //
 // A qualifier to inform the compiler that code is unreachable.
 //
@@ -0,0 +1,186 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "memorymappedfile.h"
+
+// Platform headers.
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace foundation
+{
+
+//
+// MemoryMappedFile class implementation.
+//
+
+MemoryMappedFile::MemoryMappedFile()
+#ifdef _WIN32
+  : m_file(INVALID_HANDLE_VALUE)
+  , m_mapping(0)
+#else
+  : m_file(-1)
+#endif
+  , m_is_open(false)
+  , m_data(0)
+  , m_size(0)
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    close();
+}
+
+bool MemoryMappedFile::open(const char* path)
+{
+    close();
+
+#ifdef _WIN32
+
+    m_file =
+        CreateFileA(
+            path,
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            0,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+            0);
+
+    if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size))
+    {
+        close();
+        return false;
+    }
+
+    m_size = static_cast<size_t>(size.QuadPart);
+
+    // Empty files cannot be mapped.
+    if (m_size > 0)
+    {
+        m_mapping = CreateFileMappingA(m_file, 0, PAGE_READONLY, 0, 0, 0);
+
+        if (m_mapping == 0)
+        {
+            close();
+            return false;
+        }
+
+        m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+        if (m_data == 0)
+        {
+            close();
+            return false;
+        }
+    }
+
+#else
+
+    m_file = ::open(path, O_RDONLY);
+
+    if (m_file == -1)
+        return false;
+
+    struct stat file_stat;
+    if (fstat(m_file, &file_stat) != 0)
+    {
+        close();
+        return false;
+    }
+
+    m_size = static_cast<size_t>(file_stat.st_size);
+
+    // Empty files cannot be mapped.
+    if (m_size > 0)
+    {
+        void* data = mmap(0, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+
+        if (data == MAP_FAILED)
+        {
+            close();
+            return false;
+        }
+
+        m_data = static_cast<const char*>(data);
+
+        // The file will be read sequentially, possibly by several threads at once.
+        madvise(data, m_size, MADV_WILLNEED);
+    }
+
+#endif
+
+    m_is_open = true;
+
+    return true;
+}
+
+void MemoryMappedFile::close()
+{
+#ifdef _WIN32
+
+    if (m_data)
+        UnmapViewOfFile(m_data);
+
+    if (m_mapping)
+        CloseHandle(m_mapping);
+
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = 0;
+
+#else
+
+    if (m_data)
+        munmap(const_cast<char*>(m_data), m_size);
+
+    if (m_file != -1)
+        ::close(m_file);
+
+    m_file = -1;
+
+#endif
+
+    m_is_open = false;
+    m_data = 0;
+    m_size = 0;
+}
+
+}   // namespace foundation
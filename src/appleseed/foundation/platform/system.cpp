@@ -60,6 +60,7 @@
     #include <mach/task_info.h>
     #include <sys/mount.h>
     #include <sys/param.h>
+    #include <sys/resource.h>
     #include <sys/sysctl.h>
     #include <sys/types.h>
 
@@ -70,6 +71,7 @@
     #include <cstdio>
 
     // Platform headers.
+    #include <sys/resource.h>
     #include <sys/sysinfo.h>
     #include <sys/types.h>
     #include <unistd.h>
@@ -252,6 +254,18 @@ uint64 System::get_process_virtual_memory_size()
     return pmc.PrivateUsage;
 }
 
+uint64 System::get_peak_process_virtual_memory_size()
+{
+    // The peak commit charge, consistent with PrivateUsage above.
+    PROCESS_MEMORY_COUNTERS pmc;
+    GetProcessMemoryInfo(
+        GetCurrentProcess(),
+        &pmc,
+        sizeof(pmc));
+
+    return pmc.PeakPagefileUsage;
+}
+
 // ------------------------------------------------------------------------------------------------
 // OS X.
 // ------------------------------------------------------------------------------------------------
@@ -349,6 +363,16 @@ uint64 System::get_process_virtual_memory_size()
     return info.resident_size;
 }
 
+uint64 System::get_peak_process_virtual_memory_size()
+{
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0)
+        return 0;
+
+    // On OS X, ru_maxrss is expressed in bytes.
+    return static_cast<uint64>(ru.ru_maxrss);
+}
+
 // ------------------------------------------------------------------------------------------------
 // Linux.
 // ------------------------------------------------------------------------------------------------
@@ -429,6 +453,16 @@ uint64 System::get_process_virtual_memory_size()
     return static_cast<uint64>(rss) * sysconf(_SC_PAGESIZE);
 }
 
+uint64 System::get_peak_process_virtual_memory_size()
+{
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0)
+        return 0;
+
+    // On Linux, ru_maxrss is expressed in kilobytes.
+    return static_cast<uint64>(ru.ru_maxrss) * 1024;
+}
+
 // ------------------------------------------------------------------------------------------------
 // FreeBSD.
 // ------------------------------------------------------------------------------------------------
@@ -812,6 +846,12 @@ uint64 System::get_process_virtual_memory_size()
     return static_cast<uint64>(ru.ru_maxrss) * 1024;
 }
 
+uint64 System::get_peak_process_virtual_memory_size()
+{
+    // get_process_virtual_memory_size() already returns the peak resident set size.
+    return get_process_virtual_memory_size();
+}
+
 #endif
 
 }   // namespace foundation
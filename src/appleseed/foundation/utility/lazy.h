@@ -99,6 +99,12 @@ class Lazy
     // Return the source object associated with that lazy object, if any.
     ObjectType* get_source_object() const;
 
+    // Delete the object if it was created by the factory and nobody is accessing it,
+    // so that the factory creates it again the next time it is accessed. Never blocks:
+    // returns false without doing anything if another thread holds the lazy object.
+    // Returns true if the object was deleted.
+    bool try_evict();
+
   private:
     template <typename> friend class Access;
 
@@ -141,7 +147,7 @@ class Access
     // if any. Note that releasing access to a lazy object does not
     // imply that the object is deleted, even if the reference count
     // on this object has reached 0. An object is deleted only if it
-    // is garbage-collected.
+    // is evicted with Lazy::try_evict().
     void reset(LazyType* lazy);
 
     // Get the object pointer.
@@ -387,6 +393,23 @@ inline typename Lazy<Object>::ObjectType* Lazy<Object>::get_source_object() cons
     return m_source_object;
 }
 
+template <typename Object>
+bool Lazy<Object>::try_evict()
+{
+    boost::mutex::scoped_try_lock lock(m_mutex);
+
+    if (!lock.owns_lock())
+        return false;
+
+    if (!m_own_object || m_reference_count > 0 || m_object == 0)
+        return false;
+
+    delete m_object;
+    m_object = 0;
+
+    return true;
+}
+
 
 //
 // Access class implementation.
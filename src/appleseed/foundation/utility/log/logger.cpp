@@ -35,21 +35,38 @@
 #include "foundation/platform/snprintf.h"
 #include "foundation/platform/system.h"
 #include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/log/ilogtarget.h"
 #include "foundation/utility/string.h"
 
 // Boost headers.
+#include "boost/atomic/atomic.hpp"
+#include "boost/bind.hpp"
 #include "boost/date_time/posix_time/posix_time.hpp"
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+
+// Platform headers.
+#ifndef _WIN32
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
 
 // Standard headers.
 #include <algorithm>
 #include <cassert>
 #include <cstdarg>
+#include <cstddef>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <list>
 #include <map>
+#include <memory>
+#include <string>
 #include <vector>
 
 using namespace boost::posix_time;
@@ -196,6 +213,156 @@ namespace
         size_t              m_thread_count;
         ThreadIdToIntMap    m_thread_id_to_int;
     };
+
+    // A message waiting to be sent to log targets.
+    struct LogRecord
+    {
+        LogMessage::Category    m_category;
+        const char*             m_file;
+        size_t                  m_line;
+        ptime                   m_datetime;
+        boost::thread::id       m_thread_id;
+        string                  m_message;
+    };
+
+    //
+    // A bounded, lock-free, multiple producers / single consumer queue of log records.
+    //
+    // Each slot carries a sequence number that tells producers and the consumer
+    // whether the slot is free or holds a published record. Record contents are
+    // swapped in and out of slots so that message strings are never copied.
+    //
+    // Reference:
+    //
+    //   http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+    //
+
+    class LogRecordQueue
+      : public NonCopyable
+    {
+      public:
+        explicit LogRecordQueue(const size_t capacity)
+          : m_capacity(next_power_of_two(capacity))
+          , m_mask(m_capacity - 1)
+          , m_slots(new Slot[m_capacity])
+          , m_push_count(0)
+          , m_pop_count(0)
+        {
+            for (size_t i = 0; i < m_capacity; ++i)
+                m_slots[i].m_sequence.store(i, boost::memory_order_relaxed);
+        }
+
+        ~LogRecordQueue()
+        {
+            delete [] m_slots;
+        }
+
+        size_t capacity() const
+        {
+            return m_capacity;
+        }
+
+        // Return the number of records pushed so far.
+        size_t get_push_count() const
+        {
+            return m_push_count.load(boost::memory_order_acquire);
+        }
+
+        // Thread-safe. Return false if the queue is full.
+        bool try_push(LogRecord& record)
+        {
+            size_t pos = m_push_count.load(boost::memory_order_relaxed);
+            Slot* slot;
+
+            while (true)
+            {
+                slot = &m_slots[pos & m_mask];
+
+                const size_t seq = slot->m_sequence.load(boost::memory_order_acquire);
+                const ptrdiff_t diff = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos);
+
+                if (diff == 0)
+                {
+                    if (m_push_count.compare_exchange_weak(pos, pos + 1, boost::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                    return false;
+                else pos = m_push_count.load(boost::memory_order_relaxed);
+            }
+
+            swap_records(slot->m_record, record);
+            slot->m_sequence.store(pos + 1, boost::memory_order_release);
+
+            return true;
+        }
+
+        // Must only be called by the consumer. Return false if the queue is empty.
+        bool try_pop(LogRecord& record)
+        {
+            const size_t pos = m_pop_count.load(boost::memory_order_relaxed);
+            Slot& slot = m_slots[pos & m_mask];
+
+            const size_t seq = slot.m_sequence.load(boost::memory_order_acquire);
+            if (static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos + 1) < 0)
+                return false;
+
+            swap_records(record, slot.m_record);
+            m_pop_count.store(pos + 1, boost::memory_order_relaxed);
+            slot.m_sequence.store(pos + m_capacity, boost::memory_order_release);
+
+            return true;
+        }
+
+        // Must only be called by the consumer. Return the n'th published record from
+        // the front of the queue without popping it, or 0 if there is no such record.
+        const LogRecord* peek(const size_t n) const
+        {
+            const size_t pos = m_pop_count.load(boost::memory_order_relaxed) + n;
+            const Slot& slot = m_slots[pos & m_mask];
+
+            const size_t seq = slot.m_sequence.load(boost::memory_order_acquire);
+            return n < m_capacity && seq == pos + 1 ? &slot.m_record : 0;
+        }
+
+      private:
+        struct Slot
+        {
+            boost::atomic<size_t>   m_sequence;
+            LogRecord               m_record;
+        };
+
+        const size_t                m_capacity;
+        const size_t                m_mask;
+        Slot*                       m_slots;
+
+        // Keep producer and consumer counters on separate cache lines.
+        char                        m_pad0[64];
+        boost::atomic<size_t>       m_push_count;
+        char                        m_pad1[64];
+        boost::atomic<size_t>       m_pop_count;
+        char                        m_pad2[64];
+
+        static size_t next_power_of_two(const size_t n)
+        {
+            size_t result = 1;
+
+            while (result < n)
+                result *= 2;
+
+            return result;
+        }
+
+        static void swap_records(LogRecord& lhs, LogRecord& rhs)
+        {
+            swap(lhs.m_category, rhs.m_category);
+            swap(lhs.m_file, rhs.m_file);
+            swap(lhs.m_line, rhs.m_line);
+            swap(lhs.m_datetime, rhs.m_datetime);
+            swap(lhs.m_thread_id, rhs.m_thread_id);
+            lhs.m_message.swap(rhs.m_message);
+        }
+    };
 }
 
 
@@ -203,24 +370,383 @@ namespace
 // Logger class implementation.
 //
 
+namespace
+{
+    const size_t InitialBufferSize = 1024;      // in bytes
+    const size_t MaxBufferSize = 1024 * 1024;   // in bytes
+
+    const size_t MaxAsyncLoggers = 16;          // maximum number of loggers flushed on crash
+    const uint32 DrainerIdleWaitMs = 10;        // how long the background thread sleeps when idle
+
+#ifndef _WIN32
+
+    const int CrashSignals[] = { SIGABRT, SIGSEGV, SIGFPE, SIGILL };
+    const size_t CrashSignalCount = sizeof(CrashSignals) / sizeof(CrashSignals[0]);
+
+    // Write a buffer to a file descriptor. Async-signal-safe.
+    void write_to_fd(const int fd, const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            const ssize_t written = ::write(fd, data, size);
+
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                return;
+            }
+
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+#endif
+}
+
 struct Logger::Impl
 {
     typedef list<ILogTarget*> LogTargetContainer;
 
-    boost::mutex            m_mutex;
-    bool                    m_enabled;
-    LogMessage::Category    m_verbosity_level;
-    LogTargetContainer      m_targets;
-    vector<char>            m_message_buffer;
-    ThreadMap               m_thread_map;
-    Formatter               m_formatter;
+    boost::mutex                    m_mutex;
+    boost::atomic<bool>             m_enabled;
+    boost::atomic<LogMessage::Category> m_verbosity_level;
+    LogTargetContainer              m_targets;
+    vector<char>                    m_message_buffer;
+    ThreadMap                       m_thread_map;
+    Formatter                       m_formatter;
+
+    // Asynchronous mode.
+    boost::mutex                    m_async_mutex;          // serializes enabling and disabling asynchronous mode
+    boost::atomic<bool>             m_async_enabled;
+    boost::atomic<size_t>           m_async_writers;        // number of threads currently pushing records
+    auto_ptr<LogRecordQueue>        m_queue;
+    OverflowPolicy                  m_overflow_policy;
+    size_t                          m_max_messages_per_second;
+    boost::atomic<int64>            m_rate_window;          // second during which m_rate_window_count was accumulated
+    boost::atomic<size_t>           m_rate_window_count;
+    boost::atomic<size_t>           m_dropped_count;
+    boost::atomic<size_t>           m_written_count;        // number of records sent to log targets
+    boost::atomic<bool>             m_drainer_busy;         // grants exclusive access to the consumer side of the queue
+    boost::atomic<bool>             m_drainer_waiting;
+    boost::atomic<bool>             m_stop_drainer;
+    boost::mutex                    m_drainer_mutex;
+    boost::condition_variable       m_drainer_wakeup;
+    auto_ptr<boost::thread>         m_drainer_thread;
+    boost::atomic<int>              m_crash_fd;             // file descriptor written to on crash, -1 if disabled
+
+    // Loggers in asynchronous mode, flushed when the program crashes.
+    static boost::atomic<Impl*>     s_async_loggers[MaxAsyncLoggers];
+
+#ifndef _WIN32
+    static boost::atomic<bool>      s_crash_handlers_installed;
+    static struct sigaction         s_previous_actions[CrashSignalCount];
+#endif
+
+    // Format a message and send it to all log targets. m_mutex must be locked.
+    void send_to_targets(
+        const LogMessage::Category  category,
+        const char*                 file,
+        const size_t                line,
+        const ptime&                datetime,
+        const boost::thread::id     thread_id,
+        const char*                 text)
+    {
+        const size_t thread = m_thread_map.thread_id_to_int(thread_id);
+        const FormatEvaluator format_evaluator(category, datetime, thread, text);
+        const string header = format_evaluator.evaluate(m_formatter.get_header_format(category));
+        const string message = format_evaluator.evaluate(m_formatter.get_message_format(category));
+
+        if (message.empty())
+            return;
+
+        for (const_each<LogTargetContainer> i = m_targets; i; ++i)
+        {
+            ILogTarget* target = *i;
+            target->write(
+                category,
+                file,
+                line,
+                header.c_str(),
+                message.c_str());
+        }
+    }
+
+    // Send all published records to log targets. m_drainer_busy must be held.
+    size_t drain_queue()
+    {
+        size_t count = 0;
+        LogRecord record;
+
+        while (m_queue->try_pop(record))
+        {
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+
+                send_to_targets(
+                    record.m_category,
+                    record.m_file,
+                    record.m_line,
+                    record.m_datetime,
+                    record.m_thread_id,
+                    record.m_message.c_str());
+            }
+
+            m_written_count.fetch_add(1);
+            ++count;
+        }
+
+        report_dropped_messages();
+
+        return count;
+    }
+
+    // Emit a warning if messages were dropped since the last report. m_drainer_busy must be held.
+    void report_dropped_messages()
+    {
+        const size_t dropped_count = m_dropped_count.exchange(0);
+
+        if (dropped_count == 0)
+            return;
+
+        const string text =
+            "logger dropped " + to_string(dropped_count) + " message" +
+            (dropped_count > 1 ? "s" : "") + " in asynchronous mode.";
+
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        send_to_targets(
+            LogMessage::Warning,
+            __FILE__,
+            __LINE__,
+            microsec_clock::universal_time(),
+            boost::this_thread::get_id(),
+            text.c_str());
+    }
+
+    void acquire_drainer()
+    {
+        bool expected = false;
+        while (!m_drainer_busy.compare_exchange_weak(expected, true, boost::memory_order_acquire))
+        {
+            expected = false;
+            yield();
+        }
+    }
+
+    void release_drainer()
+    {
+        m_drainer_busy.store(false, boost::memory_order_release);
+    }
+
+    // Entry point of the background thread.
+    void run_drainer()
+    {
+        while (true)
+        {
+            const bool stop = m_stop_drainer.load();
+
+            acquire_drainer();
+            const size_t count = drain_queue();
+            release_drainer();
+
+            if (count > 0)
+                continue;
+
+            if (stop)
+                break;
+
+            boost::mutex::scoped_lock lock(m_drainer_mutex);
+            m_drainer_waiting.store(true);
+            m_drainer_wakeup.timed_wait(lock, boost::posix_time::milliseconds(DrainerIdleWaitMs));
+            m_drainer_waiting.store(false);
+        }
+    }
+
+    void wake_drainer()
+    {
+        if (m_drainer_waiting.load())
+        {
+            boost::mutex::scoped_lock lock(m_drainer_mutex);
+            m_drainer_wakeup.notify_one();
+        }
+    }
+
+    // Return true if a debug or info message exceeds the rate limit.
+    bool is_rate_limited(const ptime& datetime)
+    {
+        if (m_max_messages_per_second == 0)
+            return false;
+
+        static const ptime Epoch(boost::gregorian::date(1970, 1, 1));
+        const int64 second = (datetime - Epoch).total_seconds();
+
+        int64 window = m_rate_window.load(boost::memory_order_relaxed);
+        if (window != second && m_rate_window.compare_exchange_strong(window, second))
+            m_rate_window_count.store(0, boost::memory_order_relaxed);
+
+        return m_rate_window_count.fetch_add(1, boost::memory_order_relaxed) >= m_max_messages_per_second;
+    }
+
+    // Push a record into the queue. Return false if asynchronous mode is disabled.
+    bool push_record(LogRecord& record)
+    {
+        m_async_writers.fetch_add(1);
+
+        if (!m_async_enabled.load())
+        {
+            m_async_writers.fetch_sub(1);
+            return false;
+        }
+
+        const bool may_drop = record.m_category < LogMessage::Warning;
+
+        if (may_drop && is_rate_limited(record.m_datetime))
+            m_dropped_count.fetch_add(1, boost::memory_order_relaxed);
+        else
+        {
+            while (!m_queue->try_push(record))
+            {
+                if (may_drop && m_overflow_policy == OverflowDrop)
+                {
+                    m_dropped_count.fetch_add(1, boost::memory_order_relaxed);
+                    break;
+                }
+
+                wake_drainer();
+                yield();
+            }
+
+            wake_drainer();
+        }
+
+        m_async_writers.fetch_sub(1);
+        return true;
+    }
+
+    // Wait until all records pushed so far have been sent to log targets.
+    void wait_for_drainer()
+    {
+        const size_t target = m_queue->get_push_count();
+
+        while (m_written_count.load() < target)
+        {
+            wake_drainer();
+            yield();
+        }
+    }
+
+    void stop_async_mode()
+    {
+        if (!m_async_enabled.load())
+            return;
+
+        unregister_async_logger(this);
+
+        // Stop accepting records and wait for in-flight pushes to complete.
+        m_async_enabled.store(false);
+        while (m_async_writers.load() > 0)
+            yield();
+
+        // Let the background thread drain the queue and exit.
+        m_stop_drainer.store(true);
+        wake_drainer();
+        m_drainer_thread->join();
+        m_drainer_thread.reset();
+    }
+
+    static void register_async_logger(Impl* impl)
+    {
+        for (size_t i = 0; i < MaxAsyncLoggers; ++i)
+        {
+            Impl* expected = 0;
+            if (s_async_loggers[i].compare_exchange_strong(expected, impl))
+                return;
+        }
+    }
+
+    static void unregister_async_logger(Impl* impl)
+    {
+        for (size_t i = 0; i < MaxAsyncLoggers; ++i)
+        {
+            Impl* expected = impl;
+            s_async_loggers[i].compare_exchange_strong(expected, static_cast<Impl*>(0));
+        }
+    }
+
+#ifndef _WIN32
+
+    static void install_crash_handlers()
+    {
+        bool expected = false;
+        if (!s_crash_handlers_installed.compare_exchange_strong(expected, true))
+            return;
+
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = &Impl::on_crash_signal;
+        sigemptyset(&action.sa_mask);
+
+        for (size_t i = 0; i < CrashSignalCount; ++i)
+            sigaction(CrashSignals[i], &action, &s_previous_actions[i]);
+    }
+
+    // Best-effort flush of all asynchronous loggers when the program crashes.
+    // Only async-signal-safe calls are made: the text of queued messages is
+    // written as is, records are left in the queue and nothing is allocated.
+    // Loggers whose queue is in use by another thread are skipped.
+    static void on_crash_signal(int sig)
+    {
+        for (size_t i = 0; i < MaxAsyncLoggers; ++i)
+        {
+            Impl* impl = s_async_loggers[i].load();
+            if (impl == 0)
+                continue;
+
+            const int fd = impl->m_crash_fd.load();
+            if (fd < 0)
+                continue;
+
+            bool expected = false;
+            if (!impl->m_drainer_busy.compare_exchange_strong(expected, true))
+                continue;
+
+            for (size_t n = 0; const LogRecord* record = impl->m_queue->peek(n); ++n)
+            {
+                const char* category = LogMessage::get_padded_category_name(record->m_category);
+                write_to_fd(fd, category, strlen(category));
+                write_to_fd(fd, " | ", 3);
+                write_to_fd(fd, record->m_message.data(), record->m_message.size());
+                write_to_fd(fd, "\n", 1);
+            }
+
+            impl->m_drainer_busy.store(false);
+        }
+
+        // Chain to the previous handler.
+        for (size_t i = 0; i < CrashSignalCount; ++i)
+        {
+            if (CrashSignals[i] == sig)
+            {
+                sigaction(sig, &s_previous_actions[i], 0);
+                break;
+            }
+        }
+
+        raise(sig);
+    }
+
+#endif
 };
 
-namespace
-{
-    const size_t InitialBufferSize = 1024;      // in bytes
-    const size_t MaxBufferSize = 1024 * 1024;   // in bytes
-}
+boost::atomic<Logger::Impl*> Logger::Impl::s_async_loggers[MaxAsyncLoggers];
+
+#ifndef _WIN32
+boost::atomic<bool> Logger::Impl::s_crash_handlers_installed(false);
+struct sigaction Logger::Impl::s_previous_actions[CrashSignalCount];
+#endif
 
 Logger::Logger()
   : impl(new Impl())
@@ -228,10 +754,23 @@ Logger::Logger()
     impl->m_enabled = true;
     impl->m_verbosity_level = LogMessage::Info;
     impl->m_message_buffer.resize(InitialBufferSize);
+    impl->m_async_enabled = false;
+    impl->m_async_writers = 0;
+    impl->m_overflow_policy = OverflowBlock;
+    impl->m_max_messages_per_second = 0;
+    impl->m_rate_window = 0;
+    impl->m_rate_window_count = 0;
+    impl->m_dropped_count = 0;
+    impl->m_written_count = 0;
+    impl->m_drainer_busy = false;
+    impl->m_drainer_waiting = false;
+    impl->m_stop_drainer = false;
+    impl->m_crash_fd = -1;
 }
 
 Logger::~Logger()
 {
+    disable_async_mode();
     delete impl;
 }
 
@@ -240,8 +779,8 @@ void Logger::initialize_from(const Logger& source)
     boost::mutex::scoped_lock source_lock(source.impl->m_mutex);
     boost::mutex::scoped_lock this_lock(impl->m_mutex);
 
-    impl->m_enabled = source.impl->m_enabled;
-    impl->m_verbosity_level = source.impl->m_verbosity_level;
+    impl->m_enabled = source.impl->m_enabled.load();
+    impl->m_verbosity_level = source.impl->m_verbosity_level.load();
 
     impl->m_targets.clear();
     for (const_each<Impl::LogTargetContainer> i = source.impl->m_targets; i; ++i)
@@ -256,19 +795,16 @@ void Logger::initialize_from(const Logger& source)
 
 void Logger::set_enabled(const bool enabled)
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
     impl->m_enabled = enabled;
 }
 
 void Logger::set_verbosity_level(const LogMessage::Category level)
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
     impl->m_verbosity_level = level;
 }
 
 LogMessage::Category Logger::get_verbosity_level() const
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
     return impl->m_verbosity_level;
 }
 
@@ -359,26 +895,178 @@ namespace
     }
 }
 
+void Logger::enable_async_mode(
+    const size_t                        queue_capacity,
+    const OverflowPolicy                overflow_policy,
+    const size_t                        max_messages_per_second)
+{
+    assert(queue_capacity > 0);
+
+    boost::mutex::scoped_lock lock(impl->m_async_mutex);
+
+    impl->stop_async_mode();
+
+    if (impl->m_queue.get() == 0 || impl->m_queue->capacity() < queue_capacity)
+    {
+        impl->m_queue.reset(new LogRecordQueue(queue_capacity));
+        impl->m_written_count = 0;
+    }
+
+    impl->m_overflow_policy = overflow_policy;
+    impl->m_max_messages_per_second = max_messages_per_second;
+    impl->m_rate_window = 0;
+    impl->m_rate_window_count = 0;
+    impl->m_stop_drainer = false;
+
+    impl->m_drainer_thread.reset(
+        new boost::thread(boost::bind(&Impl::run_drainer, impl)));
+
+    Impl::register_async_logger(impl);
+
+    impl->m_async_enabled = true;
+}
+
+void Logger::disable_async_mode()
+{
+    boost::mutex::scoped_lock lock(impl->m_async_mutex);
+    impl->stop_async_mode();
+}
+
+bool Logger::is_async_mode_enabled() const
+{
+    return impl->m_async_enabled;
+}
+
+void Logger::enable_crash_flushing(const int fd)
+{
+    assert(fd >= 0);
+
+#ifndef _WIN32
+    impl->m_crash_fd = fd;
+    Impl::install_crash_handlers();
+#endif
+}
+
+void Logger::disable_crash_flushing()
+{
+    impl->m_crash_fd = -1;
+}
+
+void Logger::flush()
+{
+    boost::mutex::scoped_lock lock(impl->m_async_mutex);
+
+    if (impl->m_async_enabled)
+        impl->wait_for_drainer();
+}
+
+namespace
+{
+    // Format a message into a string. Return false if formatting failed.
+    bool write_to_string(
+        string&         output,
+        const char*     format,
+        va_list         argptr)
+    {
+        char buffer[InitialBufferSize];
+
+        va_list argptr_copy;
+        va_copy(argptr_copy, argptr);
+        const int result = portable_vsnprintf(buffer, sizeof(buffer), format, argptr_copy);
+        va_end(argptr_copy);
+
+        if (result < 0)
+        {
+            output = "(failed to format message, format string is \"" + replace(format, "\n", "\\n") + "\".)";
+            return false;
+        }
+
+        const size_t length = static_cast<size_t>(result);
+
+        if (length < sizeof(buffer))
+        {
+            output.assign(buffer, length);
+            return true;
+        }
+
+        const size_t buffer_size = min(length + 1, MaxBufferSize);
+        output.resize(buffer_size);
+
+        va_copy(argptr_copy, argptr);
+        portable_vsnprintf(&output[0], buffer_size, format, argptr_copy);
+        va_end(argptr_copy);
+
+        output.resize(buffer_size - 1);
+        return length + 1 <= MaxBufferSize;
+    }
+}
+
 void Logger::write(
     const LogMessage::Category          category,
     const char*                         file,
     const size_t                        line,
     APPLESEED_PRINTF_FMT const char*    format, ...)
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
-
     if (category < impl->m_verbosity_level)
         return;
 
+    if (!impl->m_enabled)
+    {
+        // Terminate the application if the message category is 'Fatal'.
+        if (category == LogMessage::Fatal)
+            exit(EXIT_FAILURE);
+
+        return;
+    }
+
+    if (impl->m_async_enabled && category != LogMessage::Fatal)
+    {
+        // Format the message on the calling thread, without any locking.
+        LogRecord record;
+
+        va_list argptr;
+        va_start(argptr, format);
+        const bool formatting_succeeded = write_to_string(record.m_message, format, argptr);
+        va_end(argptr);
+
+        // If formatting failed, print the message as an error.
+        record.m_category = formatting_succeeded ? category : LogMessage::Error;
+        record.m_file = file;
+        record.m_line = line;
+        record.m_datetime = microsec_clock::universal_time();
+        record.m_thread_id = boost::this_thread::get_id();
+
+        if (impl->push_record(record))
+            return;
+
+        // Asynchronous mode was disabled concurrently, write the message synchronously.
+        boost::mutex::scoped_lock lock(impl->m_mutex);
+        impl->send_to_targets(
+            record.m_category,
+            record.m_file,
+            record.m_line,
+            record.m_datetime,
+            record.m_thread_id,
+            record.m_message.c_str());
+
+        return;
+    }
+
+    // Make sure queued messages are written before a fatal message.
+    if (category == LogMessage::Fatal)
+        flush();
+
     LogMessage::Category effective_category = category;
 
-    if (impl->m_enabled)
     {
+        boost::mutex::scoped_lock lock(impl->m_mutex);
+
         // Format the message into the temporary buffer.
         va_list argptr;
         va_start(argptr, format);
         const bool formatting_succeeded =
             write_to_buffer(impl->m_message_buffer, MaxBufferSize, format, argptr);
+        va_end(argptr);
 
         // If formatting failed, print the message as an error.
         if (!formatting_succeeded)
@@ -387,26 +1075,14 @@ void Logger::write(
         // Retrieve the current UTC time.
         const ptime datetime(microsec_clock::universal_time());
 
-        // Format the header and message.
-        const size_t thread = impl->m_thread_map.thread_id_to_int(boost::this_thread::get_id());
-        const FormatEvaluator format_evaluator(effective_category, datetime, thread, &impl->m_message_buffer[0]);
-        const string header = format_evaluator.evaluate(impl->m_formatter.get_header_format(effective_category));
-        const string message = format_evaluator.evaluate(impl->m_formatter.get_message_format(effective_category));
-
-        if (!message.empty())
-        {
-            // Send the header and message to all log targets.
-            for (const_each<Impl::LogTargetContainer> i = impl->m_targets; i; ++i)
-            {
-                ILogTarget* target = *i;
-                target->write(
-                    effective_category,
-                    file,
-                    line,
-                    header.c_str(),
-                    message.c_str());
-            }
-        }
+        // Format the header and message and send them to all log targets.
+        impl->send_to_targets(
+            effective_category,
+            file,
+            line,
+            datetime,
+            boost::this_thread::get_id(),
+            &impl->m_message_buffer[0]);
     }
 
     // Terminate the application if the message category is 'Fatal'.
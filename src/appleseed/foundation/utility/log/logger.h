@@ -53,6 +53,15 @@ namespace foundation
 //
 // All methods of this class are thread-safe.
 //
+// By default, messages are formatted and sent to log targets on the calling
+// thread, under a lock. In asynchronous mode, the calling thread only formats
+// the message text and timestamps it, then pushes it into a bounded lock-free
+// queue. A background thread drains the queue and writes to the log targets.
+// Warnings, errors and fatal messages are never dropped; fatal messages flush
+// the queue and are then written synchronously. Queued messages can also be
+// written to a file descriptor, on a best-effort basis, when the program aborts
+// or crashes (see enable_crash_flushing()).
+//
 
 class APPLESEED_DLLSYMBOL Logger
   : public NonCopyable
@@ -103,6 +112,39 @@ class APPLESEED_DLLSYMBOL Logger
     // Log targets can be removed at any time.
     void remove_target(ILogTarget* target);
 
+    // Policy applied in asynchronous mode to debug and info messages when the queue is full.
+    enum OverflowPolicy
+    {
+        OverflowBlock,      // wait until the background thread makes room in the queue
+        OverflowDrop        // drop the message
+    };
+
+    // Enable asynchronous mode. queue_capacity is rounded up to the next power of two.
+    // If max_messages_per_second is not zero, debug and info messages in excess of this
+    // rate are dropped. A warning reports the number of dropped messages.
+    void enable_async_mode(
+        const size_t                        queue_capacity = 4096,
+        const OverflowPolicy                overflow_policy = OverflowBlock,
+        const size_t                        max_messages_per_second = 0);
+
+    // Flush pending messages, stop the background thread and return to synchronous mode.
+    void disable_async_mode();
+
+    // Return true if asynchronous mode is enabled.
+    bool is_async_mode_enabled() const;
+
+    // Install process-wide handlers for SIGABRT, SIGSEGV, SIGFPE and SIGILL that write
+    // the messages still queued in asynchronous mode to a given file descriptor.
+    // Messages are written as raw text, without headers and bypassing log targets.
+    // Disabled by default. Not supported on Windows, where this does nothing.
+    void enable_crash_flushing(const int fd = 2);
+    void disable_crash_flushing();
+
+    // Wait until all messages written so far have been sent to log targets.
+    // Must be called before destroying log targets that are still in use
+    // while asynchronous mode is enabled. Does nothing in synchronous mode.
+    void flush();
+
     // Write a message. If the message category is Fatal,
     // this function will not return and the program will
     // be terminated.
@@ -0,0 +1,499 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "packfile.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/string.h"
+#include "foundation/utility/zip.h"
+
+// Boost headers.
+#include "boost/filesystem.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <set>
+
+using namespace std;
+namespace bf = boost::filesystem;
+
+namespace foundation
+{
+
+//
+// PackFileException class implementation.
+//
+
+PackFileException::PackFileException(const char* what)
+  : Exception(what)
+{
+}
+
+
+//
+// Pack file layout.
+//
+
+namespace
+{
+    const char PackFileMagic[8] = { 'A', 'S', 'P', 'A', 'C', 'K', '\r', '\n' };
+    const uint16 PackFileVersion = 1;
+
+    struct PackFileHeader
+    {
+        char    m_magic[8];
+        uint16  m_version;
+        uint16  m_reserved;
+        uint32  m_entry_count;
+        uint64  m_string_table_size;
+    };
+
+    struct PackFileIndexEntry
+    {
+        uint64  m_offset;
+        uint64  m_size;
+        uint32  m_path_offset;
+        uint32  m_path_size;
+    };
+
+    uint64 align(const uint64 offset)
+    {
+        return (offset + PackFileAlignment - 1) & ~static_cast<uint64>(PackFileAlignment - 1);
+    }
+
+    bool read_header(const char* data, const size_t size, PackFileHeader& header)
+    {
+        if (size < sizeof(PackFileHeader))
+            return false;
+
+        memcpy(&header, data, sizeof(PackFileHeader));
+
+        return memcmp(header.m_magic, PackFileMagic, sizeof(PackFileMagic)) == 0;
+    }
+
+    // Split a path into its components, ignoring '.' components.
+    vector<string> get_path_components(const bf::path& path)
+    {
+        vector<string> components;
+
+        for (bf::path::const_iterator i = path.begin(); i != path.end(); ++i)
+        {
+            if (*i != ".")
+                components.push_back(i->string());
+        }
+
+        return components;
+    }
+
+    // Return true if a path is relative and has no '..' component.
+    bool is_valid_entry_path(const string& path)
+    {
+        if (path.empty() || path[0] == '/' || path[0] == '\\')
+            return false;
+
+        // Reject paths starting with a drive letter.
+        if (path.size() >= 2 && path[1] == ':')
+            return false;
+
+        size_t begin = 0;
+
+        while (begin <= path.size())
+        {
+            size_t end = path.find_first_of("/\\", begin);
+            if (end == string::npos)
+                end = path.size();
+
+            if (path.compare(begin, end - begin, "..") == 0)
+                return false;
+
+            begin = end + 1;
+        }
+
+        return true;
+    }
+}
+
+
+//
+// PackFileReader class implementation.
+//
+
+PackFileReader::PackFileReader(const string& pack_filename)
+{
+    if (!m_file.open(pack_filename.c_str()))
+        throw PackFileException(("can't open file " + pack_filename).c_str());
+
+    const char* data = m_file.data();
+    const uint64 file_size = m_file.size();
+
+    PackFileHeader header;
+    if (!read_header(data, m_file.size(), header))
+        throw PackFileException((pack_filename + " is not a pack file").c_str());
+
+    if (header.m_version != PackFileVersion)
+        throw PackFileException(("unsupported version of pack file " + pack_filename).c_str());
+
+    const uint64 index_offset = sizeof(PackFileHeader);
+    const uint64 string_table_offset =
+        index_offset + static_cast<uint64>(header.m_entry_count) * sizeof(PackFileIndexEntry);
+
+    if (string_table_offset + header.m_string_table_size > file_size)
+        throw PackFileException(("truncated pack file " + pack_filename).c_str());
+
+    m_entries.resize(header.m_entry_count);
+
+    for (size_t i = 0; i < m_entries.size(); ++i)
+    {
+        PackFileIndexEntry index_entry;
+        memcpy(
+            &index_entry,
+            data + index_offset + i * sizeof(PackFileIndexEntry),
+            sizeof(PackFileIndexEntry));
+
+        if (index_entry.m_offset > file_size ||
+            index_entry.m_size > file_size - index_entry.m_offset ||
+            static_cast<uint64>(index_entry.m_path_offset) + index_entry.m_path_size > header.m_string_table_size)
+            throw PackFileException(("corrupted pack file " + pack_filename).c_str());
+
+        Entry& entry = m_entries[i];
+        entry.m_path.assign(
+            data + string_table_offset + index_entry.m_path_offset,
+            index_entry.m_path_size);
+        entry.m_offset = index_entry.m_offset;
+        entry.m_size = index_entry.m_size;
+
+        if (!is_valid_entry_path(entry.m_path))
+        {
+            throw PackFileException(
+                ("invalid path \"" + entry.m_path + "\" in pack file " + pack_filename).c_str());
+        }
+    }
+}
+
+size_t PackFileReader::find_entry(const string& path) const
+{
+    for (size_t i = 0; i < m_entries.size(); ++i)
+    {
+        if (m_entries[i].m_path == path)
+            return i;
+    }
+
+    return ~size_t(0);
+}
+
+size_t PackFileReader::find_unpacked_entry(
+    const string&   unpacked_dir,
+    const string&   filepath) const
+{
+    const vector<string> dir_components = get_path_components(bf::absolute(unpacked_dir));
+    const vector<string> file_components = get_path_components(bf::absolute(filepath));
+
+    if (file_components.size() <= dir_components.size() ||
+        !equal(dir_components.begin(), dir_components.end(), file_components.begin()))
+        return ~size_t(0);
+
+    // Build the relative path of the file, using '/' as separator.
+    string path;
+
+    for (size_t i = dir_components.size(); i < file_components.size(); ++i)
+    {
+        if (!path.empty())
+            path += '/';
+
+        path += file_components[i];
+    }
+
+    return find_entry(path);
+}
+
+
+//
+// Free functions implementation.
+//
+
+namespace
+{
+    void write_bytes(FILE* file, const void* data, const size_t size, const string& filename)
+    {
+        if (size > 0 && fwrite(data, 1, size, file) != size)
+            throw PackFileException(("i/o error while writing to " + filename).c_str());
+    }
+
+    void write_padding(FILE* file, const uint64 size, const string& filename)
+    {
+        const char zeros[PackFileAlignment] = { 0 };
+        write_bytes(file, zeros, static_cast<size_t>(size), filename);
+    }
+
+    void pack_current_file(FILE* file, const string& filename_in_fs, const string& pack_filename)
+    {
+        FILE* in = fopen(filename_in_fs.c_str(), "rb");
+        if (in == 0)
+            throw PackFileException(("can't open file " + filename_in_fs).c_str());
+
+        const size_t BufferSize = 1024 * 1024;
+        vector<char> buffer(BufferSize);
+
+        try
+        {
+            while (true)
+            {
+                const size_t read = fread(&buffer[0], 1, BufferSize, in);
+                write_bytes(file, &buffer[0], read, pack_filename);
+
+                if (read < BufferSize)
+                {
+                    if (ferror(in))
+                        throw PackFileException(("i/o error while reading from " + filename_in_fs).c_str());
+                    break;
+                }
+            }
+        }
+        catch (const exception&)
+        {
+            fclose(in);
+            throw;
+        }
+
+        fclose(in);
+    }
+
+    bool has_skipped_extension(const string& path, const vector<string>& skipped_extensions)
+    {
+        const string extension = lower_case(bf::path(path).extension().string());
+
+        for (const_each<vector<string>> i = skipped_extensions; i; ++i)
+        {
+            if (extension == lower_case(*i))
+                return true;
+        }
+
+        return false;
+    }
+
+    bool is_up_to_date(const bf::path& filepath, const uint64 size, const time_t pack_timestamp)
+    {
+        boost::system::error_code ec;
+
+        if (!bf::is_regular_file(filepath, ec))
+            return false;
+
+        const uintmax_t file_size = bf::file_size(filepath, ec);
+        if (ec || file_size != size)
+            return false;
+
+        const time_t timestamp = bf::last_write_time(filepath, ec);
+        return !ec && timestamp >= pack_timestamp;
+    }
+
+    void extract_entry(const PackFileReader& reader, const size_t index, const bf::path& filepath)
+    {
+        const bf::path parent_path = filepath.parent_path();
+        if (!bf::exists(parent_path))
+            bf::create_directories(parent_path);
+
+        const string filename = filepath.string();
+
+        FILE* file = fopen(filename.c_str(), "wb");
+        if (file == 0)
+            throw PackFileException(("can't open file " + filename).c_str());
+
+        try
+        {
+            write_bytes(file, reader.get_entry_data(index), reader.get_entry_size(index), filename);
+        }
+        catch (const exception&)
+        {
+            fclose(file);
+            throw;
+        }
+
+        if (fclose(file) != 0)
+            throw PackFileException(("i/o error while writing to " + filename).c_str());
+    }
+}
+
+void pack(const string& pack_filename, const string& directory_to_pack)
+{
+    FILE* file = 0;
+
+    try
+    {
+        const set<string> files_to_pack = recursive_ls(directory_to_pack);
+
+        // Build the index and the string table.
+        vector<PackFileIndexEntry> index;
+        string string_table;
+
+        for (const_each<set<string>> i = files_to_pack; i; ++i)
+        {
+            PackFileIndexEntry entry;
+            entry.m_size = bf::file_size(bf::path(directory_to_pack) / *i);
+            entry.m_path_offset = static_cast<uint32>(string_table.size());
+            entry.m_path_size = static_cast<uint32>(i->size());
+            index.push_back(entry);
+            string_table += *i;
+        }
+
+        PackFileHeader header;
+        memcpy(header.m_magic, PackFileMagic, sizeof(PackFileMagic));
+        header.m_version = PackFileVersion;
+        header.m_reserved = 0;
+        header.m_entry_count = static_cast<uint32>(index.size());
+        header.m_string_table_size = string_table.size();
+
+        // Lay out the contents of the files after the string table.
+        uint64 offset =
+            sizeof(PackFileHeader) +
+            index.size() * sizeof(PackFileIndexEntry) +
+            string_table.size();
+
+        for (each<vector<PackFileIndexEntry>> i = index; i; ++i)
+        {
+            i->m_offset = align(offset);
+            offset = i->m_offset + i->m_size;
+        }
+
+        file = fopen(pack_filename.c_str(), "wb");
+        if (file == 0)
+            throw PackFileException(("can't open file " + pack_filename).c_str());
+
+        write_bytes(file, &header, sizeof(header), pack_filename);
+
+        if (!index.empty())
+            write_bytes(file, &index[0], index.size() * sizeof(PackFileIndexEntry), pack_filename);
+
+        write_bytes(file, string_table.data(), string_table.size(), pack_filename);
+
+        offset =
+            sizeof(PackFileHeader) +
+            index.size() * sizeof(PackFileIndexEntry) +
+            string_table.size();
+
+        size_t entry_index = 0;
+        for (const_each<set<string>> i = files_to_pack; i; ++i, ++entry_index)
+        {
+            const PackFileIndexEntry& entry = index[entry_index];
+
+            write_padding(file, entry.m_offset - offset, pack_filename);
+            pack_current_file(file, (bf::path(directory_to_pack) / *i).string(), pack_filename);
+
+            offset = entry.m_offset + entry.m_size;
+        }
+
+        const int result = fclose(file);
+        file = 0;
+
+        if (result != 0)
+            throw PackFileException(("i/o error while writing to " + pack_filename).c_str());
+    }
+    catch (const exception&)
+    {
+        if (file)
+            fclose(file);
+
+        bf::remove(pack_filename);
+
+        throw;
+    }
+}
+
+void unpack(
+    const string&           pack_filename,
+    const string&           unpacked_dir,
+    const vector<string>&   skipped_extensions)
+{
+    const PackFileReader reader(pack_filename);
+    unpack(reader, pack_filename, unpacked_dir, skipped_extensions);
+}
+
+void unpack(
+    const PackFileReader&   reader,
+    const string&           pack_filename,
+    const string&           unpacked_dir,
+    const vector<string>&   skipped_extensions)
+{
+    const time_t pack_timestamp = bf::last_write_time(pack_filename);
+
+    bf::create_directories(unpacked_dir);
+
+    for (size_t i = 0; i < reader.get_entry_count(); ++i)
+    {
+        const string& path = reader.get_entry_path(i);
+
+        if (has_skipped_extension(path, skipped_extensions))
+            continue;
+
+        const bf::path filepath = bf::path(unpacked_dir) / path;
+
+        if (!is_up_to_date(filepath, reader.get_entry_size(i), pack_timestamp))
+            extract_entry(reader, i, filepath);
+    }
+}
+
+bool is_pack_file(const char* filename)
+{
+    FILE* file = fopen(filename, "rb");
+    if (file == 0)
+        return false;
+
+    char data[sizeof(PackFileHeader)];
+    const size_t size = fread(data, 1, sizeof(data), file);
+
+    fclose(file);
+
+    PackFileHeader header;
+    return read_header(data, size, header);
+}
+
+vector<string> get_filenames_with_extension_from_pack(
+    const string&   pack_filename,
+    const string&   extension)
+{
+    const PackFileReader reader(pack_filename);
+
+    vector<string> filenames;
+
+    for (size_t i = 0; i < reader.get_entry_count(); ++i)
+    {
+        const string& filename = reader.get_entry_path(i);
+
+        if (ends_with(filename, extension))
+            filenames.push_back(filename);
+    }
+
+    return filenames;
+}
+
+}   // namespace foundation
@@ -0,0 +1,201 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_UTILITY_PACKFILE_H
+#define APPLESEED_FOUNDATION_UTILITY_PACKFILE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/core/exceptions/exception.h"
+#include "foundation/platform/memorymappedfile.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace foundation
+{
+
+//
+// Pack files bundle the files of a directory into a single uncompressed file.
+//
+// A pack file starts with a header and an index giving the relative path, the
+// offset and the size of every file. The paths are stored once in a string table
+// at the end of the index. The contents of the files follow, each one aligned on
+// a PackFileAlignment boundary so that they can be used in place once the pack
+// file is mapped into memory.
+//
+// Unlike zip files, reading a single file out of a pack file requires neither
+// decompression nor a scan of the whole archive.
+//
+// Paths stored in a pack file are relative: pack files containing absolute paths
+// or paths with '..' components are rejected, so that unpacking a pack file can't
+// write outside of the target directory.
+//
+
+const size_t PackFileAlignment = 64;
+
+
+//
+// Exception class used for all pack file related exceptions.
+//
+
+class PackFileException
+  : public Exception
+{
+  public:
+    explicit PackFileException(const char* what);
+};
+
+
+//
+// Read-only access to the contents of a pack file.
+//
+
+class PackFileReader
+  : public NonCopyable
+{
+  public:
+    // Open a pack file. Throws PackFileException in case of error.
+    explicit PackFileReader(const std::string& pack_filename);
+
+    // Return the number of files in the pack file.
+    size_t get_entry_count() const;
+
+    // Return the relative path of a given file, using '/' as separator.
+    const std::string& get_entry_path(const size_t index) const;
+
+    // Return the size in bytes of a given file.
+    size_t get_entry_size(const size_t index) const;
+
+    // Return the contents of a given file. The returned pointer
+    // remains valid for the lifetime of the reader.
+    const char* get_entry_data(const size_t index) const;
+
+    // Return the index of the file with a given relative path, or ~0 if there is none.
+    size_t find_entry(const std::string& path) const;
+
+    // Return the index of the file that unpacking to unpacked_dir would extract
+    // to filepath, or ~0 if there is none.
+    size_t find_unpacked_entry(
+        const std::string&  unpacked_dir,
+        const std::string&  filepath) const;
+
+  private:
+    struct Entry
+    {
+        std::string     m_path;
+        uint64          m_offset;
+        uint64          m_size;
+    };
+
+    MemoryMappedFile    m_file;
+    std::vector<Entry>  m_entries;
+};
+
+
+//
+// Bundles the files of directory_to_pack into pack_filename.
+//
+// Throws PackFileException in case of error.
+// If an exception is thrown, the pack file is deleted.
+//
+
+void pack(const std::string& pack_filename, const std::string& directory_to_pack);
+
+//
+// Extracts pack file pack_filename to unpacked_dir directory.
+//
+// Files with one of the given extensions are skipped. Files that were already
+// extracted after the pack file was written, and whose size has not changed,
+// are left untouched, so that unpacking the same file again is nearly free.
+//
+// Throws PackFileException in case of error.
+//
+
+void unpack(
+    const std::string&              pack_filename,
+    const std::string&              unpacked_dir,
+    const std::vector<std::string>& skipped_extensions = std::vector<std::string>());
+
+//
+// Same as above, but uses an already open reader for pack file pack_filename.
+//
+
+void unpack(
+    const PackFileReader&           reader,
+    const std::string&              pack_filename,
+    const std::string&              unpacked_dir,
+    const std::vector<std::string>& skipped_extensions = std::vector<std::string>());
+
+//
+// Checks if a file is a pack file by looking at its header.
+//
+
+bool is_pack_file(const char* filename);
+
+//
+// Returns all filenames from pack_filename pack file with given extension.
+//
+// Throws PackFileException if pack_filename can't be opened or is not a pack file.
+//
+
+std::vector<std::string> get_filenames_with_extension_from_pack(
+    const std::string& pack_filename,
+    const std::string& extension);
+
+
+//
+// PackFileReader class implementation.
+//
+
+inline size_t PackFileReader::get_entry_count() const
+{
+    return m_entries.size();
+}
+
+inline const std::string& PackFileReader::get_entry_path(const size_t index) const
+{
+    return m_entries[index].m_path;
+}
+
+inline size_t PackFileReader::get_entry_size(const size_t index) const
+{
+    return static_cast<size_t>(m_entries[index].m_size);
+}
+
+inline const char* PackFileReader::get_entry_data(const size_t index) const
+{
+    return m_file.data() + m_entries[index].m_offset;
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_UTILITY_PACKFILE_H
@@ -32,14 +32,20 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/singleton.h"
+#include "foundation/platform/compiler.h"
 #include "foundation/platform/thread.h"
 #include "foundation/platform/types.h"
 
+// Boost headers.
+#include "boost/thread/tss.hpp"
+
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <vector>
 
 namespace foundation
 {
@@ -47,8 +53,17 @@ namespace foundation
 //
 // A standard-conformant, thread-safe, fixed-size object allocator.
 //
+// Each thread allocates memory blocks from, and returns them to, its own pair of
+// magazines (small lists of free blocks) without any synchronization. Threads only
+// lock the pool when they exchange a whole magazine with the global depot, that is
+// when they run out of free blocks or when they hold too many of them.
+//
+// Pages are allocated and initialized by the thread that first needs them, so that
+// with a first-touch placement policy they end up in memory local to that thread.
+//
 // Note that memory allocated through this allocator is never returned
 // to the system, and thus is never made available for other uses.
+// Free blocks held by a thread are returned to the depot when that thread terminates.
 //
 
 namespace impl
@@ -61,43 +76,55 @@ namespace impl
       : public Singleton<Pool<ItemSize, ItemsPerPage>>
     {
       public:
+        // Number of memory blocks in a full magazine.
+        static const size_t MagazineSize = 32;
+
         // Allocate a memory block.
         void* allocate()
         {
-            Spinlock::ScopedLock lock(m_spinlock);
+            ThreadCache& cache = get_thread_cache();
 
-            if (Node* node = m_free_head)
+            if (cache.m_loaded_count == 0)
             {
-                // Return the first node from the list of free nodes.
-                m_free_head = m_free_head->m_next;
-                return node;
+                if (cache.m_previous_count > 0)
+                    swap_magazines(cache);
+                else load_magazine(cache);
             }
-            else
-            {
-                // The current page is full, allocate a new page of nodes.
-                if (m_page_index == ItemsPerPage)
-                {
-                    m_page = new Node[ItemsPerPage];
-                    m_page_index = 0;
-                }
 
-                // Return the next node from the page.
-                return &m_page[m_page_index++];
-            }
+            // Return the first node from the loaded magazine.
+            Node* node = cache.m_loaded;
+            cache.m_loaded = node->m_next;
+            --cache.m_loaded_count;
+            return node;
         }
 
         // Return a memory block to the pool.
         void deallocate(void* p)
         {
-            Spinlock::ScopedLock lock(m_spinlock);
-
             assert(p);
 
+            ThreadCache& cache = get_thread_cache();
+
+            if (cache.m_loaded_count == MagazineSize)
+            {
+                if (cache.m_previous_count == MagazineSize)
+                {
+                    // Both magazines are full, hand one of them over to the depot.
+                    Spinlock::ScopedLock lock(m_spinlock);
+                    m_full_magazines.push_back(cache.m_previous);
+                    cache.m_previous = 0;
+                    cache.m_previous_count = 0;
+                }
+
+                swap_magazines(cache);
+            }
+
             Node* node = static_cast<Node*>(p);
 
-            // Insert this node at the beginning of the list of free nodes.
-            node->m_next = m_free_head;
-            m_free_head = node;
+            // Insert this node at the beginning of the loaded magazine.
+            node->m_next = cache.m_loaded;
+            cache.m_loaded = node;
+            ++cache.m_loaded_count;
         }
 
       private:
@@ -109,17 +136,159 @@ namespace impl
             Node*   m_next;             // pointer to the next free node
         };
 
-        Spinlock    m_spinlock;
-        Node*       m_page;
-        size_t      m_page_index;
-        Node*       m_free_head;
+        // Per-thread state. Must remain a plain old data type that is valid when zero-initialized.
+        // The previous magazine is always either empty or full.
+        struct ThreadCache
+        {
+            Node*   m_loaded;           // magazine blocks are allocated from and returned to
+            size_t  m_loaded_count;
+            Node*   m_previous;         // magazine that was loaded before the current one
+            size_t  m_previous_count;
+            Node*   m_page;             // page new nodes are taken from
+            size_t  m_page_index;       // index of the next unused node in the page
+            bool    m_registered;       // is the cache flushed when the thread terminates?
+        };
+
+        Spinlock            m_spinlock;
+        std::vector<Node*>  m_full_magazines;   // each entry is a list of MagazineSize nodes
+        Node*               m_partial;          // magazine of the depot that is not full yet
+        size_t              m_partial_count;
+
+        // Flushes the cache of each thread when that thread terminates. The pointers it
+        // holds are not owned: the caches themselves are thread-local variables.
+        boost::thread_specific_ptr<ThreadCache> m_thread_exit_hook;
 
-        // Constructor.
         Pool()
-          : m_page(0)
-          , m_page_index(ItemsPerPage)
-          , m_free_head(0)
+          : m_partial(0)
+          , m_partial_count(0)
+          , m_thread_exit_hook(&Pool::flush_thread_cache)
+        {
+        }
+
+        ~Pool()
+        {
+            // Don't flush the cache of the current thread into a pool being destroyed.
+            m_thread_exit_hook.release();
+        }
+
+        ThreadCache& get_thread_cache()
+        {
+            static APPLESEED_THREAD_LOCAL ThreadCache cache;
+
+            if (!cache.m_registered)
+            {
+                cache.m_registered = true;
+                m_thread_exit_hook.reset(&cache);
+            }
+
+            return cache;
+        }
+
+        static void flush_thread_cache(ThreadCache* cache)
+        {
+            Pool::instance().flush(*cache);
+        }
+
+        // Return all the free blocks of a thread to the depot.
+        void flush(ThreadCache& cache)
         {
+            Spinlock::ScopedLock lock(m_spinlock);
+
+            push_free_list(cache.m_loaded);
+            push_free_list(cache.m_previous);
+
+            if (cache.m_page)
+            {
+                while (cache.m_page_index < ItemsPerPage)
+                    push_free_node(&cache.m_page[cache.m_page_index++]);
+            }
+
+            cache.m_loaded = 0;
+            cache.m_loaded_count = 0;
+            cache.m_previous = 0;
+            cache.m_previous_count = 0;
+            cache.m_page = 0;
+            cache.m_page_index = 0;
+        }
+
+        // Insert a list of free nodes into the depot. The pool must be locked.
+        void push_free_list(Node* node)
+        {
+            while (node)
+            {
+                Node* next = node->m_next;
+                push_free_node(node);
+                node = next;
+            }
+        }
+
+        // Insert a free node into the depot. The pool must be locked.
+        void push_free_node(Node* node)
+        {
+            node->m_next = m_partial;
+            m_partial = node;
+
+            if (++m_partial_count == MagazineSize)
+            {
+                m_full_magazines.push_back(m_partial);
+                m_partial = 0;
+                m_partial_count = 0;
+            }
+        }
+
+        static void swap_magazines(ThreadCache& cache)
+        {
+            std::swap(cache.m_loaded, cache.m_previous);
+            std::swap(cache.m_loaded_count, cache.m_previous_count);
+        }
+
+        // Load a new magazine, assuming both magazines of this thread are empty.
+        void load_magazine(ThreadCache& cache)
+        {
+            assert(cache.m_loaded_count == 0);
+            assert(cache.m_previous_count == 0);
+
+            {
+                Spinlock::ScopedLock lock(m_spinlock);
+
+                if (!m_full_magazines.empty())
+                {
+                    // Take a full magazine from the depot.
+                    cache.m_loaded = m_full_magazines.back();
+                    cache.m_loaded_count = MagazineSize;
+                    m_full_magazines.pop_back();
+                    return;
+                }
+
+                if (m_partial_count > 0)
+                {
+                    // Take the magazine that is being filled by terminated threads.
+                    cache.m_loaded = m_partial;
+                    cache.m_loaded_count = m_partial_count;
+                    m_partial = 0;
+                    m_partial_count = 0;
+                    return;
+                }
+            }
+
+            // The current page is full, allocate a new page of nodes.
+            if (cache.m_page == 0 || cache.m_page_index == ItemsPerPage)
+            {
+                cache.m_page = new Node[ItemsPerPage];
+                cache.m_page_index = 0;
+            }
+
+            // Fill the magazine with the next nodes from the page.
+            const size_t remaining = ItemsPerPage - cache.m_page_index;
+            const size_t count = remaining < MagazineSize ? remaining : MagazineSize;
+            cache.m_loaded = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                Node* node = &cache.m_page[cache.m_page_index++];
+                node->m_next = cache.m_loaded;
+                cache.m_loaded = node;
+            }
+            cache.m_loaded_count = count;
         }
     };
 }
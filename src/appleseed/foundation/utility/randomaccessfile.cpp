@@ -0,0 +1,220 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "randomaccessfile.h"
+
+// Platform headers.
+#ifdef _WIN32
+#include "foundation/platform/windows.h"
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+// Standard headers.
+#include <cassert>
+
+namespace foundation
+{
+
+//
+// RandomAccessFile class implementation.
+//
+
+#ifdef _WIN32
+
+RandomAccessFile::RandomAccessFile()
+  : m_handle(INVALID_HANDLE_VALUE)
+{
+}
+
+RandomAccessFile::~RandomAccessFile()
+{
+    if (is_open())
+        close();
+}
+
+bool RandomAccessFile::open(const char* path)
+{
+    assert(path);
+    assert(!is_open());
+
+    m_handle =
+        CreateFileA(
+            path,
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            0,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+            0);
+
+    return m_handle != INVALID_HANDLE_VALUE;
+}
+
+bool RandomAccessFile::close()
+{
+    assert(is_open());
+
+    const bool success = CloseHandle(m_handle) != 0;
+    m_handle = INVALID_HANDLE_VALUE;
+
+    return success;
+}
+
+bool RandomAccessFile::is_open() const
+{
+    return m_handle != INVALID_HANDLE_VALUE;
+}
+
+uint64 RandomAccessFile::get_size() const
+{
+    assert(is_open());
+
+    LARGE_INTEGER size;
+    return GetFileSizeEx(m_handle, &size) ? static_cast<uint64>(size.QuadPart) : 0;
+}
+
+size_t RandomAccessFile::read(
+    const uint64        offset,
+    void*               outbuf,
+    const size_t        size) const
+{
+    assert(is_open());
+    assert(outbuf);
+
+    uint8* ptr = static_cast<uint8*>(outbuf);
+    size_t bytes = 0;
+
+    while (bytes < size)
+    {
+        // On synchronous handles, ReadFile() reads at the position given in the
+        // OVERLAPPED structure, independently of other reads on the same handle.
+        const uint64 position = offset + bytes;
+        OVERLAPPED overlapped = OVERLAPPED();
+        overlapped.Offset = static_cast<DWORD>(position & 0xFFFFFFFFUL);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+
+        const size_t remaining = size - bytes;
+        const DWORD chunk = static_cast<DWORD>(remaining > 0x40000000UL ? 0x40000000UL : remaining);
+
+        DWORD read_bytes = 0;
+        if (!ReadFile(m_handle, ptr + bytes, chunk, &read_bytes, &overlapped) || read_bytes == 0)
+            break;
+
+        bytes += read_bytes;
+    }
+
+    return bytes;
+}
+
+#else
+
+RandomAccessFile::RandomAccessFile()
+  : m_fd(-1)
+{
+}
+
+RandomAccessFile::~RandomAccessFile()
+{
+    if (is_open())
+        close();
+}
+
+bool RandomAccessFile::open(const char* path)
+{
+    assert(path);
+    assert(!is_open());
+
+    m_fd = ::open(path, O_RDONLY);
+
+    return m_fd != -1;
+}
+
+bool RandomAccessFile::close()
+{
+    assert(is_open());
+
+    const bool success = ::close(m_fd) == 0;
+    m_fd = -1;
+
+    return success;
+}
+
+bool RandomAccessFile::is_open() const
+{
+    return m_fd != -1;
+}
+
+uint64 RandomAccessFile::get_size() const
+{
+    assert(is_open());
+
+    struct stat st;
+    return fstat(m_fd, &st) == 0 ? static_cast<uint64>(st.st_size) : 0;
+}
+
+size_t RandomAccessFile::read(
+    const uint64        offset,
+    void*               outbuf,
+    const size_t        size) const
+{
+    assert(is_open());
+    assert(outbuf);
+
+    uint8* ptr = static_cast<uint8*>(outbuf);
+    size_t bytes = 0;
+
+    while (bytes < size)
+    {
+        const ssize_t result =
+            pread(
+                m_fd,
+                ptr + bytes,
+                size - bytes,
+                static_cast<off_t>(offset + bytes));
+
+        if (result < 0 && errno == EINTR)
+            continue;
+
+        if (result <= 0)
+            break;
+
+        bytes += static_cast<size_t>(result);
+    }
+
+    return bytes;
+}
+
+#endif
+
+}   // namespace foundation
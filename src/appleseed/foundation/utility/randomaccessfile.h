@@ -0,0 +1,93 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_UTILITY_RANDOMACCESSFILE_H
+#define APPLESEED_FOUNDATION_UTILITY_RANDOMACCESSFILE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+namespace foundation
+{
+
+//
+// A read-only file supporting positional reads.
+//
+// Reads specify their own offset and don't move any shared file position,
+// so any number of threads may read from the same open file concurrently.
+//
+
+class APPLESEED_DLLSYMBOL RandomAccessFile
+  : public NonCopyable
+{
+  public:
+    // Constructor.
+    RandomAccessFile();
+
+    // Destructor, closes the file if it is still open.
+    ~RandomAccessFile();
+
+    // Open a file for reading.
+    // Return true on success, false on error.
+    bool open(const char* path);
+
+    // Close the file.
+    // Return true on success, false on error.
+    bool close();
+
+    // Return true if the file is open, false otherwise.
+    bool is_open() const;
+
+    // Return the size of the file in bytes.
+    uint64 get_size() const;
+
+    // Read a contiguous sequence of bytes starting at a given offset.
+    // Thread-safe. Return the number of bytes that were successfully read.
+    size_t read(
+        const uint64        offset,
+        void*               outbuf,
+        const size_t        size) const;
+
+  private:
+#ifdef _WIN32
+    void*   m_handle;
+#else
+    int     m_fd;
+#endif
+};
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_UTILITY_RANDOMACCESSFILE_H
@@ -44,12 +44,12 @@
 #include "xercesc/util/XMLString.hpp"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
-#include <map>
 #include <memory>
-#include <stack>
 #include <string>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class Logger; }
@@ -261,15 +261,38 @@ class SAX2ContentHandler
 
     struct FactoryInfo
     {
+        std::basic_string<XMLCh>    m_name;
         ElementID                   m_id;
         ElementHandlerFactoryType*  m_handler_factory;
     };
 
-    typedef std::map<std::string, FactoryInfo> FactoryInfoMap;
-    typedef std::stack<ElementHandlerType*> ElementHandlerStack;
+    struct FactoryInfoOrder
+    {
+        bool operator()(const FactoryInfo& lhs, const XMLCh* rhs) const
+        {
+            return xercesc::XMLString::compareString(lhs.m_name.c_str(), rhs) < 0;
+        }
+    };
+
+    struct StackEntry
+    {
+        ElementHandlerType*         m_handler;
+        const FactoryInfo*          m_factory_info;     // 0 for unknown elements
+    };
+
+    // Factories are sorted by element name and looked up with the element names
+    // reported by Xerces-C++, without transcoding them. The factory of each open
+    // element is kept on the stack so that it isn't looked up again at its end.
+    typedef std::vector<FactoryInfo> FactoryInfoVector;
+    typedef std::vector<StackEntry> ElementHandlerStack;
 
-    FactoryInfoMap                  m_factory_info;
+    FactoryInfoVector               m_factory_info;
     ElementHandlerStack             m_handler_stack;
+
+    // Stateless handler shared by the root and by all unknown elements.
+    ElementHandlerBase<ElementID>   m_default_handler;
+
+    const FactoryInfo* find_factory_info(const XMLCh* name) const;
 };
 
 
@@ -389,8 +412,27 @@ inline std::string ElementHandlerBase<ElementID>::get_value(
     const std::string&          name,
     const std::string&          default_value)
 {
-    const XMLCh* value = attrs.getValue(transcode(name).c_str());
-    return value ? transcode(value) : default_value;
+    // This is called for every attribute of every element: transcode short
+    // names and values into stack buffers instead of allocating temporaries.
+    const size_t MaxShortLength = 64;
+
+    XMLCh xml_name[MaxShortLength];
+    const XMLCh* value =
+        name.size() < MaxShortLength &&
+        xercesc::XMLString::transcode(name.c_str(), xml_name, MaxShortLength - 1)
+            ? attrs.getValue(xml_name)
+            : attrs.getValue(transcode(name).c_str());
+
+    if (value == 0)
+        return default_value;
+
+    // Leave room for the longest multibyte encoding of each character.
+    char buffer[MaxShortLength * 8];
+    if (xercesc::XMLString::stringLen(value) < MaxShortLength &&
+        xercesc::XMLString::transcode(value, buffer, sizeof(buffer) - 1))
+        return buffer;
+
+    return transcode(value);
 }
 
 
@@ -401,21 +443,26 @@ inline std::string ElementHandlerBase<ElementID>::get_value(
 template <typename ElementID>
 SAX2ContentHandler<ElementID>::SAX2ContentHandler()
 {
-    // Push a dummy element handler on the stack to avoid special-casing for an empty stack.
-    m_handler_stack.push(new ElementHandlerBase<ElementID>());
+    // Push the default element handler on the stack to avoid special-casing for an empty stack.
+    StackEntry entry;
+    entry.m_handler = &m_default_handler;
+    entry.m_factory_info = 0;
+    m_handler_stack.push_back(entry);
 }
 
 template <typename ElementID>
 SAX2ContentHandler<ElementID>::~SAX2ContentHandler()
 {
-    while (!m_handler_stack.empty())
+    for (const_each<ElementHandlerStack> i = m_handler_stack; i; ++i)
     {
-        delete m_handler_stack.top();
-        m_handler_stack.pop();
+        if (i->m_factory_info)
+            delete i->m_handler;
     }
 
-    for (const_each<FactoryInfoMap> i = m_factory_info; i; ++i)
-        delete i->second.m_handler_factory;
+    m_handler_stack.clear();
+
+    for (const_each<FactoryInfoVector> i = m_factory_info; i; ++i)
+        delete i->m_handler_factory;
 
     m_factory_info.clear();
 }
@@ -426,10 +473,49 @@ void SAX2ContentHandler<ElementID>::register_factory(
     const ElementID                             id,
     std::auto_ptr<ElementHandlerFactoryType>    handler_factory)
 {
-    FactoryInfo info;
-    info.m_id = id;
-    info.m_handler_factory = handler_factory.release();
-    m_factory_info[name] = info;
+    // Factories must be registered before parsing starts.
+    assert(m_handler_stack.size() == 1);
+
+    const std::basic_string<XMLCh> xml_name = transcode(name);
+
+    const typename FactoryInfoVector::iterator it =
+        std::lower_bound(
+            m_factory_info.begin(),
+            m_factory_info.end(),
+            xml_name.c_str(),
+            FactoryInfoOrder());
+
+    if (it != m_factory_info.end() && it->m_name == xml_name)
+    {
+        delete it->m_handler_factory;
+        it->m_id = id;
+        it->m_handler_factory = handler_factory.release();
+    }
+    else
+    {
+        FactoryInfo info;
+        info.m_name = xml_name;
+        info.m_id = id;
+        info.m_handler_factory = handler_factory.release();
+        m_factory_info.insert(it, info);
+    }
+}
+
+template <typename ElementID>
+inline const typename SAX2ContentHandler<ElementID>::FactoryInfo*
+SAX2ContentHandler<ElementID>::find_factory_info(const XMLCh* name) const
+{
+    const typename FactoryInfoVector::const_iterator it =
+        std::lower_bound(
+            m_factory_info.begin(),
+            m_factory_info.end(),
+            name,
+            FactoryInfoOrder());
+
+    return
+        it != m_factory_info.end() && xercesc::XMLString::equals(it->m_name.c_str(), name)
+            ? &*it
+            : 0;
 }
 
 template <typename ElementID>
@@ -439,25 +525,25 @@ void SAX2ContentHandler<ElementID>::startElement(
     const XMLCh* const                          qname,
     const xercesc::Attributes&                  attrs)
 {
-    const typename FactoryInfoMap::const_iterator it =
-        m_factory_info.find(transcode(localname));
+    StackEntry entry;
+    entry.m_factory_info = find_factory_info(localname);
 
-    ElementHandlerType* handler;
-
-    if (it == m_factory_info.end())
+    if (entry.m_factory_info == 0)
     {
-        handler = new ElementHandlerBase<ElementID>();
+        entry.m_handler = &m_default_handler;
     }
     else
     {
-        handler = it->second.m_handler_factory->create().release();
+        entry.m_handler = entry.m_factory_info->m_handler_factory->create().release();
 
-        m_handler_stack.top()->start_child_element(it->second.m_id, handler);
+        m_handler_stack.back().m_handler->start_child_element(
+            entry.m_factory_info->m_id,
+            entry.m_handler);
     }
 
-    m_handler_stack.push(handler);
+    m_handler_stack.push_back(entry);
 
-    handler->start_element(attrs);
+    entry.m_handler->start_element(attrs);
 }
 
 template <typename ElementID>
@@ -466,19 +552,22 @@ void SAX2ContentHandler<ElementID>::endElement(
     const XMLCh* const                          localname,
     const XMLCh* const                          qname)
 {
-    ElementHandlerType* handler = m_handler_stack.top();
+    assert(m_handler_stack.size() > 1);
 
-    handler->end_element();
+    const StackEntry entry = m_handler_stack.back();
 
-    m_handler_stack.pop();
+    entry.m_handler->end_element();
 
-    const typename FactoryInfoMap::const_iterator it =
-        m_factory_info.find(transcode(localname));
+    m_handler_stack.pop_back();
 
-    if (it != m_factory_info.end())
-        m_handler_stack.top()->end_child_element(it->second.m_id, handler);
+    if (entry.m_factory_info)
+    {
+        m_handler_stack.back().m_handler->end_child_element(
+            entry.m_factory_info->m_id,
+            entry.m_handler);
 
-    delete handler;
+        delete entry.m_handler;
+    }
 }
 
 template <typename ElementID>
@@ -488,7 +577,7 @@ void SAX2ContentHandler<ElementID>::characters(
 {
     assert(!m_handler_stack.empty());
 
-    m_handler_stack.top()->characters(chars, length);
+    m_handler_stack.back().m_handler->characters(chars, length);
 }
 
 }       // namespace foundation
@@ -35,6 +35,7 @@
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/intersection/intersectionsettings.h"
 #include "renderer/kernel/intersection/regioninfo.h"
+#include "renderer/kernel/intersection/triangletreestore.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/modeling/entity/entityvector.h"
 #include "renderer/modeling/object/curveobject.h"
@@ -46,26 +47,35 @@
 #include "renderer/modeling/scene/objectinstance.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/utility/bbox.h"
+#include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
 #include "foundation/math/beziercurve.h"
+#include "foundation/math/intersection/rayaabb.h"
 #include "foundation/math/permutation.h"
 #include "foundation/math/ray.h"
 #include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/defaulttimers.h"
 #include "foundation/platform/system.h"
 #include "foundation/platform/timers.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/alignedallocator.h"
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/job/ijob.h"
+#include "foundation/utility/job/jobmanager.h"
+#include "foundation/utility/job/jobqueue.h"
 #include "foundation/utility/lazy.h"
 #include "foundation/utility/siphash.h"
 #include "foundation/utility/statistics.h"
+#include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
+#include "foundation/utility/uid.h"
 
 // Standard headers.
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstring>
 #include <set>
 #include <utility>
@@ -80,22 +90,54 @@ namespace renderer
 // AssemblyTree class implementation.
 //
 
-AssemblyTree::AssemblyTree(const Scene& scene)
+AssemblyTree::AssemblyTree(
+    const Scene&        scene,
+    TriangleTreeStore&  triangle_tree_store,
+    const size_t        thread_count)
   : TreeType(AlignedAllocator<void>(System::get_l1_data_cache_line_size()))
   , m_scene(scene)
+  , m_triangle_tree_store(triangle_tree_store)
+  , m_paged_triangle_trees(false)
+  , m_items_signature(0)
+  , m_structure_signature(0)
 {
-    update();
+    update(thread_count);
 }
 
 AssemblyTree::~AssemblyTree()
 {
     RENDERER_LOG_INFO("deleting assembly tree...");
+
+    delete_all_child_trees();
 }
 
-void AssemblyTree::update()
+void AssemblyTree::update(const size_t thread_count)
 {
-    rebuild_assembly_tree();
-    update_tree_hierarchy();
+    // Triangle trees are rebuilt when the triangle tree store is enabled or disabled.
+    const bool paged_triangle_trees = m_triangle_tree_store.is_enabled();
+    if (paged_triangle_trees != m_paged_triangle_trees)
+    {
+        delete_all_child_trees();
+        m_paged_triangle_trees = paged_triangle_trees;
+    }
+
+    // The assembly tree only needs to be updated when assembly instances,
+    // their transforms or their assemblies have changed. It is only refitted
+    // when nothing but the transforms of assembly instances changed.
+    const uint64 items_signature = compute_items_signature(m_scene.assembly_instances());
+    if (m_items.empty() || items_signature != m_items_signature)
+    {
+        const uint64 structure_signature = compute_structure_signature(m_scene.assembly_instances());
+        if (!m_items.empty() && structure_signature == m_structure_signature)
+            refit_assembly_tree();
+        else rebuild_assembly_tree();
+
+        m_items_signature = items_signature;
+        m_structure_signature = structure_signature;
+    }
+    else RENDERER_LOG_INFO("assembly tree is up-to-date.");
+
+    update_tree_hierarchy(thread_count);
 }
 
 size_t AssemblyTree::get_memory_size() const
@@ -105,7 +147,9 @@ size_t AssemblyTree::get_memory_size() const
         - sizeof(*static_cast<const TreeType*>(this))
         + sizeof(*this)
         + m_items.capacity() * sizeof(AssemblyInstance*)
-        + m_assembly_versions.size() * sizeof(pair<UniqueID, VersionID>);
+        + m_item_ordering.capacity() * sizeof(size_t)
+        + m_assembly_versions.size() * sizeof(pair<UniqueID, VersionID>)
+        + m_proxy_trees.size() * sizeof(ProxyTrees);
 }
 
 void AssemblyTree::collect_assembly_instances(
@@ -152,11 +196,50 @@ void AssemblyTree::collect_assembly_instances(
     }
 }
 
+uint64 AssemblyTree::compute_items_signature(
+    const AssemblyInstanceContainer&    assembly_instances) const
+{
+    uint64 signature = 0;
+
+    for (const_each<AssemblyInstanceContainer> i = assembly_instances; i; ++i)
+    {
+        const AssemblyInstance& assembly_instance = *i;
+        const Assembly& assembly = assembly_instance.get_assembly();
+
+        signature = Entity::combine_signatures(signature, assembly_instance.compute_signature());
+        signature = Entity::combine_signatures(signature, assembly_instance.transform_sequence().compute_signature());
+        signature = Entity::combine_signatures(signature, assembly.compute_signature());
+        signature = Entity::combine_signatures(signature, compute_items_signature(assembly.assembly_instances()));
+    }
+
+    return signature;
+}
+
+uint64 AssemblyTree::compute_structure_signature(
+    const AssemblyInstanceContainer&    assembly_instances) const
+{
+    uint64 signature = 0;
+
+    for (const_each<AssemblyInstanceContainer> i = assembly_instances; i; ++i)
+    {
+        const AssemblyInstance& assembly_instance = *i;
+        const Assembly& assembly = assembly_instance.get_assembly();
+
+        // The version of an assembly instance changes with its transforms, use its UID instead.
+        signature = Entity::combine_signatures(signature, assembly_instance.get_uid());
+        signature = Entity::combine_signatures(signature, assembly.compute_signature());
+        signature = Entity::combine_signatures(signature, compute_structure_signature(assembly.assembly_instances()));
+    }
+
+    return signature;
+}
+
 void AssemblyTree::rebuild_assembly_tree()
 {
     // Clear the current tree.
     clear();
     m_items.clear();
+    m_item_ordering.clear();
 
     Statistics statistics;
 
@@ -193,6 +276,9 @@ void AssemblyTree::rebuild_assembly_tree()
         const vector<size_t>& ordering = partitioner.get_item_ordering();
         assert(m_items.size() == ordering.size());
 
+        // Keep the ordering around to refit the tree later.
+        m_item_ordering = ordering;
+
         // Reorder the items according to the tree ordering.
         ItemVector temp_assembly_instances(ordering.size());
         small_item_reorder(
@@ -212,6 +298,82 @@ void AssemblyTree::rebuild_assembly_tree()
             statistics).to_string().c_str());
 }
 
+void AssemblyTree::refit_assembly_tree()
+{
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    // Collect assembly instances and their bounding boxes, in the same order as when the tree was built.
+    m_items.clear();
+    AABBVector assembly_instance_bboxes;
+    collect_assembly_instances(
+        m_scene.assembly_instances(),
+        TransformSequence(),
+        assembly_instance_bboxes);
+    assert(m_items.size() == m_item_ordering.size());
+
+    // Reorder the items and their bounding boxes according to the tree ordering.
+    ItemVector temp_assembly_instances(m_items.size());
+    small_item_reorder(
+        &m_items[0],
+        &temp_assembly_instances[0],
+        &m_item_ordering[0],
+        m_item_ordering.size());
+    AABBVector temp_assembly_instance_bboxes(assembly_instance_bboxes.size());
+    small_item_reorder(
+        &assembly_instance_bboxes[0],
+        &temp_assembly_instance_bboxes[0],
+        &m_item_ordering[0],
+        m_item_ordering.size());
+
+    // Update the bounding boxes of the nodes, bottom-up.
+    refit_node(0, assembly_instance_bboxes);
+
+    // Update the copies of the items stored in the tree leaves.
+    Statistics statistics;
+    store_items_in_leaves(statistics);
+
+    stopwatch.measure();
+
+    RENDERER_LOG_INFO(
+        "refitted assembly tree (%s %s) in %s.",
+        pretty_int(m_items.size()).c_str(),
+        plural(m_items.size(), "assembly instance").c_str(),
+        pretty_time(stopwatch.get_seconds()).c_str());
+}
+
+AABB3d AssemblyTree::refit_node(
+    const size_t                        node_index,
+    const AABBVector&                   assembly_instance_bboxes)
+{
+    NodeType& node = m_nodes[node_index];
+
+    if (node.is_leaf())
+    {
+        AABB3d bbox;
+        bbox.invalidate();
+
+        const size_t item_begin = node.get_item_index();
+        const size_t item_end = item_begin + node.get_item_count();
+
+        for (size_t i = item_begin; i < item_end; ++i)
+            bbox.insert(assembly_instance_bboxes[i]);
+
+        return bbox;
+    }
+
+    const size_t left_node_index = node.get_child_node_index();
+    const AABB3d left_bbox = refit_node(left_node_index, assembly_instance_bboxes);
+    const AABB3d right_bbox = refit_node(left_node_index + 1, assembly_instance_bboxes);
+
+    node.set_left_bbox(left_bbox);
+    node.set_right_bbox(right_bbox);
+
+    AABB3d bbox(left_bbox);
+    bbox.insert(right_bbox);
+    return bbox;
+}
+
 void AssemblyTree::store_items_in_leaves(Statistics& statistics)
 {
     size_t leaf_count = 0;
@@ -245,7 +407,7 @@ void AssemblyTree::store_items_in_leaves(Statistics& statistics)
     statistics.insert_percent("fat leaves", fat_leaf_count, leaf_count);
 }
 
-void AssemblyTree::update_tree_hierarchy()
+void AssemblyTree::update_tree_hierarchy(const size_t thread_count)
 {
     // Collect all assemblies in the scene.
     AssemblyVector assemblies;
@@ -287,8 +449,10 @@ void AssemblyTree::update_tree_hierarchy()
     }
 
     // Update child trees.
-    update_region_trees();
-    update_triangle_trees();
+    update_child_trees(thread_count);
+
+    // Let the items point directly to the child trees.
+    resolve_child_trees();
 }
 
 void AssemblyTree::collect_unique_assemblies(AssemblyVector& assemblies) const
@@ -408,9 +572,13 @@ void AssemblyTree::create_child_trees(const Assembly& assembly)
     // Create a region or a triangle tree if there are mesh objects.
     if (has_object_instances_of_type(assembly, MeshObjectFactory::get_model()))
     {
-        assembly.is_flushable()
-            ? create_region_tree(assembly)
-            : create_triangle_tree(assembly);
+        if (assembly.is_flushable())
+            create_region_tree(assembly);
+        else
+        {
+            create_triangle_tree(assembly);
+            create_proxy_trees(assembly);
+        }
     }
 
     // Create a curve tree if there are curve objects.
@@ -466,6 +634,9 @@ void AssemblyTree::create_triangle_tree(const Assembly& assembly)
 
         tree = new Lazy<TriangleTree>(triangle_tree_factory);
         m_triangle_tree_repository.insert(hash, tree);
+
+        if (m_paged_triangle_trees)
+            m_triangle_tree_store.insert(tree);
     }
 
     m_triangle_trees.insert(make_pair(assembly.get_uid(), tree));
@@ -499,11 +670,75 @@ void AssemblyTree::create_curve_tree(const Assembly& assembly)
     m_curve_trees.insert(make_pair(assembly.get_uid(), tree));
 }
 
+void AssemblyTree::create_proxy_trees(const Assembly& assembly)
+{
+    const ParamArray& params = assembly.get_parameters().child("acceleration_structure");
+
+    const size_t level_count = params.get_optional<size_t>("proxy_levels", 0);
+    if (level_count == 0)
+        return;
+
+    const size_t resolution = max<size_t>(params.get_optional<size_t>("proxy_resolution", 256), 1);
+    const double tolerance = params.get_optional<double>("proxy_tolerance", 1.0);
+
+    // Compute the assembly space bounding box of the assembly.
+    const GAABB3 assembly_bbox =
+        compute_parent_bbox<GAABB3>(
+            assembly.object_instances().begin(),
+            assembly.object_instances().end());
+
+    if (!assembly_bbox.is_valid() || max_value(assembly_bbox.extent()) == GScalar(0.0))
+        return;
+
+    RegionInfoVector regions;
+    collect_regions(assembly, regions);
+
+    auto_ptr<ProxyTrees> proxy_trees(new ProxyTrees());
+    proxy_trees->m_bbox = AABB3d(assembly_bbox);
+    proxy_trees->m_tolerance = tolerance;
+
+    // The finest level has 'resolution' cells along the largest extent of the assembly,
+    // each subsequent level has half as many.
+    size_t cell_count = resolution;
+    for (size_t i = 0; i < level_count && cell_count > 0; ++i, cell_count /= 2)
+    {
+        const GScalar cell_size = max_value(assembly_bbox.extent()) / cell_count;
+
+        auto_ptr<ILazyFactory<TriangleTree>> triangle_tree_factory(
+            new TriangleTreeFactory(
+                TriangleTree::Arguments(
+                    m_scene,
+                    new_guid(),
+                    assembly_bbox,
+                    assembly,
+                    regions,
+                    cell_size)));
+
+        // Simplified vertices stay within about one cell diagonal of the vertices they replace.
+        ProxyLevel level;
+        level.m_tree = new Lazy<TriangleTree>(triangle_tree_factory);
+        level.m_resolved_tree = 0;
+        level.m_error = sqrt(3.0) * cell_size;
+        proxy_trees->m_levels.push_back(level);
+    }
+
+    m_proxy_trees.insert(make_pair(assembly.get_uid(), proxy_trees.release()));
+}
+
+void AssemblyTree::delete_all_child_trees()
+{
+    for (const_each<AssemblyVersionMap> i = m_assembly_versions; i; ++i)
+        delete_child_trees(i->first);
+
+    m_assembly_versions.clear();
+}
+
 void AssemblyTree::delete_child_trees(const UniqueID assembly_id)
 {
     delete_region_tree(assembly_id);
     delete_triangle_tree(assembly_id);
     delete_curve_tree(assembly_id);
+    delete_proxy_trees(assembly_id);
 }
 
 void AssemblyTree::delete_region_tree(const UniqueID assembly_id)
@@ -521,6 +756,10 @@ void AssemblyTree::delete_triangle_tree(const UniqueID assembly_id)
     const TriangleTreeContainer::iterator it = m_triangle_trees.find(assembly_id);
     if (it != m_triangle_trees.end())
     {
+        // The tree must leave the store before the repository deletes it.
+        if (m_paged_triangle_trees && m_triangle_tree_repository.get_ref_count(it->second) == 1)
+            m_triangle_tree_store.remove(it->second);
+
         m_triangle_tree_repository.release(it->second);
         m_triangle_trees.erase(it);
     }
@@ -536,31 +775,265 @@ void AssemblyTree::delete_curve_tree(const UniqueID assembly_id)
     }
 }
 
+void AssemblyTree::delete_proxy_trees(const UniqueID assembly_id)
+{
+    const ProxyTreesContainer::iterator it = m_proxy_trees.find(assembly_id);
+    if (it != m_proxy_trees.end())
+    {
+        for (const_each<vector<ProxyLevel>> i = it->second->m_levels; i; ++i)
+            delete i->m_tree;
+
+        delete it->second;
+        m_proxy_trees.erase(it);
+    }
+}
+
 namespace
 {
+    void update_non_geometry(RegionTree& tree, const bool enable_intersection_filters)
+    {
+        tree.update_non_geometry(enable_intersection_filters);
+    }
+
+    void update_non_geometry(TriangleTree& tree, const bool enable_intersection_filters)
+    {
+        tree.update_non_geometry(enable_intersection_filters);
+    }
+
+    void update_non_geometry(CurveTree& tree, const bool enable_intersection_filters)
+    {
+        // Curve trees don't have intersection filters.
+    }
+
+    // Return true if a tree must be updated now.
     template <typename TreeType>
-    struct UpdateTrees
+    bool prepare_update(
+        Lazy<TreeType>&         tree,
+        TriangleTreeStore*      store,
+        const bool              enable_intersection_filters)
     {
-        void operator()(Lazy<TreeType>& tree, const size_t ref_count)
+        return true;
+    }
+
+    bool prepare_update(
+        Lazy<TriangleTree>&     tree,
+        TriangleTreeStore*      store,
+        const bool              enable_intersection_filters)
+    {
+        if (store == 0)
+            return true;
+
+        // All the triangle trees of the assembly tree are created by a TriangleTreeFactory.
+        static_cast<TriangleTreeFactory*>(tree.get_factory())->set_paged(*store, enable_intersection_filters);
+
+        // Trees that aren't in memory will be updated when they are created.
+        return store->is_resident(&tree);
+    }
+
+    // Builds a child tree if it doesn't exist yet, then updates it.
+    template <typename TreeType>
+    class UpdateTreeJob
+      : public IJob
+    {
+      public:
+        UpdateTreeJob(
+            Lazy<TreeType>&     tree,
+            const bool          enable_intersection_filters)
+          : m_tree(tree)
+          , m_enable_intersection_filters(enable_intersection_filters)
         {
-            Access<TreeType> update(&tree);
+        }
 
+        virtual void execute(const size_t thread_index) override
+        {
+            Access<TreeType> update(&m_tree);
+            update_non_geometry(*update.get(), m_enable_intersection_filters);
+        }
+
+      private:
+        Lazy<TreeType>&         m_tree;
+        const bool              m_enable_intersection_filters;
+    };
+
+    template <typename TreeType>
+    struct ScheduleTreeUpdates
+    {
+        JobQueue&           m_job_queue;
+        TriangleTreeStore*  m_store;            // store of the paged trees, 0 if trees aren't paged
+        size_t              m_job_count;
+
+        ScheduleTreeUpdates(JobQueue& job_queue, TriangleTreeStore* store)
+          : m_job_queue(job_queue)
+          , m_store(store)
+          , m_job_count(0)
+        {
+        }
+
+        void operator()(Lazy<TreeType>& tree, const size_t ref_count)
+        {
+            // Intersection filters are only enabled on trees that are not shared.
             const bool enable_intersection_filters = ref_count == 1;
-            update->update_non_geometry(enable_intersection_filters);
+
+            if (prepare_update(tree, m_store, enable_intersection_filters))
+            {
+                m_job_queue.schedule(new UpdateTreeJob<TreeType>(tree, enable_intersection_filters));
+                ++m_job_count;
+            }
         }
     };
 }
 
-void AssemblyTree::update_region_trees()
+void AssemblyTree::update_child_trees(const size_t thread_count)
+{
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    // Child trees are independent from each other, except for the triangle
+    // trees of a region tree which are updated by the region tree itself.
+    JobQueue job_queue;
+
+    ScheduleTreeUpdates<RegionTree> schedule_region_trees(job_queue, 0);
+    m_region_tree_repository.for_each(schedule_region_trees);
+
+    ScheduleTreeUpdates<TriangleTree> schedule_triangle_trees(
+        job_queue,
+        m_paged_triangle_trees ? &m_triangle_tree_store : 0);
+    m_triangle_tree_repository.for_each(schedule_triangle_trees);
+
+    ScheduleTreeUpdates<CurveTree> schedule_curve_trees(job_queue, 0);
+    m_curve_tree_repository.for_each(schedule_curve_trees);
+
+    // Proxy trees belong to a single assembly and always stay in memory.
+    size_t proxy_tree_count = 0;
+    for (const_each<ProxyTreesContainer> i = m_proxy_trees; i; ++i)
+    {
+        for (const_each<vector<ProxyLevel>> j = i->second->m_levels; j; ++j)
+        {
+            job_queue.schedule(new UpdateTreeJob<TriangleTree>(*j->m_tree, true));
+            ++proxy_tree_count;
+        }
+    }
+
+    const size_t tree_count =
+        schedule_region_trees.m_job_count +
+        schedule_triangle_trees.m_job_count +
+        schedule_curve_trees.m_job_count +
+        proxy_tree_count;
+
+    if (tree_count == 0)
+        return;
+
+    const size_t max_thread_count =
+        thread_count > 0 ? thread_count : System::get_logical_cpu_core_count();
+    const size_t used_thread_count = min(tree_count, max_thread_count);
+
+    JobManager job_manager(
+        global_logger(),
+        job_queue,
+        used_thread_count);
+    job_manager.start();
+    job_queue.wait_until_completion();
+
+    stopwatch.measure();
+
+    RENDERER_LOG_INFO(
+        "updated %s child %s of the assembly tree in %s using %s %s.",
+        pretty_uint(tree_count).c_str(),
+        plural(tree_count, "tree").c_str(),
+        pretty_time(stopwatch.get_seconds()).c_str(),
+        pretty_uint(used_thread_count).c_str(),
+        plural(used_thread_count, "thread").c_str());
+}
+
+namespace
 {
-    UpdateTrees<RegionTree> update_trees;
-    m_region_tree_repository.for_each(update_trees);
+    template <typename TreeType>
+    const TreeType* find_child_tree(
+        const map<UniqueID, Lazy<TreeType>*>&       trees,
+        const UniqueID                              assembly_uid)
+    {
+        const typename map<UniqueID, Lazy<TreeType>*>::const_iterator it =
+            trees.find(assembly_uid);
+
+        if (it == trees.end())
+            return 0;
+
+        // The tree was built by update_child_trees(), this doesn't construct anything.
+        // Releasing access doesn't delete the tree, it lives as long as its lazy object.
+        Access<TreeType> access(it->second);
+        return access.get();
+    }
 }
 
-void AssemblyTree::update_triangle_trees()
+void AssemblyTree::resolve_child_trees()
 {
-    UpdateTrees<TriangleTree> update_trees;
-    m_triangle_tree_repository.for_each(update_trees);
+    for (each<ProxyTreesContainer> i = m_proxy_trees; i; ++i)
+    {
+        for (each<vector<ProxyLevel>> j = i->second->m_levels; j; ++j)
+        {
+            Access<TriangleTree> access(j->m_tree);
+            j->m_resolved_tree = access.get();
+        }
+    }
+
+    for (each<ItemVector> i = m_items; i; ++i)
+    {
+        i->m_region_tree = find_child_tree(m_region_trees, i->m_assembly_uid);
+        i->m_triangle_tree = m_paged_triangle_trees ? 0 : find_child_tree(m_triangle_trees, i->m_assembly_uid);
+        i->m_curve_tree = find_child_tree(m_curve_trees, i->m_assembly_uid);
+
+        const ProxyTreesContainer::const_iterator proxy_trees = m_proxy_trees.find(i->m_assembly_uid);
+        i->m_proxy_trees = proxy_trees != m_proxy_trees.end() ? proxy_trees->second : 0;
+    }
+
+    // Refresh the copies of the items stored in fat leaves.
+    Statistics statistics;
+    store_items_in_leaves(statistics);
+}
+
+size_t AssemblyTree::select_proxy_level(
+    const ProxyTrees&           proxy_trees,
+    const AssemblyInstance&     assembly_instance,
+    const Transformd&           assembly_instance_transform,
+    const ShadingPoint*         parent_shading_point,
+    const ShadingRay&           ray,
+    const ShadingRay&           local_ray,
+    const RayInfo3d&            local_ray_info)
+{
+    // Rays leaving an assembly instance intersect the same geometry as the ray that
+    // hit it, otherwise they could hit the surface they are leaving.
+    if (parent_shading_point &&
+        parent_shading_point->get_assembly_instance().get_uid() == assembly_instance.get_uid())
+        return parent_shading_point->m_proxy_level;
+
+    // Only rays with differentials have a footprint.
+    if (!ray.m_has_differentials)
+        return 0;
+
+    // Find where the ray enters the assembly.
+    double tmin, tmax;
+    if (!intersect(local_ray, local_ray_info, proxy_trees.m_bbox, tmin, tmax))
+        return 0;
+
+    const double t = max(tmin, local_ray.m_tmin);
+    if (t >= local_ray.m_tmax)
+        return 0;
+
+    // Compute the footprint of the ray at that distance, in assembly space.
+    const Vector3d p = local_ray.point_at(t);
+    const Vector3d px = assembly_instance_transform.point_to_local(ray.m_rx.point_at(t));
+    const Vector3d py = assembly_instance_transform.point_to_local(ray.m_ry.point_at(t));
+    const double footprint = max(norm(px - p), norm(py - p));
+
+    // Select the coarsest level whose geometric error is within tolerance.
+    const double max_error = proxy_trees.m_tolerance * footprint;
+    for (size_t i = proxy_trees.m_levels.size(); i > 0; --i)
+    {
+        if (proxy_trees.m_levels[i - 1].m_error <= max_error)
+            return i;
+    }
+
+    return 0;
 }
 
 
@@ -665,18 +1138,30 @@ bool AssemblyLeafVisitor::visit(
             local_shading_point.m_ray);
         const RayInfo3d local_ray_info(local_shading_point.m_ray);
 
+        // Select the level of detail of the triangle geometry of this assembly.
+        const size_t proxy_level =
+            item.m_proxy_trees
+                ? AssemblyTree::select_proxy_level(
+                      *item.m_proxy_trees,
+                      assembly_instance,
+                      assembly_instance_transform,
+                      m_parent_shading_point,
+                      ray,
+                      local_shading_point.m_ray,
+                      local_ray_info)
+                : 0;
+
         if (item.m_assembly->is_flushable())
         {
             // Retrieve the region tree of this assembly.
-            const RegionTree& region_tree =
-                *m_region_tree_cache.access(
-                    item.m_assembly_uid,
-                    m_tree.m_region_trees);
+            assert(item.m_region_tree);
+            const RegionTree& region_tree = *item.m_region_tree;
 
             // Check the intersection between the ray and the region tree.
             RegionLeafVisitor visitor(
                 local_shading_point,
-                m_triangle_tree_cache
+                m_triangle_tree_cache,
+                m_filter_stats
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
                 , m_triangle_tree_stats
 #endif
@@ -690,17 +1175,22 @@ bool AssemblyLeafVisitor::visit(
         }
         else
         {
-            // Retrieve the triangle tree of this assembly.
+            // Retrieve the triangle tree of this assembly, or one of its proxies. The access
+            // cache keeps trees of the triangle tree store in memory while they are in use.
             const TriangleTree* triangle_tree =
-                m_triangle_tree_cache.access(
-                    item.m_assembly_uid,
-                    m_tree.m_triangle_trees);
+                proxy_level > 0 ? item.m_proxy_trees->m_levels[proxy_level - 1].m_resolved_tree :
+                m_tree.m_paged_triangle_trees
+                    ? m_triangle_tree_cache.access(item.m_assembly_uid, m_tree.m_triangle_trees)
+                    : item.m_triangle_tree;
 
             if (triangle_tree)
             {
                 // Check the intersection between the ray and the triangle tree.
                 TriangleTreeIntersector intersector;
-                TriangleLeafVisitor visitor(*triangle_tree, local_shading_point);
+                TriangleLeafVisitor visitor(
+                    *triangle_tree,
+                    local_shading_point,
+                    m_filter_stats);
                 if (triangle_tree->get_moving_triangle_count() > 0)
                 {
                     intersector.intersect_motion(
@@ -731,10 +1221,7 @@ bool AssemblyLeafVisitor::visit(
         }
 
         // Retrieve the curve tree of this assembly.
-        const CurveTree* curve_tree =
-            m_curve_tree_cache.access(
-                item.m_assembly_uid,
-                m_tree.m_curve_trees);
+        const CurveTree* curve_tree = item.m_curve_tree;
 
         if (curve_tree)
         {
@@ -769,6 +1256,7 @@ bool AssemblyLeafVisitor::visit(
             m_shading_point.m_region_index = local_shading_point.m_region_index;
             m_shading_point.m_primitive_index = local_shading_point.m_primitive_index;
             m_shading_point.m_triangle_support_plane = local_shading_point.m_triangle_support_plane;
+            m_shading_point.m_proxy_level = proxy_level;
         }
     }
 
@@ -826,13 +1314,24 @@ bool AssemblyLeafProbeVisitor::visit(
             local_ray);
         const RayInfo3d local_ray_info(local_ray);
 
+        // Select the level of detail of the triangle geometry of this assembly.
+        const size_t proxy_level =
+            item.m_proxy_trees
+                ? AssemblyTree::select_proxy_level(
+                      *item.m_proxy_trees,
+                      assembly_instance,
+                      assembly_instance_transform,
+                      m_parent_shading_point,
+                      ray,
+                      local_ray,
+                      local_ray_info)
+                : 0;
+
         if (item.m_assembly->is_flushable())
         {
             // Retrieve the region tree of this assembly.
-            const RegionTree& region_tree =
-                *m_region_tree_cache.access(
-                    item.m_assembly_uid,
-                    m_tree.m_region_trees);
+            assert(item.m_region_tree);
+            const RegionTree& region_tree = *item.m_region_tree;
 
             // Check the intersection between the ray and the region tree.
             RegionLeafProbeVisitor visitor(
@@ -857,11 +1356,13 @@ bool AssemblyLeafProbeVisitor::visit(
         }
         else
         {
-            // Retrieve the triangle tree of this assembly.
+            // Retrieve the triangle tree of this assembly, or one of its proxies. The access
+            // cache keeps trees of the triangle tree store in memory while they are in use.
             const TriangleTree* triangle_tree =
-                m_triangle_tree_cache.access(
-                    item.m_assembly_uid,
-                    m_tree.m_triangle_trees);
+                proxy_level > 0 ? item.m_proxy_trees->m_levels[proxy_level - 1].m_resolved_tree :
+                m_tree.m_paged_triangle_trees
+                    ? m_triangle_tree_cache.access(item.m_assembly_uid, m_tree.m_triangle_trees)
+                    : item.m_triangle_tree;
 
             if (triangle_tree)
             {
@@ -904,10 +1405,7 @@ bool AssemblyLeafProbeVisitor::visit(
         }
 
         // Retrieve the curve tree of this assembly.
-        const CurveTree* curve_tree =
-            m_curve_tree_cache.access(
-                item.m_assembly_uid,
-                m_tree.m_curve_trees);
+        const CurveTree* curve_tree = item.m_curve_tree;
 
         if (curve_tree)
         {
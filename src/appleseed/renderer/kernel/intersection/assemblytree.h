@@ -45,7 +45,11 @@
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/aabb.h"
 #include "foundation/math/bvh.h"
+#include "foundation/math/ray.h"
+#include "foundation/math/transform.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/alignedvector.h"
+#include "foundation/utility/lazy.h"
 #include "foundation/utility/uid.h"
 #include "foundation/utility/version.h"
 
@@ -59,6 +63,7 @@ namespace foundation    { class Statistics; }
 namespace renderer      { class AssemblyInstance; }
 namespace renderer      { class Scene; }
 namespace renderer      { class ShadingPoint; }
+namespace renderer      { class TriangleTreeStore; }
 
 namespace renderer
 {
@@ -75,14 +80,19 @@ class AssemblyTree
            >
 {
   public:
-    // Constructor, builds the tree for a given scene.
-    explicit AssemblyTree(const Scene& scene);
+    // Constructor, builds the tree for a given scene. Triangle trees are paged in and out
+    // by the given triangle tree store when it is enabled. Child trees are built using
+    // up to thread_count threads (0 for one thread per logical CPU core).
+    AssemblyTree(
+        const Scene&        scene,
+        TriangleTreeStore&  triangle_tree_store,
+        const size_t        thread_count = 0);
 
     // Destructor.
     ~AssemblyTree();
 
     // Update the assembly tree and all the child trees.
-    void update();
+    void update(const size_t thread_count = 0);
 
     // Return the size (in bytes) of this object in memory.
     size_t get_memory_size() const;
@@ -92,6 +102,24 @@ class AssemblyTree
     friend class AssemblyLeafProbeVisitor;
     friend class Intersector;
 
+    // Simplified versions of the triangle tree of an assembly, used instead of the full
+    // resolution tree when the footprint of a ray on an assembly instance is large enough.
+    struct ProxyLevel
+    {
+        foundation::Lazy<TriangleTree>*         m_tree;
+        const TriangleTree*                     m_resolved_tree;
+        double                                  m_error;            // maximum geometric error in assembly space
+    };
+
+    struct ProxyTrees
+    {
+        foundation::AABB3d                      m_bbox;             // assembly space bounding box
+        double                                  m_tolerance;        // maximum ratio between the geometric error and the ray footprint
+        std::vector<ProxyLevel>                 m_levels;           // from the finest to the coarsest level
+    };
+
+    typedef std::map<foundation::UniqueID, ProxyTrees*> ProxyTreesContainer;
+
     struct Item
     {
         const renderer::Assembly*               m_assembly;
@@ -99,6 +127,12 @@ class AssemblyTree
         const renderer::AssemblyInstance*       m_assembly_instance;
         renderer::TransformSequence             m_transform_sequence;
 
+        // Child trees of the assembly, resolved once all child trees are built.
+        const RegionTree*                       m_region_tree;
+        const TriangleTree*                     m_triangle_tree;
+        const CurveTree*                        m_curve_tree;
+        const ProxyTrees*                       m_proxy_trees;
+
         Item() {}
 
         Item(
@@ -109,6 +143,10 @@ class AssemblyTree
           , m_assembly_uid(assembly->get_uid())
           , m_assembly_instance(assembly_instance)
           , m_transform_sequence(transform_sequence)
+          , m_region_tree(0)
+          , m_triangle_tree(0)
+          , m_curve_tree(0)
+          , m_proxy_trees(0)
         {
         }
     };
@@ -119,7 +157,12 @@ class AssemblyTree
     typedef std::map<foundation::UniqueID, foundation::VersionID> AssemblyVersionMap;
 
     const Scene&                    m_scene;
+    TriangleTreeStore&              m_triangle_tree_store;
+    bool                            m_paged_triangle_trees;
     ItemVector                      m_items;
+    std::vector<size_t>             m_item_ordering;
+    foundation::uint64              m_items_signature;
+    foundation::uint64              m_structure_signature;
     AssemblyVersionMap              m_assembly_versions;
 
     TreeRepository<TriangleTree>    m_triangle_tree_repository;
@@ -131,15 +174,32 @@ class AssemblyTree
     TreeRepository<CurveTree>       m_curve_tree_repository;
     CurveTreeContainer              m_curve_trees;
 
+    ProxyTreesContainer             m_proxy_trees;
+
     void collect_assembly_instances(
         const AssemblyInstanceContainer&        assembly_instances,
         const TransformSequence&                parent_transform_seq,
         AABBVector&                             assembly_instance_bboxes);
 
+    foundation::uint64 compute_items_signature(
+        const AssemblyInstanceContainer&        assembly_instances) const;
+
+    // Like compute_items_signature() but ignoring the transforms of assembly instances.
+    foundation::uint64 compute_structure_signature(
+        const AssemblyInstanceContainer&        assembly_instances) const;
+
     void rebuild_assembly_tree();
+
+    // Update the bounding boxes of the tree after assembly instances have moved,
+    // keeping the topology of the tree.
+    void refit_assembly_tree();
+    foundation::AABB3d refit_node(
+        const size_t                            node_index,
+        const AABBVector&                       assembly_instance_bboxes);
+
     void store_items_in_leaves(foundation::Statistics& statistics);
 
-    void update_tree_hierarchy();
+    void update_tree_hierarchy(const size_t thread_count);
     void collect_unique_assemblies(AssemblyVector& assemblies) const;
     void delete_unused_child_trees(const AssemblyVector& assemblies);
 
@@ -147,14 +207,34 @@ class AssemblyTree
     void create_region_tree(const Assembly& assembly);
     void create_triangle_tree(const Assembly& assembly);
     void create_curve_tree(const Assembly& assembly);
+    void create_proxy_trees(const Assembly& assembly);
 
+    void delete_all_child_trees();
     void delete_child_trees(const foundation::UniqueID assembly_id);
     void delete_region_tree(const foundation::UniqueID assembly_id);
     void delete_triangle_tree(const foundation::UniqueID assembly_id);
     void delete_curve_tree(const foundation::UniqueID assembly_id);
-
-    void update_region_trees();
-    void update_triangle_trees();
+    void delete_proxy_trees(const foundation::UniqueID assembly_id);
+
+    // Build the child trees that don't exist yet and update all of them, in parallel.
+    void update_child_trees(const size_t thread_count);
+
+    // Store direct pointers to the child trees in the items, so that traversal
+    // doesn't need to go through access caches and lazy objects. Triangle trees
+    // of the triangle tree store may be evicted and are always accessed through
+    // the triangle tree access cache instead.
+    void resolve_child_trees();
+
+    // Return the proxy level to intersect for a given ray in assembly instance space,
+    // or 0 to intersect the full resolution geometry.
+    static size_t select_proxy_level(
+        const ProxyTrees&                       proxy_trees,
+        const AssemblyInstance&                 assembly_instance,
+        const foundation::Transformd&           assembly_instance_transform,
+        const ShadingPoint*                     parent_shading_point,
+        const ShadingRay&                       ray,
+        const ShadingRay&                       local_ray,
+        const foundation::RayInfo3d&            local_ray_info);
 };
 
 
@@ -170,10 +250,9 @@ class AssemblyLeafVisitor
     AssemblyLeafVisitor(
         ShadingPoint&                               shading_point,
         const AssemblyTree&                         tree,
-        RegionTreeAccessCache&                      region_tree_cache,
         TriangleTreeAccessCache&                    triangle_tree_cache,
-        CurveTreeAccessCache&                       curve_tree_cache,
-        const ShadingPoint*                         parent_shading_point
+        const ShadingPoint*                         parent_shading_point,
+        IntersectionFilterStatistics&               filter_stats
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
         , foundation::bvh::TraversalStatistics&     triangle_tree_stats
         , foundation::bvh::TraversalStatistics&     curve_tree_stats
@@ -194,10 +273,9 @@ class AssemblyLeafVisitor
   private:
     ShadingPoint&                                   m_shading_point;
     const AssemblyTree&                             m_tree;
-    RegionTreeAccessCache&                          m_region_tree_cache;
     TriangleTreeAccessCache&                        m_triangle_tree_cache;
-    CurveTreeAccessCache&                           m_curve_tree_cache;
     const ShadingPoint*                             m_parent_shading_point;
+    IntersectionFilterStatistics&                   m_filter_stats;
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
     foundation::bvh::TraversalStatistics&           m_triangle_tree_stats;
     foundation::bvh::TraversalStatistics&           m_curve_tree_stats;
@@ -217,9 +295,7 @@ class AssemblyLeafProbeVisitor
     // Constructor.
     AssemblyLeafProbeVisitor(
         const AssemblyTree&                         tree,
-        RegionTreeAccessCache&                      region_tree_cache,
         TriangleTreeAccessCache&                    triangle_tree_cache,
-        CurveTreeAccessCache&                       curve_tree_cache,
         const ShadingPoint*                         parent_shading_point
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
         , foundation::bvh::TraversalStatistics&     triangle_tree_stats
@@ -240,9 +316,7 @@ class AssemblyLeafProbeVisitor
 
   private:
     const AssemblyTree&                             m_tree;
-    RegionTreeAccessCache&                          m_region_tree_cache;
     TriangleTreeAccessCache&                        m_triangle_tree_cache;
-    CurveTreeAccessCache&                           m_curve_tree_cache;
     const ShadingPoint*                             m_parent_shading_point;
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
     foundation::bvh::TraversalStatistics&           m_triangle_tree_stats;
@@ -275,10 +349,9 @@ typedef foundation::bvh::Intersector<
 inline AssemblyLeafVisitor::AssemblyLeafVisitor(
     ShadingPoint&                                   shading_point,
     const AssemblyTree&                             tree,
-    RegionTreeAccessCache&                          region_tree_cache,
     TriangleTreeAccessCache&                        triangle_tree_cache,
-    CurveTreeAccessCache&                           curve_tree_cache,
-    const ShadingPoint*                             parent_shading_point
+    const ShadingPoint*                             parent_shading_point,
+    IntersectionFilterStatistics&                   filter_stats
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
     , foundation::bvh::TraversalStatistics&         triangle_tree_stats
     , foundation::bvh::TraversalStatistics&         curve_tree_stats
@@ -286,10 +359,9 @@ inline AssemblyLeafVisitor::AssemblyLeafVisitor(
     )
   : m_shading_point(shading_point)
   , m_tree(tree)
-  , m_region_tree_cache(region_tree_cache)
   , m_triangle_tree_cache(triangle_tree_cache)
-  , m_curve_tree_cache(curve_tree_cache)
   , m_parent_shading_point(parent_shading_point)
+  , m_filter_stats(filter_stats)
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
   , m_triangle_tree_stats(triangle_tree_stats)
   , m_curve_tree_stats(curve_tree_stats)
@@ -304,9 +376,7 @@ inline AssemblyLeafVisitor::AssemblyLeafVisitor(
 
 inline AssemblyLeafProbeVisitor::AssemblyLeafProbeVisitor(
     const AssemblyTree&                             tree,
-    RegionTreeAccessCache&                          region_tree_cache,
     TriangleTreeAccessCache&                        triangle_tree_cache,
-    CurveTreeAccessCache&                           curve_tree_cache,
     const ShadingPoint*                             parent_shading_point
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
     , foundation::bvh::TraversalStatistics&         triangle_tree_stats
@@ -314,9 +384,7 @@ inline AssemblyLeafProbeVisitor::AssemblyLeafProbeVisitor(
 #endif
     )
   : m_tree(tree)
-  , m_region_tree_cache(region_tree_cache)
   , m_triangle_tree_cache(triangle_tree_cache)
-  , m_curve_tree_cache(curve_tree_cache)
   , m_parent_shading_point(parent_shading_point)
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
   , m_triangle_tree_stats(triangle_tree_stats)
@@ -0,0 +1,394 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "bvhcache.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/filesystem.hpp"
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+namespace bf = boost::filesystem;
+
+namespace renderer
+{
+
+namespace
+{
+    const uint64 DefaultBVHCacheSizeMB = 4096;
+
+    struct BVHCacheState
+    {
+        boost::mutex    m_mutex;
+        string          m_directory;
+        uint64          m_max_size;
+        uint64          m_hit_count;
+        uint64          m_miss_count;
+        uint64          m_invalid_count;
+        uint64          m_store_count;
+        uint64          m_evict_count;
+        uint64          m_bytes_read;
+        uint64          m_bytes_written;
+
+        BVHCacheState()
+          : m_max_size(DefaultBVHCacheSizeMB * 1024 * 1024)
+          , m_hit_count(0)
+          , m_miss_count(0)
+          , m_invalid_count(0)
+          , m_store_count(0)
+          , m_evict_count(0)
+          , m_bytes_read(0)
+          , m_bytes_written(0)
+        {
+        }
+    };
+
+    BVHCacheState g_state;
+
+    bf::path get_file_path(const string& directory, const uint64 key)
+    {
+        char filename[32];
+        sprintf(filename, "%016llx", static_cast<unsigned long long>(key));
+        return bf::path(directory) / (string(filename) + BVHCacheFileExtension);
+    }
+
+    struct CacheFile
+    {
+        bf::path        m_path;
+        uint64          m_size;
+        time_t          m_time;
+
+        bool operator<(const CacheFile& rhs) const
+        {
+            return m_time < rhs.m_time;
+        }
+    };
+
+    // Delete the least recently used cache files until the total size of the cache
+    // fits within the size cap. Must be called with the state mutex locked.
+    void enforce_size_cap(const string& directory, const uint64 max_size)
+    {
+        try
+        {
+            vector<CacheFile> files;
+            uint64 total_size = 0;
+
+            for (bf::directory_iterator i(directory), e; i != e; ++i)
+            {
+                const bf::path& path = i->path();
+
+                if (path.extension() != BVHCacheFileExtension || !bf::is_regular_file(path))
+                    continue;
+
+                CacheFile file;
+                file.m_path = path;
+                file.m_size = static_cast<uint64>(bf::file_size(path));
+                file.m_time = bf::last_write_time(path);
+                files.push_back(file);
+
+                total_size += file.m_size;
+            }
+
+            if (total_size <= max_size)
+                return;
+
+            sort(files.begin(), files.end());
+
+            for (size_t i = 0; i < files.size() && total_size > max_size; ++i)
+            {
+                boost::system::error_code ec;
+                bf::remove(files[i].m_path, ec);
+
+                if (!ec)
+                {
+                    total_size -= files[i].m_size;
+                    ++g_state.m_evict_count;
+                }
+            }
+        }
+        catch (const exception& e)
+        {
+            RENDERER_LOG_WARNING("failed to enforce the size limit of the bvh cache: %s.", e.what());
+        }
+    }
+}
+
+Dictionary BVHCache::get_params_metadata()
+{
+    Dictionary metadata;
+
+    metadata.dictionaries().insert(
+        "directory",
+        Dictionary()
+            .insert("type", "text")
+            .insert("default", "")
+            .insert("label", "BVH Cache Directory")
+            .insert("help", "Directory where built acceleration structures are cached across renders (caching is disabled if empty)"));
+
+    metadata.dictionaries().insert(
+        "max_size",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", DefaultBVHCacheSizeMB * 1024 * 1024)
+            .insert("label", "BVH Cache Size")
+            .insert("help", "Maximum size in bytes of the BVH cache directory"));
+
+    return metadata;
+}
+
+void BVHCache::configure(const ParamArray& params)
+{
+    const string directory = params.get_optional<string>("directory", "");
+    const uint64 max_size = params.get_optional<uint64>("max_size", DefaultBVHCacheSizeMB * 1024 * 1024);
+
+    boost::mutex::scoped_lock lock(g_state.m_mutex);
+
+    g_state.m_directory.clear();
+    g_state.m_max_size = max_size;
+
+    if (directory.empty())
+        return;
+
+    try
+    {
+        bf::create_directories(bf::path(directory));
+        g_state.m_directory = directory;
+    }
+    catch (const exception& e)
+    {
+        RENDERER_LOG_WARNING(
+            "failed to create bvh cache directory %s, bvh caching is disabled: %s.",
+            directory.c_str(),
+            e.what());
+    }
+}
+
+bool BVHCache::is_enabled()
+{
+    boost::mutex::scoped_lock lock(g_state.m_mutex);
+    return !g_state.m_directory.empty();
+}
+
+bool BVHCache::open_for_reading(
+    const uint64                key,
+    BufferedFile&               file,
+    uint64&                     file_size)
+{
+    bf::path path;
+
+    {
+        boost::mutex::scoped_lock lock(g_state.m_mutex);
+
+        if (g_state.m_directory.empty())
+            return false;
+
+        path = get_file_path(g_state.m_directory, key);
+    }
+
+    bool success = false;
+
+    try
+    {
+        if (bf::is_regular_file(path))
+        {
+            file_size = static_cast<uint64>(bf::file_size(path));
+
+            BVHCacheFileHeader header;
+
+            success =
+                file.open(path.string().c_str(), BufferedFile::BinaryType, BufferedFile::ReadMode) &&
+                read_item(file, header) &&
+                memcmp(header.m_magic, BVHCacheFileMagic, sizeof(header.m_magic)) == 0 &&
+                header.m_version == BVHCacheFileVersion &&
+                header.m_key == key;
+
+            // Mark the file as recently used.
+            if (success)
+                bf::last_write_time(path, time(0));
+        }
+    }
+    catch (const exception&)
+    {
+        success = false;
+    }
+
+    boost::mutex::scoped_lock lock(g_state.m_mutex);
+
+    if (success)
+    {
+        ++g_state.m_hit_count;
+        g_state.m_bytes_read += file_size;
+    }
+    else
+    {
+        if (file.is_open())
+        {
+            file.close();
+            ++g_state.m_invalid_count;
+        }
+
+        ++g_state.m_miss_count;
+    }
+
+    return success;
+}
+
+void BVHCache::report_invalid_file(const uint64 key)
+{
+    boost::mutex::scoped_lock lock(g_state.m_mutex);
+
+    // The load was counted as a hit, count it as a miss instead.
+    --g_state.m_hit_count;
+    ++g_state.m_miss_count;
+    ++g_state.m_invalid_count;
+
+    if (!g_state.m_directory.empty())
+    {
+        boost::system::error_code ec;
+        bf::remove(get_file_path(g_state.m_directory, key), ec);
+    }
+}
+
+bool BVHCache::open_for_writing(
+    const uint64                key,
+    BufferedFile&               file,
+    string&                     temp_path)
+{
+    string directory;
+
+    {
+        boost::mutex::scoped_lock lock(g_state.m_mutex);
+
+        if (g_state.m_directory.empty())
+            return false;
+
+        directory = g_state.m_directory;
+    }
+
+    try
+    {
+        temp_path = (bf::path(directory) / bf::unique_path("%%%%-%%%%-%%%%-%%%%.tmp")).string();
+    }
+    catch (const exception&)
+    {
+        return false;
+    }
+
+    BVHCacheFileHeader header;
+    memcpy(header.m_magic, BVHCacheFileMagic, sizeof(header.m_magic));
+    header.m_version = BVHCacheFileVersion;
+    header.m_key = key;
+
+    if (!file.open(temp_path.c_str(), BufferedFile::BinaryType, BufferedFile::WriteMode))
+        return false;
+
+    if (!write_item(file, header))
+    {
+        close_for_writing(key, file, temp_path, false);
+        return false;
+    }
+
+    return true;
+}
+
+void BVHCache::close_for_writing(
+    const uint64                key,
+    BufferedFile&               file,
+    const string&               temp_path,
+    const bool                  success)
+{
+    const bool closed = file.close();
+
+    boost::mutex::scoped_lock lock(g_state.m_mutex);
+
+    boost::system::error_code ec;
+
+    if (!success || !closed || g_state.m_directory.empty())
+    {
+        bf::remove(bf::path(temp_path), ec);
+        return;
+    }
+
+    const bf::path path = get_file_path(g_state.m_directory, key);
+
+    // Another render may have stored the same structure in the meantime,
+    // in which case the rename simply replaces it with an identical file.
+    bf::rename(bf::path(temp_path), path, ec);
+
+    if (ec)
+    {
+        RENDERER_LOG_WARNING("failed to store %s in the bvh cache: %s.", path.string().c_str(), ec.message().c_str());
+        bf::remove(bf::path(temp_path), ec);
+        return;
+    }
+
+    ++g_state.m_store_count;
+    g_state.m_bytes_written += static_cast<uint64>(bf::file_size(path, ec));
+
+    enforce_size_cap(g_state.m_directory, g_state.m_max_size);
+}
+
+StatisticsVector BVHCache::get_statistics()
+{
+    boost::mutex::scoped_lock lock(g_state.m_mutex);
+
+    Statistics stats;
+    stats.insert("directory", g_state.m_directory.empty() ? string("n/a") : g_state.m_directory);
+    stats.insert_size("size limit", g_state.m_max_size);
+    stats.insert("hits", g_state.m_hit_count);
+    stats.insert("misses", g_state.m_miss_count);
+    stats.insert_percent("hit rate", g_state.m_hit_count, g_state.m_hit_count + g_state.m_miss_count);
+    stats.insert("invalid files", g_state.m_invalid_count);
+    stats.insert("stored", g_state.m_store_count);
+    stats.insert("evicted", g_state.m_evict_count);
+    stats.insert_size("bytes read", g_state.m_bytes_read);
+    stats.insert_size("bytes written", g_state.m_bytes_written);
+
+    return StatisticsVector::make("bvh cache statistics", stats);
+}
+
+}   // namespace renderer
@@ -0,0 +1,201 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_INTERSECTION_BVHCACHE_H
+#define APPLESEED_RENDERER_KERNEL_INTERSECTION_BVHCACHE_H
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+#include "foundation/utility/bufferedfile.h"
+#include "foundation/utility/statistics.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+// Forward declarations.
+namespace foundation    { class Dictionary; }
+namespace renderer      { class ParamArray; }
+
+namespace renderer
+{
+
+//
+// A persistent, on-disk cache of built acceleration structures, shared by all the
+// renders of a machine.
+//
+// Each structure is stored in its own file, named after a 64-bit key that must cover
+// everything the structure depends on: the geometry, the transforms feeding the tree,
+// the build settings and the layout of the stored data types. Files are written to a
+// temporary name and renamed once complete, so concurrent renders never see partial
+// files. When the total size of the cache exceeds its cap, the least recently used
+// files are deleted.
+//
+// Cache files hold raw arrays of the tree data and are only valid for the platform
+// and the build of appleseed that wrote them.
+//
+// The cache is disabled until a cache directory is configured.
+//
+
+const char BVHCacheFileMagic[4] = { 'A', 'S', 'B', 'C' };
+const foundation::uint32 BVHCacheFileVersion = 2;
+const char BVHCacheFileExtension[] = ".asbvhcache";
+
+struct BVHCacheFileHeader
+{
+    char                    m_magic[4];
+    foundation::uint32      m_version;
+    foundation::uint64      m_key;
+};
+
+class APPLESEED_DLLSYMBOL BVHCache
+{
+  public:
+    // Return the metadata of the cache parameters.
+    static foundation::Dictionary get_params_metadata();
+
+    // Configure the cache from the "bvh_cache" parameters of the renderer.
+    static void configure(const ParamArray& params);
+
+    // Return true if a cache directory was configured.
+    static bool is_enabled();
+
+    // Open the cache file of a given key for reading and return its size in bytes.
+    // Returns false on a cache miss, or if the cache file is invalid.
+    static bool open_for_reading(
+        const foundation::uint64    key,
+        foundation::BufferedFile&   file,
+        foundation::uint64&         file_size);
+
+    // Record that data read from an opened cache file turned out to be invalid.
+    static void report_invalid_file(const foundation::uint64 key);
+
+    // Open a new, temporary cache file for writing.
+    static bool open_for_writing(
+        const foundation::uint64    key,
+        foundation::BufferedFile&   file,
+        std::string&                temp_path);
+
+    // Close a cache file opened with open_for_writing() and, if the write succeeded,
+    // make it visible under its final name and enforce the size cap of the cache.
+    static void close_for_writing(
+        const foundation::uint64    key,
+        foundation::BufferedFile&   file,
+        const std::string&          temp_path,
+        const bool                  success);
+
+    // Retrieve cache statistics.
+    static foundation::StatisticsVector get_statistics();
+
+    // Write and read a vector of plain-old-data items, preceded by its size.
+    template <typename Vector>
+    static bool write_vector(
+        foundation::BufferedFile&   file,
+        const Vector&               vec);
+    template <typename Vector>
+    static bool read_vector(
+        foundation::BufferedFile&   file,
+        const foundation::uint64    file_size,
+        Vector&                     vec);
+
+    // Write and read a single plain-old-data item.
+    template <typename T>
+    static bool write_item(
+        foundation::BufferedFile&   file,
+        const T&                    item);
+    template <typename T>
+    static bool read_item(
+        foundation::BufferedFile&   file,
+        T&                          item);
+};
+
+
+//
+// BVHCache class implementation.
+//
+
+template <typename Vector>
+bool BVHCache::write_vector(
+    foundation::BufferedFile&       file,
+    const Vector&                   vec)
+{
+    const foundation::uint64 size = static_cast<foundation::uint64>(vec.size());
+
+    if (!write_item(file, size))
+        return false;
+
+    const size_t byte_count = vec.size() * sizeof(typename Vector::value_type);
+
+    return byte_count == 0 || file.write(&vec[0], byte_count) == byte_count;
+}
+
+template <typename Vector>
+bool BVHCache::read_vector(
+    foundation::BufferedFile&       file,
+    const foundation::uint64        file_size,
+    Vector&                         vec)
+{
+    foundation::uint64 size;
+
+    if (!read_item(file, size))
+        return false;
+
+    // Guard against corrupted sizes before allocating memory.
+    const foundation::uint64 position = static_cast<foundation::uint64>(file.tell());
+    if (position > file_size || size > (file_size - position) / sizeof(typename Vector::value_type))
+        return false;
+
+    vec.resize(static_cast<size_t>(size));
+
+    const size_t byte_count = vec.size() * sizeof(typename Vector::value_type);
+
+    return byte_count == 0 || file.read(&vec[0], byte_count) == byte_count;
+}
+
+template <typename T>
+bool BVHCache::write_item(
+    foundation::BufferedFile&       file,
+    const T&                        item)
+{
+    return file.write(&item, sizeof(T)) == sizeof(T);
+}
+
+template <typename T>
+bool BVHCache::read_item(
+    foundation::BufferedFile&       file,
+    T&                              item)
+{
+    return file.read(&item, sizeof(T)) == sizeof(T);
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_INTERSECTION_BVHCACHE_H
@@ -31,6 +31,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/intersection/bvhcache.h"
 #include "renderer/modeling/object/curveobject.h"
 #include "renderer/modeling/object/object.h"
 #include "renderer/modeling/scene/assembly.h"
@@ -48,8 +49,10 @@
 #include "foundation/platform/system.h"
 #include "foundation/utility/alignedallocator.h"
 #include "foundation/utility/api/apistring.h"
+#include "foundation/utility/bufferedfile.h"
 #include "foundation/utility/makevector.h"
 #include "foundation/utility/memory.h"
+#include "foundation/utility/siphash.h"
 #include "foundation/utility/statistics.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
@@ -96,11 +99,28 @@ CurveTree::CurveTree(const Arguments& arguments)
     Stopwatch<DefaultWallclockTimer> stopwatch;
     stopwatch.start();
 
-    // Build the tree.
     Statistics statistics;
-    if (algorithm == "bvh")
-        build_bvh(params, time, statistics);
-    else throw ExceptionNotImplemented();
+
+    // Try to load the tree from the BVH cache.
+    const bool use_cache = BVHCache::is_enabled();
+    const uint64 cache_key = use_cache ? compute_cache_key(algorithm) : 0;
+
+    if (use_cache && load_from_cache(cache_key))
+        statistics.insert("bvh cache", "hit");
+    else
+    {
+        // Build the tree.
+        if (algorithm == "bvh")
+            build_bvh(params, time, statistics);
+        else throw ExceptionNotImplemented();
+
+        // Store the tree into the BVH cache.
+        if (use_cache)
+        {
+            store_to_cache(cache_key);
+            statistics.insert("bvh cache", "miss");
+        }
+    }
 
     // Print curve tree statistics.
     statistics.insert_size("nodes alignment", alignment(&m_nodes[0]));
@@ -111,6 +131,112 @@ CurveTree::CurveTree(const Arguments& arguments)
             statistics).to_string().c_str());
 }
 
+uint64 CurveTree::compute_cache_key(const string& algorithm) const
+{
+    // The key covers the curves of the assembly, the transforms of their object
+    // instances, the construction parameters and the layout of the stored data.
+    uint64 key = siphash24(algorithm.c_str(), algorithm.size());
+
+    key = siphash24(key, sizeof(NodeType));
+    key = siphash24(key, sizeof(Curve1Type));
+    key = siphash24(key, sizeof(Curve3Type));
+    key = siphash24(key, sizeof(CurveKey));
+
+    const ObjectInstanceContainer& object_instances = m_arguments.m_assembly.object_instances();
+
+    for (size_t i = 0; i < object_instances.size(); ++i)
+    {
+        const ObjectInstance* object_instance = object_instances.get_by_index(i);
+        assert(object_instance);
+
+        const Object& object = object_instance->get_object();
+
+        if (strcmp(object.get_model(), CurveObjectFactory::get_model()))
+            continue;
+
+        const CurveObject& curve_object = static_cast<const CurveObject&>(object);
+
+        const Transformd::MatrixType& transform =
+            object_instance->get_transform().get_local_to_parent();
+
+        key = siphash24(key, i);
+        key = siphash24(key, siphash24(&transform[0], 16 * sizeof(double)));
+
+        const size_t curve1_count = curve_object.get_curve1_count();
+        key = siphash24(key, curve1_count);
+        if (curve1_count > 0)
+            key = siphash24(key, siphash24(&curve_object.get_curve1(0), curve1_count * sizeof(Curve1Type)));
+
+        const size_t curve3_count = curve_object.get_curve3_count();
+        key = siphash24(key, curve3_count);
+        if (curve3_count > 0)
+            key = siphash24(key, siphash24(&curve_object.get_curve3(0), curve3_count * sizeof(Curve3Type)));
+    }
+
+    return key;
+}
+
+bool CurveTree::load_from_cache(const uint64 key)
+{
+    BufferedFile file;
+    uint64 file_size;
+
+    if (!BVHCache::open_for_reading(key, file, file_size))
+        return false;
+
+    RENDERER_LOG_INFO(
+        "loading curve tree #" FMT_UNIQUE_ID " for assembly \"%s\" from the bvh cache...",
+        m_arguments.m_curve_tree_uid,
+        m_arguments.m_assembly.get_path().c_str());
+
+    const bool success =
+        BVHCache::read_vector(file, file_size, m_nodes) &&
+        BVHCache::read_vector(file, file_size, m_node_bboxes) &&
+        BVHCache::read_vector(file, file_size, m_curves1) &&
+        BVHCache::read_vector(file, file_size, m_curves3) &&
+        BVHCache::read_vector(file, file_size, m_curve_keys) &&
+        !m_nodes.empty();
+
+    file.close();
+
+    if (!success)
+    {
+        RENDERER_LOG_WARNING(
+            "invalid bvh cache file for curve tree #" FMT_UNIQUE_ID ", rebuilding the tree.",
+            m_arguments.m_curve_tree_uid);
+
+        BVHCache::report_invalid_file(key);
+
+        m_nodes.clear();
+        m_node_bboxes.clear();
+        m_curves1.clear();
+        m_curves3.clear();
+        m_curve_keys.clear();
+
+        return false;
+    }
+
+    return true;
+}
+
+void CurveTree::store_to_cache(const uint64 key) const
+{
+    BufferedFile file;
+    string temp_path;
+
+    if (!BVHCache::open_for_writing(key, file, temp_path))
+        return;
+
+    const bool success =
+        BVHCache::write_vector(file, m_nodes) &&
+        BVHCache::write_vector(file, m_node_bboxes) &&
+        BVHCache::write_vector(file, m_curves1) &&
+        BVHCache::write_vector(file, m_curves3) &&
+        BVHCache::write_vector(file, m_curve_keys);
+
+    BVHCache::close_for_writing(key, file, temp_path, success);
+}
+
 void CurveTree::collect_curves(vector<GAABB3>& curve_bboxes)
 {
     const ObjectInstanceContainer& object_instances = m_arguments.m_assembly.object_instances();
@@ -50,6 +50,7 @@
 #include <cstddef>
 #include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 // Forward declarations.
@@ -109,6 +110,10 @@ class CurveTree
     std::vector<Curve3Type> m_curves3;
     std::vector<CurveKey>   m_curve_keys;
 
+    foundation::uint64 compute_cache_key(const std::string& algorithm) const;
+    bool load_from_cache(const foundation::uint64 key);
+    void store_to_cache(const foundation::uint64 key) const;
+
     void collect_curves(std::vector<GAABB3>& curve_bboxes);
 
     void build_bvh(
@@ -32,23 +32,20 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
-#include "renderer/kernel/tessellation/statictessellation.h"
 #include "renderer/modeling/input/source.h"
 #include "renderer/modeling/input/texturesource.h"
 #include "renderer/modeling/material/material.h"
-#include "renderer/modeling/object/iregion.h"
 #include "renderer/modeling/object/object.h"
-#include "renderer/modeling/object/regionkit.h"
 #include "renderer/modeling/scene/objectinstance.h"
 #include "renderer/modeling/scene/textureinstance.h"
 #include "renderer/modeling/texture/texture.h"
 
 // appleseed.foundation headers.
 #include "foundation/image/canvasproperties.h"
-#include "foundation/utility/foreach.h"
-#include "foundation/utility/lazy.h"
+#include "foundation/utility/statistics.h"
 
 // Standard headers.
+#include <algorithm>
 #include <memory>
 
 using namespace foundation;
@@ -57,82 +54,31 @@ using namespace std;
 namespace renderer
 {
 
+//
+// IntersectionFilter class implementation.
+//
+
 namespace
 {
-    size_t get_triangle_count(Object& object)
-    {
-        size_t triangle_count = 0;
-
-        Access<RegionKit> region_kit(&object.get_region_kit());
-
-        for (const_each<RegionKit> i = *region_kit; i; ++i)
-        {
-            const IRegion* region = *i;
-            Access<StaticTriangleTess> tess(&region->get_static_triangle_tess());
-
-            triangle_count += tess->m_primitives.size();
-        }
-
-        return triangle_count;
-    }
-
-    void copy_uv_coordinates(const StaticTriangleTess& tess, vector<Vector2f>& uv)
-    {
-        for (const_each<StaticTriangleTess::PrimitiveArray> i = tess.m_primitives; i; ++i)
-        {
-            if (i->has_vertex_attributes() && tess.get_tex_coords_count() > 0)
-            {
-                const Vector2f uv0(tess.get_tex_coords(i->m_a0));
-                const Vector2f uv1(tess.get_tex_coords(i->m_a1));
-                const Vector2f uv2(tess.get_tex_coords(i->m_a2));
-
-                uv.push_back(Vector2f(uv0[0], 1.0f - uv0[1]));
-                uv.push_back(Vector2f(uv1[0], 1.0f - uv1[1]));
-                uv.push_back(Vector2f(uv2[0], 1.0f - uv2[1]));
-            }
-            else
-            {
-                uv.push_back(Vector2f(0.0f));
-                uv.push_back(Vector2f(0.0f));
-                uv.push_back(Vector2f(0.0f));
-            }
-        }
-    }
-
-    void copy_uv_coordinates(Object& object, vector<Vector2f>& uv)
-    {
-        Access<RegionKit> region_kit(&object.get_region_kit());
-
-        for (const_each<RegionKit> i = *region_kit; i; ++i)
-        {
-            const IRegion* region = *i;
-            Access<StaticTriangleTess> tess(&region->get_static_triangle_tess());
-
-            copy_uv_coordinates(*tess, uv);
-        }
-    }
+    // Maximum number of texels examined when computing the coverage of a triangle.
+    // Triangles covering more texels are assumed to be partially transparent.
+    const size_t MaxCoverageTexelCount = 64 * 64;
 }
 
 IntersectionFilter::IntersectionFilter(
-    Object&                 object,
+    const Object&           object,
     const MaterialArray&    materials,
     TextureCache&           texture_cache)
-  : m_obj_alpha_mask(0)
-  , m_obj_alpha_map_signature(0)
+  : m_obj_alpha_map_signature(0)
+  , m_obj_alpha_mask(0)
 {
     // Initialize the material -> alpha mask mapping.
     m_material_alpha_map_signatures.assign(materials.size(), 0);
     m_material_alpha_masks.assign(materials.size(), 0);
+    m_combined_alpha_masks.assign(materials.size(), 0);
 
     // Create alpha masks.
     update(object, materials, texture_cache);
-
-    if (has_alpha_masks())
-    {
-        // Make a local copy of the object's UV coordinates.
-        m_uv.reserve(get_triangle_count(object) * 3);
-        copy_uv_coordinates(object, m_uv);
-    }
 }
 
 IntersectionFilter::~IntersectionFilter()
@@ -141,20 +87,26 @@ IntersectionFilter::~IntersectionFilter()
 
     for (size_t i = 0; i < m_material_alpha_masks.size(); ++i)
         delete m_material_alpha_masks[i];
+
+    for (size_t i = 0; i < m_combined_alpha_masks.size(); ++i)
+        delete m_combined_alpha_masks[i];
 }
 
 namespace
 {
+    // Delete an object and return true if there was one.
     template <typename T>
-    void delete_and_clear(T*& ptr)
+    bool delete_and_clear(T*& ptr)
     {
+        const bool deleted = ptr != 0;
         delete ptr;
         ptr = 0;
+        return deleted;
     }
 }
 
 template <typename EntityType>
-void IntersectionFilter::do_update(
+bool IntersectionFilter::do_update(
     const EntityType&               entity,
     TextureCache&                   texture_cache,
     IntersectionFilter::AlphaMask*& mask,
@@ -162,8 +114,7 @@ void IntersectionFilter::do_update(
 {
     // Intersection filters would prevent shading fully transparent shading points,
     // so don't create one if shading fully transparent shading points is enabled.
-    if (entity.shade_alpha_cutouts())
-        delete_and_clear(mask);
+    const bool deleted = entity.shade_alpha_cutouts() && delete_and_clear(mask);
 
     // Use the uncached version of get_alpha_map() since at this point
     // on_frame_begin() hasn't been called on the materials, when
@@ -172,15 +123,12 @@ void IntersectionFilter::do_update(
     const Source* alpha_map = entity.get_uncached_alpha_map();
 
     if (alpha_map == 0)
-    {
-        delete_and_clear(mask);
-        return;
-    }
+        return delete_and_clear(mask) || deleted;
 
     // Don't do anything if there is already an alpha mask and it is up-to-date.
     const uint64 alpha_map_sig = alpha_map->compute_signature();
     if (mask != 0 && alpha_map_sig == signature)
-        return;
+        return false;
 
     // Build the alpha mask.
     double transparency;
@@ -192,15 +140,14 @@ void IntersectionFilter::do_update(
 
     // Discard the alpha mask if it's mostly opaque.
     if (transparency < 5.0 / 100)
-    {
-        delete_and_clear(mask);
-        return;
-    }
+        return delete_and_clear(mask) || deleted;
 
     // Store the alpha mask.
     delete mask;
     mask = alpha_mask.release();
     signature = alpha_map_sig;
+
+    return true;
 }
 
 void IntersectionFilter::update(
@@ -211,21 +158,27 @@ void IntersectionFilter::update(
     assert(m_material_alpha_map_signatures.size() == materials.size());
     assert(m_material_alpha_masks.size() == materials.size());
 
-    do_update(object, texture_cache, m_obj_alpha_mask, m_obj_alpha_map_signature);
+    bool changed =
+        do_update(object, texture_cache, m_obj_alpha_mask, m_obj_alpha_map_signature);
 
     for (size_t i = 0; i < materials.size(); ++i)
     {
         if (const Material* material = materials[i])
         {
-            do_update(
-                *material,
-                texture_cache,
-                m_material_alpha_masks[i],
-                m_material_alpha_map_signatures[i]);
+            changed |=
+                do_update(
+                    *material,
+                    texture_cache,
+                    m_material_alpha_masks[i],
+                    m_material_alpha_map_signatures[i]);
         }
         else
-            delete_and_clear(m_material_alpha_masks[i]);
+            changed |= delete_and_clear(m_material_alpha_masks[i]);
     }
+
+    // Rebuild the masks used for lookups if any of the alpha masks changed.
+    if (changed || m_masks.size() != materials.size())
+        update_combined_alpha_masks();
 }
 
 bool IntersectionFilter::has_alpha_masks() const
@@ -255,12 +208,80 @@ size_t IntersectionFilter::get_masks_memory_size() const
             size += m_material_alpha_masks[i]->get_memory_size();
     }
 
+    for (size_t i = 0; i < m_combined_alpha_masks.size(); ++i)
+    {
+        if (m_combined_alpha_masks[i])
+            size += m_combined_alpha_masks[i]->get_memory_size();
+    }
+
     return size;
 }
 
-size_t IntersectionFilter::get_uv_memory_size() const
+IntersectionFilter::Coverage IntersectionFilter::compute_coverage(
+    const size_t            triangle_pa,
+    const Vector2f&         uv0,
+    const Vector2f&         uv1,
+    const Vector2f&         uv2) const
+{
+    assert(triangle_pa < m_masks.size());
+
+    const MaskPair& masks = m_masks[triangle_pa];
+
+    if (masks.m_first == 0)
+        return CoverageOpaque;
+
+    const Coverage first_coverage = compute_coverage(*masks.m_first, uv0, uv1, uv2);
+
+    if (masks.m_second == 0 || first_coverage == CoverageTransparent)
+        return first_coverage;
+
+    const Coverage second_coverage = compute_coverage(*masks.m_second, uv0, uv1, uv2);
+
+    if (second_coverage == CoverageTransparent)
+        return CoverageTransparent;
+
+    return
+        first_coverage == CoverageOpaque && second_coverage == CoverageOpaque
+            ? CoverageOpaque
+            : CoveragePartial;
+}
+
+IntersectionFilter::Coverage IntersectionFilter::compute_coverage(
+    const AlphaMask&        mask,
+    const Vector2f&         uv0,
+    const Vector2f&         uv1,
+    const Vector2f&         uv2)
 {
-    return m_uv.capacity() * sizeof(Vector2f);
+    // Since texture coordinates are clamped during lookups, any point of the triangle
+    // maps to a texel inside the footprint of the triangle's bounding box in texture space.
+    const size_t x0 = mask.get_x(min(uv0[0], min(uv1[0], uv2[0])));
+    const size_t y0 = mask.get_y(min(uv0[1], min(uv1[1], uv2[1])));
+    const size_t x1 = mask.get_x(max(uv0[0], max(uv1[0], uv2[0])));
+    const size_t y1 = mask.get_y(max(uv0[1], max(uv1[1], uv2[1])));
+
+    // Texture coordinates may be indefinite on degenerate geometry.
+    if (!(x0 <= x1 && y0 <= y1))
+        return CoveragePartial;
+
+    // Don't bother examining large footprints.
+    if ((x1 - x0 + 1) * (y1 - y0 + 1) > MaxCoverageTexelCount)
+        return CoveragePartial;
+
+    size_t opaque_texel_count = 0;
+
+    for (size_t y = y0; y <= y1; ++y)
+    {
+        for (size_t x = x0; x <= x1; ++x)
+            opaque_texel_count += mask.is_opaque(x, y) ? 1 : 0;
+    }
+
+    if (opaque_texel_count == 0)
+        return CoverageTransparent;
+
+    return
+        opaque_texel_count == (x1 - x0 + 1) * (y1 - y0 + 1)
+            ? CoverageOpaque
+            : CoveragePartial;
 }
 
 IntersectionFilter::AlphaMask* IntersectionFilter::create_alpha_mask(
@@ -319,4 +340,77 @@ IntersectionFilter::AlphaMask* IntersectionFilter::create_alpha_mask(
     return alpha_mask;
 }
 
+IntersectionFilter::AlphaMask* IntersectionFilter::create_combined_alpha_mask(
+    const AlphaMask&        lhs,
+    const AlphaMask&        rhs)
+{
+    assert(lhs.get_width() == rhs.get_width());
+    assert(lhs.get_height() == rhs.get_height());
+
+    const size_t width = lhs.get_width();
+    const size_t height = lhs.get_height();
+
+    AlphaMask* alpha_mask = new AlphaMask(width, height);
+
+    for (size_t y = 0; y < height; ++y)
+    {
+        for (size_t x = 0; x < width; ++x)
+            alpha_mask->set_opaque(x, y, lhs.is_opaque(x, y) && rhs.is_opaque(x, y));
+    }
+
+    return alpha_mask;
+}
+
+void IntersectionFilter::update_combined_alpha_masks()
+{
+    const size_t material_count = m_material_alpha_masks.size();
+
+    m_masks.resize(material_count);
+
+    for (size_t i = 0; i < material_count; ++i)
+    {
+        delete_and_clear(m_combined_alpha_masks[i]);
+
+        const AlphaMask* obj_mask = m_obj_alpha_mask;
+        const AlphaMask* mtl_mask = m_material_alpha_masks[i];
+        MaskPair& masks = m_masks[i];
+
+        if (obj_mask && mtl_mask &&
+            obj_mask->get_width() == mtl_mask->get_width() &&
+            obj_mask->get_height() == mtl_mask->get_height())
+        {
+            // Both masks have the same resolution: merge them into a single mask.
+            m_combined_alpha_masks[i] = create_combined_alpha_mask(*obj_mask, *mtl_mask);
+            masks.m_first = m_combined_alpha_masks[i];
+            masks.m_second = 0;
+        }
+        else
+        {
+            masks.m_first = obj_mask ? obj_mask : mtl_mask;
+            masks.m_second = obj_mask ? mtl_mask : 0;
+        }
+    }
+}
+
+
+//
+// IntersectionFilterStatistics class implementation.
+//
+
+IntersectionFilterStatistics::IntersectionFilterStatistics()
+  : m_skipped_hit_count(0)
+  , m_tested_hit_count(0)
+  , m_rejected_hit_count(0)
+{
+}
+
+Statistics IntersectionFilterStatistics::get_statistics() const
+{
+    Statistics stats;
+    stats.insert("skipped hits", m_skipped_hit_count);
+    stats.insert("tested hits", m_tested_hit_count);
+    stats.insert("rejected hits", m_rejected_hit_count);
+    return stats;
+}
+
 }   // namespace renderer
@@ -30,9 +30,6 @@
 #ifndef APPLESEED_RENDERER_KERNEL_INTERSECTION_INTERSECTIONFILTER_H
 #define APPLESEED_RENDERER_KERNEL_INTERSECTION_INTERSECTIONFILTER_H
 
-// appleseed.renderer headers.
-#include "renderer/kernel/intersection/trianglekey.h"
-
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/scalar.h"
@@ -46,20 +43,37 @@
 #include <vector>
 
 // Forward declarations.
-namespace renderer  { class MaterialArray; }
-namespace renderer  { class Object; }
-namespace renderer  { class Source; }
-namespace renderer  { class TextureCache; }
+namespace foundation    { class Statistics; }
+namespace renderer      { class MaterialArray; }
+namespace renderer      { class Object; }
+namespace renderer      { class Source; }
+namespace renderer      { class TextureCache; }
 
 namespace renderer
 {
 
+//
+// Filters out intersections with the transparent parts of an object, as defined
+// by the alpha maps of the object and of its materials.
+//
+// The alpha masks of the object and of a given material are merged into a single
+// mask whenever they have the same resolution, so that a single lookup is needed.
+//
+
 class IntersectionFilter
   : public foundation::NonCopyable
 {
   public:
+    // Coverage of a triangle by the alpha masks, in texture space.
+    enum Coverage
+    {
+        CoverageOpaque,                     // all texels covered by the triangle are opaque
+        CoverageTransparent,                // all texels covered by the triangle are transparent
+        CoveragePartial                     // the triangle covers both opaque and transparent texels
+    };
+
     IntersectionFilter(
-        Object&                 object,
+        const Object&           object,
         const MaterialArray&    materials,
         TextureCache&           texture_cache);
 
@@ -73,12 +87,21 @@ class IntersectionFilter
     bool has_alpha_masks() const;
 
     size_t get_masks_memory_size() const;
-    size_t get_uv_memory_size() const;
 
+    // Compute the coverage of the triangle with given texture coordinates
+    // (as returned by the filter's own convention, see below) and material index.
+    Coverage compute_coverage(
+        const size_t                triangle_pa,
+        const foundation::Vector2f& uv0,
+        const foundation::Vector2f& uv1,
+        const foundation::Vector2f& uv2) const;
+
+    // Return true if the point with given texture coordinates on a triangle with
+    // a given material index is opaque. Texture coordinates are expected with the
+    // V axis pointing downward, i.e. (u, 1 - v).
     bool accept(
-        const TriangleKey&      triangle_key,
-        const double            u,
-        const double            v) const;
+        const size_t                triangle_pa,
+        const foundation::Vector2f& uv) const;
 
   private:
     class AlphaMask
@@ -94,6 +117,16 @@ class IntersectionFilter
         {
         }
 
+        size_t get_width() const
+        {
+            return m_bitmask.get_width();
+        }
+
+        size_t get_height() const
+        {
+            return m_bitmask.get_height();
+        }
+
         void set_opaque(
             const size_t        x,
             const size_t        y,
@@ -102,15 +135,16 @@ class IntersectionFilter
             m_bitmask.set(x, y, opaque);
         }
 
-        bool is_opaque(const foundation::Vector2f& uv) const
+        bool is_opaque(
+            const size_t        x,
+            const size_t        y) const
         {
-            const float fx = foundation::clamp(uv[0] * m_bitmask.get_width(), 0.0f, m_max_x);
-            const float fy = foundation::clamp(uv[1] * m_bitmask.get_height(), 0.0f, m_max_y);
-
-            const size_t ix = foundation::truncate<size_t>(fx);
-            const size_t iy = foundation::truncate<size_t>(fy);
+            return m_bitmask.is_set(x, y);
+        }
 
-            return m_bitmask.is_set(ix, iy);
+        bool is_opaque(const foundation::Vector2f& uv) const
+        {
+            return m_bitmask.is_set(get_x(uv[0]), get_y(uv[1]));
         }
 
         bool is_transparent(const foundation::Vector2f& uv) const
@@ -118,6 +152,16 @@ class IntersectionFilter
             return !is_opaque(uv);
         }
 
+        size_t get_x(const float u) const
+        {
+            return foundation::truncate<size_t>(foundation::clamp(u * m_bitmask.get_width(), 0.0f, m_max_x));
+        }
+
+        size_t get_y(const float v) const
+        {
+            return foundation::truncate<size_t>(foundation::clamp(v * m_bitmask.get_height(), 0.0f, m_max_y));
+        }
+
         size_t get_memory_size() const
         {
             return m_bitmask.get_memory_size();
@@ -129,14 +173,23 @@ class IntersectionFilter
         foundation::BitMask2    m_bitmask;
     };
 
+    // Up to two alpha masks that must both be opaque for an intersection to be accepted.
+    struct MaskPair
+    {
+        const AlphaMask*        m_first;
+        const AlphaMask*        m_second;
+    };
+
     foundation::uint64                  m_obj_alpha_map_signature;
     AlphaMask*                          m_obj_alpha_mask;
     std::vector<foundation::uint64>     m_material_alpha_map_signatures;
     std::vector<AlphaMask*>             m_material_alpha_masks;
-    std::vector<foundation::Vector2f>   m_uv;
+    std::vector<AlphaMask*>             m_combined_alpha_masks;
+    std::vector<MaskPair>               m_masks;
 
+    // Return true if the alpha mask was created, updated or deleted.
     template <typename EntityType>
-    static void do_update(
+    static bool do_update(
         const EntityType&               entity,
         TextureCache&                   texture_cache,
         IntersectionFilter::AlphaMask*& mask,
@@ -146,49 +199,56 @@ class IntersectionFilter
         const Source*           alpha_map,
         TextureCache&           texture_cache,
         double&                 transparency);
+
+    static AlphaMask* create_combined_alpha_mask(
+        const AlphaMask&        lhs,
+        const AlphaMask&        rhs);
+
+    void update_combined_alpha_masks();
+
+    static Coverage compute_coverage(
+        const AlphaMask&            mask,
+        const foundation::Vector2f& uv0,
+        const foundation::Vector2f& uv1,
+        const foundation::Vector2f& uv2);
 };
 
 
 //
-// IntersectionFilter class implementation.
+// Intersection filtering statistics, collected per thread.
 //
 
-inline bool IntersectionFilter::accept(
-    const TriangleKey&          triangle_key,
-    const double                u,
-    const double                v) const
+struct IntersectionFilterStatistics
 {
-    assert(triangle_key.get_region_index() == 0);
+    foundation::uint64  m_skipped_hit_count;        // hits on triangles fully covered by opaque texels
+    foundation::uint64  m_tested_hit_count;         // hits tested against alpha masks
+    foundation::uint64  m_rejected_hit_count;       // hits rejected by intersection filters
 
-    // Don't use the alpha mask if the UV coordinates are indefinite.
-    // This can happen in rare circumstances, when hitting degenerate
-    // or nearly degenerate geometry. Since we cannot guarantee to
-    // catch all instances of degenerate geometry before rendering, and
-    // because using the alpha mask in this case would lead to a crash,
-    // we decide in this case to simply revert to the normal code path.
-    if (u != u || v != v)
-        return true;
+    // Constructor.
+    IntersectionFilterStatistics();
 
-    const AlphaMask* mtl_alpha_mask = m_material_alpha_masks[triangle_key.get_triangle_pa()];
+    // Retrieve intersection filtering statistics.
+    foundation::Statistics get_statistics() const;
+};
 
-    if (m_obj_alpha_mask || mtl_alpha_mask)
-    {
-        const size_t triangle_index = triangle_key.get_triangle_index();
 
-        const float fu = static_cast<float>(u);
-        const float fv = static_cast<float>(v);
+//
+// IntersectionFilter class implementation.
+//
+
+inline bool IntersectionFilter::accept(
+    const size_t                    triangle_pa,
+    const foundation::Vector2f&     uv) const
+{
+    assert(triangle_pa < m_masks.size());
 
-        const foundation::Vector2f uv =
-              m_uv[triangle_index * 3 + 0] * (1.0f - fu - fv)
-            + m_uv[triangle_index * 3 + 1] * fu
-            + m_uv[triangle_index * 3 + 2] * fv;
+    const MaskPair& masks = m_masks[triangle_pa];
 
-        if (m_obj_alpha_mask && m_obj_alpha_mask->is_transparent(uv))
-            return false;
+    if (masks.m_first && masks.m_first->is_transparent(uv))
+        return false;
 
-        if (mtl_alpha_mask)
-            return mtl_alpha_mask->is_opaque(uv);
-    }
+    if (masks.m_second && masks.m_second->is_transparent(uv))
+        return false;
 
     return true;
 }
@@ -274,10 +274,9 @@ bool Intersector::trace(
     AssemblyLeafVisitor visitor(
         shading_point,
         assembly_tree,
-        m_region_tree_cache,
         m_triangle_tree_cache,
-        m_curve_tree_cache,
-        parent_shading_point
+        parent_shading_point,
+        m_filter_stats
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
         , m_triangle_tree_traversal_stats
 #endif
@@ -325,9 +324,7 @@ bool Intersector::trace_probe(
     AssemblyTreeProbeIntersector intersector;
     AssemblyLeafProbeVisitor visitor(
         assembly_tree,
-        m_region_tree_cache,
         m_triangle_tree_cache,
-        m_curve_tree_cache,
         parent_shading_point
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
         , m_triangle_tree_traversal_stats
@@ -380,6 +377,7 @@ void Intersector::manufacture_hit(
     shading_point.m_region_index = region_index;
     shading_point.m_primitive_index = primitive_index;
     shading_point.m_triangle_support_plane = triangle_support_plane;
+    shading_point.m_proxy_level = 0;
 
     // Available on-demand results: none.
     shading_point.m_members = 0;
@@ -446,6 +444,7 @@ StatisticsVector Intersector::get_statistics() const
     StatisticsVector vec;
 
     vec.insert("intersection statistics", intersection_stats);
+    vec.insert("intersection filter statistics", m_filter_stats.get_statistics());
 
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
     vec.insert(
@@ -457,10 +456,6 @@ StatisticsVector Intersector::get_statistics() const
         m_triangle_tree_traversal_stats.get_statistics());
 #endif
 
-    vec.insert(
-        "region tree access cache statistics",
-        make_dual_stage_cache_stats(m_region_tree_cache));
-
     vec.insert(
         "triangle tree access cache statistics",
         make_dual_stage_cache_stats(m_triangle_tree_cache));
@@ -520,7 +520,7 @@ double RegionLeafVisitor::visit(
     {
         // Check the intersection between the ray and the triangle tree.
         TriangleTreeIntersector intersector;
-        TriangleLeafVisitor visitor(*triangle_tree, m_shading_point);
+        TriangleLeafVisitor visitor(*triangle_tree, m_shading_point, m_filter_stats);
         if (triangle_tree->get_moving_triangle_count() > 0)
         {
             intersector.intersect_motion(
@@ -175,7 +175,8 @@ class RegionLeafVisitor
     // Constructor.
     RegionLeafVisitor(
         ShadingPoint&                           shading_point,
-        TriangleTreeAccessCache&                triangle_tree_cache
+        TriangleTreeAccessCache&                triangle_tree_cache,
+        IntersectionFilterStatistics&           filter_stats
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
         , foundation::bvh::TraversalStatistics& triangle_tree_stats
 #endif
@@ -190,6 +191,7 @@ class RegionLeafVisitor
   private:
     ShadingPoint&                               m_shading_point;
     TriangleTreeAccessCache&                    m_triangle_tree_cache;
+    IntersectionFilterStatistics&               m_filter_stats;
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
     foundation::bvh::TraversalStatistics&       m_triangle_tree_stats;
 #endif
@@ -275,13 +277,15 @@ inline foundation::UniqueID RegionLeaf::get_triangle_tree_uid() const
 
 inline RegionLeafVisitor::RegionLeafVisitor(
     ShadingPoint&                               shading_point,
-    TriangleTreeAccessCache&                    triangle_tree_cache
+    TriangleTreeAccessCache&                    triangle_tree_cache,
+    IntersectionFilterStatistics&               filter_stats
   #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
     , foundation::bvh::TraversalStatistics&     triangle_tree_stats
 #endif
     )
   : m_shading_point(shading_point)
   , m_triangle_tree_cache(triangle_tree_cache)
+  , m_filter_stats(filter_stats)
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
   , m_triangle_tree_stats(triangle_tree_stats)
 #endif
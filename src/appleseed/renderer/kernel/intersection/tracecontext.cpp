@@ -37,6 +37,7 @@
 #include "renderer/kernel/intersection/regioninfo.h"
 #include "renderer/kernel/intersection/trianglekey.h"
 #include "renderer/kernel/intersection/triangletree.h"
+#include "renderer/kernel/intersection/triangletreestore.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/shadingray.h"
 #include "renderer/kernel/shading/shadingresult.h"
@@ -57,10 +58,17 @@ namespace renderer
 // TraceContext class implementation.
 //
 
-TraceContext::TraceContext(const Scene& scene)
+TraceContext::TraceContext(
+    const Scene&        scene,
+    const ParamArray&   triangle_tree_store_params,
+    const size_t        thread_count)
   : m_scene(scene)
-  , m_assembly_tree(new AssemblyTree(scene))
+  , m_triangle_tree_store(new TriangleTreeStore())
 {
+    // The store must be configured before the assembly tree builds the child trees.
+    m_triangle_tree_store->configure(triangle_tree_store_params);
+    m_assembly_tree = new AssemblyTree(scene, *m_triangle_tree_store, thread_count);
+
     RENDERER_LOG_DEBUG(
         "data structures size:\n"
         "  bvh::NodeType                 %s\n"
@@ -82,11 +90,15 @@ TraceContext::TraceContext(const Scene& scene)
 TraceContext::~TraceContext()
 {
     delete m_assembly_tree;
+    delete m_triangle_tree_store;
 }
 
-void TraceContext::update()
+void TraceContext::update(
+    const ParamArray&   triangle_tree_store_params,
+    const size_t        thread_count)
 {
-    m_assembly_tree->update();
+    m_triangle_tree_store->configure(triangle_tree_store_params);
+    m_assembly_tree->update(thread_count);
 }
 
 }   // namespace renderer
@@ -30,15 +30,22 @@
 #ifndef APPLESEED_RENDERER_KERNEL_INTERSECTION_TRACECONTEXT_H
 #define APPLESEED_RENDERER_KERNEL_INTERSECTION_TRACECONTEXT_H
 
+// appleseed.renderer headers.
+#include "renderer/utility/paramarray.h"
+
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
 
+// Standard headers.
+#include <cstddef>
+
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
 // Forward declarations.
 namespace renderer  { class AssemblyTree; }
 namespace renderer  { class Scene; }
+namespace renderer  { class TriangleTreeStore; }
 
 namespace renderer
 {
@@ -54,8 +61,14 @@ class APPLESEED_DLLSYMBOL TraceContext
   : public foundation::NonCopyable
 {
   public:
-    // Constructor, initializes the trace context for a given scene.
-    explicit TraceContext(const Scene& scene);
+    // Constructor, initializes the trace context for a given scene. The parameters are
+    // those of the triangle tree store (see TriangleTreeStore::get_params_metadata()).
+    // A thread count of 0 builds the acceleration structures with one thread per logical
+    // CPU core.
+    explicit TraceContext(
+        const Scene&        scene,
+        const ParamArray&   triangle_tree_store_params = ParamArray(),
+        const size_t        thread_count = 0);
 
     // Destructor.
     ~TraceContext();
@@ -66,12 +79,18 @@ class APPLESEED_DLLSYMBOL TraceContext
     // Get the assembly tree.
     const AssemblyTree& get_assembly_tree() const;
 
-    // Synchronize the trace context with the scene.
-    void update();
+    // Get the triangle tree store.
+    const TriangleTreeStore& get_triangle_tree_store() const;
+
+    // Synchronize the trace context with the scene, with new triangle tree store parameters.
+    void update(
+        const ParamArray&   triangle_tree_store_params = ParamArray(),
+        const size_t        thread_count = 0);
 
   private:
-    const Scene&    m_scene;
-    AssemblyTree*   m_assembly_tree;
+    const Scene&        m_scene;
+    TriangleTreeStore*  m_triangle_tree_store;
+    AssemblyTree*       m_assembly_tree;
 };
 
 
@@ -89,6 +108,11 @@ inline const AssemblyTree& TraceContext::get_assembly_tree() const
     return *m_assembly_tree;
 }
 
+inline const TriangleTreeStore& TraceContext::get_triangle_tree_store() const
+{
+    return *m_triangle_tree_store;
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_KERNEL_INTERSECTION_TRACECONTEXT_H
@@ -62,6 +62,9 @@ class TreeRepository
     LazyTreeType* acquire(const foundation::uint64 key);
     void release(LazyTreeType* tree);
 
+    // Return the number of references to a tree.
+    size_t get_ref_count(LazyTreeType* tree) const;
+
     template <typename Func>
     void for_each(Func& func);
 
@@ -136,6 +139,18 @@ void TreeRepository<TreeType>::release(LazyTreeType* tree)
     }
 }
 
+template <typename TreeType>
+size_t TreeRepository<TreeType>::get_ref_count(LazyTreeType* tree) const
+{
+    const typename TreeIndex::const_iterator i = m_index.find(tree);
+    assert(i != m_index.end());
+
+    const typename TreeContainer::const_iterator t = m_trees.find(i->second);
+    assert(t != m_trees.end());
+
+    return t->second.m_ref;
+}
+
 template <typename TreeType>
 template <typename Func>
 void TreeRepository<TreeType>::for_each(Func& func)
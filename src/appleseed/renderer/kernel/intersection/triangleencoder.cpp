@@ -48,7 +48,8 @@ size_t TriangleEncoder::compute_size(
     const vector<TriangleVertexInfo>&   triangle_vertex_infos,
     const vector<size_t>&               triangle_indices,
     const size_t                        item_begin,
-    const size_t                        item_count)
+    const size_t                        item_count,
+    const bool                          indexed)
 {
     size_t size = 0;
 
@@ -61,7 +62,7 @@ size_t TriangleEncoder::compute_size(
         size += sizeof(uint32);         // motion segment count
 
         if (vertex_info.m_motion_segment_count == 0)
-            size += sizeof(GTriangleType);
+            size += indexed ? 3 * sizeof(uint32) : sizeof(GTriangleType);
         else size += (vertex_info.m_motion_segment_count + 1) * 3 * sizeof(GVector3);
     }
 
@@ -71,6 +72,7 @@ size_t TriangleEncoder::compute_size(
 void TriangleEncoder::encode(
     const vector<TriangleVertexInfo>&   triangle_vertex_infos,
     const vector<GVector3>&             triangle_vertices,
+    const vector<uint32>*               shared_vertex_indices,
     const vector<size_t>&               triangle_indices,
     const size_t                        item_begin,
     const size_t                        item_count,
@@ -84,7 +86,13 @@ void TriangleEncoder::encode(
         writer.write(vertex_info.m_vis_flags);
         writer.write(static_cast<uint32>(vertex_info.m_motion_segment_count));
 
-        if (vertex_info.m_motion_segment_count == 0)
+        if (vertex_info.m_motion_segment_count == 0 && shared_vertex_indices)
+        {
+            writer.write(
+                &(*shared_vertex_indices)[triangle_index * 3],
+                3 * sizeof(uint32));
+        }
+        else if (vertex_info.m_motion_segment_count == 0)
         {
             writer.write(
                 GTriangleType(
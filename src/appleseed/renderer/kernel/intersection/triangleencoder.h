@@ -33,6 +33,9 @@
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
 
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
 // Standard headers.
 #include <cstddef>
 #include <vector>
@@ -44,6 +47,13 @@ namespace renderer      { class TriangleVertexInfo; }
 namespace renderer
 {
 
+//
+// Each triangle is encoded as its visibility flags and its number of motion segments,
+// followed by its vertices. Static triangles may instead be encoded as the indices of
+// their three vertices in a vertex array shared by the whole tree: in that case, the
+// shared_vertex_indices argument holds three indices per triangle.
+//
+
 class TriangleEncoder
 {
   public:
@@ -51,11 +61,13 @@ class TriangleEncoder
         const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
         const std::vector<size_t>&              triangle_indices,
         const size_t                            item_begin,
-        const size_t                            item_count);
+        const size_t                            item_count,
+        const bool                              indexed);
 
     static void encode(
         const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
         const std::vector<GVector3>&            triangle_vertices,
+        const std::vector<foundation::uint32>*  shared_vertex_indices,
         const std::vector<size_t>&              triangle_indices,
         const size_t                            item_begin,
         const size_t                            item_count,
@@ -32,9 +32,11 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/intersection/bvhcache.h"
 #include "renderer/kernel/intersection/intersectionfilter.h"
 #include "renderer/kernel/intersection/triangleencoder.h"
 #include "renderer/kernel/intersection/triangleitemhandler.h"
+#include "renderer/kernel/intersection/triangletreestore.h"
 #include "renderer/kernel/intersection/trianglevertexinfo.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/shadingray.h"
@@ -57,6 +59,7 @@
 // appleseed.foundation headers.
 #include "foundation/math/area.h"
 #include "foundation/math/intersection/aabbtriangle.h"
+#include "foundation/math/matrix.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/transform.h"
 #include "foundation/math/treeoptimizer.h"
@@ -65,18 +68,27 @@
 #include "foundation/platform/timers.h"
 #include "foundation/utility/alignedallocator.h"
 #include "foundation/utility/api/apistring.h"
+#include "foundation/utility/bufferedfile.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/makevector.h"
 #include "foundation/utility/memory.h"
+#include "foundation/utility/otherwise.h"
+#include "foundation/utility/siphash.h"
 #include "foundation/utility/statistics.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
+// Boost headers.
+#include "boost/unordered/unordered_map.hpp"
+
 // Standard headers.
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -317,6 +329,345 @@ namespace
         }
     }
 
+    //
+    // Mesh simplification by vertex clustering (Rossignac and Borrel), with Lindstrom's
+    // quadric-based placement of the representative vertices:
+    //
+    //   - the bounding box of the tree is divided into a uniform grid of cubic cells
+    //   - all the vertices falling into a cell are merged into a single vertex, placed
+    //     where it minimizes the sum of the squared distances to the planes of the
+    //     triangles touching the cell (or at the mean of the vertices when this point
+    //     lies too far away from the cell)
+    //   - triangles whose vertices end up in fewer than three cells are dropped, as
+    //     well as triangles duplicating another triangle
+    //
+    // Simplified triangles keep the key of one of their source triangles, so that
+    // hits on the simplified geometry are shaded using the source geometry.
+    //
+
+    class VertexClustering
+      : public NonCopyable
+    {
+      public:
+        VertexClustering(
+            const GAABB3&                   bbox,
+            const GScalar                   cell_size)
+          : m_origin(bbox.min)
+          , m_rcp_cell_size(cell_size > GScalar(0.0) ? 1.0 / cell_size : 0.0)
+          , m_cell_size(cell_size)
+        {
+        }
+
+        void insert_triangles(
+            const GAABB3&                   tree_bbox,
+            const RegionInfo&               region_info,
+            const ObjectInstance&           object_instance,
+            const StaticTriangleTess&       tess)
+        {
+            const Transformd& transform = object_instance.get_transform();
+            const size_t triangle_count = tess.m_primitives.size();
+
+            for (size_t i = 0; i < triangle_count; ++i)
+            {
+                // Fetch the triangle.
+                const Triangle& triangle = tess.m_primitives[i];
+
+                // Transform triangle vertices to assembly space.
+                const GVector3 v[3] =
+                {
+                    transform.point_to_parent(tess.m_vertices[triangle.m_v0]),
+                    transform.point_to_parent(tess.m_vertices[triangle.m_v1]),
+                    transform.point_to_parent(tess.m_vertices[triangle.m_v2])
+                };
+
+                // Ignore degenerate triangles.
+                if (square_area(v[0], v[1], v[2]) == GScalar(0.0))
+                    continue;
+
+                // Ignore triangles that don't intersect the tree.
+                if (!intersect(tree_bbox, v[0], v[1], v[2]))
+                    continue;
+
+                // Compute the plane of the triangle, weighted by its area.
+                const Vector3d p0(v[0]), p1(v[1]), p2(v[2]);
+                const Vector3d n = cross(p1 - p0, p2 - p0);
+                const double n_norm = norm(n);
+                if (n_norm == 0.0)
+                    continue;
+                const Vector3d unit_n = n / n_norm;
+                const double d = -dot(unit_n, p0);
+                const double weight = 0.5 * n_norm;
+
+                ClusteredTriangle clustered_triangle;
+                clustered_triangle.m_key =
+                    TriangleKey(
+                        region_info.get_object_instance_index(),
+                        region_info.get_region_index(),
+                        i,
+                        triangle.m_pa);
+                clustered_triangle.m_vis_flags = object_instance.get_vis_flags();
+
+                for (size_t j = 0; j < 3; ++j)
+                {
+                    const uint64 cell = compute_cell(v[j]);
+                    clustered_triangle.m_cells[j] = cell;
+
+                    Cluster& cluster = m_clusters[cell];
+                    cluster.m_vertex_sum += Vector3d(v[j]);
+                    cluster.m_vertex_count += 1;
+
+                    // Add the plane of the triangle once to each of the cells it touches.
+                    if ((j < 1 || cell != clustered_triangle.m_cells[0]) &&
+                        (j < 2 || cell != clustered_triangle.m_cells[1]))
+                        cluster.add_plane(unit_n, d, weight);
+                }
+
+                // Only keep triangles that don't collapse.
+                if (clustered_triangle.m_cells[0] != clustered_triangle.m_cells[1] &&
+                    clustered_triangle.m_cells[1] != clustered_triangle.m_cells[2] &&
+                    clustered_triangle.m_cells[2] != clustered_triangle.m_cells[0])
+                    m_triangles.push_back(clustered_triangle);
+            }
+        }
+
+        template <typename AABBType>
+        void collect_triangles(
+            const GAABB3&                   tree_bbox,
+            vector<TriangleKey>*            triangle_keys,
+            vector<TriangleVertexInfo>*     triangle_vertex_infos,
+            vector<GVector3>*               triangle_vertices,
+            vector<AABBType>*               triangle_bboxes,
+            size_t&                         triangle_vertex_count)
+        {
+            compute_cluster_vertices(tree_bbox);
+
+            const vector<bool> duplicates = find_duplicate_triangles();
+
+            for (size_t i = 0; i < m_triangles.size(); ++i)
+            {
+                if (duplicates[i])
+                    continue;
+
+                const ClusteredTriangle& triangle = m_triangles[i];
+
+                const GVector3& v0 = m_clusters[triangle.m_cells[0]].m_vertex;
+                const GVector3& v1 = m_clusters[triangle.m_cells[1]].m_vertex;
+                const GVector3& v2 = m_clusters[triangle.m_cells[2]].m_vertex;
+
+                // Ignore triangles that became degenerate.
+                if (square_area(v0, v1, v2) == GScalar(0.0))
+                    continue;
+
+                // Store the triangle key.
+                if (triangle_keys)
+                    triangle_keys->push_back(triangle.m_key);
+
+                // Store the index of the first triangle vertex and the number of motion segments.
+                if (triangle_vertex_infos)
+                {
+                    triangle_vertex_infos->push_back(
+                        TriangleVertexInfo(
+                            triangle_vertex_count,
+                            0,
+                            triangle.m_vis_flags));
+                }
+
+                // Store the triangle vertices.
+                if (triangle_vertices)
+                {
+                    triangle_vertices->push_back(v0);
+                    triangle_vertices->push_back(v1);
+                    triangle_vertices->push_back(v2);
+                }
+                triangle_vertex_count += 3;
+
+                // Store the triangle bounding box.
+                if (triangle_bboxes)
+                {
+                    GAABB3 triangle_bbox;
+                    triangle_bbox.invalidate();
+                    triangle_bbox.insert(v0);
+                    triangle_bbox.insert(v1);
+                    triangle_bbox.insert(v2);
+                    triangle_bboxes->push_back(AABBType(triangle_bbox));
+                }
+            }
+        }
+
+      private:
+        struct Cluster
+        {
+            // Quadric error function: sum of w * (dot(n, x) + d)^2, stored as
+            // the symmetric matrix sum of w * n * n^T and the vector sum of w * d * n.
+            Vector3d            m_a[3];
+            Vector3d            m_b;
+            Vector3d            m_vertex_sum;
+            size_t              m_vertex_count;
+            GVector3            m_vertex;
+
+            Cluster()
+              : m_b(0.0)
+              , m_vertex_sum(0.0)
+              , m_vertex_count(0)
+            {
+                m_a[0] = m_a[1] = m_a[2] = Vector3d(0.0);
+            }
+
+            void add_plane(const Vector3d& n, const double d, const double weight)
+            {
+                m_a[0] += (weight * n[0]) * n;
+                m_a[1] += (weight * n[1]) * n;
+                m_a[2] += (weight * n[2]) * n;
+                m_b += (weight * d) * n;
+            }
+        };
+
+        struct ClusteredTriangle
+        {
+            uint64                  m_cells[3];
+            TriangleKey             m_key;
+            uint32                  m_vis_flags;
+        };
+
+        typedef boost::unordered_map<uint64, Cluster> ClusterMap;
+
+        const GVector3              m_origin;
+        const double                m_rcp_cell_size;
+        const double                m_cell_size;
+        ClusterMap                  m_clusters;
+        vector<ClusteredTriangle>   m_triangles;
+
+        uint64 compute_cell(const GVector3& v) const
+        {
+            const uint64 MaxCoordinate = (uint64(1) << 21) - 1;
+
+            uint64 cell = 0;
+
+            for (size_t i = 0; i < 3; ++i)
+            {
+                const double x = floor((v[i] - m_origin[i]) * m_rcp_cell_size);
+                const uint64 c = static_cast<uint64>(clamp(x, 0.0, static_cast<double>(MaxCoordinate)));
+                cell |= c << (21 * i);
+            }
+
+            return cell;
+        }
+
+        GAABB3 compute_cell_bbox(const uint64 cell) const
+        {
+            const uint64 Mask = (uint64(1) << 21) - 1;
+
+            GAABB3 bbox;
+
+            for (size_t i = 0; i < 3; ++i)
+            {
+                const double c = static_cast<double>((cell >> (21 * i)) & Mask);
+                bbox.min[i] = static_cast<GScalar>(m_origin[i] + c * m_cell_size);
+                bbox.max[i] = static_cast<GScalar>(m_origin[i] + (c + 1.0) * m_cell_size);
+            }
+
+            return bbox;
+        }
+
+        static Vector3d minimize_quadric(const Cluster& cluster, const Vector3d& x0)
+        {
+            const double trace = cluster.m_a[0][0] + cluster.m_a[1][1] + cluster.m_a[2][2];
+
+            Vector3d x = x0;
+            Vector3d r = -(multiply(cluster, x) + cluster.m_b);
+            Vector3d p = r;
+            double rr = dot(r, r);
+
+            for (size_t i = 0; i < 3 && rr > 0.0; ++i)
+            {
+                const Vector3d ap = multiply(cluster, p);
+                const double pap = dot(p, ap);
+
+                if (pap <= 1.0e-12 * trace * dot(p, p))
+                    break;
+
+                const double alpha = rr / pap;
+                x += alpha * p;
+                r -= alpha * ap;
+
+                const double new_rr = dot(r, r);
+                p = r + (new_rr / rr) * p;
+                rr = new_rr;
+            }
+
+            return x;
+        }
+
+        static Vector3d multiply(const Cluster& cluster, const Vector3d& v)
+        {
+            return
+                Vector3d(
+                    dot(cluster.m_a[0], v),
+                    dot(cluster.m_a[1], v),
+                    dot(cluster.m_a[2], v));
+        }
+
+        void compute_cluster_vertices(const GAABB3& tree_bbox)
+        {
+            for (ClusterMap::iterator i = m_clusters.begin(), e = m_clusters.end(); i != e; ++i)
+            {
+                Cluster& cluster = i->second;
+
+                const Vector3d mean = cluster.m_vertex_sum / static_cast<double>(cluster.m_vertex_count);
+                Vector3d vertex = mean;
+
+                // Minimize the quadric error function by solving A x = -b with conjugate gradients,
+                // starting from the mean of the vertices. A is only positive semidefinite (it's
+                // singular when the planes meeting in the cell don't define a corner), in which
+                // case this converges to the minimizer closest to the mean.
+                const Vector3d x = minimize_quadric(cluster, mean);
+
+                // Only use the minimizer when it stays close to the cell.
+                GAABB3 cell_bbox = compute_cell_bbox(i->first);
+                cell_bbox.grow(GVector3(static_cast<GScalar>(0.5 * m_cell_size)));
+                if (cell_bbox.contains(GVector3(x)))
+                    vertex = x;
+
+                // Keep the simplified geometry inside the bounding box of the tree.
+                for (size_t j = 0; j < 3; ++j)
+                    cluster.m_vertex[j] = clamp(static_cast<GScalar>(vertex[j]), tree_bbox.min[j], tree_bbox.max[j]);
+            }
+        }
+
+        // Return, for each clustered triangle, whether it uses the same cells as a previous one.
+        vector<bool> find_duplicate_triangles() const
+        {
+            typedef pair<pair<uint64, uint64>, pair<uint64, size_t>> SortKey;
+
+            vector<SortKey> keys(m_triangles.size());
+
+            for (size_t i = 0; i < m_triangles.size(); ++i)
+            {
+                uint64 cells[3] =
+                {
+                    m_triangles[i].m_cells[0],
+                    m_triangles[i].m_cells[1],
+                    m_triangles[i].m_cells[2]
+                };
+                sort(cells, cells + 3);
+                keys[i] = make_pair(make_pair(cells[0], cells[1]), make_pair(cells[2], i));
+            }
+
+            sort(keys.begin(), keys.end());
+
+            vector<bool> duplicates(m_triangles.size(), false);
+
+            for (size_t i = 1; i < keys.size(); ++i)
+            {
+                if (keys[i].first == keys[i - 1].first &&
+                    keys[i].second.first == keys[i - 1].second.first)
+                    duplicates[keys[i].second.second] = true;
+            }
+
+            return duplicates;
+        }
+    };
+
     template <typename AABBType>
     void collect_triangles(
         const TriangleTree::Arguments&  arguments,
@@ -334,6 +685,10 @@ namespace
 
         size_t triangle_vertex_count = 0;
 
+        // Static triangles are simplified when building a proxy tree.
+        const bool simplify = arguments.m_simplification_cell_size > GScalar(0.0);
+        VertexClustering clustering(arguments.m_bbox, arguments.m_simplification_cell_size);
+
         const size_t region_count = arguments.m_regions.size();
 
         for (size_t i = 0; i < region_count; ++i)
@@ -375,6 +730,14 @@ namespace
                     triangle_bboxes,
                     triangle_vertex_count);
             }
+            else if (simplify)
+            {
+                clustering.insert_triangles(
+                    arguments.m_bbox,
+                    region_info,
+                    *object_instance,
+                    tess.ref());
+            }
             else
             {
                 collect_static_triangles(
@@ -390,6 +753,92 @@ namespace
                     triangle_vertex_count);
             }
         }
+
+        if (simplify)
+        {
+            clustering.collect_triangles(
+                arguments.m_bbox,
+                triangle_keys,
+                triangle_vertex_infos,
+                triangle_vertices,
+                triangle_bboxes,
+                triangle_vertex_count);
+        }
+    }
+
+    // Compute the key of a triangle tree in the BVH cache. The key covers everything
+    // the tree depends on: the geometry of its regions, the transforms and visibility
+    // flags of their object instances, the bounding box of the tree, the construction
+    // parameters and the layout of the stored data.
+    uint64 compute_cache_key(
+        const TriangleTree::Arguments&  arguments,
+        const string&                   algorithm,
+        const double                    time,
+        const bool                      indexed,
+        const ParamArray&               params)
+    {
+        uint64 key = siphash24(algorithm.c_str(), algorithm.size());
+
+        key = siphash24(key, siphash24(time));
+        key = siphash24(key, indexed ? 1 : 0);
+        key = siphash24(key, siphash24(params.get_optional<size_t>("max_leaf_size", TriangleTreeDefaultMaxLeafSize)));
+        key = siphash24(key, siphash24(params.get_optional<size_t>("bin_count", TriangleTreeDefaultBinCount)));
+        key = siphash24(key, siphash24(params.get_optional<GScalar>("interior_node_traversal_cost", TriangleTreeDefaultInteriorNodeTraversalCost)));
+        key = siphash24(key, siphash24(params.get_optional<GScalar>("triangle_intersection_cost", TriangleTreeDefaultTriangleIntersectionCost)));
+
+        key = siphash24(key, sizeof(TriangleTree::NodeType));
+        key = siphash24(key, sizeof(TriangleKey));
+        key = siphash24(key, sizeof(GScalar));
+
+        key = siphash24(key, siphash24(arguments.m_bbox));
+        key = siphash24(key, siphash24(arguments.m_simplification_cell_size));
+
+        for (size_t i = 0; i < arguments.m_regions.size(); ++i)
+        {
+            const RegionInfo& region_info = arguments.m_regions[i];
+
+            const ObjectInstance* object_instance =
+                arguments.m_assembly.object_instances().get_by_index(
+                    region_info.get_object_instance_index());
+            assert(object_instance);
+
+            key = siphash24(key, region_info.get_object_instance_index());
+            key = siphash24(key, region_info.get_region_index());
+            key = siphash24(key, siphash24(object_instance->get_vis_flags()));
+
+            const Matrix4d& local_to_parent = object_instance->get_transform().get_local_to_parent();
+            key = siphash24(key, siphash24(&local_to_parent[0], 16 * sizeof(double)));
+
+            Access<RegionKit> region_kit(&object_instance->get_object().get_region_kit());
+            const IRegion* region = (*region_kit)[region_info.get_region_index()];
+            Access<StaticTriangleTess> tess(&region->get_static_triangle_tess());
+
+            if (!tess->m_vertices.empty())
+                key = siphash24(key, siphash24(&tess->m_vertices[0], tess->m_vertices.size() * sizeof(GVector3)));
+
+            if (!tess->m_primitives.empty())
+                key = siphash24(key, siphash24(&tess->m_primitives[0], tess->m_primitives.size() * sizeof(Triangle)));
+
+            const size_t motion_segment_count = tess->get_motion_segment_count();
+            key = siphash24(key, motion_segment_count);
+
+            if (motion_segment_count > 0)
+            {
+                vector<GVector3> poses;
+                poses.reserve(tess->m_vertices.size() * motion_segment_count);
+
+                for (size_t v = 0; v < tess->m_vertices.size(); ++v)
+                {
+                    for (size_t m = 0; m < motion_segment_count; ++m)
+                        poses.push_back(tess->get_vertex_pose(v, m));
+                }
+
+                if (!poses.empty())
+                    key = siphash24(key, siphash24(&poses[0], poses.size() * sizeof(GVector3)));
+            }
+        }
+
+        return key;
     }
 }
 
@@ -398,12 +847,14 @@ TriangleTree::Arguments::Arguments(
     const UniqueID          triangle_tree_uid,
     const GAABB3&           bbox,
     const Assembly&         assembly,
-    const RegionInfoVector& regions)
+    const RegionInfoVector& regions,
+    const GScalar           simplification_cell_size)
   : m_scene(scene)
   , m_triangle_tree_uid(triangle_tree_uid)
   , m_bbox(bbox)
   , m_assembly(assembly)
   , m_regions(regions)
+  , m_simplification_cell_size(simplification_cell_size)
 {
 }
 
@@ -418,25 +869,50 @@ TriangleTree::TriangleTree(const Arguments& arguments)
     const string algorithm = params.get_optional<string>("algorithm", "bvh", make_vector("bvh", "sbvh"), message_context);
     const double time = params.get_optional<double>("time", 0.5);
     const bool save_memory = params.get_optional<bool>("save_temporary_memory", false);
+    const bool indexed =
+        params.get_optional<string>(
+            "triangle_encoding",
+            "vertices",
+            make_vector("vertices", "indices"),
+            message_context) == "indices";
 
     // Start stopwatch.
     Stopwatch<DefaultWallclockTimer> stopwatch;
     stopwatch.start();
 
-    // Build the tree.
     Statistics statistics;
-    if (algorithm == "bvh")
-        build_bvh(params, time, save_memory, statistics);
-    else build_sbvh(params, time, save_memory, statistics);
+
+    // Try to load the tree from the BVH cache.
+    const bool use_cache = BVHCache::is_enabled();
+    const uint64 cache_key = use_cache ? compute_cache_key(m_arguments, algorithm, time, indexed, params) : 0;
+
+    if (use_cache && load_from_cache(cache_key))
+        statistics.insert("bvh cache", "hit");
+    else
+    {
+        // Build the tree.
+        if (algorithm == "bvh")
+            build_bvh(params, time, save_memory, indexed, statistics);
+        else build_sbvh(params, time, save_memory, indexed, statistics);
 
 #ifdef RENDERER_TRIANGLE_TREE_REORDER_NODES
-    // Optimize the tree layout in memory.
-    TreeOptimizer<NodeVectorType> tree_optimizer(m_nodes);
-    tree_optimizer.optimize_node_layout(TriangleTreeSubtreeDepth);
-    assert(m_nodes.size() == m_nodes.capacity());
+        // Optimize the tree layout in memory.
+        TreeOptimizer<NodeVectorType> tree_optimizer(m_nodes);
+        tree_optimizer.optimize_node_layout(TriangleTreeSubtreeDepth);
+        assert(m_nodes.size() == m_nodes.capacity());
 #endif
 
+        // Store the tree into the BVH cache.
+        if (use_cache)
+        {
+            store_to_cache(cache_key);
+            statistics.insert("bvh cache", "miss");
+        }
+    }
+
     // Print triangle tree statistics.
+    if (m_arguments.m_simplification_cell_size > GScalar(0.0))
+        statistics.insert("simplification cell size", m_arguments.m_simplification_cell_size);
     statistics.insert_size("nodes alignment", alignment(&m_nodes[0]));
     statistics.insert_time("total time", stopwatch.measure().get_seconds());
     RENDERER_LOG_DEBUG("%s",
@@ -462,6 +938,76 @@ void TriangleTree::update_non_geometry(const bool enable_intersection_filters)
     else delete_intersection_filters();
 }
 
+bool TriangleTree::load_from_cache(const uint64 key)
+{
+    BufferedFile file;
+    uint64 file_size;
+
+    if (!BVHCache::open_for_reading(key, file, file_size))
+        return false;
+
+    RENDERER_LOG_INFO(
+        "loading triangle tree #" FMT_UNIQUE_ID " for assembly \"%s\" from the bvh cache...",
+        m_arguments.m_triangle_tree_uid,
+        m_arguments.m_assembly.get_path().c_str());
+
+    uint64 static_triangle_count, moving_triangle_count;
+
+    const bool success =
+        BVHCache::read_item(file, static_triangle_count) &&
+        BVHCache::read_item(file, moving_triangle_count) &&
+        BVHCache::read_vector(file, file_size, m_nodes) &&
+        BVHCache::read_vector(file, file_size, m_node_bboxes) &&
+        BVHCache::read_vector(file, file_size, m_triangle_keys) &&
+        BVHCache::read_vector(file, file_size, m_leaf_data) &&
+        BVHCache::read_vector(file, file_size, m_vertices) &&
+        !m_nodes.empty();
+
+    file.close();
+
+    if (!success)
+    {
+        RENDERER_LOG_WARNING(
+            "invalid bvh cache file for triangle tree #" FMT_UNIQUE_ID ", rebuilding the tree.",
+            m_arguments.m_triangle_tree_uid);
+
+        BVHCache::report_invalid_file(key);
+
+        m_nodes.clear();
+        m_node_bboxes.clear();
+        m_triangle_keys.clear();
+        m_leaf_data.clear();
+        m_vertices.clear();
+
+        return false;
+    }
+
+    m_static_triangle_count = static_cast<size_t>(static_triangle_count);
+    m_moving_triangle_count = static_cast<size_t>(moving_triangle_count);
+
+    return true;
+}
+
+void TriangleTree::store_to_cache(const uint64 key) const
+{
+    BufferedFile file;
+    string temp_path;
+
+    if (!BVHCache::open_for_writing(key, file, temp_path))
+        return;
+
+    const bool success =
+        BVHCache::write_item(file, static_cast<uint64>(m_static_triangle_count)) &&
+        BVHCache::write_item(file, static_cast<uint64>(m_moving_triangle_count)) &&
+        BVHCache::write_vector(file, m_nodes) &&
+        BVHCache::write_vector(file, m_node_bboxes) &&
+        BVHCache::write_vector(file, m_triangle_keys) &&
+        BVHCache::write_vector(file, m_leaf_data) &&
+        BVHCache::write_vector(file, m_vertices);
+
+    BVHCache::close_for_writing(key, file, temp_path, success);
+}
+
 size_t TriangleTree::get_memory_size() const
 {
     return
@@ -469,7 +1015,10 @@ size_t TriangleTree::get_memory_size() const
         - sizeof(*static_cast<const TreeType*>(this))
         + sizeof(*this)
         + m_triangle_keys.capacity() * sizeof(TriangleKey)
-        + m_leaf_data.capacity() * sizeof(uint8);
+        + m_leaf_data.capacity() * sizeof(uint8)
+        + m_vertices.capacity() * sizeof(GVector3)
+        + m_filter_indices.capacity() * sizeof(uint32)
+        + m_filtered_triangles.capacity() * sizeof(FilteredTriangle);
 }
 
 namespace
@@ -511,6 +1060,7 @@ void TriangleTree::build_bvh(
     const ParamArray&   params,
     const double        time,
     const bool          save_memory,
+    const bool          indexed,
     Statistics&         statistics)
 {
     Stopwatch<DefaultWallclockTimer> stopwatch;
@@ -602,6 +1152,7 @@ void TriangleTree::build_bvh(
         triangle_vertex_infos,
         triangle_vertices,
         triangle_keys,
+        indexed,
         statistics);
 
     const double storing_time = stopwatch.measure().get_seconds();
@@ -615,6 +1166,7 @@ void TriangleTree::build_sbvh(
     const ParamArray&   params,
     const double        time,
     const bool          save_memory,
+    const bool          indexed,
     Statistics&         statistics)
 {
     Stopwatch<DefaultWallclockTimer> stopwatch;
@@ -715,6 +1267,7 @@ void TriangleTree::build_sbvh(
         triangle_vertex_infos,
         triangle_vertices,
         triangle_keys,
+        indexed,
         statistics);
 
     const double storing_time = stopwatch.measure().get_seconds();
@@ -892,15 +1445,90 @@ vector<GAABB3> TriangleTree::compute_motion_bboxes(
     }
 }
 
+namespace
+{
+    struct VertexHasher
+    {
+        size_t operator()(const GVector3& v) const
+        {
+            return static_cast<size_t>(siphash24(v));
+        }
+    };
+
+    // Merge identical vertices of static triangles into a single vertex array, and
+    // return the indices in that array of the three vertices of each triangle.
+    void build_shared_vertices(
+        const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+        const vector<GVector3>&             triangle_vertices,
+        vector<GVector3>&                   shared_vertices,
+        vector<uint32>&                     shared_vertex_indices)
+    {
+        typedef boost::unordered_map<GVector3, uint32, VertexHasher> VertexIndexMap;
+
+        const size_t triangle_count = triangle_vertex_infos.size();
+
+        VertexIndexMap vertex_indices;
+        shared_vertex_indices.resize(triangle_count * 3, ~uint32(0));
+
+        for (size_t i = 0; i < triangle_count; ++i)
+        {
+            const TriangleVertexInfo& vertex_info = triangle_vertex_infos[i];
+
+            if (vertex_info.m_motion_segment_count > 0)
+                continue;
+
+            for (size_t j = 0; j < 3; ++j)
+            {
+                const GVector3& vertex = triangle_vertices[vertex_info.m_vertex_index + j];
+
+                const pair<VertexIndexMap::iterator, bool> result =
+                    vertex_indices.insert(
+                        make_pair(vertex, static_cast<uint32>(shared_vertices.size())));
+
+                if (result.second)
+                    shared_vertices.push_back(vertex);
+
+                shared_vertex_indices[i * 3 + j] = result.first->second;
+            }
+        }
+    }
+}
+
 void TriangleTree::store_triangles(
     const vector<size_t>&               triangle_indices,
     const vector<TriangleVertexInfo>&   triangle_vertex_infos,
     const vector<GVector3>&             triangle_vertices,
     const vector<TriangleKey>&          triangle_keys,
+    const bool                          indexed,
     Statistics&                         statistics)
 {
     const size_t node_count = m_nodes.size();
 
+    // Merge the vertices of static triangles if they are to be stored as vertex indices.
+
+    vector<uint32> shared_vertex_indices;
+
+    if (indexed)
+    {
+        if (triangle_vertices.size() < ~uint32(0))
+        {
+            build_shared_vertices(
+                triangle_vertex_infos,
+                triangle_vertices,
+                m_vertices,
+                shared_vertex_indices);
+            shrink_to_fit(m_vertices);
+        }
+        else
+        {
+            RENDERER_LOG_WARNING(
+                "triangle tree #" FMT_UNIQUE_ID " has too many vertices to store triangles as vertex indices.",
+                m_arguments.m_triangle_tree_uid);
+        }
+    }
+
+    const bool use_indices = !m_vertices.empty();
+
     // Gather statistics.
 
     size_t leaf_count = 0;
@@ -923,7 +1551,8 @@ void TriangleTree::store_triangles(
                     triangle_vertex_infos,
                     triangle_indices,
                     item_begin,
-                    item_count);
+                    item_count,
+                    use_indices);
 
             if (leaf_size < NodeType::MaxUserDataSize)
                 ++fat_leaf_count;
@@ -960,7 +1589,8 @@ void TriangleTree::store_triangles(
                     triangle_vertex_infos,
                     triangle_indices,
                     item_begin,
-                    item_count);
+                    item_count,
+                    use_indices);
 
             MemoryWriter user_data_writer(&node.get_user_data<uint8>());
 
@@ -971,6 +1601,7 @@ void TriangleTree::store_triangles(
                 TriangleEncoder::encode(
                     triangle_vertex_infos,
                     triangle_vertices,
+                    use_indices ? &shared_vertex_indices : 0,
                     triangle_indices,
                     item_begin,
                     item_count,
@@ -983,6 +1614,7 @@ void TriangleTree::store_triangles(
                 TriangleEncoder::encode(
                     triangle_vertex_infos,
                     triangle_vertices,
+                    use_indices ? &shared_vertex_indices : 0,
                     triangle_indices,
                     item_begin,
                     item_count,
@@ -992,6 +1624,9 @@ void TriangleTree::store_triangles(
     }
 
     statistics.insert_percent("fat leaves", fat_leaf_count, leaf_count);
+    statistics.insert<string>("triangle encoding", use_indices ? "vertex indices" : "vertices");
+    if (use_indices)
+        statistics.insert<size_t>("shared vertices", m_vertices.size());
 }
 
 namespace
@@ -1177,12 +1812,11 @@ namespace
 
             RENDERER_LOG_DEBUG(
                 "created intersection filter for object \"%s\" with " FMT_SIZE_T " material%s "
-                "(masks: %s, uvs: %s, filter key hash: 0x" FMT_UINT64_HEX ").",
+                "(masks: %s, filter key hash: 0x" FMT_UINT64_HEX ").",
                 filter_key.m_object->get_path().c_str(),
                 filter_key.m_materials.size(),
                 filter_key.m_materials.size() > 1 ? "s" : "",
                 pretty_size(intersection_filter->get_masks_memory_size()).c_str(),
-                pretty_size(intersection_filter->get_masks_memory_size()).c_str(),
                 filter_key_hash);
 
             // Store this intersection filter.
@@ -1285,6 +1919,153 @@ void TriangleTree::update_intersection_filters()
         object_instances_to_filter_keys,
         m_intersection_filters_repository,
         m_intersection_filters);
+
+    // Precompute per-triangle filtering data.
+    update_filtered_triangles();
+}
+
+namespace
+{
+    // Order triangle indices by object instance and region.
+    struct TriangleRegionOrder
+    {
+        const vector<TriangleKey>& m_triangle_keys;
+
+        explicit TriangleRegionOrder(const vector<TriangleKey>& triangle_keys)
+          : m_triangle_keys(triangle_keys)
+        {
+        }
+
+        bool operator()(const size_t lhs, const size_t rhs) const
+        {
+            const TriangleKey& lhs_key = m_triangle_keys[lhs];
+            const TriangleKey& rhs_key = m_triangle_keys[rhs];
+
+            if (lhs_key.get_object_instance_index() != rhs_key.get_object_instance_index())
+                return lhs_key.get_object_instance_index() < rhs_key.get_object_instance_index();
+
+            return lhs_key.get_region_index() < rhs_key.get_region_index();
+        }
+    };
+
+    void fetch_uv_coordinates(
+        const StaticTriangleTess&   tess,
+        const size_t                triangle_index,
+        Vector2f                    uv[3])
+    {
+        const Triangle& triangle = tess.m_primitives[triangle_index];
+
+        if (triangle.has_vertex_attributes() && tess.get_tex_coords_count() > 0)
+        {
+            const Vector2f uv0(tess.get_tex_coords(triangle.m_a0));
+            const Vector2f uv1(tess.get_tex_coords(triangle.m_a1));
+            const Vector2f uv2(tess.get_tex_coords(triangle.m_a2));
+
+            uv[0] = Vector2f(uv0[0], 1.0f - uv0[1]);
+            uv[1] = Vector2f(uv1[0], 1.0f - uv1[1]);
+            uv[2] = Vector2f(uv2[0], 1.0f - uv2[1]);
+        }
+        else
+        {
+            uv[0] = uv[1] = uv[2] = Vector2f(0.0f);
+        }
+    }
+}
+
+void TriangleTree::update_filtered_triangles()
+{
+    m_filter_indices.clear();
+    m_filtered_triangles.clear();
+
+    // Collect the triangles that belong to object instances with an intersection filter.
+    vector<size_t> triangle_indices;
+    for (size_t i = 0, e = m_triangle_keys.size(); i < e; ++i)
+    {
+        const size_t object_instance_index = m_triangle_keys[i].get_object_instance_index();
+        if (m_intersection_filters[object_instance_index])
+            triangle_indices.push_back(i);
+    }
+
+    if (triangle_indices.empty())
+        return;
+
+    // Group triangles by region so that each tessellation is accessed only once.
+    sort(triangle_indices.begin(), triangle_indices.end(), TriangleRegionOrder(m_triangle_keys));
+
+    const ObjectInstanceContainer& object_instances = m_arguments.m_assembly.object_instances();
+
+    vector<uint32> filter_indices(m_triangle_keys.size(), OpaqueTriangle);
+    vector<FilteredTriangle> filtered_triangles;
+    size_t transparent_triangle_count = 0;
+
+    for (size_t i = 0, e = triangle_indices.size(); i < e; )
+    {
+        const TriangleKey& first_key = m_triangle_keys[triangle_indices[i]];
+        const size_t object_instance_index = first_key.get_object_instance_index();
+        const size_t region_index = first_key.get_region_index();
+
+        const IntersectionFilter* filter = m_intersection_filters[object_instance_index];
+        Object& object = object_instances.get_by_index(object_instance_index)->get_object();
+
+        Access<RegionKit> region_kit(&object.get_region_kit());
+        const IRegion* region = (*region_kit)[region_index];
+        Access<StaticTriangleTess> tess(&region->get_static_triangle_tess());
+
+        for (; i < e; ++i)
+        {
+            const size_t triangle_index = triangle_indices[i];
+            const TriangleKey& triangle_key = m_triangle_keys[triangle_index];
+
+            if (triangle_key.get_object_instance_index() != object_instance_index ||
+                triangle_key.get_region_index() != region_index)
+                break;
+
+            FilteredTriangle filtered_triangle;
+            filtered_triangle.m_filter = filter;
+            filtered_triangle.m_triangle_pa = triangle_key.get_triangle_pa();
+            fetch_uv_coordinates(*tess, triangle_key.get_triangle_index(), filtered_triangle.m_uv);
+
+            // Hits on triangles fully covered by opaque or transparent texels are resolved here, once and for all.
+            switch (
+                filter->compute_coverage(
+                    filtered_triangle.m_triangle_pa,
+                    filtered_triangle.m_uv[0],
+                    filtered_triangle.m_uv[1],
+                    filtered_triangle.m_uv[2]))
+            {
+              case IntersectionFilter::CoverageOpaque:
+                break;
+
+              case IntersectionFilter::CoverageTransparent:
+                filter_indices[triangle_index] = TransparentTriangle;
+                ++transparent_triangle_count;
+                break;
+
+              case IntersectionFilter::CoveragePartial:
+                filter_indices[triangle_index] = static_cast<uint32>(filtered_triangles.size());
+                filtered_triangles.push_back(filtered_triangle);
+                break;
+
+              assert_otherwise;
+            }
+        }
+    }
+
+    RENDERER_LOG_DEBUG(
+        "triangle tree #" FMT_UNIQUE_ID ": " FMT_SIZE_T " triangle%s with intersection filters, "
+        FMT_SIZE_T " partially transparent, " FMT_SIZE_T " fully transparent.",
+        m_arguments.m_triangle_tree_uid,
+        triangle_indices.size(),
+        triangle_indices.size() > 1 ? "s" : "",
+        filtered_triangles.size(),
+        transparent_triangle_count);
+
+    // Leave the filtering data empty if no hit will ever need to be filtered.
+    if (filtered_triangles.empty() && transparent_triangle_count == 0)
+        return;
+
+    m_filter_indices.swap(filter_indices);
+    m_filtered_triangles.swap(filtered_triangles);
 }
 
 void TriangleTree::delete_intersection_filters()
@@ -1294,6 +2075,9 @@ void TriangleTree::delete_intersection_filters()
 
     m_intersection_filters_repository.clear();
     m_intersection_filters.clear();
+
+    clear_release_memory(m_filter_indices);
+    clear_release_memory(m_filtered_triangles);
 }
 
 
@@ -1303,12 +2087,30 @@ void TriangleTree::delete_intersection_filters()
 
 TriangleTreeFactory::TriangleTreeFactory(const TriangleTree::Arguments& arguments)
   : m_arguments(arguments)
+  , m_store(0)
+  , m_enable_intersection_filters(false)
 {
 }
 
+void TriangleTreeFactory::set_paged(
+    TriangleTreeStore&      store,
+    const bool              enable_intersection_filters)
+{
+    m_store = &store;
+    m_enable_intersection_filters = enable_intersection_filters;
+}
+
 auto_ptr<TriangleTree> TriangleTreeFactory::create()
 {
-    return auto_ptr<TriangleTree>(new TriangleTree(m_arguments));
+    auto_ptr<TriangleTree> tree(new TriangleTree(m_arguments));
+
+    if (m_store)
+    {
+        tree->update_non_geometry(m_enable_intersection_filters);
+        m_store->on_tree_loaded(this, tree->get_memory_size());
+    }
+
+    return tree;
 }
 
 
@@ -1354,6 +2156,26 @@ namespace
 // TriangleLeafVisitor class implementation.
 //
 
+namespace
+{
+    // Maximum number of hits on partially transparent triangles of a leaf whose filtering is deferred.
+    const size_t MaxDeferredHitCount = 8;
+
+    struct DeferredHit
+    {
+        double                  m_t;
+        double                  m_u;
+        double                  m_v;
+        GTriangleType           m_triangle;
+        size_t                  m_triangle_index;
+
+        bool operator<(const DeferredHit& rhs) const
+        {
+            return m_t < rhs.m_t;
+        }
+    };
+}
+
 bool TriangleLeafVisitor::visit(
     const TriangleTree::NodeType&           node,
     const Ray3d&                            ray,
@@ -1373,6 +2195,14 @@ bool TriangleLeafVisitor::visit(
             : &m_tree.m_leaf_data[leaf_data_index];     // triangles are stored in the tree
     MemoryReader reader(leaf_data);
 
+    // Hits on partially transparent triangles are only filtered once all triangles of the leaf
+    // have been intersected, from the closest one, since closer opaque hits may make them moot.
+    DeferredHit deferred_hits[MaxDeferredHitCount];
+    size_t deferred_hit_count = 0;
+
+    // Static triangles are stored as vertex indices if the tree has a vertex array.
+    const bool indexed = !m_tree.m_vertices.empty();
+
     // Sequentially intersect all triangles of the leaf.
     for (size_t triangle_index = node.get_item_index(),
                 triangle_count = node.get_item_count();
@@ -1393,34 +2223,88 @@ bool TriangleLeafVisitor::visit(
             // Check visibility flags.
             if (!(vis_flags & m_shading_point.m_ray.m_flags))
             {
-                reader += sizeof(GTriangleType);
+                reader += indexed ? 3 * sizeof(uint32) : sizeof(GTriangleType);
                 continue;
             }
 
-            // Read the triangle, converting it to the right format if necessary.
-            const GTriangleType& triangle = reader.read<GTriangleType>();
-            const TriangleReader triangle_reader(triangle);
-
-            // Intersect the triangle.
+            GTriangleType fetched_triangle;
+            const GTriangleType* triangle;
             double t, u, v;
-            if (triangle_reader.m_triangle.intersect(ray, t, u, v))
+
+            if (indexed)
             {
-                // Optionally filter intersections.
-                if (m_has_intersection_filters)
+                // Fetch the triangle's vertices from the tree's vertex array.
+                const GVector3& v0 = m_tree.m_vertices[reader.read<uint32>()];
+                const GVector3& v1 = m_tree.m_vertices[reader.read<uint32>()];
+                const GVector3& v2 = m_tree.m_vertices[reader.read<uint32>()];
+
+                // Intersect the triangle in single precision.
+                if (!m_has_watertight_ray_info)
                 {
-                    const TriangleKey& triangle_key = m_tree.m_triangle_keys[triangle_index];
-                    const IntersectionFilter* filter =
-                        m_tree.m_intersection_filters[triangle_key.get_object_instance_index()];
-                    if (filter && !filter->accept(triangle_key, u, v))
-                        continue;
+                    m_watertight_ray_info = WatertightRayInfo(ray);
+                    m_has_watertight_ray_info = true;
                 }
+                GScalar ft, fu, fv;
+                if (!GWatertightTriangleType(v0, v1, v2).intersect(ray, m_watertight_ray_info, ft, fu, fv))
+                    continue;
+
+                fetched_triangle = GTriangleType(v0, v1, v2);
+                triangle = &fetched_triangle;
+                t = ft;
+                u = fu;
+                v = fv;
+            }
+            else
+            {
+                // Read the triangle, converting it to the right format if necessary.
+                triangle = &reader.read<GTriangleType>();
+                const TriangleReader triangle_reader(*triangle);
 
-                m_hit_triangle = &triangle;
-                m_hit_triangle_index = triangle_index;
-                m_shading_point.m_ray.m_tmax = t;
-                m_shading_point.m_bary[0] = static_cast<float>(u);
-                m_shading_point.m_bary[1] = static_cast<float>(v);
+                // Intersect the triangle.
+                if (!triangle_reader.m_triangle.intersect(ray, t, u, v))
+                    continue;
             }
+
+            // Optionally filter intersections.
+            if (m_has_intersection_filters)
+            {
+                const uint32 filter_index = m_tree.m_filter_indices[triangle_index];
+
+                if (filter_index == TriangleTree::TransparentTriangle)
+                {
+                    ++m_filter_stats.m_skipped_hit_count;
+                    ++m_filter_stats.m_rejected_hit_count;
+                    continue;
+                }
+
+                if (filter_index == TriangleTree::OpaqueTriangle)
+                    ++m_filter_stats.m_skipped_hit_count;
+                else if (deferred_hit_count < MaxDeferredHitCount)
+                {
+                    DeferredHit& hit = deferred_hits[deferred_hit_count++];
+                    hit.m_t = t;
+                    hit.m_u = u;
+                    hit.m_v = v;
+                    hit.m_triangle = *triangle;
+                    hit.m_triangle_index = triangle_index;
+                    continue;
+                }
+                else if (!filter_hit(triangle_index, u, v))
+                    continue;
+            }
+
+            if (indexed)
+            {
+                m_hit_triangle_storage = fetched_triangle;
+                m_hit_triangle = &m_hit_triangle_storage;
+            }
+            else
+                m_hit_triangle = triangle;
+
+            m_hit_triangle_index = triangle_index;
+            m_shading_point.m_ray.m_tmax = t;
+            m_shading_point.m_bary[0] = static_cast<float>(u);
+            m_shading_point.m_bary[1] = static_cast<float>(v);
         }
         else
         {
@@ -1461,17 +2345,11 @@ bool TriangleLeafVisitor::visit(
             if (reader.m_triangle.intersect(ray, t, u, v))
             {
                 // Optionally filter intersections.
-                if (m_has_intersection_filters)
-                {
-                    const TriangleKey& triangle_key = m_tree.m_triangle_keys[triangle_index];
-                    const IntersectionFilter* filter =
-                        m_tree.m_intersection_filters[triangle_key.get_object_instance_index()];
-                    if (filter && !filter->accept(triangle_key, u, v))
-                        continue;
-                }
+                if (m_has_intersection_filters && !filter_hit(triangle_index, u, v))
+                    continue;
 
-                m_interpolated_triangle = triangle;
-                m_hit_triangle = &m_interpolated_triangle;
+                m_hit_triangle_storage = triangle;
+                m_hit_triangle = &m_hit_triangle_storage;
                 m_hit_triangle_index = triangle_index;
                 m_shading_point.m_ray.m_tmax = t;
                 m_shading_point.m_bary[0] = static_cast<float>(u);
@@ -1480,11 +2358,84 @@ bool TriangleLeafVisitor::visit(
         }
     }
 
+    // Filter deferred hits, closest first, until one of them is accepted.
+    if (deferred_hit_count > 0)
+    {
+        sort(&deferred_hits[0], &deferred_hits[0] + deferred_hit_count);
+
+        for (size_t i = 0; i < deferred_hit_count; ++i)
+        {
+            const DeferredHit& hit = deferred_hits[i];
+
+            if (hit.m_t >= m_shading_point.m_ray.m_tmax)
+                break;
+
+            if (filter_hit(hit.m_triangle_index, hit.m_u, hit.m_v))
+            {
+                m_hit_triangle_storage = hit.m_triangle;
+                m_hit_triangle = &m_hit_triangle_storage;
+                m_hit_triangle_index = hit.m_triangle_index;
+                m_shading_point.m_ray.m_tmax = hit.m_t;
+                m_shading_point.m_bary[0] = static_cast<float>(hit.m_u);
+                m_shading_point.m_bary[1] = static_cast<float>(hit.m_v);
+                break;
+            }
+        }
+    }
+
     // Continue traversal.
     distance = m_shading_point.m_ray.m_tmax;
     return true;
 }
 
+bool TriangleLeafVisitor::filter_hit(
+    const size_t                            triangle_index,
+    const double                            u,
+    const double                            v) const
+{
+    const uint32 filter_index = m_tree.m_filter_indices[triangle_index];
+
+    if (filter_index == TriangleTree::OpaqueTriangle)
+    {
+        ++m_filter_stats.m_skipped_hit_count;
+        return true;
+    }
+
+    if (filter_index == TriangleTree::TransparentTriangle)
+    {
+        ++m_filter_stats.m_skipped_hit_count;
+        ++m_filter_stats.m_rejected_hit_count;
+        return false;
+    }
+
+    // Don't use the alpha mask if the UV coordinates are indefinite.
+    // This can happen in rare circumstances, when hitting degenerate
+    // or nearly degenerate geometry. Since we cannot guarantee to
+    // catch all instances of degenerate geometry before rendering, and
+    // because using the alpha mask in this case would lead to a crash,
+    // we decide in this case to simply revert to the normal code path.
+    if (u != u || v != v)
+        return true;
+
+    ++m_filter_stats.m_tested_hit_count;
+
+    const TriangleTree::FilteredTriangle& triangle = m_tree.m_filtered_triangles[filter_index];
+
+    const float fu = static_cast<float>(u);
+    const float fv = static_cast<float>(v);
+
+    const Vector2f uv =
+          triangle.m_uv[0] * (1.0f - fu - fv)
+        + triangle.m_uv[1] * fu
+        + triangle.m_uv[2] * fv;
+
+    if (triangle.m_filter->accept(triangle.m_triangle_pa, uv))
+        return true;
+
+    ++m_filter_stats.m_rejected_hit_count;
+    return false;
+}
+
 void TriangleLeafVisitor::read_hit_triangle_data() const
 {
     if (m_hit_triangle)
@@ -1528,6 +2479,9 @@ bool TriangleLeafProbeVisitor::visit(
             : &m_tree.m_leaf_data[leaf_data_index];     // triangles are stored in the tree
     MemoryReader reader(leaf_data);
 
+    // Static triangles are stored as vertex indices if the tree has a vertex array.
+    const bool indexed = !m_tree.m_vertices.empty();
+
     // Sequentially intersect triangles until a hit is found.
     for (size_t triangle_count = node.get_item_count(); triangle_count--; )
     {
@@ -1545,19 +2499,41 @@ bool TriangleLeafProbeVisitor::visit(
             // Check visibility flags.
             if (!(vis_flags & m_ray_flags))
             {
-                reader += sizeof(GTriangleType);
+                reader += indexed ? 3 * sizeof(uint32) : sizeof(GTriangleType);
                 continue;
             }
 
-            // Read the triangle, converting it to the right format if necessary.
-            const GTriangleType& triangle = reader.read<GTriangleType>();
-            const TriangleReader triangle_reader(triangle);
+            if (indexed)
+            {
+                // Fetch the triangle's vertices from the tree's vertex array.
+                const GVector3& v0 = m_tree.m_vertices[reader.read<uint32>()];
+                const GVector3& v1 = m_tree.m_vertices[reader.read<uint32>()];
+                const GVector3& v2 = m_tree.m_vertices[reader.read<uint32>()];
 
-            // Intersect the triangle.
-            if (triangle_reader.m_triangle.intersect(ray))
+                // Intersect the triangle in single precision.
+                if (!m_has_watertight_ray_info)
+                {
+                    m_watertight_ray_info = WatertightRayInfo(ray);
+                    m_has_watertight_ray_info = true;
+                }
+                if (GWatertightTriangleType(v0, v1, v2).intersect(ray, m_watertight_ray_info))
+                {
+                    m_hit = true;
+                    return false;
+                }
+            }
+            else
             {
-                m_hit = true;
-                return false;
+                // Read the triangle, converting it to the right format if necessary.
+                const GTriangleType& triangle = reader.read<GTriangleType>();
+                const TriangleReader triangle_reader(triangle);
+
+                // Intersect the triangle.
+                if (triangle_reader.m_triangle.intersect(ray))
+                {
+                    m_hit = true;
+                    return false;
+                }
             }
         }
         else
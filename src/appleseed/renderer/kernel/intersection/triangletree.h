@@ -43,7 +43,9 @@
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/aabb.h"
 #include "foundation/math/bvh.h"
+#include "foundation/math/intersection/raytrianglewt.h"
 #include "foundation/math/ray.h"
+#include "foundation/math/vector.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/alignedvector.h"
 #include "foundation/utility/lazy.h"
@@ -60,9 +62,11 @@
 namespace foundation    { class Statistics; }
 namespace renderer      { class Assembly; }
 namespace renderer      { class IntersectionFilter; }
+namespace renderer      { struct IntersectionFilterStatistics; }
 namespace renderer      { class ParamArray; }
 namespace renderer      { class Scene; }
 namespace renderer      { class ShadingPoint; }
+namespace renderer      { class TriangleTreeStore; }
 
 namespace renderer
 {
@@ -90,6 +94,7 @@ class TriangleTree
         const GAABB3                            m_bbox;
         const Assembly&                         m_assembly;
         const RegionInfoVector                  m_regions;
+        const GScalar                           m_simplification_cell_size;     // 0 for full resolution geometry
 
         // Constructor.
         Arguments(
@@ -97,10 +102,14 @@ class TriangleTree
             const foundation::UniqueID          triangle_tree_uid,
             const GAABB3&                       bbox,
             const Assembly&                     assembly,
-            const RegionInfoVector&             regions);
+            const RegionInfoVector&             regions,
+            const GScalar                       simplification_cell_size = GScalar(0.0));
     };
 
-    // Constructor, builds the tree for a given set of regions.
+    // Constructor, builds the tree for a given set of regions. When a simplification
+    // cell size is given, the static triangles of the regions are simplified by vertex
+    // clustering on a grid of cubic cells of that size, which makes the tree a proxy
+    // of the full resolution geometry.
     explicit TriangleTree(const Arguments& arguments);
 
     // Destructor.
@@ -128,19 +137,45 @@ class TriangleTree
     std::vector<TriangleKey>                    m_triangle_keys;
     std::vector<foundation::uint8>              m_leaf_data;
 
+    // Vertices shared by the static triangles of the tree, when they are stored in leaves as
+    // vertex indices rather than as vertices. Empty if static triangles store their vertices.
+    std::vector<GVector3>                       m_vertices;
+
     IntersectionFilterRepository                m_intersection_filters_repository;
     std::vector<const IntersectionFilter*>      m_intersection_filters;
 
+    // Special values of m_filter_indices[] for triangles whose hits don't need filtering.
+    enum
+    {
+        OpaqueTriangle      = ~foundation::uint32(0),
+        TransparentTriangle = ~foundation::uint32(0) - 1
+    };
+
+    // Data required to filter hits on a triangle partially covered by alpha masks.
+    struct FilteredTriangle
+    {
+        const IntersectionFilter*               m_filter;
+        size_t                                  m_triangle_pa;
+        foundation::Vector2f                    m_uv[3];        // V axis pointing downward
+    };
+
+    // For each item of m_triangle_keys, either OpaqueTriangle, TransparentTriangle
+    // or the index of the triangle's filtering data in m_filtered_triangles.
+    std::vector<foundation::uint32>             m_filter_indices;
+    std::vector<FilteredTriangle>               m_filtered_triangles;
+
     void build_bvh(
         const ParamArray&                       params,
         const double                            time,
         const bool                              save_memory,
+        const bool                              indexed,
         foundation::Statistics&                 statistics);
 
     void build_sbvh(
         const ParamArray&                       params,
         const double                            time,
         const bool                              save_memory,
+        const bool                              indexed,
         foundation::Statistics&                 statistics);
 
     std::vector<GAABB3> compute_motion_bboxes(
@@ -154,9 +189,14 @@ class TriangleTree
         const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
         const std::vector<GVector3>&            triangle_vertices,
         const std::vector<TriangleKey>&         triangle_keys,
+        const bool                              indexed,
         foundation::Statistics&                 statistics);
 
+    bool load_from_cache(const foundation::uint64 key);
+    void store_to_cache(const foundation::uint64 key) const;
+
     void update_intersection_filters();
+    void update_filtered_triangles();
     void delete_intersection_filters();
 };
 
@@ -173,11 +213,20 @@ class TriangleTreeFactory
     explicit TriangleTreeFactory(
         const TriangleTree::Arguments& arguments);
 
+    // Let a triangle tree store track the trees created by this factory. Since such
+    // trees may be evicted and created again while rendering, their non-geometry
+    // aspects are updated as soon as they are created.
+    void set_paged(
+        TriangleTreeStore&      store,
+        const bool              enable_intersection_filters);
+
     // Create the triangle tree.
     virtual std::auto_ptr<TriangleTree> create();
 
   private:
     TriangleTree::Arguments m_arguments;
+    TriangleTreeStore*      m_store;
+    bool                    m_enable_intersection_filters;
 };
 
 
@@ -206,6 +255,10 @@ typedef foundation::AccessCacheMap<
 // Triangle leaf visitor, used during tree intersection.
 //
 
+// Triangles stored as vertex indices are intersected in single precision using a watertight test.
+typedef foundation::TriangleWT<GScalar> GWatertightTriangleType;
+typedef GWatertightTriangleType::RayInfo WatertightRayInfo;
+
 class TriangleLeafVisitor
   : public foundation::NonCopyable
 {
@@ -213,7 +266,8 @@ class TriangleLeafVisitor
     // Constructor.
     TriangleLeafVisitor(
         const TriangleTree&                     tree,
-        ShadingPoint&                           shading_point);
+        ShadingPoint&                           shading_point,
+        IntersectionFilterStatistics&           filter_stats);
 
     // Visit a leaf.
     bool visit(
@@ -230,12 +284,21 @@ class TriangleLeafVisitor
     void read_hit_triangle_data() const;
 
   private:
-    const TriangleTree&     m_tree;
-    const bool              m_has_intersection_filters;
-    ShadingPoint&           m_shading_point;
-    GTriangleType           m_interpolated_triangle;
-    const GTriangleType*    m_hit_triangle;
-    size_t                  m_hit_triangle_index;
+    const TriangleTree&             m_tree;
+    const bool                      m_has_intersection_filters;
+    ShadingPoint&                   m_shading_point;
+    IntersectionFilterStatistics&   m_filter_stats;
+    GTriangleType                   m_hit_triangle_storage;     // hit triangle, if it isn't stored in the tree
+    const GTriangleType*            m_hit_triangle;
+    size_t                          m_hit_triangle_index;
+    bool                            m_has_watertight_ray_info;
+    WatertightRayInfo               m_watertight_ray_info;
+
+    // Return true if a hit at given barycentric coordinates on a given triangle is accepted.
+    bool filter_hit(
+        const size_t                            triangle_index,
+        const double                            u,
+        const double                            v) const;
 };
 
 
@@ -270,6 +333,8 @@ class TriangleLeafProbeVisitor
     const double                m_ray_time;
     const VisibilityFlags::Type m_ray_flags;
     const bool                  m_has_intersection_filters;
+    bool                        m_has_watertight_ray_info;
+    WatertightRayInfo           m_watertight_ray_info;
 };
 
 
@@ -312,12 +377,15 @@ inline size_t TriangleTree::get_moving_triangle_count() const
 //
 
 inline TriangleLeafVisitor::TriangleLeafVisitor(
-    const TriangleTree&         tree,
-    ShadingPoint&               shading_point)
+    const TriangleTree&             tree,
+    ShadingPoint&                   shading_point,
+    IntersectionFilterStatistics&   filter_stats)
   : m_tree(tree)
-  , m_has_intersection_filters(!tree.m_intersection_filters.empty())
+  , m_has_intersection_filters(!tree.m_filter_indices.empty())
   , m_shading_point(shading_point)
+  , m_filter_stats(filter_stats)
   , m_hit_triangle(0)
+  , m_has_watertight_ray_info(false)
 {
 }
 
@@ -333,7 +401,8 @@ inline TriangleLeafProbeVisitor::TriangleLeafProbeVisitor(
   : m_tree(tree)
   , m_ray_time(ray_time)
   , m_ray_flags(ray_flags)
-  , m_has_intersection_filters(!tree.m_intersection_filters.empty())
+  , m_has_intersection_filters(!tree.m_filter_indices.empty())
+  , m_has_watertight_ray_info(false)
 {
 }
 
@@ -0,0 +1,287 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "triangletreestore.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/intersection/triangletree.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+#include "foundation/utility/containers/dictionary.h"
+
+// Boost headers.
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <cassert>
+#include <list>
+#include <map>
+#include <utility>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    typedef TriangleTreeStore::LazyTreeType LazyTreeType;
+    typedef TriangleTreeStore::FactoryType FactoryType;
+
+    // Resident trees, least recently loaded first.
+    typedef list<const FactoryType*> LoadOrder;
+
+    struct TreeEntry
+    {
+        LazyTreeType*       m_tree;
+        size_t              m_memory_size;      // 0 if the tree is not resident
+        bool                m_resident;
+        bool                m_loaded;           // true if the tree was loaded at least once
+        LoadOrder::iterator m_load_order_it;
+    };
+
+    // Trees are indexed by their factory, which is what creates them.
+    typedef map<const FactoryType*, TreeEntry> TreeEntryMap;
+}
+
+struct TriangleTreeStore::Impl
+{
+    mutable boost::mutex    m_mutex;
+    uint64                  m_max_size;
+    TreeEntryMap            m_entries;
+    LoadOrder               m_load_order;
+    uint64                  m_resident_size;
+    uint64                  m_peak_resident_size;
+    uint64                  m_load_count;
+    uint64                  m_reload_count;
+    uint64                  m_evict_count;
+
+    Impl()
+      : m_max_size(0)
+      , m_resident_size(0)
+      , m_peak_resident_size(0)
+      , m_load_count(0)
+      , m_reload_count(0)
+      , m_evict_count(0)
+    {
+    }
+
+    void make_non_resident(TreeEntry& entry)
+    {
+        assert(entry.m_resident);
+        assert(m_resident_size >= entry.m_memory_size);
+
+        m_resident_size -= entry.m_memory_size;
+        m_load_order.erase(entry.m_load_order_it);
+
+        entry.m_memory_size = 0;
+        entry.m_resident = false;
+    }
+
+    // Evict the least recently loaded trees until the resident trees fit within
+    // the memory budget. Must be called with the mutex locked.
+    void enforce_memory_budget(const FactoryType* keep)
+    {
+        LoadOrder::iterator i = m_load_order.begin();
+
+        while (i != m_load_order.end() && m_resident_size > m_max_size)
+        {
+            const FactoryType* factory = *i++;
+
+            if (factory == keep)
+                continue;
+
+            TreeEntry& entry = m_entries[factory];
+
+            // Trees being accessed, or locked by another thread, are skipped.
+            if (entry.m_tree->try_evict())
+            {
+                make_non_resident(entry);
+                ++m_evict_count;
+            }
+        }
+    }
+};
+
+Dictionary TriangleTreeStore::get_params_metadata()
+{
+    Dictionary metadata;
+
+    metadata.dictionaries().insert(
+        "max_size",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "0")
+            .insert("label", "Triangle Tree Memory Budget")
+            .insert("help", "Maximum size in bytes of the triangle trees kept in memory (all trees stay in memory if 0)"));
+
+    return metadata;
+}
+
+TriangleTreeStore::TriangleTreeStore()
+  : impl(new Impl())
+{
+}
+
+TriangleTreeStore::~TriangleTreeStore()
+{
+    assert(impl->m_entries.empty());
+    delete impl;
+}
+
+void TriangleTreeStore::configure(const ParamArray& params)
+{
+    const uint64 max_size = params.get_optional<uint64>("max_size", 0);
+
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    impl->m_max_size = max_size;
+}
+
+bool TriangleTreeStore::is_enabled() const
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    return impl->m_max_size > 0;
+}
+
+void TriangleTreeStore::insert(LazyTreeType* tree)
+{
+    assert(tree);
+    assert(tree->get_factory());
+
+    TreeEntry entry;
+    entry.m_tree = tree;
+    entry.m_memory_size = 0;
+    entry.m_resident = false;
+    entry.m_loaded = false;
+
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    assert(impl->m_entries.find(tree->get_factory()) == impl->m_entries.end());
+    impl->m_entries.insert(make_pair(tree->get_factory(), entry));
+}
+
+void TriangleTreeStore::remove(LazyTreeType* tree)
+{
+    assert(tree);
+
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    const TreeEntryMap::iterator i = impl->m_entries.find(tree->get_factory());
+    assert(i != impl->m_entries.end());
+
+    if (i->second.m_resident)
+        impl->make_non_resident(i->second);
+
+    impl->m_entries.erase(i);
+}
+
+bool TriangleTreeStore::is_resident(const LazyTreeType* tree) const
+{
+    assert(tree);
+
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    const TreeEntryMap::const_iterator i = impl->m_entries.find(tree->get_factory());
+    return i != impl->m_entries.end() && i->second.m_resident;
+}
+
+void TriangleTreeStore::on_tree_loaded(
+    const FactoryType*  factory,
+    const size_t        memory_size)
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    const TreeEntryMap::iterator i = impl->m_entries.find(factory);
+    if (i == impl->m_entries.end())
+        return;
+
+    TreeEntry& entry = i->second;
+
+    if (entry.m_resident)
+        impl->make_non_resident(entry);
+
+    if (entry.m_loaded)
+        ++impl->m_reload_count;
+    else ++impl->m_load_count;
+
+    entry.m_memory_size = memory_size;
+    entry.m_resident = true;
+    entry.m_loaded = true;
+    entry.m_load_order_it = impl->m_load_order.insert(impl->m_load_order.end(), factory);
+
+    impl->m_resident_size += memory_size;
+
+    if (impl->m_peak_resident_size < impl->m_resident_size)
+        impl->m_peak_resident_size = impl->m_resident_size;
+
+    if (impl->m_max_size > 0)
+        impl->enforce_memory_budget(factory);
+}
+
+size_t TriangleTreeStore::get_resident_tree_count() const
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    return impl->m_load_order.size();
+}
+
+uint64 TriangleTreeStore::get_reload_count() const
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    return impl->m_reload_count;
+}
+
+uint64 TriangleTreeStore::get_eviction_count() const
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    return impl->m_evict_count;
+}
+
+StatisticsVector TriangleTreeStore::get_statistics() const
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    Statistics stats;
+    stats.insert_size("size limit", impl->m_max_size);
+    stats.insert_size("resident size", impl->m_resident_size);
+    stats.insert_size("peak size", impl->m_peak_resident_size);
+    stats.insert("trees", static_cast<uint64>(impl->m_entries.size()));
+    stats.insert("resident trees", static_cast<uint64>(impl->m_load_order.size()));
+    stats.insert("loads", impl->m_load_count);
+    stats.insert("reloads", impl->m_reload_count);
+    stats.insert("evictions", impl->m_evict_count);
+
+    return StatisticsVector::make("triangle tree store statistics", stats);
+}
+
+}   // namespace renderer
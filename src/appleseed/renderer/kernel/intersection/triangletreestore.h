@@ -0,0 +1,125 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_INTERSECTION_TRIANGLETREESTORE_H
+#define APPLESEED_RENDERER_KERNEL_INTERSECTION_TRIANGLETREESTORE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/lazy.h"
+#include "foundation/utility/statistics.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class Dictionary; }
+namespace renderer      { class ParamArray; }
+namespace renderer      { class TriangleTree; }
+
+namespace renderer
+{
+
+//
+// Residency manager for the triangle trees of assemblies (out-of-core geometry).
+//
+// When a memory budget is configured, triangle trees registered with the store are
+// no longer kept in memory for the whole render: whenever loading a tree makes the
+// total size of the resident trees exceed the budget, the least recently loaded
+// trees that are not being accessed are evicted. Evicted trees are reloaded from
+// the BVH cache, or rebuilt, the next time a ray reaches them.
+//
+// Trees held by the triangle tree access caches of the rendering threads can't be
+// evicted, so the budget may be exceeded when it is smaller than the working set
+// of the threads.
+//
+// Each trace context owns a store. The store is disabled (all trees stay resident)
+// until a budget is configured. All methods are thread-safe.
+//
+
+class APPLESEED_DLLSYMBOL TriangleTreeStore
+  : public foundation::NonCopyable
+{
+  public:
+    typedef foundation::Lazy<TriangleTree> LazyTreeType;
+    typedef foundation::ILazyFactory<TriangleTree> FactoryType;
+
+    // Return the metadata of the store parameters.
+    static foundation::Dictionary get_params_metadata();
+
+    // Constructor.
+    TriangleTreeStore();
+
+    // Destructor.
+    ~TriangleTreeStore();
+
+    // Configure the store from the "triangle_tree_store" parameters of the renderer.
+    void configure(const ParamArray& params);
+
+    // Return true if a memory budget was configured.
+    bool is_enabled() const;
+
+    // Register a tree that can be evicted. The tree must not have been accessed yet.
+    void insert(LazyTreeType* tree);
+
+    // Unregister a tree. Must be called before the tree is deleted.
+    void remove(LazyTreeType* tree);
+
+    // Return true if a registered tree is currently in memory.
+    bool is_resident(const LazyTreeType* tree) const;
+
+    // Record that the factory of a registered tree created it, then evict
+    // other trees if the memory budget is exceeded.
+    void on_tree_loaded(
+        const FactoryType*  factory,
+        const size_t        memory_size);
+
+    // Return the number of registered trees currently in memory.
+    size_t get_resident_tree_count() const;
+
+    // Return the number of trees created again after having been evicted.
+    foundation::uint64 get_reload_count() const;
+
+    // Return the number of evicted trees.
+    foundation::uint64 get_eviction_count() const;
+
+    // Retrieve residency statistics.
+    foundation::StatisticsVector get_statistics() const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_INTERSECTION_TRIANGLETREESTORE_H
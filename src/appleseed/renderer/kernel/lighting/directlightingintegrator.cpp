@@ -32,6 +32,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/lighting/lightsampler.h"
+#include "renderer/kernel/lighting/shadowraybatch.h"
 #include "renderer/kernel/lighting/tracer.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
@@ -64,12 +65,17 @@ namespace renderer
 //       take_single_material_sample
 //
 //   compute_outgoing_radiance_light_sampling
-//       add_emitting_triangle_sample_contribution
-//       add_non_physical_light_sample_contribution
+//       add_light_sample
+//           prepare_emitting_triangle_sample
+//           prepare_non_physical_light_sample
+//           add_pending_light_sample_contributions
+//               get_shader_group
+//               add_emitting_triangle_sample_contribution
+//               add_non_physical_light_sample_contribution
 //
 //   compute_outgoing_radiance_light_sampling_low_variance
-//       add_emitting_triangle_sample_contribution
-//       add_non_physical_light_sample_contribution
+//       add_light_sample
+//           (same as above)
 //
 //   compute_outgoing_radiance_combined_sampling
 //       compute_outgoing_radiance_material_sampling
@@ -91,7 +97,9 @@ DirectLightingIntegrator::DirectLightingIntegrator(
     const size_t                material_sample_count,
     const size_t                light_sample_count,
     const float                 low_light_threshold,
-    const bool                  indirect)
+    const bool                  indirect,
+    const size_t                shadow_ray_batch_size,
+    const bool                  coherent_shading)
   : m_shading_context(shading_context)
   , m_light_sampler(light_sampler)
   , m_material_sampler(material_sampler)
@@ -101,9 +109,26 @@ DirectLightingIntegrator::DirectLightingIntegrator(
   , m_light_sample_count(light_sample_count)
   , m_low_light_threshold(low_light_threshold)
   , m_indirect(indirect)
+  , m_shadow_ray_batch_size(shadow_ray_batch_size)
+  , m_coherent_shading(coherent_shading)
 {
 }
 
+struct DirectLightingIntegrator::PendingLightSample
+{
+    LightSample     m_sample;
+    Vector3d        m_incoming;                 // world space incoming direction, unit-length
+
+    // Emitting triangles only.
+    double          m_cos_on;
+    double          m_rcp_sample_square_distance;
+    float           m_contribution_prob;
+
+    // Non-physical lights only.
+    Vector3d        m_emission_position;
+    Spectrum        m_light_value;
+};
+
 void DirectLightingIntegrator::compute_outgoing_radiance_material_sampling(
     SamplingContext&            sampling_context,
     const MISHeuristic          mis_heuristic,
@@ -151,6 +176,9 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling(
 
     sampling_context.split_in_place(3, m_light_sample_count);
 
+    ShadowRayBatch shadow_rays(m_shadow_ray_batch_size);
+    PendingLightSample pending_samples[ShadowRayBatch::MaxSize];
+
     // Add contributions from both emitting triangles and non-physical light sources.
     for (size_t i = 0; i < m_light_sample_count; ++i)
     {
@@ -161,24 +189,24 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling(
             sampling_context.next2<Vector3f>(),
             sample);
 
-        if (sample.m_triangle)
-        {
-            add_emitting_triangle_sample_contribution(
-                sampling_context,
-                sample,
-                mis_heuristic,
-                outgoing,
-                radiance);
-        }
-        else
-        {
-            add_non_physical_light_sample_contribution(
-                sample,
-                outgoing,
-                radiance);
-        }
+        add_light_sample(
+            sampling_context,
+            sample,
+            mis_heuristic,
+            outgoing,
+            shadow_rays,
+            pending_samples,
+            radiance);
     }
 
+    // Trace the remaining shadow rays.
+    add_pending_light_sample_contributions(
+        mis_heuristic,
+        outgoing,
+        shadow_rays,
+        pending_samples,
+        radiance);
+
     if (m_light_sample_count > 1)
     {
         const float rcp_light_sample_count = 1.0f / m_light_sample_count;
@@ -203,6 +231,9 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling_low_vari
     if (!m_material_sampler.contributes_to_light_sampling())
         return;
 
+    ShadowRayBatch shadow_rays(m_shadow_ray_batch_size);
+    PendingLightSample pending_samples[ShadowRayBatch::MaxSize];
+
     // Add contributions from emitting triangles only.
     if (m_light_sampler.get_emitting_triangle_count() > 0)
     {
@@ -217,14 +248,24 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling_low_vari
                 sampling_context.next2<Vector3f>(),
                 sample);
 
-            add_emitting_triangle_sample_contribution(
+            add_light_sample(
                 sampling_context,
                 sample,
                 mis_heuristic,
                 outgoing,
+                shadow_rays,
+                pending_samples,
                 radiance);
         }
 
+        // Trace the remaining shadow rays.
+        add_pending_light_sample_contributions(
+            mis_heuristic,
+            outgoing,
+            shadow_rays,
+            pending_samples,
+            radiance);
+
         if (m_light_sample_count > 1)
         {
             const float rcp_light_sample_count = 1.0f / m_light_sample_count;
@@ -238,11 +279,23 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling_low_vari
         LightSample sample;
         m_light_sampler.sample_non_physical_light(m_time, i, sample);
 
-        add_non_physical_light_sample_contribution(
+        add_light_sample(
+            sampling_context,
             sample,
+            mis_heuristic,
             outgoing,
+            shadow_rays,
+            pending_samples,
             radiance);
     }
+
+    // Trace the remaining shadow rays.
+    add_pending_light_sample_contributions(
+        mis_heuristic,
+        outgoing,
+        shadow_rays,
+        pending_samples,
+        radiance);
 }
 
 void DirectLightingIntegrator::compute_outgoing_radiance_combined_sampling(
@@ -529,38 +582,149 @@ void DirectLightingIntegrator::take_single_material_sample(
     radiance += edf_value;
 }
 
-void DirectLightingIntegrator::add_emitting_triangle_sample_contribution(
+void DirectLightingIntegrator::add_light_sample(
     SamplingContext&            sampling_context,
     const LightSample&          sample,
     const MISHeuristic          mis_heuristic,
     const Dual3d&               outgoing,
+    ShadowRayBatch&             shadow_rays,
+    PendingLightSample*         pending_samples,
     Spectrum&                   radiance) const
 {
-    const Material* material = sample.m_triangle->m_material;
-    const Material::RenderData& material_data = material->get_render_data();
-    const EDF* edf = material_data.m_edf;
+    PendingLightSample& pending_sample = pending_samples[shadow_rays.size()];
+    pending_sample.m_sample = sample;
+
+    // Only cheap tests are done before tracing the shadow ray.
+    if (sample.m_triangle)
+    {
+        if (!prepare_emitting_triangle_sample(sampling_context, pending_sample))
+            return;
+
+        shadow_rays.insert(sample.m_point);
+    }
+    else
+    {
+        if (!prepare_non_physical_light_sample(pending_sample))
+            return;
+
+        shadow_rays.insert(pending_sample.m_emission_position);
+    }
+
+    if (shadow_rays.full())
+    {
+        add_pending_light_sample_contributions(
+            mis_heuristic,
+            outgoing,
+            shadow_rays,
+            pending_samples,
+            radiance);
+    }
+}
+
+void DirectLightingIntegrator::add_pending_light_sample_contributions(
+    const MISHeuristic          mis_heuristic,
+    const Dual3d&               outgoing,
+    ShadowRayBatch&             shadow_rays,
+    const PendingLightSample*   pending_samples,
+    Spectrum&                   radiance) const
+{
+    // Trace all shadow rays first.
+    shadow_rays.trace_between(m_shading_context, m_material_sampler);
+
+    // Only evaluate materials and emitters of unoccluded samples.
+    size_t order[ShadowRayBatch::MaxSize];
+    size_t count = 0;
+    for (size_t i = 0, e = shadow_rays.size(); i < e; ++i)
+    {
+        // Discard occluded samples.
+        if (shadow_rays.get_transmission(i) > 0.0f)
+            order[count++] = i;
+    }
+
+    // Optionally group the samples by the shader group of their emitter so that
+    // executions of the same OSL shader group run back to back. The sort is stable
+    // so that samples sharing a shader group keep their original order.
+    if (m_coherent_shading)
+    {
+        for (size_t i = 1; i < count; ++i)
+        {
+            const size_t index = order[i];
+            const ShaderGroup* group = get_shader_group(pending_samples[index]);
+
+            size_t j = i;
+            while (j > 0 && group < get_shader_group(pending_samples[order[j - 1]]))
+            {
+                order[j] = order[j - 1];
+                --j;
+            }
+
+            order[j] = index;
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float transmission = shadow_rays.get_transmission(order[i]);
+        const PendingLightSample& pending_sample = pending_samples[order[i]];
+
+        if (pending_sample.m_sample.m_triangle)
+        {
+            add_emitting_triangle_sample_contribution(
+                pending_sample,
+                transmission,
+                mis_heuristic,
+                outgoing,
+                radiance);
+        }
+        else
+        {
+            add_non_physical_light_sample_contribution(
+                pending_sample,
+                transmission,
+                outgoing,
+                radiance);
+        }
+    }
+
+    shadow_rays.clear();
+}
+
+const ShaderGroup* DirectLightingIntegrator::get_shader_group(
+    const PendingLightSample&   pending_sample)
+{
+    // Non-physical lights are not shaded with OSL and sort first.
+    const LightSample& sample = pending_sample.m_sample;
+    return sample.m_triangle ? sample.m_triangle->m_material->get_render_data().m_shader_group : 0;
+}
+
+bool DirectLightingIntegrator::prepare_emitting_triangle_sample(
+    SamplingContext&            sampling_context,
+    PendingLightSample&         pending_sample) const
+{
+    const LightSample& sample = pending_sample.m_sample;
+    const EDF* edf = sample.m_triangle->m_material->get_render_data().m_edf;
 
     // No contribution if we are computing indirect lighting but this light does not cast indirect light.
     if (m_indirect && !(edf->get_flags() & EDF::CastIndirectLight))
-        return;
+        return false;
 
     // Compute the incoming direction in world space.
     Vector3d incoming = sample.m_point - m_material_sampler.get_point();
 
     if (m_material_sampler.cull_incoming_direction(incoming))
-        return;
+        return false;
 
     // No contribution if the shading point is behind the light.
     double cos_on = dot(-incoming, sample.m_shading_normal);
     if (cos_on <= 0.0)
-        return;
+        return false;
     
     // Compute the square distance between the light sample and the shading point.
     const double square_distance = square_norm(incoming);
     
     // Don't use this sample if we're closer than the light near start value.
     if (square_distance < square(edf->get_light_near_start()))
-        return;
+        return false;
 
     const double rcp_sample_square_distance = 1.0 / square_distance;
     const double rcp_sample_distance = sqrt(rcp_sample_square_distance);
@@ -593,19 +757,30 @@ void DirectLightingIntegrator::add_emitting_triangle_sample_contribution(
 
             // Russian Roulette.
             if (!pass_rr(contribution_prob, s))
-                return;
+                return false;
         }
     }
 
-    // Compute the transmission factor between the light sample and the shading point.
-    const float transmission =
-        m_material_sampler.trace_between(
-            m_shading_context,
-            sample.m_point);
+    pending_sample.m_incoming = incoming;
+    pending_sample.m_cos_on = cos_on;
+    pending_sample.m_rcp_sample_square_distance = rcp_sample_square_distance;
+    pending_sample.m_contribution_prob = contribution_prob;
 
-    // Discard occluded samples.
-    if (transmission == 0.0f)
-        return;
+    return true;
+}
+
+void DirectLightingIntegrator::add_emitting_triangle_sample_contribution(
+    const PendingLightSample&   pending_sample,
+    const float                 transmission,
+    const MISHeuristic          mis_heuristic,
+    const Dual3d&               outgoing,
+    Spectrum&                   radiance) const
+{
+    const LightSample& sample = pending_sample.m_sample;
+    const Material* material = sample.m_triangle->m_material;
+    const Material::RenderData& material_data = material->get_render_data();
+    const EDF* edf = material_data.m_edf;
+    const Vector3d& incoming = pending_sample.m_incoming;
 
     // Evaluate the BSDF (or phase function).
     Spectrum material_value;
@@ -641,8 +816,8 @@ void DirectLightingIntegrator::add_emitting_triangle_sample_contribution(
         -Vector3f(incoming),
         edf_value);
 
-    const float g = static_cast<float>(cos_on * rcp_sample_square_distance);
-    float weight = (transmission * g) / (sample.m_probability * contribution_prob);
+    const float g = static_cast<float>(pending_sample.m_cos_on * pending_sample.m_rcp_sample_square_distance);
+    float weight = (transmission * g) / (sample.m_probability * pending_sample.m_contribution_prob);
 
     // Apply MIS weighting.
     weight *=
@@ -657,43 +832,44 @@ void DirectLightingIntegrator::add_emitting_triangle_sample_contribution(
     radiance += edf_value;
 }
 
-void DirectLightingIntegrator::add_non_physical_light_sample_contribution(
-    const LightSample&          sample,
-    const Dual3d&               outgoing,
-    Spectrum&                   radiance) const
+bool DirectLightingIntegrator::prepare_non_physical_light_sample(
+    PendingLightSample&         pending_sample) const
 {
+    const LightSample& sample = pending_sample.m_sample;
     const Light* light = sample.m_light;
 
     // No contribution if we are computing indirect lighting but this light does not cast indirect light.
     if (m_indirect && !(light->get_flags() & Light::CastIndirectLight))
-        return;
+        return false;
 
     // Evaluate the light.
-    Vector3d emission_position, emission_direction;
-    Spectrum light_value(Spectrum::Illuminance);
+    Vector3d emission_direction;
+    pending_sample.m_light_value.set_intent(Spectrum::Illuminance);
     light->evaluate(
         m_shading_context,
         sample.m_light_transform,
         m_material_sampler.get_point(),
-        emission_position,
+        pending_sample.m_emission_position,
         emission_direction,
-        light_value);
+        pending_sample.m_light_value);
 
     // Compute the incoming direction in world space.
-    const Vector3d incoming = -emission_direction;
+    pending_sample.m_incoming = -emission_direction;
 
-    if (m_material_sampler.cull_incoming_direction(incoming))
-        return;
+    if (m_material_sampler.cull_incoming_direction(pending_sample.m_incoming))
+        return false;
 
-    // Compute the transmission factor between the light sample and the shading point.
-    const float transmission =
-        m_material_sampler.trace_between(
-            m_shading_context,
-            emission_position);
+    return true;
+}
 
-    // Discard occluded samples.
-    if (transmission == 0.0f)
-        return;
+void DirectLightingIntegrator::add_non_physical_light_sample_contribution(
+    const PendingLightSample&   pending_sample,
+    const float                 transmission,
+    const Dual3d&               outgoing,
+    Spectrum&                   radiance) const
+{
+    const LightSample& sample = pending_sample.m_sample;
+    const Light* light = sample.m_light;
 
     // Evaluate the BSDF (or phase function).
     Spectrum material_value;
@@ -701,15 +877,16 @@ void DirectLightingIntegrator::add_non_physical_light_sample_contribution(
         m_material_sampler.evaluate(
             m_light_sampling_modes,
             Vector3f(outgoing.get_value()),
-            Vector3f(incoming),
+            Vector3f(pending_sample.m_incoming),
             material_value);
     if (material_probability == 0.0f)
         return;
 
     // Add the contribution of this sample to the illumination.
     const float attenuation = light->compute_distance_attenuation(
-        m_material_sampler.get_point(), emission_position);
+        m_material_sampler.get_point(), pending_sample.m_emission_position);
     const float weight = transmission * attenuation / sample.m_probability;
+    Spectrum light_value = pending_sample.m_light_value;
     light_value *= weight;
     light_value *= material_value;
     radiance += light_value;
@@ -33,6 +33,7 @@
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/lighting/materialsamplers.h"
+#include "renderer/kernel/lighting/shadowraybatch.h"
 #include "renderer/kernel/shading/shadingray.h"
 
 // appleseed.foundation headers.
@@ -47,6 +48,7 @@
 // Forward declarations.
 namespace renderer  { class LightSample; }
 namespace renderer  { class LightSampler; }
+namespace renderer  { class ShaderGroup; }
 namespace renderer  { class ShadingContext; }
 namespace renderer  { class ShadingPoint; }
 
@@ -81,7 +83,9 @@ class DirectLightingIntegrator
         const size_t                material_sample_count,        // number of samples in material sampling
         const size_t                light_sample_count,           // number of samples in light sampling
         const float                 low_light_threshold,          // light contribution threshold to disable shadow rays 
-        const bool                  indirect);                    // are we computing indirect lighting?
+        const bool                  indirect,                     // are we computing indirect lighting?
+        const size_t                shadow_ray_batch_size = ShadowRayBatch::MaxSize,    // 1 to trace each shadow ray right away
+        const bool                  coherent_shading = false);    // shade the samples of a batch grouped by shader group?
 
     // Compute outgoing radiance due to direct lighting via combined BSDF and light sampling.
     void compute_outgoing_radiance_combined_sampling(
@@ -129,6 +133,11 @@ class DirectLightingIntegrator
     const size_t                        m_material_sample_count;
     const size_t                        m_light_sample_count;
     const bool                          m_indirect;
+    const size_t                        m_shadow_ray_batch_size;
+    const bool                          m_coherent_shading;
+
+    // A light sample whose shadow ray is waiting to be traced.
+    struct PendingLightSample;
 
     void take_single_material_sample(
         SamplingContext&                sampling_context,
@@ -136,15 +145,43 @@ class DirectLightingIntegrator
         const foundation::Dual3d&       outgoing,
         Spectrum&                       radiance) const;
 
-    void add_emitting_triangle_sample_contribution(
+    void add_light_sample(
         SamplingContext&                sampling_context,
         const LightSample&              sample,
         const foundation::MISHeuristic  mis_heuristic,
         const foundation::Dual3d&       outgoing,
+        ShadowRayBatch&                 shadow_rays,
+        PendingLightSample*             pending_samples,
+        Spectrum&                       radiance) const;
+
+    void add_pending_light_sample_contributions(
+        const foundation::MISHeuristic  mis_heuristic,
+        const foundation::Dual3d&       outgoing,
+        ShadowRayBatch&                 shadow_rays,
+        const PendingLightSample*       pending_samples,
+        Spectrum&                       radiance) const;
+
+    // Return the OSL shader group that shades the emitter of a light sample, or 0.
+    static const ShaderGroup* get_shader_group(
+        const PendingLightSample&       pending_sample);
+
+    bool prepare_emitting_triangle_sample(
+        SamplingContext&                sampling_context,
+        PendingLightSample&             pending_sample) const;
+
+    void add_emitting_triangle_sample_contribution(
+        const PendingLightSample&       pending_sample,
+        const float                     transmission,
+        const foundation::MISHeuristic  mis_heuristic,
+        const foundation::Dual3d&       outgoing,
         Spectrum&                       radiance) const;
 
+    bool prepare_non_physical_light_sample(
+        PendingLightSample&             pending_sample) const;
+
     void add_non_physical_light_sample_contribution(
-        const LightSample&              sample,
+        const PendingLightSample&       pending_sample,
+        const float                     transmission,
         const foundation::Dual3d&       outgoing,
         Spectrum&                       radiance) const;
 };
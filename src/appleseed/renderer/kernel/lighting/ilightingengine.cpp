@@ -37,6 +37,20 @@ using namespace foundation;
 namespace renderer
 {
 
+//
+// ILightingEngine class implementation.
+//
+
+bool ILightingEngine::is_shader_group_timing_enabled() const
+{
+    return false;
+}
+
+
+//
+// ILightingEngineFactory class implementation.
+//
+
 void ILightingEngineFactory::add_common_params_metadata(
     Dictionary& metadata,
     const bool  add_lighting_samples)
@@ -49,6 +63,22 @@ void ILightingEngineFactory::add_common_params_metadata(
             .insert("label", "Enable IBL")
             .insert("help", "Enable image-based lighting"));
 
+    metadata.dictionaries().insert(
+        "shader_group_statistics",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Shader Group Statistics")
+            .insert("help", "Time OSL shader group executions and report them per shader group"));
+
+    metadata.dictionaries().insert(
+        "coherent_shading",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Coherent Shading")
+            .insert("help", "Shade the light samples of a shadow ray batch grouped by OSL shader group"));
+
     if (add_lighting_samples)
     {
         metadata.dictionaries().insert(
@@ -64,6 +64,9 @@ class ILightingEngine
 
     // Retrieve performance statistics.
     virtual foundation::StatisticsVector get_statistics() const = 0;
+
+    // Return true if OSL shader group executions should be timed per shader group.
+    virtual bool is_shader_group_timing_enabled() const;
 };
 
 
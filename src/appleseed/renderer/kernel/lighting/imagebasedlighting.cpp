@@ -31,6 +31,7 @@
 #include "imagebasedlighting.h"
 
 // appleseed.renderer headers.
+#include "renderer/kernel/lighting/shadowraybatch.h"
 #include "renderer/kernel/lighting/tracer.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
@@ -175,6 +176,76 @@ void compute_ibl_bsdf_sampling(
         radiance /= static_cast<float>(bsdf_sample_count);
 }
 
+namespace
+{
+    // An environment sample whose shadow ray is waiting to be traced.
+    struct PendingEnvironmentSample
+    {
+        Vector3f    m_incoming;         // world space incoming direction, unit-length
+        Spectrum    m_env_value;
+        float       m_env_prob;
+    };
+
+    void add_environment_sample_contributions(
+        const ShadingContext&           shading_context,
+        const ShadingPoint&             shading_point,
+        const Dual3d&                   outgoing,
+        const BSDF&                     bsdf,
+        const void*                     bsdf_data,
+        const int                       env_sampling_modes,
+        const size_t                    bsdf_sample_count,
+        const size_t                    env_sample_count,
+        ShadowRayBatch&                 shadow_rays,
+        PendingEnvironmentSample*       pending_samples,
+        Spectrum&                       radiance)
+    {
+        const Vector3f geometric_normal(shading_point.get_geometric_normal());
+        const Basis3f shading_basis(shading_point.get_shading_basis());
+
+        // Trace all shadow rays first.
+        shadow_rays.trace(shading_context, shading_point);
+
+        for (size_t i = 0, e = shadow_rays.size(); i < e; ++i)
+        {
+            // Discard occluded samples.
+            const float transmission = shadow_rays.get_transmission(i);
+            if (transmission == 0.0f)
+                continue;
+
+            PendingEnvironmentSample& sample = pending_samples[i];
+
+            // Evaluate the BSDF.
+            Spectrum bsdf_value;
+            const float bsdf_prob =
+                bsdf.evaluate(
+                    bsdf_data,
+                    false,                          // not adjoint
+                    true,                           // multiply by |cos(incoming, normal)|
+                    geometric_normal,
+                    shading_basis,
+                    Vector3f(outgoing.get_value()),
+                    sample.m_incoming,
+                    env_sampling_modes,
+                    bsdf_value);
+            if (bsdf_prob == 0.0f)
+                continue;
+
+            // Compute MIS weight.
+            const float mis_weight =
+                mis_power2(
+                    env_sample_count * sample.m_env_prob,
+                    bsdf_sample_count * bsdf_prob);
+
+            // Add the contribution of this sample to the illumination.
+            sample.m_env_value *= transmission / sample.m_env_prob * mis_weight;
+            sample.m_env_value *= bsdf_value;
+            radiance += sample.m_env_value;
+        }
+
+        shadow_rays.clear();
+    }
+}
+
 void compute_ibl_environment_sampling(
     SamplingContext&        sampling_context,
     const ShadingContext&   shading_context,
@@ -190,7 +261,6 @@ void compute_ibl_environment_sampling(
 {
     assert(is_normalized(outgoing.get_value()));
 
-    const Vector3f geometric_normal(shading_point.get_geometric_normal());
     const Basis3f shading_basis(shading_point.get_shading_basis());
 
     radiance.set(0.0f);
@@ -201,65 +271,64 @@ void compute_ibl_environment_sampling(
 
     sampling_context.split_in_place(2, env_sample_count);
 
+    ShadowRayBatch shadow_rays;
+    PendingEnvironmentSample pending_samples[ShadowRayBatch::MaxSize];
+
     for (size_t i = 0; i < env_sample_count; ++i)
     {
         // Generate a uniform sample in [0,1)^2.
         const Vector2f s = sampling_context.next2<Vector2f>();
 
         // Sample the environment.
-        Vector3f incoming;
-        Spectrum env_value(Spectrum::Illuminance);
-        float env_prob;
+        PendingEnvironmentSample& sample = pending_samples[shadow_rays.size()];
+        sample.m_env_value.set_intent(Spectrum::Illuminance);
         environment_edf.sample(
             shading_context,
             s,
-            incoming,
-            env_value,
-            env_prob);
+            sample.m_incoming,
+            sample.m_env_value,
+            sample.m_env_prob);
 
         // Cull samples behind the shading surface.
-        assert(is_normalized(incoming));
-        const float cos_in = dot(incoming, Vector3f(shading_basis.get_normal()));
+        assert(is_normalized(sample.m_incoming));
+        const float cos_in = dot(sample.m_incoming, Vector3f(shading_basis.get_normal()));
         if (cos_in < 0.0f)
             continue;
 
-        // Discard occluded samples.
-        const float transmission =
-            shading_context.get_tracer().trace(
+        // Queue a shadow ray in the direction of the sample. The BSDF is only
+        // evaluated once we know that the sample is not occluded.
+        shadow_rays.insert(Vector3d(sample.m_incoming));
+        if (shadow_rays.full())
+        {
+            add_environment_sample_contributions(
+                shading_context,
                 shading_point,
-                Vector3d(incoming),
-                VisibilityFlags::ShadowRay);
-        if (transmission == 0.0f)
-            continue;
-
-        // Evaluate the BSDF.
-        Spectrum bsdf_value;
-        const float bsdf_prob =
-            bsdf.evaluate(
+                outgoing,
+                bsdf,
                 bsdf_data,
-                false,                          // not adjoint
-                true,                           // multiply by |cos(incoming, normal)|
-                geometric_normal,
-                shading_basis,
-                Vector3f(outgoing.get_value()),
-                incoming,
                 env_sampling_modes,
-                bsdf_value);
-        if (bsdf_prob == 0.0f)
-            continue;
-
-        // Compute MIS weight.
-        const float mis_weight =
-            mis_power2(
-                env_sample_count * env_prob,
-                bsdf_sample_count * bsdf_prob);
-
-        // Add the contribution of this sample to the illumination.
-        env_value *= transmission / env_prob * mis_weight;
-        env_value *= bsdf_value;
-        radiance += env_value;
+                bsdf_sample_count,
+                env_sample_count,
+                shadow_rays,
+                pending_samples,
+                radiance);
+        }
     }
 
+    // Trace the remaining shadow rays.
+    add_environment_sample_contributions(
+        shading_context,
+        shading_point,
+        outgoing,
+        bsdf,
+        bsdf_data,
+        env_sampling_modes,
+        bsdf_sample_count,
+        env_sample_count,
+        shadow_rays,
+        pending_samples,
+        radiance);
+
     if (env_sample_count > 1)
         radiance /= static_cast<float>(env_sample_count);
 }
@@ -141,6 +141,53 @@ LightSampler::LightSampler(const Scene& scene, const ParamArray& params)
         plural(m_emitting_triangles.size(), "triangle").c_str());
 }
 
+namespace
+{
+    template <typename EntityContainer>
+    uint64 combine_entity_signatures(
+        uint64                  signature,
+        const EntityContainer&  entities)
+    {
+        for (const_each<EntityContainer> i = entities; i; ++i)
+            signature = Entity::combine_signatures(signature, i->compute_signature());
+
+        return signature;
+    }
+
+    uint64 compute_emitters_signature(const AssemblyInstanceContainer& assembly_instances)
+    {
+        uint64 signature = 0;
+
+        for (const_each<AssemblyInstanceContainer> i = assembly_instances; i; ++i)
+        {
+            const AssemblyInstance& assembly_instance = *i;
+            const Assembly& assembly = assembly_instance.get_assembly();
+
+            signature = Entity::combine_signatures(signature, assembly_instance.compute_signature());
+            signature = Entity::combine_signatures(signature, assembly_instance.transform_sequence().compute_signature());
+            signature = Entity::combine_signatures(signature, assembly.compute_signature());
+
+            // Entities that determine which triangles emit light, their importance,
+            // and the surface areas stored into OSL shader groups.
+            signature = combine_entity_signatures(signature, assembly.lights());
+            signature = combine_entity_signatures(signature, assembly.edfs());
+            signature = combine_entity_signatures(signature, assembly.shader_groups());
+            signature = combine_entity_signatures(signature, assembly.materials());
+            signature = combine_entity_signatures(signature, assembly.objects());
+            signature = combine_entity_signatures(signature, assembly.object_instances());
+
+            signature = Entity::combine_signatures(signature, compute_emitters_signature(assembly.assembly_instances()));
+        }
+
+        return signature;
+    }
+}
+
+uint64 LightSampler::compute_signature(const Scene& scene)
+{
+    return compute_emitters_signature(scene.assembly_instances());
+}
+
 void LightSampler::collect_non_physical_lights(
     const AssemblyInstanceContainer&    assembly_instances,
     const TransformSequence&            parent_transform_seq)
@@ -181,6 +181,11 @@ class LightSampler
         const Scene&                        scene,
         const ParamArray&                   params = ParamArray());
 
+    // Compute a signature of the scene entities the light sampler depends on.
+    // A light sampler built for a scene remains valid as long as this signature
+    // doesn't change.
+    static foundation::uint64 compute_signature(const Scene& scene);
+
     // Return the number of non-physical lights in the scene.
     size_t get_non_physical_light_count() const;
 
@@ -38,6 +38,7 @@
 #include "renderer/kernel/lighting/pathtracer.h"
 #include "renderer/kernel/lighting/pathvertex.h"
 #include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/kernel/lighting/shadowraybatch.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/modeling/bsdf/bsdf.h"
@@ -112,6 +113,9 @@ namespace
             const bool      m_has_max_ray_intensity;
             const float     m_max_ray_intensity;
 
+            const bool      m_shader_group_statistics;      // time OSL shader group executions?
+            const bool      m_coherent_shading;             // shade light samples grouped by OSL shader group?
+
             float           m_rcp_dl_light_sample_count;
             float           m_rcp_ibl_env_sample_count;
 
@@ -130,6 +134,8 @@ namespace
               , m_ibl_env_sample_count(params.get_optional<float>("ibl_env_samples", 1.0f))
               , m_has_max_ray_intensity(params.strings().exist("max_ray_intensity"))
               , m_max_ray_intensity(params.get_optional<float>("max_ray_intensity", 0.0f))
+              , m_shader_group_statistics(params.get_optional<bool>("shader_group_statistics", false))
+              , m_coherent_shading(params.get_optional<bool>("coherent_shading", false))
             {
                 // Precompute the reciprocal of the number of light samples.
                 m_rcp_dl_light_sample_count =
@@ -170,7 +176,9 @@ namespace
                     "  dl light samples              %s\n"
                     "  dl light threshold            %s\n"
                     "  ibl env samples               %s\n"
-                    "  max ray intensity             %s",
+                    "  max ray intensity             %s\n"
+                    "  shader group statistics       %s\n"
+                    "  coherent shading              %s",
                     m_enable_dl ? "on" : "off",
                     m_enable_ibl ? "on" : "off",
                     m_enable_caustics ? "on" : "off",
@@ -183,7 +191,9 @@ namespace
                     pretty_scalar(m_dl_light_sample_count).c_str(),
                     pretty_scalar(m_dl_low_light_threshold, 3).c_str(),
                     pretty_scalar(m_ibl_env_sample_count).c_str(),
-                    m_has_max_ray_intensity ? pretty_scalar(m_max_ray_intensity).c_str() : "infinite");
+                    m_has_max_ray_intensity ? pretty_scalar(m_max_ray_intensity).c_str() : "infinite",
+                    m_shader_group_statistics ? "on" : "off",
+                    m_coherent_shading ? "on" : "off");
             }
         };
 
@@ -273,6 +283,11 @@ namespace
             return StatisticsVector::make("path tracing statistics", stats);
         }
 
+        virtual bool is_shader_group_timing_enabled() const override
+        {
+            return m_params.m_shader_group_statistics;
+        }
+
       private:
         const Parameters                m_params;
         const LightSampler&             m_light_sampler;
@@ -643,7 +658,9 @@ namespace
                     1,                  // bsdf_sample_count
                     light_sample_count,
                     m_params.m_dl_low_light_threshold,
-                    m_is_indirect_lighting);
+                    m_is_indirect_lighting,
+                    ShadowRayBatch::MaxSize,
+                    m_params.m_coherent_shading);
                 integrator.compute_outgoing_radiance_light_sampling_low_variance(
                     m_sampling_context,
                     MISPower2,
@@ -0,0 +1,70 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "shadowraybatch.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/materialsamplers.h"
+#include "renderer/kernel/lighting/tracer.h"
+#include "renderer/kernel/shading/shadingcontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+
+using namespace foundation;
+
+namespace renderer
+{
+
+//
+// ShadowRayBatch class implementation.
+//
+
+void ShadowRayBatch::trace_between(
+    const ShadingContext&   shading_context,
+    const IMaterialSampler& material_sampler)
+{
+    for (size_t i = 0; i < m_size; ++i)
+        m_transmissions[i] = material_sampler.trace_between(shading_context, m_targets[i]);
+}
+
+void ShadowRayBatch::trace(
+    const ShadingContext&   shading_context,
+    const ShadingPoint&     shading_point)
+{
+    for (size_t i = 0; i < m_size; ++i)
+    {
+        m_transmissions[i] =
+            shading_context.get_tracer().trace(
+                shading_point,
+                m_targets[i],
+                VisibilityFlags::ShadowRay);
+    }
+}
+
+}   // namespace renderer
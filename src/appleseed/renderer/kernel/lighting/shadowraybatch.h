@@ -0,0 +1,152 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_LIGHTING_SHADOWRAYBATCH_H
+#define APPLESEED_RENDERER_KERNEL_LIGHTING_SHADOWRAYBATCH_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/vector.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+// Forward declarations.
+namespace renderer  { class IMaterialSampler; }
+namespace renderer  { class ShadingContext; }
+namespace renderer  { class ShadingPoint; }
+
+namespace renderer
+{
+
+//
+// A batch of shadow rays cast from a single point.
+//
+// Light samples are first culled using cheap geometric tests only. The shadow rays of
+// the surviving samples are queued and traced back-to-back, without any shading work
+// in between. Only then are the materials and emitters of the unoccluded samples
+// evaluated, so that occluded samples never pay for BSDF, EDF or OSL evaluation.
+//
+// A batch of size 1 traces every shadow ray as soon as it is queued, which is exactly
+// equivalent to not batching shadow rays at all.
+//
+// All the shadow rays of a batch must be of the same kind: either toward target points
+// (traced with trace_between()) or along directions (traced with trace()).
+//
+
+class ShadowRayBatch
+  : public foundation::NonCopyable
+{
+  public:
+    enum { MaxSize = 16 };
+
+    // Constructor.
+    explicit ShadowRayBatch(const size_t max_size = MaxSize);
+
+    size_t size() const;
+    bool empty() const;
+    bool full() const;
+
+    // Queue a shadow ray toward a target point or along a direction.
+    // Return the index of the shadow ray in the batch.
+    size_t insert(const foundation::Vector3d& target);
+
+    // Trace shadow rays from the point of a material sampler to all queued target points.
+    void trace_between(
+        const ShadingContext&           shading_context,
+        const IMaterialSampler&         material_sampler);
+
+    // Trace shadow rays from a shading point along all queued directions.
+    void trace(
+        const ShadingContext&           shading_context,
+        const ShadingPoint&             shading_point);
+
+    // Return the transmission along a given shadow ray. Only valid after tracing.
+    float get_transmission(const size_t index) const;
+
+    // Remove all shadow rays from the batch.
+    void clear();
+
+  private:
+    const size_t                        m_max_size;
+    size_t                              m_size;
+    foundation::Vector3d                m_targets[MaxSize];
+    float                               m_transmissions[MaxSize];
+};
+
+
+//
+// ShadowRayBatch class implementation.
+//
+
+inline ShadowRayBatch::ShadowRayBatch(const size_t max_size)
+  : m_max_size(max_size)
+  , m_size(0)
+{
+    assert(m_max_size > 0);
+    assert(m_max_size <= MaxSize);
+}
+
+inline size_t ShadowRayBatch::size() const
+{
+    return m_size;
+}
+
+inline bool ShadowRayBatch::empty() const
+{
+    return m_size == 0;
+}
+
+inline bool ShadowRayBatch::full() const
+{
+    return m_size == m_max_size;
+}
+
+inline size_t ShadowRayBatch::insert(const foundation::Vector3d& target)
+{
+    assert(!full());
+
+    m_targets[m_size] = target;
+    return m_size++;
+}
+
+inline float ShadowRayBatch::get_transmission(const size_t index) const
+{
+    assert(index < m_size);
+    return m_transmissions[index];
+}
+
+inline void ShadowRayBatch::clear()
+{
+    m_size = 0;
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_SHADOWRAYBATCH_H
@@ -36,6 +36,7 @@
 #include "renderer/kernel/lighting/pathtracer.h"
 #include "renderer/kernel/lighting/pathvertex.h"
 #include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/kernel/lighting/shadowraybatch.h"
 #include "renderer/kernel/lighting/sppm/sppmpasscallback.h"
 #include "renderer/kernel/lighting/sppm/sppmphoton.h"
 #include "renderer/kernel/lighting/sppm/sppmphotonmap.h"
@@ -195,6 +196,11 @@ namespace
             return StatisticsVector::make("sppm statistics", stats);
         }
 
+        virtual bool is_shader_group_timing_enabled() const override
+        {
+            return m_params.m_shader_group_statistics;
+        }
+
       private:
         const SPPMParameters            m_params;
         const SPPMPassCallback&         m_pass_callback;
@@ -333,7 +339,9 @@ namespace
                     bsdf_sample_count,
                     light_sample_count,
                     m_params.m_dl_low_light_threshold,
-                    false);             // not computing indirect lighting
+                    false,              // not computing indirect lighting
+                    ShadowRayBatch::MaxSize,
+                    m_params.m_coherent_shading);
 
                 // Always sample both the lights and the BSDF.
                 integrator.compute_outgoing_radiance_combined_sampling_low_variance(
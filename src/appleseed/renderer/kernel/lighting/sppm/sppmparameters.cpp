@@ -117,6 +117,8 @@ SPPMParameters::SPPMParameters(const ParamArray& params)
   , m_dl_low_light_threshold(params.get_optional<float>("dl_low_light_threshold", 0.0f))
   , m_view_photons(params.get_optional<bool>("view_photons", false))
   , m_view_photons_radius(params.get_optional<float>("view_photons_radius", 1.0e-3f))
+  , m_shader_group_statistics(params.get_optional<bool>("shader_group_statistics", false))
+  , m_coherent_shading(params.get_optional<bool>("coherent_shading", false))
 {
     // Precompute the reciprocal of the number of light samples.
     m_rcp_dl_light_sample_count =
@@ -156,14 +158,16 @@ void SPPMParameters::print() const
         "  alpha                         %s\n"
         "  max photons per estimate      %s\n"
         "  dl light samples              %s\n"
-        "  dl light threshold            %s",
+        "  dl light threshold            %s\n"
+        "  coherent shading              %s",
         m_path_tracing_max_bounces == ~0 ? "infinite" : pretty_uint(m_path_tracing_max_bounces).c_str(),
         m_path_tracing_rr_min_path_length == ~0 ? "infinite" : pretty_uint(m_path_tracing_rr_min_path_length).c_str(),
         pretty_scalar(m_initial_radius_percents, 3).c_str(),
         pretty_scalar(m_alpha, 1).c_str(),
         pretty_uint(m_max_photons_per_estimate).c_str(),
         pretty_scalar(m_dl_light_sample_count).c_str(),
-        pretty_scalar(m_dl_low_light_threshold, 3).c_str());
+        pretty_scalar(m_dl_low_light_threshold, 3).c_str(),
+        m_coherent_shading ? "on" : "off");
 }
 
 }   // namespace renderer
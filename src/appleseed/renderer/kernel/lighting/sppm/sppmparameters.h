@@ -77,6 +77,9 @@ struct SPPMParameters
     const bool                  m_view_photons;                         // debug mode to visualize the photons
     const float                 m_view_photons_radius;                  // lookup radius when visualizing photons
 
+    const bool                  m_shader_group_statistics;              // time OSL shader group executions?
+    const bool                  m_coherent_shading;                     // shade light samples grouped by OSL shader group?
+
     explicit SPPMParameters(const ParamArray& params);
 
     void print() const;
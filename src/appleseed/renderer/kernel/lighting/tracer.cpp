@@ -36,11 +36,19 @@
 #include "renderer/modeling/camera/camera.h"
 #include "renderer/modeling/input/source.h"
 #include "renderer/modeling/material/material.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/objectinstance.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/modeling/shadergroup/shadergroup.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/hash.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/string.h"
+#include "foundation/utility/uid.h"
 
 // Standard headers.
 #include <string>
@@ -57,14 +65,23 @@ Tracer::Tracer(
     OSLShaderGroupExec&         shadergroup_exec,
     const float                 transparency_threshold,
     const size_t                max_iterations,
-    const bool                  print_details)
+    const bool                  print_details,
+    const size_t                alpha_cache_resolution)
   : m_intersector(intersector)
   , m_texture_cache(texture_cache)
   , m_shadergroup_exec(shadergroup_exec)
   , m_assume_no_alpha_mapping(!scene.uses_alpha_mapping())
   , m_transmission_threshold(transparency_threshold)
   , m_max_iterations(max_iterations)
+  , m_alpha_cache_resolution(static_cast<float>(alpha_cache_resolution))
 {
+    for (size_t i = 0; i < AlphaCacheSize; ++i)
+    {
+        m_alpha_cache[i].m_assembly_instance_uid = ~UniqueID(0);
+        m_alpha_cache[i].m_object_instance_uid = ~UniqueID(0);
+        m_alpha_cache[i].m_material_uid = ~UniqueID(0);
+    }
+
     if (print_details)
     {
         if (m_assume_no_alpha_mapping)
@@ -130,15 +147,14 @@ const ShadingPoint& Tracer::do_trace(
         if (material == 0)
             break;
 
-        Alpha alpha;
-        evaluate_alpha(*material, *shading_point_ptr, alpha);
+        const float alpha = evaluate_alpha(*material, *shading_point_ptr);
 
         // Stop at the first fully opaque occluder.
-        if (alpha[0] >= 1.0f)
+        if (alpha >= 1.0f)
             break;
 
         // Update the transmission factor.
-        transmission *= 1.0f - alpha[0];
+        transmission *= 1.0f - alpha;
 
         // Stop once we hit full opacity.
         if (transmission < m_transmission_threshold)
@@ -212,15 +228,14 @@ const ShadingPoint& Tracer::do_trace_between(
             break;
 
         // Evaluate the alpha map at the shading point.
-        Alpha alpha;
-        evaluate_alpha(*material, *shading_point_ptr, alpha);
+        const float alpha = evaluate_alpha(*material, *shading_point_ptr);
 
         // Stop at the first fully opaque occluder.
-        if (alpha[0] >= 1.0f)
+        if (alpha >= 1.0f)
             break;
 
         // Update the transmission factor.
-        transmission *= 1.0f - alpha[0];
+        transmission *= 1.0f - alpha;
 
         // Stop once we hit full opacity.
         if (transmission < m_transmission_threshold)
@@ -233,12 +248,83 @@ const ShadingPoint& Tracer::do_trace_between(
     return *shading_point_ptr;
 }
 
-void Tracer::evaluate_alpha(
+float Tracer::evaluate_alpha(
+    const Material&             material,
+    const ShadingPoint&         shading_point)
+{
+    const Material::RenderData& material_data = material.get_render_data();
+
+    if (shading_point.is_curve_primitive())
+    {
+        // Alpha maps are not applied to curves.
+        return
+            material_data.m_has_constant_alpha
+                ? 1.0f
+                : evaluate_varying_alpha(material, shading_point);
+    }
+
+    const Source* object_alpha_map = shading_point.get_object().get_alpha_map();
+
+    // Fast path: alpha is the same everywhere on this surface.
+    if (material_data.m_has_constant_alpha &&
+        (object_alpha_map == 0 || object_alpha_map->is_uniform()))
+    {
+        float alpha = material_data.m_constant_alpha;
+
+        if (object_alpha_map)
+        {
+            Alpha object_alpha;
+            object_alpha_map->evaluate_uniform(object_alpha);
+            alpha *= object_alpha[0];
+        }
+
+        return alpha;
+    }
+
+    if (m_alpha_cache_resolution == 0.0f)
+        return evaluate_varying_alpha(material, shading_point);
+
+    // Compute the alpha cache key.
+    const Vector2f& uv = shading_point.get_uv(0);
+    const uint32 cell_x = static_cast<uint32>(static_cast<int32>(fast_floor(uv[0] * m_alpha_cache_resolution)));
+    const uint32 cell_y = static_cast<uint32>(static_cast<int32>(fast_floor(uv[1] * m_alpha_cache_resolution)));
+    const uint64 assembly_instance_uid = shading_point.get_assembly_instance().get_uid();
+    const uint64 object_instance_uid = shading_point.get_object_instance().get_uid();
+    const uint64 primitive_index = static_cast<uint64>(shading_point.get_primitive_index());
+    const uint64 cell = (static_cast<uint64>(cell_x) << 32) | cell_y;
+
+    // The material depends on the side of the surface that was hit.
+    const uint64 material_uid = material.get_uid();
+
+    // Look up the alpha cache.
+    const uint64 h =
+        mix_uint64(
+            mix_uint64(assembly_instance_uid, object_instance_uid, primitive_index, cell),
+            material_uid);
+    AlphaCacheEntry& entry = m_alpha_cache[h & (AlphaCacheSize - 1)];
+    if (entry.m_assembly_instance_uid == assembly_instance_uid &&
+        entry.m_object_instance_uid == object_instance_uid &&
+        entry.m_primitive_index == primitive_index &&
+        entry.m_cell == cell &&
+        entry.m_material_uid == material_uid)
+        return entry.m_alpha;
+
+    // Evaluate alpha and store it into the cache.
+    entry.m_assembly_instance_uid = assembly_instance_uid;
+    entry.m_object_instance_uid = object_instance_uid;
+    entry.m_primitive_index = primitive_index;
+    entry.m_cell = cell;
+    entry.m_material_uid = material_uid;
+    entry.m_alpha = evaluate_varying_alpha(material, shading_point);
+
+    return entry.m_alpha;
+}
+
+float Tracer::evaluate_varying_alpha(
     const Material&             material,
-    const ShadingPoint&         shading_point,
-    Alpha&                      alpha) const
+    const ShadingPoint&         shading_point) const
 {
-    alpha = shading_point.get_alpha();
+    Alpha alpha = shading_point.get_alpha();
 
     // Apply OSL transparency if needed.
     if (const ShaderGroup* sg = material.get_render_data().m_shader_group)
@@ -250,6 +336,8 @@ void Tracer::evaluate_alpha(
             alpha *= a;
         }
     }
+
+    return alpha[0];
 }
 
 }   // namespace renderer
@@ -40,6 +40,7 @@
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 
 // Standard headers.
 #include <cstddef>
@@ -59,6 +60,16 @@ namespace renderer
 // point-to-point visibility. It automatically takes into account alpha
 // transparency.
 //
+// Alpha is not evaluated at all on surfaces whose alpha is known to be the
+// same everywhere. Otherwise, when a nonzero alpha cache resolution is given,
+// the alpha of partially transparent surfaces is cached per primitive and per
+// cell of a regular grid in UV space, so that shadow rays crossing the same
+// regions of layered transparent surfaces (foliage, particles, glass panes)
+// don't repeatedly execute alpha maps and OSL transparency shaders. The cache
+// is lossy and disabled by default: each cell shares the alpha of its first hit,
+// which is wrong for alpha maps finer than a cell and for transparency shaders
+// that depend on anything else than UV coordinates.
+//
 
 class Tracer
   : public foundation::NonCopyable
@@ -72,7 +83,8 @@ class Tracer
         OSLShaderGroupExec&             shadergroup_exec,
         const float                     transparency_threshold = 0.001f,
         const size_t                    max_iterations = 1000,
-        const bool                      print_details = true);
+        const bool                      print_details = true,
+        const size_t                    alpha_cache_resolution = 0);    // in cells per unit of UV space, 0 to disable
 
     // Compute the transmission in a given direction. Returns the intersection
     // with the closest fully opaque occluder and the transmission factor up
@@ -137,13 +149,27 @@ class Tracer
         const VisibilityFlags::Type     ray_flags);
 
   private:
+    struct AlphaCacheEntry
+    {
+        foundation::uint64              m_assembly_instance_uid;
+        foundation::uint64              m_object_instance_uid;
+        foundation::uint64              m_primitive_index;
+        foundation::uint64              m_cell;
+        foundation::uint64              m_material_uid;
+        float                           m_alpha;
+    };
+
+    enum { AlphaCacheSize = 1024 };     // must be a power of two
+
     const Intersector&                  m_intersector;
     TextureCache&                       m_texture_cache;
     OSLShaderGroupExec&                 m_shadergroup_exec;
     const bool                          m_assume_no_alpha_mapping;
     const float                         m_transmission_threshold;
     const size_t                        m_max_iterations;
+    const float                         m_alpha_cache_resolution;
     ShadingPoint                        m_shading_points[2];
+    AlphaCacheEntry                     m_alpha_cache[AlphaCacheSize];
 
     const ShadingPoint& do_trace(
         const foundation::Vector3d&     origin,
@@ -163,10 +189,13 @@ class Tracer
         float&                          transmission,
         const ShadingPoint*             parent_shading_point);
 
-    void evaluate_alpha(
+    float evaluate_alpha(
+        const Material&                 material,
+        const ShadingPoint&             shading_point);
+
+    float evaluate_varying_alpha(
         const Material&                 material,
-        const ShadingPoint&             shading_point,
-        Alpha&                          alpha) const;
+        const ShadingPoint&             shading_point) const;
 };
 
 
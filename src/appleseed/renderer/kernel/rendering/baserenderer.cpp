@@ -137,17 +137,6 @@ bool BaseRenderer::initialize_shading_system(
 
 void BaseRenderer::initialize_oiio()
 {
-    const ParamArray& params = m_params.child("texture_store");
-
-    const size_t texture_cache_size_bytes =
-        params.get_optional<size_t>("max_size", 256 * 1024 * 1024);
-    RENDERER_LOG_INFO(
-        "setting oiio texture cache size to %s.",
-        pretty_size(texture_cache_size_bytes).c_str());
-    const float texture_cache_size_mb =
-        static_cast<float>(texture_cache_size_bytes) / (1024 * 1024);
-    m_texture_system->attribute("max_memory_MB", texture_cache_size_mb);
-
     string prev_search_path;
     m_texture_system->getattribute("searchpath", prev_search_path);
 
@@ -52,6 +52,7 @@
 #include "foundation/utility/string.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <memory>
@@ -169,6 +170,8 @@ namespace
                     m_frame,
                     m_params.m_tile_ordering,
                     m_params.m_pass_count,
+                    m_params.m_first_pass,
+                    m_params.m_last_pass,
                     m_tile_renderers,
                     m_tile_callbacks,
                     m_pass_callback,
@@ -217,11 +220,15 @@ namespace
             const size_t                        m_thread_count;     // number of rendering threads
             const TileJobFactory::TileOrdering  m_tile_ordering;    // tile rendering order
             const size_t                        m_pass_count;       // number of rendering passes
+            const size_t                        m_first_pass;       // first pass to render
+            const size_t                        m_last_pass;        // last pass to render
 
             explicit Parameters(const ParamArray& params)
               : m_thread_count(get_rendering_thread_count(params))
               , m_tile_ordering(get_tile_ordering(params))
               , m_pass_count(params.get_optional<size_t>("passes", 1))
+              , m_first_pass(params.get_optional<size_t>("first_pass", 0))
+              , m_last_pass(min(params.get_optional<size_t>("last_pass", m_pass_count - 1), m_pass_count - 1))
             {
             }
 
@@ -267,6 +274,8 @@ namespace
                 const Frame&                        frame,
                 const TileJobFactory::TileOrdering  tile_ordering,
                 const size_t                        pass_count,
+                const size_t                        first_pass,
+                const size_t                        last_pass,
                 vector<ITileRenderer*>&             tile_renderers,
                 vector<ITileCallback*>&             tile_callbacks,
                 IPassCallback*                      pass_callback,
@@ -276,6 +285,8 @@ namespace
               : m_frame(frame)
               , m_tile_ordering(tile_ordering)
               , m_pass_count(pass_count)
+              , m_first_pass(first_pass)
+              , m_last_pass(last_pass)
               , m_tile_renderers(tile_renderers)
               , m_tile_callbacks(tile_callbacks)
               , m_pass_callback(pass_callback)
@@ -287,7 +298,10 @@ namespace
 
             void operator()()
             {
-                for (size_t pass = 0; pass < m_pass_count && !m_abort_switch.is_aborted(); ++pass)
+                // When only a range of passes is rendered (e.g. to merge it later with other
+                // ranges rendered by other processes), passes keep their index in the full
+                // sequence so that they are seeded exactly as in a full render.
+                for (size_t pass = m_first_pass; pass <= m_last_pass && !m_abort_switch.is_aborted(); ++pass)
                 {
                     if (m_pass_count > 1)
                         RENDERER_LOG_INFO("--- beginning pass %s ---", pretty_uint(pass + 1).c_str());
@@ -338,6 +352,8 @@ namespace
             vector<ITileCallback*>&                 m_tile_callbacks;
             IPassCallback*                          m_pass_callback;
             const size_t                            m_pass_count;
+            const size_t                            m_first_pass;
+            const size_t                            m_last_pass;
             JobQueue&                               m_job_queue;
             IAbortSwitch&                           m_abort_switch;
             bool&                                   m_is_rendering;
@@ -45,15 +45,18 @@
 // appleseed.foundation headers.
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/image.h"
+#include "foundation/math/mortoncode.h"
 #include "foundation/math/population.h"
 #include "foundation/math/qmc.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/statistics.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <vector>
 
@@ -92,6 +95,7 @@ namespace
           , m_window_width_next_pow2(next_power(static_cast<double>(m_window_width), 2.0))
           , m_window_height_next_pow3(next_power(static_cast<double>(m_window_height), 3.0))
         {
+            set_coherent_ordering(m_params.m_coherent_sample_order);
         }
 
         virtual void release() override
@@ -121,9 +125,11 @@ namespace
         struct Parameters
         {
             const SamplingContext::Mode     m_sampling_mode;
+            const bool                      m_coherent_sample_order;
 
             explicit Parameters(const ParamArray& params)
               : m_sampling_mode(get_sampling_context_mode(params))
+              , m_coherent_sample_order(params.get_optional<bool>("coherent_sample_order", false))
             {
             }
         };
@@ -145,21 +151,54 @@ namespace
 
         Population<uint64>                  m_total_sampling_dim;
 
-        virtual size_t generate_samples(
+        // Compute the position of a sample in the padded crop window and the coordinates
+        // of its pixel in the crop window. Return false if the sample falls outside the frame.
+        bool compute_sample_position(
             const size_t                    sequence_index,
-            SampleVector&                   samples) override
+            Vector2d&                       t,
+            int&                            x,
+            int&                            y) const
         {
             // Compute the sample position in NDC.
             const size_t Bases[2] = { 2, 3 };
             const Vector2d s = halton_sequence<double, 2>(Bases, sequence_index);
 
             // Compute the coordinates of the pixel in the padded crop window.
-            const Vector2d t(s[0] * m_window_width_next_pow2, s[1] * m_window_height_next_pow3);
-            const int x = truncate<int>(t[0]);
-            const int y = truncate<int>(t[1]);
+            t = Vector2d(s[0] * m_window_width_next_pow2, s[1] * m_window_height_next_pow3);
+            x = truncate<int>(t[0]);
+            y = truncate<int>(t[1]);
 
             // Reject samples that fall outside the actual frame.
-            if (x >= m_window_width || y >= m_window_height)
+            return x < m_window_width && y < m_window_height;
+        }
+
+        virtual bool compute_sorting_key(
+            const size_t                    sequence_index,
+            uint32&                         key) override
+        {
+            Vector2d t;
+            int x, y;
+
+            if (!compute_sample_position(sequence_index, t, x, y))
+                return false;
+
+            // Sort samples along a Z-order curve over the pixels of the crop window.
+            key =
+                morton_code(
+                    min<uint32>(static_cast<uint32>(x), 65535),
+                    min<uint32>(static_cast<uint32>(y), 65535));
+
+            return true;
+        }
+
+        virtual size_t generate_samples(
+            const size_t                    sequence_index,
+            SampleVector&                   samples) override
+        {
+            Vector2d t;
+            int x, y;
+
+            if (!compute_sample_position(sequence_index, t, x, y))
                 return 0;
 
             // Transform the sample position back to NDC. Full precision divisions are required
@@ -246,6 +285,21 @@ ISampleGenerator* GenericSampleGeneratorFactory::create(
             generator_count);
 }
 
+Dictionary GenericSampleGeneratorFactory::get_params_metadata()
+{
+    Dictionary metadata;
+
+    metadata.dictionaries().insert(
+        "coherent_sample_order",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Coherent Sample Order")
+            .insert("help", "Render the samples of each job sorted by image position rather than in sequence order"));
+
+    return metadata;
+}
+
 SampleAccumulationBuffer* GenericSampleGeneratorFactory::create_sample_accumulation_buffer()
 {
     const CanvasProperties& props = m_frame.image().properties();
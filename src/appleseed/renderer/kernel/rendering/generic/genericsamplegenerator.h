@@ -41,9 +41,10 @@
 #include <cstddef>
 
 // Forward declarations.
-namespace renderer  { class Frame; }
-namespace renderer  { class ISampleRendererFactory; }
-namespace renderer  { class SampleAccumulationBuffer; }
+namespace foundation    { class Dictionary; }
+namespace renderer      { class Frame; }
+namespace renderer      { class ISampleRendererFactory; }
+namespace renderer      { class SampleAccumulationBuffer; }
 
 namespace renderer
 {
@@ -69,6 +70,9 @@ class GenericSampleGeneratorFactory
     // Create an accumulation buffer for this sample generator.
     virtual SampleAccumulationBuffer* create_sample_accumulation_buffer() override;
 
+    // Return the metadata of the generic sample generator parameters.
+    static foundation::Dictionary get_params_metadata();
+
   private:
     const Frame&                m_frame;
     ISampleRendererFactory*     m_sample_renderer_factory;
@@ -122,7 +122,8 @@ namespace
                 m_shadergroup_exec,
                 m_params.m_transparency_threshold,
                 m_params.m_max_iterations,
-                thread_index == 0)
+                thread_index == 0,
+                m_params.m_alpha_cache_resolution)
           , m_shading_context(
                 m_intersector,
                 m_tracer,
@@ -140,6 +141,9 @@ namespace
             const CanvasProperties& c = frame.image().properties();
             m_image_point_dx = Vector2d(1.0 / (4.0 * c.m_canvas_width), 0.0);
             m_image_point_dy = Vector2d(0.0, -1.0 / (4.0 * c.m_canvas_height));
+
+            if (m_lighting_engine->is_shader_group_timing_enabled())
+                m_shadergroup_exec.enable_shader_group_timing();
         }
 
         ~GenericSampleRenderer()
@@ -302,6 +306,7 @@ namespace
             stats.merge(m_texture_cache.get_statistics());
             stats.merge(m_intersector.get_statistics());
             stats.merge(m_lighting_engine->get_statistics());
+            stats.merge(m_shadergroup_exec.get_statistics());
             return stats;
         }
 
@@ -310,11 +315,13 @@ namespace
         {
             const float     m_transparency_threshold;
             const size_t    m_max_iterations;
+            const size_t    m_alpha_cache_resolution;
             const bool      m_report_self_intersections;
 
             explicit Parameters(const ParamArray& params)
               : m_transparency_threshold(params.get_optional<float>("transparency_threshold", 0.001f))
               , m_max_iterations(params.get_optional<size_t>("max_iterations", 1000))
+              , m_alpha_cache_resolution(params.get_optional<size_t>("alpha_cache_resolution", 0))
               , m_report_self_intersections(params.get_optional<bool>("report_self_intersections", false))
             {
             }
@@ -0,0 +1,81 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_ISEQUENCECALLBACK_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_ISEQUENCECALLBACK_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace renderer  { class Project; }
+
+namespace renderer
+{
+
+//
+// Sequence callback interface.
+//
+// A sequence callback updates the project between the frames of a sequence
+// rendered with MasterRenderer::render_sequence(), and typically writes each
+// frame to disk once it is rendered.
+//
+// Between frames, only the transforms and parameters of existing entities may
+// be changed: caches such as the texture store are kept from one frame to the
+// next and assume that no entity is created or destroyed.
+//
+
+class APPLESEED_DLLSYMBOL ISequenceCallback
+  : public foundation::NonCopyable
+{
+  public:
+    // Destructor.
+    virtual ~ISequenceCallback() {}
+
+    // This method is called before a frame of the sequence is rendered.
+    // Return false to stop rendering the sequence.
+    virtual bool on_frame_begin(
+        Project&        project,
+        const size_t    frame) = 0;
+
+    // This method is called after a frame of the sequence is rendered.
+    // Return false to stop rendering the sequence.
+    virtual bool on_frame_end(
+        Project&        project,
+        const size_t    frame) = 0;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_ISEQUENCECALLBACK_H
@@ -32,10 +32,16 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/intersection/bvhcache.h"
+#include "renderer/kernel/intersection/tracecontext.h"
+#include "renderer/kernel/intersection/triangletreestore.h"
+#include "renderer/kernel/lighting/lightsampler.h"
 #include "renderer/kernel/rendering/iframerenderer.h"
+#include "renderer/kernel/rendering/isequencecallback.h"
 #include "renderer/kernel/rendering/renderercomponents.h"
 #include "renderer/kernel/rendering/serialrenderercontroller.h"
 #include "renderer/kernel/rendering/serialtilecallback.h"
+#include "renderer/kernel/texturing/texturememoryarbiter.h"
 #include "renderer/kernel/texturing/texturestore.h"
 #include "renderer/modeling/display/display.h"
 #include "renderer/modeling/entity/onframebeginrecorder.h"
@@ -43,6 +49,7 @@
 #include "renderer/modeling/input/inputbinder.h"
 #include "renderer/modeling/project/project.h"
 #include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/settingsparsing.h"
 
 // appleseed.foundation headers.
 #include "foundation/platform/compiler.h"
@@ -50,6 +57,7 @@
 #include "foundation/utility/job/iabortswitch.h"
 #include "foundation/utility/otherwise.h"
 #include "foundation/utility/statistics.h"
+#include "foundation/utility/string.h"
 
 // Standard headers.
 #include <cassert>
@@ -77,6 +85,14 @@ MasterRenderer::MasterRenderer(
   , m_serial_renderer_controller(0)
   , m_serial_tile_callback_factory(0)
   , m_display(0)
+  , m_input_binder(new InputBinder())
+  , m_light_sampler(0)
+  , m_light_sampler_signature(0)
+  , m_texture_store(0)
+  , m_texture_store_signature(0)
+  , m_rendering_sequence(false)
+  , m_update_stopwatch(0)
+  , m_pending_update(IRendererController::ContinueRendering)
 {
     if (m_tile_callback_factory == 0)
     {
@@ -100,6 +116,14 @@ MasterRenderer::MasterRenderer(
   , m_serial_tile_callback_factory(
         new SerialTileCallbackFactory(m_serial_renderer_controller))
   , m_display(0)
+  , m_input_binder(new InputBinder())
+  , m_light_sampler(0)
+  , m_light_sampler_signature(0)
+  , m_texture_store(0)
+  , m_texture_store_signature(0)
+  , m_rendering_sequence(false)
+  , m_update_stopwatch(0)
+  , m_pending_update(IRendererController::ContinueRendering)
 {
     m_renderer_controller = m_serial_renderer_controller;
     m_tile_callback_factory = m_serial_tile_callback_factory;
@@ -110,6 +134,9 @@ MasterRenderer::~MasterRenderer()
     if (m_display)
         m_display->close();
 
+    delete m_texture_store;
+    delete m_light_sampler;
+    delete m_input_binder;
     delete m_serial_tile_callback_factory;
     delete m_serial_renderer_controller;
 }
@@ -134,6 +161,58 @@ bool MasterRenderer::render()
         return false;
     }
 
+    const bool success = try_render();
+
+    // Frames of a sequence share the texture store.
+    if (!m_rendering_sequence)
+        release_texture_store();
+
+    return success;
+}
+
+bool MasterRenderer::render_sequence(
+    ISequenceCallback&      sequence_callback,
+    const size_t            first_frame,
+    const size_t            last_frame)
+{
+    assert(first_frame <= last_frame);
+
+    m_rendering_sequence = true;
+
+    bool success = true;
+
+    for (size_t frame = first_frame; frame <= last_frame; ++frame)
+    {
+        if (!sequence_callback.on_frame_begin(m_project, frame))
+        {
+            success = false;
+            break;
+        }
+
+        RENDERER_LOG_INFO("rendering frame " FMT_SIZE_T " of the sequence...", frame);
+
+        if (!render())
+        {
+            success = false;
+            break;
+        }
+
+        if (!sequence_callback.on_frame_end(m_project, frame))
+        {
+            success = false;
+            break;
+        }
+    }
+
+    m_rendering_sequence = false;
+
+    release_texture_store();
+
+    return success;
+}
+
+bool MasterRenderer::try_render()
+{
     try
     {
         return do_render();
@@ -179,6 +258,9 @@ bool MasterRenderer::do_render()
             return false;
 
           case IRendererController::ReinitializeRendering:
+            // Entities may have been destroyed, even during a sequence.
+            begin_update(status);
+            release_texture_store();
             break;
 
           assert_otherwise;
@@ -217,6 +299,9 @@ IRendererController::Status MasterRenderer::initialize_and_render_frame_sequence
     // Construct an abort switch based on the renderer controller.
     RendererControllerAbortSwitch abort_switch(*m_renderer_controller);
 
+    // Scene preparation uses as many threads as rendering.
+    m_project.set_thread_count(get_rendering_thread_count(m_params));
+
     // We start by expanding all procedural assemblies.
     if (!m_project.get_scene()->expand_procedural_assemblies(m_project, &abort_switch))
         return IRendererController::AbortRendering;
@@ -225,17 +310,26 @@ IRendererController::Status MasterRenderer::initialize_and_render_frame_sequence
     if (!bind_scene_entities_inputs())
         return IRendererController::AbortRendering;
 
-    m_project.update_trace_context();
+    // Configure the BVH cache before the trees of the trace context are built.
+    BVHCache::configure(m_params.child("bvh_cache"));
+
+    // The memory budget of the triangle trees is a setting of this render's trace context.
+    m_project.update_trace_context(m_params.child("triangle_tree_store"));
     m_project.get_frame()->print_settings();
 
-    // Create the texture store.
-    TextureStore texture_store(
-        *m_project.get_scene(),
-        m_params.child("texture_store"));
+    // Create the texture store or reuse the one of the previous frame of the sequence.
+    TextureStore& texture_store = update_texture_store();
 
     if (!initialize_shading_system(texture_store, abort_switch))
         return IRendererController::AbortRendering;
 
+    // Share the texture memory budget between the texture store and OIIO's texture cache.
+    TextureMemoryArbiter texture_memory_arbiter(
+        *m_project.get_scene(),
+        texture_store,
+        *m_texture_system,
+        m_params.child("texture_store"));
+
     // Don't proceed further if rendering was aborted.
     if (abort_switch.is_aborted())
         return m_renderer_controller->get_status();
@@ -249,6 +343,7 @@ IRendererController::Status MasterRenderer::initialize_and_render_frame_sequence
         m_project,
         m_params,
         m_tile_callback_factory,
+        update_light_sampler(),
         texture_store,
         *m_texture_system,
         *m_shading_system);
@@ -257,19 +352,29 @@ IRendererController::Status MasterRenderer::initialize_and_render_frame_sequence
 
     // Execute the main rendering loop.
     const IRendererController::Status status =
-        render_frame_sequence(components, abort_switch);
+        render_frame_sequence(components, texture_memory_arbiter, abort_switch);
 
     // Perform post-render rendering actions.
     m_project.get_scene()->on_render_end(m_project);
 
-    // Print texture store performance statistics.
-    RENDERER_LOG_DEBUG("%s", texture_store.get_statistics().to_string().c_str());
+    // Print texture performance statistics.
+    RENDERER_LOG_DEBUG("%s", texture_memory_arbiter.get_statistics().to_string().c_str());
+
+    // Print BVH cache statistics.
+    if (BVHCache::is_enabled())
+        RENDERER_LOG_DEBUG("%s", BVHCache::get_statistics().to_string().c_str());
+
+    // Print triangle tree residency statistics.
+    const TriangleTreeStore& triangle_tree_store = m_project.get_trace_context().get_triangle_tree_store();
+    if (triangle_tree_store.is_enabled())
+        RENDERER_LOG_DEBUG("%s", triangle_tree_store.get_statistics().to_string().c_str());
 
     return status;
 }
 
 IRendererController::Status MasterRenderer::render_frame_sequence(
     RendererComponents&     components,
+    TextureMemoryArbiter&   texture_memory_arbiter,
     IAbortSwitch&           abort_switch)
 {
     while (true)
@@ -301,18 +406,24 @@ IRendererController::Status MasterRenderer::render_frame_sequence(
         }
 
         frame_renderer.start_rendering();
+        end_update();
 
-        const IRendererController::Status status = wait_for_event(frame_renderer);
+        const IRendererController::Status status = wait_for_event(frame_renderer, texture_memory_arbiter);
 
         switch (status)
         {
           case IRendererController::TerminateRendering:
           case IRendererController::AbortRendering:
+            frame_renderer.terminate_rendering();
+            break;
+
           case IRendererController::ReinitializeRendering:
+            begin_update(status);
             frame_renderer.terminate_rendering();
             break;
 
           case IRendererController::RestartRendering:
+            begin_update(status);
             frame_renderer.stop_rendering();
             break;
 
@@ -325,6 +436,11 @@ IRendererController::Status MasterRenderer::render_frame_sequence(
         recorder.on_frame_end(m_project);
         m_renderer_controller->on_frame_end();
 
+        // Save the raw sample sums if requested.
+        if (status == IRendererController::TerminateRendering &&
+            !components.write_sample_buffer_file())
+            return IRendererController::AbortRendering;
+
         switch (status)
         {
           case IRendererController::TerminateRendering:
@@ -340,7 +456,9 @@ IRendererController::Status MasterRenderer::render_frame_sequence(
     }
 }
 
-IRendererController::Status MasterRenderer::wait_for_event(IFrameRenderer& frame_renderer) const
+IRendererController::Status MasterRenderer::wait_for_event(
+    IFrameRenderer&         frame_renderer,
+    TextureMemoryArbiter&   texture_memory_arbiter) const
 {
     bool is_paused = false;
 
@@ -375,15 +493,92 @@ IRendererController::Status MasterRenderer::wait_for_event(IFrameRenderer& frame
 
         m_renderer_controller->on_progress();
 
+        texture_memory_arbiter.update();
+
         foundation::sleep(1);   // namespace qualifer required
     }
 }
 
-bool MasterRenderer::bind_scene_entities_inputs() const
+bool MasterRenderer::bind_scene_entities_inputs()
+{
+    // The input binder is preserved across reinitializations: only the entities
+    // of the binding scopes that changed since the last binding are bound again.
+    m_input_binder->bind(*m_project.get_scene());
+    return m_input_binder->get_error_count() == 0;
+}
+
+const LightSampler& MasterRenderer::update_light_sampler()
+{
+    const Scene& scene = *m_project.get_scene();
+    const uint64 signature = LightSampler::compute_signature(scene);
+    const ParamArray params =
+        RendererComponents::get_child_and_inherit_globals(m_params, "light_sampler");
+
+    if (m_light_sampler &&
+        signature == m_light_sampler_signature &&
+        params == m_light_sampler_params)
+        RENDERER_LOG_INFO("light emitters are up-to-date.");
+    else
+    {
+        delete m_light_sampler;
+        m_light_sampler = 0;
+
+        m_light_sampler = new LightSampler(scene, params);
+        m_light_sampler_signature = signature;
+        m_light_sampler_params = params;
+    }
+
+    return *m_light_sampler;
+}
+
+TextureStore& MasterRenderer::update_texture_store()
+{
+    const Scene& scene = *m_project.get_scene();
+    const uint64 signature = TextureStore::compute_signature(scene);
+
+    if (m_texture_store && signature == m_texture_store_signature)
+        RENDERER_LOG_INFO("texture store is up-to-date.");
+    else
+    {
+        delete m_texture_store;
+        m_texture_store = 0;
+
+        m_texture_store = new TextureStore(scene, m_params.child("texture_store"));
+        m_texture_store_signature = signature;
+    }
+
+    return *m_texture_store;
+}
+
+void MasterRenderer::release_texture_store()
+{
+    delete m_texture_store;
+    m_texture_store = 0;
+}
+
+void MasterRenderer::begin_update(const IRendererController::Status status)
 {
-    InputBinder input_binder;
-    input_binder.bind(*m_project.get_scene());
-    return input_binder.get_error_count() == 0;
+    // Keep the earliest request if several requests follow each other.
+    if (m_pending_update == IRendererController::ContinueRendering)
+        m_update_stopwatch.start();
+
+    // A reinitialization supersedes a restart.
+    if (m_pending_update != IRendererController::ReinitializeRendering)
+        m_pending_update = status;
+}
+
+void MasterRenderer::end_update()
+{
+    if (m_pending_update == IRendererController::ContinueRendering)
+        return;
+
+    const double seconds = m_update_stopwatch.measure().get_seconds();
+
+    if (m_pending_update == IRendererController::ReinitializeRendering)
+        RENDERER_LOG_INFO("rendering restarted %s after the scene was edited.", pretty_time(seconds).c_str());
+    else RENDERER_LOG_DEBUG("rendering restarted %s after the restart request.", pretty_time(seconds).c_str());
+
+    m_pending_update = IRendererController::ContinueRendering;
 }
 
 }   // namespace renderer
@@ -35,6 +35,11 @@
 #include "renderer/kernel/rendering/irenderercontroller.h"
 #include "renderer/utility/paramarray.h"
 
+// appleseed.foundation headers.
+#include "foundation/platform/timers.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/stopwatch.h"
+
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
@@ -42,11 +47,16 @@
 namespace foundation    { class IAbortSwitch; }
 namespace renderer      { class Display; }
 namespace renderer      { class IFrameRenderer; }
+namespace renderer      { class InputBinder; }
+namespace renderer      { class ISequenceCallback; }
 namespace renderer      { class ITileCallback; }
 namespace renderer      { class ITileCallbackFactory; }
+namespace renderer      { class LightSampler; }
 namespace renderer      { class Project; }
 namespace renderer      { class RendererComponents; }
 namespace renderer      { class SerialRendererController; }
+namespace renderer      { class TextureMemoryArbiter; }
+namespace renderer      { class TextureStore; }
 
 namespace renderer
 {
@@ -79,6 +89,15 @@ class APPLESEED_DLLSYMBOL MasterRenderer
     // Render the project. Return true on success, false otherwise.
     bool render();
 
+    // Render the frames first_frame to last_frame of a sequence. The sequence callback
+    // updates the project before each frame is rendered; acceleration structures, light
+    // samplers and texture caches are kept from one frame to the next and only updated
+    // where the scene changed. Return true on success, false otherwise.
+    bool render_sequence(
+        ISequenceCallback&          sequence_callback,
+        const size_t                first_frame,
+        const size_t                last_frame);
+
   private:
     IRendererController*            m_renderer_controller;
     ITileCallbackFactory*           m_tile_callback_factory;
@@ -89,6 +108,27 @@ class APPLESEED_DLLSYMBOL MasterRenderer
 
     Display*                        m_display;
 
+    // State preserved across rendering restarts and reinitializations, so that
+    // only the parts of the scene that changed need to be updated.
+    InputBinder*                    m_input_binder;
+    LightSampler*                   m_light_sampler;
+    foundation::uint64              m_light_sampler_signature;
+    ParamArray                      m_light_sampler_params;
+
+    // The texture store is only kept across the frames of a sequence, since entities
+    // may be destroyed between independent renders.
+    TextureStore*                   m_texture_store;
+    foundation::uint64              m_texture_store_signature;
+    bool                            m_rendering_sequence;
+
+    // Measure the time from a restart or reinitialization request to the restart of rendering.
+    typedef foundation::Stopwatch<foundation::DefaultWallclockTimer> StopwatchType;
+    StopwatchType                   m_update_stopwatch;
+    IRendererController::Status     m_pending_update;
+
+    // Render the project, reporting exceptions as rendering failures.
+    bool try_render();
+
     // Render frame sequences, each time reinitializing the rendering components.
     bool do_render();
 
@@ -98,13 +138,31 @@ class APPLESEED_DLLSYMBOL MasterRenderer
     // Render a frame sequence until the sequence is completed or rendering is aborted.
     IRendererController::Status render_frame_sequence(
         RendererComponents&         components,
+        TextureMemoryArbiter&       texture_memory_arbiter,
         foundation::IAbortSwitch&   abort_switch);
 
     // Wait until the the frame is completed or rendering is aborted.
-    IRendererController::Status wait_for_event(IFrameRenderer& frame_renderer) const;
+    IRendererController::Status wait_for_event(
+        IFrameRenderer&             frame_renderer,
+        TextureMemoryArbiter&       texture_memory_arbiter) const;
 
     // Bind all scene entities inputs. Return true on success, false otherwise.
-    bool bind_scene_entities_inputs() const;
+    bool bind_scene_entities_inputs();
+
+    // Rebuild the light sampler if the light emitters of the scene changed.
+    const LightSampler& update_light_sampler();
+
+    // Create a new texture store unless the current one can be reused.
+    TextureStore& update_texture_store();
+
+    // Destroy the texture store.
+    void release_texture_store();
+
+    // Start measuring the time until rendering restarts after a given request.
+    void begin_update(const IRendererController::Status status);
+
+    // Report the time elapsed since the last restart or reinitialization request.
+    void end_update();
 };
 
 }       // namespace renderer
@@ -40,6 +40,9 @@
 #include "foundation/image/image.h"
 #include "foundation/image/tile.h"
 
+// Standard headers.
+#include <cassert>
+
 using namespace foundation;
 
 namespace renderer
@@ -52,11 +55,11 @@ void PermanentShadingResultFrameBufferFactory::release()
 
 PermanentShadingResultFrameBufferFactory::PermanentShadingResultFrameBufferFactory(
     const Frame&                frame)
+  : m_tile_count_x(frame.image().properties().m_tile_count_x)
 {
-    const size_t tile_count_x = frame.image().properties().m_tile_count_x;
     const size_t tile_count_y = frame.image().properties().m_tile_count_y;
 
-    m_framebuffers.resize(tile_count_x * tile_count_y, 0);
+    m_framebuffers.resize(m_tile_count_x * tile_count_y, 0);
 }
 
 PermanentShadingResultFrameBufferFactory::~PermanentShadingResultFrameBufferFactory()
@@ -71,8 +74,7 @@ ShadingResultFrameBuffer* PermanentShadingResultFrameBufferFactory::create(
     const size_t                tile_y,
     const AABB2u&               tile_bbox)
 {
-    const size_t tile_count_x = frame.image().properties().m_tile_count_x;
-    const size_t index = tile_y * tile_count_x + tile_x;
+    const size_t index = tile_y * m_tile_count_x + tile_x;
 
     if (m_framebuffers[index] == 0)
     {
@@ -97,4 +99,16 @@ void PermanentShadingResultFrameBufferFactory::destroy(
 {
 }
 
+const ShadingResultFrameBuffer* PermanentShadingResultFrameBufferFactory::get_framebuffer(
+    const size_t                tile_x,
+    const size_t                tile_y) const
+{
+    assert(tile_x < m_tile_count_x);
+
+    const size_t index = tile_y * m_tile_count_x + tile_x;
+    assert(index < m_framebuffers.size());
+
+    return m_framebuffers[index];
+}
+
 }   // namespace renderer
@@ -71,8 +71,14 @@ class PermanentShadingResultFrameBufferFactory
     virtual void destroy(
         ShadingResultFrameBuffer*   framebuffer) override;
 
+    // Return the framebuffer of a given tile, or 0 if this tile was never rendered.
+    const ShadingResultFrameBuffer* get_framebuffer(
+        const size_t                tile_x,
+        const size_t                tile_y) const;
+
   private:
-    std::vector<ShadingResultFrameBuffer*> m_framebuffers;
+    const size_t                            m_tile_count_x;
+    std::vector<ShadingResultFrameBuffer*>  m_framebuffers;
 };
 
 }       // namespace renderer
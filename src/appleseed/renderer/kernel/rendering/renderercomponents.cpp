@@ -49,10 +49,13 @@
 #include "renderer/kernel/rendering/generic/generictilerenderer.h"
 #include "renderer/kernel/rendering/permanentshadingresultframebufferfactory.h"
 #include "renderer/kernel/rendering/progressive/progressiveframerenderer.h"
+#include "renderer/kernel/rendering/samplebufferfile.h"
 #include "renderer/modeling/project/project.h"
 #include "renderer/utility/paramarray.h"
 
 // Standard headers.
+#include <algorithm>
+#include <cassert>
 #include <string>
 
 using namespace std;
@@ -74,22 +77,23 @@ namespace
         if (source.strings().exist(param_name))
             dest.strings().insert(param_name, source.strings().get(param_name));
     }
+}
 
-    ParamArray get_child_and_inherit_globals(
-        const ParamArray&   source,
-        const char*         name)
-    {
-        ParamArray child = source.child(name);
-        copy_param(child, source, "sampling_mode");
-        copy_param(child, source, "rendering_threads");
-        return child;
-    }
+ParamArray RendererComponents::get_child_and_inherit_globals(
+    const ParamArray&       params,
+    const char*             name)
+{
+    ParamArray child = params.child(name);
+    copy_param(child, params, "sampling_mode");
+    copy_param(child, params, "rendering_threads");
+    return child;
 }
 
 RendererComponents::RendererComponents(
     const Project&          project,
     const ParamArray&       params,
     ITileCallbackFactory*   tile_callback_factory,
+    const LightSampler&     light_sampler,
     TextureStore&           texture_store,
     OIIO::TextureSystem&    texture_system,
     OSL::ShadingSystem&     shading_system)
@@ -99,11 +103,12 @@ RendererComponents::RendererComponents(
   , m_scene(*project.get_scene())
   , m_frame(*project.get_frame())
   , m_trace_context(project.get_trace_context())
-  , m_light_sampler(m_scene, get_child_and_inherit_globals(params, "light_sampler"))
+  , m_light_sampler(light_sampler)
   , m_shading_engine(get_child_and_inherit_globals(params, "shading_engine"))
   , m_texture_store(texture_store)
   , m_texture_system(texture_system)
   , m_shading_system(shading_system)
+  , m_permanent_framebuffer_factory(0)
 {
 }
 
@@ -133,6 +138,28 @@ bool RendererComponents::create()
     return true;
 }
 
+bool RendererComponents::write_sample_buffer_file() const
+{
+    const string filename = m_params.get_optional<string>("sample_buffer_file", "");
+
+    if (filename.empty())
+        return true;
+
+    assert(m_permanent_framebuffer_factory);
+
+    const ParamArray params = get_child_and_inherit_globals(m_params, "generic_frame_renderer");
+    const size_t pass_count = params.get_optional<size_t>("passes", 1);
+    const size_t last_pass = params.get_optional<size_t>("last_pass", pass_count - 1);
+
+    return
+        SampleBufferFile::write(
+            filename.c_str(),
+            m_frame,
+            *m_permanent_framebuffer_factory,
+            params.get_optional<size_t>("first_pass", 0),
+            min(last_pass, pass_count - 1));
+}
+
 bool RendererComponents::create_lighting_engine_factory()
 {
     const string name = m_params.get_required<string>("lighting_engine", "pt");
@@ -321,7 +348,11 @@ bool RendererComponents::create_pixel_renderer_factory()
 
 bool RendererComponents::create_shading_result_framebuffer_factory()
 {
-    const string name = m_params.get_optional<string>("shading_result_framebuffer", "ephemeral");
+    string name = m_params.get_optional<string>("shading_result_framebuffer", "ephemeral");
+
+    // Sample buffer files are written from the framebuffers of all tiles once rendering is complete.
+    if (!m_params.get_optional<string>("sample_buffer_file", "").empty())
+        name = "permanent";
 
     if (name.empty())
     {
@@ -335,8 +366,8 @@ bool RendererComponents::create_shading_result_framebuffer_factory()
     }
     else if (name == "permanent")
     {
-        m_shading_result_framebuffer_factory.reset(
-            new PermanentShadingResultFrameBufferFactory(m_frame));
+        m_permanent_framebuffer_factory = new PermanentShadingResultFrameBufferFactory(m_frame);
+        m_shading_result_framebuffer_factory.reset(m_permanent_framebuffer_factory);
         return true;
     }
     else
@@ -413,13 +444,29 @@ bool RendererComponents::create_frame_renderer_factory()
             return false;
         }
 
+        const ParamArray params = get_child_and_inherit_globals(m_params, "generic_frame_renderer");
+        const size_t pass_count = params.get_optional<size_t>("passes", 1);
+        const size_t first_pass = params.get_optional<size_t>("first_pass", 0);
+
+        if (first_pass > params.get_optional<size_t>("last_pass", pass_count - 1) || first_pass >= pass_count)
+        {
+            RENDERER_LOG_ERROR("invalid range of passes.");
+            return false;
+        }
+
+        if (m_pass_callback.get() && first_pass > 0)
+        {
+            RENDERER_LOG_ERROR("cannot render a range of passes with a lighting engine that relies on previous passes.");
+            return false;
+        }
+
         m_frame_renderer.reset(
             GenericFrameRendererFactory::create(
                 m_frame,
                 m_tile_renderer_factory.get(),
                 m_tile_callback_factory,
                 m_pass_callback.get(),
-                get_child_and_inherit_globals(m_params, "generic_frame_renderer")));
+                params));
         return true;
     }
     else if (name == "progressive")
@@ -430,6 +477,12 @@ bool RendererComponents::create_frame_renderer_factory()
             return false;
         }
 
+        if (!m_params.get_optional<string>("sample_buffer_file", "").empty())
+        {
+            RENDERER_LOG_ERROR("cannot write a sample buffer file with the progressive frame renderer.");
+            return false;
+        }
+
         m_frame_renderer.reset(
             ProgressiveFrameRendererFactory::create(
                 m_project,
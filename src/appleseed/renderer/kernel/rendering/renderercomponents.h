@@ -62,6 +62,7 @@ namespace renderer  { class Frame; }
 namespace renderer  { class IFrameRenderer; }
 namespace renderer  { class ITileCallbackFactory; }
 namespace renderer  { class ParamArray; }
+namespace renderer  { class PermanentShadingResultFrameBufferFactory; }
 namespace renderer  { class Project; }
 namespace renderer  { class Scene; }
 namespace renderer  { class TextureStore; }
@@ -82,16 +83,27 @@ class RendererComponents
         const Project&          project,
         const ParamArray&       params,
         ITileCallbackFactory*   tile_callback_factory,
+        const LightSampler&     light_sampler,
         TextureStore&           texture_store,
         OIIO::TextureSystem&    texture_system,
         OSL::ShadingSystem&     shading_system);
 
+    // Return the child parameters with the given name, with the global parameters
+    // that all rendering components need copied into them.
+    static ParamArray get_child_and_inherit_globals(
+        const ParamArray&       params,
+        const char*             name);
+
     bool create();
 
     ShadingEngine& get_shading_engine();
 
     IFrameRenderer& get_frame_renderer();
 
+    // Write the raw contents of the shading result framebuffers to the file
+    // given by the "sample_buffer_file" parameter, if this parameter is set.
+    bool write_sample_buffer_file() const;
+
   private:
     const Project&              m_project;
     const ParamArray&           m_params;
@@ -99,7 +111,7 @@ class RendererComponents
     const Scene&                m_scene;
     const Frame&                m_frame;
     const TraceContext&         m_trace_context;
-    LightSampler                m_light_sampler;
+    const LightSampler&         m_light_sampler;
     ShadingEngine               m_shading_engine;
     TextureStore&               m_texture_store;
     OIIO::TextureSystem&        m_texture_system;
@@ -110,6 +122,7 @@ class RendererComponents
     std::auto_ptr<ISampleGeneratorFactory>              m_sample_generator_factory;
     std::auto_ptr<IPixelRendererFactory>                m_pixel_renderer_factory;
     std::auto_ptr<IShadingResultFrameBufferFactory>     m_shading_result_framebuffer_factory;
+    PermanentShadingResultFrameBufferFactory*           m_permanent_framebuffer_factory;
     std::auto_ptr<ITileRendererFactory>                 m_tile_renderer_factory;
     std::auto_ptr<IPassCallback>                        m_pass_callback;
     foundation::auto_release_ptr<IFrameRenderer>        m_frame_renderer;
@@ -0,0 +1,390 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "samplebufferfile.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/aov/imagestack.h"
+#include "renderer/kernel/aov/tilestack.h"
+#include "renderer/kernel/rendering/permanentshadingresultframebufferfactory.h"
+#include "renderer/kernel/rendering/shadingresultframebuffer.h"
+#include "renderer/modeling/frame/frame.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/bufferedfile.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    bool write_bytes(
+        BufferedFile&   file,
+        const void*     data,
+        const size_t    size)
+    {
+        return file.write(data, size) == size;
+    }
+
+    bool read_bytes(
+        BufferedFile&   file,
+        void*           data,
+        const size_t    size)
+    {
+        return file.read(data, size) == size;
+    }
+
+    bool read_header(
+        BufferedFile&           file,
+        const char*             filename,
+        SampleBufferFileHeader& header)
+    {
+        if (!read_bytes(file, &header, sizeof(header)) ||
+            memcmp(header.m_magic, SampleBufferFileMagic, sizeof(SampleBufferFileMagic)) != 0 ||
+            header.m_version != SampleBufferFileVersion ||
+            header.m_first_pass > header.m_last_pass)
+        {
+            RENDERER_LOG_ERROR("%s is not a valid sample buffer file.", filename);
+            return false;
+        }
+
+        return true;
+    }
+
+    struct FrameBufferVector
+      : public vector<ShadingResultFrameBuffer*>
+    {
+        explicit FrameBufferVector(const size_t size)
+          : vector<ShadingResultFrameBuffer*>(size, 0)
+        {
+        }
+
+        ~FrameBufferVector()
+        {
+            for (size_t i = 0; i < size(); ++i)
+                delete (*this)[i];
+        }
+    };
+
+    bool merge_file(
+        const char*             filename,
+        const Frame&            frame,
+        FrameBufferVector&      framebuffers,
+        vector<uint32>&         next_passes)
+    {
+        BufferedFile file;
+        if (!file.open(filename, BufferedFile::BinaryType, BufferedFile::ReadMode))
+        {
+            RENDERER_LOG_ERROR("failed to open %s.", filename);
+            return false;
+        }
+
+        SampleBufferFileHeader header;
+        if (!read_header(file, filename, header))
+            return false;
+
+        const CanvasProperties& props = frame.image().properties();
+
+        if (header.m_frame_width != props.m_canvas_width ||
+            header.m_frame_height != props.m_canvas_height ||
+            header.m_tile_width != props.m_tile_width ||
+            header.m_tile_height != props.m_tile_height)
+        {
+            RENDERER_LOG_ERROR(
+                "the resolution or the tile size of %s do not match those of the frame.",
+                filename);
+            return false;
+        }
+
+        // Make sure the AOV images of the frame match the AOVs of the file, in the same order.
+        // Extra AOV images created by the renderer (e.g. for diagnostics) are created here too.
+        for (size_t i = 0; i < header.m_aov_count; ++i)
+        {
+            SampleBufferAOVName aov_name;
+            if (!read_bytes(file, &aov_name, sizeof(aov_name)))
+            {
+                RENDERER_LOG_ERROR("failed to read from %s.", filename);
+                return false;
+            }
+
+            aov_name.m_name[sizeof(aov_name.m_name) - 1] = '\0';
+
+            if (frame.create_extra_aov_image(aov_name.m_name) != i)
+            {
+                RENDERER_LOG_ERROR("the AOVs of %s do not match those of the frame.", filename);
+                return false;
+            }
+        }
+
+        if (frame.aov_images().size() != header.m_aov_count)
+        {
+            RENDERER_LOG_ERROR("the AOVs of %s do not match those of the frame.", filename);
+            return false;
+        }
+
+        vector<float> scratch;
+
+        for (size_t i = 0; i < header.m_tile_count; ++i)
+        {
+            SampleBufferTileHeader tile_header;
+            if (!read_bytes(file, &tile_header, sizeof(tile_header)))
+            {
+                RENDERER_LOG_ERROR("failed to read from %s.", filename);
+                return false;
+            }
+
+            if (tile_header.m_tile_x >= props.m_tile_count_x ||
+                tile_header.m_tile_y >= props.m_tile_count_y)
+            {
+                RENDERER_LOG_ERROR("%s is corrupted.", filename);
+                return false;
+            }
+
+            const size_t tile_index = tile_header.m_tile_y * props.m_tile_count_x + tile_header.m_tile_x;
+
+            // Refuse to count the same pass of a given tile twice.
+            if (header.m_first_pass < next_passes[tile_index])
+            {
+                RENDERER_LOG_ERROR(
+                    "tile (" FMT_SIZE_T ", " FMT_SIZE_T ") of %s overlaps passes merged from another file.",
+                    static_cast<size_t>(tile_header.m_tile_x),
+                    static_cast<size_t>(tile_header.m_tile_y),
+                    filename);
+                return false;
+            }
+
+            next_passes[tile_index] = header.m_last_pass + 1;
+
+            ShadingResultFrameBuffer*& framebuffer = framebuffers[tile_index];
+
+            if (framebuffer == 0)
+            {
+                // First occurrence of this tile: read the sums as they are.
+                const Tile& tile = frame.image().tile(tile_header.m_tile_x, tile_header.m_tile_y);
+                framebuffer =
+                    new ShadingResultFrameBuffer(
+                        tile.get_width(),
+                        tile.get_height(),
+                        header.m_aov_count,
+                        frame.get_filter());
+
+                if (!read_bytes(file, framebuffer->get_storage(), framebuffer->get_size()))
+                {
+                    RENDERER_LOG_ERROR("failed to read from %s.", filename);
+                    return false;
+                }
+            }
+            else
+            {
+                // Subsequent occurrences of this tile: add the sums to the existing ones.
+                const size_t value_count = framebuffer->get_size() / sizeof(float);
+                scratch.resize(value_count);
+
+                if (!read_bytes(file, &scratch[0], framebuffer->get_size()))
+                {
+                    RENDERER_LOG_ERROR("failed to read from %s.", filename);
+                    return false;
+                }
+
+                float* values = framebuffer->pixel(0);
+
+                for (size_t j = 0; j < value_count; ++j)
+                    values[j] += scratch[j];
+            }
+        }
+
+        return true;
+    }
+}
+
+bool SampleBufferFile::write(
+    const char*                                     filename,
+    const Frame&                                    frame,
+    const PermanentShadingResultFrameBufferFactory& framebuffer_factory,
+    const size_t                                    first_pass,
+    const size_t                                    last_pass)
+{
+    assert(filename);
+    assert(first_pass <= last_pass);
+
+    const CanvasProperties& props = frame.image().properties();
+    const ImageStack& aov_images = frame.aov_images();
+
+    // Collect the tiles that were rendered.
+    vector<SampleBufferTileHeader> tiles;
+    for (size_t tile_y = 0; tile_y < props.m_tile_count_y; ++tile_y)
+    {
+        for (size_t tile_x = 0; tile_x < props.m_tile_count_x; ++tile_x)
+        {
+            if (framebuffer_factory.get_framebuffer(tile_x, tile_y))
+            {
+                SampleBufferTileHeader tile_header;
+                tile_header.m_tile_x = static_cast<uint32>(tile_x);
+                tile_header.m_tile_y = static_cast<uint32>(tile_y);
+                tiles.push_back(tile_header);
+            }
+        }
+    }
+
+    BufferedFile file;
+    if (!file.open(filename, BufferedFile::BinaryType, BufferedFile::WriteMode))
+    {
+        RENDERER_LOG_ERROR("failed to open %s for writing.", filename);
+        return false;
+    }
+
+    SampleBufferFileHeader header;
+    memcpy(header.m_magic, SampleBufferFileMagic, sizeof(header.m_magic));
+    header.m_version = SampleBufferFileVersion;
+    header.m_frame_width = static_cast<uint32>(props.m_canvas_width);
+    header.m_frame_height = static_cast<uint32>(props.m_canvas_height);
+    header.m_tile_width = static_cast<uint32>(props.m_tile_width);
+    header.m_tile_height = static_cast<uint32>(props.m_tile_height);
+    header.m_aov_count = static_cast<uint32>(aov_images.size());
+    header.m_first_pass = static_cast<uint32>(first_pass);
+    header.m_last_pass = static_cast<uint32>(last_pass);
+    header.m_tile_count = static_cast<uint32>(tiles.size());
+
+    bool success = write_bytes(file, &header, sizeof(header));
+
+    for (size_t i = 0; i < aov_images.size(); ++i)
+    {
+        SampleBufferAOVName aov_name;
+        memset(aov_name.m_name, 0, sizeof(aov_name.m_name));
+        strncpy(aov_name.m_name, aov_images.get_name(i), sizeof(aov_name.m_name) - 1);
+        success = success && write_bytes(file, &aov_name, sizeof(aov_name));
+    }
+
+    for (size_t i = 0; i < tiles.size(); ++i)
+    {
+        const ShadingResultFrameBuffer* framebuffer =
+            framebuffer_factory.get_framebuffer(tiles[i].m_tile_x, tiles[i].m_tile_y);
+
+        success = success && write_bytes(file, &tiles[i], sizeof(tiles[i]));
+        success = success && write_bytes(file, framebuffer->get_storage(), framebuffer->get_size());
+    }
+
+    if (!success || !file.close())
+    {
+        RENDERER_LOG_ERROR("failed to write to %s.", filename);
+        return false;
+    }
+
+    RENDERER_LOG_INFO(
+        "wrote %s %s of passes %s to %s to sample buffer file %s.",
+        pretty_uint(tiles.size()).c_str(),
+        plural(tiles.size(), "tile").c_str(),
+        pretty_uint(first_pass + 1).c_str(),
+        pretty_uint(last_pass + 1).c_str(),
+        filename);
+
+    return true;
+}
+
+bool SampleBufferFile::merge(
+    const vector<string>&                           filenames,
+    Frame&                                          frame)
+{
+    // Sort the files by first pass.
+    vector<pair<uint32, size_t>> order;
+    for (size_t i = 0; i < filenames.size(); ++i)
+    {
+        BufferedFile file;
+        if (!file.open(filenames[i].c_str(), BufferedFile::BinaryType, BufferedFile::ReadMode))
+        {
+            RENDERER_LOG_ERROR("failed to open %s.", filenames[i].c_str());
+            return false;
+        }
+
+        SampleBufferFileHeader header;
+        if (!read_header(file, filenames[i].c_str(), header))
+            return false;
+
+        order.push_back(make_pair(header.m_first_pass, i));
+    }
+    stable_sort(order.begin(), order.end());
+
+    // Accumulate the sums of all files.
+    const CanvasProperties& props = frame.image().properties();
+    FrameBufferVector framebuffers(props.m_tile_count);
+    vector<uint32> next_passes(props.m_tile_count, 0);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        if (!merge_file(filenames[order[i].second].c_str(), frame, framebuffers, next_passes))
+            return false;
+    }
+
+    // Develop the merged framebuffers to the frame.
+    size_t tile_count = 0;
+    for (size_t tile_y = 0; tile_y < props.m_tile_count_y; ++tile_y)
+    {
+        for (size_t tile_x = 0; tile_x < props.m_tile_count_x; ++tile_x)
+        {
+            const ShadingResultFrameBuffer* framebuffer =
+                framebuffers[tile_y * props.m_tile_count_x + tile_x];
+
+            if (framebuffer == 0)
+                continue;
+
+            Tile& tile = frame.image().tile(tile_x, tile_y);
+            TileStack aov_tiles = frame.aov_images().tiles(tile_x, tile_y);
+
+            if (frame.is_premultiplied_alpha())
+                framebuffer->develop_to_tile_premult_alpha(tile, aov_tiles);
+            else framebuffer->develop_to_tile_straight_alpha(tile, aov_tiles);
+
+            ++tile_count;
+        }
+    }
+
+    RENDERER_LOG_INFO(
+        "merged %s sample buffer %s into %s %s.",
+        pretty_uint(filenames.size()).c_str(),
+        plural(filenames.size(), "file").c_str(),
+        pretty_uint(tile_count).c_str(),
+        plural(tile_count, "tile").c_str());
+
+    return true;
+}
+
+}   // namespace renderer
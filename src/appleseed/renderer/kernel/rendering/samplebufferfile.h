@@ -0,0 +1,123 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_SAMPLEBUFFERFILE_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_SAMPLEBUFFERFILE_H
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Forward declarations.
+namespace renderer  { class Frame; }
+namespace renderer  { class PermanentShadingResultFrameBufferFactory; }
+
+namespace renderer
+{
+
+//
+// Sample buffer files hold the raw contents of the shading result framebuffers of
+// a frame, i.e. the filtered, weighted sums of the samples of the main image and of
+// all AOVs, before they are developed into the frame's images. They are lossless.
+//
+// A frame can be split into slices, each one being a band of tiles (rendered using
+// a tile-aligned crop window) and/or a range of passes. Slices are rendered by
+// separate processes, then merged and developed in a single step.
+//
+// Slices made of distinct tiles merge into images that are bit-identical to those
+// of a single-process render. Slices made of distinct pass ranges are identical up
+// to the rounding of the floating-point sums of each pass range.
+//
+// Layout of a file (all values in little-endian byte order):
+//   SampleBufferFileHeader
+//   SampleBufferAOVName                [AOV count]
+//   SampleBufferTileHeader, tile data  [tile count]
+// Tile data are stored uncompressed, as contiguous arrays of interleaved pixels:
+// the total weight followed by the RGBA sums of the main image and of each AOV,
+// all as 32-bit floating-point values.
+//
+
+const char SampleBufferFileMagic[4] = { 'A', 'S', 'S', 'B' };
+const foundation::uint32 SampleBufferFileVersion = 1;
+const char SampleBufferFileExtension[] = ".assb";
+
+struct SampleBufferFileHeader
+{
+    char                m_magic[4];
+    foundation::uint32  m_version;
+    foundation::uint32  m_frame_width;
+    foundation::uint32  m_frame_height;
+    foundation::uint32  m_tile_width;
+    foundation::uint32  m_tile_height;
+    foundation::uint32  m_aov_count;
+    foundation::uint32  m_first_pass;       // first rendering pass included in this file
+    foundation::uint32  m_last_pass;        // last rendering pass included in this file
+    foundation::uint32  m_tile_count;       // number of tiles stored in this file
+};
+
+struct SampleBufferAOVName
+{
+    char                m_name[64];         // null-terminated
+};
+
+struct SampleBufferTileHeader
+{
+    foundation::uint32  m_tile_x;
+    foundation::uint32  m_tile_y;
+};
+
+class APPLESEED_DLLSYMBOL SampleBufferFile
+{
+  public:
+    // Write the framebuffers of all the tiles that were rendered to a sample buffer file.
+    static bool write(
+        const char*                                     filename,
+        const Frame&                                    frame,
+        const PermanentShadingResultFrameBufferFactory& framebuffer_factory,
+        const size_t                                    first_pass,
+        const size_t                                    last_pass);
+
+    // Merge a set of sample buffer files and develop the result into the main image
+    // and the AOV images of a frame. Tiles that are present in none of the files are
+    // left untouched. Files are merged in the order of their first pass, regardless
+    // of the order in which they are given.
+    static bool merge(
+        const std::vector<std::string>&                 filenames,
+        Frame&                                          frame);
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_SAMPLEBUFFERFILE_H
@@ -39,9 +39,11 @@
 #include "foundation/utility/memory.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
@@ -59,6 +61,7 @@ SampleGeneratorBase::SampleGeneratorBase(
     const size_t                generator_count)
   : m_generator_index(generator_index)
   , m_stride((generator_count - 1) * SampleBatchSize)
+  , m_coherent_ordering(false)
 {
     reset();
 }
@@ -80,25 +83,94 @@ void SampleGeneratorBase::generate_samples(
     clear_keep_memory(m_samples);
     m_samples.reserve(sample_count);
 
+    const size_t stored =
+        m_coherent_ordering
+            ? generate_samples_in_coherent_order(sample_count, abort_switch)
+            : generate_samples_in_sequence_order(sample_count, abort_switch);
+
+    if (stored > 0)
+        buffer.store_samples(stored, &m_samples[0], abort_switch);
+}
+
+void SampleGeneratorBase::set_coherent_ordering(const bool enabled)
+{
+    m_coherent_ordering = enabled;
+}
+
+bool SampleGeneratorBase::compute_sorting_key(
+    const size_t                sequence_index,
+    uint32&                     key)
+{
+    key = 0;
+    return true;
+}
+
+bool SampleGeneratorBase::advance_sequence_index()
+{
+    ++m_sequence_index;
+
+    if (++m_current_batch_size == SampleBatchSize)
+    {
+        m_current_batch_size = 0;
+        m_sequence_index += m_stride;
+        return true;
+    }
+
+    return false;
+}
+
+size_t SampleGeneratorBase::generate_samples_in_sequence_order(
+    const size_t                sample_count,
+    IAbortSwitch&               abort_switch)
+{
     size_t stored = 0;
 
     while (stored < sample_count)
     {
         stored += generate_samples(m_sequence_index, m_samples);
-        ++m_sequence_index;
 
-        if (++m_current_batch_size == SampleBatchSize)
+        if (advance_sequence_index() && abort_switch.is_aborted())
+            break;
+    }
+
+    return stored;
+}
+
+size_t SampleGeneratorBase::generate_samples_in_coherent_order(
+    const size_t                sample_count,
+    IAbortSwitch&               abort_switch)
+{
+    size_t stored = 0;
+
+    while (stored < sample_count)
+    {
+        // Collect the sequence indices of the next samples, skipping those that produce nothing.
+        const size_t pending_count = min<size_t>(sample_count - stored, MaxPendingSampleCount);
+        clear_keep_memory(m_pending_samples);
+        m_pending_samples.reserve(pending_count);
+
+        while (m_pending_samples.size() < pending_count)
+        {
+            uint32 key;
+            if (compute_sorting_key(m_sequence_index, key))
+                m_pending_samples.push_back(PendingSample(key, m_sequence_index));
+
+            advance_sequence_index();
+        }
+
+        // Render the samples in coherent order.
+        sort(m_pending_samples.begin(), m_pending_samples.end());
+
+        for (size_t i = 0; i < pending_count; ++i)
         {
-            m_current_batch_size = 0;
-            m_sequence_index += m_stride;
+            stored += generate_samples(m_pending_samples[i].second, m_samples);
 
-            if (abort_switch.is_aborted())
-                break;
+            if ((i + 1) % SampleBatchSize == 0 && abort_switch.is_aborted())
+                return stored;
         }
     }
 
-    if (stored > 0)
-        buffer.store_samples(stored, &m_samples[0], abort_switch);
+    return stored;
 }
 
 void SampleGeneratorBase::signal_invalid_sample()
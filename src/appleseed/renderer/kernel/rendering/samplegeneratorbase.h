@@ -39,6 +39,7 @@
 
 // Standard headers.
 #include <cstddef>
+#include <utility>
 #include <vector>
 
 // Forward declarations.
@@ -51,6 +52,13 @@ namespace renderer
 //
 // A convenient base class for sample generators.
 //
+// By default, samples are rendered in the order of their sequence indices. Derived classes
+// may instead enable coherent ordering: the sequence indices of up to MaxPendingSampleCount
+// samples are collected first, then their samples are rendered by increasing sorting key.
+// Consecutive samples of a low discrepancy sequence are scattered all over the image plane;
+// rendering them sorted by position makes consecutive camera rays, and to a lesser extent
+// the secondary rays that follow, visit the same parts of the scene.
+//
 
 class SampleGeneratorBase
   : public ISampleGenerator
@@ -72,6 +80,18 @@ class SampleGeneratorBase
   protected:
     typedef std::vector<Sample> SampleVector;
 
+    // Maximum number of samples sorted together in coherent ordering mode.
+    enum { MaxPendingSampleCount = 64 * 1024 };
+
+    // Enable or disable coherent ordering of the samples.
+    void set_coherent_ordering(const bool enabled);
+
+    // Compute the sorting key of the sample with a given sequence index, in coherent ordering mode.
+    // Return false if this sequence index produces no sample and may be skipped.
+    virtual bool compute_sorting_key(
+        const size_t                sequence_index,
+        foundation::uint32&         key);
+
     // Generate one or multiple samples for a given sequence index and store them in 'samples'.
     // Return the number of samples that were stored.
     virtual size_t generate_samples(
@@ -81,12 +101,27 @@ class SampleGeneratorBase
     void signal_invalid_sample();
 
   private:
+    typedef std::pair<foundation::uint32, size_t> PendingSample;     // sorting key, sequence index
+
     const size_t                    m_generator_index;
     const size_t                    m_stride;
+    bool                            m_coherent_ordering;
     size_t                          m_sequence_index;
     size_t                          m_current_batch_size;
     SampleVector                    m_samples;
+    std::vector<PendingSample>      m_pending_samples;
     foundation::uint64              m_invalid_sample_count;
+
+    // Move to the next sequence index. Return true at the end of a batch of samples.
+    bool advance_sequence_index();
+
+    size_t generate_samples_in_sequence_order(
+        const size_t                sample_count,
+        foundation::IAbortSwitch&   abort_switch);
+
+    size_t generate_samples_in_coherent_order(
+        const size_t                sample_count,
+        foundation::IAbortSwitch&   abort_switch);
 };
 
 }       // namespace renderer
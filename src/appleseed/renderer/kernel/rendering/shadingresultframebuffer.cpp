@@ -115,7 +115,8 @@ void ShadingResultFrameBuffer::add(
         *ptr++ = aov.m_alpha[0];
     }
 
-    FilteredTile::add(x, y, &m_scratch[0]);
+    // The scratch buffer makes this method single-threaded anyway.
+    FilteredTile::add_unsynchronized(x, y, &m_scratch[0]);
 }
 
 void ShadingResultFrameBuffer::merge(
@@ -36,10 +36,17 @@
 #include "renderer/modeling/bsdf/bsdf.h"
 #include "renderer/modeling/shadergroup/shadergroup.h"
 
+// appleseed.foundation headers.
+#include "foundation/utility/api/apistring.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/string.h"
+
 // Standard headers.
 #include <cassert>
+#include <string>
 
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
@@ -53,6 +60,9 @@ OSLShaderGroupExec::OSLShaderGroupExec(OSL::ShadingSystem& shading_system, Arena
   , m_arena(arena)
   , m_osl_thread_info(shading_system.create_thread_info())
   , m_osl_shading_context(shading_system.get_context(m_osl_thread_info))
+  , m_last_shader_group(0)
+  , m_execution_count(0)
+  , m_switch_count(0)
 {
 }
 
@@ -65,6 +75,47 @@ OSLShaderGroupExec::~OSLShaderGroupExec()
         m_osl_shading_system.destroy_thread_info(m_osl_thread_info);
 }
 
+void OSLShaderGroupExec::enable_shader_group_timing()
+{
+    if (m_timer.get() == 0)
+        m_timer.reset(new TimerType());
+}
+
+StatisticsVector OSLShaderGroupExec::get_statistics() const
+{
+    Statistics stats;
+    stats.insert("executions", m_execution_count);
+    stats.insert("shader group switches", m_switch_count);
+    stats.insert_percent("switch rate", m_switch_count, m_execution_count);
+
+    StatisticsVector vec = StatisticsVector::make("osl shader execution statistics", stats);
+
+    if (m_timer.get())
+    {
+        const double rcp_frequency = 1.0 / m_timer->frequency();
+
+        for (const_each<ShaderGroupStatisticsMap> i = m_shader_group_stats; i; ++i)
+        {
+            const ShaderGroupStatistics& group_stats = i->second;
+            const double seconds = group_stats.m_ticks * rcp_frequency;
+
+            Statistics shader_group_stats;
+            shader_group_stats.insert("executions", group_stats.m_execution_count);
+            shader_group_stats.insert_time("total time", seconds);
+            shader_group_stats.insert_time(
+                "time per execution",
+                group_stats.m_execution_count > 0 ? seconds / group_stats.m_execution_count : 0.0,
+                3);
+
+            vec.insert(
+                string("shader group \"") + i->first->get_path().c_str() + "\" statistics",
+                shader_group_stats);
+        }
+    }
+
+    return vec;
+}
+
 void OSLShaderGroupExec::execute_shading(
     const ShaderGroup&              shader_group,
     const ShadingPoint&             shading_point) const
@@ -175,10 +226,7 @@ Color3f OSLShaderGroupExec::execute_background(
     sg.renderer = m_osl_shading_system.renderer();
     sg.raytype = VisibilityFlags::CameraRay;
 
-    m_osl_shading_system.execute(
-        m_osl_shading_context,
-        *shader_group.shader_group_ref(),
-        sg);
+    execute(shader_group, sg);
 
     return process_background_tree(sg.Ci);
 }
@@ -196,10 +244,43 @@ void OSLShaderGroupExec::do_execute(
         ray_flags,
         m_osl_shading_system.renderer());
 
-    m_osl_shading_system.execute(
-        m_osl_shading_context,
-        *shader_group.shader_group_ref(),
-        shading_point.get_osl_shader_globals());
+    execute(shader_group, shading_point.get_osl_shader_globals());
+}
+
+void OSLShaderGroupExec::execute(
+    const ShaderGroup&              shader_group,
+    OSL::ShaderGlobals&             shader_globals) const
+{
+    ++m_execution_count;
+
+    if (&shader_group != m_last_shader_group)
+    {
+        ++m_switch_count;
+        m_last_shader_group = &shader_group;
+    }
+
+    if (m_timer.get())
+    {
+        const uint64 start = m_timer->read_start();
+
+        m_osl_shading_system.execute(
+            m_osl_shading_context,
+            *shader_group.shader_group_ref(),
+            shader_globals);
+
+        const uint64 end = m_timer->read_end();
+
+        ShaderGroupStatistics& group_stats = m_shader_group_stats[&shader_group];
+        ++group_stats.m_execution_count;
+        group_stats.m_ticks += end - start;
+    }
+    else
+    {
+        m_osl_shading_system.execute(
+            m_osl_shading_context,
+            *shader_group.shader_group_ref(),
+            shader_globals);
+    }
 }
 
 void OSLShaderGroupExec::choose_bsdf_closure_shading_basis(
@@ -221,4 +302,15 @@ void OSLShaderGroupExec::choose_bsdf_closure_shading_basis(
         Basis3d(c.get_closure_shading_basis(index)));
 }
 
+
+//
+// OSLShaderGroupExec::ShaderGroupStatistics class implementation.
+//
+
+OSLShaderGroupExec::ShaderGroupStatistics::ShaderGroupStatistics()
+  : m_execution_count(0)
+  , m_ticks(0)
+{
+}
+
 }   // namespace renderer
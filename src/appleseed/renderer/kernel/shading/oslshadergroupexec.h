@@ -37,6 +37,9 @@
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/image/color.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/timers.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/statistics.h"
 
 // OSL headers.
 #include "foundation/platform/_beginoslheaders.h"
@@ -44,6 +47,10 @@
 #include "OSL/oslversion.h"
 #include "foundation/platform/_endoslheaders.h"
 
+// Standard headers.
+#include <map>
+#include <memory>
+
 // Forward declarations.
 namespace foundation    { class Arena; }
 namespace renderer      { class ShaderGroup; }
@@ -64,10 +71,33 @@ class OSLShaderGroupExec
 
     ~OSLShaderGroupExec();
 
+    // Enable timing of shader executions, per shader group. Disabled by default
+    // since reading the timer around every execution has a cost.
+    void enable_shader_group_timing();
+
+    // Retrieve shader execution statistics.
+    foundation::StatisticsVector get_statistics() const;
+
   private:
     friend class ShadingContext;
     friend class Tracer;
 
+#ifdef APPLESEED_X86
+    typedef foundation::X86Timer TimerType;
+#else
+    typedef foundation::DefaultWallclockTimer TimerType;
+#endif
+
+    struct ShaderGroupStatistics
+    {
+        foundation::uint64              m_execution_count;
+        foundation::uint64              m_ticks;
+
+        ShaderGroupStatistics();
+    };
+
+    typedef std::map<const ShaderGroup*, ShaderGroupStatistics> ShaderGroupStatisticsMap;
+
     OSL::ShadingSystem&                 m_osl_shading_system;
     foundation::Arena&                  m_arena;
 
@@ -77,6 +107,17 @@ class OSLShaderGroupExec
     char*                               m_osl_mem_pool_start;
     mutable size_t                      m_osl_mem_used;
 
+    // Execution statistics.
+    mutable const ShaderGroup*          m_last_shader_group;
+    mutable foundation::uint64          m_execution_count;
+    mutable foundation::uint64          m_switch_count;
+    std::auto_ptr<TimerType>            m_timer;
+    mutable ShaderGroupStatisticsMap    m_shader_group_stats;
+
+    void execute(
+        const ShaderGroup&              shader_group,
+        OSL::ShaderGlobals&             shader_globals) const;
+
     void execute_shading(
         const ShaderGroup&              shader_group,
         const ShadingPoint&             shading_point) const;
@@ -60,6 +60,45 @@ namespace renderer
 // ShadingPoint class implementation.
 //
 
+namespace
+{
+    // Compute the barycentric coordinates of the point of a triangle closest to the
+    // projection of a given point onto the plane of the triangle.
+    Vector2f compute_clamped_barycentrics(
+        const Vector3d&     p,
+        const Vector3d&     v0,
+        const Vector3d&     v1,
+        const Vector3d&     v2)
+    {
+        const Vector3d e0 = v1 - v0;
+        const Vector3d e1 = v2 - v0;
+        const Vector3d d = p - v0;
+
+        const double d00 = dot(e0, e0);
+        const double d01 = dot(e0, e1);
+        const double d11 = dot(e1, e1);
+        const double denom = d00 * d11 - d01 * d01;
+
+        if (denom == 0.0)
+            return Vector2f(0.0f);
+
+        const double d20 = dot(d, e0);
+        const double d21 = dot(d, e1);
+
+        double u = max((d11 * d20 - d01 * d21) / denom, 0.0);
+        double v = max((d00 * d21 - d01 * d20) / denom, 0.0);
+
+        const double sum = u + v;
+        if (sum > 1.0)
+        {
+            u /= sum;
+            v /= sum;
+        }
+
+        return Vector2f(static_cast<float>(u), static_cast<float>(v));
+    }
+}
+
 void ShadingPoint::flip_side()
 {
     assert(hit());
@@ -257,6 +296,22 @@ void ShadingPoint::fetch_triangle_source_geometry() const
         m_v2 = tess.m_vertices[triangle.m_v2];
     }
 
+    // The barycentric coordinates of a proxy hit are relative to the proxy triangle.
+    // Replace them by those of the closest point on the source triangle.
+    if (m_proxy_level > 0)
+    {
+        const ShadingRay::RayType local_ray = m_assembly_instance_transform.to_local(m_ray);
+        const Vector3d p =
+            m_object_instance->get_transform().point_to_local(
+                local_ray.point_at(local_ray.m_tmax));
+        m_bary =
+            compute_clamped_barycentrics(
+                p,
+                Vector3d(m_v0),
+                Vector3d(m_v1),
+                Vector3d(m_v2));
+    }
+
     // Copy or compute triangle vertex normals (in object instance space).
     if (triangle.m_n0 != Triangle::None &&
         triangle.m_n1 != Triangle::None &&
@@ -382,9 +437,15 @@ void ShadingPoint::refine_and_offset() const
                 local_ray.m_dir);
 
         // Compute the geometric normal to the hit triangle in assembly instance space.
-        // Note that it doesn't need to be normalized at this point.
-        m_asm_geo_normal = Vector3d(compute_triangle_normal(m_v0, m_v1, m_v2));
-        m_asm_geo_normal = m_object_instance->get_transform().normal_to_parent(m_asm_geo_normal);
+        // Note that it doesn't need to be normalized at this point. Proxy hits are
+        // offset from the proxy triangle, otherwise spawned rays could hit it again.
+        if (m_proxy_level > 0)
+            m_asm_geo_normal = cross(m_triangle_support_plane.m_e0, m_triangle_support_plane.m_e1);
+        else
+        {
+            m_asm_geo_normal = Vector3d(compute_triangle_normal(m_v0, m_v1, m_v2));
+            m_asm_geo_normal = m_object_instance->get_transform().normal_to_parent(m_asm_geo_normal);
+        }
         m_asm_geo_normal = faceforward(m_asm_geo_normal, local_ray.m_dir);
 
         // Compute the offset points in assembly instance space.
@@ -634,7 +695,14 @@ void ShadingPoint::compute_triangle_normals() const
     // Compute the geometric normal to the triangle.
     //
 
-    if (m_members & HasWorldSpaceTriangleVertices)
+    if (m_proxy_level > 0)
+    {
+        // Use the plane of the hit proxy triangle, which is stored in assembly instance space.
+        m_geometric_normal =
+            m_assembly_instance_transform.normal_to_parent(
+                cross(m_triangle_support_plane.m_e0, m_triangle_support_plane.m_e1));
+    }
+    else if (m_members & HasWorldSpaceTriangleVertices)
     {
         // We already have the world space vertices of the hit triangle.
         // Use them to compute the geometric normal directly in world space.
@@ -1098,6 +1166,7 @@ void PoisonImpl<renderer::ShadingPoint>::do_poison(renderer::ShadingPoint& point
     poison(point.m_region_index);
     poison(point.m_primitive_index);
     poison(point.m_triangle_support_plane);
+    poison(point.m_proxy_level);
 
     poison(point.m_members);
 
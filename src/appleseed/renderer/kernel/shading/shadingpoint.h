@@ -221,6 +221,9 @@ class ShadingPoint
     // Return the index of the primitive attribute.
     size_t get_primitive_attribute_index() const;
 
+    // Return the level of the assembly proxy that was hit, or 0 for full resolution geometry.
+    size_t get_proxy_level() const;
+
     // Return the opacity at the intersection point.
     const Alpha& get_alpha() const;
 
@@ -258,6 +261,7 @@ class ShadingPoint
   private:
     friend class AssemblyLeafProbeVisitor;
     friend class AssemblyLeafVisitor;
+    friend class AssemblyTree;
     friend class CurveLeafVisitor;
     friend class Intersector;
     friend class OSLShaderGroupExec;
@@ -276,7 +280,7 @@ class ShadingPoint
 
     // Primary intersection results.
     PrimitiveType                       m_primitive_type;                   // type of the hit primitive
-    foundation::Vector2f                m_bary;                             // barycentric coordinates of intersection point
+    mutable foundation::Vector2f        m_bary;                             // barycentric coordinates of intersection point
     const AssemblyInstance*             m_assembly_instance;                // hit assembly instance
     foundation::Transformd              m_assembly_instance_transform;      // transform of the hit assembly instance at ray time
     const TransformSequence*            m_assembly_instance_transform_seq;  // transform sequence of the hit assembly instance.
@@ -284,6 +288,7 @@ class ShadingPoint
     size_t                              m_region_index;                     // index of the region containing the hit triangle
     size_t                              m_primitive_index;                  // index of the hit primitive
     TriangleSupportPlaneType            m_triangle_support_plane;           // support plane of the hit triangle
+    size_t                              m_proxy_level;                      // level of the assembly proxy that was hit, 0 for full resolution geometry
 
     // Flags to keep track of which on-demand results have been computed and cached.
     enum Members
@@ -415,6 +420,7 @@ inline ShadingPoint::ShadingPoint(const ShadingPoint& rhs)
   , m_region_index(rhs.m_region_index)
   , m_primitive_index(rhs.m_primitive_index)
   , m_triangle_support_plane(rhs.m_triangle_support_plane)
+  , m_proxy_level(rhs.m_proxy_level)
   , m_members(0)
 {
 }
@@ -435,6 +441,7 @@ inline ShadingPoint& ShadingPoint::operator=(const ShadingPoint& rhs)
     m_region_index = rhs.m_region_index;
     m_primitive_index = rhs.m_primitive_index;
     m_triangle_support_plane = rhs.m_triangle_support_plane;
+    m_proxy_level = rhs.m_proxy_level;
     m_members = 0;
     return *this;
 }
@@ -500,6 +507,11 @@ inline double ShadingPoint::get_distance() const
 inline const foundation::Vector2f& ShadingPoint::get_bary() const
 {
     assert(hit());
+
+    // The barycentric coordinates of proxy hits are remapped to the source triangle.
+    if (m_proxy_level > 0)
+        cache_source_geometry();
+
     return m_bary;
 }
 
@@ -858,6 +870,12 @@ inline size_t ShadingPoint::get_primitive_attribute_index() const
     return static_cast<size_t>(m_primitive_pa);
 }
 
+inline size_t ShadingPoint::get_proxy_level() const
+{
+    assert(hit());
+    return m_proxy_level;
+}
+
 inline const Alpha& ShadingPoint::get_alpha() const
 {
     if (!(m_members & HasAlpha))
@@ -0,0 +1,126 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "texturefilebudget.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+namespace renderer
+{
+
+//
+// TextureFileBudget class implementation.
+//
+
+TextureFileBudget::TextureFileBudget()
+  : m_max_open_files(DefaultMaxOpenFiles)
+  , m_open_file_count(0)
+{
+}
+
+void TextureFileBudget::set_max_open_files(const size_t count)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_max_open_files = max<size_t>(count, 1);
+    m_file_available.notify_all();
+}
+
+size_t TextureFileBudget::get_max_open_files() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_max_open_files;
+}
+
+size_t TextureFileBudget::get_open_file_count() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_open_file_count;
+}
+
+void TextureFileBudget::acquire(IClient* client)
+{
+    assert(client);
+
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    // Move the client to the front of the list.
+    m_clients.remove(client);
+    m_clients.push_front(client);
+
+    while (m_open_file_count >= m_max_open_files)
+    {
+        if (!close_idle_file())
+            m_file_available.wait(lock);
+    }
+
+    ++m_open_file_count;
+}
+
+void TextureFileBudget::release()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    assert(m_open_file_count > 0);
+    --m_open_file_count;
+
+    m_file_available.notify_one();
+}
+
+void TextureFileBudget::notify_idle_file()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_file_available.notify_one();
+}
+
+void TextureFileBudget::remove_client(IClient* client)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_clients.remove(client);
+}
+
+bool TextureFileBudget::close_idle_file()
+{
+    for (ClientList::reverse_iterator i = m_clients.rbegin(); i != m_clients.rend(); ++i)
+    {
+        if ((*i)->close_idle_file())
+        {
+            assert(m_open_file_count > 0);
+            --m_open_file_count;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+}   // namespace renderer
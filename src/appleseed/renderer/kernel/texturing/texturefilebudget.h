@@ -0,0 +1,118 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_TEXTURING_TEXTUREFILEBUDGET_H
+#define APPLESEED_RENDERER_KERNEL_TEXTURING_TEXTUREFILEBUDGET_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/singleton.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Boost headers.
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <list>
+
+namespace renderer
+{
+
+//
+// A process-wide budget of texture files kept open for reading, shared by all textures.
+//
+// Textures that keep image files open register as clients: they acquire a slot before
+// opening a file and give it back after closing it. When the budget is exhausted, idle
+// files of the least recently served clients are closed to make room. If all open files
+// are in use, acquire() waits until one of them becomes idle or is closed.
+//
+// The maximum number of open files is set from the "max_open_files" parameter of the
+// texture store.
+//
+
+class APPLESEED_DLLSYMBOL TextureFileBudget
+  : public foundation::Singleton<TextureFileBudget>
+{
+  public:
+    enum { DefaultMaxOpenFiles = 64 };
+
+    class IClient
+    {
+      public:
+        virtual ~IClient() {}
+
+        // Close one open file that is not in use. Return false if there is none.
+        // Called with the budget's lock held: must not call back into the budget.
+        virtual bool close_idle_file() = 0;
+    };
+
+    // Set/get the maximum number of open files. Thread-safe.
+    // Lowering the limit closes idle files as new files get opened.
+    void set_max_open_files(const size_t count);
+    size_t get_max_open_files() const;
+
+    // Return the number of files currently open. Thread-safe.
+    size_t get_open_file_count() const;
+
+    // Acquire a slot for a new file of a given client. Thread-safe.
+    // The caller must not hold any lock taken by close_idle_file().
+    void acquire(IClient* client);
+
+    // Give back the slot of a file that was closed by its client. Thread-safe.
+    void release();
+
+    // Signal that a file was returned to its client's idle files. Thread-safe.
+    void notify_idle_file();
+
+    // Forget a client. Must be called before the client is destroyed. Thread-safe.
+    void remove_client(IClient* client);
+
+  private:
+    friend class foundation::Singleton<TextureFileBudget>;
+
+    typedef std::list<IClient*> ClientList;
+
+    mutable boost::mutex        m_mutex;
+    boost::condition_variable   m_file_available;
+    size_t                      m_max_open_files;
+    size_t                      m_open_file_count;
+    ClientList                  m_clients;              // most recently served client first
+
+    // Constructor.
+    TextureFileBudget();
+
+    // Close an idle file of the least recently served client that has one. m_mutex must be locked.
+    bool close_idle_file();
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_TEXTURING_TEXTUREFILEBUDGET_H
@@ -0,0 +1,351 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "texturememoryarbiter.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/basegroup.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/cache.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/statistics.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// TextureMemoryArbiter class implementation.
+//
+
+namespace
+{
+    // Minimum time in seconds between two rebalancings.
+    const double RebalanceInterval = 1.0;
+
+    // Fraction of the budget that each cache keeps at all times.
+    const double MinShare = 0.1;
+
+    // Fraction of the budget moved from one cache to the other at each rebalancing.
+    const double RebalanceStep = 0.1;
+
+    // A cache only receives more memory if its miss rate is this many times higher.
+    const double MissRateRatio = 2.0;
+
+    // Minimum number of lookups for a miss rate to be considered meaningful.
+    const uint64 MinLookupCount = 1000;
+
+    void find_texture_kinds(
+        const BaseGroup&    group,
+        bool&               has_textures,
+        bool&               has_shader_groups)
+    {
+        if (!group.textures().empty())
+            has_textures = true;
+
+        if (!group.shader_groups().empty())
+            has_shader_groups = true;
+
+        for (const_each<AssemblyContainer> i = group.assemblies(); i; ++i)
+            find_texture_kinds(*i, has_textures, has_shader_groups);
+    }
+
+    uint64 delta(const uint64 current, const uint64 previous)
+    {
+        // Counters may have been reset in the meantime.
+        return current >= previous ? current - previous : current;
+    }
+
+    bool is_nearly_full(const size_t size, const size_t limit)
+    {
+        return size >= limit - limit / 10;
+    }
+
+    typedef map<string, TextureStore::TextureStats> TextureStatsMap;
+
+    uint64 get_texture_system_counter(
+        OIIO::TextureSystem&    texture_system,
+        const char*             name)
+    {
+        // Read counters as 64-bit integers since they overflow 32 bits on long renders.
+        // Fall back to 32-bit integers for counters that OpenImageIO exposes as such.
+        long long value = 0;
+        if (texture_system.getattribute(name, OIIO::TypeDesc::INT64, &value))
+            return static_cast<uint64>(value);
+
+        int int_value = 0;
+        texture_system.getattribute(name, OIIO::TypeDesc::INT, &int_value);
+        return static_cast<uint32>(int_value);
+    }
+
+    bool has_more_bytes_read(
+        const TextureStore::TextureStats&   lhs,
+        const TextureStore::TextureStats&   rhs)
+    {
+        return lhs.m_bytes_read > rhs.m_bytes_read;
+    }
+}
+
+TextureMemoryArbiter::TextureMemoryArbiter(
+    const Scene&            scene,
+    TextureStore&           texture_store,
+    OIIO::TextureSystem&    texture_system,
+    const ParamArray&       params)
+  : m_texture_store(texture_store)
+  , m_texture_system(texture_system)
+  , m_budget(params.get_optional<size_t>("max_size", 256 * 1024 * 1024))
+  , m_min_limit(static_cast<size_t>(m_budget * MinShare))
+  , m_rebalance_count(0)
+  , m_stopwatch(0)
+{
+    assert(m_budget > 0);
+
+    // Split the budget according to the kinds of textures used by the scene.
+    bool has_textures = false;
+    bool has_shader_groups = false;
+    find_texture_kinds(scene, has_textures, has_shader_groups);
+
+    if (has_textures && !has_shader_groups)
+        m_texture_system_limit = m_min_limit;
+    else if (!has_textures && has_shader_groups)
+        m_texture_system_limit = m_budget - m_min_limit;
+    else m_texture_system_limit = m_budget / 2;
+
+    m_texture_store_limit = m_budget - m_texture_system_limit;
+
+    RENDERER_LOG_INFO(
+        "sharing %s of texture memory: %s for the texture store, %s for the oiio texture cache.",
+        pretty_size(m_budget).c_str(),
+        pretty_size(m_texture_store_limit).c_str(),
+        pretty_size(m_texture_system_limit).c_str());
+
+    apply_limits();
+
+    // The OIIO texture system outlives this object: only count what happens from now on.
+    m_texture_store_counters = get_texture_store_counters();
+    m_texture_system_counters = get_texture_system_counters();
+    m_initial_texture_system_counters = m_texture_system_counters;
+    m_initial_texture_system_bytes_read = get_texture_system_bytes_read();
+
+    m_stopwatch.start();
+}
+
+void TextureMemoryArbiter::update()
+{
+    if (m_stopwatch.measure().get_seconds() < RebalanceInterval)
+        return;
+
+    m_stopwatch.start();
+
+    rebalance();
+}
+
+void TextureMemoryArbiter::rebalance()
+{
+    // Compute the miss rates of both caches since the last update.
+    const CacheCounters store_counters = get_texture_store_counters();
+    const CacheCounters system_counters = get_texture_system_counters();
+    const uint64 store_lookups = delta(store_counters.m_lookup_count, m_texture_store_counters.m_lookup_count);
+    const uint64 store_misses = delta(store_counters.m_miss_count, m_texture_store_counters.m_miss_count);
+    const uint64 system_lookups = delta(system_counters.m_lookup_count, m_texture_system_counters.m_lookup_count);
+    const uint64 system_misses = delta(system_counters.m_miss_count, m_texture_system_counters.m_miss_count);
+    m_texture_store_counters = store_counters;
+    m_texture_system_counters = system_counters;
+
+    const double store_miss_rate =
+        store_lookups >= MinLookupCount
+            ? static_cast<double>(store_misses) / store_lookups
+            : 0.0;
+    const double system_miss_rate =
+        system_lookups >= MinLookupCount
+            ? static_cast<double>(system_misses) / system_lookups
+            : 0.0;
+
+    // Move memory toward the cache that misses most, if it is actually short of memory.
+    const size_t step = static_cast<size_t>(m_budget * RebalanceStep);
+
+    if (store_miss_rate > MissRateRatio * system_miss_rate &&
+        m_texture_system_limit > m_min_limit &&
+        is_nearly_full(m_texture_store.get_memory_size(), m_texture_store_limit))
+    {
+        const size_t amount = min(step, m_texture_system_limit - m_min_limit);
+        m_texture_system_limit -= amount;
+        m_texture_store_limit += amount;
+    }
+    else if (system_miss_rate > MissRateRatio * store_miss_rate &&
+             m_texture_store_limit > m_min_limit &&
+             is_nearly_full(get_texture_system_memory_size(), m_texture_system_limit))
+    {
+        const size_t amount = min(step, m_texture_store_limit - m_min_limit);
+        m_texture_store_limit -= amount;
+        m_texture_system_limit += amount;
+    }
+    else return;
+
+    ++m_rebalance_count;
+
+    RENDERER_LOG_DEBUG(
+        "rebalanced texture memory: %s for the texture store (miss rate %s), "
+        "%s for the oiio texture cache (miss rate %s).",
+        pretty_size(m_texture_store_limit).c_str(),
+        pretty_percent(store_misses, store_lookups).c_str(),
+        pretty_size(m_texture_system_limit).c_str(),
+        pretty_percent(system_misses, system_lookups).c_str());
+
+    apply_limits();
+}
+
+StatisticsVector TextureMemoryArbiter::get_statistics() const
+{
+    StatisticsVector vec;
+
+    Statistics memory_stats;
+    memory_stats.insert_size("budget", m_budget);
+    memory_stats.insert_size("texture store", m_texture_store_limit);
+    memory_stats.insert_size("oiio texture cache", m_texture_system_limit);
+    memory_stats.insert("rebalancings", m_rebalance_count);
+    vec.insert("texture memory statistics", memory_stats);
+
+    vec.merge(m_texture_store.get_statistics());
+
+    const CacheCounters system_counters = get_texture_system_counters();
+    const uint64 system_lookups =
+        delta(system_counters.m_lookup_count, m_initial_texture_system_counters.m_lookup_count);
+    const uint64 system_misses =
+        min(system_lookups, delta(system_counters.m_miss_count, m_initial_texture_system_counters.m_miss_count));
+    Statistics system_stats;
+    system_stats.insert(
+        auto_ptr<cache_impl::CacheStatisticsEntry>(
+            new cache_impl::CacheStatisticsEntry(
+                "performances",
+                system_lookups - system_misses,
+                system_misses)));
+    system_stats.insert_size(
+        "bytes read",
+        delta(get_texture_system_bytes_read(), m_initial_texture_system_bytes_read));
+    system_stats.insert_size("size", get_texture_system_memory_size());
+    vec.insert("oiio texture cache statistics", system_stats);
+
+    // Textures that share the same file are reported together.
+    TextureStore::TextureStatsVector texture_stats;
+    m_texture_store.get_texture_statistics(texture_stats);
+
+    TextureStatsMap texture_stats_map;
+    for (const_each<TextureStore::TextureStatsVector> i = texture_stats; i; ++i)
+    {
+        TextureStore::TextureStats& s = texture_stats_map[i->m_name];
+        s.m_name = i->m_name;
+        s.m_hit_count += i->m_hit_count;
+        s.m_miss_count += i->m_miss_count;
+        s.m_bytes_read += i->m_bytes_read;
+    }
+
+    texture_stats.clear();
+    for (const_each<TextureStatsMap> i = texture_stats_map; i; ++i)
+        texture_stats.push_back(i->second);
+
+    sort(texture_stats.begin(), texture_stats.end(), has_more_bytes_read);
+
+    if (!texture_stats.empty())
+    {
+        Statistics per_texture_stats;
+
+        for (const_each<TextureStore::TextureStatsVector> i = texture_stats; i; ++i)
+        {
+            per_texture_stats.insert<string>(
+                i->m_name,
+                  "hits " + pretty_uint(i->m_hit_count)
+                + "  misses " + pretty_uint(i->m_miss_count)
+                + "  read " + pretty_size(i->m_bytes_read));
+        }
+
+        vec.insert("texture statistics", per_texture_stats);
+    }
+
+    return vec;
+}
+
+void TextureMemoryArbiter::apply_limits()
+{
+    m_texture_store.set_memory_limit(m_texture_store_limit);
+
+    const float texture_system_limit_mb =
+        static_cast<float>(m_texture_system_limit) / (1024 * 1024);
+    m_texture_system.attribute("max_memory_MB", texture_system_limit_mb);
+}
+
+TextureMemoryArbiter::CacheCounters TextureMemoryArbiter::get_texture_store_counters() const
+{
+    CacheCounters counters;
+    counters.m_miss_count = m_texture_store.get_miss_count();
+    counters.m_lookup_count = m_texture_store.get_hit_count() + counters.m_miss_count;
+    return counters;
+}
+
+TextureMemoryArbiter::CacheCounters TextureMemoryArbiter::get_texture_system_counters() const
+{
+    CacheCounters counters;
+    counters.m_lookup_count = get_texture_system_counter(m_texture_system, "stat:find_tile_calls");
+    counters.m_miss_count = get_texture_system_counter(m_texture_system, "stat:find_tile_cache_misses");
+    return counters;
+}
+
+size_t TextureMemoryArbiter::get_texture_system_memory_size() const
+{
+    long long memory_size = 0;
+    m_texture_system.getattribute("stat:cache_memory_used", OIIO::TypeDesc::INT64, &memory_size);
+    return static_cast<size_t>(memory_size);
+}
+
+uint64 TextureMemoryArbiter::get_texture_system_bytes_read() const
+{
+    long long bytes_read = 0;
+    m_texture_system.getattribute("stat:bytes_read", OIIO::TypeDesc::INT64, &bytes_read);
+    return static_cast<uint64>(bytes_read);
+}
+
+}   // namespace renderer
@@ -0,0 +1,122 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_TEXTURING_TEXTUREMEMORYARBITER_H
+#define APPLESEED_RENDERER_KERNEL_TEXTURING_TEXTUREMEMORYARBITER_H
+
+// appleseed.renderer headers.
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/timers.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/stopwatch.h"
+
+// OpenImageIO headers.
+#include "foundation/platform/_beginoiioheaders.h"
+#include "OpenImageIO/texture.h"
+#include "foundation/platform/_endoiioheaders.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class StatisticsVector; }
+namespace renderer      { class Scene; }
+namespace renderer      { class TextureStore; }
+
+namespace renderer
+{
+
+//
+// Shares a single texture memory budget between the texture store (which holds the
+// tiles of appleseed's own textures) and OpenImageIO's texture cache (which holds
+// the tiles of textures accessed by OSL shaders).
+//
+// The budget is initially split according to the kinds of textures used by the scene,
+// then periodically shifted toward the cache that misses most, as long as that cache
+// is full.
+//
+
+class TextureMemoryArbiter
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. The budget is the "max_size" parameter of the texture store parameters.
+    TextureMemoryArbiter(
+        const Scene&            scene,
+        TextureStore&           texture_store,
+        OIIO::TextureSystem&    texture_system,
+        const ParamArray&       params = ParamArray());
+
+    // Rebalance the budget if enough time has passed since the last rebalancing.
+    // Cheap enough to be called at every iteration of the rendering event loop.
+    void update();
+
+    // Rebalance the budget now, according to the cache activity since the last rebalancing.
+    void rebalance();
+
+    // Retrieve unified statistics for both caches and for individual textures.
+    foundation::StatisticsVector get_statistics() const;
+
+  private:
+    // Cumulative counters of one of the two caches.
+    struct CacheCounters
+    {
+        foundation::uint64  m_lookup_count;
+        foundation::uint64  m_miss_count;
+    };
+
+    typedef foundation::Stopwatch<foundation::DefaultWallclockTimer> StopwatchType;
+
+    TextureStore&           m_texture_store;
+    OIIO::TextureSystem&    m_texture_system;
+    const size_t            m_budget;
+    const size_t            m_min_limit;
+    size_t                  m_texture_store_limit;
+    size_t                  m_texture_system_limit;
+    CacheCounters           m_texture_store_counters;
+    CacheCounters           m_texture_system_counters;
+    CacheCounters           m_initial_texture_system_counters;
+    foundation::uint64      m_initial_texture_system_bytes_read;
+    foundation::uint64      m_rebalance_count;
+    StopwatchType           m_stopwatch;
+
+    void apply_limits();
+
+    CacheCounters get_texture_store_counters() const;
+    CacheCounters get_texture_system_counters() const;
+
+    size_t get_texture_system_memory_size() const;
+    foundation::uint64 get_texture_system_bytes_read() const;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_TEXTURING_TEXTUREMEMORYARBITER_H
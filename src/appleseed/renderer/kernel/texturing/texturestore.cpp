@@ -32,7 +32,10 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/texturing/texturefilebudget.h"
+#include "renderer/modeling/entity/entity.h"
 #include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/basegroup.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/modeling/texture/texture.h"
 #include "renderer/utility/paramarray.h"
@@ -68,16 +71,128 @@ TextureStore::TextureStore(
   : m_tile_swapper(scene, params)
   , m_tile_cache(m_tile_key_hasher, m_tile_swapper)
 {
+    TextureFileBudget::instance().set_max_open_files(
+        params.get_optional<size_t>("max_open_files", TextureFileBudget::DefaultMaxOpenFiles));
+}
+
+void TextureStore::set_memory_limit(const size_t limit)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_tile_swapper.set_memory_limit(limit);
+}
+
+size_t TextureStore::get_memory_limit() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_tile_swapper.get_memory_limit();
+}
+
+size_t TextureStore::get_memory_size() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_tile_swapper.get_memory_size();
+}
+
+uint64 TextureStore::get_hit_count() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_tile_cache.get_hit_count();
+}
+
+uint64 TextureStore::get_miss_count() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_tile_cache.get_miss_count();
+}
+
+void TextureStore::get_texture_statistics(TextureStatsVector& stats) const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_tile_swapper.get_texture_statistics(stats);
 }
 
 StatisticsVector TextureStore::get_statistics() const
 {
+    boost::mutex::scoped_lock lock(m_mutex);
+
     Statistics stats = make_single_stage_cache_stats(m_tile_cache);
+    stats.insert_size("size limit", m_tile_swapper.get_memory_limit());
     stats.insert_size("peak size", m_tile_swapper.get_peak_memory_size());
 
     return StatisticsVector::make("texture store statistics", stats);
 }
 
+namespace
+{
+    uint64 compute_textures_signature(const BaseGroup& group)
+    {
+        uint64 signature = 0;
+
+        for (const_each<TextureContainer> i = group.textures(); i; ++i)
+            signature = Entity::combine_signatures(signature, i->compute_signature());
+
+        for (const_each<AssemblyContainer> i = group.assemblies(); i; ++i)
+        {
+            signature = Entity::combine_signatures(signature, i->get_uid());
+            signature = Entity::combine_signatures(signature, compute_textures_signature(*i));
+        }
+
+        return signature;
+    }
+}
+
+uint64 TextureStore::compute_signature(const Scene& scene)
+{
+    return compute_textures_signature(scene);
+}
+
+void TextureStore::load_tile(const TileKey& key, TileRecord& record)
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        // Sleep while another thread is loading this tile.
+        while (atomic_read(&record.m_state) == TileLoading)
+            m_tile_load_ended.wait(lock);
+
+        if (atomic_read(&record.m_state) == TileLoaded)
+            return;
+
+        // This thread is in charge of loading the tile.
+        atomic_write(&record.m_state, TileLoading);
+    }
+
+    Tile* tile;
+
+    try
+    {
+        tile = m_tile_swapper.load_tile(key);
+    }
+    catch (...)
+    {
+        // Let another thread retry and give up ownership of the record.
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            atomic_write(&record.m_state, TileNotLoaded);
+        }
+
+        m_tile_load_ended.notify_all();
+        atomic_dec(&record.m_owners);
+        throw;
+    }
+
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_tile_swapper.track_loaded_tile(key, *tile);
+
+        // Publish the tile. atomic_cas() acts as a full memory barrier for lock-free readers.
+        record.m_tile = tile;
+        atomic_cas(&record.m_state, TileLoading, TileLoaded);
+    }
+
+    m_tile_load_ended.notify_all();
+}
+
 Dictionary TextureStore::get_params_metadata()
 {
     Dictionary metadata;
@@ -91,10 +206,30 @@ Dictionary TextureStore::get_params_metadata()
             .insert("label", "Texture Cache Size")
             .insert("help", "Texture cache size in bytes"));
 
+    metadata.dictionaries().insert(
+        "max_open_files",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", static_cast<size_t>(TextureFileBudget::DefaultMaxOpenFiles))
+            .insert("label", "Max Open Texture Files")
+            .insert("help", "Maximum number of texture files kept open at the same time, across all textures"));
+
     return metadata;
 }
 
 
+//
+// TextureStore::TextureStats class implementation.
+//
+
+TextureStore::TextureStats::TextureStats()
+  : m_hit_count(0)
+  , m_miss_count(0)
+  , m_bytes_read(0)
+{
+}
+
+
 //
 // TextureStore::TileSwapper class implementation.
 //
@@ -165,22 +300,32 @@ TextureStore::TileSwapper::TileSwapper(
     const ParamArray&   params)
   : m_scene(scene)
   , m_params(params)
+  , m_memory_limit(params.get_optional<size_t>("max_size", 256 * 1024 * 1024))
   , m_memory_size(0)
   , m_peak_memory_size(0)
+  , m_last_texture_key(UniqueID(~0), UniqueID(~0))
+  , m_last_texture_counters(0)
 {
+    assert(m_memory_limit > 0);
+
     gather_assemblies(scene.assemblies());
 }
 
 void TextureStore::TileSwapper::load(const TileKey& key, TileRecord& record)
 {
-    // Fetch the texture container.
-    const TextureContainer& textures =
-        key.m_assembly_uid == UniqueID(~0)
-            ? m_scene.textures()
-            : m_assemblies[key.m_assembly_uid]->textures();
+    // track_access() was just called for this key: the last texture is the right one.
+    assert(m_last_texture_counters);
+    ++m_last_texture_counters->m_miss_count;
 
+    record.m_tile = 0;
+    record.m_owners = 0;
+    record.m_state = TileNotLoaded;
+}
+
+Tile* TextureStore::TileSwapper::load_tile(const TileKey& key) const
+{
     // Fetch the texture.
-    Texture* texture = textures.get_by_uid(key.m_texture_uid);
+    Texture* texture = get_texture(key);
 
     if (m_params.m_track_tile_loading)
     {
@@ -193,8 +338,7 @@ void TextureStore::TileSwapper::load(const TileKey& key, TileRecord& record)
     }
 
     // Load the tile.
-    record.m_tile = texture->load_tile(key.get_tile_x(), key.get_tile_y());
-    record.m_owners = 0;
+    Tile* tile = texture->load_tile(key.get_tile_x(), key.get_tile_y());
 
     // Convert the tile to the linear RGB color space.
     switch (texture->get_color_space())
@@ -203,37 +347,49 @@ void TextureStore::TileSwapper::load(const TileKey& key, TileRecord& record)
         break;
 
       case ColorSpaceSRGB:
-        convert_tile_srgb_to_linear_rgb(*record.m_tile);
+        convert_tile_srgb_to_linear_rgb(*tile);
         break;
 
       case ColorSpaceCIEXYZ:
-        convert_tile_ciexyz_to_linear_rgb(*record.m_tile);
+        convert_tile_ciexyz_to_linear_rgb(*tile);
         break;
 
       assert_otherwise;
     }
 
+    return tile;
+}
+
+void TextureStore::TileSwapper::track_access(const TileKey& key)
+{
+    ++get_texture_counters(key).m_access_count;
+}
+
+void TextureStore::TileSwapper::track_loaded_tile(const TileKey& key, const Tile& tile)
+{
+    get_texture_counters(key).m_bytes_read += tile.get_size();
+
     // Track the amount of memory used by the tile cache.
-    m_memory_size += record.m_tile->get_memory_size();
+    m_memory_size += tile.get_memory_size();
     m_peak_memory_size = max(m_peak_memory_size, m_memory_size);
 
     if (m_params.m_track_store_size)
     {
-        if (m_memory_size > m_params.m_memory_limit)
+        if (m_memory_size > m_memory_limit)
         {
             RENDERER_LOG_DEBUG(
                 "texture store size is %s, exceeding capacity %s by %s",
                 pretty_size(m_memory_size).c_str(),
-                pretty_size(m_params.m_memory_limit).c_str(),
-                pretty_size(m_memory_size - m_params.m_memory_limit).c_str());
+                pretty_size(m_memory_limit).c_str(),
+                pretty_size(m_memory_size - m_memory_limit).c_str());
         }
         else
         {
             RENDERER_LOG_DEBUG(
                 "texture store size is %s, below capacity %s by %s",
                 pretty_size(m_memory_size).c_str(),
-                pretty_size(m_params.m_memory_limit).c_str(),
-                pretty_size(m_params.m_memory_limit - m_memory_size).c_str());
+                pretty_size(m_memory_limit).c_str(),
+                pretty_size(m_memory_limit - m_memory_size).c_str());
         }
     }
 }
@@ -244,19 +400,17 @@ bool TextureStore::TileSwapper::unload(const TileKey& key, TileRecord& record)
     if (atomic_read(&record.m_owners) > 0)
         return false;
 
+    // Tiles that failed to load have nothing to unload.
+    if (record.m_tile == 0)
+        return true;
+
     // Track the amount of memory used by the tile cache.
     const size_t tile_memory_size = record.m_tile->get_memory_size();
     assert(m_memory_size >= tile_memory_size);
     m_memory_size -= tile_memory_size;
 
-    // Fetch the texture container.
-    const TextureContainer& textures =
-        key.m_assembly_uid == UniqueID(~0)
-            ? m_scene.textures()
-            : m_assemblies[key.m_assembly_uid]->textures();
-
     // Fetch the texture.
-    Texture* texture = textures.get_by_uid(key.m_texture_uid);
+    Texture* texture = get_texture(key);
 
     if (m_params.m_track_tile_unloading)
     {
@@ -284,18 +438,75 @@ void TextureStore::TileSwapper::gather_assemblies(const AssemblyContainer& assem
     }
 }
 
+Texture* TextureStore::TileSwapper::get_texture(const TileKey& key) const
+{
+    // Fetch the texture container.
+    const TextureContainer& textures =
+        key.m_assembly_uid == UniqueID(~0)
+            ? m_scene.textures()
+            : m_assemblies.find(key.m_assembly_uid)->second->textures();
+
+    // Fetch the texture.
+    return textures.get_by_uid(key.m_texture_uid);
+}
+
+TextureStore::TileSwapper::TextureCounters& TextureStore::TileSwapper::get_texture_counters(const TileKey& key)
+{
+    const TextureKey texture_key(key.m_assembly_uid, key.m_texture_uid);
+
+    // Consecutive accesses usually hit the same texture.
+    if (texture_key != m_last_texture_key)
+    {
+        TextureCountersMap::iterator i = m_texture_counters.find(texture_key);
+
+        if (i == m_texture_counters.end())
+        {
+            TextureCounters counters;
+            counters.m_access_count = 0;
+            counters.m_miss_count = 0;
+            counters.m_bytes_read = 0;
+            i = m_texture_counters.insert(make_pair(texture_key, counters)).first;
+        }
+
+        m_last_texture_key = texture_key;
+        m_last_texture_counters = &i->second;
+    }
+
+    return *m_last_texture_counters;
+}
+
+void TextureStore::TileSwapper::get_texture_statistics(TextureStatsVector& stats) const
+{
+    stats.clear();
+    stats.reserve(m_texture_counters.size());
+
+    for (const_each<TextureCountersMap> i = m_texture_counters; i; ++i)
+    {
+        const TextureKey& texture_key = i->first;
+        const TextureCounters& counters = i->second;
+
+        const Texture* texture =
+            get_texture(TileKey(texture_key.first, texture_key.second, 0));
+
+        TextureStats texture_stats;
+        texture_stats.m_name = texture->get_path().c_str();
+        texture_stats.m_hit_count = counters.m_access_count - counters.m_miss_count;
+        texture_stats.m_miss_count = counters.m_miss_count;
+        texture_stats.m_bytes_read = counters.m_bytes_read;
+        stats.push_back(texture_stats);
+    }
+}
+
 
 //
 // TextureStore::TileSwapper::Parameters class implementation.
 //
 
 TextureStore::TileSwapper::Parameters::Parameters(const ParamArray& params)
-  : m_memory_limit(params.get_optional<size_t>("max_size", 256 * 1024 * 1024))
-  , m_track_tile_loading(params.get_optional<bool>("track_tile_loading", false))
+  : m_track_tile_loading(params.get_optional<bool>("track_tile_loading", false))
   , m_track_tile_unloading(params.get_optional<bool>("track_tile_unloading", false))
   , m_track_store_size(params.get_optional<bool>("track_store_size", false))
 {
-    assert(m_memory_limit > 0);
 }
 
 }   // namespace renderer
@@ -42,10 +42,17 @@
 #include "foundation/utility/cache.h"
 #include "foundation/utility/uid.h"
 
+// Boost headers.
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/mutex.hpp"
+
 // Standard headers.
 #include <cassert>
 #include <cstddef>
 #include <map>
+#include <string>
+#include <utility>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class Dictionary; }
@@ -53,6 +60,7 @@ namespace foundation    { class StatisticsVector; }
 namespace foundation    { class Tile; }
 namespace renderer      { class ParamArray; }
 namespace renderer      { class Scene; }
+namespace renderer      { class Texture; }
 
 namespace renderer
 {
@@ -99,26 +107,73 @@ class TextureStore
         bool operator<(const TileKey& rhs) const;
     };
 
+    // Loading state of a tile record.
+    enum TileState
+    {
+        TileNotLoaded,
+        TileLoading,
+        TileLoaded
+    };
+
     struct TileRecord
     {
         foundation::Tile*           m_tile;
         volatile foundation::uint32 m_owners;
+        volatile foundation::uint32 m_state;        // one of the TileState values
+    };
+
+    // Access statistics of a single texture.
+    struct TextureStats
+    {
+        std::string                 m_name;
+        foundation::uint64          m_hit_count;
+        foundation::uint64          m_miss_count;
+        foundation::uint64          m_bytes_read;   // bytes of tile data loaded into the store
+
+        TextureStats();
     };
 
-    // Constructor.
+    typedef std::vector<TextureStats> TextureStatsVector;
+
+    // Constructor. Also sets the maximum number of open files of the process-wide
+    // texture file budget from the "max_open_files" parameter.
     TextureStore(
         const Scene&        scene,
         const ParamArray&   params = ParamArray());
 
     // Acquire an element from the cache. Thread-safe.
+    // Tiles are loaded outside of the store's lock, so that misses on
+    // different tiles, including tiles of the same texture, proceed
+    // in parallel.
     TileRecord& acquire(const TileKey& key);
 
     // Release a previously-acquired element. Thread-safe.
     void release(TileRecord& record) const;
 
+    // Set the maximum amount of memory the store may use, in bytes. Thread-safe.
+    // Lowering the limit evicts tiles as new tiles get loaded.
+    void set_memory_limit(const size_t limit);
+
+    // Return the maximum amount of memory the store may use, in bytes. Thread-safe.
+    size_t get_memory_limit() const;
+
+    // Return the amount of memory currently used by the store, in bytes. Thread-safe.
+    size_t get_memory_size() const;
+
+    // Return the total number of tile hits and misses so far. Thread-safe.
+    foundation::uint64 get_hit_count() const;
+    foundation::uint64 get_miss_count() const;
+
+    // Retrieve the access statistics of all textures accessed so far. Thread-safe.
+    void get_texture_statistics(TextureStatsVector& stats) const;
+
     // Retrieve performance statistics.
     foundation::StatisticsVector get_statistics() const;
 
+    // Compute a signature of the textures and assemblies of a scene. A texture store
+    // may be kept across renders as long as the signature of the scene doesn't change.
+    static foundation::uint64 compute_signature(const Scene& scene);
+
     // Return the metadata of the texture store parameters.
     static foundation::Dictionary get_params_metadata();
 
@@ -137,22 +192,38 @@ class TextureStore
             const Scene&        scene,
             const ParamArray&   params);
 
-        // Load a cache line.
+        // Load a cache line. The tile itself is loaded by load_tile().
         void load(const TileKey& key, TileRecord& record);
 
         // Unload a cache line.
         bool unload(const TileKey& key, TileRecord& record);
 
+        // Load and convert the tile of a cache line. Thread-safe.
+        foundation::Tile* load_tile(const TileKey& key) const;
+
+        // Account for a tile access. Must be called with the store's lock held.
+        void track_access(const TileKey& key);
+
+        // Account for a newly loaded tile. Must be called with the store's lock held.
+        void track_loaded_tile(const TileKey& key, const foundation::Tile& tile);
+
         // Return true if the cache is full, false otherwise.
         bool is_full(const size_t element_count) const;
 
-        // Return the peak memory size in bytes of the tile cache.
+        // Get/set the memory limit in bytes of the tile cache.
+        void set_memory_limit(const size_t limit);
+        size_t get_memory_limit() const;
+
+        // Return the current and peak memory size in bytes of the tile cache.
+        size_t get_memory_size() const;
         size_t get_peak_memory_size() const;
 
+        // Retrieve the access statistics of all textures accessed so far.
+        void get_texture_statistics(TextureStatsVector& stats) const;
+
       private:
         struct Parameters
         {
-            const size_t    m_memory_limit;
             const bool      m_track_tile_loading;
             const bool      m_track_tile_unloading;
             const bool      m_track_store_size;
@@ -162,13 +233,32 @@ class TextureStore
 
         typedef std::map<foundation::UniqueID, const Assembly*> AssemblyMap;
 
+        // Per-texture counters, keyed by (assembly UID, texture UID).
+        struct TextureCounters
+        {
+            foundation::uint64  m_access_count;
+            foundation::uint64  m_miss_count;
+            foundation::uint64  m_bytes_read;
+        };
+
+        typedef std::pair<foundation::UniqueID, foundation::UniqueID> TextureKey;
+        typedef std::map<TextureKey, TextureCounters> TextureCountersMap;
+
         const Scene&        m_scene;
         const Parameters    m_params;
+        size_t              m_memory_limit;
         size_t              m_memory_size;
         size_t              m_peak_memory_size;
         AssemblyMap         m_assemblies;
+        TextureCountersMap  m_texture_counters;
+        TextureKey          m_last_texture_key;
+        TextureCounters*    m_last_texture_counters;
 
         void gather_assemblies(const AssemblyContainer& assemblies);
+
+        TextureCounters& get_texture_counters(const TileKey& key);
+
+        Texture* get_texture(const TileKey& key) const;
     };
 
     typedef foundation::LRUCache<
@@ -178,10 +268,13 @@ class TextureStore
         TileSwapper
     > TileCache;
 
-    boost::mutex            m_mutex;
-    TileKeyHasher           m_tile_key_hasher;
-    TileSwapper             m_tile_swapper;
-    TileCache               m_tile_cache;
+    mutable boost::mutex        m_mutex;
+    boost::condition_variable   m_tile_load_ended;  // notified when a tile finishes or fails loading
+    TileKeyHasher               m_tile_key_hasher;
+    TileSwapper                 m_tile_swapper;
+    TileCache                   m_tile_cache;
+
+    void load_tile(const TileKey& key, TileRecord& record);
 };
 
 
@@ -191,12 +284,20 @@ class TextureStore
 
 inline TextureStore::TileRecord& TextureStore::acquire(const TileKey& key)
 {
-    boost::mutex::scoped_lock lock(m_mutex);
+    TileRecord* record;
+
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        m_tile_swapper.track_access(key);
+        record = &m_tile_cache.get(key);
+        foundation::atomic_inc(&record->m_owners);
+    }
 
-    TileRecord& record = m_tile_cache.get(key);
-    foundation::atomic_inc(&record.m_owners);
+    if (foundation::atomic_read(&record->m_state) != TileLoaded)
+        load_tile(key, *record);
 
-    return record;
+    return *record;
 }
 
 inline void TextureStore::release(TileRecord& record) const
@@ -299,7 +400,23 @@ inline size_t TextureStore::TileKeyHasher::operator()(const TileKey& key) const
 
 inline bool TextureStore::TileSwapper::is_full(const size_t element_count) const
 {
-    return m_memory_size >= m_params.m_memory_limit;
+    return m_memory_size >= m_memory_limit;
+}
+
+inline void TextureStore::TileSwapper::set_memory_limit(const size_t limit)
+{
+    assert(limit > 0);
+    m_memory_limit = limit;
+}
+
+inline size_t TextureStore::TileSwapper::get_memory_limit() const
+{
+    return m_memory_limit;
+}
+
+inline size_t TextureStore::TileSwapper::get_memory_size() const
+{
+    return m_memory_size;
 }
 
 inline size_t TextureStore::TileSwapper::get_peak_memory_size() const
@@ -0,0 +1,118 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/intersection/bvhcache.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+#include "foundation/utility/bufferedfile.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Intersection_BVHCache)
+{
+    struct Fixture
+    {
+        Fixture()
+        {
+            BVHCache::configure(
+                ParamArray()
+                    .insert("directory", "unit tests/outputs/test_bvhcache"));
+        }
+
+        ~Fixture()
+        {
+            // Disable the cache.
+            BVHCache::configure(ParamArray());
+        }
+
+        static bool store(const uint64 key, const vector<uint32>& values)
+        {
+            BufferedFile file;
+            string temp_path;
+
+            if (!BVHCache::open_for_writing(key, file, temp_path))
+                return false;
+
+            const bool success = BVHCache::write_vector(file, values);
+            BVHCache::close_for_writing(key, file, temp_path, success);
+
+            return success;
+        }
+
+        static bool load(const uint64 key, vector<uint32>& values)
+        {
+            BufferedFile file;
+            uint64 file_size;
+
+            if (!BVHCache::open_for_reading(key, file, file_size))
+                return false;
+
+            return BVHCache::read_vector(file, file_size, values);
+        }
+    };
+
+    TEST_CASE(IsEnabled_GivenNoDirectory_ReturnsFalse)
+    {
+        BVHCache::configure(ParamArray());
+
+        EXPECT_FALSE(BVHCache::is_enabled());
+    }
+
+    TEST_CASE_F(Load_GivenStoredKey_ReturnsStoredValues, Fixture)
+    {
+        vector<uint32> values;
+        values.push_back(1);
+        values.push_back(2);
+        values.push_back(3);
+
+        ASSERT_TRUE(store(42, values));
+
+        vector<uint32> loaded_values;
+        ASSERT_TRUE(load(42, loaded_values));
+
+        EXPECT_EQ(values, loaded_values);
+    }
+
+    TEST_CASE_F(Load_GivenUnknownKey_ReturnsFalse, Fixture)
+    {
+        vector<uint32> loaded_values;
+
+        EXPECT_FALSE(load(0xDEADBEEF, loaded_values));
+    }
+}
@@ -0,0 +1,335 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/lighting/directlightingintegrator.h"
+#include "renderer/kernel/lighting/lightsampler.h"
+#include "renderer/kernel/lighting/materialsamplers.h"
+#include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/kernel/lighting/shadowraybatch.h"
+#include "renderer/kernel/lighting/tracer.h"
+#include "renderer/kernel/rendering/rendererservices.h"
+#include "renderer/kernel/shading/oslshadergroupexec.h"
+#include "renderer/kernel/shading/shadingcontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/entity/onframebeginrecorder.h"
+#include "renderer/modeling/light/light.h"
+#include "renderer/modeling/light/pointlight.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/math/dual.h"
+#include "foundation/math/matrix.h"
+#include "foundation/math/mis.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/arena.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/string.h"
+#include "foundation/utility/test.h"
+
+// OSL headers.
+#include "foundation/platform/_beginoslheaders.h"
+#include "OSL/oslexec.h"
+#include "foundation/platform/_endoslheaders.h"
+
+// OpenImageIO headers.
+#include "foundation/platform/_beginoiioheaders.h"
+#include "OpenImageIO/texture.h"
+#include "foundation/platform/_endoiioheaders.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Lighting_DirectLightingIntegrator)
+{
+    // A material sampler at the origin that doesn't trace rays: light samples located
+    // below the z = 0 plane are occluded, all the others are visible.
+    class TestMaterialSampler
+      : public IMaterialSampler
+    {
+      public:
+        mutable size_t  m_shadow_ray_count;
+        mutable size_t  m_evaluation_count;
+
+        TestMaterialSampler()
+          : m_shadow_ray_count(0)
+          , m_evaluation_count(0)
+          , m_point(0.0)
+        {
+        }
+
+        virtual const Vector3d& get_point() const override
+        {
+            return m_point;
+        }
+
+        virtual bool contributes_to_light_sampling() const override
+        {
+            return true;
+        }
+
+        virtual const ShadingPoint& trace(
+            const ShadingContext&   shading_context,
+            const Vector3f&         direction,
+            float&                  transmission) const override
+        {
+            transmission = 0.0f;
+            return m_shading_point;
+        }
+
+        virtual float trace_between(
+            const ShadingContext&   shading_context,
+            const Vector3d&         target_position) const override
+        {
+            ++m_shadow_ray_count;
+            return target_position.z < 0.0 ? 0.0f : 0.5f;
+        }
+
+        virtual bool sample(
+            SamplingContext&        sampling_context,
+            const Dual3d&           outgoing,
+            Dual3f&                 incoming,
+            Spectrum&               value,
+            float&                  pdf) const override
+        {
+            return false;
+        }
+
+        virtual float evaluate(
+            const int               light_sampling_modes,
+            const Vector3f&         outgoing,
+            const Vector3f&         incoming,
+            Spectrum&               value) const override
+        {
+            ++m_evaluation_count;
+            value.set(0.3f * abs(incoming.z));
+            return RcpPi<float>();
+        }
+
+        virtual bool cull_incoming_direction(
+            const Vector3d&         incoming) const override
+        {
+            return false;
+        }
+
+      private:
+        const Vector3d      m_point;
+        ShadingPoint        m_shading_point;
+    };
+
+    // More lights than shadow rays in a full batch.
+    const size_t LightCount = 2 * ShadowRayBatch::MaxSize + 3;
+
+    struct Fixture
+      : public TestFixtureBase
+    {
+        Fixture()
+        {
+            create_color_entity("white", Color3f(1.0f));
+
+            // Lights alternate between the upper and the lower half-spaces.
+            for (size_t i = 0; i < LightCount; ++i)
+            {
+                const double angle = TwoPi<double>() * i / LightCount;
+                const Vector3d position(cos(angle), sin(angle), i % 2 == 0 ? 1.0 : -1.0);
+
+                auto_release_ptr<Light> light(
+                    PointLightFactory().create(
+                        ("light" + to_string(i)).c_str(),
+                        ParamArray().insert("intensity", "white")));
+                light->set_transform(
+                    Transformd::from_local_to_parent(Matrix4d::make_translation(position)));
+                m_assembly.lights().insert(light);
+            }
+
+            m_scene.assembly_instances().insert(
+                AssemblyInstanceFactory::create(
+                    "assembly_instance",
+                    ParamArray(),
+                    "assembly"));
+
+            bind_inputs();
+        }
+
+        Spectrum compute_radiance(
+            const bool                  low_variance,
+            const size_t                shadow_ray_batch_size,
+            const TestMaterialSampler&  material_sampler,
+            const bool                  coherent_shading = false)
+        {
+            OnFrameBeginRecorder recorder;
+            for (each<LightContainer> i = m_assembly.lights(); i; ++i)
+                i->on_frame_begin(m_project, &m_assembly, recorder);
+
+            TextureStore texture_store(m_scene);
+            TextureCache texture_cache(texture_store);
+
+            shared_ptr<OIIO::TextureSystem> texture_system(
+                OIIO::TextureSystem::create(),
+                [](OIIO::TextureSystem* object) { OIIO::TextureSystem::destroy(object); });
+
+            RendererServices renderer_services(
+                m_project,
+                *texture_system);
+
+            shared_ptr<OSL::ShadingSystem> shading_system(
+                new OSL::ShadingSystem(&renderer_services, texture_system.get()));
+
+            Intersector intersector(
+                m_project.get_trace_context(),
+                texture_cache);
+
+            Arena arena;
+            OSLShaderGroupExec sg_exec(*shading_system, arena);
+
+            Tracer tracer(
+                m_scene,
+                intersector,
+                texture_cache,
+                sg_exec);
+
+            ShadingContext shading_context(
+                intersector,
+                tracer,
+                texture_cache,
+                *texture_system,
+                sg_exec,
+                arena,
+                0);
+
+            const LightSampler light_sampler(m_scene);
+            const ShadingRay::Time time;
+
+            const DirectLightingIntegrator integrator(
+                shading_context,
+                light_sampler,
+                material_sampler,
+                time,
+                ScatteringMode::All,
+                1,                      // material_sample_count
+                LightCount,             // light_sample_count
+                0.0f,                   // low_light_threshold
+                false,                  // indirect
+                shadow_ray_batch_size,
+                coherent_shading);
+
+            MersenneTwister rng;
+            SamplingContext sampling_context(rng, SamplingContext::RNGMode);
+
+            const Dual3d outgoing(Vector3d(0.0, 0.0, 1.0));
+            Spectrum radiance;
+
+            if (low_variance)
+            {
+                integrator.compute_outgoing_radiance_light_sampling_low_variance(
+                    sampling_context,
+                    MISPower2,
+                    outgoing,
+                    radiance);
+            }
+            else
+            {
+                integrator.compute_outgoing_radiance_light_sampling(
+                    sampling_context,
+                    MISPower2,
+                    outgoing,
+                    radiance);
+            }
+
+            recorder.on_frame_end(m_project);
+
+            return radiance;
+        }
+    };
+
+    TEST_CASE_F(ComputeOutgoingRadianceLightSampling_BatchedAndUnbatchedShadowRays_ReturnSameRadiance, Fixture)
+    {
+        const TestMaterialSampler material_sampler;
+
+        const Spectrum unbatched = compute_radiance(false, 1, material_sampler);
+        const Spectrum batched = compute_radiance(false, ShadowRayBatch::MaxSize, material_sampler);
+
+        EXPECT_TRUE(unbatched == batched);
+        EXPECT_GT(0.0f, unbatched[0]);
+    }
+
+    TEST_CASE_F(ComputeOutgoingRadianceLightSamplingLowVariance_BatchedAndUnbatchedShadowRays_ReturnSameRadiance, Fixture)
+    {
+        const TestMaterialSampler material_sampler;
+
+        const Spectrum unbatched = compute_radiance(true, 1, material_sampler);
+        const Spectrum batched = compute_radiance(true, ShadowRayBatch::MaxSize, material_sampler);
+
+        EXPECT_TRUE(unbatched == batched);
+        EXPECT_GT(0.0f, unbatched[0]);
+    }
+
+    TEST_CASE_F(ComputeOutgoingRadianceLightSamplingLowVariance_GivenOccludedLights_DoesNotEvaluateMaterialForOccludedSamples, Fixture)
+    {
+        const TestMaterialSampler material_sampler;
+
+        compute_radiance(true, ShadowRayBatch::MaxSize, material_sampler);
+
+        // Every light casts one shadow ray, but only the lights above the point are evaluated.
+        EXPECT_EQ(LightCount, material_sampler.m_shadow_ray_count);
+        EXPECT_EQ((LightCount + 1) / 2, material_sampler.m_evaluation_count);
+    }
+
+    TEST_CASE_F(ComputeOutgoingRadianceLightSamplingLowVariance_CoherentAndIncoherentShading_ReturnSameRadiance, Fixture)
+    {
+        const TestMaterialSampler material_sampler;
+
+        const Spectrum incoherent = compute_radiance(true, ShadowRayBatch::MaxSize, material_sampler, false);
+        const Spectrum coherent = compute_radiance(true, ShadowRayBatch::MaxSize, material_sampler, true);
+
+        EXPECT_TRUE(incoherent == coherent);
+        EXPECT_GT(0.0f, coherent[0]);
+    }
+}
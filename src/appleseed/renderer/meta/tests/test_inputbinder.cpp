@@ -0,0 +1,139 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/modeling/bsdf/bsdf.h"
+#include "renderer/modeling/bsdf/lambertianbrdf.h"
+#include "renderer/modeling/color/colorentity.h"
+#include "renderer/modeling/input/inputbinder.h"
+#include "renderer/modeling/input/source.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_Input_InputBinder)
+{
+    struct Fixture
+      : public TestFixtureBase
+    {
+        BSDF* m_bsdf;
+
+        Fixture()
+        {
+            create_color_entity("color", Color3f(0.5f));
+
+            m_assembly.bsdfs().insert(
+                LambertianBRDFFactory().create(
+                    "bsdf",
+                    ParamArray().insert("reflectance", "color")));
+
+            m_bsdf = m_assembly.bsdfs().get_by_name("bsdf");
+        }
+
+        const Source* get_reflectance_source() const
+        {
+            return m_bsdf->get_inputs().source("reflectance");
+        }
+    };
+
+    TEST_CASE_F(Bind_GivenUnchangedScene_DoesNotRebindInputs, Fixture)
+    {
+        InputBinder input_binder;
+        input_binder.bind(m_scene);
+        const Source* source = get_reflectance_source();
+
+        input_binder.bind(m_scene);
+
+        ASSERT_EQ(0, input_binder.get_error_count());
+        EXPECT_EQ(source, get_reflectance_source());
+    }
+
+    TEST_CASE_F(Bind_AfterBumpingVersionOfEntity_RebindsInputs, Fixture)
+    {
+        InputBinder input_binder;
+        input_binder.bind(m_scene);
+        const Source* source = get_reflectance_source();
+
+        m_bsdf->bump_version_id();
+        input_binder.bind(m_scene);
+
+        ASSERT_EQ(0, input_binder.get_error_count());
+        EXPECT_NEQ(source, get_reflectance_source());
+    }
+
+    TEST_CASE_F(Bind_AfterEditingParametersOfEntityInPlace_RebindsInputs, Fixture)
+    {
+        InputBinder input_binder;
+        input_binder.bind(m_scene);
+
+        m_bsdf->get_parameters().insert("reflectance", "0.8");
+        input_binder.bind(m_scene);
+
+        ASSERT_EQ(0, input_binder.get_error_count());
+
+        float reflectance;
+        get_reflectance_source()->evaluate_uniform(reflectance);
+        EXPECT_FEQ(0.8f, reflectance);
+    }
+
+    TEST_CASE_F(Bind_AfterReplacingSceneEntity_RebindsInputsOfAssemblyEntities, Fixture)
+    {
+        InputBinder input_binder;
+        input_binder.bind(m_scene);
+        const Source* source = get_reflectance_source();
+
+        m_scene.colors().remove(m_scene.colors().get_by_name("color"));
+        create_color_entity("color", Color3f(0.8f));
+        input_binder.bind(m_scene);
+
+        ASSERT_EQ(0, input_binder.get_error_count());
+        EXPECT_NEQ(source, get_reflectance_source());
+    }
+
+    TEST_CASE_F(Bind_GivenNewBinder_BindsAllInputs, Fixture)
+    {
+        InputBinder first_input_binder;
+        first_input_binder.bind(m_scene);
+        const Source* source = get_reflectance_source();
+
+        InputBinder second_input_binder;
+        second_input_binder.bind(m_scene);
+
+        ASSERT_EQ(0, second_input_binder.get_error_count());
+        EXPECT_NEQ(source, get_reflectance_source());
+    }
+}
@@ -0,0 +1,451 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersectionfilter.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/intersection/tracecontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/textureinstance.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/modeling/texture/texture.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/colorspace.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Intersection_IntersectionFilter)
+{
+    // An 8x8 RGBA texture whose left half is opaque and whose right half is transparent.
+    class HalfTransparentTexture
+      : public Texture
+    {
+      public:
+        explicit HalfTransparentTexture(const char* name)
+          : Texture(name, ParamArray())
+          , m_props(
+                8, 8,
+                8, 8,
+                4,
+                PixelFormatFloat)
+        {
+            m_tile.reset(
+                new Tile(
+                    m_props.m_canvas_width,
+                    m_props.m_canvas_height,
+                    m_props.m_channel_count,
+                    m_props.m_pixel_format));
+
+            for (size_t y = 0; y < m_props.m_canvas_height; ++y)
+            {
+                for (size_t x = 0; x < m_props.m_canvas_width; ++x)
+                {
+                    const float alpha = x < m_props.m_canvas_width / 2 ? 1.0f : 0.0f;
+                    m_tile->set_pixel(x, y, Color4f(1.0f, 1.0f, 1.0f, alpha));
+                }
+            }
+        }
+
+        virtual void release() override
+        {
+            delete this;
+        }
+
+        virtual const char* get_model() const override
+        {
+            return "half_transparent_texture";
+        }
+
+        virtual ColorSpace get_color_space() const override
+        {
+            return ColorSpaceLinearRGB;
+        }
+
+        virtual const CanvasProperties& properties() override
+        {
+            return m_props;
+        }
+
+        virtual Tile* load_tile(
+            const size_t    tile_x,
+            const size_t    tile_y) override
+        {
+            assert(tile_x == 0);
+            assert(tile_y == 0);
+
+            return m_tile.get();
+        }
+
+        virtual void unload_tile(
+            const size_t    tile_x,
+            const size_t    tile_y,
+            const Tile*     tile) override
+        {
+        }
+
+      private:
+        const CanvasProperties  m_props;
+        auto_ptr<Tile>          m_tile;
+    };
+
+    // Push a triangle of the plane z = z, covering the point (x, 0, z), whose U texture
+    // coordinate grows linearly with the X coordinate: u = u0 + 0.1 * (x' - x).
+    void push_triangle(
+        MeshObject&     mesh_object,
+        const double    x,
+        const double    z,
+        const float     u0,
+        const float     du = 0.1f)
+    {
+        const size_t v0 = mesh_object.push_vertex(GVector3(GScalar(x - 1.0), GScalar(-1.0), GScalar(z)));
+        const size_t v1 = mesh_object.push_vertex(GVector3(GScalar(x + 3.0), GScalar(-1.0), GScalar(z)));
+        const size_t v2 = mesh_object.push_vertex(GVector3(GScalar(x - 1.0), GScalar(3.0), GScalar(z)));
+
+        const size_t a0 = mesh_object.push_tex_coords(GVector2(GScalar(u0 - du), GScalar(0.5)));
+        const size_t a1 = mesh_object.push_tex_coords(GVector2(GScalar(u0 + 3.0f * du), GScalar(0.5)));
+        const size_t a2 = mesh_object.push_tex_coords(GVector2(GScalar(u0 - du), GScalar(0.5)));
+
+        mesh_object.push_triangle(
+            Triangle(
+                v0, v1, v2,
+                Triangle::None, Triangle::None, Triangle::None,
+                a0, a1, a2,
+                0));
+    }
+
+    // A scene with a single mesh object whose alpha map is a HalfTransparentTexture.
+    // Derived classes fill the mesh object.
+    struct TestSceneBase
+    {
+        auto_release_ptr<Scene> m_scene;
+
+        TestSceneBase()
+          : m_scene(SceneFactory::create())
+        {
+        }
+
+        void create_scene(
+            auto_release_ptr<MeshObject>    mesh_object,
+            const ParamArray&               assembly_params = ParamArray())
+        {
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory().create("assembly", assembly_params));
+
+            assembly->textures().insert(
+                auto_release_ptr<Texture>(new HalfTransparentTexture("texture")));
+
+            ParamArray texture_instance_params;
+            texture_instance_params.insert("addressing_mode", "clamp");
+            texture_instance_params.insert("filtering_mode", "nearest");
+
+            assembly->texture_instances().insert(
+                TextureInstanceFactory::create(
+                    "texture_instance",
+                    texture_instance_params,
+                    "texture",
+                    Transformf::identity()));
+
+            assembly->objects().insert(auto_release_ptr<Object>(mesh_object.release()));
+
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "object_instance",
+                    ParamArray(),
+                    "object",
+                    Transformd::identity(),
+                    StringDictionary()));
+
+            m_scene->assembly_instances().insert(
+                auto_release_ptr<AssemblyInstance>(
+                    AssemblyInstanceFactory::create(
+                        "assembly_instance",
+                        ParamArray(),
+                        "assembly")));
+
+            m_scene->assemblies().insert(assembly);
+        }
+
+        static auto_release_ptr<MeshObject> create_mesh_object()
+        {
+            return
+                MeshObjectFactory::create(
+                    "object",
+                    ParamArray().insert("alpha_map", "texture_instance"));
+        }
+    };
+
+    // Three triangles of the plane z = 0: an opaque one around x = 0, a transparent one
+    // around x = 10 and a partially transparent one around x = 20, which is opaque for
+    // x < 21 and transparent beyond.
+    struct CoverageTestScene
+      : public TestSceneBase
+    {
+        CoverageTestScene()
+        {
+            auto_release_ptr<MeshObject> mesh_object = create_mesh_object();
+            push_triangle(mesh_object.ref(), 0.0, 0.0, 0.15f);
+            push_triangle(mesh_object.ref(), 10.0, 0.0, 0.65f);
+            push_triangle(mesh_object.ref(), 20.0, 0.0, 0.4f);
+            create_scene(mesh_object);
+        }
+    };
+
+    template <typename TestScene>
+    struct Fixture
+      : public BindInputs<TestScene>
+    {
+        TraceContext    m_trace_context;
+        TextureStore    m_texture_store;
+        TextureCache    m_texture_cache;
+        Intersector     m_intersector;
+
+        Fixture()
+          : m_trace_context(TestScene::m_scene.ref())
+          , m_texture_store(TestScene::m_scene.ref())
+          , m_texture_cache(m_texture_store)
+          , m_intersector(m_trace_context, m_texture_cache)
+        {
+        }
+
+        bool trace(const double x, double& distance)
+        {
+            const ShadingRay ray(
+                Vector3d(x, 0.0, 20.0),
+                Vector3d(0.0, 0.0, -1.0),
+                0.0,                            // tmin
+                100.0,                          // tmax
+                ShadingRay::Time(),
+                VisibilityFlags::CameraRay,
+                0);                             // depth
+
+            ShadingPoint shading_point;
+            if (!m_intersector.trace(ray, shading_point))
+                return false;
+
+            distance = shading_point.get_distance();
+            return true;
+        }
+
+        bool trace_probe(const double x)
+        {
+            const ShadingRay ray(
+                Vector3d(x, 0.0, 20.0),
+                Vector3d(0.0, 0.0, -1.0),
+                0.0,                            // tmin
+                100.0,                          // tmax
+                ShadingRay::Time(),
+                VisibilityFlags::ShadowRay,
+                0);                             // depth
+
+            return m_intersector.trace_probe(ray);
+        }
+    };
+
+    typedef Fixture<CoverageTestScene> CoverageFixture;
+
+    struct IntersectionFilterFixture
+      : public CoverageFixture
+    {
+        auto_ptr<IntersectionFilter> m_filter;
+
+        IntersectionFilterFixture()
+        {
+            const ObjectInstance* object_instance =
+                m_scene->assemblies().get_by_name("assembly")->object_instances().get_by_name("object_instance");
+
+            m_filter.reset(
+                new IntersectionFilter(
+                    object_instance->get_object(),
+                    object_instance->get_front_materials(),
+                    m_texture_cache));
+        }
+
+        IntersectionFilter::Coverage compute_coverage(const float u0, const float u1) const
+        {
+            return
+                m_filter->compute_coverage(
+                    0,
+                    Vector2f(u0, 0.2f),
+                    Vector2f(u1, 0.2f),
+                    Vector2f(u0, 0.8f));
+        }
+    };
+
+    TEST_CASE_F(Constructor_GivenHalfTransparentAlphaMap_CreatesAlphaMask, IntersectionFilterFixture)
+    {
+        EXPECT_TRUE(m_filter->has_alpha_masks());
+    }
+
+    TEST_CASE_F(ComputeCoverage_GivenTriangleCoveringOpaqueTexelsOnly_ReturnsCoverageOpaque, IntersectionFilterFixture)
+    {
+        EXPECT_EQ(IntersectionFilter::CoverageOpaque, compute_coverage(0.05f, 0.45f));
+    }
+
+    TEST_CASE_F(ComputeCoverage_GivenTriangleCoveringTransparentTexelsOnly_ReturnsCoverageTransparent, IntersectionFilterFixture)
+    {
+        EXPECT_EQ(IntersectionFilter::CoverageTransparent, compute_coverage(0.55f, 0.95f));
+    }
+
+    TEST_CASE_F(ComputeCoverage_GivenTriangleCoveringOpaqueAndTransparentTexels_ReturnsCoveragePartial, IntersectionFilterFixture)
+    {
+        EXPECT_EQ(IntersectionFilter::CoveragePartial, compute_coverage(0.3f, 0.7f));
+    }
+
+    TEST_CASE_F(Trace_GivenFullyOpaqueTriangle_ReturnsHit, CoverageFixture)
+    {
+        double distance;
+        const bool hit = trace(0.0, distance);
+
+        ASSERT_TRUE(hit);
+        EXPECT_FEQ(20.0, distance);
+        EXPECT_TRUE(trace_probe(0.0));
+    }
+
+    TEST_CASE_F(Trace_GivenFullyTransparentTriangle_ReturnsNoHit, CoverageFixture)
+    {
+        double distance;
+        const bool hit = trace(10.0, distance);
+
+        EXPECT_FALSE(hit);
+        EXPECT_FALSE(trace_probe(10.0));
+    }
+
+    TEST_CASE_F(Trace_GivenPartiallyTransparentTriangleAndRayThroughOpaqueTexel_ReturnsHit, CoverageFixture)
+    {
+        double distance;
+        const bool hit = trace(20.0, distance);
+
+        ASSERT_TRUE(hit);
+        EXPECT_FEQ(20.0, distance);
+        EXPECT_TRUE(trace_probe(20.0));
+    }
+
+    TEST_CASE_F(Trace_GivenPartiallyTransparentTriangleAndRayThroughTransparentTexel_ReturnsNoHit, CoverageFixture)
+    {
+        double distance;
+        const bool hit = trace(21.5, distance);
+
+        EXPECT_FALSE(hit);
+        EXPECT_FALSE(trace_probe(21.5));
+    }
+
+    // A stack of partially transparent triangles, more than can be deferred in a leaf,
+    // all stored in a single leaf. The ray through x = 0 crosses opaque texels of the
+    // triangles at z = 1, 2 and 4 only. Triangles are inserted in scrambled order.
+    const size_t StackedTriangleCount = 12;
+    const double StackedTriangleZ[StackedTriangleCount] = { 1, 5, 9, 2, 12, 6, 3, 10, 4, 7, 11, 8 };
+
+    bool is_opaque_at_origin(const double z)
+    {
+        return z == 1.0 || z == 2.0 || z == 4.0;
+    }
+
+    struct StackTestScene
+      : public TestSceneBase
+    {
+        StackTestScene()
+        {
+            auto_release_ptr<MeshObject> mesh_object = create_mesh_object();
+
+            for (size_t i = 0; i < StackedTriangleCount; ++i)
+            {
+                // Both kinds of triangles cover opaque and transparent texels.
+                const double z = StackedTriangleZ[i];
+                if (is_opaque_at_origin(z))
+                    push_triangle(mesh_object.ref(), 0.0, z, 0.25f, 0.2f);
+                else push_triangle(mesh_object.ref(), 0.0, z, 0.75f, -0.2f);
+            }
+
+            ParamArray assembly_params;
+            assembly_params.insert_path("acceleration_structure.max_leaf_size", StackedTriangleCount);
+
+            create_scene(mesh_object, assembly_params);
+        }
+    };
+
+    typedef Fixture<StackTestScene> StackFixture;
+
+    TEST_CASE_F(Trace_GivenMoreOverlappingPartiallyTransparentTrianglesThanDeferredHits_ReturnsClosestOpaqueHit, StackFixture)
+    {
+        double distance;
+        const bool hit = trace(0.0, distance);
+
+        ASSERT_TRUE(hit);
+        EXPECT_FEQ(20.0 - 4.0, distance);
+        EXPECT_TRUE(trace_probe(0.0));
+    }
+
+    TEST_CASE_F(Trace_GivenMoreOverlappingPartiallyTransparentTrianglesThanDeferredHitsAndTMaxBeforeOpaqueHits_ReturnsNoHit, StackFixture)
+    {
+        // All triangles between the ray origin and tmax are transparent along the ray.
+        const ShadingRay ray(
+            Vector3d(0.0, 0.0, 20.0),
+            Vector3d(0.0, 0.0, -1.0),
+            0.0,                                // tmin
+            20.0 - 4.5,                         // tmax
+            ShadingRay::Time(),
+            VisibilityFlags::CameraRay,
+            0);                                 // depth
+
+        ShadingPoint shading_point;
+        const bool hit = m_intersector.trace(ray, shading_point);
+
+        EXPECT_FALSE(hit);
+    }
+}
@@ -35,7 +35,9 @@
 #include "renderer/kernel/shading/shadingray.h"
 #include "renderer/kernel/texturing/texturecache.h"
 #include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/object/meshobject.h"
 #include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/triangle.h"
 #include "renderer/modeling/scene/assembly.h"
 #include "renderer/modeling/scene/assemblyinstance.h"
 #include "renderer/modeling/scene/containers.h"
@@ -51,8 +53,12 @@
 #include "foundation/math/vector.h"
 #include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/iostreamop.h"
 #include "foundation/utility/test.h"
 
+// Standard headers.
+#include <cstddef>
+
 using namespace foundation;
 using namespace renderer;
 
@@ -142,4 +148,232 @@ TEST_SUITE(Renderer_Kernel_Intersection_Intersector)
 
         EXPECT_FALSE(hit);
     }
+
+    // A 2x2 square in the z = 0 plane, tessellated into a grid of 8x8 cells, in an
+    // assembly with proxy levels.
+    struct TestSceneWithProxies
+    {
+        auto_release_ptr<Scene> m_scene;
+
+        TestSceneWithProxies()
+          : m_scene(SceneFactory::create())
+        {
+            ParamArray assembly_params;
+            assembly_params.insert_path("acceleration_structure.proxy_levels", 3);
+            assembly_params.insert_path("acceleration_structure.proxy_resolution", 4);
+
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory().create("assembly", assembly_params));
+
+            auto_release_ptr<MeshObject> mesh_object =
+                MeshObjectFactory::create("object", ParamArray());
+
+            const size_t N = 8;
+
+            for (size_t y = 0; y <= N; ++y)
+            {
+                for (size_t x = 0; x <= N; ++x)
+                {
+                    mesh_object->push_vertex(
+                        GVector3(
+                            static_cast<GScalar>(2.0 * x / N - 1.0),
+                            static_cast<GScalar>(2.0 * y / N - 1.0),
+                            GScalar(0.0)));
+                }
+            }
+
+            for (size_t y = 0; y < N; ++y)
+            {
+                for (size_t x = 0; x < N; ++x)
+                {
+                    const size_t v0 = y * (N + 1) + x;
+                    const size_t v1 = v0 + 1;
+                    const size_t v2 = v1 + N + 1;
+                    const size_t v3 = v0 + N + 1;
+                    mesh_object->push_triangle(Triangle(v0, v1, v2, 0));
+                    mesh_object->push_triangle(Triangle(v2, v3, v0, 0));
+                }
+            }
+
+            assembly->objects().insert(auto_release_ptr<Object>(mesh_object.release()));
+
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "object_instance",
+                    ParamArray(),
+                    "object",
+                    Transformd::identity(),
+                    StringDictionary()));
+
+            m_scene->assembly_instances().insert(
+                auto_release_ptr<AssemblyInstance>(
+                    AssemblyInstanceFactory::create(
+                        "assembly_instance",
+                        ParamArray(),
+                        "assembly")));
+
+            m_scene->assemblies().insert(assembly);
+        }
+    };
+
+    struct FixtureWithProxies
+      : public BindInputs<TestSceneWithProxies>
+    {
+        TraceContext    m_trace_context;
+        TextureStore    m_texture_store;
+        TextureCache    m_texture_cache;
+        Intersector     m_intersector;
+
+        FixtureWithProxies()
+          : m_trace_context(m_scene.ref())
+          , m_texture_store(m_scene.ref())
+          , m_texture_cache(m_texture_store)
+          , m_intersector(m_trace_context, m_texture_cache)
+        {
+        }
+    };
+
+    ShadingRay make_ray_with_footprint(const double footprint)
+    {
+        ShadingRay ray(
+            Vector3d(0.3, 0.2, 4.0),
+            Vector3d(0.0, 0.0, -1.0),
+            0.0,                                // tmin
+            10.0,                               // tmax
+            ShadingRay::Time(),
+            VisibilityFlags::CameraRay,
+            0);                                 // depth
+
+        // The differential rays are offset by the footprint at distance 1.
+        ray.m_rx = Ray3d(ray.m_org, Vector3d(footprint, 0.0, -1.0));
+        ray.m_ry = Ray3d(ray.m_org, Vector3d(0.0, footprint, -1.0));
+        ray.m_has_differentials = true;
+
+        return ray;
+    }
+
+    // The proxy levels have cells of size 0.5, 1 and 2, and geometric errors of about
+    // 0.87, 1.73 and 3.46. Rays enter the assembly 4 units away from their origin,
+    // where their footprint is 4 times the one given to make_ray_with_footprint().
+
+    TEST_CASE_F(Trace_GivenRayWithSmallFootprint_HitsFullResolutionGeometry, FixtureWithProxies)
+    {
+        const ShadingRay ray = make_ray_with_footprint(0.001);
+
+        ShadingPoint shading_point;
+        const bool hit = m_intersector.trace(ray, shading_point);
+
+        ASSERT_TRUE(hit);
+        EXPECT_EQ(0, shading_point.get_proxy_level());
+        EXPECT_FEQ(4.0, shading_point.get_distance());
+    }
+
+    TEST_CASE_F(Trace_GivenRayWithMediumFootprint_HitsFinestProxy, FixtureWithProxies)
+    {
+        const ShadingRay ray = make_ray_with_footprint(0.25);
+
+        ShadingPoint shading_point;
+        const bool hit = m_intersector.trace(ray, shading_point);
+
+        ASSERT_TRUE(hit);
+        EXPECT_EQ(1, shading_point.get_proxy_level());
+        EXPECT_FEQ(4.0, shading_point.get_distance());
+    }
+
+    TEST_CASE_F(Trace_GivenRayWithLargeFootprint_HitsCoarsestProxy, FixtureWithProxies)
+    {
+        const ShadingRay ray = make_ray_with_footprint(1.0);
+
+        ShadingPoint shading_point;
+        const bool hit = m_intersector.trace(ray, shading_point);
+
+        ASSERT_TRUE(hit);
+        EXPECT_EQ(3, shading_point.get_proxy_level());
+        EXPECT_FEQ(4.0, shading_point.get_distance());
+        EXPECT_EQ(0, shading_point.get_primitive_attribute_index());
+    }
+
+    TEST_CASE_F(Trace_GivenProxyHit_GeometricNormalIsNormalToProxy, FixtureWithProxies)
+    {
+        const ShadingRay ray = make_ray_with_footprint(1.0);
+
+        ShadingPoint shading_point;
+        const bool hit = m_intersector.trace(ray, shading_point);
+
+        ASSERT_TRUE(hit);
+        ASSERT_EQ(3, shading_point.get_proxy_level());
+        EXPECT_FEQ(Vector3d(0.0, 0.0, 1.0), shading_point.get_geometric_normal());
+    }
+
+    TEST_CASE_F(Trace_GivenRaysLeavingProxyHit_DoNotHitProxyAgain, FixtureWithProxies)
+    {
+        const ShadingRay ray = make_ray_with_footprint(1.0);
+
+        ShadingPoint shading_point;
+        const bool hit = m_intersector.trace(ray, shading_point);
+
+        ASSERT_TRUE(hit);
+        ASSERT_EQ(3, shading_point.get_proxy_level());
+
+        const Vector3d directions[2] =
+        {
+            Vector3d(0.0, 0.6, 0.8),            // reflection
+            Vector3d(0.0, 0.6, -0.8)            // transmission
+        };
+
+        for (size_t i = 0; i < 2; ++i)
+        {
+            const ShadingRay child_ray(
+                shading_point.get_offset_point(directions[i]),
+                directions[i],
+                0.0,                            // tmin
+                10.0,                           // tmax
+                ShadingRay::Time(),
+                VisibilityFlags::CameraRay,
+                1);                             // depth
+
+            ShadingPoint child_shading_point;
+            const bool child_hit = m_intersector.trace(child_ray, child_shading_point, &shading_point);
+
+            EXPECT_FALSE(child_hit);
+        }
+    }
+
+    TEST_CASE_F(TraceProbe_GivenRayWithLargeFootprint_HitsProxy, FixtureWithProxies)
+    {
+        const ShadingRay ray = make_ray_with_footprint(1.0);
+
+        const bool hit = m_intersector.trace_probe(ray);
+
+        EXPECT_TRUE(hit);
+    }
+
+    TEST_CASE_F(Trace_GivenAssemblyInstanceMovedAfterTraceContextUpdate_HitsMovedGeometry, FixtureWithProxies)
+    {
+        // Only the transform of the assembly instance changes: the assembly tree is refitted.
+        AssemblyInstance* assembly_instance = m_scene->assembly_instances().get_by_name("assembly_instance");
+        assembly_instance->transform_sequence().clear();
+        assembly_instance->transform_sequence().set_transform(
+            0.0f,
+            Transformd::from_local_to_parent(Matrix4d::make_translation(Vector3d(10.0, 0.0, 0.0))));
+        assembly_instance->bump_version_id();
+
+        m_trace_context.update();
+
+        const ShadingRay ray(
+            Vector3d(10.3, 0.2, 4.0),
+            Vector3d(0.0, 0.0, -1.0),
+            0.0,                                // tmin
+            10.0,                               // tmax
+            ShadingRay::Time(),
+            VisibilityFlags::CameraRay,
+            0);                                 // depth
+
+        ShadingPoint shading_point;
+        const bool hit = m_intersector.trace(ray, shading_point);
+
+        ASSERT_TRUE(hit);
+        EXPECT_FEQ(4.0, shading_point.get_distance());
+        EXPECT_FALSE(m_intersector.trace_probe(make_ray_with_footprint(0.001)));
+    }
 }
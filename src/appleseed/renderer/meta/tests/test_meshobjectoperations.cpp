@@ -0,0 +1,123 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectoperations.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_Object_MeshObjectOperations)
+{
+    //
+    // Two triangles at a right angle, sharing the edge between vertices 0 and 2:
+    //
+    //   triangle 0: (0, 0, 0), (1, 0, 0), (0, 1, 0)     area 0.5, normal +Z
+    //   triangle 1: (0, 0, 0), (0, 1, 0), (0, 0, -2)    area 1.0, normal -X
+    //
+
+    auto_release_ptr<MeshObject> create_mesh()
+    {
+        auto_release_ptr<MeshObject> mesh(MeshObjectFactory::create("mesh", ParamArray()));
+
+        mesh->push_vertex(GVector3(0.0f, 0.0f, 0.0f));
+        mesh->push_vertex(GVector3(1.0f, 0.0f, 0.0f));
+        mesh->push_vertex(GVector3(0.0f, 1.0f, 0.0f));
+        mesh->push_vertex(GVector3(0.0f, 0.0f, -2.0f));
+
+        mesh->push_triangle(Triangle(0, 1, 2, 0));
+        mesh->push_triangle(Triangle(0, 2, 3, 0));
+
+        return mesh;
+    }
+
+    TEST_CASE(ComputeSmoothVertexNormals_UniformWeighting)
+    {
+        auto_release_ptr<MeshObject> mesh = create_mesh();
+
+        compute_smooth_vertex_normals(mesh.ref(), VertexWeightingUniform, 1);
+
+        ASSERT_EQ(4, mesh->get_vertex_normal_count());
+        EXPECT_FEQ(normalize(GVector3(-1.0f, 0.0f, 1.0f)), mesh->get_vertex_normal(0));
+        EXPECT_FEQ(GVector3(0.0f, 0.0f, 1.0f), mesh->get_vertex_normal(1));
+        EXPECT_FEQ(normalize(GVector3(-1.0f, 0.0f, 1.0f)), mesh->get_vertex_normal(2));
+        EXPECT_FEQ(GVector3(-1.0f, 0.0f, 0.0f), mesh->get_vertex_normal(3));
+
+        EXPECT_EQ(2, mesh->get_triangle(1).m_n1);
+    }
+
+    TEST_CASE(ComputeSmoothVertexNormals_AreaWeighting)
+    {
+        auto_release_ptr<MeshObject> mesh = create_mesh();
+
+        compute_smooth_vertex_normals(mesh.ref(), VertexWeightingArea, 1);
+
+        EXPECT_FEQ(normalize(GVector3(-1.0f, 0.0f, 0.5f)), mesh->get_vertex_normal(0));
+    }
+
+    TEST_CASE(ComputeSmoothVertexNormals_AngleWeighting)
+    {
+        auto_release_ptr<MeshObject> mesh = create_mesh();
+
+        compute_smooth_vertex_normals(mesh.ref(), VertexWeightingAngle, 1);
+
+        // Both triangles have a right angle at vertex 0.
+        EXPECT_FEQ(normalize(GVector3(-1.0f, 0.0f, 1.0f)), mesh->get_vertex_normal(0));
+
+        // At vertex 2, triangle 0 has an angle of 45 degrees, triangle 1 an angle of atan(2).
+        const GScalar angle0 = GScalar(std::atan(1.0));
+        const GScalar angle1 = GScalar(std::atan(2.0));
+        EXPECT_FEQ(normalize(GVector3(-angle1, 0.0f, angle0)), mesh->get_vertex_normal(2));
+    }
+
+    TEST_CASE(ComputeSmoothVertexNormals_SeveralThreads_MatchesSingleThread)
+    {
+        auto_release_ptr<MeshObject> mesh1 = create_mesh();
+        auto_release_ptr<MeshObject> mesh2 = create_mesh();
+
+        compute_smooth_vertex_normals(mesh1.ref(), VertexWeightingAngle, 1);
+        compute_smooth_vertex_normals(mesh2.ref(), VertexWeightingAngle, 3);
+
+        for (size_t i = 0; i < 4; ++i)
+            EXPECT_EQ(mesh1->get_vertex_normal(i), mesh2->get_vertex_normal(i));
+    }
+}
@@ -99,6 +99,59 @@ TEST_SUITE(Renderer_Modeling_Project_ProjectFileReader)
         }
     }
 
+    TEST_CASE(BinaryProjectRoundtrip)
+    {
+        const char* BinaryProject = "unit tests/outputs/test_projectfilereader_binaryproject.appleseedb";
+        const char* UnpackDirectory = "unit tests/outputs/test_projectfilereader_binaryproject.unpacked/";
+
+        try
+        {
+            ProjectFileReader reader;
+
+            auto_release_ptr<Project> project =
+                reader.read(
+                    "unit tests/inputs/test_projectfilereader_configurationblocks.appleseed",
+                    "../../../schemas/project.xsd");    // path relative to input file
+
+            ASSERT_NEQ(0, project.get());
+
+            ASSERT_TRUE(
+                ProjectFileWriter::write(
+                    project.ref(),
+                    BinaryProject,
+                    ProjectFileWriter::OmitHeaderComment));
+
+            project =
+                reader.read(
+                    BinaryProject,
+                    "../../../../schemas/project.xsd");     // path relative to unpacked file
+
+            ASSERT_NEQ(0, project.get());
+
+            ASSERT_TRUE(
+                ProjectFileWriter::write(
+                    project.ref(),
+                    "unit tests/outputs/test_projectfilereader_binaryproject.appleseed",
+                    ProjectFileWriter::OmitHeaderComment));
+
+            const bool identical =
+                compare_text_files(
+                    "unit tests/inputs/test_projectfilereader_configurationblocks.appleseed",
+                    "unit tests/outputs/test_projectfilereader_binaryproject.appleseed");
+
+            EXPECT_TRUE(identical);
+
+            bf::remove(bf::path(BinaryProject));
+            bf::remove_all(bf::path(UnpackDirectory));
+        }
+        catch (const std::exception& e)
+        {
+            bf::remove(bf::path(BinaryProject));
+            bf::remove_all(bf::path(UnpackDirectory));
+            throw e;
+        }
+    }
+
 #if 0
     // Test waits for a brilliant solution of how to invoke it without emitting error message
 
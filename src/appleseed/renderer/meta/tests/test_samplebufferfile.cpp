@@ -0,0 +1,154 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/permanentshadingresultframebufferfactory.h"
+#include "renderer/kernel/rendering/samplebufferfile.h"
+#include "renderer/kernel/rendering/shadingresultframebuffer.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/image/image.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_SampleBufferFile)
+{
+    auto_release_ptr<Frame> create_frame()
+    {
+        return
+            FrameFactory::create(
+                "frame",
+                ParamArray()
+                    .insert("resolution", "4 4")
+                    .insert("tile_size", "2 2"));
+    }
+
+    // Render a given tile with a single color of a given weight, and write it to disk.
+    bool write_tile(
+        const char*     filename,
+        const size_t    tile_x,
+        const size_t    tile_y,
+        const float     weight,
+        const Color4f&  color,
+        const size_t    first_pass,
+        const size_t    last_pass)
+    {
+        auto_release_ptr<Frame> frame(create_frame());
+        PermanentShadingResultFrameBufferFactory factory(frame.ref());
+
+        ShadingResultFrameBuffer* framebuffer =
+            factory.create(
+                frame.ref(),
+                tile_x,
+                tile_y,
+                AABB2u(Vector2u(0, 0), Vector2u(1, 1)));
+
+        for (size_t i = 0; i < framebuffer->get_pixel_count(); ++i)
+        {
+            float* ptr = framebuffer->pixel(i);
+            ptr[0] = weight;
+            ptr[1] = color.r * weight;
+            ptr[2] = color.g * weight;
+            ptr[3] = color.b * weight;
+            ptr[4] = color.a * weight;
+        }
+
+        return SampleBufferFile::write(filename, frame.ref(), factory, first_pass, last_pass);
+    }
+
+    Color4f get_pixel(const Frame& frame, const size_t x, const size_t y)
+    {
+        Color4f color;
+        frame.image().get_pixel(x, y, color);
+        return color;
+    }
+
+    TEST_CASE(Merge_GivenDisjointTiles_DevelopsEachTile)
+    {
+        ASSERT_TRUE(write_tile("unit tests/outputs/test_samplebufferfile_slice1.assb", 0, 0, 2.0f, Color4f(0.5f, 0.25f, 0.125f, 1.0f), 0, 0));
+        ASSERT_TRUE(write_tile("unit tests/outputs/test_samplebufferfile_slice2.assb", 1, 1, 4.0f, Color4f(0.25f, 0.5f, 0.75f, 1.0f), 0, 0));
+
+        vector<string> filenames;
+        filenames.push_back("unit tests/outputs/test_samplebufferfile_slice1.assb");
+        filenames.push_back("unit tests/outputs/test_samplebufferfile_slice2.assb");
+
+        auto_release_ptr<Frame> frame(create_frame());
+        const bool success = SampleBufferFile::merge(filenames, frame.ref());
+
+        ASSERT_TRUE(success);
+        EXPECT_EQ(Color4f(0.5f, 0.25f, 0.125f, 1.0f), get_pixel(frame.ref(), 1, 1));
+        EXPECT_EQ(Color4f(0.25f, 0.5f, 0.75f, 1.0f), get_pixel(frame.ref(), 2, 3));
+    }
+
+    TEST_CASE(Merge_GivenDisjointPassRanges_SumsSamples)
+    {
+        ASSERT_TRUE(write_tile("unit tests/outputs/test_samplebufferfile_slice1.assb", 0, 0, 1.0f, Color4f(1.0f, 0.0f, 0.0f, 1.0f), 1, 1));
+        ASSERT_TRUE(write_tile("unit tests/outputs/test_samplebufferfile_slice2.assb", 0, 0, 1.0f, Color4f(0.0f, 1.0f, 0.0f, 1.0f), 0, 0));
+
+        vector<string> filenames;
+        filenames.push_back("unit tests/outputs/test_samplebufferfile_slice1.assb");
+        filenames.push_back("unit tests/outputs/test_samplebufferfile_slice2.assb");
+
+        auto_release_ptr<Frame> frame(create_frame());
+        const bool success = SampleBufferFile::merge(filenames, frame.ref());
+
+        ASSERT_TRUE(success);
+        EXPECT_EQ(Color4f(0.5f, 0.5f, 0.0f, 1.0f), get_pixel(frame.ref(), 0, 0));
+    }
+
+    TEST_CASE(Merge_GivenOverlappingPassRanges_ReturnsFalse)
+    {
+        ASSERT_TRUE(write_tile("unit tests/outputs/test_samplebufferfile_slice1.assb", 0, 0, 1.0f, Color4f(1.0f), 0, 1));
+        ASSERT_TRUE(write_tile("unit tests/outputs/test_samplebufferfile_slice2.assb", 0, 0, 1.0f, Color4f(1.0f), 1, 2));
+
+        vector<string> filenames;
+        filenames.push_back("unit tests/outputs/test_samplebufferfile_slice1.assb");
+        filenames.push_back("unit tests/outputs/test_samplebufferfile_slice2.assb");
+
+        auto_release_ptr<Frame> frame(create_frame());
+        const bool success = SampleBufferFile::merge(filenames, frame.ref());
+
+        EXPECT_FALSE(success);
+    }
+}
@@ -0,0 +1,165 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/sample.h"
+#include "renderer/kernel/rendering/sampleaccumulationbuffer.h"
+#include "renderer/kernel/rendering/samplegeneratorbase.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+#include "foundation/utility/job/abortswitch.h"
+#include "foundation/utility/statistics.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_SampleGeneratorBase)
+{
+    // Only even sequence indices produce a sample. Keys sort samples by decreasing sequence index.
+    class RecordingSampleGenerator
+      : public SampleGeneratorBase
+    {
+      public:
+        using SampleGeneratorBase::generate_samples;
+
+        vector<size_t> m_rendered_indices;
+
+        explicit RecordingSampleGenerator(const bool coherent_ordering)
+          : SampleGeneratorBase(0, 1)
+        {
+            set_coherent_ordering(coherent_ordering);
+        }
+
+        virtual void release() override
+        {
+            delete this;
+        }
+
+        virtual StatisticsVector get_statistics() const override
+        {
+            return StatisticsVector();
+        }
+
+      private:
+        virtual bool compute_sorting_key(
+            const size_t    sequence_index,
+            uint32&         key) override
+        {
+            key = static_cast<uint32>(1000000 - sequence_index);
+            return sequence_index % 2 == 0;
+        }
+
+        virtual size_t generate_samples(
+            const size_t    sequence_index,
+            SampleVector&   samples) override
+        {
+            if (sequence_index % 2 != 0)
+                return 0;
+
+            m_rendered_indices.push_back(sequence_index);
+            samples.push_back(Sample());
+
+            return 1;
+        }
+    };
+
+    class CountingSampleAccumulationBuffer
+      : public SampleAccumulationBuffer
+    {
+      public:
+        size_t m_stored_sample_count;
+
+        CountingSampleAccumulationBuffer()
+          : m_stored_sample_count(0)
+        {
+        }
+
+        virtual void clear() override
+        {
+            m_stored_sample_count = 0;
+        }
+
+        virtual void store_samples(
+            const size_t    sample_count,
+            const Sample    samples[],
+            IAbortSwitch&   abort_switch) override
+        {
+            m_stored_sample_count += sample_count;
+        }
+
+        virtual void develop_to_frame(
+            Frame&          frame,
+            IAbortSwitch&   abort_switch) override
+        {
+        }
+    };
+
+    TEST_CASE(GenerateSamples_GivenCoherentOrdering_RendersSameSamplesAsSequenceOrdering)
+    {
+        AbortSwitch abort_switch;
+
+        RecordingSampleGenerator sequence_generator(false);
+        CountingSampleAccumulationBuffer sequence_buffer;
+        sequence_generator.generate_samples(100, sequence_buffer, abort_switch);
+
+        RecordingSampleGenerator coherent_generator(true);
+        CountingSampleAccumulationBuffer coherent_buffer;
+        coherent_generator.generate_samples(100, coherent_buffer, abort_switch);
+
+        vector<size_t> coherent_indices = coherent_generator.m_rendered_indices;
+        sort(coherent_indices.begin(), coherent_indices.end());
+
+        EXPECT_EQ(100, sequence_buffer.m_stored_sample_count);
+        EXPECT_EQ(100, coherent_buffer.m_stored_sample_count);
+        EXPECT_TRUE(sequence_generator.m_rendered_indices == coherent_indices);
+    }
+
+    TEST_CASE(GenerateSamples_GivenCoherentOrdering_RendersSamplesByIncreasingKey)
+    {
+        AbortSwitch abort_switch;
+        RecordingSampleGenerator generator(true);
+        CountingSampleAccumulationBuffer buffer;
+
+        generator.generate_samples(100, buffer, abort_switch);
+
+        const vector<size_t>& indices = generator.m_rendered_indices;
+
+        ASSERT_EQ(100, indices.size());
+
+        for (size_t i = 1; i < indices.size(); ++i)
+            EXPECT_LT(indices[i - 1], indices[i]);
+    }
+}
@@ -0,0 +1,172 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/modeling/camera/camera.h"
+#include "renderer/modeling/camera/pinholecamera.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/sceneupdater.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/test.h"
+#include "foundation/utility/version.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_Scene_SceneUpdater)
+{
+    auto_release_ptr<Scene> create_scene(
+        const Vector3d&     camera_position,
+        const Vector3d&     object_instance_position = Vector3d(0.0))
+    {
+        auto_release_ptr<Scene> scene(SceneFactory::create());
+
+        auto_release_ptr<Camera> camera(
+            PinholeCameraFactory().create(
+                "camera",
+                ParamArray()
+                    .insert("film_width", "0.025")
+                    .insert("film_height", "0.025")
+                    .insert("focal_length", "0.035")));
+        camera->transform_sequence().set_transform(
+            0.0f,
+            Transformd::from_local_to_parent(Matrix4d::make_translation(camera_position)));
+        scene->cameras().insert(camera);
+
+        auto_release_ptr<Assembly> assembly(
+            AssemblyFactory().create("assembly", ParamArray()));
+        assembly->object_instances().insert(
+            ObjectInstanceFactory::create(
+                "object_instance",
+                ParamArray(),
+                "object",
+                Transformd::from_local_to_parent(Matrix4d::make_translation(object_instance_position)),
+                StringDictionary()));
+        scene->assemblies().insert(assembly);
+
+        scene->assembly_instances().insert(
+            AssemblyInstanceFactory::create(
+                "assembly_instance",
+                ParamArray(),
+                "assembly"));
+
+        return scene;
+    }
+
+    TEST_CASE(Update_GivenIdenticalScenes_ModifiesNothing)
+    {
+        auto_release_ptr<Scene> scene = create_scene(Vector3d(0.0));
+        auto_release_ptr<Scene> source_scene = create_scene(Vector3d(0.0));
+        const VersionID camera_version = scene->cameras().get_by_name("camera")->get_version_id();
+
+        size_t updated_count;
+        const bool success = SceneUpdater::update(scene.ref(), source_scene.ref(), updated_count);
+
+        ASSERT_TRUE(success);
+        EXPECT_EQ(0, updated_count);
+        EXPECT_EQ(camera_version, scene->cameras().get_by_name("camera")->get_version_id());
+    }
+
+    TEST_CASE(Update_GivenMovedCamera_CopiesCameraTransformAndBumpsCameraVersion)
+    {
+        auto_release_ptr<Scene> scene = create_scene(Vector3d(0.0));
+        auto_release_ptr<Scene> source_scene = create_scene(Vector3d(1.0, 2.0, 3.0));
+        const Camera* camera = scene->cameras().get_by_name("camera");
+        const VersionID camera_version = camera->get_version_id();
+
+        size_t updated_count;
+        const bool success = SceneUpdater::update(scene.ref(), source_scene.ref(), updated_count);
+
+        ASSERT_TRUE(success);
+        EXPECT_EQ(1, updated_count);
+        EXPECT_NEQ(camera_version, camera->get_version_id());
+        EXPECT_EQ(
+            source_scene->cameras().get_by_name("camera")->transform_sequence().compute_signature(),
+            camera->transform_sequence().compute_signature());
+    }
+
+    TEST_CASE(Update_GivenMovedAssemblyInstance_CopiesAssemblyInstanceTransform)
+    {
+        auto_release_ptr<Scene> scene = create_scene(Vector3d(0.0));
+        auto_release_ptr<Scene> source_scene = create_scene(Vector3d(0.0));
+        source_scene->assembly_instances().get_by_name("assembly_instance")->transform_sequence().set_transform(
+            0.0f,
+            Transformd::from_local_to_parent(Matrix4d::make_scaling(Vector3d(2.0))));
+
+        size_t updated_count;
+        const bool success = SceneUpdater::update(scene.ref(), source_scene.ref(), updated_count);
+
+        ASSERT_TRUE(success);
+        EXPECT_EQ(1, updated_count);
+        EXPECT_EQ(1, scene->assembly_instances().get_by_name("assembly_instance")->transform_sequence().size());
+    }
+
+    TEST_CASE(Update_GivenMovedObjectInstance_FailsAndModifiesNothing)
+    {
+        auto_release_ptr<Scene> scene = create_scene(Vector3d(0.0));
+        auto_release_ptr<Scene> source_scene = create_scene(Vector3d(1.0, 2.0, 3.0), Vector3d(1.0, 0.0, 0.0));
+        const VersionID camera_version = scene->cameras().get_by_name("camera")->get_version_id();
+
+        size_t updated_count;
+        const bool success = SceneUpdater::update(scene.ref(), source_scene.ref(), updated_count);
+
+        EXPECT_FALSE(success);
+        EXPECT_EQ(0, updated_count);
+        EXPECT_EQ(camera_version, scene->cameras().get_by_name("camera")->get_version_id());
+    }
+
+    TEST_CASE(Update_GivenMeshObjectOfUnreadMeshFile_MatchesMeshObjectParts)
+    {
+        const ParamArray params = ParamArray().insert("filename", "object.obj");
+        auto_release_ptr<Scene> scene = create_scene(Vector3d(0.0));
+        auto_release_ptr<Scene> source_scene = create_scene(Vector3d(0.0));
+        scene->assemblies().get_by_name("assembly")->objects().insert(
+            auto_release_ptr<Object>(MeshObjectFactory::create("object.part", params)));
+        source_scene->assemblies().get_by_name("assembly")->objects().insert(
+            auto_release_ptr<Object>(MeshObjectFactory::create("object", params)));
+
+        size_t updated_count;
+        const bool success = SceneUpdater::update(scene.ref(), source_scene.ref(), updated_count);
+
+        EXPECT_TRUE(success);
+    }
+}
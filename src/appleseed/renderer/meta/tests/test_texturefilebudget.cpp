@@ -0,0 +1,118 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/texturing/texturefilebudget.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Texturing_TextureFileBudget)
+{
+    // A client whose open files are all idle.
+    class IdleFilesClient
+      : public TextureFileBudget::IClient
+    {
+      public:
+        size_t  m_open_file_count;
+
+        IdleFilesClient()
+          : m_open_file_count(0)
+        {
+        }
+
+        void open_file(TextureFileBudget& budget)
+        {
+            budget.acquire(this);
+            ++m_open_file_count;
+        }
+
+        void close_files(TextureFileBudget& budget)
+        {
+            for (; m_open_file_count > 0; --m_open_file_count)
+                budget.release();
+
+            budget.remove_client(this);
+        }
+
+        virtual bool close_idle_file() override
+        {
+            if (m_open_file_count == 0)
+                return false;
+
+            --m_open_file_count;
+            return true;
+        }
+    };
+
+    struct Fixture
+    {
+        TextureFileBudget&  m_budget;
+        const size_t        m_initial_max_open_files;
+
+        Fixture()
+          : m_budget(TextureFileBudget::instance())
+          , m_initial_max_open_files(m_budget.get_max_open_files())
+        {
+            m_budget.set_max_open_files(m_budget.get_open_file_count() + 3);
+        }
+
+        ~Fixture()
+        {
+            m_budget.set_max_open_files(m_initial_max_open_files);
+        }
+    };
+
+    TEST_CASE_F(Acquire_GivenExhaustedBudget_ClosesIdleFileOfLeastRecentlyServedClient, Fixture)
+    {
+        const size_t initial_open_file_count = m_budget.get_open_file_count();
+        IdleFilesClient client1, client2, client3;
+
+        client1.open_file(m_budget);
+        client2.open_file(m_budget);
+        client1.open_file(m_budget);
+        client3.open_file(m_budget);
+
+        EXPECT_EQ(initial_open_file_count + 3, m_budget.get_open_file_count());
+        EXPECT_EQ(2, client1.m_open_file_count);
+        EXPECT_EQ(0, client2.m_open_file_count);
+        EXPECT_EQ(1, client3.m_open_file_count);
+
+        client1.close_files(m_budget);
+        client2.close_files(m_budget);
+        client3.close_files(m_budget);
+
+        EXPECT_EQ(initial_open_file_count, m_budget.get_open_file_count());
+    }
+}
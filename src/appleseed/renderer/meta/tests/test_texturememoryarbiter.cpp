@@ -0,0 +1,209 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/texturing/texturememoryarbiter.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/shadergroup/shadergroup.h"
+#include "renderer/modeling/texture/texture.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/colorspace.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+#include "foundation/utility/uid.h"
+
+// OpenImageIO headers.
+#include "foundation/platform/_beginoiioheaders.h"
+#include "OpenImageIO/texture.h"
+#include "foundation/platform/_endoiioheaders.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Texturing_TextureMemoryArbiter)
+{
+    const size_t TileSize = 32;
+    const size_t TileCount = 32;
+
+    // A texture made of a single row of tiles, allocated on demand.
+    class TiledTexture
+      : public Texture
+    {
+      public:
+        explicit TiledTexture(const char* name)
+          : Texture(name, ParamArray())
+          , m_props(
+                TileSize * TileCount, TileSize,
+                TileSize, TileSize,
+                4,
+                PixelFormatFloat)
+        {
+        }
+
+        virtual void release() override
+        {
+            delete this;
+        }
+
+        virtual const char* get_model() const override
+        {
+            return "tiled_texture";
+        }
+
+        virtual ColorSpace get_color_space() const override
+        {
+            return ColorSpaceLinearRGB;
+        }
+
+        virtual const CanvasProperties& properties() override
+        {
+            return m_props;
+        }
+
+        virtual Tile* load_tile(
+            const size_t    tile_x,
+            const size_t    tile_y) override
+        {
+            return new Tile(TileSize, TileSize, 4, PixelFormatFloat);
+        }
+
+        virtual void unload_tile(
+            const size_t    tile_x,
+            const size_t    tile_y,
+            const Tile*     tile) override
+        {
+            delete tile;
+        }
+
+      private:
+        const CanvasProperties  m_props;
+    };
+
+    struct Fixture
+    {
+        auto_release_ptr<Scene>             m_scene;
+        UniqueID                            m_texture_uid;
+        size_t                              m_budget;
+        size_t                              m_share;
+        auto_ptr<TextureStore>              m_texture_store;
+        shared_ptr<OIIO::TextureSystem>     m_texture_system;
+
+        Fixture()
+          : m_scene(SceneFactory::create())
+          , m_texture_system(
+                OIIO::TextureSystem::create(),
+                [](OIIO::TextureSystem* object) { OIIO::TextureSystem::destroy(object); })
+        {
+            // The scene uses both kinds of textures: the budget is split evenly.
+            auto_release_ptr<Texture> texture(new TiledTexture("texture"));
+            m_texture_uid = texture->get_uid();
+            m_scene->textures().insert(texture);
+            m_scene->shader_groups().insert(ShaderGroupFactory::create("shader_group"));
+
+            // Each half of the budget holds a quarter of the texture's tiles.
+            m_budget = TileCount / 2 * Tile(TileSize, TileSize, 4, PixelFormatFloat).get_memory_size();
+
+            // Both the rebalancing step and the minimum share of each cache are 10% of the budget.
+            m_share = static_cast<size_t>(m_budget * 0.1);
+
+            const ParamArray params = ParamArray().insert("max_size", m_budget);
+            m_texture_store.reset(new TextureStore(m_scene.ref(), params));
+        }
+
+        void access_all_tiles(const size_t pass_count)
+        {
+            for (size_t pass = 0; pass < pass_count; ++pass)
+            {
+                for (size_t tile_x = 0; tile_x < TileCount; ++tile_x)
+                {
+                    const TextureStore::TileKey key(UniqueID(~0), m_texture_uid, tile_x, 0);
+                    m_texture_store->release(m_texture_store->acquire(key));
+                }
+            }
+        }
+    };
+
+    TEST_CASE_F(Constructor_GivenSceneWithTexturesAndShaderGroups_SplitsBudgetEvenly, Fixture)
+    {
+        const ParamArray params = ParamArray().insert("max_size", m_budget);
+        TextureMemoryArbiter arbiter(m_scene.ref(), *m_texture_store, *m_texture_system, params);
+
+        EXPECT_EQ(m_budget - m_budget / 2, m_texture_store->get_memory_limit());
+    }
+
+    TEST_CASE_F(Rebalance_GivenFullTextureStoreMissingMoreThanTextureSystem_GrowsTextureStore, Fixture)
+    {
+        const ParamArray params = ParamArray().insert("max_size", m_budget);
+        TextureMemoryArbiter arbiter(m_scene.ref(), *m_texture_store, *m_texture_system, params);
+        const size_t initial_limit = m_texture_store->get_memory_limit();
+
+        // Cycling through more tiles than the store can hold makes every access miss.
+        access_all_tiles(1000 / TileCount + 1);
+        arbiter.rebalance();
+
+        EXPECT_EQ(initial_limit + m_share, m_texture_store->get_memory_limit());
+    }
+
+    TEST_CASE_F(Rebalance_GivenTooFewLookups_KeepsLimits, Fixture)
+    {
+        const ParamArray params = ParamArray().insert("max_size", m_budget);
+        TextureMemoryArbiter arbiter(m_scene.ref(), *m_texture_store, *m_texture_system, params);
+        const size_t initial_limit = m_texture_store->get_memory_limit();
+
+        access_all_tiles(1);
+        arbiter.rebalance();
+
+        EXPECT_EQ(initial_limit, m_texture_store->get_memory_limit());
+    }
+
+    TEST_CASE_F(Rebalance_NeverShrinksTextureSystemBelowMinimumShare, Fixture)
+    {
+        const ParamArray params = ParamArray().insert("max_size", m_budget);
+        TextureMemoryArbiter arbiter(m_scene.ref(), *m_texture_store, *m_texture_system, params);
+
+        for (size_t i = 0; i < 10; ++i)
+        {
+            access_all_tiles(1000 / TileCount + 1);
+            arbiter.rebalance();
+        }
+
+        EXPECT_EQ(m_budget - m_share, m_texture_store->get_memory_limit());
+    }
+}
@@ -29,10 +29,29 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/texture/texture.h"
+#include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/colorspace.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/platform/thread.h"
+#include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/test.h"
+#include "foundation/utility/uid.h"
 
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+#include "boost/thread/thread.hpp"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
 using namespace renderer;
 
 TEST_SUITE(Renderer_Kernel_Texturing_TextureStore_TileKey)
@@ -47,3 +66,128 @@ TEST_SUITE(Renderer_Kernel_Texturing_TextureStore_TileKey)
         EXPECT_EQ(56565, key.get_tile_y());
     }
 }
+
+TEST_SUITE(Renderer_Kernel_Texturing_TextureStore)
+{
+    TEST_CASE(Constructor_GivenMaxSizeParameter_SetsMemoryLimit)
+    {
+        auto_release_ptr<Scene> scene(SceneFactory::create());
+        TextureStore texture_store(*scene, ParamArray().insert("max_size", 1024));
+
+        EXPECT_EQ(1024, texture_store.get_memory_limit());
+        EXPECT_EQ(0, texture_store.get_memory_size());
+    }
+
+    TEST_CASE(SetMemoryLimit_UpdatesMemoryLimit)
+    {
+        auto_release_ptr<Scene> scene(SceneFactory::create());
+        TextureStore texture_store(*scene);
+
+        texture_store.set_memory_limit(2048);
+
+        EXPECT_EQ(2048, texture_store.get_memory_limit());
+    }
+
+    TEST_CASE(GetTextureStatistics_GivenNoTileAccessed_ReturnsNoStatistics)
+    {
+        auto_release_ptr<Scene> scene(SceneFactory::create());
+        TextureStore texture_store(*scene);
+
+        TextureStore::TextureStatsVector stats;
+        texture_store.get_texture_statistics(stats);
+
+        EXPECT_TRUE(stats.empty());
+        EXPECT_EQ(0, texture_store.get_hit_count());
+        EXPECT_EQ(0, texture_store.get_miss_count());
+    }
+
+    // A single-tile texture that takes a while to load its tile.
+    class SlowTexture
+      : public Texture
+    {
+      public:
+        boost::atomic<size_t> m_load_count;
+
+        SlowTexture()
+          : Texture("slow_texture", ParamArray())
+          , m_load_count(0)
+          , m_props(8, 8, 8, 8, 4, PixelFormatFloat)
+        {
+        }
+
+        virtual void release() override
+        {
+            delete this;
+        }
+
+        virtual const char* get_model() const override
+        {
+            return "slow_texture";
+        }
+
+        virtual ColorSpace get_color_space() const override
+        {
+            return ColorSpaceLinearRGB;
+        }
+
+        virtual const CanvasProperties& properties() override
+        {
+            return m_props;
+        }
+
+        virtual Tile* load_tile(
+            const size_t    tile_x,
+            const size_t    tile_y) override
+        {
+            ++m_load_count;
+            foundation::sleep(50);
+            return new Tile(8, 8, 4, PixelFormatFloat);
+        }
+
+        virtual void unload_tile(
+            const size_t    tile_x,
+            const size_t    tile_y,
+            const Tile*     tile) override
+        {
+            delete tile;
+        }
+
+      private:
+        const CanvasProperties  m_props;
+    };
+
+    TEST_CASE(Acquire_GivenConcurrentMissesOnSameTile_LoadsTileOnce)
+    {
+        auto_release_ptr<Scene> scene(SceneFactory::create());
+        SlowTexture* texture = new SlowTexture();
+        const TextureStore::TileKey key(UniqueID(~0), texture->get_uid(), 0, 0);
+        scene->textures().insert(auto_release_ptr<Texture>(texture));
+
+        TextureStore texture_store(*scene);
+
+        const size_t ThreadCount = 4;
+        const Tile* tiles[ThreadCount];
+        boost::thread_group threads;
+
+        for (size_t i = 0; i < ThreadCount; ++i)
+        {
+            threads.create_thread(
+                [&texture_store, &key, &tiles, i]()
+                {
+                    TextureStore::TileRecord& record = texture_store.acquire(key);
+                    tiles[i] = record.m_tile;
+                    texture_store.release(record);
+                });
+        }
+
+        threads.join_all();
+
+        EXPECT_EQ(1, texture->m_load_count.load());
+
+        for (size_t i = 0; i < ThreadCount; ++i)
+        {
+            EXPECT_NEQ(0, tiles[i]);
+            EXPECT_EQ(tiles[0], tiles[i]);
+        }
+    }
+}
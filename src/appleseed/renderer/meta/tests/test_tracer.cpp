@@ -46,18 +46,24 @@
 #include "renderer/modeling/object/meshobject.h"
 #include "renderer/modeling/object/triangle.h"
 #include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/containers.h"
 #include "renderer/modeling/scene/assembly.h"
 #include "renderer/modeling/scene/assemblyinstance.h"
 #include "renderer/modeling/scene/objectinstance.h"
 #include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/textureinstance.h"
 #include "renderer/modeling/scene/visibilityflags.h"
 #include "renderer/modeling/surfaceshader/constantsurfaceshader.h"
 #include "renderer/modeling/surfaceshader/surfaceshader.h"
+#include "renderer/modeling/texture/memorytexture2d.h"
+#include "renderer/modeling/texture/texture.h"
 #include "renderer/utility/paramarray.h"
 #include "renderer/utility/testutils.h"
 
 // appleseed.foundation headers.
 #include "foundation/image/color.h"
+#include "foundation/image/image.h"
+#include "foundation/image/pixel.h"
 #include "foundation/math/matrix.h"
 #include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
@@ -165,6 +171,37 @@ TEST_SUITE(Renderer_Kernel_Lighting_Tracer)
                 GenericMaterialFactory().create(material_name, params));
         }
 
+        void create_material_with_alpha_map(const char* material_name, const char* surface_shader_name, const char* alpha_map)
+        {
+            ParamArray params;
+            params.insert("surface_shader", surface_shader_name);
+            params.insert("alpha_map", alpha_map);
+
+            m_assembly->materials().insert(
+                GenericMaterialFactory().create(material_name, params));
+        }
+
+        // Create a 2x2 in-memory texture of a given color, and an instance of it.
+        void create_texture_instance(const char* texture_instance_name, const Color4f& color)
+        {
+            auto_release_ptr<Image> image(new Image(2, 2, 2, 2, 4, PixelFormatFloat));
+            image->clear(color);
+
+            const string texture_name = string(texture_instance_name) + "_texture";
+
+            m_assembly->textures().insert(
+                MemoryTexture2dFactory::static_create(
+                    texture_name.c_str(),
+                    ParamArray().insert("color_space", "linear_rgb"),
+                    image));
+
+            m_assembly->texture_instances().insert(
+                TextureInstanceFactory::create(
+                    texture_instance_name,
+                    ParamArray(),
+                    texture_name.c_str()));
+        }
+
         void create_plane_object()
         {
             auto_release_ptr<MeshObject> mesh_object =
@@ -190,10 +227,14 @@ TEST_SUITE(Renderer_Kernel_Lighting_Tracer)
             const char*             name,
             const Vector3d&         position,
             const char*             material_name,
-            const ParamArray&       params = ParamArray())
+            const ParamArray&       params = ParamArray(),
+            const char*             back_material_name = 0)
         {
-            StringDictionary material_mappings;
-            material_mappings.insert("material", material_name);
+            StringDictionary front_material_mappings;
+            front_material_mappings.insert("material", material_name);
+
+            StringDictionary back_material_mappings;
+            back_material_mappings.insert("material", back_material_name ? back_material_name : material_name);
 
             m_assembly->object_instances().insert(
                 ObjectInstanceFactory::create(
@@ -202,8 +243,8 @@ TEST_SUITE(Renderer_Kernel_Lighting_Tracer)
                     "plane",
                     Transformd::from_local_to_parent(
                         Matrix4d::make_translation(position)),
-                    material_mappings,
-                    material_mappings));
+                    front_material_mappings,
+                    back_material_mappings));
         }
     };
 
@@ -747,4 +788,80 @@ TEST_SUITE(Renderer_Kernel_Lighting_Tracer)
 
         EXPECT_EQ(1.0f, transmission);
     }
+
+    struct SceneWithTransparentOccluderWithConstantColorAlphaMap
+      : public SceneBase
+    {
+        SceneWithTransparentOccluderWithConstantColorAlphaMap()
+        {
+            // The alpha of this color differs from its first channel.
+            create_color("red_quarter_alpha", Color4f(1.0f, 0.0f, 0.0f, 0.25f));
+            create_material_with_alpha_map("quarter_alpha_material", "constant_white_surface_shader", "red_quarter_alpha");
+            create_plane_object_instance("plane_inst", Vector3d(2.0, 0.0, 0.0), "quarter_alpha_material");
+        }
+    };
+
+    TEST_CASE_F(Trace_GivenOccluderWithConstantColorAlphaMap_UsesAlphaChannel, Fixture<SceneWithTransparentOccluderWithConstantColorAlphaMap>)
+    {
+        Tracer tracer(
+            *m_scene,
+            m_intersector,
+            m_texture_cache,
+            *m_shading_group_exec);
+
+        const float transmission =
+            tracer.trace(
+                Vector3d(0.0, 0.0, 0.0),
+                Vector3d(1.0, 0.0, 0.0),
+                ShadingRay::Time(),
+                VisibilityFlags::ShadowRay,
+                0);
+
+        EXPECT_FEQ(0.75f, transmission);
+    }
+
+    struct SceneWithTwoSidedTexturedOccluder
+      : public SceneBase
+    {
+        SceneWithTwoSidedTexturedOccluder()
+        {
+            create_texture_instance("quarter_alpha_texture_inst", Color4f(1.0f, 1.0f, 1.0f, 0.25f));
+            create_texture_instance("three_quarters_alpha_texture_inst", Color4f(1.0f, 1.0f, 1.0f, 0.75f));
+            create_material_with_alpha_map("front_material", "constant_white_surface_shader", "quarter_alpha_texture_inst");
+            create_material_with_alpha_map("back_material", "constant_white_surface_shader", "three_quarters_alpha_texture_inst");
+            create_plane_object_instance("plane_inst", Vector3d(2.0, 0.0, 0.0), "front_material", ParamArray(), "back_material");
+        }
+    };
+
+    TEST_CASE_F(Trace_GivenTwoSidedOccluderWithAlphaCache_DistinguishesSides, Fixture<SceneWithTwoSidedTexturedOccluder>)
+    {
+        Tracer tracer(
+            *m_scene,
+            m_intersector,
+            m_texture_cache,
+            *m_shading_group_exec,
+            0.001f,                             // transparency threshold
+            1000,                               // max iterations
+            false,                              // print details
+            16);                                // alpha cache resolution
+
+        // Both rays hit the same primitive at the same UV coordinates, but on opposite sides.
+        const float transmission1 =
+            tracer.trace(
+                Vector3d(0.0, 0.0, 0.0),
+                Vector3d(1.0, 0.0, 0.0),
+                ShadingRay::Time(),
+                VisibilityFlags::ShadowRay,
+                0);
+        const float transmission2 =
+            tracer.trace(
+                Vector3d(4.0, 0.0, 0.0),
+                Vector3d(-1.0, 0.0, 0.0),
+                ShadingRay::Time(),
+                VisibilityFlags::ShadowRay,
+                0);
+
+        EXPECT_FEQ(1.0f, transmission1 + transmission2);
+        EXPECT_NEQ(transmission1, transmission2);
+    }
 }
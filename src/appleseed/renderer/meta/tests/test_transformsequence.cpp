@@ -950,4 +950,37 @@ TEST_SUITE(Renderer_Utility_TransformSequence)
         const Transformd xform = sequence.evaluate(0.5);
         EXPECT_EQ(xform.swaps_handedness(), sequence.swaps_handedness(xform));
     }
+
+    TEST_CASE(ComputeSignature_GivenEqualSequences_ReturnsSameSignature)
+    {
+        TransformSequence sequence1;
+        sequence1.set_transform(0.0f, Transformd::from_local_to_parent(Matrix4d::make_translation(Vector3d(1.0, 2.0, 3.0))));
+        sequence1.set_transform(1.0f, Transformd::identity());
+
+        TransformSequence sequence2(sequence1);
+
+        EXPECT_EQ(sequence1.compute_signature(), sequence2.compute_signature());
+    }
+
+    TEST_CASE(ComputeSignature_GivenSequencesWithDifferentTransforms_ReturnsDifferentSignatures)
+    {
+        TransformSequence sequence1;
+        sequence1.set_transform(0.0f, Transformd::identity());
+
+        TransformSequence sequence2;
+        sequence2.set_transform(0.0f, Transformd::from_local_to_parent(Matrix4d::make_translation(Vector3d(1.0, 0.0, 0.0))));
+
+        EXPECT_NEQ(sequence1.compute_signature(), sequence2.compute_signature());
+    }
+
+    TEST_CASE(ComputeSignature_GivenSequencesWithDifferentTimes_ReturnsDifferentSignatures)
+    {
+        TransformSequence sequence1;
+        sequence1.set_transform(0.0f, Transformd::identity());
+
+        TransformSequence sequence2;
+        sequence2.set_transform(1.0f, Transformd::identity());
+
+        EXPECT_NEQ(sequence1.compute_signature(), sequence2.compute_signature());
+    }
 }
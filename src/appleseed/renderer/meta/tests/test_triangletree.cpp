@@ -0,0 +1,435 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/intersection/regioninfo.h"
+#include "renderer/kernel/intersection/tracecontext.h"
+#include "renderer/kernel/intersection/triangletree.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/input/inputbinder.h"
+#include "renderer/modeling/object/iregion.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/regionkit.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/textureinstance.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/modeling/texture/texture.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/colorspace.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/lazy.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Intersection_TriangleTree)
+{
+    // An 8x8 RGBA texture whose left half is opaque and whose right half is transparent.
+    class HalfTransparentTexture
+      : public Texture
+    {
+      public:
+        explicit HalfTransparentTexture(const char* name)
+          : Texture(name, ParamArray())
+          , m_props(
+                8, 8,
+                8, 8,
+                4,
+                PixelFormatFloat)
+        {
+            m_tile.reset(
+                new Tile(
+                    m_props.m_canvas_width,
+                    m_props.m_canvas_height,
+                    m_props.m_channel_count,
+                    m_props.m_pixel_format));
+
+            for (size_t y = 0; y < m_props.m_canvas_height; ++y)
+            {
+                for (size_t x = 0; x < m_props.m_canvas_width; ++x)
+                {
+                    const float alpha = x < m_props.m_canvas_width / 2 ? 1.0f : 0.0f;
+                    m_tile->set_pixel(x, y, Color4f(1.0f, 1.0f, 1.0f, alpha));
+                }
+            }
+        }
+
+        virtual void release() override
+        {
+            delete this;
+        }
+
+        virtual const char* get_model() const override
+        {
+            return "half_transparent_texture";
+        }
+
+        virtual ColorSpace get_color_space() const override
+        {
+            return ColorSpaceLinearRGB;
+        }
+
+        virtual const CanvasProperties& properties() override
+        {
+            return m_props;
+        }
+
+        virtual Tile* load_tile(
+            const size_t    tile_x,
+            const size_t    tile_y) override
+        {
+            assert(tile_x == 0);
+            assert(tile_y == 0);
+
+            return m_tile.get();
+        }
+
+        virtual void unload_tile(
+            const size_t    tile_x,
+            const size_t    tile_y,
+            const Tile*     tile) override
+        {
+        }
+
+      private:
+        const CanvasProperties  m_props;
+        auto_ptr<Tile>          m_tile;
+    };
+
+    // Number of cells along each side of the grids. Odd so that the middle column
+    // of cells straddles the boundary between opaque and transparent texels.
+    const size_t GridSize = 5;
+
+    // A 2x2 grid of GridSize x GridSize cells in the plane z = z, whose alpha map is opaque
+    // for x < 0, or for x > 0 if flip_u is true. Vertices are shared by adjacent triangles.
+    auto_release_ptr<MeshObject> create_grid(
+        const char*     name,
+        const double    z,
+        const bool      flip_u)
+    {
+        auto_release_ptr<MeshObject> mesh_object =
+            MeshObjectFactory::create(
+                name,
+                ParamArray().insert("alpha_map", "texture_instance"));
+
+        for (size_t y = 0; y <= GridSize; ++y)
+        {
+            for (size_t x = 0; x <= GridSize; ++x)
+            {
+                const double fx = static_cast<double>(x) / GridSize;
+                const double fy = static_cast<double>(y) / GridSize;
+
+                mesh_object->push_vertex(
+                    GVector3(
+                        static_cast<GScalar>(2.0 * fx - 1.0),
+                        static_cast<GScalar>(2.0 * fy - 1.0),
+                        static_cast<GScalar>(z)));
+
+                mesh_object->push_tex_coords(
+                    GVector2(
+                        static_cast<GScalar>(flip_u ? 1.0 - fx : fx),
+                        static_cast<GScalar>(fy)));
+            }
+        }
+
+        for (size_t y = 0; y < GridSize; ++y)
+        {
+            for (size_t x = 0; x < GridSize; ++x)
+            {
+                const size_t v0 = y * (GridSize + 1) + x;
+                const size_t v1 = v0 + 1;
+                const size_t v2 = v1 + GridSize + 1;
+                const size_t v3 = v0 + GridSize + 1;
+                const size_t None = Triangle::None;
+                mesh_object->push_triangle(Triangle(v0, v1, v2, None, None, None, v0, v1, v2, 0));
+                mesh_object->push_triangle(Triangle(v2, v3, v0, None, None, None, v2, v3, v0, 0));
+            }
+        }
+
+        return mesh_object;
+    }
+
+    // A static grid in the plane z = 0, opaque for x < 0, above a grid moving from
+    // z = -1 to z = -2 during the shutter interval, opaque for x > 0, in an assembly
+    // using a given triangle encoding. Every ray through the grids hits one of them.
+    struct TestScene
+    {
+        auto_release_ptr<Scene>         m_scene;
+        auto_ptr<TraceContext>          m_trace_context;
+        auto_ptr<TextureStore>          m_texture_store;
+        auto_ptr<TextureCache>          m_texture_cache;
+        auto_ptr<Intersector>           m_intersector;
+
+        explicit TestScene(const char* triangle_encoding)
+          : m_scene(SceneFactory::create())
+        {
+            // Use leaves too large to be stored in tree nodes, so that the encodings affect the tree size.
+            ParamArray assembly_params;
+            assembly_params.insert_path("acceleration_structure.triangle_encoding", triangle_encoding);
+            assembly_params.insert_path("acceleration_structure.max_leaf_size", 8);
+
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory().create("assembly", assembly_params));
+
+            assembly->textures().insert(
+                auto_release_ptr<Texture>(new HalfTransparentTexture("texture")));
+
+            ParamArray texture_instance_params;
+            texture_instance_params.insert("addressing_mode", "clamp");
+            texture_instance_params.insert("filtering_mode", "nearest");
+
+            assembly->texture_instances().insert(
+                TextureInstanceFactory::create(
+                    "texture_instance",
+                    texture_instance_params,
+                    "texture",
+                    Transformf::identity()));
+
+            auto_release_ptr<MeshObject> static_grid = create_grid("static_grid", 0.0, false);
+
+            auto_release_ptr<MeshObject> moving_grid = create_grid("moving_grid", -1.0, true);
+            moving_grid->set_motion_segment_count(1);
+            for (size_t i = 0, e = moving_grid->get_vertex_count(); i < e; ++i)
+                moving_grid->set_vertex_pose(i, 0, moving_grid->get_vertex(i) - GVector3(0.0f, 0.0f, 1.0f));
+
+            assembly->objects().insert(auto_release_ptr<Object>(static_grid.release()));
+            assembly->objects().insert(auto_release_ptr<Object>(moving_grid.release()));
+
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "static_grid_inst",
+                    ParamArray(),
+                    "static_grid",
+                    Transformd::identity(),
+                    StringDictionary()));
+
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "moving_grid_inst",
+                    ParamArray(),
+                    "moving_grid",
+                    Transformd::identity(),
+                    StringDictionary()));
+
+            m_scene->assembly_instances().insert(
+                auto_release_ptr<AssemblyInstance>(
+                    AssemblyInstanceFactory::create(
+                        "assembly_instance",
+                        ParamArray(),
+                        "assembly")));
+
+            m_scene->assemblies().insert(assembly);
+
+            InputBinder input_binder;
+            input_binder.bind(m_scene.ref());
+            assert(input_binder.get_error_count() == 0);
+
+            m_trace_context.reset(new TraceContext(m_scene.ref()));
+            m_texture_store.reset(new TextureStore(m_scene.ref()));
+            m_texture_cache.reset(new TextureCache(*m_texture_store));
+            m_intersector.reset(new Intersector(*m_trace_context, *m_texture_cache));
+        }
+
+        // Build the triangle tree of the assembly, the way the assembly tree does.
+        auto_ptr<TriangleTree> create_triangle_tree() const
+        {
+            const Assembly& assembly = *m_scene->assemblies().get_by_name("assembly");
+
+            RegionInfoVector regions;
+            GAABB3 bbox;
+            bbox.invalidate();
+
+            for (size_t i = 0; i < assembly.object_instances().size(); ++i)
+            {
+                const ObjectInstance* object_instance = assembly.object_instances().get_by_index(i);
+                Access<RegionKit> region_kit(&object_instance->get_object().get_region_kit());
+
+                for (size_t j = 0; j < region_kit->size(); ++j)
+                {
+                    const GAABB3 region_bbox =
+                        object_instance->get_transform().to_parent((*region_kit)[j]->compute_local_bbox());
+                    regions.push_back(RegionInfo(i, j, region_bbox));
+                    bbox.insert(region_bbox);
+                }
+            }
+
+            auto_ptr<TriangleTree> tree(
+                new TriangleTree(
+                    TriangleTree::Arguments(
+                        m_scene.ref(),
+                        assembly.get_uid(),
+                        bbox,
+                        assembly,
+                        regions)));
+
+            tree->update_non_geometry(true);
+
+            return tree;
+        }
+    };
+
+    struct Fixture
+    {
+        TestScene   m_vertices_scene;
+        TestScene   m_indices_scene;
+
+        Fixture()
+          : m_vertices_scene("vertices")
+          , m_indices_scene("indices")
+        {
+        }
+    };
+
+    ShadingRay make_ray(const double x, const double y, const float time)
+    {
+        return
+            ShadingRay(
+                Vector3d(x, y, 4.0),
+                Vector3d(0.0, 0.0, -1.0),
+                0.0,                            // tmin
+                10.0,                           // tmax
+                ShadingRay::Time::create_with_normalized_time(time, 0.0f, 1.0f),
+                VisibilityFlags::CameraRay,
+                0);                             // depth
+    }
+
+    TEST_CASE_F(Trace_GivenIndexedTriangles_ReturnsSameHitsAsVertexTriangles, Fixture)
+    {
+        // Cast rays away from triangle edges, where single and double precision may disagree.
+        const size_t RayCount = 16;
+        const float Times[] = { 0.0f, 0.3f, 0.8f };
+        size_t static_hit_count = 0, moving_hit_count = 0;
+
+        for (size_t t = 0; t < 3; ++t)
+        {
+            for (size_t y = 0; y < RayCount; ++y)
+            {
+                for (size_t x = 0; x < RayCount; ++x)
+                {
+                    const ShadingRay ray =
+                        make_ray(
+                            2.0 * (x + 0.37) / RayCount - 1.0,
+                            2.0 * (y + 0.61) / RayCount - 1.0,
+                            Times[t]);
+
+                    ShadingPoint vertices_shading_point;
+                    const bool vertices_hit = m_vertices_scene.m_intersector->trace(ray, vertices_shading_point);
+
+                    ShadingPoint indices_shading_point;
+                    const bool indices_hit = m_indices_scene.m_intersector->trace(ray, indices_shading_point);
+
+                    EXPECT_TRUE(vertices_hit);
+                    ASSERT_EQ(vertices_hit, indices_hit);
+
+                    if (!vertices_hit)
+                        continue;
+
+                    EXPECT_EQ(
+                        vertices_shading_point.get_object_instance_index(),
+                        indices_shading_point.get_object_instance_index());
+                    EXPECT_EQ(
+                        vertices_shading_point.get_primitive_index(),
+                        indices_shading_point.get_primitive_index());
+                    EXPECT_FEQ_EPS(
+                        vertices_shading_point.get_distance(),
+                        indices_shading_point.get_distance(),
+                        1.0e-5);
+
+                    if (vertices_shading_point.get_object_instance_index() == 0)
+                        ++static_hit_count;
+                    else ++moving_hit_count;
+                }
+            }
+        }
+
+        // Both the static and the moving grid were hit.
+        EXPECT_GT(0, static_hit_count);
+        EXPECT_GT(0, moving_hit_count);
+    }
+
+    TEST_CASE_F(TraceProbe_GivenIndexedTriangles_ReturnsSameResultsAsVertexTriangles, Fixture)
+    {
+        const size_t RayCount = 16;
+
+        for (size_t y = 0; y < RayCount; ++y)
+        {
+            for (size_t x = 0; x < RayCount; ++x)
+            {
+                const ShadingRay ray =
+                    make_ray(
+                        2.0 * (x + 0.37) / RayCount - 1.0,
+                        2.0 * (y + 0.61) / RayCount - 1.0,
+                        0.5f);
+
+                EXPECT_EQ(
+                    m_vertices_scene.m_intersector->trace_probe(ray),
+                    m_indices_scene.m_intersector->trace_probe(ray));
+            }
+        }
+    }
+
+    TEST_CASE_F(GetMemorySize_GivenIndexedTriangles_ReturnsSmallerSizeThanVertexTriangles, Fixture)
+    {
+        const auto_ptr<TriangleTree> vertices_tree = m_vertices_scene.create_triangle_tree();
+        const auto_ptr<TriangleTree> indices_tree = m_indices_scene.create_triangle_tree();
+
+        ASSERT_EQ(vertices_tree->get_static_triangle_count(), indices_tree->get_static_triangle_count());
+        ASSERT_EQ(vertices_tree->get_moving_triangle_count(), indices_tree->get_moving_triangle_count());
+        EXPECT_EQ(2 * GridSize * GridSize, indices_tree->get_static_triangle_count());
+        EXPECT_EQ(2 * GridSize * GridSize, indices_tree->get_moving_triangle_count());
+
+        EXPECT_LT(vertices_tree->get_memory_size(), indices_tree->get_memory_size());
+    }
+}
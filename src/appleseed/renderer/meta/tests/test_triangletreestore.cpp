@@ -0,0 +1,228 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/intersection/tracecontext.h"
+#include "renderer/kernel/intersection/triangletreestore.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/string.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Intersection_TriangleTreeStore)
+{
+    const size_t AssemblyCount = 3;
+
+    // A row of assemblies, each containing a 2x2 square in the z = 0 plane centered on (3 * i, 0, 0).
+    struct TestScene
+    {
+        auto_release_ptr<Scene> m_scene;
+
+        TestScene()
+          : m_scene(SceneFactory::create())
+        {
+            for (size_t i = 0; i < AssemblyCount; ++i)
+            {
+                const string assembly_name = "assembly" + to_string(i);
+
+                auto_release_ptr<Assembly> assembly(
+                    AssemblyFactory().create(assembly_name.c_str(), ParamArray()));
+
+                auto_release_ptr<MeshObject> mesh_object =
+                    MeshObjectFactory::create("object", ParamArray());
+
+                const GScalar x = static_cast<GScalar>(3.0 * i);
+                mesh_object->push_vertex(GVector3(x - 1.0f, -1.0f, 0.0f));
+                mesh_object->push_vertex(GVector3(x + 1.0f, -1.0f, 0.0f));
+                mesh_object->push_vertex(GVector3(x + 1.0f, 1.0f, 0.0f));
+                mesh_object->push_vertex(GVector3(x - 1.0f, 1.0f, 0.0f));
+                mesh_object->push_triangle(Triangle(0, 1, 2, 0));
+                mesh_object->push_triangle(Triangle(2, 3, 0, 0));
+
+                assembly->objects().insert(auto_release_ptr<Object>(mesh_object.release()));
+
+                assembly->object_instances().insert(
+                    ObjectInstanceFactory::create(
+                        "object_instance",
+                        ParamArray(),
+                        "object",
+                        Transformd::identity(),
+                        StringDictionary()));
+
+                m_scene->assembly_instances().insert(
+                    auto_release_ptr<AssemblyInstance>(
+                        AssemblyInstanceFactory::create(
+                            (assembly_name + "_inst").c_str(),
+                            ParamArray(),
+                            assembly_name.c_str())));
+
+                m_scene->assemblies().insert(assembly);
+            }
+        }
+    };
+
+    struct Fixture
+      : public BindInputs<TestScene>
+    {
+        TextureStore    m_texture_store;
+        TextureCache    m_texture_cache;
+
+        Fixture()
+          : m_texture_store(m_scene.ref())
+          , m_texture_cache(m_texture_store)
+        {
+        }
+
+        // Trace a ray toward one of the assemblies with a new intersector. The triangle
+        // tree access cache of the intersector is destroyed with it, so the trees it
+        // accessed can be evicted afterward.
+        bool trace_to_assembly(
+            const TraceContext&     trace_context,
+            const size_t            assembly_index)
+        {
+            const Intersector intersector(trace_context, m_texture_cache);
+
+            const ShadingRay ray(
+                Vector3d(3.0 * assembly_index, 0.0, 4.0),
+                Vector3d(0.0, 0.0, -1.0),
+                0.0,                                // tmin
+                10.0,                               // tmax
+                ShadingRay::Time(),
+                VisibilityFlags::CameraRay,
+                0);                                 // depth
+
+            ShadingPoint shading_point;
+            return intersector.trace(ray, shading_point);
+        }
+    };
+
+    ParamArray make_params(const size_t max_size)
+    {
+        ParamArray params;
+        params.insert("max_size", max_size);
+        return params;
+    }
+
+    TEST_CASE_F(TraceContext_GivenNoMemoryBudget_DisablesStore, Fixture)
+    {
+        const TraceContext trace_context(m_scene.ref());
+
+        EXPECT_FALSE(trace_context.get_triangle_tree_store().is_enabled());
+        EXPECT_TRUE(trace_to_assembly(trace_context, 0));
+    }
+
+    TEST_CASE_F(Trace_GivenLargeMemoryBudget_KeepsAllTreesResident, Fixture)
+    {
+        const TraceContext trace_context(m_scene.ref(), make_params(1024 * 1024 * 1024));
+        const TriangleTreeStore& store = trace_context.get_triangle_tree_store();
+
+        ASSERT_TRUE(store.is_enabled());
+        EXPECT_EQ(0, store.get_resident_tree_count());
+
+        for (size_t i = 0; i < AssemblyCount; ++i)
+            EXPECT_TRUE(trace_to_assembly(trace_context, i));
+
+        EXPECT_EQ(AssemblyCount, store.get_resident_tree_count());
+        EXPECT_EQ(0, store.get_eviction_count());
+        EXPECT_EQ(0, store.get_reload_count());
+    }
+
+    TEST_CASE_F(Trace_GivenTinyMemoryBudget_EvictsLeastRecentlyLoadedTrees, Fixture)
+    {
+        const TraceContext trace_context(m_scene.ref(), make_params(1));
+        const TriangleTreeStore& store = trace_context.get_triangle_tree_store();
+
+        for (size_t i = 0; i < AssemblyCount; ++i)
+            EXPECT_TRUE(trace_to_assembly(trace_context, i));
+
+        // Every tree but the last one loaded was evicted when the next one was loaded.
+        EXPECT_EQ(1, store.get_resident_tree_count());
+        EXPECT_EQ(AssemblyCount - 1, store.get_eviction_count());
+        EXPECT_EQ(0, store.get_reload_count());
+    }
+
+    TEST_CASE_F(Trace_GivenEvictedTree_RecreatesTree, Fixture)
+    {
+        const TraceContext trace_context(m_scene.ref(), make_params(1));
+        const TriangleTreeStore& store = trace_context.get_triangle_tree_store();
+
+        for (size_t i = 0; i < AssemblyCount; ++i)
+            EXPECT_TRUE(trace_to_assembly(trace_context, i));
+
+        // The tree of the first assembly was evicted: it must be created again.
+        EXPECT_TRUE(trace_to_assembly(trace_context, 0));
+
+        EXPECT_EQ(1, store.get_resident_tree_count());
+        EXPECT_EQ(AssemblyCount, store.get_eviction_count());
+        EXPECT_EQ(1, store.get_reload_count());
+    }
+
+    TEST_CASE_F(TraceContexts_GivenDifferentMemoryBudgets_ConfigureTheirOwnStores, Fixture)
+    {
+        TraceContext paged_trace_context(m_scene.ref(), make_params(1));
+        const TraceContext resident_trace_context(m_scene.ref());
+
+        EXPECT_TRUE(paged_trace_context.get_triangle_tree_store().is_enabled());
+        EXPECT_FALSE(resident_trace_context.get_triangle_tree_store().is_enabled());
+
+        paged_trace_context.update(make_params(0));
+
+        EXPECT_FALSE(paged_trace_context.get_triangle_tree_store().is_enabled());
+        EXPECT_TRUE(trace_to_assembly(paged_trace_context, 0));
+        EXPECT_TRUE(trace_to_assembly(resident_trace_context, 0));
+    }
+}
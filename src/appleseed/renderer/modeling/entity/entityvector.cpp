@@ -33,9 +33,14 @@
 // appleseed.foundation headers.
 #include "foundation/utility/foreach.h"
 
+// Boost headers.
+#include "boost/functional/hash.hpp"
+#include "boost/unordered_map.hpp"
+
 // Standard headers.
 #include <cassert>
-#include <map>
+#include <cstring>
+#include <string>
 #include <vector>
 
 using namespace foundation;
@@ -44,11 +49,50 @@ using namespace std;
 namespace renderer
 {
 
+namespace
+{
+    // Hash and compare entity names without building a std::string
+    // from the C string passed to lookup methods.
+
+    struct NameHash
+    {
+        size_t operator()(const string& name) const
+        {
+            return boost::hash_range(name.begin(), name.end());
+        }
+
+        size_t operator()(const char* name) const
+        {
+            return boost::hash_range(name, name + strlen(name));
+        }
+    };
+
+    struct NameEqual
+    {
+        bool operator()(const string& lhs, const string& rhs) const
+        {
+            return lhs == rhs;
+        }
+
+        bool operator()(const char* lhs, const string& rhs) const
+        {
+            return rhs == lhs;
+        }
+
+        bool operator()(const string& lhs, const char* rhs) const
+        {
+            return lhs == rhs;
+        }
+    };
+}
+
 struct EntityVector::Impl
 {
+    // Hash tables rather than trees: scenes may hold hundreds of thousands of
+    // entities in a single container, and each insertion looks up the name.
     typedef vector<Entity*> Storage;
-    typedef map<UniqueID, size_t> IDIndex;
-    typedef map<string, size_t> NameIndex;
+    typedef boost::unordered_map<UniqueID, size_t> IDIndex;
+    typedef boost::unordered_map<string, size_t, NameHash, NameEqual> NameIndex;
 
     Storage     m_storage;
     IDIndex     m_id_index;
@@ -280,7 +324,7 @@ size_t EntityVector::insert(auto_release_ptr<Entity> entity)
 
     // The entity shouldn't already be in the container.
     assert(impl->m_id_index.find(entity_ptr->get_uid()) == impl->m_id_index.end());
-    assert(impl->m_name_index.find(entity_ptr->get_name()) == impl->m_name_index.end());
+    assert(impl->m_name_index.find(entity_ptr->get_name(), NameHash(), NameEqual()) == impl->m_name_index.end());
 
     // Insert the entity into the container.
     const size_t entity_index = impl->m_storage.size();
@@ -300,7 +344,8 @@ auto_release_ptr<Entity> EntityVector::remove(Entity* entity)
 
     // Find the entity to remove in the vector.
     const Impl::IDIndex::iterator id_it = impl->m_id_index.find(entity->get_uid());
-    const Impl::NameIndex::iterator name_it = impl->m_name_index.find(entity->get_name());
+    const Impl::NameIndex::iterator name_it =
+        impl->m_name_index.find(entity->get_name(), NameHash(), NameEqual());
     assert(id_it != impl->m_id_index.end());
     assert(name_it != impl->m_name_index.end());
     assert(id_it->second == name_it->second);
@@ -336,7 +381,7 @@ size_t EntityVector::get_index(const UniqueID id) const
 size_t EntityVector::get_index(const char* name) const
 {
     assert(name);
-    const Impl::NameIndex::iterator it = impl->m_name_index.find(name);
+    const Impl::NameIndex::iterator it = impl->m_name_index.find(name, NameHash(), NameEqual());
     return it == impl->m_name_index.end() ? ~0 : it->second;
 }
 
@@ -34,7 +34,7 @@
 
 // Standard headers.
 #include <cassert>
-#include <stack>
+#include <vector>
 
 using namespace std;
 
@@ -49,7 +49,7 @@ struct OnFrameBeginRecorder::Impl
         const BaseGroup*    m_parent;
     };
 
-    stack<Record> m_records;
+    vector<Record> m_records;
 };
 
 OnFrameBeginRecorder::OnFrameBeginRecorder()
@@ -68,17 +68,29 @@ void OnFrameBeginRecorder::record(Entity* entity, const BaseGroup* parent)
     Impl::Record record;
     record.m_entity = entity;
     record.m_parent = parent;
-    impl->m_records.push(record);
+    impl->m_records.push_back(record);
 }
 
 void OnFrameBeginRecorder::on_frame_end(const Project& project)
 {
     while (!impl->m_records.empty())
     {
-        const Impl::Record& record = impl->m_records.top();
+        const Impl::Record& record = impl->m_records.back();
         record.m_entity->on_frame_end(project, record.m_parent);
-        impl->m_records.pop();
+        impl->m_records.pop_back();
     }
 }
 
+void OnFrameBeginRecorder::append(OnFrameBeginRecorder& other)
+{
+    assert(&other != this);
+
+    impl->m_records.insert(
+        impl->m_records.end(),
+        other.impl->m_records.begin(),
+        other.impl->m_records.end());
+
+    other.impl->m_records.clear();
+}
+
 }   // namespace renderer
@@ -54,6 +54,11 @@ class APPLESEED_DLLSYMBOL OnFrameBeginRecorder
     void record(Entity* entity, const BaseGroup* parent);
     void on_frame_end(const Project& project);
 
+    // Move all the records of another recorder on top of the records of this one.
+    // Allows to call on_frame_begin() on independent entities from multiple threads,
+    // each thread recording into its own recorder.
+    void append(OnFrameBeginRecorder& other);
+
   private:
     struct Impl;
     Impl* impl;
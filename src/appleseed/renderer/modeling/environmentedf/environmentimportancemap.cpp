@@ -0,0 +1,336 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "environmentimportancemap.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/entity/entity.h"
+#include "renderer/modeling/input/source.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/colorspace.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/defaulttimers.h"
+#include "foundation/utility/job/abortswitch.h"
+#include "foundation/utility/job/ijob.h"
+#include "foundation/utility/job/jobmanager.h"
+#include "foundation/utility/job/jobqueue.h"
+#include "foundation/utility/stopwatch.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    //
+    // Evaluates the radiance of the environment map at the center of a texel.
+    //
+
+    class ImageSampler
+    {
+      public:
+        ImageSampler(
+            TextureCache&                               texture_cache,
+            const EnvironmentImportanceMap::Mapping     mapping,
+            const Source*                               radiance_source,
+            const Source*                               multiplier_source,
+            const Source*                               exposure_source,
+            const size_t                                width,
+            const size_t                                height)
+          : m_texture_cache(texture_cache)
+          , m_mapping(mapping)
+          , m_radiance_source(radiance_source)
+          , m_multiplier_source(multiplier_source)
+          , m_exposure_source(exposure_source)
+          , m_rcp_width(1.0f / width)
+          , m_rcp_height(1.0f / height)
+        {
+        }
+
+        void sample(const size_t x, const size_t y, Color3f& payload, float& importance)
+        {
+            const Vector2f uv(
+                (x + 0.5f) * m_rcp_width,
+                1.0f - (y + 0.5f) * m_rcp_height);
+
+            if (m_radiance_source == 0 || !is_sampleable(uv))
+            {
+                payload.set(0.0f);
+                importance = 0.0f;
+                return;
+            }
+
+            m_radiance_source->evaluate(m_texture_cache, uv, payload);
+
+            if (is_finite(payload))
+            {
+                float multiplier;
+                m_multiplier_source->evaluate(m_texture_cache, uv, multiplier);
+                payload *= multiplier;
+
+                if (m_exposure_source)
+                {
+                    float exposure;
+                    m_exposure_source->evaluate(m_texture_cache, uv, exposure);
+                    payload *= pow(2.0f, exposure);
+                }
+
+                importance = luminance(payload);
+            }
+            else
+            {
+                payload.set(0.0f);
+                importance = 0.0f;
+            }
+        }
+
+      private:
+        TextureCache&                                   m_texture_cache;
+        const EnvironmentImportanceMap::Mapping         m_mapping;
+        const Source*                                   m_radiance_source;
+        const Source*                                   m_multiplier_source;
+        const Source*                                   m_exposure_source;
+        const float                                     m_rcp_width;
+        const float                                     m_rcp_height;
+
+        bool is_sampleable(const Vector2f& uv) const
+        {
+            if (m_mapping == EnvironmentImportanceMap::MirrorBallMapping)
+                return square(uv[0] - 0.5f) + square(uv[1] - 0.5f) < 0.25f;
+
+            return true;
+        }
+    };
+
+
+    //
+    // Resamples a range of rows of the importance map.
+    //
+
+    class ImportanceMapRowsJob
+      : public IJob
+    {
+      public:
+        ImportanceMapRowsJob(
+            EnvironmentImportanceMap::SamplerType&      importance_sampler,
+            TextureStore&                               texture_store,
+            const EnvironmentImportanceMap::Mapping     mapping,
+            const Source*                               radiance_source,
+            const Source*                               multiplier_source,
+            const Source*                               exposure_source,
+            const size_t                                row_begin,
+            const size_t                                row_end,
+            IAbortSwitch*                               abort_switch)
+          : m_importance_sampler(importance_sampler)
+          , m_texture_store(texture_store)
+          , m_mapping(mapping)
+          , m_radiance_source(radiance_source)
+          , m_multiplier_source(multiplier_source)
+          , m_exposure_source(exposure_source)
+          , m_row_begin(row_begin)
+          , m_row_end(row_end)
+          , m_abort_switch(abort_switch)
+        {
+        }
+
+        virtual void execute(const size_t thread_index) override
+        {
+            if (is_aborted(m_abort_switch))
+                return;
+
+            // Texture caches are not thread-safe: use one per job.
+            TextureCache texture_cache(m_texture_store);
+            ImageSampler sampler(
+                texture_cache,
+                m_mapping,
+                m_radiance_source,
+                m_multiplier_source,
+                m_exposure_source,
+                m_importance_sampler.get_width(),
+                m_importance_sampler.get_height());
+
+            m_importance_sampler.rebuild_rows(sampler, m_row_begin, m_row_end);
+        }
+
+      private:
+        EnvironmentImportanceMap::SamplerType&          m_importance_sampler;
+        TextureStore&                                   m_texture_store;
+        const EnvironmentImportanceMap::Mapping         m_mapping;
+        const Source*                                   m_radiance_source;
+        const Source*                                   m_multiplier_source;
+        const Source*                                   m_exposure_source;
+        const size_t                                    m_row_begin;
+        const size_t                                    m_row_end;
+        IAbortSwitch*                                   m_abort_switch;
+    };
+
+    const size_t RowsPerJob = 16;
+
+    uint64 compute_sources_signature(
+        const size_t                width,
+        const size_t                height,
+        const Source*               radiance_source,
+        const Source*               multiplier_source,
+        const Source*               exposure_source)
+    {
+        uint64 signature = Entity::combine_signatures(width, height);
+
+        if (radiance_source)
+            signature = Entity::combine_signatures(signature, radiance_source->compute_signature());
+
+        if (multiplier_source)
+            signature = Entity::combine_signatures(signature, multiplier_source->compute_signature());
+
+        if (exposure_source)
+            signature = Entity::combine_signatures(signature, exposure_source->compute_signature());
+
+        return signature;
+    }
+}
+
+
+//
+// EnvironmentImportanceMap class implementation.
+//
+
+EnvironmentImportanceMap::EnvironmentImportanceMap(const Mapping mapping)
+  : m_mapping(mapping)
+  , m_signature(0)
+{
+}
+
+bool EnvironmentImportanceMap::update(
+    const Scene&                    scene,
+    const char*                     entity_path,
+    const size_t                    width,
+    const size_t                    height,
+    const Source*                   radiance_source,
+    const Source*                   multiplier_source,
+    const Source*                   exposure_source,
+    const size_t                    thread_count,
+    IAbortSwitch*                   abort_switch)
+{
+    assert(multiplier_source);
+
+    const uint64 signature =
+        compute_sources_signature(
+            width,
+            height,
+            radiance_source,
+            multiplier_source,
+            exposure_source);
+
+    // Reuse the existing importance map if the environment did not change.
+    if (m_sampler.get() && m_signature == signature)
+    {
+        RENDERER_LOG_DEBUG(
+            "reusing " FMT_SIZE_T "x" FMT_SIZE_T " importance map for environment edf \"%s\".",
+            width,
+            height,
+            entity_path);
+        return true;
+    }
+
+    RENDERER_LOG_INFO(
+        "building " FMT_SIZE_T "x" FMT_SIZE_T " importance map "
+        "for environment edf \"%s\"...",
+        width,
+        height,
+        entity_path);
+
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    m_sampler.reset(new SamplerType(width, height));
+
+    TextureStore texture_store(scene);
+
+    // Resample the rows of the environment map in parallel.
+    JobQueue job_queue;
+    for (size_t row_begin = 0; row_begin < height; row_begin += RowsPerJob)
+    {
+        job_queue.schedule(
+            new ImportanceMapRowsJob(
+                *m_sampler,
+                texture_store,
+                m_mapping,
+                radiance_source,
+                multiplier_source,
+                exposure_source,
+                row_begin,
+                min(row_begin + RowsPerJob, height),
+                abort_switch));
+    }
+
+    JobManager job_manager(
+        global_logger(),
+        job_queue,
+        thread_count);
+    job_manager.start();
+    job_queue.wait_until_completion();
+
+    if (is_aborted(abort_switch))
+    {
+        clear();
+        return false;
+    }
+
+    // Build the alias table of the rows.
+    m_sampler->prepare();
+    m_signature = signature;
+
+    stopwatch.measure();
+
+    RENDERER_LOG_INFO(
+        "built importance map for environment edf \"%s\" in %s.",
+        entity_path,
+        pretty_time(stopwatch.get_seconds()).c_str());
+
+    return true;
+}
+
+void EnvironmentImportanceMap::clear()
+{
+    m_sampler.reset();
+    m_signature = 0;
+}
+
+}   // namespace renderer
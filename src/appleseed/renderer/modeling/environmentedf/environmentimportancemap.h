@@ -0,0 +1,122 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_MODELING_ENVIRONMENTEDF_ENVIRONMENTIMPORTANCEMAP_H
+#define APPLESEED_RENDERER_MODELING_ENVIRONMENTEDF_ENVIRONMENTIMPORTANCEMAP_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/image/color.h"
+#include "foundation/math/sampling/imageimportancesampler.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <memory>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+namespace renderer      { class Scene; }
+namespace renderer      { class Source; }
+
+namespace renderer
+{
+
+//
+// Importance map of a texture-based environment EDF.
+//
+// The map is built in parallel (one job per range of rows) and is only rebuilt
+// when the signature of the sources feeding it changes, so that it survives
+// frames and rendering restarts as long as the environment is unchanged.
+//
+
+class EnvironmentImportanceMap
+  : public foundation::NonCopyable
+{
+  public:
+    typedef foundation::ImageImportanceSampler<foundation::Color3f, float> SamplerType;
+
+    // Parameterization of the environment map.
+    enum Mapping
+    {
+        LatLongMapping,                     // all texels may be sampled
+        MirrorBallMapping                   // only texels inside the disk of the mirror ball may be sampled
+    };
+
+    // Constructor.
+    explicit EnvironmentImportanceMap(const Mapping mapping);
+
+    // Rebuild the importance map unless a map built from the same sources is available.
+    // exposure_source is optional. The map is built using thread_count threads.
+    // Return true if a valid importance map is available.
+    bool update(
+        const Scene&                scene,
+        const char*                 entity_path,
+        const size_t                width,
+        const size_t                height,
+        const Source*               radiance_source,
+        const Source*               multiplier_source,
+        const Source*               exposure_source,
+        const size_t                thread_count,
+        foundation::IAbortSwitch*   abort_switch);
+
+    // Discard the importance map.
+    void clear();
+
+    // Return true if a valid importance map is available.
+    bool is_valid() const;
+
+    // Access the importance sampler. Only valid if is_valid() returns true.
+    const SamplerType& get_sampler() const;
+
+  private:
+    const Mapping                   m_mapping;
+    std::auto_ptr<SamplerType>      m_sampler;
+    foundation::uint64              m_signature;
+};
+
+
+//
+// EnvironmentImportanceMap class implementation.
+//
+
+inline bool EnvironmentImportanceMap::is_valid() const
+{
+    return m_sampler.get() != 0;
+}
+
+inline const EnvironmentImportanceMap::SamplerType& EnvironmentImportanceMap::get_sampler() const
+{
+    assert(m_sampler.get());
+    return *m_sampler;
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_MODELING_ENVIRONMENTEDF_ENVIRONMENTIMPORTANCEMAP_H
@@ -35,8 +35,8 @@
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/texturing/texturecache.h"
-#include "renderer/kernel/texturing/texturestore.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
+#include "renderer/modeling/environmentedf/environmentimportancemap.h"
 #include "renderer/modeling/environmentedf/sphericalcoordinates.h"
 #include "renderer/modeling/input/inputarray.h"
 #include "renderer/modeling/input/source.h"
@@ -54,7 +54,6 @@
 #include "foundation/image/colorspace.h"
 #include "foundation/math/fp.h"
 #include "foundation/math/matrix.h"
-#include "foundation/math/sampling/imageimportancesampler.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
@@ -92,69 +91,6 @@ namespace
     //   http://www.cs.kuleuven.be/~graphics/index.php/environment-maps
     //
 
-    typedef ImageImportanceSampler<Color3f, float> ImageImportanceSamplerType;
-
-    class ImageSampler
-    {
-      public:
-        ImageSampler(
-            TextureCache&   texture_cache,
-            const Source*   radiance_source,
-            const Source*   multiplier_source,
-            const Source*   exposure_source,
-            const size_t    width,
-            const size_t    height)
-          : m_texture_cache(texture_cache)
-          , m_radiance_source(radiance_source)
-          , m_multiplier_source(multiplier_source)
-          , m_exposure_source(exposure_source)
-          , m_rcp_width(1.0f / width)
-          , m_rcp_height(1.0f / height)
-        {
-        }
-
-        void sample(const size_t x, const size_t y, Color3f& payload, float& importance)
-        {
-            if (m_radiance_source == 0)
-            {
-                payload.set(0.0f);
-                importance = 0.0f;
-                return;
-            }
-
-            const Vector2f uv(
-                (x + 0.5f) * m_rcp_width,
-                1.0f - (y + 0.5f) * m_rcp_height);
-
-            m_radiance_source->evaluate(m_texture_cache, uv, payload);
-
-            if (is_finite(payload))
-            {
-                float multiplier;
-                m_multiplier_source->evaluate(m_texture_cache, uv, multiplier);
-
-                float exposure;
-                m_exposure_source->evaluate(m_texture_cache, uv, exposure);
-
-                payload *= multiplier * pow(2.0f, exposure);
-                importance = luminance(payload);
-            }
-            else
-            {
-                payload.set(0.0f);
-                importance = 0.0f;
-            }
-        }
-
-      private:
-        TextureCache&   m_texture_cache;
-        const Source*   m_radiance_source;
-        const Source*   m_multiplier_source;
-        const Source*   m_exposure_source;
-        const float     m_rcp_width;
-        const float     m_rcp_height;
-    };
-
     const char* Model = "latlong_map_environment_edf";
 
     class LatLongMapEnvironmentEDF
@@ -165,6 +101,7 @@ namespace
             const char*             name,
             const ParamArray&       params)
           : EnvironmentEDF(name, params)
+          , m_importance_map(EnvironmentImportanceMap::LatLongMapping)
           , m_importance_map_width(0)
           , m_importance_map_height(0)
           , m_probability_scale(0.0f)
@@ -201,9 +138,10 @@ namespace
             if (environment->get_uncached_environment_edf() == this)
             {
                 check_non_zero_emission("radiance", "radiance_multiplier");
-
-                if (m_importance_sampler.get() == 0)
-                    build_importance_map(*project.get_scene(), abort_switch);
+                build_importance_map(
+                    *project.get_scene(),
+                    project.get_thread_count(),
+                    abort_switch);
             }
 
             return true;
@@ -216,7 +154,7 @@ namespace
             Spectrum&               value,
             float&                  probability) const override
         {
-            if (m_importance_sampler.get() == 0)
+            if (!m_importance_map.is_valid())
             {
                 RENDERER_LOG_WARNING(
                     "cannot sample environment edf \"%s\" because it is not bound to the environment.",
@@ -230,7 +168,7 @@ namespace
             size_t x, y;
             Color3f payload;
             float prob_xy;
-            m_importance_sampler->sample(s, x, y, payload, prob_xy);
+            m_importance_map.get_sampler().sample(s, x, y, payload, prob_xy);
 
             // Compute the coordinates in [0,1]^2 of the sample.
             const float u = (x + 0.5f) * m_rcp_importance_map_width;
@@ -294,7 +232,7 @@ namespace
         {
             assert(is_normalized(outgoing));
 
-            if (m_importance_sampler.get() == 0)
+            if (!m_importance_map.is_valid())
             {
                 RENDERER_LOG_WARNING(
                     "cannot compute pdf for environment edf \"%s\" because it is not bound to the environment.",
@@ -328,7 +266,7 @@ namespace
         {
             assert(is_normalized(outgoing));
 
-            if (m_importance_sampler.get() == 0)
+            if (!m_importance_map.is_valid())
             {
                 RENDERER_LOG_WARNING(
                     "cannot compute pdf for environment edf \"%s\" because it is not bound to the environment.",
@@ -372,9 +310,12 @@ namespace
         float   m_rcp_importance_map_height;
         float   m_probability_scale;
 
-        auto_ptr<ImageImportanceSamplerType> m_importance_sampler;
+        EnvironmentImportanceMap m_importance_map;
 
-        void build_importance_map(const Scene& scene, IAbortSwitch*abort_switch)
+        void build_importance_map(
+            const Scene&            scene,
+            const size_t            thread_count,
+            IAbortSwitch*           abort_switch)
         {
             const Source* radiance_source = m_inputs.source("radiance");
             assert(radiance_source);
@@ -405,38 +346,16 @@ namespace
             const size_t texel_count = m_importance_map_width * m_importance_map_height;
             m_probability_scale = texel_count / (2.0f * PiSquare<float>());
 
-            TextureStore texture_store(scene);
-            TextureCache texture_cache(texture_store);
-            ImageSampler sampler(
-                texture_cache,
+            m_importance_map.update(
+                scene,
+                get_path().c_str(),
+                m_importance_map_width,
+                m_importance_map_height,
                 radiance_source,
                 m_inputs.source("radiance_multiplier"),
                 m_inputs.source("exposure"),
-                m_importance_map_width,
-                m_importance_map_height);
-
-            m_importance_sampler.reset(
-                new ImageImportanceSamplerType(
-                    m_importance_map_width,
-                    m_importance_map_height));
-
-            RENDERER_LOG_INFO(
-                "building " FMT_SIZE_T "x" FMT_SIZE_T " importance map "
-                "for environment edf \"%s\"...",
-                m_importance_map_width,
-                m_importance_map_height,
-                get_path().c_str());
-
-            m_importance_sampler->rebuild(sampler, abort_switch);
-
-            if (is_aborted(abort_switch))
-                m_importance_sampler.reset();
-            else
-            {
-                RENDERER_LOG_INFO(
-                    "built importance map for environment edf \"%s\".",
-                    get_path().c_str());
-            }
+                thread_count,
+                abort_switch);
         }
 
         void lookup_environment_map(
@@ -466,12 +385,12 @@ namespace
         {
             assert(u >= 0.0f && u < 1.0f);
             assert(v >= 0.0f && v < 1.0f);
-            assert(m_importance_sampler.get());
+            assert(m_importance_map.is_valid());
 
             // Compute the probability density of this sample in the importance map.
             const size_t x = truncate<size_t>(m_importance_map_width * u);
             const size_t y = truncate<size_t>(m_importance_map_height * v);
-            const float prob_xy = m_importance_sampler->get_pdf(x, y);
+            const float prob_xy = m_importance_map.get_sampler().get_pdf(x, y);
 
             // Compute the probability density of the emission direction.
             return prob_xy * m_probability_scale / sin(theta);
@@ -34,27 +34,39 @@
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/modeling/environment/environment.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
+#include "renderer/modeling/environmentedf/environmentimportancemap.h"
 #include "renderer/modeling/input/inputarray.h"
+#include "renderer/modeling/input/source.h"
+#include "renderer/modeling/input/texturesource.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/textureinstance.h"
+#include "renderer/modeling/texture/texture.h"
 #include "renderer/utility/transformsequence.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
 #include "foundation/math/matrix.h"
 #include "foundation/math/sampling/mappings.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/compiler.h"
+#include "foundation/utility/api/apistring.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstddef>
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
-namespace renderer      { class Project; }
 
 using namespace foundation;
 using namespace std;
@@ -67,6 +79,9 @@ namespace
     //
     // Mirror ball environment map EDF.
     //
+    // When the radiance input is bound to a texture, directions are importance
+    // sampled according to the luminance of the texels inside the mirror ball.
+    //
     // References:
     //
     //   http://www.debevec.org/probes/
@@ -83,6 +98,10 @@ namespace
             const char*             name,
             const ParamArray&       params)
           : EnvironmentEDF(name, params)
+          , m_importance_map(EnvironmentImportanceMap::MirrorBallMapping)
+          , m_importance_map_width(0)
+          , m_importance_map_height(0)
+          , m_probability_scale(0.0f)
         {
             m_inputs.declare("radiance", InputFormatSpectralIlluminance);
             m_inputs.declare("radiance_multiplier", InputFormatFloat, "1.0");
@@ -109,6 +128,14 @@ namespace
 
             check_non_zero_emission("radiance", "radiance_multiplier");
 
+            // Do not build an importance map if the environment EDF is not the active one.
+            const Environment* environment = project.get_scene()->get_environment();
+            if (environment->get_uncached_environment_edf() == this)
+                build_importance_map(
+                    *project.get_scene(),
+                    project.get_thread_count(),
+                    abort_switch);
+
             return true;
         }
 
@@ -119,14 +146,42 @@ namespace
             Spectrum&               value,
             float&                  probability) const override
         {
-            const Vector3f local_outgoing = sample_sphere_uniform(s);
-            probability = RcpFourPi<float>();
-
             Transformd scratch;
             const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
+
+            if (!m_importance_map.is_valid())
+            {
+                const Vector3f local_outgoing = sample_sphere_uniform(s);
+                probability = RcpFourPi<float>();
+
+                outgoing = transform.vector_to_parent(local_outgoing);
+
+                lookup_envmap(shading_context, local_outgoing, value);
+                return;
+            }
+
+            // Sample the importance map.
+            size_t x, y;
+            Color3f payload;
+            float prob_xy;
+            m_importance_map.get_sampler().sample(s, x, y, payload, prob_xy);
+
+            // Compute the texture coordinates of the center of the texel.
+            const Vector2f uv(
+                (x + 0.5f) * m_rcp_importance_map_width,
+                1.0f - (y + 0.5f) * m_rcp_importance_map_height);
+
+            // Compute the local space emission direction.
+            const Vector3f local_outgoing = uv_to_direction(uv);
+
+            // Transform the emission direction to world space.
             outgoing = transform.vector_to_parent(local_outgoing);
 
-            lookup_envmap(shading_context, local_outgoing, value);
+            // Return the emitted radiance.
+            value = payload;
+
+            // Compute the probability density of this direction.
+            probability = prob_xy * m_probability_scale * compute_area_to_solid_angle_ratio(uv);
         }
 
         virtual void evaluate(
@@ -156,14 +211,22 @@ namespace
             const Vector3f local_outgoing = transform.vector_to_local(outgoing);
 
             lookup_envmap(shading_context, local_outgoing, value);
-            probability = RcpFourPi<float>();
+            probability = compute_pdf(local_outgoing);
         }
 
         virtual float evaluate_pdf(
             const Vector3f&         outgoing) const override
         {
             assert(is_normalized(outgoing));
-            return RcpFourPi<float>();
+
+            if (!m_importance_map.is_valid())
+                return RcpFourPi<float>();
+
+            Transformd scratch;
+            const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
+            const Vector3f local_outgoing = transform.vector_to_local(outgoing);
+
+            return compute_pdf(local_outgoing);
         }
 
       private:
@@ -173,15 +236,120 @@ namespace
             float       m_radiance_multiplier;  // emitted radiance multiplier
         };
 
+        EnvironmentImportanceMap m_importance_map;
+
+        size_t  m_importance_map_width;
+        size_t  m_importance_map_height;
+
+        float   m_rcp_importance_map_width;
+        float   m_rcp_importance_map_height;
+        float   m_probability_scale;
+
+        void build_importance_map(
+            const Scene&            scene,
+            const size_t            thread_count,
+            IAbortSwitch*           abort_switch)
+        {
+            const Source* radiance_source = m_inputs.source("radiance");
+            assert(radiance_source);
+
+            // Fall back to uniform sampling if the radiance input is not textured.
+            if (!dynamic_cast<const TextureSource*>(radiance_source))
+            {
+                m_importance_map.clear();
+                return;
+            }
+
+            const TextureSource* texture_source = static_cast<const TextureSource*>(radiance_source);
+            const TextureInstance& texture_instance = texture_source->get_texture_instance();
+            const CanvasProperties& texture_props = texture_instance.get_texture().properties();
+
+            m_importance_map_width = texture_props.m_canvas_width;
+            m_importance_map_height = texture_props.m_canvas_height;
+
+            m_rcp_importance_map_width = 1.0f / m_importance_map_width;
+            m_rcp_importance_map_height = 1.0f / m_importance_map_height;
+
+            const size_t texel_count = m_importance_map_width * m_importance_map_height;
+            m_probability_scale = texel_count * RcpTwoPi<float>();
+
+            m_importance_map.update(
+                scene,
+                get_path().c_str(),
+                m_importance_map_width,
+                m_importance_map_height,
+                radiance_source,
+                m_inputs.source("radiance_multiplier"),
+                0,
+                thread_count,
+                abort_switch);
+        }
+
+        // Compute the texture coordinates corresponding to a given direction.
+        static Vector2f direction_to_uv(const Vector3f& direction)
+        {
+            const float d = sqrt(square(direction[0]) + square(direction[1]));
+
+            // The +Z direction maps to the center of the mirror ball, -Z maps to its rim.
+            if (d == 0.0f)
+                return direction[2] > 0.0f ? Vector2f(0.5f) : Vector2f(1.0f, 0.5f);
+
+            const float r = RcpTwoPi<float>() * acos(direction[2]) / d;
+            return Vector2f(0.5f + direction[0] * r, 0.5f + direction[1] * r);
+        }
+
+        // Compute the direction corresponding to given texture coordinates inside the mirror ball.
+        static Vector3f uv_to_direction(const Vector2f& uv)
+        {
+            const float dx = uv[0] - 0.5f;
+            const float dy = uv[1] - 0.5f;
+            const float rho = sqrt(square(dx) + square(dy));
+
+            if (rho == 0.0f)
+                return Vector3f(0.0f, 0.0f, 1.0f);
+
+            const float theta = TwoPi<float>() * rho;
+            const float k = sin(theta) / rho;
+            return Vector3f(dx * k, dy * k, cos(theta));
+        }
+
+        // Compute the ratio between the texture space area and the solid angle around a given
+        // point of the mirror ball, up to a factor of 2*Pi: the polar angle theta of the direction
+        // is 2*Pi*rho where rho is the distance to the center, hence dw = 2*Pi*sin(theta)/rho dA.
+        static float compute_area_to_solid_angle_ratio(const Vector2f& uv)
+        {
+            const float rho = sqrt(square(uv[0] - 0.5f) + square(uv[1] - 0.5f));
+
+            if (rho == 0.0f)
+                return RcpTwoPi<float>();
+
+            const float sin_theta = sin(TwoPi<float>() * rho);
+            return sin_theta > 0.0f ? rho / sin_theta : 0.0f;
+        }
+
+        float compute_pdf(const Vector3f& local_outgoing) const
+        {
+            if (!m_importance_map.is_valid())
+                return RcpFourPi<float>();
+
+            const Vector2f uv = direction_to_uv(local_outgoing);
+
+            // Compute the probability density of this sample in the importance map.
+            const size_t x = min(truncate<size_t>(m_importance_map_width * max(uv[0], 0.0f)), m_importance_map_width - 1);
+            const size_t y = min(truncate<size_t>(m_importance_map_height * max(1.0f - uv[1], 0.0f)), m_importance_map_height - 1);
+            const float prob_xy = m_importance_map.get_sampler().get_pdf(x, y);
+
+            // Compute the probability density of the emission direction.
+            return prob_xy * m_probability_scale * compute_area_to_solid_angle_ratio(uv);
+        }
+
         void lookup_envmap(
             const ShadingContext&   shading_context,
             const Vector3f&         direction,
             Spectrum&               value) const
         {
             // Compute the texture coordinates corresponding to this direction.
-            const float d = sqrt(square(direction[0]) + square(direction[1]));
-            const float r = RcpTwoPi<float>() * acos(direction[2]) / d;
-            const Vector2f uv(0.5f + direction[0] * r, 0.5f + direction[1] * r);
+            const Vector2f uv = direction_to_uv(direction);
 
             // Evaluate the input.
             InputValues values;
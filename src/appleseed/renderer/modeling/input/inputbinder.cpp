@@ -61,12 +61,15 @@
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/color.h"
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/siphash.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
+#include <cstring>
 #include <exception>
 
 using namespace foundation;
@@ -81,11 +84,152 @@ namespace renderer
 
 InputBinder::InputBinder()
   : m_error_count(0)
+  , m_scope_count(0)
+  , m_bound_scope_count(0)
 {
 }
 
+namespace
+{
+    uint64 compute_string_signature(const char* s)
+    {
+        return siphash24(s, strlen(s));
+    }
+
+    uint64 compute_name_signature(const Entity& entity)
+    {
+        return compute_string_signature(entity.get_name());
+    }
+
+    // Parameters edited in place through Entity::get_parameters() don't bump the
+    // version ID of their entity, so they are part of the entity's signature.
+    uint64 compute_parameters_signature(const Dictionary& params)
+    {
+        uint64 signature = 0;
+
+        for (const_each<StringDictionary> i = params.strings(); i; ++i)
+        {
+            signature = Entity::combine_signatures(signature, compute_string_signature(i->key()));
+            signature = Entity::combine_signatures(signature, compute_string_signature(i->value()));
+        }
+
+        for (const_each<DictionaryDictionary> i = params.dictionaries(); i; ++i)
+        {
+            signature = Entity::combine_signatures(signature, compute_string_signature(i->key()));
+            signature = Entity::combine_signatures(signature, compute_parameters_signature(i->value()));
+        }
+
+        return signature;
+    }
+
+    uint64 combine_entity_signature(
+        const uint64                signature,
+        const Entity&               entity)
+    {
+        uint64 result = Entity::combine_signatures(signature, entity.compute_signature());
+        result = Entity::combine_signatures(result, compute_name_signature(entity));
+        result = Entity::combine_signatures(result, compute_parameters_signature(entity.get_parameters()));
+        return result;
+    }
+
+    // Combine the signatures of a collection of entities: any entity added, removed,
+    // replaced, renamed, whose version ID was bumped or whose parameters were edited
+    // changes the result.
+    template <typename EntityContainer>
+    uint64 combine_entity_signatures(
+        uint64                      signature,
+        const EntityContainer&      entities)
+    {
+        for (const_each<EntityContainer> i = entities; i; ++i)
+            signature = combine_entity_signature(signature, *i);
+
+        return signature;
+    }
+
+    // Combine the names of a collection of entities. Used for entities that cannot be
+    // bound to inputs but whose names may still shadow the names of other entities.
+    template <typename EntityContainer>
+    uint64 combine_entity_names(
+        uint64                      signature,
+        const EntityContainer&      entities)
+    {
+        for (const_each<EntityContainer> i = entities; i; ++i)
+            signature = Entity::combine_signatures(signature, compute_name_signature(*i));
+
+        return signature;
+    }
+
+    // Signature of the scene scope, as seen by the entities of the scene.
+    uint64 compute_scene_signature(const Scene& scene)
+    {
+        uint64 signature = scene.compute_signature();
+        signature = combine_entity_signature(signature, *scene.get_default_surface_shader());
+        signature = combine_entity_signatures(signature, scene.cameras());
+        signature = combine_entity_signatures(signature, scene.colors());
+        signature = combine_entity_signatures(signature, scene.textures());
+        signature = combine_entity_signatures(signature, scene.texture_instances());
+        signature = combine_entity_signatures(signature, scene.environment_edfs());
+        signature = combine_entity_signatures(signature, scene.environment_shaders());
+        signature = combine_entity_signatures(signature, scene.shader_groups());
+        if (scene.get_environment())
+            signature = combine_entity_signature(signature, *scene.get_environment());
+        signature = combine_entity_signatures(signature, scene.assemblies());
+        signature = combine_entity_signatures(signature, scene.assembly_instances());
+        return signature;
+    }
+
+    // Signature of the scene scope, as seen by the entities of the assemblies.
+    // Cameras, the environment and scene-level assembly instances only matter
+    // through their names since assembly entities cannot be bound to them.
+    uint64 compute_visible_scene_signature(const Scene& scene)
+    {
+        uint64 signature = 0;
+        signature = combine_entity_names(signature, scene.cameras());
+        signature = combine_entity_signatures(signature, scene.colors());
+        signature = combine_entity_signatures(signature, scene.textures());
+        signature = combine_entity_signatures(signature, scene.texture_instances());
+        signature = combine_entity_signatures(signature, scene.environment_edfs());
+        signature = combine_entity_signatures(signature, scene.environment_shaders());
+        signature = combine_entity_signatures(signature, scene.shader_groups());
+        if (scene.get_environment())
+            signature = Entity::combine_signatures(signature, compute_name_signature(*scene.get_environment()));
+        signature = combine_entity_signatures(signature, scene.assemblies());
+        signature = combine_entity_names(signature, scene.assembly_instances());
+        return signature;
+    }
+
+    // Signature of the scope of an assembly, including the scopes of its parents.
+    uint64 compute_assembly_signature(
+        const uint64                parent_signature,
+        const Assembly&             assembly)
+    {
+        uint64 signature = combine_entity_signature(parent_signature, assembly);
+        signature = combine_entity_signatures(signature, assembly.colors());
+        signature = combine_entity_signatures(signature, assembly.textures());
+        signature = combine_entity_signatures(signature, assembly.texture_instances());
+        signature = combine_entity_signatures(signature, assembly.bsdfs());
+        signature = combine_entity_signatures(signature, assembly.bssrdfs());
+        signature = combine_entity_signatures(signature, assembly.edfs());
+        signature = combine_entity_signatures(signature, assembly.shader_groups());
+        signature = combine_entity_signatures(signature, assembly.surface_shaders());
+        signature = combine_entity_signatures(signature, assembly.materials());
+        signature = combine_entity_signatures(signature, assembly.lights());
+        signature = combine_entity_signatures(signature, assembly.objects());
+        signature = combine_entity_signatures(signature, assembly.object_instances());
+        signature = combine_entity_signatures(signature, assembly.phase_functions());
+        signature = combine_entity_signatures(signature, assembly.assemblies());
+        signature = combine_entity_signatures(signature, assembly.assembly_instances());
+        return signature;
+    }
+}
+
 void InputBinder::bind(const Scene& scene)
 {
+    m_error_count = 0;
+    m_scope_count = 0;
+    m_bound_scope_count = 0;
+    m_new_scope_signatures.clear();
+
     try
     {
         // Build the symbol table of the scene.
@@ -93,13 +237,22 @@ void InputBinder::bind(const Scene& scene)
         build_scene_symbol_table(scene, scene_symbols);
 
         // Bind all inputs of all entities in the scene.
-        bind_scene_entities_inputs(scene, scene_symbols);
+        const uint64 scene_signature = compute_scene_signature(scene);
+        ++m_scope_count;
+        if (!is_scope_up_to_date(scene.get_uid(), scene_signature))
+        {
+            bind_scene_entities_inputs(scene, scene_symbols);
+            ++m_bound_scope_count;
+        }
+        if (m_error_count == 0)
+            m_new_scope_signatures[scene.get_uid()] = scene_signature;
 
         // Bind all inputs of all entities in all assemblies.
+        const uint64 visible_scene_signature = compute_visible_scene_signature(scene);
         for (const_each<AssemblyContainer> i = scene.assemblies(); i; ++i)
         {
             assert(m_assembly_info.empty());
-            bind_assembly_entities_inputs(scene, scene_symbols, *i);
+            bind_assembly_scope(scene, scene_symbols, visible_scene_signature, *i);
         }
     }
     catch (const ExceptionUnknownEntity& e)
@@ -109,7 +262,18 @@ void InputBinder::bind(const Scene& scene)
             e.get_context_path().c_str(),
             e.string());
         ++m_error_count;
+        m_assembly_info.clear();
     }
+
+    // Only remember the scopes that were bound without errors.
+    m_scope_signatures.swap(m_new_scope_signatures);
+    m_new_scope_signatures.clear();
+
+    RENDERER_LOG_DEBUG(
+        "bound inputs of %s out of %s binding %s.",
+        pretty_uint(m_bound_scope_count).c_str(),
+        pretty_uint(m_scope_count).c_str(),
+        plural(m_scope_count, "scope").c_str());
 }
 
 size_t InputBinder::get_error_count() const
@@ -117,6 +281,14 @@ size_t InputBinder::get_error_count() const
     return m_error_count;
 }
 
+bool InputBinder::is_scope_up_to_date(
+    const UniqueID                  scope_uid,
+    const uint64                    signature) const
+{
+    const ScopeSignatureMap::const_iterator i = m_scope_signatures.find(scope_uid);
+    return i != m_scope_signatures.end() && i->second == signature;
+}
+
 namespace
 {
     template <typename EntityContainer>
@@ -315,12 +487,15 @@ void InputBinder::bind_scene_entity_inputs(
     }
 }
 
-void InputBinder::bind_assembly_entities_inputs(
+void InputBinder::bind_assembly_scope(
     const Scene&                    scene,
     const SymbolTable&              scene_symbols,
+    const uint64                    parent_signature,
     const Assembly&                 assembly)
 {
     // Build the symbol table of the assembly.
+    // It is needed by child assemblies even if this assembly is up-to-date.
+    const size_t error_count = m_error_count;
     SymbolTable assembly_symbols;
     build_assembly_symbol_table(assembly, assembly_symbols);
 
@@ -330,6 +505,30 @@ void InputBinder::bind_assembly_entities_inputs(
     info.m_assembly_symbols = &assembly_symbols;
     m_assembly_info.push_back(info);
 
+    // Bind the inputs of the entities of this assembly unless they are up-to-date.
+    const uint64 signature = compute_assembly_signature(parent_signature, assembly);
+    ++m_scope_count;
+    if (!is_scope_up_to_date(assembly.get_uid(), signature))
+    {
+        bind_assembly_entities_inputs(scene, scene_symbols, assembly);
+        ++m_bound_scope_count;
+    }
+    if (m_error_count == error_count)
+        m_new_scope_signatures[assembly.get_uid()] = signature;
+
+    // Recurse into child assemblies.
+    for (const_each<AssemblyContainer> i = assembly.assemblies(); i; ++i)
+        bind_assembly_scope(scene, scene_symbols, signature, *i);
+
+    // Pop the information about this assembly from the stack.
+    m_assembly_info.pop_back();
+}
+
+void InputBinder::bind_assembly_entities_inputs(
+    const Scene&                    scene,
+    const SymbolTable&              scene_symbols,
+    const Assembly&                 assembly)
+{
     // Bind textures to texture instances.
     // Other entities might need to access the textures bound to texture instances,
     // so binding of textures to texture instances must come first.
@@ -469,13 +668,6 @@ void InputBinder::bind_assembly_entities_inputs(
 
         i->check_assembly();
     }
-
-    // Recurse into child assemblies.
-    for (const_each<AssemblyContainer> i = assembly.assemblies(); i; ++i)
-        bind_assembly_entities_inputs(scene, scene_symbols, *i);
-
-    // Pop the information about this assembly from the stack.
-    m_assembly_info.pop_back();
 }
 
 void InputBinder::bind_assembly_entity_inputs(
@@ -728,10 +920,23 @@ void InputBinder::bind_texture_instance_to_input(
 
     try
     {
-        input.bind(
-            new TextureSource(
-                assembly_uid,
-                *texture_instance));
+        // Textures whose texels all have the same value don't need to be sampled.
+        Color4f constant_color;
+        if (texture_instance->get_texture().is_constant(constant_color))
+        {
+            input.bind(
+                new TextureSource(
+                    assembly_uid,
+                    *texture_instance,
+                    constant_color));
+        }
+        else
+        {
+            input.bind(
+                new TextureSource(
+                    assembly_uid,
+                    *texture_instance));
+        }
     }
     catch (const exception& e)
     {
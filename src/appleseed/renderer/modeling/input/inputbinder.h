@@ -39,11 +39,13 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/uid.h"
 
 // Standard headers.
 #include <cassert>
 #include <cstddef>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -67,9 +69,14 @@ class InputBinder
     InputBinder();
 
     // Bind all inputs of all entities in a scene.
+    // The binder remembers the signatures of the binding scopes (the scene and
+    // each assembly) that were successfully bound. On subsequent calls, scopes
+    // in which no entity was added, removed, replaced, had its version ID
+    // bumped or its parameters edited, and whose parent scopes are unchanged,
+    // are not bound again.
     void bind(const Scene& scene);
 
-    // Return the number of reported binding errors.
+    // Return the number of binding errors reported by the last call to bind().
     size_t get_error_count() const;
 
     // Find an entity with a given name using the input binding logic.
@@ -87,9 +94,19 @@ class InputBinder
 
     typedef std::vector<AssemblyInfo> AssemblyInfoVector;
     typedef AssemblyInfoVector::const_reverse_iterator AssemblyInfoIt;
+    typedef std::map<foundation::UniqueID, foundation::uint64> ScopeSignatureMap;
 
     size_t                  m_error_count;
     AssemblyInfoVector      m_assembly_info;
+    ScopeSignatureMap       m_scope_signatures;         // signatures of the scopes bound by the last call to bind()
+    ScopeSignatureMap       m_new_scope_signatures;
+    size_t                  m_scope_count;
+    size_t                  m_bound_scope_count;
+
+    // Return true if a given scope was bound with a given signature by the last call to bind().
+    bool is_scope_up_to_date(
+        const foundation::UniqueID      scope_uid,
+        const foundation::uint64        signature) const;
 
     // Build the symbol table for a given scene.
     void build_scene_symbol_table(
@@ -113,6 +130,14 @@ class InputBinder
         const char*                     entity_type,
         ConnectableEntity&              entity);
 
+    // Bind all inputs of all entities of a given assembly and of its child assemblies.
+    // Assemblies whose scope is up-to-date are skipped.
+    void bind_assembly_scope(
+        const Scene&                    scene,
+        const SymbolTable&              scene_symbols,
+        const foundation::uint64        parent_signature,
+        const Assembly&                 assembly);
+
     // Bind all inputs of all entities of a given assembly.
     void bind_assembly_entities_inputs(
         const Scene&                    scene,
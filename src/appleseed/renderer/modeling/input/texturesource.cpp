@@ -36,6 +36,7 @@
 #include "renderer/modeling/texture/texture.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/colorspace.h"
 #include "foundation/image/tile.h"
 #include "foundation/math/hash.h"
 #include "foundation/math/scalar.h"
@@ -182,9 +183,44 @@ TextureSource::TextureSource(
   , m_scalar_canvas_height(static_cast<float>(m_texture_props.m_canvas_height))
   , m_max_x(static_cast<float>(m_texture_props.m_canvas_width - 1))
   , m_max_y(static_cast<float>(m_texture_props.m_canvas_height - 1))
+  , m_uniform_color(0.0f)
 {
 }
 
+TextureSource::TextureSource(
+    const UniqueID              assembly_uid,
+    const TextureInstance&      texture_instance,
+    const Color4f&              constant_color)
+  : Source(true)
+  , m_assembly_uid(assembly_uid)
+  , m_texture_instance(texture_instance)
+  , m_texture_uid(texture_instance.get_texture().get_uid())
+  , m_texture_props(texture_instance.get_texture().properties())
+  , m_texture_transform(texture_instance.get_transform())
+  , m_scalar_canvas_width(static_cast<float>(m_texture_props.m_canvas_width))
+  , m_scalar_canvas_height(static_cast<float>(m_texture_props.m_canvas_height))
+  , m_max_x(static_cast<float>(m_texture_props.m_canvas_width - 1))
+  , m_max_y(static_cast<float>(m_texture_props.m_canvas_height - 1))
+  , m_uniform_color(constant_color)
+{
+    // Convert the color to the linear RGB color space, as texture tiles are.
+    switch (texture_instance.get_texture().get_color_space())
+    {
+      case ColorSpaceLinearRGB:
+        break;
+
+      case ColorSpaceSRGB:
+        m_uniform_color.rgb() = srgb_to_linear_rgb(m_uniform_color.rgb());
+        break;
+
+      case ColorSpaceCIEXYZ:
+        m_uniform_color.rgb() = ciexyz_to_linear_rgb(m_uniform_color.rgb());
+        break;
+
+      assert_otherwise;
+    }
+}
+
 uint64 TextureSource::compute_signature() const
 {
     return m_texture_instance.compute_signature();
@@ -66,6 +66,15 @@ class TextureSource
         const foundation::UniqueID          assembly_uid,
         const TextureInstance&              texture_instance);
 
+    // Constructor for a texture instance whose texels all have the same value.
+    // The resulting source is uniform, but it still samples the texture when
+    // evaluated at a given shading point. constant_color is expressed in the
+    // color space of the texture.
+    TextureSource(
+        const foundation::UniqueID          assembly_uid,
+        const TextureInstance&              texture_instance,
+        const foundation::Color4f&          constant_color);
+
     // Retrieve the texture instance used by this source.
     const TextureInstance& get_texture_instance() const;
 
@@ -100,6 +109,22 @@ class TextureSource
         Spectrum&                           spectrum,
         Alpha&                              alpha) const override;
 
+    // Evaluate the source as a uniform source.
+    virtual void evaluate_uniform(
+        float&                              scalar) const override;
+    virtual void evaluate_uniform(
+        foundation::Color3f&                linear_rgb) const override;
+    virtual void evaluate_uniform(
+        Spectrum&                           spectrum) const override;
+    virtual void evaluate_uniform(
+        Alpha&                              alpha) const override;
+    virtual void evaluate_uniform(
+        foundation::Color3f&                linear_rgb,
+        Alpha&                              alpha) const override;
+    virtual void evaluate_uniform(
+        Spectrum&                           spectrum,
+        Alpha&                              alpha) const override;
+
   private:
     const foundation::UniqueID              m_assembly_uid;
     const TextureInstance&                  m_texture_instance;
@@ -110,6 +135,7 @@ class TextureSource
     const float                             m_scalar_canvas_height;
     const float                             m_max_x;
     const float                             m_max_y;
+    foundation::Color4f                     m_uniform_color;
 
     // Apply the texture instance transform to UV coordinates.
     foundation::Vector2f apply_transform(
@@ -210,6 +236,46 @@ inline void TextureSource::evaluate(
     evaluate_alpha(color, alpha);
 }
 
+inline void TextureSource::evaluate_uniform(
+    float&                                  scalar) const
+{
+    scalar = m_uniform_color[0];
+}
+
+inline void TextureSource::evaluate_uniform(
+    foundation::Color3f&                    linear_rgb) const
+{
+    linear_rgb = m_uniform_color.rgb();
+}
+
+inline void TextureSource::evaluate_uniform(
+    Spectrum&                               spectrum) const
+{
+    spectrum = m_uniform_color.rgb();
+}
+
+inline void TextureSource::evaluate_uniform(
+    Alpha&                                  alpha) const
+{
+    evaluate_alpha(m_uniform_color, alpha);
+}
+
+inline void TextureSource::evaluate_uniform(
+    foundation::Color3f&                    linear_rgb,
+    Alpha&                                  alpha) const
+{
+    linear_rgb = m_uniform_color.rgb();
+    evaluate_alpha(m_uniform_color, alpha);
+}
+
+inline void TextureSource::evaluate_uniform(
+    Spectrum&                               spectrum,
+    Alpha&                                  alpha) const
+{
+    spectrum = m_uniform_color.rgb();
+    evaluate_alpha(m_uniform_color, alpha);
+}
+
 inline void TextureSource::evaluate_alpha(
     const foundation::Color4f&              color,
     Alpha&                                  alpha) const
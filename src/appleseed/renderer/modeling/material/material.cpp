@@ -190,8 +190,21 @@ bool Material::on_frame_begin(
     m_render_data.m_shader_group = 0;
     m_render_data.m_basis_modifier = 0;
     m_render_data.m_phase_function = 0;
+    m_render_data.m_has_constant_alpha = true;
+    m_render_data.m_constant_alpha = 1.0f;
     m_has_render_data = true;
 
+    if (m_render_data.m_alpha_map)
+    {
+        if (m_render_data.m_alpha_map->is_uniform())
+        {
+            Alpha alpha;
+            m_render_data.m_alpha_map->evaluate_uniform(alpha);
+            m_render_data.m_constant_alpha = alpha[0];
+        }
+        else m_render_data.m_has_constant_alpha = false;
+    }
+
     return true;
 }
 
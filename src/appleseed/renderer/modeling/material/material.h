@@ -148,6 +148,8 @@ class APPLESEED_DLLSYMBOL Material
         const Source*               m_alpha_map;
         const ShaderGroup*          m_shader_group;
         const IBasisModifier*       m_basis_modifier;   // owned by RenderData
+        bool                        m_has_constant_alpha;   // true if the alpha of this material is the same everywhere
+        float                       m_constant_alpha;       // only valid if m_has_constant_alpha is true
     };
 
     // Return render-time data of this entity.
@@ -125,6 +125,10 @@ namespace
 
                 if (m_render_data.m_shader_group->has_emission())
                     m_render_data.m_edf = m_osl_edf.get();
+
+                // Transparency closures may make alpha vary over the surface.
+                if (m_render_data.m_shader_group->has_transparency())
+                    m_render_data.m_has_constant_alpha = false;
             }
 
             return true;
@@ -30,17 +30,34 @@
 #include "meshobjectoperations.h"
 
 // appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
 #include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectreader.h"
+#include "renderer/modeling/object/object.h"
 #include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/containers.h"
 #include "renderer/utility/triangle.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/system.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/api/apistring.h"
+#include "foundation/utility/foreach.h"
+
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
+#include <cstring>
 #include <vector>
 
 using namespace foundation;
@@ -49,178 +66,642 @@ using namespace std;
 namespace renderer
 {
 
-void compute_smooth_vertex_normals_base_pose(MeshObject& object)
+namespace
 {
-    assert(object.get_vertex_normal_count() == 0);
-
-    const size_t vertex_count = object.get_vertex_count();
-    const size_t triangle_count = object.get_triangle_count();
+    // Below this number of vertices per thread, spawning threads costs more than it saves.
+    const size_t MinVerticesPerThread = 32 * 1024;
 
-    vector<GVector3> normals(vertex_count, GVector3(0.0));
-
-    for (size_t i = 0; i < triangle_count; ++i)
+    size_t get_thread_count(const size_t thread_count, const size_t item_count, const size_t min_items_per_thread)
     {
-        Triangle& triangle = object.get_triangle(i);
-        triangle.m_n0 = triangle.m_v0;
-        triangle.m_n1 = triangle.m_v1;
-        triangle.m_n2 = triangle.m_v2;
+        if (thread_count > 0)
+            return max<size_t>(min(thread_count, item_count), 1);
 
-        const GVector3& v0 = object.get_vertex(triangle.m_v0);
-        const GVector3& v1 = object.get_vertex(triangle.m_v1);
-        const GVector3& v2 = object.get_vertex(triangle.m_v2);
-        const GVector3 normal = normalize(compute_triangle_normal(v0, v1, v2));
+        return
+            max<size_t>(
+                min(item_count / min_items_per_thread, System::get_logical_cpu_core_count()),
+                1);
+    }
 
-        normals[triangle.m_v0] += normal;
-        normals[triangle.m_v1] += normal;
-        normals[triangle.m_v2] += normal;
+    //
+    // The corners of the triangles incident to each vertex, in compressed sparse row format.
+    //
+    // The corners of vertex v are m_corners[m_offsets[v]] to m_corners[m_offsets[v + 1] - 1].
+    // A corner is encoded as 3 * triangle index + index of the vertex in the triangle.
+    // Listing corners rather than triangles preserves the contributions of degenerate
+    // triangles referencing the same vertex several times.
+    //
+
+    // Return whether all the corners of a mesh object can be encoded on 32 bits.
+    bool can_encode_corners(const MeshObject& object)
+    {
+        return 3 * static_cast<uint64>(object.get_triangle_count()) <= ~uint32(0);
     }
 
-    object.reserve_vertex_normals(vertex_count);
+    struct VertexCorners
+    {
+        vector<uint32>  m_offsets;
+        vector<uint32>  m_corners;
+
+        explicit VertexCorners(const MeshObject& object)
+        {
+            const size_t vertex_count = object.get_vertex_count();
+            const size_t triangle_count = object.get_triangle_count();
+            assert(can_encode_corners(object));
+
+            // Count the corners of each vertex.
+            m_offsets.assign(vertex_count + 1, 0);
+
+            for (size_t i = 0; i < triangle_count; ++i)
+            {
+                const Triangle& triangle = object.get_triangle(i);
+                ++m_offsets[triangle.m_v0 + 1];
+                ++m_offsets[triangle.m_v1 + 1];
+                ++m_offsets[triangle.m_v2 + 1];
+            }
+
+            for (size_t i = 0; i < vertex_count; ++i)
+                m_offsets[i + 1] += m_offsets[i];
+
+            // Distribute the corners to their vertices.
+            m_corners.resize(3 * triangle_count);
+
+            vector<uint32> next(m_offsets.begin(), m_offsets.end() - 1);
+
+            for (size_t i = 0; i < triangle_count; ++i)
+            {
+                const Triangle& triangle = object.get_triangle(i);
+                const uint32 corner = static_cast<uint32>(3 * i);
+                m_corners[next[triangle.m_v0]++] = corner;
+                m_corners[next[triangle.m_v1]++] = corner + 1;
+                m_corners[next[triangle.m_v2]++] = corner + 2;
+            }
+        }
+    };
+
+    // Return the angle of the triangle (p0, p1, p2) at p0.
+    GScalar compute_corner_angle(
+        const GVector3&     p0,
+        const GVector3&     p1,
+        const GVector3&     p2)
+    {
+        const GVector3 e1 = p1 - p0;
+        const GVector3 e2 = p2 - p0;
 
-    for (size_t i = 0; i < vertex_count; ++i)
-        object.push_vertex_normal(safe_normalize(normals[i]));
-}
+        // Unlike acos(), atan2() needs no normalization and is accurate for all angles.
+        return atan2(norm(cross(e1, e2)), dot(e1, e2));
+    }
 
-void compute_smooth_vertex_normals_pose(MeshObject& object, const size_t motion_segment_index)
-{
-    const size_t vertex_count = object.get_vertex_count();
-    const size_t triangle_count = object.get_triangle_count();
+    // Weight the unit-length direction of a triangle for one of its corners.
+    GVector3 weight_direction(
+        const GVector3&         direction,
+        const VertexWeighting   weighting,
+        const GVector3          (&p)[3],
+        const size_t            corner)
+    {
+        switch (weighting)
+        {
+          case VertexWeightingArea:
+            return direction * norm(compute_triangle_normal(p[0], p[1], p[2]));
+
+          case VertexWeightingAngle:
+            return
+                direction *
+                compute_corner_angle(
+                    p[corner],
+                    p[corner == 2 ? 0 : corner + 1],
+                    p[corner == 0 ? 2 : corner - 1]);
+
+          default:
+            return direction;
+        }
+    }
 
-    vector<GVector3> normals(vertex_count, GVector3(0.0));
+    // Retrieve the vertices of a triangle, either in the base pose or in a given pose.
+    struct VertexFetcher
+    {
+        static const size_t BasePose = ~size_t(0);
+
+        const MeshObject&   m_object;
+        const size_t        m_pose;
+
+        VertexFetcher(const MeshObject& object, const size_t pose)
+          : m_object(object)
+          , m_pose(pose)
+        {
+        }
+
+        void fetch(const Triangle& triangle, GVector3 (&p)[3]) const
+        {
+            if (m_pose == BasePose)
+            {
+                p[0] = m_object.get_vertex(triangle.m_v0);
+                p[1] = m_object.get_vertex(triangle.m_v1);
+                p[2] = m_object.get_vertex(triangle.m_v2);
+            }
+            else
+            {
+                p[0] = m_object.get_vertex_pose(triangle.m_v0, m_pose);
+                p[1] = m_object.get_vertex_pose(triangle.m_v1, m_pose);
+                p[2] = m_object.get_vertex_pose(triangle.m_v2, m_pose);
+            }
+        }
+    };
+
+    // Contribution of a triangle corner to the normal of its vertex.
+    struct NormalContribution
+    {
+        VertexFetcher       m_fetcher;
+
+        NormalContribution(const MeshObject& object, const size_t pose)
+          : m_fetcher(object, pose)
+        {
+        }
+
+        // Return false if the triangle doesn't contribute.
+        bool operator()(
+            const size_t            triangle_index,
+            const size_t            corner,
+            const VertexWeighting   weighting,
+            GVector3&               contribution) const
+        {
+            const Triangle& triangle = m_fetcher.m_object.get_triangle(triangle_index);
+
+            GVector3 p[3];
+            m_fetcher.fetch(triangle, p);
+
+            const GVector3 normal = compute_triangle_normal(p[0], p[1], p[2]);
+            const GScalar normal_norm = norm(normal);
+
+            if (normal_norm == GScalar(0.0))
+                return false;
+
+            contribution = weight_direction(normal / normal_norm, weighting, p, corner);
+            return true;
+        }
+    };
+
+    // Contribution of a triangle corner to the tangent of its vertex.
+    struct TangentContribution
+    {
+        VertexFetcher       m_fetcher;
+
+        TangentContribution(const MeshObject& object, const size_t pose)
+          : m_fetcher(object, pose)
+        {
+            assert(object.get_tex_coords_count() > 0);
+        }
+
+        // Return false if the triangle doesn't contribute.
+        bool operator()(
+            const size_t            triangle_index,
+            const size_t            corner,
+            const VertexWeighting   weighting,
+            GVector3&               contribution) const
+        {
+            const MeshObject& object = m_fetcher.m_object;
+            const Triangle& triangle = object.get_triangle(triangle_index);
+
+            if (!triangle.has_vertex_attributes())
+                return false;
+
+            const GVector2 v0_uv = object.get_tex_coords(triangle.m_a0);
+            const GVector2 v1_uv = object.get_tex_coords(triangle.m_a1);
+            const GVector2 v2_uv = object.get_tex_coords(triangle.m_a2);
+
+            //
+            // Reference:
+            //
+            //   Physically Based Rendering, first edition, pp. 128-129
+            //
+
+            const GScalar du0 = v0_uv[0] - v2_uv[0];
+            const GScalar dv0 = v0_uv[1] - v2_uv[1];
+            const GScalar du1 = v1_uv[0] - v2_uv[0];
+            const GScalar dv1 = v1_uv[1] - v2_uv[1];
+            const GScalar det = du0 * dv1 - dv0 * du1;
+
+            if (det == GScalar(0.0))
+                return false;
+
+            GVector3 p[3];
+            m_fetcher.fetch(triangle, p);
+
+            const GVector3 dp0 = p[0] - p[2];
+            const GVector3 dp1 = p[1] - p[2];
+            const GVector3 tangent = dv1 * dp0 - dv0 * dp1;
+            const GScalar tangent_norm = norm(tangent);
+
+            if (tangent_norm == GScalar(0.0))
+                return false;
+
+            contribution = weight_direction(tangent / tangent_norm, weighting, p, corner);
+            return true;
+        }
+    };
+
+    // Compute the smooth vectors of the vertices in [begin, end).
+    template <typename Contribution>
+    class AccumulateVectors
+    {
+      public:
+        AccumulateVectors(
+            const VertexCorners&    corners,
+            const Contribution&     contribution,
+            const VertexWeighting   weighting,
+            const size_t            begin,
+            const size_t            end,
+            GVector3*               vectors)
+          : m_corners(corners)
+          , m_contribution(contribution)
+          , m_weighting(weighting)
+          , m_begin(begin)
+          , m_end(end)
+          , m_vectors(vectors)
+        {
+        }
+
+        void operator()() const
+        {
+            for (size_t i = m_begin; i < m_end; ++i)
+            {
+                GVector3 sum(0.0);
+
+                const uint32 corner_end = m_corners.m_offsets[i + 1];
+                for (uint32 c = m_corners.m_offsets[i]; c < corner_end; ++c)
+                {
+                    const uint32 corner = m_corners.m_corners[c];
+
+                    GVector3 contribution;
+                    if (m_contribution(corner / 3, corner % 3, m_weighting, contribution))
+                        sum += contribution;
+                }
+
+                m_vectors[i] = safe_normalize(sum);
+            }
+        }
+
+      private:
+        const VertexCorners&    m_corners;
+        const Contribution&     m_contribution;
+        const VertexWeighting   m_weighting;
+        const size_t            m_begin;
+        const size_t            m_end;
+        GVector3*               m_vectors;
+    };
+
+    // Compute the smooth vectors of all vertices, splitting vertices among threads.
+    template <typename Contribution>
+    void compute_smooth_vectors(
+        const VertexCorners&    corners,
+        const Contribution&     contribution,
+        const VertexWeighting   weighting,
+        const size_t            thread_count,
+        vector<GVector3>&       vectors)
+    {
+        const size_t vertex_count = corners.m_offsets.size() - 1;
+        vectors.resize(vertex_count);
+
+        if (vertex_count == 0)
+            return;
+
+        if (thread_count <= 1)
+        {
+            AccumulateVectors<Contribution>(corners, contribution, weighting, 0, vertex_count, &vectors[0])();
+            return;
+        }
+
+        boost::thread_group threads;
+
+        for (size_t i = 1; i < thread_count; ++i)
+        {
+            threads.create_thread(
+                AccumulateVectors<Contribution>(
+                    corners,
+                    contribution,
+                    weighting,
+                    (i * vertex_count) / thread_count,
+                    ((i + 1) * vertex_count) / thread_count,
+                    &vectors[0]));
+        }
+
+        // The calling thread processes the first range.
+        AccumulateVectors<Contribution>(
+            corners,
+            contribution,
+            weighting,
+            0,
+            vertex_count / thread_count,
+            &vectors[0])();
+
+        threads.join_all();
+    }
 
-    for (size_t i = 0; i < triangle_count; ++i)
+    void compute_smooth_vertex_normals(
+        MeshObject&             object,
+        const VertexCorners&    corners,
+        const VertexWeighting   weighting,
+        const size_t            thread_count)
     {
-        const Triangle& triangle = object.get_triangle(i);
+        assert(object.get_vertex_normal_count() == 0);
+
+        const size_t vertex_count = object.get_vertex_count();
+        const size_t triangle_count = object.get_triangle_count();
+
+        for (size_t i = 0; i < triangle_count; ++i)
+        {
+            Triangle& triangle = object.get_triangle(i);
+            triangle.m_n0 = triangle.m_v0;
+            triangle.m_n1 = triangle.m_v1;
+            triangle.m_n2 = triangle.m_v2;
+        }
+
+        vector<GVector3> normals;
+
+        compute_smooth_vectors(
+            corners,
+            NormalContribution(object, VertexFetcher::BasePose),
+            weighting,
+            thread_count,
+            normals);
+
+        object.reserve_vertex_normals(vertex_count);
+
+        for (size_t i = 0; i < vertex_count; ++i)
+            object.push_vertex_normal(normals[i]);
+
+        for (size_t m = 0; m < object.get_motion_segment_count(); ++m)
+        {
+            compute_smooth_vectors(
+                corners,
+                NormalContribution(object, m),
+                weighting,
+                thread_count,
+                normals);
+
+            for (size_t i = 0; i < vertex_count; ++i)
+                object.set_vertex_normal_pose(i, m, normals[i]);
+        }
+    }
 
-        const GVector3& v0 = object.get_vertex_pose(triangle.m_v0, motion_segment_index);
-        const GVector3& v1 = object.get_vertex_pose(triangle.m_v1, motion_segment_index);
-        const GVector3& v2 = object.get_vertex_pose(triangle.m_v2, motion_segment_index);
-        const GVector3 normal = normalize(compute_triangle_normal(v0, v1, v2));
+    void compute_smooth_vertex_tangents(
+        MeshObject&             object,
+        const VertexCorners&    corners,
+        const VertexWeighting   weighting,
+        const size_t            thread_count)
+    {
+        assert(object.get_vertex_tangent_count() == 0);
+        assert(object.get_tex_coords_count() > 0);
 
-        normals[triangle.m_v0] += normal;
-        normals[triangle.m_v1] += normal;
-        normals[triangle.m_v2] += normal;
-    }
+        const size_t vertex_count = object.get_vertex_count();
 
-    for (size_t i = 0; i < vertex_count; ++i)
-        object.set_vertex_normal_pose(i, motion_segment_index, safe_normalize(normals[i]));
-}
+        vector<GVector3> tangents;
 
-void compute_smooth_vertex_normals(MeshObject& object)
-{
-    compute_smooth_vertex_normals_base_pose(object);
+        compute_smooth_vectors(
+            corners,
+            TangentContribution(object, VertexFetcher::BasePose),
+            weighting,
+            thread_count,
+            tangents);
 
-    for (size_t i = 0; i < object.get_motion_segment_count(); ++i)
-        compute_smooth_vertex_normals_pose(object, i);
-}
+        object.reserve_vertex_tangents(vertex_count);
 
-void compute_smooth_vertex_tangents_base_pose(MeshObject& object)
-{
-    assert(object.get_vertex_tangent_count() == 0);
-    assert(object.get_tex_coords_count() > 0);
+        for (size_t i = 0; i < vertex_count; ++i)
+            object.push_vertex_tangent(tangents[i]);
 
-    const size_t vertex_count = object.get_vertex_count();
-    const size_t triangle_count = object.get_triangle_count();
+        for (size_t m = 0; m < object.get_motion_segment_count(); ++m)
+        {
+            compute_smooth_vectors(
+                corners,
+                TangentContribution(object, m),
+                weighting,
+                thread_count,
+                tangents);
 
-    vector<GVector3> tangents(vertex_count, GVector3(0.0));
+            for (size_t i = 0; i < vertex_count; ++i)
+                object.set_vertex_tangent_pose(i, m, tangents[i]);
+        }
+    }
 
-    for (size_t i = 0; i < triangle_count; ++i)
+    // Process several mesh objects, one mesh object per thread at a time.
+    template <typename Function>
+    class ProcessMeshObjects
     {
-        const Triangle& triangle = object.get_triangle(i);
-
-        if (!triangle.has_vertex_attributes())
-            continue;
+      public:
+        ProcessMeshObjects(
+            const vector<MeshObject*>&  objects,
+            boost::atomic<size_t>&      next_object,
+            const VertexWeighting       weighting)
+          : m_objects(objects)
+          , m_next_object(next_object)
+          , m_weighting(weighting)
+        {
+        }
+
+        void operator()() const
+        {
+            while (true)
+            {
+                const size_t i = m_next_object++;
+                if (i >= m_objects.size())
+                    break;
+
+                MeshObject& object = *m_objects[i];
+                Function()(object, VertexCorners(object), m_weighting, 1);
+            }
+        }
+
+      private:
+        const vector<MeshObject*>&  m_objects;
+        boost::atomic<size_t>&      m_next_object;
+        const VertexWeighting       m_weighting;
+    };
+
+    struct ComputeNormals
+    {
+        void operator()(MeshObject& object, const VertexCorners& corners, const VertexWeighting weighting, const size_t thread_count) const
+        {
+            compute_smooth_vertex_normals(object, corners, weighting, thread_count);
+        }
+    };
 
-        const GVector2 v0_uv = object.get_tex_coords(triangle.m_a0);
-        const GVector2 v1_uv = object.get_tex_coords(triangle.m_a1);
-        const GVector2 v2_uv = object.get_tex_coords(triangle.m_a2);
+    struct ComputeTangents
+    {
+        void operator()(MeshObject& object, const VertexCorners& corners, const VertexWeighting weighting, const size_t thread_count) const
+        {
+            compute_smooth_vertex_tangents(object, corners, weighting, thread_count);
+        }
+    };
+
+    template <typename Function>
+    void process_mesh_objects(
+        const vector<MeshObject*>&  candidate_objects,
+        const VertexWeighting       weighting,
+        const size_t                thread_count)
+    {
+        vector<MeshObject*> objects;
+        objects.reserve(candidate_objects.size());
+
+        for (const_each<vector<MeshObject*>> i = candidate_objects; i; ++i)
+        {
+            if (can_encode_corners(**i))
+                objects.push_back(*i);
+            else
+            {
+                RENDERER_LOG_ERROR(
+                    "cannot compute smooth vectors for mesh object \"%s\" because it has too many triangles (" FMT_SIZE_T ").",
+                    (*i)->get_path().c_str(),
+                    (*i)->get_triangle_count());
+            }
+        }
+
+        if (objects.empty())
+            return;
+
+        // A single mesh object is better served by splitting its vertices among threads.
+        if (objects.size() == 1)
+        {
+            MeshObject& object = *objects[0];
+            Function()(
+                object,
+                VertexCorners(object),
+                weighting,
+                get_thread_count(thread_count, object.get_vertex_count(), MinVerticesPerThread));
+            return;
+        }
+
+        size_t total_vertex_count = 0;
+        for (const_each<vector<MeshObject*>> i = objects; i; ++i)
+            total_vertex_count += (*i)->get_vertex_count();
+
+        const size_t actual_thread_count =
+            min(
+                get_thread_count(thread_count, total_vertex_count, MinVerticesPerThread),
+                objects.size());
+
+        boost::atomic<size_t> next_object(0);
+        const ProcessMeshObjects<Function> process(objects, next_object, weighting);
+
+        boost::thread_group threads;
+
+        for (size_t i = 1; i < actual_thread_count; ++i)
+            threads.create_thread(process);
+
+        process();
+
+        threads.join_all();
+    }
 
-        //
-        // Reference:
-        //
-        //   Physically Based Rendering, first edition, pp. 128-129
-        //
+    struct HasVertexNormals
+    {
+        bool operator()(const MeshObject* object) const
+        {
+            return object->get_vertex_normal_count() > 0;
+        }
+    };
 
-        const GScalar du0 = v0_uv[0] - v2_uv[0];
-        const GScalar dv0 = v0_uv[1] - v2_uv[1];
-        const GScalar du1 = v1_uv[0] - v2_uv[0];
-        const GScalar dv1 = v1_uv[1] - v2_uv[1];
-        const GScalar det = du0 * dv1 - dv0 * du1;
+    struct CannotComputeVertexTangents
+    {
+        bool operator()(const MeshObject* object) const
+        {
+            return object->get_vertex_tangent_count() > 0 || object->get_tex_coords_count() == 0;
+        }
+    };
 
-        if (det == GScalar(0.0))
-            continue;
+    vector<MeshObject*> collect_mesh_objects(MeshObjectArray& objects)
+    {
+        vector<MeshObject*> result;
+        result.reserve(objects.size());
 
-        const GVector3& v2 = object.get_vertex(triangle.m_v2);
-        const GVector3 dp0 = object.get_vertex(triangle.m_v0) - v2;
-        const GVector3 dp1 = object.get_vertex(triangle.m_v1) - v2;
-        const GVector3 tangent = normalize(dv1 * dp0 - dv0 * dp1);
+        for (size_t i = 0; i < objects.size(); ++i)
+            result.push_back(objects[i]);
 
-        tangents[triangle.m_v0] += tangent;
-        tangents[triangle.m_v1] += tangent;
-        tangents[triangle.m_v2] += tangent;
+        return result;
     }
 
-    object.reserve_vertex_tangents(vertex_count);
+    vector<MeshObject*> collect_mesh_objects(Assembly& assembly)
+    {
+        vector<MeshObject*> result;
+
+        for (each<ObjectContainer> i = assembly.objects(); i; ++i)
+        {
+            if (strcmp(i->get_model(), MeshObjectFactory::get_model()) == 0)
+                result.push_back(static_cast<MeshObject*>(&*i));
+        }
 
-    for (size_t i = 0; i < vertex_count; ++i)
-        object.push_vertex_tangent(safe_normalize(tangents[i]));
+        return result;
+    }
 }
 
-void compute_smooth_vertex_tangents_pose(MeshObject& object, const size_t motion_segment_index)
+void compute_smooth_vertex_normals(
+    MeshObject&             object,
+    const VertexWeighting   weighting,
+    const size_t            thread_count)
 {
-    assert(object.get_tex_coords_count() > 0);
-
-    const size_t vertex_count = object.get_vertex_count();
-    const size_t triangle_count = object.get_triangle_count();
-
-    vector<GVector3> tangents(vertex_count, GVector3(0.0));
-
-    for (size_t i = 0; i < triangle_count; ++i)
-    {
-        const Triangle& triangle = object.get_triangle(i);
-
-        if (!triangle.has_vertex_attributes())
-            continue;
-
-        const GVector2 v0_uv = object.get_tex_coords(triangle.m_a0);
-        const GVector2 v1_uv = object.get_tex_coords(triangle.m_a1);
-        const GVector2 v2_uv = object.get_tex_coords(triangle.m_a2);
+    process_mesh_objects<ComputeNormals>(
+        vector<MeshObject*>(1, &object),
+        weighting,
+        thread_count);
+}
 
-        //
-        // Reference:
-        //
-        //   Physically Based Rendering, first edition, pp. 128-129
-        //
+void compute_smooth_vertex_tangents(
+    MeshObject&             object,
+    const VertexWeighting   weighting,
+    const size_t            thread_count)
+{
+    process_mesh_objects<ComputeTangents>(
+        vector<MeshObject*>(1, &object),
+        weighting,
+        thread_count);
+}
 
-        const GScalar du0 = v0_uv[0] - v2_uv[0];
-        const GScalar dv0 = v0_uv[1] - v2_uv[1];
-        const GScalar du1 = v1_uv[0] - v2_uv[0];
-        const GScalar dv1 = v1_uv[1] - v2_uv[1];
-        const GScalar det = du0 * dv1 - dv0 * du1;
+void compute_smooth_vertex_normals(
+    MeshObjectArray&        objects,
+    const VertexWeighting   weighting,
+    const size_t            thread_count)
+{
+    process_mesh_objects<ComputeNormals>(
+        collect_mesh_objects(objects),
+        weighting,
+        thread_count);
+}
 
-        if (det == GScalar(0.0))
-            continue;
+void compute_smooth_vertex_tangents(
+    MeshObjectArray&        objects,
+    const VertexWeighting   weighting,
+    const size_t            thread_count)
+{
+    process_mesh_objects<ComputeTangents>(
+        collect_mesh_objects(objects),
+        weighting,
+        thread_count);
+}
 
-        const GVector3& v2 = object.get_vertex_pose(triangle.m_v2, motion_segment_index);
-        const GVector3 dp0 = object.get_vertex_pose(triangle.m_v0, motion_segment_index) - v2;
-        const GVector3 dp1 = object.get_vertex_pose(triangle.m_v1, motion_segment_index) - v2;
-        const GVector3 tangent = normalize(dv1 * dp0 - dv0 * dp1);
+void compute_smooth_vertex_normals(
+    Assembly&               assembly,
+    const VertexWeighting   weighting,
+    const size_t            thread_count)
+{
+    vector<MeshObject*> objects = collect_mesh_objects(assembly);
 
-        tangents[triangle.m_v0] += tangent;
-        tangents[triangle.m_v1] += tangent;
-        tangents[triangle.m_v2] += tangent;
-    }
+    objects.erase(
+        remove_if(objects.begin(), objects.end(), HasVertexNormals()),
+        objects.end());
 
-    for (size_t i = 0; i < vertex_count; ++i)
-        object.set_vertex_tangent_pose(i, motion_segment_index, safe_normalize(tangents[i]));
+    process_mesh_objects<ComputeNormals>(objects, weighting, thread_count);
 }
 
-void compute_smooth_vertex_tangents(MeshObject& object)
+void compute_smooth_vertex_tangents(
+    Assembly&               assembly,
+    const VertexWeighting   weighting,
+    const size_t            thread_count)
 {
-    compute_smooth_vertex_tangents_base_pose(object);
+    vector<MeshObject*> objects = collect_mesh_objects(assembly);
+
+    objects.erase(
+        remove_if(objects.begin(), objects.end(), CannotComputeVertexTangents()),
+        objects.end());
 
-    for (size_t i = 0; i < object.get_motion_segment_count(); ++i)
-        compute_smooth_vertex_tangents_pose(object, i);
+    process_mesh_objects<ComputeTangents>(objects, weighting, thread_count);
 }
 
 }   // namespace renderer
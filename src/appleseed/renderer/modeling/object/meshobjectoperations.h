@@ -32,20 +32,72 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
+namespace renderer  { class Assembly; }
 namespace renderer  { class MeshObject; }
+namespace renderer  { class MeshObjectArray; }
 
 namespace renderer
 {
 
+// How triangles sharing a vertex contribute to its smooth normal or tangent vector.
+enum VertexWeighting
+{
+    VertexWeightingUniform,     // all triangles contribute equally
+    VertexWeightingArea,        // triangles contribute in proportion to their area
+    VertexWeightingAngle        // triangles contribute in proportion to their angle at the vertex
+};
+
+// In the functions below, a thread count of 0 lets the function pick a number
+// of threads based on the size of the work and on the number of CPU cores.
+
 // Compute smooth vertex normal vectors for a mesh object.
 // The mesh object must not already have normals.
-APPLESEED_DLLSYMBOL void compute_smooth_vertex_normals(MeshObject& object);
+APPLESEED_DLLSYMBOL void compute_smooth_vertex_normals(
+    MeshObject&             object,
+    const VertexWeighting   weighting = VertexWeightingUniform,
+    const size_t            thread_count = 0);
 
 // Compute smooth vertex tangent vectors for a mesh object.
 // The mesh object must not already have tangent vectors.
 // The mesh object must have texture coordinates.
-APPLESEED_DLLSYMBOL void compute_smooth_vertex_tangents(MeshObject& object);
+APPLESEED_DLLSYMBOL void compute_smooth_vertex_tangents(
+    MeshObject&             object,
+    const VertexWeighting   weighting = VertexWeightingUniform,
+    const size_t            thread_count = 0);
+
+// Compute smooth vertex normal vectors for several mesh objects concurrently.
+// The mesh objects must not already have normals.
+APPLESEED_DLLSYMBOL void compute_smooth_vertex_normals(
+    MeshObjectArray&        objects,
+    const VertexWeighting   weighting = VertexWeightingUniform,
+    const size_t            thread_count = 0);
+
+// Compute smooth vertex tangent vectors for several mesh objects concurrently.
+// The mesh objects must not already have tangent vectors.
+// The mesh objects must have texture coordinates.
+APPLESEED_DLLSYMBOL void compute_smooth_vertex_tangents(
+    MeshObjectArray&        objects,
+    const VertexWeighting   weighting = VertexWeightingUniform,
+    const size_t            thread_count = 0);
+
+// Compute smooth vertex normal vectors for all the mesh objects of an assembly
+// that don't have normals yet. Child assemblies are not visited.
+APPLESEED_DLLSYMBOL void compute_smooth_vertex_normals(
+    Assembly&               assembly,
+    const VertexWeighting   weighting = VertexWeightingUniform,
+    const size_t            thread_count = 0);
+
+// Compute smooth vertex tangent vectors for all the mesh objects of an assembly
+// that have texture coordinates but no tangent vectors yet. Child assemblies are
+// not visited.
+APPLESEED_DLLSYMBOL void compute_smooth_vertex_tangents(
+    Assembly&               assembly,
+    const VertexWeighting   weighting = VertexWeightingUniform,
+    const size_t            thread_count = 0);
 
 }       // namespace renderer
 
@@ -44,6 +44,7 @@
 #include "foundation/math/scalar.h"
 #include "foundation/math/triangulator.h"
 #include "foundation/math/vector.h"
+#include "foundation/mesh/binarymeshfilereader.h"
 #include "foundation/mesh/genericmeshfilereader.h"
 #include "foundation/mesh/imeshbuilder.h"
 #include "foundation/mesh/imeshfilereader.h"
@@ -56,21 +57,27 @@
 #include "foundation/utility/filter.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/memory.h"
+#include "foundation/utility/packfile.h"
 #include "foundation/utility/searchpaths.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
+// Boost headers.
+#include "boost/filesystem/path.hpp"
+
 // Standard headers.
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <exception>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 using namespace foundation;
 using namespace std;
+namespace bf = boost::filesystem;
 
 namespace renderer
 {
@@ -403,16 +410,18 @@ namespace
         const char*             filename,
         const char*             base_object_name,
         const ParamArray&       params,
+        const PackFileReader*   pack_file,
+        const char*             unpacked_dir,
         MeshObjectArray&        objects)
     {
-        GenericMeshFileReader reader(filename);
+        GenericMeshFileReader generic_reader(filename);
 
         const string obj_parsing_mode = params.get_optional<string>("obj_parsing_mode", "fast");
 
         if (obj_parsing_mode == "fast")
         {
-            reader.set_obj_options(
-                reader.get_obj_options() | OBJMeshFileReader::FavorSpeedOverPrecision);
+            generic_reader.set_obj_options(
+                generic_reader.get_obj_options() | OBJMeshFileReader::FavorSpeedOverPrecision);
         }
         else if (obj_parsing_mode == "precise")
         {
@@ -428,10 +437,30 @@ namespace
                 filename,
                 obj_parsing_mode.c_str());
 
-            reader.set_obj_options(
-                reader.get_obj_options() | OBJMeshFileReader::FavorSpeedOverPrecision);
+            generic_reader.set_obj_options(
+                generic_reader.get_obj_options() | OBJMeshFileReader::FavorSpeedOverPrecision);
+        }
+
+        // Binary mesh files of binary projects are decoded in place from the pack file.
+        auto_ptr<BinaryMeshFileReader> packed_reader;
+        if (pack_file && lower_case(bf::path(filename).extension().string()) == ".binarymesh")
+        {
+            const size_t entry = pack_file->find_unpacked_entry(unpacked_dir, filename);
+            if (entry != ~size_t(0))
+            {
+                packed_reader.reset(
+                    new BinaryMeshFileReader(
+                        filename,
+                        pack_file->get_entry_data(entry),
+                        pack_file->get_entry_size(entry)));
+            }
         }
 
+        IMeshFileReader& reader =
+            packed_reader.get()
+                ? static_cast<IMeshFileReader&>(*packed_reader)
+                : static_cast<IMeshFileReader&>(generic_reader);
+
         MeshObjectBuilder builder(params, base_object_name);
 
         Stopwatch<DefaultWallclockTimer> stopwatch;
@@ -714,6 +743,8 @@ namespace
         const StringDictionary& filenames,
         const char*             base_object_name,
         const ParamArray&       params,
+        const PackFileReader*   pack_file,
+        const char*             unpacked_dir,
         MeshObjectArray&        objects)
     {
         assert(filenames.size() >= 2);
@@ -734,6 +765,8 @@ namespace
                 search_paths.qualify(key_frames[0].m_filename).c_str(),
                 base_object_name,
                 params,
+                pack_file,
+                unpacked_dir,
                 objects))
             return false;
 
@@ -756,6 +789,8 @@ namespace
                     search_paths.qualify(filename).c_str(),
                     base_object_name,
                     params,
+                    pack_file,
+                    unpacked_dir,
                     poses))
                 return false;
 
@@ -780,29 +815,29 @@ namespace
         return true;
     }
 
-    void compute_smooth_normals(MeshObject& object)
+    // Return whether smooth normal vectors can be computed for a given mesh object, warn if not.
+    bool check_smooth_normals_computable(const MeshObject& object)
     {
         if (object.get_vertex_normal_count() > 0)
         {
             RENDERER_LOG_WARNING(
                 "skipping computation of smooth normal vectors for mesh object \"%s\" because it already has normal vectors.",
                 object.get_path().c_str());
-            return;
+            return false;
         }
 
-        RENDERER_LOG_INFO("computing smooth normal vectors for mesh object \"%s\"...", object.get_path().c_str());
-
-        compute_smooth_vertex_normals(object);
+        return true;
     }
 
-    void compute_smooth_tangents(MeshObject& object)
+    // Return whether smooth tangent vectors can be computed for a given mesh object, warn if not.
+    bool check_smooth_tangents_computable(const MeshObject& object)
     {
         if (object.get_vertex_tangent_count() > 0)
         {
             RENDERER_LOG_WARNING(
                 "skipping computation of smooth tangent vectors for mesh object \"%s\" because it already has tangent vectors.",
                 object.get_path().c_str());
-            return;
+            return false;
         }
 
         if (object.get_tex_coords_count() == 0)
@@ -810,22 +845,23 @@ namespace
             RENDERER_LOG_WARNING(
                 "cannot compute smooth tangent vectors for mesh object \"%s\" because it lacks texture coordinates.",
                 object.get_path().c_str());
-            return;
+            return false;
         }
 
-        RENDERER_LOG_INFO("computing smooth tangent vectors for mesh object \"%s\"...", object.get_path().c_str());
-
-        compute_smooth_vertex_tangents(object);
+        return true;
     }
 }
 
 bool MeshObjectReader::read(
-    const SearchPaths&  search_paths,
-    const char*         base_object_name,
-    const ParamArray&   params,
-    MeshObjectArray&    objects)
+    const SearchPaths&      search_paths,
+    const char*             base_object_name,
+    const ParamArray&       params,
+    MeshObjectArray&        objects,
+    const PackFileReader*   pack_file,
+    const char*             unpacked_dir)
 {
     assert(base_object_name);
+    assert(pack_file == 0 || unpacked_dir);
 
     // Handle built-in primitives.
     if (params.strings().exist("primitive"))
@@ -859,6 +895,8 @@ bool MeshObjectReader::read(
                 search_paths.qualify(params.strings().get<string>("filename")).c_str(),
                 base_object_name,
                 completed_params,
+                pack_file,
+                unpacked_dir,
                 objects))
             return false;
     }
@@ -884,6 +922,8 @@ bool MeshObjectReader::read(
                         search_paths.qualify(filenames.begin().value()).c_str(),
                         base_object_name,
                         completed_params,
+                        pack_file,
+                        unpacked_dir,
                         objects))
                     return false;
             }
@@ -907,6 +947,8 @@ bool MeshObjectReader::read(
                         filenames,
                         base_object_name,
                         completed_params,
+                        pack_file,
+                        unpacked_dir,
                         objects))
                     return false;
             }
@@ -922,28 +964,38 @@ bool MeshObjectReader::read(
         return false;
     }
 
-    // Compute smooth normals.
+    // Compute smooth normals. All selected objects are processed concurrently.
     if (params.strings().exist("compute_smooth_normals"))
     {
         const RegExFilter filter(params.get("compute_smooth_normals"));
+        MeshObjectArray selected_objects;
         for (size_t i = 0; i < objects.size(); ++i)
         {
             MeshObject& object = *objects[i];
-            if (filter.accepts(object.get_name()))
-                compute_smooth_normals(object);
+            if (filter.accepts(object.get_name()) && check_smooth_normals_computable(object))
+            {
+                RENDERER_LOG_INFO("computing smooth normal vectors for mesh object \"%s\"...", object.get_path().c_str());
+                selected_objects.push_back(&object);
+            }
         }
+        compute_smooth_vertex_normals(selected_objects);
     }
 
-    // Compute smooth tangents.
+    // Compute smooth tangents. All selected objects are processed concurrently.
     if (params.strings().exist("compute_smooth_tangents"))
     {
         const RegExFilter filter(params.get("compute_smooth_tangents"));
+        MeshObjectArray selected_objects;
         for (size_t i = 0; i < objects.size(); ++i)
         {
             MeshObject& object = *objects[i];
-            if (filter.accepts(object.get_name()))
-                compute_smooth_tangents(object);
+            if (filter.accepts(object.get_name()) && check_smooth_tangents_computable(object))
+            {
+                RENDERER_LOG_INFO("computing smooth tangent vectors for mesh object \"%s\"...", object.get_path().c_str());
+                selected_objects.push_back(&object);
+            }
         }
+        compute_smooth_vertex_tangents(selected_objects);
     }
 
     return true;
@@ -37,6 +37,7 @@
 #include "main/dllsymbol.h"
 
 // Forward declarations.
+namespace foundation    { class PackFileReader; }
 namespace foundation    { class SearchPaths; }
 namespace renderer      { class MeshObject; }
 namespace renderer      { class ParamArray; }
@@ -61,11 +62,15 @@ class APPLESEED_DLLSYMBOL MeshObjectReader
     // Read mesh objects from disk. The filenames are defined in params.
     // Returns true on success, false otherwise. When false is returned,
     // nothing should be assumed on the state of the objects parameter.
+    // If pack_file is provided, binarymesh files that unpacking pack_file
+    // to unpacked_dir would extract are read in place from pack_file.
     static bool read(
-        const foundation::SearchPaths&  search_paths,
-        const char*                     base_object_name,
-        const ParamArray&               params,
-        MeshObjectArray&                objects);
+        const foundation::SearchPaths&      search_paths,
+        const char*                         base_object_name,
+        const ParamArray&                   params,
+        MeshObjectArray&                    objects,
+        const foundation::PackFileReader*   pack_file = 0,
+        const char*                         unpacked_dir = 0);
 };
 
 }       // namespace renderer
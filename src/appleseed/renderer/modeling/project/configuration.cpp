@@ -31,11 +31,14 @@
 #include "configuration.h"
 
 // appleseed.renderer headers.
+#include "renderer/kernel/intersection/bvhcache.h"
+#include "renderer/kernel/intersection/triangletreestore.h"
 #include "renderer/kernel/lighting/pt/ptlightingengine.h"
 #include "renderer/kernel/lighting/sppm/sppmlightingengine.h"
 #include "renderer/kernel/rendering/final/adaptivepixelrenderer.h"
 #include "renderer/kernel/rendering/final/uniformpixelrenderer.h"
 #include "renderer/kernel/rendering/generic/genericframerenderer.h"
+#include "renderer/kernel/rendering/generic/genericsamplegenerator.h"
 #include "renderer/kernel/rendering/progressive/progressiveframerenderer.h"
 #include "renderer/kernel/texturing/texturestore.h"
 #include "renderer/utility/paramarray.h"
@@ -162,6 +165,14 @@ Dictionary Configuration::get_metadata()
         "texture_store",
         TextureStore::get_params_metadata());
 
+    metadata.dictionaries().insert(
+        "bvh_cache",
+        BVHCache::get_params_metadata());
+
+    metadata.dictionaries().insert(
+        "triangle_tree_store",
+        TriangleTreeStore::get_params_metadata());
+
     metadata.dictionaries().insert(
         "uniform_pixel_renderer",
         UniformPixelRendererFactory::get_params_metadata());
@@ -178,6 +189,10 @@ Dictionary Configuration::get_metadata()
         "progressive_frame_renderer",
         ProgressiveFrameRendererFactory::get_params_metadata());
 
+    metadata.dictionaries().insert(
+        "generic_sample_generator",
+        GenericSampleGeneratorFactory::get_params_metadata());
+
     metadata.dictionaries().insert("pt", PTLightingEngineFactory::get_params_metadata());
     metadata.dictionaries().insert("sppm", SPPMLightingEngineFactory::get_params_metadata());
 
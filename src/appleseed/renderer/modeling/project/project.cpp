@@ -54,6 +54,7 @@
 #include "renderer/modeling/surfaceshader/surfaceshader.h"
 
 // appleseed.foundation headers.
+#include "foundation/platform/system.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/foreach.h"
@@ -95,9 +96,11 @@ struct Project::Impl
     ConfigurationContainer      m_configurations;
     SearchPaths                 m_search_paths;
     auto_ptr<TraceContext>      m_trace_context;
+    size_t                      m_thread_count;
 
     Impl()
       : m_format_revision(ProjectFormatRevision)
+      , m_thread_count(System::get_logical_cpu_core_count())
       , m_search_paths("APPLESEED_SEARCHPATH", SearchPaths::environment_path_separator())
     {
     }
@@ -222,6 +225,17 @@ void Project::add_default_configurations()
     add_default_configuration("interactive", "base_interactive");
 }
 
+void Project::set_thread_count(const size_t thread_count)
+{
+    assert(thread_count > 0);
+    impl->m_thread_count = thread_count;
+}
+
+size_t Project::get_thread_count() const
+{
+    return impl->m_thread_count;
+}
+
 bool Project::has_trace_context() const
 {
     return impl->m_trace_context.get() != 0;
@@ -232,16 +246,26 @@ const TraceContext& Project::get_trace_context() const
     if (impl->m_trace_context.get() == 0)
     {
         assert(impl->m_scene.get());
-        impl->m_trace_context.reset(new TraceContext(*impl->m_scene));
+        impl->m_trace_context.reset(
+            new TraceContext(*impl->m_scene, ParamArray(), impl->m_thread_count));
     }
 
     return *impl->m_trace_context;
 }
 
-void Project::update_trace_context()
+void Project::update_trace_context(const ParamArray& triangle_tree_store_params)
 {
     if (impl->m_trace_context.get())
-        impl->m_trace_context->update();
+        impl->m_trace_context->update(triangle_tree_store_params, impl->m_thread_count);
+    else
+    {
+        assert(impl->m_scene.get());
+        impl->m_trace_context.reset(
+            new TraceContext(
+                *impl->m_scene,
+                triangle_tree_store_params,
+                impl->m_thread_count));
+    }
 }
 
 void Project::add_base_configurations()
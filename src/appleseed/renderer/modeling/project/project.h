@@ -35,6 +35,7 @@
 #include "renderer/modeling/project/configurationcontainer.h"
 #include "renderer/modeling/project/renderlayerrule.h"
 #include "renderer/modeling/project/renderlayerrulecontainer.h"
+#include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
 #include "foundation/platform/compiler.h"
@@ -127,14 +128,21 @@ class APPLESEED_DLLSYMBOL Project
     // Add the default configurations to the project.
     void add_default_configurations();
 
+    // Set/get the number of threads used to prepare the scene for rendering
+    // (assembly preparation, acceleration structures, importance maps).
+    // Defaults to one thread per logical CPU core.
+    void set_thread_count(const size_t thread_count);
+    size_t get_thread_count() const;
+
     // Return true if the trace context has already been built.
     bool has_trace_context() const;
 
     // Get the trace context.
     const TraceContext& get_trace_context() const;
 
-    // Synchronize the trace context with the scene.
-    void update_trace_context();
+    // Build the trace context if it doesn't exist yet, or synchronize it with the scene.
+    // The parameters are those of the triangle tree store of the trace context.
+    void update_trace_context(const ParamArray& triangle_tree_store_params = ParamArray());
 
   private:
     friend class ProjectFactory;
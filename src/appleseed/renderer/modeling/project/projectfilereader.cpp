@@ -110,6 +110,7 @@
 #include "foundation/math/vector.h"
 #include "foundation/platform/compiler.h"
 #include "foundation/platform/defaulttimers.h"
+#include "foundation/platform/system.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/containers/dictionary.h"
@@ -118,6 +119,7 @@
 #include "foundation/utility/log.h"
 #include "foundation/utility/memory.h"
 #include "foundation/utility/otherwise.h"
+#include "foundation/utility/packfile.h"
 #include "foundation/utility/searchpaths.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
@@ -214,12 +216,16 @@ namespace
     {
       public:
         ParseContext(
-            Project&        project,
-            const int       options,
-            EventCounters&  event_counters)
+            Project&                project,
+            const int               options,
+            EventCounters&          event_counters,
+            const PackFileReader*   pack_file,
+            const char*             unpacked_dir)
           : m_project(project)
           , m_options(options)
           , m_event_counters(event_counters)
+          , m_pack_file(pack_file)
+          , m_unpacked_dir(unpacked_dir)
         {
         }
 
@@ -238,10 +244,24 @@ namespace
             return m_event_counters;
         }
 
+        // Return the pack file of the binary project being read, if any.
+        const PackFileReader* get_pack_file() const
+        {
+            return m_pack_file;
+        }
+
+        // Return the directory the binary project being read was unpacked to, if any.
+        const char* get_unpacked_dir() const
+        {
+            return m_unpacked_dir;
+        }
+
       private:
-        Project&            m_project;
-        const int           m_options;
-        EventCounters&      m_event_counters;
+        Project&                m_project;
+        const int               m_options;
+        EventCounters&          m_event_counters;
+        const PackFileReader*   m_pack_file;
+        const char*             m_unpacked_dir;
     };
 
 
@@ -1630,7 +1650,9 @@ namespace
                                 m_context.get_project().search_paths(),
                                 m_name.c_str(),
                                 m_params,
-                                object_array))
+                                object_array,
+                                m_context.get_pack_file(),
+                                m_context.get_unpacked_dir()))
                             m_objects = array_vector<ObjectVector>(object_array);
                         else m_context.get_event_counters().signal_error();
                     }
@@ -2938,6 +2960,7 @@ namespace
         ProjectElementHandler(ParseContext& context, Project* project)
           : m_context(context)
           , m_project(project)
+          , m_section_memory_size(0)
         {
         }
 
@@ -2965,6 +2988,9 @@ namespace
         {
             assert(m_project);
 
+            m_section_memory_size = System::get_process_virtual_memory_size();
+            m_section_stopwatch.start();
+
             switch (element)
             {
               case ElementConfigurations:
@@ -3054,11 +3080,46 @@ namespace
 
               assert_otherwise;
             }
+
+            print_section_statistics(element);
         }
 
       private:
-        ParseContext&   m_context;
-        Project*        m_project;
+        ParseContext&                       m_context;
+        Project*                            m_project;
+        Stopwatch<DefaultWallclockTimer>    m_section_stopwatch;
+        uint64                              m_section_memory_size;
+
+        static const char* get_section_name(const ProjectElementID element)
+        {
+            switch (element)
+            {
+              case ElementConfigurations: return "configurations";
+              case ElementDisplay: return "display";
+              case ElementOutput: return "output";
+              case ElementRules: return "rules";
+              case ElementScene: return "scene";
+              case ElementSearchPaths: return "search paths";
+              default: return "unknown";
+            }
+        }
+
+        void print_section_statistics(const ProjectElementID element)
+        {
+            m_section_stopwatch.measure();
+
+            const uint64 memory_size = System::get_process_virtual_memory_size();
+            const uint64 memory_delta =
+                memory_size > m_section_memory_size ? memory_size - m_section_memory_size : 0;
+
+            RENDERER_LOG_INFO(
+                "loaded %s section in %s (memory: %s, grown by %s, peak %s).",
+                get_section_name(element),
+                pretty_time(m_section_stopwatch.get_seconds()).c_str(),
+                pretty_size(memory_size).c_str(),
+                pretty_size(memory_delta).c_str(),
+                pretty_size(System::get_peak_process_virtual_memory_size()).c_str());
+        }
     };
 
 
@@ -3210,6 +3271,64 @@ namespace
 
         return (unpacked_project_directory / project_name).string().c_str();
     }
+
+    // Unpack a binary project file and return the path to its project file, or "" on failure.
+    // Binary mesh files are not unpacked: they are read in place from the pack file, which
+    // is returned in pack_file. Other geometry files are not unpacked at all when they won't
+    // be read, for instance to render a thumbnail. Files that were already unpacked by a
+    // previous load are reused.
+    string unpack_binary_project(
+        const string&               project_filepath,
+        const string&               unpacked_project_directory,
+        const int                   options,
+        auto_ptr<PackFileReader>&   pack_file)
+    {
+        try
+        {
+            pack_file.reset(new PackFileReader(project_filepath));
+
+            vector<string> project_filenames;
+            for (size_t i = 0; i < pack_file->get_entry_count(); ++i)
+            {
+                const string& path = pack_file->get_entry_path(i);
+                if (ends_with(path, ".appleseed"))
+                    project_filenames.push_back(path);
+            }
+
+            if (project_filenames.size() != 1)
+            {
+                RENDERER_LOG_ERROR(
+                    "%s looks like a binary project file, but it should contain a single *.appleseed file in order to be valid.",
+                    project_filepath.c_str());
+                return "";
+            }
+
+            vector<string> skipped_extensions;
+            skipped_extensions.push_back(".binarymesh");
+            if (options & ProjectFileReader::OmitReadingMeshFiles)
+            {
+                skipped_extensions.push_back(".abc");
+                skipped_extensions.push_back(".obj");
+            }
+
+            RENDERER_LOG_INFO(
+                "%s appears to be a binary project; unpacking to %s...",
+                project_filepath.c_str(),
+                unpacked_project_directory.c_str());
+
+            unpack(*pack_file, project_filepath, unpacked_project_directory, skipped_extensions);
+
+            return (bf::path(unpacked_project_directory) / project_filenames[0]).string();
+        }
+        catch (const exception& e)
+        {
+            RENDERER_LOG_ERROR(
+                "failed to unpack binary project file %s: %s",
+                project_filepath.c_str(),
+                e.what());
+            return "";
+        }
+    }
 }
 
 auto_release_ptr<Project> ProjectFileReader::read(
@@ -3226,6 +3345,8 @@ auto_release_ptr<Project> ProjectFileReader::read(
 
     // Handle packed projects.
     string actual_project_filepath;
+    string unpacked_project_directory;
+    auto_ptr<PackFileReader> pack_file;
     if (is_zip_file(project_filepath))
     {
         const string project_filename = get_project_filename_from_archive(project_filepath);
@@ -3252,6 +3373,23 @@ auto_release_ptr<Project> ProjectFileReader::read(
 
         project_filepath = actual_project_filepath.data();
     }
+    else if (is_pack_file(project_filepath))
+    {
+        unpacked_project_directory =
+            bf::path(project_filepath).replace_extension(".unpacked").string();
+
+        actual_project_filepath =
+            unpack_binary_project(
+                project_filepath,
+                unpacked_project_directory,
+                options,
+                pack_file);
+
+        if (actual_project_filepath.empty())
+            return auto_release_ptr<Project>(0);
+
+        project_filepath = actual_project_filepath.data();
+    }
 
     XercesCContext xerces_context(global_logger());
     if (!xerces_context.is_initialized())
@@ -3273,7 +3411,10 @@ auto_release_ptr<Project> ProjectFileReader::read(
             project_filepath,
             schema_filepath,
             options,
-            event_counters));
+            event_counters,
+            0,
+            pack_file.get(),
+            unpacked_project_directory.c_str()));
 
     if (project.get())
         postprocess_project(project.ref(), event_counters, options);
@@ -3402,11 +3543,13 @@ auto_release_ptr<Project> ProjectFileReader::load_builtin(
 }
 
 auto_release_ptr<Project> ProjectFileReader::load_project_file(
-    const char*                     project_filepath,
-    const char*                     schema_filepath,
-    const int                       options,
-    EventCounters&                  event_counters,
-    const foundation::SearchPaths*  search_paths) const
+    const char*                         project_filepath,
+    const char*                         schema_filepath,
+    const int                           options,
+    EventCounters&                      event_counters,
+    const foundation::SearchPaths*      search_paths,
+    const foundation::PackFileReader*   pack_file,
+    const char*                         unpacked_dir) const
 {
     // Create an empty project.
     auto_release_ptr<Project> project(ProjectFactory::create(project_filepath));
@@ -3430,7 +3573,7 @@ auto_release_ptr<Project> ProjectFileReader::load_project_file(
             event_counters));
 
     // Create the content handler.
-    ParseContext context(project.ref(), options, event_counters);
+    ParseContext context(project.ref(), options, event_counters, pack_file, unpacked_dir);
     auto_ptr<ContentHandler> content_handler(
         new ContentHandler(
             project.get(),
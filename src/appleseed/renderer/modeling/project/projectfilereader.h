@@ -38,9 +38,10 @@
 #include "main/dllsymbol.h"
 
 // Forward declarations.
-namespace renderer  { class Assembly; }
-namespace renderer  { class EventCounters; }
-namespace renderer  { class Project; }
+namespace foundation    { class PackFileReader; }
+namespace renderer      { class Assembly; }
+namespace renderer      { class EventCounters; }
+namespace renderer      { class Project; }
 
 namespace renderer
 {
@@ -83,11 +84,13 @@ class APPLESEED_DLLSYMBOL ProjectFileReader
 
   private:
     foundation::auto_release_ptr<Project> load_project_file(
-        const char*                     project_filepath,
-        const char*                     schema_filepath,
-        const int                       options,
-        EventCounters&                  event_counters,
-        const foundation::SearchPaths*  search_paths = 0) const;
+        const char*                         project_filepath,
+        const char*                         schema_filepath,
+        const int                           options,
+        EventCounters&                      event_counters,
+        const foundation::SearchPaths*      search_paths = 0,
+        const foundation::PackFileReader*   pack_file = 0,
+        const char*                         unpacked_dir = 0) const;
 
     foundation::auto_release_ptr<Project> construct_builtin_project(
         const char*                     project_name,
@@ -77,6 +77,7 @@
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/indenter.h"
+#include "foundation/utility/packfile.h"
 #include "foundation/utility/searchpaths.h"
 #include "foundation/utility/string.h"
 #include "foundation/utility/xmlelement.h"
@@ -908,8 +909,10 @@ bool ProjectFileWriter::write(
     const char*     filepath,
     const int       options)
 {
+    const bf::path extension = bf::path(filepath).extension();
+
     return
-        bf::path(filepath).extension() == ".appleseedz"
+        extension == ".appleseedz" || extension == ".appleseedb"
             ? write_packed_project_file(project, filepath, options)
             : write_plain_project_file(project, filepath, options);
 }
@@ -1002,7 +1005,10 @@ bool ProjectFileWriter::write_packed_project_file(
         if (success)
         {
             RENDERER_LOG_INFO("packing project to %s...", filepath);
-            zip(filepath, temp_directory.string());
+
+            if (project_path.extension() == ".appleseedb")
+                pack(filepath, temp_directory.string());
+            else zip(filepath, temp_directory.string());
         }
     }
     catch (const std::exception&)
@@ -55,7 +55,8 @@ class APPLESEED_DLLSYMBOL ProjectFileWriter
         CopyAllAssets               = 1 << 3    // copy all asset files (by default copy asset files with relative paths only)
     };
 
-    // Write a project to disk.
+    // Write a project to disk. The project is packed into a single file if the
+    // file path has the *.appleseedz (zip) or *.appleseedb (binary) extension.
     // Returns true on success, false otherwise.
     static bool write(
         const Project&  project,
@@ -70,7 +71,7 @@ class APPLESEED_DLLSYMBOL ProjectFileWriter
         const char*     filepath,
         const int       options);
 
-    // Write a project file to disk as a packed project file.
+    // Write a project file to disk as a packed (zip or binary) project file.
     // Returns true on success, false otherwise.
     static bool write_packed_project_file(
         const Project&  project,
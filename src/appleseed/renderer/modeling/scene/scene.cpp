@@ -31,7 +31,9 @@
 #include "scene.h"
 
 // appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
 #include "renderer/modeling/color/colorentity.h"
+#include "renderer/modeling/entity/onframebeginrecorder.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
 #include "renderer/modeling/environmentshader/environmentshader.h"
 #include "renderer/modeling/frame/frame.h"
@@ -51,12 +53,21 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/vector.h"
+#include "foundation/platform/defaulttimers.h"
+#include "foundation/utility/api/apistring.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/job/abortswitch.h"
+#include "foundation/utility/job/ijob.h"
+#include "foundation/utility/job/jobmanager.h"
+#include "foundation/utility/job/jobqueue.h"
+#include "foundation/utility/stopwatch.h"
+#include "foundation/utility/string.h"
 
 // Standard headers.
+#include <algorithm>
 #include <set>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -348,6 +359,138 @@ namespace
 
         return success;
     }
+
+    //
+    // Assemblies are independent from each other: on_frame_begin() is called on all of
+    // them in parallel, each one recording into its own recorder. The records are then
+    // appended to the main recorder in the order of the assemblies, so that on_frame_end()
+    // is called in the same order as if assemblies had been processed sequentially.
+    //
+
+    struct AssemblyPreparation
+    {
+        Assembly*               m_assembly;
+        OnFrameBeginRecorder    m_recorder;
+        bool                    m_success;
+        double                  m_seconds;
+    };
+
+    class AssemblyPreparationJob
+      : public IJob
+    {
+      public:
+        AssemblyPreparationJob(
+            const Project&          project,
+            const BaseGroup*        parent,
+            AssemblyPreparation&    preparation,
+            IAbortSwitch*           abort_switch)
+          : m_project(project)
+          , m_parent(parent)
+          , m_preparation(preparation)
+          , m_abort_switch(abort_switch)
+        {
+        }
+
+        virtual void execute(const size_t thread_index) override
+        {
+            if (is_aborted(m_abort_switch))
+                return;
+
+            Stopwatch<DefaultWallclockTimer> stopwatch;
+            stopwatch.start();
+
+            m_preparation.m_success =
+                m_preparation.m_assembly->on_frame_begin(
+                    m_project,
+                    m_parent,
+                    m_preparation.m_recorder,
+                    m_abort_switch);
+
+            stopwatch.measure();
+            m_preparation.m_seconds = stopwatch.get_seconds();
+        }
+
+      private:
+        const Project&              m_project;
+        const BaseGroup*            m_parent;
+        AssemblyPreparation&        m_preparation;
+        IAbortSwitch*               m_abort_switch;
+    };
+
+    bool invoke_on_frame_begin_in_parallel(
+        const Project&          project,
+        const BaseGroup*        parent,
+        AssemblyContainer&      assemblies,
+        OnFrameBeginRecorder&   recorder,
+        IAbortSwitch*           abort_switch)
+    {
+        const size_t assembly_count = assemblies.size();
+        const size_t thread_count = min(assembly_count, project.get_thread_count());
+
+        // Not worth spawning threads.
+        if (thread_count <= 1)
+            return invoke_on_frame_begin(project, parent, assemblies, recorder, abort_switch);
+
+        Stopwatch<DefaultWallclockTimer> stopwatch;
+        stopwatch.start();
+
+        vector<AssemblyPreparation*> preparations;
+        preparations.reserve(assembly_count);
+
+        JobQueue job_queue;
+
+        for (each<AssemblyContainer> i = assemblies; i; ++i)
+        {
+            AssemblyPreparation* preparation = new AssemblyPreparation();
+            preparation->m_assembly = &*i;
+            preparation->m_success = false;
+            preparation->m_seconds = 0.0;
+            preparations.push_back(preparation);
+
+            job_queue.schedule(
+                new AssemblyPreparationJob(
+                    project,
+                    parent,
+                    *preparation,
+                    abort_switch));
+        }
+
+        JobManager job_manager(
+            global_logger(),
+            job_queue,
+            thread_count);
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        stopwatch.measure();
+
+        bool success = true;
+
+        for (size_t i = 0; i < assembly_count; ++i)
+        {
+            const AssemblyPreparation* preparation = preparations[i];
+
+            RENDERER_LOG_DEBUG(
+                "prepared assembly \"%s\" in %s.",
+                preparation->m_assembly->get_path().c_str(),
+                pretty_time(preparation->m_seconds).c_str());
+
+            success = success && preparation->m_success;
+            recorder.append(preparations[i]->m_recorder);
+
+            delete preparations[i];
+        }
+
+        RENDERER_LOG_INFO(
+            "prepared %s %s in %s using %s %s.",
+            pretty_uint(assembly_count).c_str(),
+            plural(assembly_count, "assembly", "assemblies").c_str(),
+            pretty_time(stopwatch.get_seconds()).c_str(),
+            pretty_uint(thread_count).c_str(),
+            plural(thread_count, "thread").c_str());
+
+        return success;
+    }
 }
 
 bool Scene::on_frame_begin(
@@ -384,7 +527,7 @@ bool Scene::on_frame_begin(
     if (!is_aborted(abort_switch) && impl->m_environment.get())
         success = success && impl->m_environment->on_frame_begin(project, this, recorder, abort_switch);
 
-    success = success && invoke_on_frame_begin(project, this, assemblies(), recorder, abort_switch);
+    success = success && invoke_on_frame_begin_in_parallel(project, this, assemblies(), recorder, abort_switch);
     success = success && invoke_on_frame_begin(project, this, assembly_instances(), recorder, abort_switch);
 
     return success;
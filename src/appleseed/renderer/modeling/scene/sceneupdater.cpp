@@ -0,0 +1,362 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "sceneupdater.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/modeling/camera/camera.h"
+#include "renderer/modeling/entity/entity.h"
+#include "renderer/modeling/environmentedf/environmentedf.h"
+#include "renderer/modeling/environmentshader/environmentshader.h"
+#include "renderer/modeling/light/light.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/basegroup.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/api/apistring.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/foreach.h"
+
+// Standard headers.
+#include <cstring>
+#include <set>
+#include <string>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// SceneUpdater class implementation.
+//
+
+namespace
+{
+    // Mesh files are not read when loading the scene of another frame: the mesh object
+    // "object" of that scene then stands for the objects "object.part" of this scene.
+    const Object* find_source_object(
+        const ObjectContainer&      source_objects,
+        const char*                 name)
+    {
+        string object_name = name;
+
+        while (true)
+        {
+            const Object* source_object = source_objects.get_by_name(object_name.c_str());
+
+            if (source_object)
+                return source_object;
+
+            const size_t dot = object_name.find_last_of('.');
+
+            if (dot == string::npos)
+                return 0;
+
+            object_name.resize(dot);
+        }
+    }
+
+    bool check_objects(
+        const Assembly&             assembly,
+        const Assembly&             source_assembly)
+    {
+        const ObjectContainer& source_objects = source_assembly.objects();
+
+        bool success = true;
+        set<const Object*> matched_source_objects;
+
+        for (const_each<ObjectContainer> i = assembly.objects(); i; ++i)
+        {
+            const Object* source_object = find_source_object(source_objects, i->get_name());
+
+            if (source_object == 0 || i->get_parameters() != source_object->get_parameters())
+            {
+                RENDERER_LOG_ERROR(
+                    "object \"%s\" changed between frames and cannot be updated.",
+                    i->get_path().c_str());
+                success = false;
+            }
+            else matched_source_objects.insert(source_object);
+        }
+
+        if (success && matched_source_objects.size() != source_objects.size())
+        {
+            RENDERER_LOG_ERROR(
+                "objects were added to assembly \"%s\" between frames and cannot be updated.",
+                assembly.get_path().c_str());
+            success = false;
+        }
+
+        return success;
+    }
+
+    bool check_object_instances(
+        const Assembly&             assembly,
+        const Assembly&             source_assembly)
+    {
+        const ObjectInstanceContainer& object_instances = assembly.object_instances();
+        const ObjectInstanceContainer& source_object_instances = source_assembly.object_instances();
+
+        bool success = true;
+
+        if (object_instances.size() != source_object_instances.size())
+        {
+            RENDERER_LOG_ERROR(
+                "the object instances of assembly \"%s\" changed between frames and cannot be updated.",
+                assembly.get_path().c_str());
+            success = false;
+        }
+
+        for (const_each<ObjectInstanceContainer> i = object_instances; i; ++i)
+        {
+            const ObjectInstance* source_object_instance = source_object_instances.get_by_name(i->get_name());
+
+            if (source_object_instance == 0 ||
+                strcmp(i->get_object_name(), source_object_instance->get_object_name()) != 0 ||
+                i->get_transform() != source_object_instance->get_transform() ||
+                i->get_parameters() != source_object_instance->get_parameters() ||
+                i->get_front_material_mappings() != source_object_instance->get_front_material_mappings() ||
+                i->get_back_material_mappings() != source_object_instance->get_back_material_mappings())
+            {
+                RENDERER_LOG_ERROR(
+                    "object instance \"%s\" changed between frames and cannot be updated.",
+                    i->get_path().c_str());
+                success = false;
+            }
+        }
+
+        return success;
+    }
+
+    bool check_group(
+        const BaseGroup&            group,
+        const BaseGroup&            source_group)
+    {
+        bool success = true;
+
+        for (const_each<AssemblyContainer> i = group.assemblies(); i; ++i)
+        {
+            const Assembly* source_assembly = source_group.assemblies().get_by_name(i->get_name());
+
+            if (source_assembly)
+            {
+                // Use non-short-circuiting operators to report every change.
+                success &= check_objects(*i, *source_assembly);
+                success &= check_object_instances(*i, *source_assembly);
+                success &= check_group(*i, *source_assembly);
+            }
+        }
+
+        return success;
+    }
+
+    bool update_parameters(Entity& entity, const Entity& source_entity)
+    {
+        if (entity.get_parameters() == source_entity.get_parameters())
+            return false;
+
+        entity.get_parameters() = source_entity.get_parameters();
+        return true;
+    }
+
+    bool update_transform_sequence(
+        TransformSequence&          transform_sequence,
+        const TransformSequence&    source_transform_sequence)
+    {
+        if (transform_sequence.compute_signature() == source_transform_sequence.compute_signature())
+            return false;
+
+        transform_sequence = source_transform_sequence;
+        return true;
+    }
+
+    template <typename EntityType, typename ContainerType>
+    size_t update_entities(
+        ContainerType&              entities,
+        const ContainerType&        source_entities)
+    {
+        size_t updated_count = 0;
+
+        for (each<ContainerType> i = entities; i; ++i)
+        {
+            const EntityType* source_entity = source_entities.get_by_name(i->get_name());
+
+            if (source_entity && update_parameters(*i, *source_entity))
+            {
+                i->bump_version_id();
+                ++updated_count;
+            }
+        }
+
+        return updated_count;
+    }
+
+    template <typename EntityType, typename ContainerType>
+    size_t update_transformed_entities(
+        ContainerType&              entities,
+        const ContainerType&        source_entities)
+    {
+        size_t updated_count = 0;
+
+        for (each<ContainerType> i = entities; i; ++i)
+        {
+            const EntityType* source_entity = source_entities.get_by_name(i->get_name());
+
+            if (source_entity == 0)
+                continue;
+
+            // Use a non-short-circuiting operator to update both.
+            if (update_parameters(*i, *source_entity) |
+                update_transform_sequence(i->transform_sequence(), source_entity->transform_sequence()))
+            {
+                i->bump_version_id();
+                ++updated_count;
+            }
+        }
+
+        return updated_count;
+    }
+
+    size_t update_lights(
+        LightContainer&             lights,
+        const LightContainer&       source_lights)
+    {
+        size_t updated_count = 0;
+
+        for (each<LightContainer> i = lights; i; ++i)
+        {
+            const Light* source_light = source_lights.get_by_name(i->get_name());
+
+            if (source_light == 0)
+                continue;
+
+            bool updated = update_parameters(*i, *source_light);
+
+            if (i->get_transform() != source_light->get_transform())
+            {
+                i->set_transform(source_light->get_transform());
+                updated = true;
+            }
+
+            if (updated)
+            {
+                i->bump_version_id();
+                ++updated_count;
+            }
+        }
+
+        return updated_count;
+    }
+
+    size_t update_group(
+        const BaseGroup&            group,
+        const BaseGroup&            source_group);
+
+    size_t update_assemblies(
+        AssemblyContainer&          assemblies,
+        const AssemblyContainer&    source_assemblies)
+    {
+        size_t updated_count = 0;
+
+        for (each<AssemblyContainer> i = assemblies; i; ++i)
+        {
+            const Assembly* source_assembly = source_assemblies.get_by_name(i->get_name());
+
+            if (source_assembly)
+            {
+                updated_count += update_lights(i->lights(), source_assembly->lights());
+                updated_count += update_group(*i, *source_assembly);
+            }
+        }
+
+        return updated_count;
+    }
+
+    size_t update_group(
+        const BaseGroup&            group,
+        const BaseGroup&            source_group)
+    {
+        size_t updated_count = 0;
+
+        updated_count +=
+            update_transformed_entities<AssemblyInstance>(
+                group.assembly_instances(),
+                source_group.assembly_instances());
+
+        updated_count +=
+            update_assemblies(
+                group.assemblies(),
+                source_group.assemblies());
+
+        return updated_count;
+    }
+}
+
+bool SceneUpdater::update(
+    Scene&          scene,
+    const Scene&    source_scene,
+    size_t&         updated_count)
+{
+    updated_count = 0;
+
+    // Don't render stale geometry: refuse changes that cannot be transferred.
+    if (!check_group(scene, source_scene))
+        return false;
+
+    updated_count +=
+        update_transformed_entities<Camera>(
+            scene.cameras(),
+            source_scene.cameras());
+
+    updated_count +=
+        update_transformed_entities<EnvironmentEDF>(
+            scene.environment_edfs(),
+            source_scene.environment_edfs());
+
+    updated_count +=
+        update_entities<EnvironmentShader>(
+            scene.environment_shaders(),
+            source_scene.environment_shaders());
+
+    updated_count += update_group(scene, source_scene);
+
+    return true;
+}
+
+}   // namespace renderer
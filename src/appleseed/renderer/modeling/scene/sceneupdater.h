@@ -0,0 +1,69 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_MODELING_SCENE_SCENEUPDATER_H
+#define APPLESEED_RENDERER_MODELING_SCENE_SCENEUPDATER_H
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace renderer  { class Scene; }
+
+namespace renderer
+{
+
+//
+// Transfers the animated state of a scene from another version of the same scene,
+// typically the scene of another frame of an animation. The transforms and the
+// parameters of cameras, environment EDFs and shaders, assembly instances and lights
+// are copied; entities are matched by name, and entities that only exist in one of
+// the two scenes are left untouched. The version of every modified entity is bumped.
+//
+// Objects and object instances cannot be updated. If their parameters, transforms,
+// material assignments or set differ between the two scenes, the update fails and
+// the scene is left unmodified. Mesh files are compared by name only.
+//
+
+class APPLESEED_DLLSYMBOL SceneUpdater
+{
+  public:
+    // Update a scene from another version of it.
+    // Return true on success, false if the two versions cannot be reconciled.
+    static bool update(
+        Scene&          scene,
+        const Scene&    source_scene,
+        size_t&         updated_count);     // number of entities that were modified
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_MODELING_SCENE_SCENEUPDATER_H
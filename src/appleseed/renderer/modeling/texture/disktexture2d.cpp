@@ -32,15 +32,19 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/texturing/texturefilebudget.h"
 #include "renderer/modeling/texture/texture.h"
 #include "renderer/utility/messagecontext.h"
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
 #include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
 #include "foundation/image/colorspace.h"
 #include "foundation/image/genericprogressiveimagefilereader.h"
 #include "foundation/image/tile.h"
+#include "foundation/image/tiledtexturefileformat.h"
+#include "foundation/image/tiledtexturefilereader.h"
 #include "foundation/platform/thread.h"
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/api/specializedapiarrays.h"
@@ -48,12 +52,21 @@
 #include "foundation/utility/makevector.h"
 #include "foundation/utility/searchpaths.h"
 
+// Boost headers.
+#include "boost/filesystem.hpp"
+#include "boost/system/error_code.hpp"
+#include "boost/thread/mutex.hpp"
+
 // Standard headers.
 #include <cstddef>
+#include <ctime>
+#include <memory>
 #include <string>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
+namespace bf = boost::filesystem;
 
 namespace renderer
 {
@@ -63,11 +76,49 @@ namespace
     //
     // 2D on-disk texture.
     //
+    // Native tiled texture files are read through a single file handle shared
+    // by all threads. Other image files are read through a pool of readers,
+    // each with its own file handle, so that tiles can be read concurrently.
+    // Readers are opened within the process-wide texture file budget, which
+    // may close idle readers of this texture to let other textures open files.
+    //
+    // If a native tiled texture file with the same name as the texture file
+    // (but with the .astx extension) exists and is not older than the texture
+    // file, it is used in place of the texture file.
+    //
 
     const char* Model = "disk_texture_2d";
 
+    // Return the path to an up-to-date native tiled version of a given file, if any.
+    string find_tiled_texture_file(const string& filepath)
+    {
+        const bf::path source_path(filepath);
+
+        bf::path tiled_path(source_path);
+        tiled_path.replace_extension(TiledTextureFileExtension);
+
+        if (tiled_path == source_path)
+            return filepath;
+
+        boost::system::error_code ec;
+
+        if (!bf::exists(tiled_path, ec))
+            return filepath;
+
+        const time_t source_time = bf::last_write_time(source_path, ec);
+        if (ec)
+            return tiled_path.string();
+
+        const time_t tiled_time = bf::last_write_time(tiled_path, ec);
+        if (ec || tiled_time < source_time)
+            return filepath;
+
+        return tiled_path.string();
+    }
+
     class DiskTexture2d
       : public Texture
+      , private TextureFileBudget::IClient
     {
       public:
         DiskTexture2d(
@@ -75,7 +126,8 @@ namespace
             const ParamArray&   params,
             const SearchPaths&  search_paths)
           : Texture(name, params)
-          , m_reader(&global_logger())
+          , m_is_open(false)
+          , m_open_reader_count(0)
         {
             const EntityDefMessageContext message_context("texture", this);
 
@@ -96,6 +148,12 @@ namespace
             else m_color_space = ColorSpaceCIEXYZ;
         }
 
+        virtual ~DiskTexture2d()
+        {
+            TextureFileBudget::instance().remove_client(this);
+            close_image_file();
+        }
+
         virtual void release() override
         {
             delete this;
@@ -110,8 +168,7 @@ namespace
             const Project&      project,
             const BaseGroup*    parent) override
         {
-            if (m_reader.is_open())
-                m_reader.close();
+            close_image_file();
         }
 
         virtual ColorSpace get_color_space() const override
@@ -137,13 +194,49 @@ namespace
             return m_props;
         }
 
+        virtual bool is_constant(Color4f& color) override
+        {
+            // Only native tiled texture files record whether their pixels all have
+            // the same value. Don't open other texture files: they are loaded lazily.
+            const string filepath = find_tiled_texture_file(m_filepath);
+            if (bf::path(filepath).extension() != TiledTextureFileExtension)
+                return false;
+
+            size_t channel_count;
+            if (!TiledTextureFileReader::read_constant_color(filepath.c_str(), color, channel_count))
+                return false;
+
+            return channel_count == 3 || channel_count == 4;
+        }
+
         virtual Tile* load_tile(
             const size_t        tile_x,
             const size_t        tile_y) override
         {
-            boost::mutex::scoped_lock lock(m_mutex);
-            open_image_file();
-            return m_reader.read_tile(tile_x, tile_y);
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+                open_image_file();
+            }
+
+            // Native tiled texture files support concurrent reads.
+            if (m_tiled_reader.get())
+                return m_tiled_reader->read_tile(0, tile_x, tile_y);
+
+            GenericProgressiveImageFileReader* reader = acquire_reader();
+            Tile* tile;
+
+            try
+            {
+                tile = reader->read_tile(tile_x, tile_y);
+            }
+            catch (...)
+            {
+                release_reader(reader);
+                throw;
+            }
+
+            release_reader(reader);
+            return tile;
         }
 
         virtual void unload_tile(
@@ -155,24 +248,138 @@ namespace
         }
 
       private:
+        typedef GenericProgressiveImageFileReader ReaderType;
+
         string                              m_filepath;
         ColorSpace                          m_color_space;
 
+        // All members below are protected by m_mutex, except for m_tiled_reader
+        // which may be used without locking once the image file is open.
         mutable boost::mutex                m_mutex;
-        GenericProgressiveImageFileReader   m_reader;
+        bool                                m_is_open;
         CanvasProperties                    m_props;
+        auto_ptr<TiledTextureFileReader>    m_tiled_reader;
+        vector<ReaderType*>                 m_idle_readers;
+        size_t                              m_open_reader_count;
 
+        // Must be called with m_mutex locked.
         void open_image_file()
         {
-            if (!m_reader.is_open())
+            if (m_is_open)
+                return;
+
+            const string filepath = find_tiled_texture_file(m_filepath);
+
+            RENDERER_LOG_INFO(
+                "opening texture file %s and reading metadata...",
+                filepath.c_str());
+
+            if (TiledTextureFileReader::is_tiled_texture_file(filepath.c_str()))
+            {
+                auto_ptr<TiledTextureFileReader> reader(new TiledTextureFileReader());
+                reader->open(filepath.c_str());
+                reader->read_canvas_properties(m_props);
+                m_tiled_reader = reader;
+            }
+            else
             {
-                RENDERER_LOG_INFO(
-                    "opening texture file %s and reading metadata...",
-                    m_filepath.c_str());
+                // This reader is only used to read metadata and is closed right away:
+                // it is not part of the texture file budget.
+                ReaderType reader(&global_logger());
+                reader.open(m_filepath.c_str());
+                reader.read_canvas_properties(m_props);
+                reader.close();
+            }
 
-                m_reader.open(m_filepath.c_str());
-                m_reader.read_canvas_properties(m_props);
+            m_is_open = true;
+        }
+
+        void close_image_file()
+        {
+            vector<ReaderType*> readers;
+
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+
+                assert(m_idle_readers.size() == m_open_reader_count);
+
+                readers.swap(m_idle_readers);
+                m_open_reader_count = 0;
+                m_tiled_reader.reset();
+                m_is_open = false;
+            }
+
+            // Give the slots back outside of the lock.
+            for (size_t i = 0; i < readers.size(); ++i)
+            {
+                delete readers[i];
+                TextureFileBudget::instance().release();
+            }
+        }
+
+        // Retrieve an idle reader, opening a new one within the texture file budget if there is none.
+        ReaderType* acquire_reader()
+        {
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+
+                if (!m_idle_readers.empty())
+                {
+                    ReaderType* reader = m_idle_readers.back();
+                    m_idle_readers.pop_back();
+                    return reader;
+                }
+            }
+
+            // The budget may close idle readers of any texture: m_mutex must not be locked.
+            TextureFileBudget& budget = TextureFileBudget::instance();
+            budget.acquire(this);
+
+            try
+            {
+                auto_ptr<ReaderType> reader(new ReaderType(&global_logger()));
+                reader->open(m_filepath.c_str());
+
+                boost::mutex::scoped_lock lock(m_mutex);
+                ++m_open_reader_count;
+
+                return reader.release();
+            }
+            catch (...)
+            {
+                budget.release();
+                throw;
+            }
+        }
+
+        void release_reader(ReaderType* reader)
+        {
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+                m_idle_readers.push_back(reader);
             }
+
+            // Let textures waiting for the budget close this reader.
+            TextureFileBudget::instance().notify_idle_file();
+        }
+
+        virtual bool close_idle_file() override
+        {
+            ReaderType* reader;
+
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+
+                if (m_idle_readers.empty())
+                    return false;
+
+                reader = m_idle_readers.back();
+                m_idle_readers.pop_back();
+                --m_open_reader_count;
+            }
+
+            delete reader;
+            return true;
         }
     };
 }
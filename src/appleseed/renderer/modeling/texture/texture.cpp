@@ -57,4 +57,9 @@ Texture::Texture(
     set_name(name);
 }
 
+bool Texture::is_constant(Color4f& color)
+{
+    return false;
+}
+
 }   // namespace renderer
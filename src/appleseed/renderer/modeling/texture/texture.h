@@ -34,6 +34,7 @@
 #include "renderer/modeling/entity/entity.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/color.h"
 #include "foundation/image/colorspace.h"
 #include "foundation/utility/uid.h"
 
@@ -76,6 +77,10 @@ class APPLESEED_DLLSYMBOL Texture
     // Access canvas properties.
     virtual const foundation::CanvasProperties& properties() = 0;
 
+    // Return true if all texels of the texture have the same value, and store
+    // this value, expressed in the color space of the texture, in color.
+    virtual bool is_constant(foundation::Color4f& color);
+
     // Load a given tile.
     virtual foundation::Tile* load_tile(
         const size_t                tile_x,
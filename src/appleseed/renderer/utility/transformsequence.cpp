@@ -36,6 +36,7 @@
 #include "foundation/math/root.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
+#include "foundation/utility/siphash.h"
 
 // Standard headers.
 #include <algorithm>
@@ -231,6 +232,19 @@ bool TransformSequence::swaps_handedness(const Transformd& xform) const
     return xform.swaps_handedness();
 }
 
+uint64 TransformSequence::compute_signature() const
+{
+    uint64 signature = siphash24(static_cast<uint64>(m_size));
+
+    for (size_t i = 0; i < m_size; ++i)
+    {
+        signature = siphash24(signature, siphash24(m_keys[i].m_time));
+        signature = siphash24(signature, siphash24(m_keys[i].m_transform.get_local_to_parent()));
+    }
+
+    return signature;
+}
+
 TransformSequence TransformSequence::operator*(const TransformSequence& rhs) const
 {
     TransformSequence result;
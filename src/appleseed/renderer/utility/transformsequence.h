@@ -34,6 +34,7 @@
 #include "foundation/math/aabb.h"
 #include "foundation/math/transform.h"
 #include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
 
 // appleseed.main headers.
 #include "main/dllsymbol.h"
@@ -116,6 +117,9 @@ class APPLESEED_DLLSYMBOL TransformSequence
         const float                     time,
         foundation::Transformd&         scratch) const;
 
+    // Compute a signature of the (time, transform) pairs of the sequence.
+    foundation::uint64 compute_signature() const;
+
     // Compose two transform sequences.
     TransformSequence operator*(const TransformSequence& rhs) const;
 
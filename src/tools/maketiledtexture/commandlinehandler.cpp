@@ -0,0 +1,93 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "commandlinehandler.h"
+
+// appleseed.shared headers.
+#include "application/superlogger.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/log.h"
+
+using namespace appleseed::shared;
+using namespace foundation;
+using namespace std;
+
+namespace appleseed {
+namespace maketiledtexture {
+
+CommandLineHandler::CommandLineHandler()
+  : CommandLineHandlerBase("maketiledtexture")
+{
+    add_default_options();
+
+    parser().set_default_option_handler(
+        &m_filenames
+            .set_min_value_count(1)
+            .set_max_value_count(2));
+
+    parser().add_option_handler(
+        &m_tile_size
+            .add_name("--tile-size")
+            .add_name("-t")
+            .set_description("set the width and height of the tiles, in pixels")
+            .set_syntax("size")
+            .set_exact_value_count(1)
+            .set_default_value(64));
+
+    parser().add_option_handler(
+        &m_half_float
+            .add_name("--half-float")
+            .add_name("-hf")
+            .set_description("store pixels as 16-bit floating-point values"));
+
+    parser().add_option_handler(
+        &m_no_mipmaps
+            .add_name("--no-mipmaps")
+            .add_name("-nm")
+            .set_description("only store the full resolution image"));
+}
+
+void CommandLineHandler::print_program_usage(
+    const char*     executable_name,
+    SuperLogger&    logger) const
+{
+    SaveLogFormatterConfig save_config(logger);
+    logger.set_verbosity_level(LogMessage::Info);
+    logger.set_format(LogMessage::Info, "{message}");
+
+    LOG_INFO(logger, "usage: %s [options] input-file [output-file]", executable_name);
+    LOG_INFO(logger, "if output-file is omitted, the input file path with the .astx extension is used.");
+    LOG_INFO(logger, "options:");
+
+    parser().print_usage(logger);
+}
+
+}   // namespace maketiledtexture
+}   // namespace appleseed
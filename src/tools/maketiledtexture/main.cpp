@@ -0,0 +1,186 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Project headers.
+#include "commandlinehandler.h"
+
+// appleseed.shared headers.
+#include "application/application.h"
+#include "application/superlogger.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/genericimagefilereader.h"
+#include "foundation/image/image.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tiledtexturefileformat.h"
+#include "foundation/image/tiledtexturefilereader.h"
+#include "foundation/image/tiledtexturefilewriter.h"
+#include "foundation/platform/timers.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/log.h"
+#include "foundation/utility/stopwatch.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/filesystem/path.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <string>
+
+using namespace appleseed::maketiledtexture;
+using namespace appleseed::shared;
+using namespace foundation;
+using namespace std;
+namespace bf = boost::filesystem;
+
+namespace
+{
+    void print_statistics(
+        Logger&             logger,
+        const string&       filepath)
+    {
+        TiledTextureFileReader reader;
+        reader.open(filepath.c_str());
+
+        const CanvasProperties& props = reader.get_level_properties(0);
+
+        LOG_INFO(
+            logger,
+            "wrote %s: " FMT_SIZE_T "x" FMT_SIZE_T " pixels, " FMT_SIZE_T " channel%s, %s, " FMT_SIZE_T " level%s%s.",
+            filepath.c_str(),
+            props.m_canvas_width,
+            props.m_canvas_height,
+            props.m_channel_count,
+            props.m_channel_count > 1 ? "s" : "",
+            pixel_format_name(props.m_pixel_format),
+            reader.get_level_count(),
+            reader.get_level_count() > 1 ? "s" : "",
+            reader.is_constant() ? ", constant" : "");
+
+        for (size_t c = 0; c < props.m_channel_count; ++c)
+        {
+            const TiledTextureChannelStats& stats = reader.get_channel_stats(c);
+
+            LOG_INFO(
+                logger,
+                "  channel " FMT_SIZE_T ": average %f, max %f",
+                c,
+                stats.m_average,
+                stats.m_max);
+        }
+    }
+}
+
+
+//
+// Entry point of maketiledtexture.
+//
+
+int main(int argc, const char* argv[])
+{
+    // Initialize the logger that will be used throughout the program.
+    SuperLogger logger;
+
+    // Make sure appleseed is correctly installed.
+    Application::check_installation(logger);
+
+    // Parse the command line.
+    CommandLineHandler cl;
+    cl.parse(argc, argv, logger);
+
+    // Load an apply settings from the settings file.
+    Dictionary settings;
+    Application::load_settings("appleseed.tools.xml", settings, logger);
+    logger.configure_from_settings(settings);
+
+    // Apply command line arguments.
+    cl.apply(logger);
+
+    // Retrieve the input and output file paths.
+    const string& input_filepath = cl.m_filenames.values()[0];
+    const string output_filepath =
+        cl.m_filenames.values().size() > 1
+            ? cl.m_filenames.values()[1]
+            : bf::path(input_filepath).replace_extension(TiledTextureFileExtension).string();
+
+    if (cl.m_tile_size.value() == 0)
+        LOG_FATAL(logger, "tile size must be greater than zero.");
+
+    // Read the input image file.
+    auto_ptr<Image> image;
+    try
+    {
+        GenericImageFileReader reader;
+        image.reset(reader.read(input_filepath.c_str()));
+    }
+    catch (const exception& e)
+    {
+        LOG_FATAL(
+            logger,
+            "could not read image file %s (%s).",
+            input_filepath.c_str(),
+            e.what());
+    }
+
+    // Write the tiled texture file.
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    try
+    {
+        TiledTextureFileWriter writer(
+            cl.m_tile_size.value(),
+            cl.m_tile_size.value(),
+            cl.m_half_float.is_set() ? PixelFormatHalf : image->properties().m_pixel_format,
+            !cl.m_no_mipmaps.is_set());
+        writer.write(output_filepath.c_str(), *image);
+
+        stopwatch.measure();
+
+        print_statistics(logger, output_filepath);
+    }
+    catch (const exception& e)
+    {
+        LOG_FATAL(
+            logger,
+            "could not write tiled texture file %s (%s).",
+            output_filepath.c_str(),
+            e.what());
+    }
+
+    LOG_INFO(
+        logger,
+        "conversion took %s.",
+        pretty_time(stopwatch.get_seconds()).c_str());
+
+    return 0;
+}
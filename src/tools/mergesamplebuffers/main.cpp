@@ -0,0 +1,151 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Project headers.
+#include "commandlinehandler.h"
+
+// appleseed.shared headers.
+#include "application/application.h"
+#include "application/superlogger.h"
+
+// appleseed.renderer headers.
+#include "renderer/api/frame.h"
+#include "renderer/api/log.h"
+#include "renderer/api/project.h"
+#include "renderer/api/rendering.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/timers.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/log.h"
+#include "foundation/utility/stopwatch.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/filesystem/path.hpp"
+
+// Standard headers.
+#include <string>
+
+using namespace appleseed::mergesamplebuffers;
+using namespace appleseed::shared;
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+namespace bf = boost::filesystem;
+
+namespace
+{
+    auto_release_ptr<Project> load_project(const string& project_filepath)
+    {
+        // Construct the schema file path.
+        const bf::path schema_filepath =
+              bf::path(Application::get_root_path())
+            / "schemas"
+            / "project.xsd";
+
+        // Only the frame is needed: don't read meshes.
+        ProjectFileReader reader;
+        return
+            reader.read(
+                project_filepath.c_str(),
+                schema_filepath.string().c_str(),
+                ProjectFileReader::OmitReadingMeshFiles);
+    }
+}
+
+
+//
+// Entry point of mergesamplebuffers.
+//
+
+int main(int argc, const char* argv[])
+{
+    // Initialize the logger that will be used throughout the program.
+    SuperLogger logger;
+
+    // Make sure appleseed is correctly installed.
+    Application::check_installation(logger);
+
+    // Parse the command line.
+    CommandLineHandler cl;
+    cl.parse(argc, argv, logger);
+
+    // Load an apply settings from the settings file.
+    Dictionary settings;
+    Application::load_settings("appleseed.tools.xml", settings, logger);
+    logger.configure_from_settings(settings);
+
+    // Apply command line arguments.
+    cl.apply(logger);
+
+    // Configure the renderer's global logger.
+    global_logger().initialize_from(logger);
+
+    if (!cl.m_project.is_set())
+        LOG_FATAL(logger, "the project that was rendered must be specified with --project.");
+
+    // The project defines the frame: resolution, AOVs, alpha mode and output color space.
+    auto_release_ptr<Project> project(load_project(cl.m_project.value()));
+    if (project.get() == 0)
+        LOG_FATAL(logger, "could not load project %s.", cl.m_project.value().c_str());
+
+    Frame* frame = project->get_frame();
+    if (frame == 0)
+        LOG_FATAL(logger, "project %s does not define a frame.", cl.m_project.value().c_str());
+
+    const string output_filepath =
+        cl.m_output.is_set()
+            ? cl.m_output.value()
+            : frame->get_parameters().get_optional<string>("output_filename");
+
+    if (output_filepath.empty())
+        LOG_FATAL(logger, "no output filename specified.");
+
+    // Merge the sample buffers and develop them into the frame.
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    if (!SampleBufferFile::merge(cl.m_filenames.values(), *frame))
+        return 1;
+
+    stopwatch.measure();
+
+    LOG_INFO(
+        logger,
+        "merging took %s.",
+        pretty_time(stopwatch.get_seconds()).c_str());
+
+    // Write the images to disk.
+    if (!frame->write_main_image(output_filepath.c_str()) ||
+        !frame->write_aov_images(output_filepath.c_str()))
+        return 1;
+
+    return 0;
+}
@@ -59,6 +59,12 @@ CommandLineHandler::CommandLineHandler()
             .set_description("update the project to this revision (by default, update to the latest revision)")
             .set_syntax("revision")
             .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_binary
+            .add_name("--binary")
+            .add_name("-b")
+            .set_description("pack the project to an *.appleseedb binary project file instead of an *.appleseedz file"));
 }
 
 void CommandLineHandler::print_program_usage(
@@ -72,8 +78,8 @@ void CommandLineHandler::print_program_usage(
     LOG_INFO(logger, "usage: %s <command> [options] project.appleseed", executable_name);
     LOG_INFO(logger, "commands:");
     LOG_INFO(logger, "  update               update a project to a given revision");
-    LOG_INFO(logger, "  pack                 pack a project to an *.appleseedz file");
-    LOG_INFO(logger, "  unpack               unpack an *.appleseedz file");
+    LOG_INFO(logger, "  pack                 pack a project to an *.appleseedz (or *.appleseedb) file");
+    LOG_INFO(logger, "  unpack               unpack an *.appleseedz or *.appleseedb file");
     LOG_INFO(logger, "options:");
 
     parser().print_usage(logger);
@@ -55,6 +55,7 @@ class CommandLineHandler
   public:
     foundation::ValueOptionHandler<std::string> m_positional_args;
     foundation::ValueOptionHandler<int>         m_to_revision;
+    foundation::FlagOptionHandler               m_binary;
 
     // Constructor.
     CommandLineHandler();
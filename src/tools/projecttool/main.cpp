@@ -114,7 +114,7 @@ bool update_project()
 
 
 //
-// Pack a project to an *.appleseedz file.
+// Pack a project to an *.appleseedz or *.appleseedb file.
 //
 
 bool pack_project()
@@ -129,7 +129,8 @@ bool pack_project()
 
     // Build the path of the output project.
     const string packed_file_path =
-        bf::path(input_filepath).replace_extension(".appleseedz").string();
+        bf::path(input_filepath).replace_extension(
+            g_cl.m_binary.is_set() ? ".appleseedb" : ".appleseedz").string();
 
     // Write the project to disk.
     return ProjectFileWriter::write(project.ref(), packed_file_path.c_str());
@@ -137,7 +138,7 @@ bool pack_project()
 
 
 //
-// Unpack an *.appleseedz file.
+// Unpack an *.appleseedz or *.appleseedb file.
 //
 
 bool unpack_project()